@@ -67,6 +67,9 @@ initBiometricEvaluation()
 	PyModule_AddIntConstant(module, (PBE::RecordStore::OBJECT_NAME + "_" +
 	    to_string(BE::IO::RecordStore::Kind::Compressed)).c_str(),
 	    to_int_type(BE::IO::RecordStore::Kind::Compressed));
+	PyModule_AddIntConstant(module, (PBE::RecordStore::OBJECT_NAME + "_" +
+	    to_string(BE::IO::RecordStore::Kind::Sharded)).c_str(),
+	    to_int_type(BE::IO::RecordStore::Kind::Sharded));
 	PyModule_AddIntConstant(module,  (PBE::RecordStore::OBJECT_NAME + "_" +
 	    PRS::PARAM_RSTYPE_VALUE_DEFAULT).c_str(),
 	    to_int_type(BE::IO::RecordStore::Kind::Default));
@@ -82,6 +82,15 @@ namespace BiometricEvaluation {
  * state, and the set of signals can be changed at any time, but are not in
  * effect until start() is called.
  *
+ * Signal blocks may be used from several threads at once, each thread with
+ * its own SignalManager. The jump state is kept per-thread, and a signal's
+ * handler is installed while any SignalManager handling that signal is
+ * started, returning to the default disposition when the last one stops.
+ * A signal caused by the faulting thread itself (e.g., SIGSEGV) jumps to
+ * that thread's block. A fault in a thread that is not inside a signal block
+ * receives the default disposition, and other signals delivered to such a
+ * thread are ignored.
+ *
  * @attention
  * The start(), stop(), setSigHandled() and clearSigHandled() methods are not
  * meant to be used directly by applications, which should use the 
@@ -182,15 +191,17 @@ namespace BiometricEvaluation {
 			void clearSigHandled();
 
 			/**
-			 * Flag indicating can jump after handling a signal.
+			 * Flag indicating can jump after handling a signal,
+			 * private to each thread.
 			 * @note Should not be directly used by applications.
 			 */
-			static bool _canSigJump;
+			static thread_local bool _canSigJump;
 			/**
-			 * The jump buffer used by the signal handler.
+			 * The jump buffer used by the signal handler, private
+			 * to each thread.
 			 * @note Should not be directly used by applications.
 			 */
-			static sigjmp_buf _sigJumpBuf;
+			static thread_local sigjmp_buf _sigJumpBuf;
 
 		protected:
 
@@ -200,6 +211,12 @@ namespace BiometricEvaluation {
 			 */
 			sigset_t _signalSet;
 
+			/**
+			 * Signals whose handlers were installed by start()
+			 * and not yet released by stop().
+			 */
+			sigset_t _activeSignalSet;
+
 			/**
 			 * Flag indicated that a signal was handled.
 			 */
@@ -12,11 +12,16 @@
 #define BE_FRAMEWORK_API_H_
 
 #include <functional>
+#include <map>
 #include <memory>
+#include <vector>
+
+#include <csignal>
 
 #include <be_error_signal_manager.h>
 #include <be_framework_enumeration.h>
 #include <be_framework_status.h>
+#include <be_time_histogram.h>
 #include <be_time_timer.h>
 #include <be_time_watchdog.h>
 
@@ -50,6 +55,9 @@ namespace BiometricEvaluation
 		 *
 		 * @note
 		 * One API object should be instantiated per process/thread.
+		 * Where supported, the Watchdog signals only the thread
+		 * calling call(), so threads may each use their own API
+		 * object concurrently.
 		 */
 		template<typename T>
 		class API
@@ -160,6 +168,48 @@ namespace BiometricEvaluation
 			    &failure = {},
 			    const bool rethrowExceptions = false);
 
+			/**
+			 * @brief
+			 * Invoke many operations in sequence, setting up
+			 * signal handling and the watchdog once.
+			 * @details
+			 * Each operation is guarded as by call(), using the
+			 * SignalManager and the interval of the Watchdog from
+			 * this object. Signal handlers stay installed for the
+			 * whole batch, and where supported the per-operation
+			 * time limit is enforced by a Watchdog::MONITORED
+			 * monitor thread, so an operation that completes
+			 * normally costs no system calls for its guards.
+			 * Elsewhere, each operation is passed to call().
+			 *
+			 * @param operations
+			 * Operations to invoke, in order.
+			 * @param success
+			 * Operations invoked after each operation that
+			 * returns.
+			 * @param failure
+			 * Operations invoked after each operation that is
+			 * aborted.
+			 *
+			 * @return
+			 * Analytics about the return of each operation, in
+			 * the order of operations.
+			 *
+			 * @note
+			 * Exceptions raised from operations are not rethrown.
+			 * @note
+			 * A timeout may be detected up to a quarter of the
+			 * Watchdog interval late.
+			 */
+			std::vector<Result>
+			callBatch(
+			    const std::vector<std::function<T(void)>>
+			    &operations,
+			    const std::function<void(const Result&)>
+			    &success = {},
+			    const std::function<void(const Result&)>
+			    &failure = {});
+
 			/** 
 			 * @brief
 			 * Obtain the timer object.
@@ -188,6 +238,44 @@ namespace BiometricEvaluation
 				return (_watchdog);
 			}
 
+			/**
+			 * @brief
+			 * Obtain the distribution of elapsed times of
+			 * operations that ended in a state.
+			 * @details
+			 * call() and callBatch() record the elapsed time of
+			 * every operation, in nanoseconds, in the Histogram
+			 * for the state in which the operation ended.
+			 *
+			 * @param state
+			 * Final state of operations.
+			 *
+			 * @return
+			 * Histogram for state, created if needed.
+			 */
+			std::shared_ptr<BE::Time::Histogram>
+			getLatencyHistogram(
+			    const APICurrentState state);
+
+			/**
+			 * @brief
+			 * Record elapsed times for a state in a Histogram
+			 * that may be shared.
+			 * @details
+			 * Histogram recording is lock-free, so API objects in
+			 * several threads may share one Histogram.
+			 *
+			 * @param state
+			 * Final state of operations.
+			 * @param histogram
+			 * Histogram for state.
+			 */
+			void
+			setLatencyHistogram(
+			    const APICurrentState state,
+			    const std::shared_ptr<BE::Time::Histogram>
+			    &histogram);
+
 			/**
 			 * @brief
 			 * Obtain the signal manager object.
@@ -203,12 +291,49 @@ namespace BiometricEvaluation
 			}
 
 		private:
+			/**
+			 * @brief
+			 * Count the elapsed time of the last operation.
+			 *
+			 * @param result
+			 * Result of the last operation.
+			 */
+			void
+			recordLatency(
+			    const Result &result);
+
+			/**
+			 * @brief
+			 * Invoke one operation of a batch.
+			 *
+			 * @param operation
+			 * Operation to invoke.
+			 * @param watchdog
+			 * MONITORED Watchdog guarding the batch.
+			 * @param signalMask
+			 * Signal mask of the thread when the batch began.
+			 *
+			 * @return
+			 * Analytics about the return of operation.
+			 *
+			 * @note
+			 * The SignalManager must already be started.
+			 */
+			Result
+			callInBatch(
+			    const std::function<T(void)> &operation,
+			    BE::Time::Watchdog &watchdog,
+			    const sigset_t &signalMask);
+
 			/** Timer */
 			std::shared_ptr<BE::Time::Timer> _timer;
 			/** Watchdog timer */
 			std::shared_ptr<BE::Time::Watchdog> _watchdog;
 			/** Signal manager */
 			std::shared_ptr<BE::Error::SignalManager> _sigmgr;
+			/** Elapsed times, keyed by final state */
+			std::map<APICurrentState,
+			    std::shared_ptr<BE::Time::Histogram>> _latencies;
 		};
 	}
 }
@@ -223,10 +348,17 @@ BiometricEvaluation::Framework::API<T>::Result::Result() :
 template<typename T>
 BiometricEvaluation::Framework::API<T>::API() :
      _timer(new BE::Time::Timer()),
-     _watchdog(new BE::Time::Watchdog(BE::Time::Watchdog::REALTIME)),
+     _watchdog(nullptr),
      _sigmgr(new BE::Error::SignalManager())
 {
-
+	/* Prefer a Watchdog that does not interfere with other threads */
+	try {
+		_watchdog.reset(new BE::Time::Watchdog(
+		    BE::Time::Watchdog::THREADREALTIME));
+	} catch (const BE::Error::NotImplemented &) {
+		_watchdog.reset(new BE::Time::Watchdog(
+		    BE::Time::Watchdog::REALTIME));
+	}
 }
 
 template<typename T>
@@ -247,8 +379,11 @@ BiometricEvaluation::Framework::API<T>::call(
 			ret.status = operation();
 		} catch (...) {
 			this->getTimer()->stop();
+			ABORT_WATCHDOG(this->getWatchdog());
+			ABORT_SIGNAL_MANAGER(this->getSignalManager());
 			ret.elapsed = this->getTimer()->elapsed();
 			ret.currentState = APICurrentState::ExceptionCaught;
+			this->recordLatency(ret);
 
 			if (failure)
 				failure(ret);
@@ -265,6 +400,7 @@ BiometricEvaluation::Framework::API<T>::call(
 		this->getTimer()->stop();
 		ret.elapsed = this->getTimer()->elapsed();
 		ret.currentState = APICurrentState::SignalCaught;
+		this->recordLatency(ret);
 
 		if (failure)
 			failure(ret);
@@ -272,12 +408,14 @@ BiometricEvaluation::Framework::API<T>::call(
 		this->getTimer()->stop();
 		ret.elapsed = this->getTimer()->elapsed();
 		ret.currentState = APICurrentState::WatchdogExpired;
+		this->recordLatency(ret);
 
 		if (failure)
 			failure(ret);
 	} else {
 		ret.currentState = APICurrentState::Completed;
 		ret.elapsed = this->getTimer()->elapsed();
+		this->recordLatency(ret);
 
 		if (success)
 			success(ret);
@@ -286,6 +424,148 @@ BiometricEvaluation::Framework::API<T>::call(
 	return (ret);
 }
 
+template<typename T>
+std::vector<typename BiometricEvaluation::Framework::API<T>::Result>
+BiometricEvaluation::Framework::API<T>::callBatch(
+    const std::vector<std::function<T(void)>> &operations,
+    const std::function<void(const Framework::API<T>::Result&)> &success,
+    const std::function<void(const Framework::API<T>::Result&)> &failure)
+{
+	std::vector<Result> results;
+	results.reserve(operations.size());
+
+	std::unique_ptr<BE::Time::Watchdog> watchdog;
+	try {
+		watchdog.reset(new BE::Time::Watchdog(
+		    BE::Time::Watchdog::MONITORED));
+	} catch (const BE::Error::NotImplemented &) {
+		for (const auto &operation : operations)
+			results.push_back(this->call(operation, success,
+			    failure));
+		return (results);
+	}
+	watchdog->setInterval(this->getWatchdog()->getInterval());
+
+	/* Jumps do not restore the mask, so restore it on failure */
+	sigset_t signalMask;
+	pthread_sigmask(SIG_SETMASK, nullptr, &signalMask);
+
+	this->getSignalManager()->clearSigHandled();
+	this->getSignalManager()->start();
+	BE::Error::SignalManager::_canSigJump = false;
+	for (const auto &operation : operations) {
+		results.push_back(this->callInBatch(operation, *watchdog,
+		    signalMask));
+
+		if (results.back()) {
+			if (success)
+				success(results.back());
+		} else if (failure) {
+			failure(results.back());
+		}
+	}
+	this->getSignalManager()->stop();
+
+	return (results);
+}
+
+template<typename T>
+typename BiometricEvaluation::Framework::API<T>::Result
+BiometricEvaluation::Framework::API<T>::callInBatch(
+    const std::function<T(void)> &operation,
+    BE::Time::Watchdog &watchdog,
+    const sigset_t &signalMask)
+{
+	/*
+	 * The same sequence as the signal and watchdog block macros, but
+	 * without saving and restoring the signal mask or reinstalling
+	 * handlers for every operation. Neither jump buffer may be used
+	 * once this function returns.
+	 */
+	Result ret;
+	ret.currentState = APICurrentState::Running;
+	if (sigsetjmp(BE::Error::SignalManager::_sigJumpBuf, 0) != 0) {
+		BE::Error::SignalManager::_canSigJump = false;
+		watchdog.clearCanSigJump();
+		pthread_sigmask(SIG_SETMASK, &signalMask, nullptr);
+		watchdog.stop();
+		this->getTimer()->stop();
+		this->getSignalManager()->setSigHandled();
+		ret.elapsed = this->getTimer()->elapsed();
+		ret.currentState = APICurrentState::SignalCaught;
+		this->recordLatency(ret);
+		return (ret);
+	}
+	if (sigsetjmp(BE::Time::Watchdog::_sigJumpBuf, 0) != 0) {
+		BE::Error::SignalManager::_canSigJump = false;
+		watchdog.clearCanSigJump();
+		pthread_sigmask(SIG_SETMASK, &signalMask, nullptr);
+		watchdog.stop();
+		watchdog.setExpired();
+		this->getTimer()->stop();
+		ret.elapsed = this->getTimer()->elapsed();
+		ret.currentState = APICurrentState::WatchdogExpired;
+		this->recordLatency(ret);
+		return (ret);
+	}
+
+	watchdog.clearExpired();
+	this->getTimer()->start();
+	BE::Error::SignalManager::_canSigJump = true;
+	watchdog.setCanSigJump();
+	watchdog.start();
+	try {
+		ret.status = operation();
+	} catch (...) {
+		watchdog.clearCanSigJump();
+		BE::Error::SignalManager::_canSigJump = false;
+		this->getTimer()->stop();
+		watchdog.stop();
+		ret.elapsed = this->getTimer()->elapsed();
+		ret.currentState = APICurrentState::ExceptionCaught;
+		this->recordLatency(ret);
+		return (ret);
+	}
+	watchdog.clearCanSigJump();
+	BE::Error::SignalManager::_canSigJump = false;
+	this->getTimer()->stop();
+	watchdog.stop();
+
+	ret.elapsed = this->getTimer()->elapsed();
+	ret.currentState = APICurrentState::Completed;
+	this->recordLatency(ret);
+	return (ret);
+}
+
+template<typename T>
+std::shared_ptr<BiometricEvaluation::Time::Histogram>
+BiometricEvaluation::Framework::API<T>::getLatencyHistogram(
+    const APICurrentState state)
+{
+	auto &histogram = this->_latencies[state];
+	if (!histogram)
+		histogram.reset(new BE::Time::Histogram());
+	return (histogram);
+}
+
+template<typename T>
+void
+BiometricEvaluation::Framework::API<T>::setLatencyHistogram(
+    const APICurrentState state,
+    const std::shared_ptr<BE::Time::Histogram> &histogram)
+{
+	this->_latencies[state] = histogram;
+}
+
+template<typename T>
+void
+BiometricEvaluation::Framework::API<T>::recordLatency(
+    const Result &result)
+{
+	this->getLatencyHistogram(result.currentState)->record(
+	    this->getTimer()->elapsed(true));
+}
+
 BE_FRAMEWORK_ENUMERATION_DECLARATIONS(
     BiometricEvaluation::Framework::APICurrentState,
     BE_Framework_APICurrentState_EnumToStringMap);
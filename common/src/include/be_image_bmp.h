@@ -36,6 +36,10 @@ namespace BiometricEvaluation
 			BMP(
 			    const Memory::uint8Array &data);
 
+			/** Share, rather than copy, encoded data */
+			BMP(
+			    const Memory::SharedBuffer &data);
+
 			~BMP() = default;
 
 			Memory::AutoArray<uint8_t>
@@ -157,6 +161,9 @@ namespace BiometricEvaluation
 			/**
 			 * @brief
 			 * Decode 8-bit Run-Length Encoded bitmap image data.
+			 * @details
+			 * Rows are placed top to bottom as they are decoded,
+			 * regardless of the order in which they are stored.
 			 *
 			 * @param input
 			 *	Pointer to the full BMP image data.
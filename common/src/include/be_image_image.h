@@ -17,6 +17,7 @@
 
 #include <be_image.h>
 #include <be_memory_autoarray.h>
+#include <be_memory_sharedbuffer.h>
 
 namespace BiometricEvaluation
 {
@@ -104,6 +105,49 @@ namespace BiometricEvaluation
 			    const uint64_t size,
 			    const CompressionAlgorithm compression);
 
+			/**
+		 	 * @brief
+			 * Parent constructor for all Image classes, sharing
+			 * rather than copying the image data.
+			 *
+			 * @param[in] data
+			 *	The image data.
+			 * @param[in] dimensions
+			 *	The width and height of the image in pixels.
+			 * @param[in] colorDepth
+			 *	The image color depth, in bits-per-pixel.
+			 * @param[in] bitDepth
+			 *	The number of bits per color component.
+			 * @param[in] resolution
+			 *	The resolution of the image
+			 * @param[in] compression
+			 *	The CompressionAlgorithm of data.
+			 * @param[in] hasAlphaChannel
+			 *	Presence of an alpha channel.
+			 */
+			Image(
+			    const Memory::SharedBuffer &data,
+			    const Size dimensions,
+			    const uint32_t colorDepth,
+			    const uint16_t bitDepth,
+			    const Resolution resolution,
+			    const CompressionAlgorithm compression,
+			    const bool hasAlphaChannel);
+
+			/**
+		 	 * @brief
+			 * Parent constructor for all Image classes, sharing
+			 * rather than copying the image data.
+			 *
+			 * @param[in] data
+			 *	The image data.
+			 * @param[in] compression
+			 *	The CompressionAlgorithm of data.
+			 */
+			Image(
+			    const Memory::SharedBuffer &data,
+			    const CompressionAlgorithm compression);
+
 			/**
 			 * @brief
 			 * Accessor for the CompressionAlgorithm of the image.
@@ -139,6 +183,18 @@ namespace BiometricEvaluation
 			getData()
 			    const;
 
+			/**
+		 	 * @brief
+			 * Accessor for the image data, without copying.
+			 *
+			 * @return
+			 *	SharedBuffer holding image data, which
+			 *	remains valid after this Image is destroyed.
+			 */
+			Memory::SharedBuffer
+			getSharedData()
+			    const;
+
 			/**
 		 	 * @brief
 			 * Accessor for the raw image data. The data returned
@@ -339,6 +395,48 @@ namespace BiometricEvaluation
 			static std::shared_ptr<Image>
 			openImage(
 			    const Memory::uint8Array &data);
+
+			/**
+			 * @brief
+			 * Determine the image type of a buffer of image data
+			 * and create an Image object that takes ownership of
+			 * the buffer, rather than copying it.
+			 *
+ 			 * @param[in] data
+			 *	The image data, left empty.
+			 *
+			 * @return
+			 *	Image representation of the input data buffer.
+ 			 *
+			 * @throw Error::DataError
+			 *	Error manipulating data.
+			 * @throw Error::StrategyError
+			 *	Error while creating Image.
+			 */
+			static std::shared_ptr<Image>
+			openImage(
+			    Memory::uint8Array &&data);
+
+			/**
+			 * @brief
+			 * Determine the image type of a buffer of image data
+			 * and create an Image object that shares, rather than
+			 * copies, the buffer.
+			 *
+ 			 * @param[in] data
+			 *	The image data.
+			 *
+			 * @return
+			 *	Image representation of the input data buffer.
+ 			 *
+			 * @throw Error::DataError
+			 *	Error manipulating data.
+			 * @throw Error::StrategyError
+			 *	Error while creating Image.
+			 */
+			static std::shared_ptr<Image>
+			openImage(
+			    const Memory::SharedBuffer &data);
 			    
 			/**
 			 * @brief
@@ -536,7 +634,7 @@ namespace BiometricEvaluation
 			Resolution _resolution;
 
 			/** Encoded image data */
-			Memory::AutoArray<uint8_t> _data;
+			Memory::SharedBuffer _data;
 
 			/** Compression algorithm of _data */
 			CompressionAlgorithm _compressionAlgorithm;
@@ -56,8 +56,69 @@ namespace BiometricEvaluation
 			JPEG(
 			    const Memory::uint8Array &data);
 
+			/** Share, rather than copy, encoded data */
+			JPEG(
+			    const Memory::SharedBuffer &data);
+
 			~JPEG() = default;
 
+			/** Discrete cosine transform used when encoding */
+			enum class DCTMethod
+			{
+				/** Accurate integer transform */
+				Integer,
+				/** Faster, less accurate integer transform */
+				FastInteger,
+				/** Floating-point transform */
+				Float
+			};
+
+			/** Parameters for encode() */
+			struct EncodeOptions
+			{
+				/** Default parameters */
+				EncodeOptions();
+
+				/** Quality, from 1 (smallest) to 100 (best) */
+				uint8_t quality{75};
+				/** Transform implementation */
+				DCTMethod dctMethod{DCTMethod::Integer};
+				/**
+				 * Compute Huffman tables for each image,
+				 * producing smaller output more slowly.
+				 */
+				bool optimizeCoding{false};
+				/** Write a progressive, not baseline, JPEG */
+				bool progressive{false};
+			};
+
+			/**
+			 * @brief
+			 * Encode an image as Lossy JPEG.
+			 *
+			 * @param[in] image
+			 *	The image to encode, which must have 8-bit
+			 *	grayscale or RGB samples.  An alpha channel,
+			 *	if present, is discarded.
+			 * @param[in] options
+			 *	Encoding parameters.
+			 *
+			 * @return
+			 *	JPEG (JFIF) encoded image data.
+			 *
+			 * @throw Error::DataError
+			 *	Error decompressing image.
+			 * @throw Error::ParameterError
+			 *	image cannot be encoded as JPEG, or options
+			 *	are invalid.
+			 * @throw Error::StrategyError
+			 *	Error reported by libjpeg.
+			 */
+			static Memory::uint8Array
+			encode(
+			    const Image &image,
+			    const EncodeOptions &options = EncodeOptions());
+
 			Memory::uint8Array
 			getRawGrayscaleData(
 			    uint8_t depth) const;
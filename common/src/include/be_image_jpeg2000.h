@@ -24,6 +24,11 @@ namespace BiometricEvaluation
 		class JPEG2000 : public Image
 		{
 		public:
+			/** OPJ_CODEC_FORMAT of a JPEG-2000 codestream */
+			static const int8_t CODEC_J2K = 0;
+			/** OPJ_CODEC_FORMAT of a JP2 file */
+			static const int8_t CODEC_JP2 = 2;
+
 			/**
 			 * @brief
 			 * Create a new JPEG2000 object.
@@ -43,13 +48,92 @@ namespace BiometricEvaluation
 			JPEG2000(
 			    const uint8_t *data,
 			    const uint64_t size,
-			    const int8_t codecFormat = 2);
+			    const int8_t codecFormat = CODEC_JP2);
 
 			JPEG2000(
 			    const Memory::uint8Array &data);
 
+			/**
+			 * @brief
+			 * Create a new JPEG2000 object sharing, rather than
+			 * copying, encoded data.
+			 *
+			 * @param[in] data
+			 *	The image data.
+			 * @param[in] codecFormat
+			 *	The OPJ_CODEC_FORMAT used to encode data.
+			 *
+			 * @throw Error::DataError
+			 *	Error manipulating data.
+			 * @throw Error::StrategyError
+			 *	Error while creating Image.
+			 */
+			JPEG2000(
+			    const Memory::SharedBuffer &data,
+			    const int8_t codecFormat = CODEC_JP2);
+
 			~JPEG2000() = default;
 
+			/** Parameters for encode() */
+			struct EncodeOptions
+			{
+				/** Default parameters */
+				EncodeOptions();
+
+				/**
+				 * Compression ratio (e.g., 10 for 10:1),
+				 * or 0 for lossless compression.
+				 */
+				float compressionRatio{0};
+				/**
+				 * Number of resolution levels, reduced if
+				 * the image is too small.  Fewer levels
+				 * encode faster.
+				 */
+				uint8_t resolutionLevels{6};
+				/**
+				 * Number of threads encoding code blocks,
+				 * or 0 for one per processor.  Ignored by
+				 * libopenjp2 before 2.5.
+				 */
+				uint32_t threads{0};
+				/**
+				 * The OPJ_CODEC_FORMAT to write: CODEC_J2K
+				 * or CODEC_JP2.
+				 */
+				int8_t codecFormat{CODEC_JP2};
+			};
+
+			/**
+			 * @brief
+			 * Encode an image as JPEG-2000.
+			 *
+			 * @param[in] image
+			 *	The image to encode, which must have 8- or
+			 *	16-bit grayscale or RGB samples, optionally
+			 *	followed by an alpha sample.
+			 * @param[in] options
+			 *	Encoding parameters.
+			 *
+			 * @return
+			 *	JPEG-2000-encoded image data.
+			 *
+			 * @throw Error::DataError
+			 *	Error decompressing image.
+			 * @throw Error::ParameterError
+			 *	image cannot be encoded as JPEG-2000, or
+			 *	options are invalid.
+			 * @throw Error::StrategyError
+			 *	Error reported by libopenjp2.
+			 *
+			 * @note
+			 * Resolution is not recorded.
+			 */
+			static Memory::uint8Array
+			encode(
+			    const Image &image,
+			    const EncodeOptions &options = EncodeOptions());
+
 			Memory::uint8Array
 			getRawData()
 			    const;
@@ -31,6 +31,10 @@ namespace BiometricEvaluation
 			JPEGL(
 			    const Memory::uint8Array &data);
 
+			/** Share, rather than copy, encoded data */
+			JPEGL(
+			    const Memory::SharedBuffer &data);
+
 			~JPEGL() = default;
 
 			Memory::uint8Array
@@ -48,6 +48,10 @@ namespace BiometricEvaluation
 			NetPBM(
 			    const Memory::uint8Array &data);
 
+			/** Share, rather than copy, encoded data */
+			NetPBM(
+			    const Memory::SharedBuffer &data);
+
 			~NetPBM() = default;
 
 			/**
@@ -190,9 +194,6 @@ namespace BiometricEvaluation
 			 * 
 			 * @return
 			 *	8-bit depth representation of bitmap
-			 *
-			 * @throw out_of_range
-			 *	Error extracting a value from the bitmap.
 			 */
 			static Memory::uint8Array
 			ASCIIBitmapTo8Bit(
@@ -224,11 +225,11 @@ namespace BiometricEvaluation
 			 *	Binary pixel map representation of the ASCII
 			 *	pixel map in the same depth as the original.
 			 *
-			 * @throw out_of_range
+			 * @throw Error::DataError
 			 *	Error extracting a value from the pixel map.
 			 * @throw Error::ParameterError
 			 *	Invalid value for depth, must be a multiple of
-			 *	8.
+			 *	8, or for maxColor, must be 1 to 65535.
 			 */
 			static Memory::uint8Array
 			ASCIIPixmapToBinaryPixmap(
@@ -255,9 +256,6 @@ namespace BiometricEvaluation
 			 * 
 			 * @return
 			 *	8-bit depth representation of bitmap
-			 *
-			 * @throw out_of_range
-			 *	Error extracting a value from the bitmap.
 			 */
 			static Memory::uint8Array
 			BinaryBitmapTo8Bit(
@@ -44,8 +44,71 @@ namespace BiometricEvaluation
 			PNG(
 			    const Memory::uint8Array &data);
 
+			/** Share, rather than copy, encoded data */
+			PNG(
+			    const Memory::SharedBuffer &data);
+
 			~PNG() = default;
 
+			/** Row filters tried when encoding */
+			enum class Filter
+			{
+				/** No filtering (fastest) */
+				None,
+				/** Difference from the pixel to the left */
+				Sub,
+				/** Difference from the pixel above */
+				Up,
+				/** Difference from the mean of Sub and Up */
+				Average,
+				/** Paeth predictor */
+				Paeth,
+				/** Choose the best filter for each row */
+				Adaptive
+			};
+
+			/** Parameters for encode() */
+			struct EncodeOptions
+			{
+				/** Default parameters */
+				EncodeOptions();
+
+				/**
+				 * zlib compression level, from 0 (none,
+				 * fastest) to 9 (smallest).
+				 */
+				uint8_t compressionLevel{6};
+				/** Row filter strategy */
+				Filter filter{Filter::Adaptive};
+			};
+
+			/**
+			 * @brief
+			 * Encode an image as PNG.
+			 *
+			 * @param[in] image
+			 *	The image to encode, which must have 8- or
+			 *	16-bit grayscale or RGB samples, optionally
+			 *	followed by an alpha sample.
+			 * @param[in] options
+			 *	Encoding parameters.
+			 *
+			 * @return
+			 *	PNG-encoded image data.
+			 *
+			 * @throw Error::DataError
+			 *	Error decompressing image.
+			 * @throw Error::ParameterError
+			 *	image cannot be encoded as PNG, or options
+			 *	are invalid.
+			 * @throw Error::StrategyError
+			 *	Error reported by libpng.
+			 */
+			static Memory::uint8Array
+			encode(
+			    const Image &image,
+			    const EncodeOptions &options = EncodeOptions());
+
 			Memory::uint8Array
 			getRawData()
 			    const;
@@ -114,6 +177,24 @@ namespace BiometricEvaluation
 			    png_bytep buffer,
 			    png_size_t length);
 
+			/**
+			 * @brief
+			 * libpng callback to append encoded data to a
+			 * Memory::uint8Array.
+			 *
+			 * @param png_ptr
+			 *	Pointer to a PNG struct for the image.
+			 * @param data
+			 *	Encoded data.
+			 * @param length
+			 *	Size of data.
+			 */
+			static void
+			png_write_mem_dest(
+			    png_structp png_ptr,
+			    png_bytep data,
+			    png_size_t length);
+
 		        /**
 		         * @brief
 		         * Convert libpng errors into C++ exceptions.
@@ -28,6 +28,10 @@ namespace BiometricEvaluation
 			TIFF(
 			    const Memory::uint8Array &data);
 
+			/** Share, rather than copy, encoded data */
+			TIFF(
+			    const Memory::SharedBuffer &data);
+
 			~TIFF() = default;
 
 			Memory::uint8Array
@@ -31,8 +31,57 @@ namespace BiometricEvaluation
 			WSQ(
 			    const Memory::uint8Array &data);
 
+			/** Share, rather than copy, encoded data */
+			WSQ(
+			    const Memory::SharedBuffer &data);
+
 			~WSQ() = default;
 
+			/** Parameters for encode() */
+			struct EncodeOptions
+			{
+				/** Default parameters */
+				EncodeOptions();
+
+				/**
+				 * Target bits per pixel.  0.75 gives
+				 * roughly 15:1 compression and 2.25
+				 * roughly 5:1.
+				 */
+				float bitRate{0.75};
+			};
+
+			/**
+			 * @brief
+			 * Encode an image as WSQ.
+			 *
+			 * @param[in] image
+			 *	The image to encode.  Color images are
+			 *	converted to 8-bit grayscale.
+			 * @param[in] options
+			 *	Encoding parameters.
+			 *
+			 * @return
+			 *	WSQ-encoded image data.
+			 *
+			 * @throw Error::DataError
+			 *	Error decompressing image.
+			 * @throw Error::NotImplemented
+			 *	image cannot be converted to grayscale.
+			 * @throw Error::ParameterError
+			 *	options are invalid.
+			 * @throw Error::StrategyError
+			 *	Error reported by libwsq.
+			 *
+			 * @note
+			 * libwsq encodes with global state, so concurrent
+			 * calls are serialized.
+			 */
+			static Memory::uint8Array
+			encode(
+			    const Image &image,
+			    const EncodeOptions &options = EncodeOptions());
+
 			Memory::uint8Array
 			getRawData()
 			    const;
@@ -54,6 +54,8 @@ namespace BiometricEvaluation {
 			 * 	The directory where the store is to be created.
 			 * @param[in] description
 			 *	The store's description.
+			 * @param[in] concurrency
+			 *	Whether the object may be shared by threads.
 			 *
 			 * @throw Error::ObjectExists
 			 * 	The store already exists.
@@ -63,7 +65,9 @@ namespace BiometricEvaluation {
 			 */
 			ArchiveRecordStore(
 			    const std::string &pathname,
-			    const std::string &description);
+			    const std::string &description,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
 
 			/**
 			 * Open an existing ArchiveRecordStore.
@@ -72,6 +76,8 @@ namespace BiometricEvaluation {
 			 *	The path name of the store.
 			 * @param[in] mode
 			 *	Open mode, read-only or read-write.
+			 * @param[in] concurrency
+			 *	Whether the object may be shared by threads.
 			 *
 			 * @throw Error::ObjectDoesNotExist
 			 *	The store does not exist.
@@ -81,7 +87,9 @@ namespace BiometricEvaluation {
 			 */
 			 ArchiveRecordStore(
 			     const std::string &pathname,
-			     IO::Mode mode = IO::Mode::ReadOnly);
+			     IO::Mode mode = IO::Mode::ReadOnly,
+			     RecordStore::Concurrency concurrency =
+			     RecordStore::Concurrency::Exclusive);
 
 			/**
 			 * Destructor.
@@ -133,6 +141,16 @@ namespace BiometricEvaluation {
 			    const std::string &key)
 			    override;
 
+			std::string
+			nextKey(
+			    const std::string &key)
+			    override;
+
+			RecordStore::Concurrency
+			getConcurrency()
+			    const
+			    override;
+
 			void move(
 			    const std::string &pathname)
 			    override;
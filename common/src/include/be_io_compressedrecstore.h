@@ -165,6 +165,35 @@ namespace BiometricEvaluation
 			    const std::string &pathname)
 			    override;
 
+			/**
+			 * @brief
+			 * Compress large records as blocks on several
+			 * threads.
+			 * @details
+			 * Blocks are only used by GZIP compression, and are
+			 * off by default.  Releases of this library that
+			 * predate blocks only partly decompress records
+			 * stored as blocks.  The block size is saved with a
+			 * store opened read/write.  The thread count is used
+			 * only by this object, when reading as well as when
+			 * inserting.
+			 *
+			 * @param[in] blockSize
+			 *	Records larger than this many bytes are
+			 *	compressed as blocks, or 0 to compress each
+			 *	record as a single stream.
+			 * @param[in] threadCount
+			 *	Threads to use for each record, or 0 to use
+			 *	one per processor core.
+			 *
+			 * @throw Error::StrategyError
+			 *	The block size could not be saved.
+			 */
+			void
+			setBlockCompression(
+			    uint64_t blockSize,
+			    unsigned int threadCount = 0);
+
 			/**
 			 * @brief
 			 * Copy constructor (disabled).
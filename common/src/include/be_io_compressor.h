@@ -19,6 +19,7 @@
 #include <be_framework_enumeration.h>
 #include <be_io_properties.h>
 #include <be_memory_autoarray.h>
+#include <be_memory_byteview.h>
 
 namespace BiometricEvaluation 
 {
@@ -80,6 +81,25 @@ namespace BiometricEvaluation
 			    const Memory::uint8Array &uncompressedData)
 			    const = 0;
 
+			/**
+			 * @brief
+			 * Compress a buffer without first copying it into a
+			 * uint8Array.
+			 *
+			 * @param uncompressedData
+			 *	Uncompressed data buffer to compress.
+			 *
+			 * @return
+			 * Compressed buffer.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error in compression unit.
+			 */
+			Memory::uint8Array
+			compress(
+			    Memory::ByteView uncompressedData)
+			    const;
+
 			/**
 			 * @brief
 			 * Compress a buffer.
@@ -202,6 +222,59 @@ namespace BiometricEvaluation
 			    const Memory::uint8Array &compressedData)
 			    const = 0;
 
+			/**
+			 * @brief
+			 * Decompress a compressed buffer without first copying
+			 * it into a uint8Array.
+			 *
+			 * @param compressedData
+			 *	Compressed data buffer to decompress.
+			 *
+			 * @return
+			 * Decompressed data.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error in decompression unit.
+			 */
+			Memory::uint8Array
+			decompress(
+			    Memory::ByteView compressedData)
+			    const;
+
+			/**
+			 * @brief
+			 * Decompress a compressed buffer into a buffer of known
+			 * size.
+			 * @details
+			 * Intended for callers that recorded the size of the
+			 * data when it was compressed, avoiding any
+			 * reallocation of the output.  The default
+			 * implementation decompresses into a new buffer and
+			 * copies it.
+			 *
+			 * @param compressedData
+			 *	Compressed data buffer to decompress.
+			 * @param compressedDataSize
+			 *	Size of compressedData.
+			 * @param uncompressedData
+			 *	Buffer that will hold the decompressed data.
+			 * @param uncompressedDataSize
+			 *	Size of the decompressed data, and of
+			 *	uncompressedData.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error in decompression unit, or decompressed
+			 *	data is not exactly uncompressedDataSize
+			 *	bytes.
+			 */
+			virtual void
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize,
+			    uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize)
+			    const;
+
 			/**
 			 * @brief
 			 * Decompress a compressed buffer into a file.
@@ -415,6 +488,22 @@ namespace BiometricEvaluation
 			operator=(
 			    const Compressor& other) = delete;
 
+		protected:
+			/**
+			 * @brief
+			 * Notification that an option was set or removed.
+			 * @details
+			 * Children that cache option values or state derived
+			 * from them should refresh it here.  The default
+			 * implementation does nothing.
+			 *
+			 * @param optionName
+			 *	Name of the option that changed.
+			 */
+			virtual void
+			optionChanged(
+			    const std::string &optionName);
+
 		private:
 			/** Compressor properties */
 			Properties _compressorOptions;
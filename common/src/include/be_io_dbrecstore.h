@@ -10,6 +10,8 @@
 #ifndef __BE_DBRECSTORE_H__
 #define __BE_DBRECSTORE_H__
 
+#include <vector>
+
 #include <be_io_recordstore.h>
 
 /*
@@ -27,6 +29,36 @@ namespace BiometricEvaluation {
 		 */
 		class DBRecordStore : public RecordStore {
 		public:
+			/**
+			 * @brief
+			 * The property string ``BTree Cache Size''; optional.
+			 * @details
+			 * Bytes of memory used to cache pages of each
+			 * B-tree.  Applies each time the store is opened,
+			 * so may be changed in the control file of an
+			 * existing store.  0 or absent uses the library
+			 * default.
+			 */
+			static const std::string BTREECACHESIZEPROPERTY;
+			/**
+			 * @brief
+			 * The property string ``BTree Page Size''; optional.
+			 * @details
+			 * Bytes in each page of the B-trees.  Fixed when
+			 * the store is created.  0 or absent uses the
+			 * file system's block size.
+			 */
+			static const std::string BTREEPAGESIZEPROPERTY;
+			/**
+			 * @brief
+			 * The property string ``BTree Minimum Keys Per
+			 * Page''; optional.
+			 * @details
+			 * Minimum number of keys stored on each page of the
+			 * B-trees.  Fixed when the store is created.  0 or
+			 * absent uses the library default.
+			 */
+			static const std::string BTREEMINKEYSPROPERTY;
 
 			/**
 			 * Create a new DBRecordStore, read/write mode.
@@ -46,6 +78,38 @@ namespace BiometricEvaluation {
 			    const std::string &pathname,
 			    const std::string &description);
 
+			/**
+			 * Create a new DBRecordStore with tuned B-trees,
+			 * read/write mode.
+			 *
+			 * @param[in] pathname
+			 *	The directory where the store will be created.
+			 * @param[in] description
+			 *	The store's description.
+			 * @param[in] cacheSize
+			 *	Value of BTREECACHESIZEPROPERTY.
+			 * @param[in] pageSize
+			 *	Value of BTREEPAGESIZEPROPERTY; 0, or a power
+			 *	of 2 from 512 to 65536.
+			 * @param[in] minKeysPerPage
+			 *	Value of BTREEMINKEYSPROPERTY; 0, or at
+			 *	least 2.
+			 *
+			 * @throw Error::ObjectExists
+			 * 	The store already exists.
+			 * @throw Error::ParameterError
+			 *	pageSize or minKeysPerPage is invalid.
+			 * @throw Error::StrategyError
+			 * 	An error occurred when accessing the underlying
+			 * 	file system.
+			 */
+			DBRecordStore(
+			    const std::string &pathname,
+			    const std::string &description,
+			    uint32_t cacheSize,
+			    uint32_t pageSize,
+			    uint32_t minKeysPerPage = 0);
+
 			/**
 			 * Open an existing DBRecordStore.
 			 *
@@ -90,6 +154,38 @@ namespace BiometricEvaluation {
 			    const uint64_t size)
 			    override;
 
+			/**
+			 * @brief
+			 * Insert many records whose keys are in ascending
+			 * order.
+			 * @details
+			 * Appending presorted keys lets the B-tree fill each
+			 * leaf page in turn instead of searching for and
+			 * splitting pages at random, so loading a large
+			 * store is much faster than inserting the same
+			 * records in random order.  Large loads may be
+			 * split across several calls; loading is fastest
+			 * when each call's keys follow those of the last.
+			 *
+			 * @param[in] records
+			 *	Records to insert, with keys in strictly
+			 *	ascending byte order.
+			 *
+			 * @throw Error::ObjectExists
+			 *	A record with one of the keys already exists.
+			 *	Nothing has been inserted.
+			 * @throw Error::ParameterError
+			 *	Keys are not in strictly ascending order.
+			 *	Nothing has been inserted.
+			 * @throw Error::StrategyError
+			 *	The store is read-only, a key is invalid, or
+			 *	an error occurred when using the underlying
+			 *	storage system.
+			 */
+			void
+			insertSorted(
+			    const std::vector<RecordStore::Record> &records);
+
 			void remove(
 			    const std::string &key)
 			    override;
@@ -40,6 +40,8 @@ namespace BiometricEvaluation {
 			 *	The directory where the store is to be created.
 			 * @param[in] description
 			 *	The store's description.
+			 * @param[in] concurrency
+			 *	Whether the object may be shared by threads.
 			 * @throw  Error::ObjectExists
 			 *	The store already exists.
 			 * @throw Error::StrategyError
@@ -48,7 +50,9 @@ namespace BiometricEvaluation {
 			 */
 			FileRecordStore(
 			    const std::string &pathname,
-			    const std::string &description);
+			    const std::string &description,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
 
 			/**
 			 * Open an existing FileRecordStore.
@@ -57,6 +61,8 @@ namespace BiometricEvaluation {
 			 *	The path name of the store.
 			 * @param[in] mode
 			 *	Open mode, read-only or read-write.
+			 * @param[in] concurrency
+			 *	Whether the object may be shared by threads.
 			 *
 			 * @throw Error::ObjectDoesNotExist
 			 *	The store does not exist.
@@ -66,7 +72,9 @@ namespace BiometricEvaluation {
 			 */
 			FileRecordStore(
 			    const std::string &name,
-			    IO::Mode mode = IO::Mode::ReadOnly);
+			    IO::Mode mode = IO::Mode::ReadOnly,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
 
 			~FileRecordStore();
 
@@ -118,6 +126,16 @@ namespace BiometricEvaluation {
 			    const std::string &key)
 			    override;
 
+			std::string
+			nextKey(
+			    const std::string &key)
+			    override;
+
+			RecordStore::Concurrency
+			getConcurrency()
+			    const
+			    override;
+
 			void move(
 			    const std::string &pathname)
 			    override;
@@ -11,6 +11,7 @@
 #ifndef __BE_IO_GZIP__
 #define __BE_IO_GZIP__
 
+#include <memory>
 #include <string>
 #include <zlib.h>
 
@@ -26,6 +27,14 @@ namespace BiometricEvaluation
 		/**
 		 * @brief
 		 * Compressor for gzip compression from zlib.
+		 * @details
+		 * When the BLOCK_SIZE option is set, buffers larger than it
+		 * are split into blocks that are compressed on THREAD_COUNT
+		 * threads, each as its own gzip member.  The concatenated
+		 * members are a valid gzip stream, readable by gzip(1).  The
+		 * header of each member carries an extra field (subfield ID
+		 * "BE") holding the member's compressed size, so that buffers
+		 * of such members are also decompressed on several threads.
 		 */
 		class GZip : public Compressor
 		{
@@ -47,9 +56,24 @@ namespace BiometricEvaluation
 			static const std::string MEMORY_LEVEL;
 			/** How many bytes to work at a time */
 			static const std::string CHUNK_SIZE;
+			/**
+			 * Buffers larger than this many bytes are compressed
+			 * as independent blocks on several threads (0 to
+			 * always compress as a single stream, the default)
+			 */
+			static const std::string BLOCK_SIZE;
+			/**
+			 * Threads used for blocks (0 for one per core; 1 by
+			 * default)
+			 */
+			static const std::string THREAD_COUNT;
 
 			GZip();
 
+			/* Overloads taking a Memory::ByteView */
+			using Compressor::compress;
+			using Compressor::decompress;
+
 			Memory::uint8Array
 			compress(
 			    const uint8_t *const uncompressedData,
@@ -93,6 +117,37 @@ namespace BiometricEvaluation
 			    const Memory::uint8Array &compressedData)
 			    const;
 
+			/**
+			 * @brief
+			 * Decompress a compressed buffer into a buffer of known
+			 * size.
+			 * @details
+			 * The data is inflated directly into uncompressedData,
+			 * without any intermediate buffer.
+			 *
+			 * @param compressedData
+			 *	Compressed data buffer to decompress.
+			 * @param compressedDataSize
+			 *	Size of compressedData.
+			 * @param uncompressedData
+			 *	Buffer that will hold the decompressed data.
+			 * @param uncompressedDataSize
+			 *	Size of the decompressed data, and of
+			 *	uncompressedData.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error in decompression unit, or decompressed
+			 *	data is not exactly uncompressedDataSize
+			 *	bytes.
+			 */
+			void
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize,
+			    uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize)
+			    const;
+
 			Memory::uint8Array
 			decompress(
 			    const std::string &input)
@@ -146,16 +201,31 @@ namespace BiometricEvaluation
 			operator=(
 			    const GZip& other) = delete;
 
+		protected:
+			/**
+			 * @brief
+			 * Refresh cached option values and discard cached
+			 * zlib streams.
+			 *
+			 * @param optionName
+			 *	Name of the option that changed.
+			 */
+			void
+			optionChanged(
+			    const std::string &optionName)
+			    override;
+
 		private:
 			/**
 			 * @brief
 			 * Initialize compression stream.
 			 * 
-			 * @return
-			 *	Initialized zlib stream.
+			 * @param[out] strm
+			 *	Zlib struct to initialize in place.
 			 */
-			z_stream
-			initCompressionStream()
+			void
+			initCompressionStream(
+			    z_stream &strm)
 			    const;
 			    
 			/**
@@ -195,11 +265,12 @@ namespace BiometricEvaluation
 			 * @brief
 			 * Initialize decompression stream.
 			 * 
-			 * @return
-			 *	Initialized zlib stream.
+			 * @param[out] strm
+			 *	Zlib struct to initialize in place.
 			 */
-			z_stream
-			initDecompressionStream()
+			void
+			initDecompressionStream(
+			    z_stream &strm)
 			    const;
 			    
 			/**
@@ -234,6 +305,11 @@ namespace BiometricEvaluation
 
 			/** Add GZIP to window size to produce gzip header */
 			static const uint8_t GZIP_WBITS_MAGIC = 16;
+
+			/** Option values and reusable zlib streams */
+			struct Streams;
+			/** Reused state, shared by const methods */
+			std::unique_ptr<Streams> _streams;
 		};
 	}
 }
@@ -17,6 +17,7 @@
 #include <be_framework_enumeration.h>
 #include <be_io.h>
 #include <be_memory_autoarray.h>
+#include <be_memory_byteview.h>
 
 /*
  * This file contains the class declaration for the RecordStore, a virtual
@@ -88,10 +89,27 @@ namespace BiometricEvaluation {
 				Compressed,
 				/** ListRecordStore */
 				List,
+				/** ShardedRecordStore */
+				Sharded,
 
 				/** "Default" RecordStore kind */
 				Default = BerkeleyDB
 			};
+
+			/** Whether a RecordStore may be shared by threads */
+			enum class Concurrency
+			{
+				/** Object is used by one thread at a time */
+				Exclusive,
+				/**
+				 * Object may be used by any number of reading
+				 * threads while one thread inserts, replaces,
+				 * and removes records.  Supported by
+				 * ArchiveRecordStore, FileRecordStore, and
+				 * SQLiteRecordStore.
+				 */
+				Shared
+			};
 			
 			/**
 			 * The set of prohibited characters in a key:
@@ -222,6 +240,28 @@ namespace BiometricEvaluation {
 			    const void *const data,
 			    const uint64_t size) = 0;
 
+			/**
+			 * Insert a record into the store without first
+			 * copying it into a uint8Array.
+			 *
+			 * @param[in] key
+			 *	The key of the record to be inserted.
+			 * @param[in] data
+			 *	The data for the record.
+			 *
+			 * @throw Error::ObjectExists
+			 *	A record with the given key is already
+			 *	present.
+			 * @throw Error::StrategyError
+			 *	The RecordStore is opened read-only, or
+			 *	an error occurred when using the underlying
+			 *	storage system.
+			 */
+			void
+			insert(
+			    const std::string &key,
+			    Memory::ByteView data);
+
 			/**
 			 * Remove a record from the store.
 			 *
@@ -298,6 +338,27 @@ namespace BiometricEvaluation {
 			    const void *const data,
 			    const uint64_t size);
 
+			/**
+			 * Replace a complete record in a RecordStore without
+			 * first copying it into a uint8Array.
+			 *
+			 * @param[in] key
+			 *	The key of the record to be replaced.
+			 * @param[in] data
+			 *	The data for the record.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 *	A record for the key does not exist.
+			 * @throw Error::StrategyError
+			 *	The RecordStore is opened read-only, or
+			 *	an error occurred when using the underlying
+			 *	storage system.
+			 */
+			void
+			replace(
+			    const std::string &key,
+			    Memory::ByteView data);
+
 			/**
 			 * Return the length of a record.
 			 *
@@ -408,6 +469,44 @@ namespace BiometricEvaluation {
 			virtual void setCursorAtKey(
 			    const std::string &key) = 0;
 
+			/**
+			 * @brief
+			 * Obtain the key that follows another key in
+			 * sequence order.
+			 * @details
+			 * Unlike sequenceKey(), this method keeps no state,
+			 * so each caller (e.g., each RecordStoreIterator)
+			 * holds its own position in the sequence.  The
+			 * implementations in RecordStores that support
+			 * Concurrency::Shared do not use or modify the
+			 * cursor used by sequence(), and may be called from
+			 * several threads at once.  Other implementations
+			 * move that cursor.
+			 *
+			 * @param[in] key
+			 *	The key of a record in the RecordStore, or
+			 *	the empty string to obtain the first key.
+			 * @return
+			 *	The key sequenced after key.
+			 * @throw Error::ObjectDoesNotExist
+			 *	key is not in the RecordStore, or no
+			 *	record follows key.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			virtual std::string
+			nextKey(
+			    const std::string &key);
+
+			/**
+			 * @return
+			 *	Whether this object may be shared by threads.
+			 */
+			virtual Concurrency
+			getConcurrency()
+			    const;
+
 			/**
 			 * @brief
 			 * Determines whether the RecordStore contains an
@@ -453,17 +552,22 @@ namespace BiometricEvaluation {
 			 * @param[in] mode
 			 *	The type of access a client of this 
 			 *	RecordStore has.
+			 * @param[in] concurrency
+			 *	Whether the returned object may be shared
+			 *	by threads.
 			 * @return
 			 *	An object representing the existing store.
 			 * @throw Error::ObjectDoesNotExist
 			 *	The RecordStore does not exist.
 			 * @throw Error::StrategyError
 			 *	An error occurred when using the underlying
-			 *	storage system.
+			 *	storage system, or the kind of RecordStore
+			 *	does not support concurrency.
 			 */
 			static std::shared_ptr<RecordStore> openRecordStore(
 			    const std::string &pathname,
-			    IO::Mode mode = Mode::ReadOnly);
+			    IO::Mode mode = Mode::ReadOnly,
+			    Concurrency concurrency = Concurrency::Exclusive);
 
 			/**
 			 * @brief
@@ -480,6 +584,9 @@ namespace BiometricEvaluation {
 			 *	The description of the store to be created.
 			 * @param[in] kind
 			 *	The kind of RecordStore to be created.
+			 * @param[in] concurrency
+			 *	Whether the returned object may be shared
+			 *	by threads.
 			 * @return
 			 *	An managed pointer to the object representing
 			 *	the created store.
@@ -487,12 +594,14 @@ namespace BiometricEvaluation {
 			 *	The RecordStore does not exist.
 			 * @throw Error::StrategyError
 			 *	An error occurred when using the underlying
-			 *	storage system.
+			 *	storage system, or kind does not support
+			 *	concurrency.
 			 */
 			static std::shared_ptr<RecordStore> createRecordStore(
 			    const std::string &pathname,
 			    const std::string &description,
-			    const IO::RecordStore::Kind &kind);
+			    const IO::RecordStore::Kind &kind,
+			    Concurrency concurrency = Concurrency::Exclusive);
 
 			/**
 			 * Remove a RecordStore by deleting all persistant
@@ -552,8 +661,12 @@ namespace BiometricEvaluation {
 		 * Modifying a non-const iterator does not manipulate the
 		 * underlying RecordStore.
 		 * @note
-		 * This generic iterator provides no optimization over
-		 * RecordStore::sequence().
+		 * Each iterator keeps its own position, using
+		 * RecordStore::nextKey(), so iterators do not disturb
+		 * each other or RecordStore::sequence().  Iterators
+		 * over a RecordStore opened with
+		 * RecordStore::Concurrency::Shared may be used on
+		 * different threads at once.
 		 */
 		class RecordStoreIterator
 		{
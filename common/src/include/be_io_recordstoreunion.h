@@ -182,6 +182,8 @@ namespace BiometricEvaluation
 			 * @note
 			 * Exceptions are thrown after read() has been called
 			 * on all member RecordStores.
+			 * @note
+			 * Member RecordStores are read concurrently.
 			 */
 			std::map<const std::string,
 			BiometricEvaluation::Memory::uint8Array>
@@ -210,12 +212,63 @@ namespace BiometricEvaluation
 			 * @note
 			 * Exceptions are thrown after length() has been called
 			 * on all member RecordStores.
+			 * @note
+			 * Member RecordStores are queried concurrently.
 			 */
 			std::map<const std::string, uint64_t>
 			length(
 			    const std::string &key)
 			    const;
 
+			/**
+			 * @brief
+			 * Read a key from member RecordStores without
+			 * throwing when the key is missing.
+			 *
+			 * @param key
+			 * The key to read.
+			 *
+			 * @return
+			 * Map of RecordStore name to data read from said
+			 * RecordStore. Empty if key does not exist in any
+			 * member RecordStore.
+			 *
+			 * @throw Error::StrategyError
+			 * Exceptions propagated from RecordStore, with the
+			 * exception of ObjectDoesNotExist.
+			 */
+			std::map<const std::string,
+			BiometricEvaluation::Memory::uint8Array>
+			tryRead(
+			    const std::string &key)
+			    const;
+
+			/**
+			 * @brief
+			 * Record the keys of every member RecordStore so
+			 * that lookups skip members that cannot contain a
+			 * key.
+			 * @details
+			 * Each member is sequenced once to build a compact
+			 * filter of its keys. Afterwards, read(), tryRead(),
+			 * and length() only consult members whose filter
+			 * admits the key, and consult those concurrently.
+			 * PersistentRecordStoreUnion builds and saves
+			 * filters automatically.
+			 *
+			 * @throw Error::StrategyError
+			 * Error sequencing a member RecordStore.
+			 *
+			 * @note
+			 * The sequence cursor of each member RecordStore is
+			 * left at the end of the RecordStore.
+			 * @note
+			 * Filters are not updated if member RecordStores
+			 * are modified through other handles.
+			 */
+			void
+			buildKeyFilters();
+
 			/* Prevent copying of RecordStoreUnion objects */
 			RecordStoreUnion(const RecordStoreUnion&) = delete;
 			RecordStoreUnion& operator=(const RecordStoreUnion&)
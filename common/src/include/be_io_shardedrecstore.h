@@ -0,0 +1,336 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_IO_SHARDEDRECSTORE_H__
+#define __BE_IO_SHARDEDRECSTORE_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <be_io_recordstore.h>
+
+namespace BiometricEvaluation
+{
+	namespace IO
+	{
+		/**
+		 * @brief
+		 * A RecordStore that partitions its records across several
+		 * sibling RecordStores.
+		 * @details
+		 * Each record is stored in exactly one shard, chosen by a
+		 * hash of its key that does not depend on the platform, so
+		 * callers never need to know which shard holds a key.
+		 * Shards may be any kind of RecordStore that can be
+		 * created, and each lives in its own directory, which may
+		 * be outside of the ShardedRecordStore's directory (e.g.,
+		 * to spread a large store across several disks).
+		 *
+		 * Every shard keeps its own sequence cursor, so the shards
+		 * obtained from getShard() can be scanned in parallel by
+		 * separate threads or processes.
+		 *
+		 * @see MPI::RecordStoreDistributor
+		 */
+		class ShardedRecordStore : public RecordStore
+		{
+		public:
+			/** Number of shards when none is specified */
+			static const uint32_t DEFAULT_SHARD_COUNT = 8;
+
+			/**
+			 * Create a new ShardedRecordStore, read/write mode.
+			 *
+			 * @param[in] pathname
+			 *	The directory where the store is to be created.
+			 * @param[in] description
+			 *	The store's description.
+			 * @param[in] shardKind
+			 *	The kind of RecordStore each shard should be.
+			 * @param[in] shardCount
+			 *	The number of shards.
+			 * @param[in] shardPathnames
+			 *	The directory where each shard is to be
+			 *	created.  When empty, shards are created
+			 *	within pathname.  Otherwise, must contain
+			 *	shardCount pathnames.
+			 * @param[in] concurrency
+			 *	Whether the object may be shared by threads.
+			 *	Shards are opened with the same concurrency.
+			 *
+			 * @throw Error::ObjectExists
+			 *	The store or one of its shards already exists.
+			 * @throw Error::ParameterError
+			 *	shardCount is 0, or shardPathnames does not
+			 *	contain shardCount pathnames.
+			 * @throw Error::StrategyError
+			 *	An error occurred when accessing the underlying
+			 *	file system, or shardKind cannot be used with
+			 *	concurrency.
+			 */
+			ShardedRecordStore(
+			    const std::string &pathname,
+			    const std::string &description,
+			    const RecordStore::Kind &shardKind,
+			    uint32_t shardCount = DEFAULT_SHARD_COUNT,
+			    const std::vector<std::string> &shardPathnames =
+			    {},
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
+
+			/**
+			 * Open an existing ShardedRecordStore.
+			 *
+			 * @param[in] pathname
+			 *	The path name of the store.
+			 * @param[in] mode
+			 *	Open mode, read-only or read-write.
+			 * @param[in] concurrency
+			 *	Whether the object may be shared by threads.
+			 *	Shards are opened with the same concurrency.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 *	The store or one of its shards does not exist.
+			 * @throw Error::StrategyError
+			 *	An error occurred when accessing the underlying
+			 *	file system.
+			 */
+			ShardedRecordStore(
+			    const std::string &pathname,
+			    IO::Mode mode = IO::Mode::ReadOnly,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
+
+			/*
+			 * Destructor.
+			 */
+			~ShardedRecordStore();
+
+			/**
+			 * @return
+			 *	The number of shards.
+			 */
+			uint32_t
+			getShardCount()
+			    const;
+
+			/**
+			 * @return
+			 *	The kind of RecordStore of each shard.
+			 */
+			RecordStore::Kind
+			getShardKind()
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain the shard that holds, or would hold, a key.
+			 *
+			 * @param[in] key
+			 *	The key of a record.
+			 *
+			 * @return
+			 *	Index of the shard for key.
+			 */
+			uint32_t
+			getShardIndex(
+			    const std::string &key)
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain one shard.
+			 * @details
+			 * The shard may be read and sequenced independently
+			 * of the other shards.
+			 *
+			 * @param[in] index
+			 *	Index of the shard, less than getShardCount().
+			 *
+			 * @return
+			 *	The shard at index.
+			 *
+			 * @throw Error::ParameterError
+			 *	index is out of range.
+			 *
+			 * @warning
+			 * Records must only be inserted and removed through
+			 * the ShardedRecordStore.
+			 */
+			std::shared_ptr<RecordStore>
+			getShard(
+			    uint32_t index)
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain the location of one shard.
+			 *
+			 * @param[in] index
+			 *	Index of the shard, less than getShardCount().
+			 *
+			 * @return
+			 *	Path name of the shard at index.
+			 *
+			 * @throw Error::ParameterError
+			 *	index is out of range.
+			 */
+			std::string
+			getShardPathname(
+			    uint32_t index)
+			    const;
+
+			/**
+			 * @brief
+			 * Repartition the records among a new set of shards.
+			 * @details
+			 * Records are copied into newly-created shards, the
+			 * store's control file is switched to the new shards,
+			 * and only then are the old shards removed, so the
+			 * store is left intact if copying fails.  The store
+			 * stays open throughout; when shared by threads,
+			 * other callers wait until resharding completes.
+			 *
+			 * @param[in] shardCount
+			 *	The new number of shards.
+			 * @param[in] shardPathnames
+			 *	The directory where each new shard is to be
+			 *	created.  When empty, shards are created
+			 *	within the store's directory.  Otherwise, must
+			 *	contain shardCount pathnames, none of which
+			 *	may be the location of a current shard.
+			 *
+			 * @throw Error::ObjectExists
+			 *	One of shardPathnames already exists.
+			 * @throw Error::ParameterError
+			 *	shardCount is 0, or shardPathnames does not
+			 *	contain shardCount pathnames.
+			 * @throw Error::StrategyError
+			 *	The store is read-only, or an error occurred
+			 *	when using the underlying storage system.
+			 */
+			void
+			reshard(
+			    uint32_t shardCount,
+			    const std::vector<std::string> &shardPathnames =
+			    {});
+
+			/*
+			 * Implementation of the RecordStore interface.
+			 */
+
+			/*
+			 * We need the base class insert() and replace() as well
+			 * otherwise, they are hidden by the declarations below.
+			 */
+			using RecordStore::insert;
+			using RecordStore::replace;
+
+			uint64_t
+			getSpaceUsed() const override;
+			void sync() const override;
+			unsigned int getCount() const override;
+			std::string getPathname() const override;
+			std::string getDescription() const override;
+			void changeDescription(
+			    const std::string &description) override;
+
+			void
+			insert(
+			    const std::string &key,
+			    const void *const data,
+			    const uint64_t size)
+			    override;
+
+			void
+			remove(
+			    const std::string &key) override;
+
+			Memory::uint8Array
+			read(
+			    const std::string &key) const override;
+
+			uint64_t
+			length(
+			    const std::string &key) const override;
+
+			void
+			flush(
+			    const std::string &key) const override;
+
+			RecordStore::Record
+			sequence(
+			    int cursor = BE_RECSTORE_SEQ_NEXT)
+			    override;
+
+			std::string
+			sequenceKey(
+			    int cursor = BE_RECSTORE_SEQ_NEXT)
+			    override;
+
+			void
+			setCursorAtKey(
+			    const std::string &key)
+			    override;
+
+			std::string
+			nextKey(
+			    const std::string &key)
+			    override;
+
+			RecordStore::Concurrency
+			getConcurrency()
+			    const
+			    override;
+
+			void
+			move(
+			    const std::string &pathname)
+			    override;
+
+			/**
+			 * @brief
+			 * Copy constructor (disabled).
+			 * @details
+			 * Disabled because this object could represent a
+			 * file on disk.
+			 *
+			 * @param rhs
+			 *	ShardedRecordStore object to copy.
+			 */
+			ShardedRecordStore(
+			    const ShardedRecordStore &rhs) = delete;
+
+			/**
+			 * @brief
+			 * Assignment operator (disabled).
+			 * @details
+			 * Disabled because this object could represent a
+			 * file on disk.
+			 *
+			 * @param rhs
+			 *	ShardedRecordStore object to assign.
+			 *
+			 * @return
+			 *	ShardedRecordStore object, now containing
+			 *	the contents of rhs.
+			 */
+			ShardedRecordStore&
+			operator=(
+			    const ShardedRecordStore &rhs) = delete;
+
+		private:
+			class Impl;
+			std::unique_ptr<ShardedRecordStore::Impl> pimpl;
+		};
+	}
+}
+#endif	/* __BE_IO_SHARDEDRECSTORE_H__ */
@@ -27,11 +27,21 @@ namespace BiometricEvaluation
 		public:
 			SQLiteRecordStore(
 			    const std::string &pathname,
-			    const std::string &description);
+			    const std::string &description,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
 
+			/*
+			 * With Concurrency::Shared, each reading thread
+			 * uses a connection of its own, and read/write
+			 * databases use write-ahead logging so that readers
+			 * are not blocked by the writer.
+			 */
 			SQLiteRecordStore(
 			    const std::string &pathname,
-			    IO::Mode mode = Mode::ReadOnly);
+			    IO::Mode mode = Mode::ReadOnly,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
 
 			/*
                          * We need the base class insert() and replace() as well
@@ -97,6 +107,16 @@ namespace BiometricEvaluation
 			    const std::string &key)
 			    override;
 
+			std::string
+			nextKey(
+			    const std::string &key)
+			    override;
+
+			RecordStore::Concurrency
+			getConcurrency()
+			    const
+			    override;
+
 			~SQLiteRecordStore();
 
 			SQLiteRecordStore(const SQLiteRecordStore&) = delete;
@@ -15,6 +15,7 @@
 #include <cstdint>
 #include <fstream>
 #include <string>
+#include <vector>
 
 #include <be_error_exception.h>
 #include <be_memory_autoarray.h>
@@ -152,6 +153,30 @@ namespace BiometricEvaluation
 			uint64_t
 			sumDirectoryUsage(const std::string &pathname);
 
+			/**
+			 * Obtain a value that changes when the files in a
+			 * directory change.
+			 *
+			 * @param[in] pathname
+			 *	The name of the directory.
+			 * @param[in] excluded
+			 *	Paths, relative to pathname, of files whose
+			 *	changes are ignored.
+			 * @return
+			 * 	A hash of the relative path, size, and
+			 *	modification time of every file in pathname
+			 *	and its subdirectories.
+			 * @throw Error::ObjectDoesNotExist
+			 *	The named directory does not exist.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system, or pathname is malformed.
+			 */
+			uint64_t
+			getDirectoryFingerprint(
+			    const std::string &pathname,
+			    const std::vector<std::string> &excluded = {});
+
 			/**
 			 * Indicate whether a file exists.
 			 *
@@ -0,0 +1,429 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_MEMORY_ALLOCATOR_H__
+#define __BE_MEMORY_ALLOCATOR_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace BiometricEvaluation
+{
+	namespace Memory
+	{
+		/** Counts of an Allocator's activity. */
+		struct AllocatorStatistics
+		{
+			/** Calls to allocate() */
+			uint64_t allocations{0};
+			/** Calls to deallocate() */
+			uint64_t deallocations{0};
+			/** Bytes requested from allocate() */
+			uint64_t bytesAllocated{0};
+			/**
+			 * Allocations that required memory from the system,
+			 * rather than memory that was pooled or preallocated
+			 */
+			uint64_t systemAllocations{0};
+		};
+
+		/**
+		 * @brief
+		 * Source of memory for AutoArray and other containers.
+		 * @details
+		 * Every AutoArray holds a pointer to the Allocator that
+		 * provided its storage, and returns its storage to that
+		 * Allocator.  An AutoArray constructed without an Allocator
+		 * uses getDefault(), which can be changed for the process or,
+		 * with ScopedDefaultAllocator, for the calling thread.
+		 * Allocators must outlive the memory they provide.
+		 */
+		class Allocator
+		{
+		public:
+			/**
+			 * @brief
+			 * Obtain memory.
+			 *
+			 * @param size
+			 *	Number of bytes, greater than 0.
+			 * @param alignment
+			 *	Required alignment of the memory, a power
+			 *	of 2.
+			 *
+			 * @return
+			 *	Pointer to at least size bytes.
+			 *
+			 * @throw Error::MemoryError
+			 *	Could not obtain memory.
+			 */
+			void*
+			allocate(
+			    size_t size,
+			    size_t alignment = alignof(std::max_align_t));
+
+			/**
+			 * @brief
+			 * Return memory obtained from allocate().
+			 *
+			 * @param pointer
+			 *	Value returned from allocate().
+			 * @param size
+			 *	size passed to allocate().
+			 * @param alignment
+			 *	alignment passed to allocate().
+			 */
+			void
+			deallocate(
+			    void *pointer,
+			    size_t size,
+			    size_t alignment = alignof(std::max_align_t))
+			    noexcept;
+
+			/**
+			 * @return
+			 * Counts of this Allocator's activity.
+			 */
+			AllocatorStatistics
+			getStatistics()
+			    const;
+
+			/** Set all counts of activity to 0. */
+			void
+			resetStatistics();
+
+			/**
+			 * @brief
+			 * Obtain the Allocator used by containers constructed
+			 * without one.
+			 *
+			 * @return
+			 *	The calling thread's default Allocator, if set
+			 *	with ScopedDefaultAllocator, otherwise the
+			 *	process default Allocator.
+			 */
+			static Allocator&
+			getDefault();
+
+			/**
+			 * @brief
+			 * Change the process default Allocator.
+			 *
+			 * @param allocator
+			 *	New process default Allocator, which must live
+			 *	until the end of the process, or nullptr for
+			 *	NewAllocator.
+			 */
+			static void
+			setDefault(
+			    Allocator *allocator);
+
+			virtual ~Allocator() = default;
+
+		protected:
+			Allocator() = default;
+
+			/**
+			 * @brief
+			 * Obtain memory.
+			 * @details
+			 * Implementations call countSystemAllocation() when
+			 * memory came from the system.
+			 *
+			 * @throw Error::MemoryError
+			 *	Could not obtain memory.
+			 */
+			virtual void*
+			doAllocate(
+			    size_t size,
+			    size_t alignment) = 0;
+
+			/** Return memory obtained from doAllocate(). */
+			virtual void
+			doDeallocate(
+			    void *pointer,
+			    size_t size,
+			    size_t alignment)
+			    noexcept = 0;
+
+			/** Count an allocation that required system memory */
+			void
+			countSystemAllocation();
+
+			/**
+			 * @brief
+			 * Obtain memory from the system.
+			 *
+			 * @throw Error::MemoryError
+			 *	Could not obtain memory.
+			 */
+			static void*
+			systemAllocate(
+			    size_t size,
+			    size_t alignment);
+
+			/** Return memory obtained from systemAllocate() */
+			static void
+			systemDeallocate(
+			    void *pointer)
+			    noexcept;
+
+		private:
+			Allocator(const Allocator&) = delete;
+			Allocator& operator=(const Allocator&) = delete;
+
+			std::atomic<uint64_t> _allocations{0};
+			std::atomic<uint64_t> _deallocations{0};
+			std::atomic<uint64_t> _bytesAllocated{0};
+			std::atomic<uint64_t> _systemAllocations{0};
+		};
+
+		/**
+		 * @brief
+		 * Allocator obtaining every allocation from the system.
+		 * @details
+		 * The process default Allocator, unless changed.
+		 */
+		class NewAllocator : public Allocator
+		{
+		public:
+			/** @return Process-wide instance */
+			static NewAllocator&
+			instance();
+
+		protected:
+			void*
+			doAllocate(
+			    size_t size,
+			    size_t alignment)
+			    override;
+
+			void
+			doDeallocate(
+			    void *pointer,
+			    size_t size,
+			    size_t alignment)
+			    noexcept override;
+		};
+
+		/**
+		 * @brief
+		 * Allocator reusing freed memory through per-thread pools.
+		 * @details
+		 * Requests are rounded up to a power of two (at least
+		 * MIN_POOLED_SIZE bytes) and, once freed, kept in a pool
+		 * belonging to the freeing thread for the next request of the
+		 * same size class on that thread.  No locks are taken.  Each
+		 * thread pools at most MAX_POOLED_PER_CLASS buffers per class
+		 * and MAX_POOLED_BYTES bytes in total; requests larger than
+		 * MAX_POOLED_SIZE go to the system.  All memory is aligned to
+		 * at least CACHE_LINE_SIZE bytes.  Pools are released when
+		 * their thread exits.
+		 */
+		class PoolAllocator : public Allocator
+		{
+		public:
+			/** Smallest size class */
+			static const size_t MIN_POOLED_SIZE = 64;
+			/** Largest size class */
+			static const size_t MAX_POOLED_SIZE = 16 * 1024 * 1024;
+			/** Most free buffers pooled per thread per class */
+			static const size_t MAX_POOLED_PER_CLASS = 8;
+			/** Most bytes pooled per thread */
+			static const size_t MAX_POOLED_BYTES = 64 * 1024 * 1024;
+
+			/** @return Process-wide instance */
+			static PoolAllocator&
+			instance();
+
+		protected:
+			void*
+			doAllocate(
+			    size_t size,
+			    size_t alignment)
+			    override;
+
+			void
+			doDeallocate(
+			    void *pointer,
+			    size_t size,
+			    size_t alignment)
+			    noexcept override;
+		};
+
+		/**
+		 * @brief
+		 * Allocator handing out memory from large chunks, all of
+		 * which is released at once by reset().
+		 * @details
+		 * Allocation is a pointer increment and deallocation does
+		 * nothing, which suits the many short-lived buffers built
+		 * while processing one work package.  Not thread-safe.
+		 * Every container using an ArenaAllocator must be destroyed
+		 * before reset() or the ArenaAllocator's destruction.
+		 */
+		class ArenaAllocator : public Allocator
+		{
+		public:
+			/**
+			 * @brief
+			 * Constructor.
+			 *
+			 * @param chunkSize
+			 *	Bytes obtained from the system at a time.
+			 *	Larger requests are given a chunk of their
+			 *	own.
+			 */
+			explicit ArenaAllocator(
+			    size_t chunkSize = 1024 * 1024);
+
+			/**
+			 * @brief
+			 * Release all memory handed out.
+			 * @details
+			 * The largest chunk is kept for reuse.
+			 */
+			void
+			reset();
+
+			/** @return Bytes handed out since the last reset() */
+			size_t
+			getBytesInUse()
+			    const;
+
+			~ArenaAllocator();
+
+		protected:
+			void*
+			doAllocate(
+			    size_t size,
+			    size_t alignment)
+			    override;
+
+			void
+			doDeallocate(
+			    void *pointer,
+			    size_t size,
+			    size_t alignment)
+			    noexcept override;
+
+		private:
+			/** Memory obtained from the system */
+			struct Chunk
+			{
+				/** Start of the chunk */
+				uint8_t *data;
+				/** Size of the chunk */
+				size_t size;
+			};
+
+			/** Bytes obtained from the system at a time */
+			const size_t _chunkSize;
+			/** Chunks, the current chunk last */
+			std::vector<Chunk> _chunks;
+			/** Bytes used of the current chunk */
+			size_t _offset;
+			/** Bytes handed out since the last reset() */
+			size_t _bytesInUse;
+		};
+
+		/**
+		 * @brief
+		 * Allocator for memory aligned for SIMD kernels.
+		 * @details
+		 * Every allocation is aligned to at least the alignment given
+		 * at construction.  Large allocations can be aligned to huge
+		 * pages and, where supported, advised to use them.
+		 */
+		class AlignedAllocator : public Allocator
+		{
+		public:
+			/** Alignment that avoids splitting cache lines */
+			static const size_t CACHE_LINE_SIZE = 64;
+			/** Size of a (transparent) huge page */
+			static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+			/**
+			 * @brief
+			 * Constructor.
+			 *
+			 * @param alignment
+			 *	Minimum alignment of every allocation, a power
+			 *	of 2.
+			 * @param hugePages
+			 *	Whether allocations of at least HUGE_PAGE_SIZE
+			 *	bytes should be backed by huge pages.
+			 */
+			explicit AlignedAllocator(
+			    size_t alignment = CACHE_LINE_SIZE,
+			    bool hugePages = false);
+
+		protected:
+			void*
+			doAllocate(
+			    size_t size,
+			    size_t alignment)
+			    override;
+
+			void
+			doDeallocate(
+			    void *pointer,
+			    size_t size,
+			    size_t alignment)
+			    noexcept override;
+
+		private:
+			/** Minimum alignment of every allocation */
+			const size_t _alignment;
+			/** Whether to back large allocations by huge pages */
+			const bool _hugePages;
+		};
+
+		/**
+		 * @brief
+		 * Change the calling thread's default Allocator for the
+		 * lifetime of this object.
+		 * @details
+		 * Allows buffers built deep inside the framework (records
+		 * read from a RecordStore, decoded images, etc.) to come from
+		 * a pool or arena without changing any interfaces.
+		 */
+		class ScopedDefaultAllocator
+		{
+		public:
+			/**
+			 * @brief
+			 * Constructor.
+			 *
+			 * @param allocator
+			 *	Default Allocator for the calling thread until
+			 *	this object is destroyed.
+			 */
+			explicit ScopedDefaultAllocator(
+			    Allocator &allocator);
+
+			/** Restore the previous default Allocator. */
+			~ScopedDefaultAllocator();
+
+			ScopedDefaultAllocator(
+			    const ScopedDefaultAllocator&) = delete;
+			ScopedDefaultAllocator& operator=(
+			    const ScopedDefaultAllocator&) = delete;
+
+		private:
+			/** Thread default Allocator before this object */
+			Allocator *_previous;
+		};
+	}
+}
+
+#endif /* __BE_MEMORY_ALLOCATOR_H__ */
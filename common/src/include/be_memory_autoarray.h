@@ -20,11 +20,15 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <limits>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <be_error_exception.h>
+#include <be_memory_allocator.h>
 #include <be_memory_autoarrayiterator.h>
 
 namespace BiometricEvaluation
@@ -39,6 +43,9 @@ namespace BiometricEvaluation
 		 * manner for containers, where (size_type) construction creates
 		 * an array of the given size, while {...} construction creates
 		 * an array with the given elements.
+		 *
+		 * Storage is obtained from a Memory::Allocator, by default
+		 * Allocator::getDefault() at the time of construction.
 		 */
 		template<class T> 
 		class AutoArray
@@ -247,6 +254,43 @@ namespace BiometricEvaluation
 				size()
 				    const;
 
+				/**
+				 * @brief
+				 * Obtain the number of elements allocated.
+				 *
+				 * @return
+				 *	Number of elements that may be made
+				 *	accessible by resize() without
+				 *	allocating memory.
+				 */
+				size_type
+				capacity()
+				    const;
+
+				/**
+				 * @brief
+				 * Allocate storage for at least a number of
+				 * elements without changing size().
+				 *
+				 * @param[in] new_capacity
+				 *	Number of elements to allocate.
+				 *
+				 * @throw Error::MemoryError
+				 *	Problem allocating memory.
+				 */
+				void
+				reserve(
+				    size_type new_capacity);
+
+				/**
+				 * @return
+				 *	Allocator providing this AutoArray's
+				 *	storage.
+				 */
+				Allocator&
+				getAllocator()
+				    const;
+
 				/**
 				 * @brief
 				 * Change the number of accessible elements.
@@ -344,6 +388,25 @@ namespace BiometricEvaluation
 				explicit AutoArray(
 				    size_type size = 0);
 
+				/**
+				 * @brief
+				 * Construct an AutoArray whose storage is
+				 * provided by an Allocator.
+				 *
+				 * @param[in] size
+				 *	The number of elements this AutoArray
+				 *	should initially hold.
+				 * @param[in] allocator
+				 *	Source of storage for this AutoArray,
+				 *	which must outlive it.
+				 *
+				 * @throw Error::MemoryError
+				 *	Could not allocate new memory.
+				 */
+				AutoArray(
+				    size_type size,
+				    Allocator &allocator);
+
 				/**
 				 * @brief
 				 * Construct an AutoArray.
@@ -429,6 +492,49 @@ namespace BiometricEvaluation
 				~AutoArray();
 								
 			private:
+				/**
+				 * @brief
+				 * Allocate and construct elements.
+				 *
+				 * @param[in] allocator
+				 *	Source of storage.
+				 * @param[in] count
+				 *	Number of elements.
+				 *
+				 * @return
+				 *	Storage for count elements, or
+				 *	nullptr if count is 0.
+				 *
+				 * @throw Error::MemoryError
+				 *	Could not allocate new memory.
+				 */
+				static T*
+				allocateElements(
+				    Allocator &allocator,
+				    size_type count);
+
+				/**
+				 * @brief
+				 * Destroy and deallocate elements.
+				 *
+				 * @param[in] allocator
+				 *	allocator passed to
+				 *	allocateElements().
+				 * @param[in] data
+				 *	Value returned from
+				 *	allocateElements().
+				 * @param[in] count
+				 *	count passed to allocateElements().
+				 */
+				static void
+				deallocateElements(
+				    Allocator &allocator,
+				    T *data,
+				    size_type count)
+				    noexcept;
+
+				/** Source of storage for _data */
+				Allocator *_allocator;
 				/** The underlying C-array */
 				value_type *_data;
 				/** Advertised size of _data */
@@ -499,6 +605,71 @@ BiometricEvaluation::Memory::AutoArray<T>::size()
 	return (_size);
 }
 
+template<class T>
+typename BiometricEvaluation::Memory::AutoArray<T>::size_type
+BiometricEvaluation::Memory::AutoArray<T>::capacity()
+    const
+{
+	return (_capacity);
+}
+
+template<class T>
+BiometricEvaluation::Memory::Allocator&
+BiometricEvaluation::Memory::AutoArray<T>::getAllocator()
+    const
+{
+	return (*_allocator);
+}
+
+template<class T>
+T*
+BiometricEvaluation::Memory::AutoArray<T>::allocateElements(
+    Allocator &allocator,
+    size_type count)
+{
+	if (count == 0)
+		return (nullptr);
+	if (count > (std::numeric_limits<size_type>::max() / sizeof(T)))
+		throw Error::MemoryError("Could not allocate data");
+
+	T *data = static_cast<T*>(allocator.allocate(count * sizeof(T),
+	    std::max(alignof(T), alignof(std::max_align_t))));
+	if (std::is_trivial<T>::value)
+		return (data);
+
+	/* Default-initialize, as new T[count] would */
+	size_type constructed = 0;
+	try {
+		for (; constructed < count; constructed++)
+			new (&data[constructed]) T;
+	} catch (...) {
+		while (constructed > 0)
+			data[--constructed].~T();
+		allocator.deallocate(data, count * sizeof(T),
+		    std::max(alignof(T), alignof(std::max_align_t)));
+		throw;
+	}
+	return (data);
+}
+
+template<class T>
+void
+BiometricEvaluation::Memory::AutoArray<T>::deallocateElements(
+    Allocator &allocator,
+    T *data,
+    size_type count)
+    noexcept
+{
+	if (data == nullptr)
+		return;
+
+	if (!std::is_trivial<T>::value)
+		for (size_type i = 0; i < count; i++)
+			data[i].~T();
+	allocator.deallocate(data, count * sizeof(T),
+	    std::max(alignof(T), alignof(std::max_align_t)));
+}
+
 template<class T>
 void
 BiometricEvaluation::Memory::AutoArray<T>::resize(
@@ -511,24 +682,33 @@ BiometricEvaluation::Memory::AutoArray<T>::resize(
 		return;
 	}
 
-	T* new_data = nullptr;
-	if (new_size != 0) {
-		new_data = new (std::nothrow) T[new_size];
-		if (new_data == nullptr)
-			throw Error::MemoryError("Could not allocate data");
-	}
+	T *new_data = allocateElements(*_allocator, new_size);
 
-	/* Copy as much data as will fit into the new buffer */
-	std::copy(&_data[0], &_data[((new_size < _size) ? new_size : _size)],
+	/* Move as much data as will fit into the new buffer */
+	std::move(&_data[0], &_data[((new_size < _size) ? new_size : _size)],
 	    new_data);
 
 	/* Delete the old buffer and assign the new buffer to this object */
-	if (_data != nullptr)
-		delete [] _data;
+	deallocateElements(*_allocator, _data, _capacity);
 	_data = new_data;
 	_size = _capacity = new_size;
 }
 
+template<class T>
+void
+BiometricEvaluation::Memory::AutoArray<T>::reserve(
+    size_type new_capacity)
+{
+	if (new_capacity <= _capacity)
+		return;
+
+	T *new_data = allocateElements(*_allocator, new_capacity);
+	std::move(&_data[0], &_data[_size], new_data);
+	deallocateElements(*_allocator, _data, _capacity);
+	_data = new_data;
+	_capacity = new_capacity;
+}
+
 template<class T>
 void
 BiometricEvaluation::Memory::AutoArray<T>::copy(
@@ -628,19 +808,16 @@ BiometricEvaluation::Memory::AutoArray<T>::operator=(
     const BiometricEvaluation::Memory::AutoArray<T> &other)
 {
 	if (this != &other) {
-		_size = _capacity = other._size;
-		if (_data != nullptr) {
-			delete [] _data;
-			_data = nullptr;
-		}
-		if (_size != 0) {
-			_data = new (std::nothrow) T[_size];
-			if (_data == nullptr)
-				throw Error::MemoryError("Could not "
-				    "allocate data");
-			std::copy(&(other._data[0]), &(other._data[_size]),
-			    _data);
+		/* Reuse existing storage when it is large enough */
+		if (other._size > _capacity) {
+			T *new_data = allocateElements(*_allocator,
+			    other._size);
+			deallocateElements(*_allocator, _data, _capacity);
+			_data = new_data;
+			_capacity = other._size;
 		}
+		_size = other._size;
+		std::copy(&(other._data[0]), &(other._data[_size]), _data);
 	}
 
 	return (*this);
@@ -658,6 +835,7 @@ BiometricEvaluation::Memory::AutoArray<T>::operator=(
 {
 	using std::swap;
 
+	swap(_allocator, other._allocator);
 	swap(_size, other._size);
 	swap(_capacity, other._capacity);
 	swap(_data, other._data);
@@ -720,36 +898,36 @@ BiometricEvaluation::Memory::AutoArray<T>::cend()
 template<class T>
 BiometricEvaluation::Memory::AutoArray<T>::AutoArray(
     size_type size) :
-    _data(nullptr),
+    AutoArray(size, Allocator::getDefault())
+{
+
+}
+
+template<class T>
+BiometricEvaluation::Memory::AutoArray<T>::AutoArray(
+    size_type size,
+    Allocator &allocator) :
+    _allocator(&allocator),
+    _data(allocateElements(allocator, size)),
     _size(size),
     _capacity(size)
 {
-	if (_size != 0) {
-		_data = new (std::nothrow) T[_size];
-		if (_data == nullptr)
-			throw Error::MemoryError("Could not allocate data");
-	}
+
 }
 
 template<class T>
 BiometricEvaluation::Memory::AutoArray<T>::AutoArray(
     const AutoArray& copy) :
-    _data(nullptr),
-    _size(copy._size),
-    _capacity(copy._size)
-{
-	if (_size != 0) {
-		_data = new (std::nothrow) T[_size];
-		if (_data == nullptr)
-			throw Error::MemoryError("Could not allocate data");
-		std::copy(&(copy._data[0]), &(copy._data[_size]), _data);
-	}
+    AutoArray(copy._size)
+{
+	std::copy(&(copy._data[0]), &(copy._data[_size]), _data);
 }
 
 template<class T>
 BiometricEvaluation::Memory::AutoArray<T>::AutoArray(
     AutoArray &&rvalue)
     noexcept :
+    _allocator(rvalue._allocator),
     _data(rvalue._data),
     _size(rvalue._size),
     _capacity(rvalue._capacity)
@@ -773,8 +951,7 @@ BiometricEvaluation::Memory::AutoArray<T>::AutoArray(
 template<class T>
 BiometricEvaluation::Memory::AutoArray<T>::~AutoArray()
 {
-	if (_data != nullptr)
-		delete [] _data;
+	deallocateElements(*_allocator, _data, _capacity);
 }
 
 /******************************************************************************/
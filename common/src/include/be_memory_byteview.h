@@ -0,0 +1,235 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_MEMORY_BYTEVIEW_H__
+#define __BE_MEMORY_BYTEVIEW_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <be_memory_autoarray.h>
+
+namespace BiometricEvaluation
+{
+	namespace Memory
+	{
+		/**
+		 * @brief
+		 * A read-only view of a contiguous run of bytes owned by
+		 * someone else.
+		 * @details
+		 * ByteViews are two words in size and are intended to be
+		 * passed by value wherever a function only needs to read a
+		 * buffer, so that callers holding a uint8Array, a
+		 * std::vector, a SharedBuffer, or a pointer and size need
+		 * not copy their data into a uint8Array first.
+		 *
+		 * @warning
+		 * A ByteView does not keep its bytes alive. It must not
+		 * outlive the object it was constructed from, and is
+		 * invalidated by anything that reallocates that object
+		 * (e.g., AutoArray::resize()).
+		 */
+		class ByteView
+		{
+		public:
+			/** Type of element */
+			using value_type = uint8_t;
+			/** Type of subscripts, counts, etc. */
+			using size_type = size_t;
+			/** Iterator of element */
+			using const_iterator = const uint8_t*;
+
+			/** View of nothing. */
+			ByteView() noexcept :
+			    _data(nullptr),
+			    _size(0)
+			{
+
+			}
+
+			/**
+			 * @brief
+			 * View a buffer.
+			 *
+			 * @param data
+			 *	Start of the bytes to view.
+			 * @param size
+			 *	Number of bytes to view.
+			 */
+			ByteView(
+			    const uint8_t *data,
+			    size_type size)
+			    noexcept :
+			    _data(data),
+			    _size(size)
+			{
+
+			}
+
+			/**
+			 * @brief
+			 * View the accessible elements of an AutoArray.
+			 *
+			 * @param array
+			 *	AutoArray to view.
+			 */
+			ByteView(
+			    const uint8Array &array)
+			    noexcept :
+			    _data(array),
+			    _size(array.size())
+			{
+
+			}
+
+			/**
+			 * @brief
+			 * View the elements of a vector.
+			 *
+			 * @param vector
+			 *	Vector to view.
+			 */
+			ByteView(
+			    const std::vector<uint8_t> &vector)
+			    noexcept :
+			    _data(vector.data()),
+			    _size(vector.size())
+			{
+
+			}
+
+			/** @return Start of the viewed bytes */
+			const uint8_t*
+			data()
+			    const
+			    noexcept
+			{
+				return (this->_data);
+			}
+
+			/** @return Number of viewed bytes */
+			size_type
+			size()
+			    const
+			    noexcept
+			{
+				return (this->_size);
+			}
+
+			/** @return Whether no bytes are viewed */
+			bool
+			empty()
+			    const
+			    noexcept
+			{
+				return (this->_size == 0);
+			}
+
+			/** @return Iterator to the first viewed byte */
+			const_iterator
+			begin()
+			    const
+			    noexcept
+			{
+				return (this->_data);
+			}
+
+			/** @return Iterator past the last viewed byte */
+			const_iterator
+			end()
+			    const
+			    noexcept
+			{
+				return (this->_data + this->_size);
+			}
+
+			/**
+			 * @brief
+			 * Unchecked access to a viewed byte.
+			 *
+			 * @param index
+			 *	Offset of the byte.
+			 *
+			 * @return
+			 *	Byte at index.
+			 */
+			const uint8_t&
+			operator[](
+			    size_type index)
+			    const
+			{
+				return (this->_data[index]);
+			}
+
+			/**
+			 * @brief
+			 * Checked access to a viewed byte.
+			 *
+			 * @param index
+			 *	Offset of the byte.
+			 *
+			 * @return
+			 *	Byte at index.
+			 *
+			 * @throw out_of_range
+			 *	index is not less than size().
+			 */
+			const uint8_t&
+			at(
+			    size_type index)
+			    const
+			{
+				if (index >= this->_size)
+					throw std::out_of_range("index");
+				return (this->_data[index]);
+			}
+
+			/**
+			 * @brief
+			 * View part of the viewed bytes.
+			 *
+			 * @param offset
+			 *	Offset of the first byte of the new view.
+			 * @param count
+			 *	Maximum number of bytes in the new view.
+			 *
+			 * @return
+			 *	View of up to count bytes starting at
+			 *	offset.
+			 *
+			 * @throw out_of_range
+			 *	offset is greater than size().
+			 */
+			ByteView
+			subview(
+			    size_type offset,
+			    size_type count = SIZE_MAX)
+			    const
+			{
+				if (offset > this->_size)
+					throw std::out_of_range("offset");
+				if (count > (this->_size - offset))
+					count = this->_size - offset;
+				return (ByteView(this->_data + offset, count));
+			}
+
+		private:
+			/** Start of the viewed bytes */
+			const uint8_t *_data;
+			/** Number of viewed bytes */
+			size_type _size;
+		};
+	}
+}
+
+#endif /* __BE_MEMORY_BYTEVIEW_H__ */
@@ -12,6 +12,7 @@
 #define __BE_MEMORY_INDEXEDBUFFER__
 
 #include <be_memory_autoarray.h>
+#include <be_memory_byteview.h>
 
 namespace BiometricEvaluation
 {
@@ -59,6 +60,16 @@ namespace BiometricEvaluation
 				IndexedBuffer(
 				    const uint8Array &aa);
 
+				/**
+				 * @brief
+				 * Wrap the bytes of a ByteView.
+				 *
+				 * @param view
+				 * ByteView to wrap.
+				 */
+				IndexedBuffer(
+				    ByteView view);
+
 				/** Copy constructor (default). */
 				IndexedBuffer(
 				    const IndexedBuffer &copy) = default;
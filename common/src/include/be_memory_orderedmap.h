@@ -11,6 +11,7 @@
 #ifndef __ORDERED_MAP_H__
 #define __ORDERED_MAP_H__
 
+#include <functional>
 #include <iterator>
 #include <list>
 #include <memory>
@@ -415,7 +416,8 @@ namespace BiometricEvaluation
 			 * Obtain an iterator to a particular key.
 			 *
 			 * @note
-			 *	Complexity is O(n).
+			 *	Complexity: Average case: O(1), worst case
+			 *	O(size()).
 			 */
 			const OrderedMapIterator<Key, T>
 			find(
@@ -454,6 +456,25 @@ namespace BiometricEvaluation
 			container *_elements;
 			/** Container that maintains insertion order */
 			std::list<Key> *_ordering;
+
+			/** Position of each key in _ordering */
+			using position_map = std::unordered_map<
+			    std::reference_wrapper<const Key>,
+			    typename std::list<Key>::iterator,
+			    std::hash<Key>, std::equal_to<Key>>;
+			/** Index of _ordering, so keys are found in O(1) */
+			position_map *_positions;
+
+			/**
+			 * @brief
+			 * Record a key at the end of the insertion order.
+			 *
+			 * @param key
+			 *	Key newly inserted into _elements.
+			 */
+			void
+			appendPosition(
+			    const Key &key);
 		};
 	}
 }
@@ -461,7 +482,8 @@ namespace BiometricEvaluation
 template<class Key, class T>
 BiometricEvaluation::Memory::OrderedMap<Key, T>::OrderedMap() :
     _elements(new container()),
-    _ordering(new std::list<Key>())
+    _ordering(new std::list<Key>()),
+    _positions(new position_map())
 {
 
 }
@@ -473,6 +495,18 @@ BiometricEvaluation::Memory::OrderedMap<Key, T>::~OrderedMap()
 		delete _elements;
 	if (_ordering != nullptr)
 		delete _ordering;
+	if (_positions != nullptr)
+		delete _positions;
+}
+
+template<class Key, class T>
+void
+BiometricEvaluation::Memory::OrderedMap<Key, T>::appendPosition(
+    const Key &key)
+{
+	_ordering->push_back(key);
+	_positions->emplace(std::cref(_ordering->back()),
+	    std::prev(_ordering->end()));
 }
 
 template<class Key, class T>
@@ -481,7 +515,7 @@ BiometricEvaluation::Memory::OrderedMap<Key, T>::push_back(
     const value_type &value)
 {
 	if (_elements->insert(value).second) {
-		_ordering->push_back(value.first);
+		this->appendPosition(value.first);
 		return (true);
 	} else
 		return (false);
@@ -492,8 +526,7 @@ void
 BiometricEvaluation::Memory::OrderedMap<Key, T>::erase(
     iterator pos)
 {
-	_ordering->remove(pos->first);
-	_elements->erase(pos);
+	this->erase(pos->first);
 }
 
 template<class Key, class T>
@@ -501,8 +534,16 @@ void
 BiometricEvaluation::Memory::OrderedMap<Key, T>::erase(
     const Key &key)
 {
-	_ordering->remove(key);
-	_elements->erase(_elements->find(key));
+	typename position_map::iterator position =
+	    _positions->find(std::cref(key));
+	if (position == _positions->end())
+		return;
+
+	/* Position's key lives in _ordering, so erase it first */
+	const typename std::list<Key>::iterator listIter = position->second;
+	_positions->erase(position);
+	_ordering->erase(listIter);
+	_elements->erase(key);
 }
 
 template<class Key, class T>
@@ -578,7 +619,7 @@ BiometricEvaluation::Memory::OrderedMap<Key, T>::operator[](
 	    
 	if (result.second) {
 		/* New insertion */
-		_ordering->push_back(key);
+		this->appendPosition(key);
 		return (result.first->second);
 	} else
 		/* Already in list */
@@ -591,8 +632,11 @@ BiometricEvaluation::Memory::OrderedMap<Key, T>::find(
     const Key &key)
     const
 {
+	const typename position_map::const_iterator position =
+	    _positions->find(std::cref(key));
 	return (OrderedMapIterator<Key, T>(this,
-	    std::find(_ordering->begin(), _ordering->end(), key)));
+	    position == _positions->end() ? _ordering->end() :
+	    position->second));
 }
 
 template<class Key, class T>
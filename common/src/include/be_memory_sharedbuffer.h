@@ -0,0 +1,130 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_MEMORY_SHAREDBUFFER_H__
+#define __BE_MEMORY_SHAREDBUFFER_H__
+
+#include <cstdint>
+#include <memory>
+
+#include <be_memory_autoarray.h>
+#include <be_memory_byteview.h>
+
+namespace BiometricEvaluation
+{
+	namespace Memory
+	{
+		/**
+		 * @brief
+		 * An immutable buffer whose bytes are shared by every copy.
+		 * @details
+		 * Copying a SharedBuffer copies a reference, not the bytes,
+		 * and the bytes are freed when the last SharedBuffer
+		 * referring to them is destroyed.  Because the bytes can
+		 * never change, a SharedBuffer can be handed between layers
+		 * (e.g., from a RecordStore to an Image to a processing
+		 * thread) and read concurrently without copying or locking.
+		 */
+		class SharedBuffer
+		{
+		public:
+			/** Type of subscripts, counts, etc. */
+			using size_type = size_t;
+
+			/** Construct an empty SharedBuffer. */
+			SharedBuffer();
+
+			/**
+			 * @brief
+			 * Take ownership of the contents of an AutoArray,
+			 * without copying.
+			 *
+			 * @param data
+			 *	Contents of the new SharedBuffer.  data
+			 *	is left empty.
+			 */
+			explicit SharedBuffer(
+			    uint8Array &&data);
+
+			/**
+			 * @brief
+			 * Copy bytes into a new SharedBuffer.
+			 *
+			 * @param data
+			 *	Bytes to copy.
+			 *
+			 * @throw Error::MemoryError
+			 *	Could not allocate memory.
+			 */
+			explicit SharedBuffer(
+			    ByteView data);
+
+			/** @return Start of the bytes */
+			const uint8_t*
+			data()
+			    const
+			    noexcept;
+
+			/** @return Number of bytes */
+			size_type
+			size()
+			    const
+			    noexcept;
+
+			/** @return Whether there are no bytes */
+			bool
+			empty()
+			    const
+			    noexcept;
+
+			/** @return View of the bytes */
+			ByteView
+			getView()
+			    const
+			    noexcept;
+
+			/** @return View of the bytes */
+			operator ByteView()
+			    const
+			    noexcept;
+
+			/**
+			 * @brief
+			 * Share part of the bytes.
+			 *
+			 * @param offset
+			 *	Offset of the first byte of the slice.
+			 * @param count
+			 *	Maximum number of bytes in the slice.
+			 *
+			 * @return
+			 *	SharedBuffer of up to count bytes starting
+			 *	at offset, which keeps all of this
+			 *	SharedBuffer's bytes alive.
+			 *
+			 * @throw out_of_range
+			 *	offset is greater than size().
+			 */
+			SharedBuffer
+			slice(
+			    size_type offset,
+			    size_type count = SIZE_MAX)
+			    const;
+
+		private:
+			/** Owner of the bytes */
+			std::shared_ptr<const uint8Array> _owner;
+			/** Bytes of _owner shared by this object */
+			ByteView _view;
+		};
+	}
+}
+
+#endif /* __BE_MEMORY_SHAREDBUFFER_H__ */
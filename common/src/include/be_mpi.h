@@ -15,6 +15,7 @@
 
 #include <be_framework_enumeration.h>
 #include <be_io_logsheet.h>
+#include <be_time_histogram.h>
 
 namespace BiometricEvaluation {
 	/**
@@ -98,6 +99,26 @@ namespace BiometricEvaluation {
 		    const std::string &url,
 		    const std::string &description);
 
+		/**
+		 * @brief
+		 * Combine the Histograms of all MPI tasks.
+		 * @details
+		 * This is a collective operation: every task in
+		 * COMM_WORLD must call it. Each task's Histogram is
+		 * sent to the root task and merged into the root's
+		 * Histogram. Histograms of other tasks are not changed.
+		 * @param[in,out] histogram
+		 * The Histogram of this task, which, on the root task,
+		 * also receives the Histograms of the other tasks.
+		 * @param[in] root
+		 * Rank of the task that receives the combined Histogram.
+		 * @throw Error::ParameterError
+		 * A received Histogram was corrupt.
+		 */
+		void mergeHistogram(
+		    Time::Histogram &histogram,
+		    const int root = 0);
+
 		/** The command given to an MPI task. */
 		enum class TaskCommand : int32_t
 		{
@@ -145,7 +166,14 @@ namespace BiometricEvaluation {
 			 * normal control/data messaging cannot
 			 * be used.
 			 */
-			OOB = 2
+			OOB = 2,
+			/**
+			 * @brief
+			 * The identifier of a work package completed by
+			 * a worker, sent to Task-0. A message with no
+			 * identifier is the last from its task.
+			 */
+			Completion = 3
 		};
 
 		/** Storage type for MessageTag. */
@@ -10,18 +10,27 @@
 #ifndef _BE_MPI_DISTRIBUTOR_H
 #define _BE_MPI_DISTRIBUTOR_H
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <be_error_exception.h>
 #include <be_io_logsheet.h>
 #include <be_mpi.h>
 #include <be_mpi_resources.h>
 #include <be_mpi_workpackage.h>
+#include <be_time_histogram.h>
 
 namespace BiometricEvaluation {
 	namespace MPI {
+		class Topology;
+
 		/**
 		 * @brief
 		 * A class to represent an MPI task that distributes work
@@ -39,9 +48,30 @@ namespace BiometricEvaluation {
 		 * Failure to start the Distributor object will result in
 		 * the entire MPI job shutting down before any work is done.
 		 *
+		 * Work packages are created on a separate thread, which
+		 * keeps a queue of packages ready before receivers ask for
+		 * them, so reading the input does not delay replies to
+		 * receivers. While waiting for requests, the distributor
+		 * polls with increasing sleeps instead of spinning.
+		 *
+		 * Each package is numbered as it is created, and
+		 * workPackageCompleted() is called with the number of
+		 * every package a worker finishes, so that subclasses
+		 * can record progress and resume an interrupted job.
+		 *
+		 * When the Node Distributors property is true and the
+		 * job is started by Runtime::start(), a Distributor on
+		 * the first task of each node relays batches of work
+		 * packages from Task-0 to the other tasks of its node,
+		 * and forwards their completions back. Task-0 prefers
+		 * to send a node the packages whose locality matches
+		 * that node.
+		 *
 		 * If the Logsheet URL property is set, log messages will be
 		 * written to that sheet. Otherwise, log messages will be 
-		 * written to a Null Logsheet.
+		 * written to a Null Logsheet. When distribution ends,
+		 * the queue depth seen by each request and the time taken
+		 * to reply to each request are summarized in the log.
 		 *
 		 * @see IO::Properties
 		 * @see MPI::Receiver
@@ -73,6 +103,8 @@ namespace BiometricEvaluation {
 			 */
 			void start();
 
+			friend class Runtime;
+
 		protected:
 			/**
 			 * @brief
@@ -80,11 +112,42 @@ namespace BiometricEvaluation {
 			 * @details
 			 * Implementations of this class create a work package
 			 * to encapsulate the specific data type that is to
-			 * be distributed.
+			 * be distributed. A package with no elements
+			 * indicates there is no more work.
+			 *
+			 * @note
+			 * This method is called from a thread other than the
+			 * one that called start(), but is never called
+			 * concurrently with itself. The Logsheet from
+			 * getLogsheet() may be written while it runs.
 			 */
 			virtual void createWorkPackage(
 			    MPI::WorkPackage &workPackage) = 0;
 
+			/**
+			 * @brief
+			 * Note that a worker completed a work package.
+			 * @details
+			 * Called once for each package that a worker
+			 * finished processing without error, identified by
+			 * the ID set on the package before it was passed to
+			 * createWorkPackage(). Packages in progress when the
+			 * job stops are never reported. The default
+			 * implementation does nothing.
+			 *
+			 * @note
+			 * This method is called from the thread that called
+			 * start(), possibly while createWorkPackage() runs,
+			 * and must not write to the Logsheet.
+			 * @param[in] packageID
+			 * The ID of the completed package.
+			 * @throw Error::Exception
+			 * The completion could not be recorded; the error
+			 * is logged and distribution continues.
+			 */
+			virtual void workPackageCompleted(
+			    const uint64_t packageID);
+
 			/**
 		 	 * @brief
 			 * Get access to the Logsheet object.
@@ -94,6 +157,17 @@ namespace BiometricEvaluation {
 			std::shared_ptr<IO::Logsheet> getLogsheet() const;
 
 		private:
+			/**
+			 * @brief
+			 * Start distributing work in an arrangement of
+			 * tasks.
+			 * @param[in] topology
+			 * The arrangement of the job's tasks; this task
+			 * is the Distributor or a node distributor.
+			 */
+			void start(
+			    const std::shared_ptr<Topology> &topology);
+
 			/**
 			* @brief
 			* Distribute work to other tasks.
@@ -111,6 +185,146 @@ namespace BiometricEvaluation {
 			    MPI::WorkPackage &workPackage,
 			    int MPITask);
 
+			/**
+			 * @brief
+			 * Send a batch of work packages to a node
+			 * distributor as a single work package.
+			 * @details
+			 * Each package is preceded by its number of
+			 * elements, ID, and size, as 64-bit integers.
+			 */
+			void sendWorkPackages(
+			    const std::vector<std::unique_ptr<
+			    MPI::WorkPackage>> &batch,
+			    int MPITask);
+
+			/**
+			 * @brief
+			 * Obtain the most packages to send to a task
+			 * at once.
+			 * @param[in] task
+			 * Rank of the task in the downstream
+			 * communicator.
+			 * @return
+			 * 1, unless task is a node distributor.
+			 */
+			size_t getBatchSize(
+			    int task) const;
+
+			/**
+			 * @brief
+			 * Create work packages until there are no more, or
+			 * stopProducer() is called.
+			 * @details
+			 * Run on _producer, keeping at most
+			 * _packageQueueCapacity packages in _packageQueue.
+			 */
+			void producePackages();
+
+			/**
+			 * @brief
+			 * Stop and join the work package producer thread.
+			 */
+			void stopProducer();
+
+			/**
+			 * @brief
+			 * Obtain the next work package from the queue.
+			 * @details
+			 * Waits for the producer when the queue is empty.
+			 * A package whose locality matches the node of
+			 * the task is preferred.
+			 * @param[in] task
+			 * Rank of the task that will be sent the package.
+			 * @param[in] wait
+			 * Whether to wait for a package when none is ready.
+			 * @return
+			 * The next work package, or nullptr if there is no
+			 * more work or an exit signal was received.
+			 * @throw Error::Exception
+			 * Propagated from createWorkPackage().
+			 */
+			std::unique_ptr<MPI::WorkPackage> takeWorkPackage(
+			    int task,
+			    bool wait);
+
+			/**
+			 * @brief
+			 * Put a package taken by takeWorkPackage() back
+			 * at the front of the queue.
+			 * @param[in] workPackage
+			 * The package not sent.
+			 */
+			void returnWorkPackage(
+			    std::unique_ptr<MPI::WorkPackage> workPackage);
+
+			/**
+			 * @brief
+			 * Ask Task-0 for the next batch of work packages,
+			 * as a node distributor.
+			 * @details
+			 * The packages are added to the queue, or the
+			 * producer is marked done if Task-0 has no more
+			 * work for this node.
+			 */
+			void requestBatch();
+
+			/**
+			 * @brief
+			 * Act on an exit command sent out-of-band by
+			 * Task-0 to a node distributor, without waiting.
+			 */
+			void receiveUpstreamCommand();
+
+			/**
+			 * @brief
+			 * Shut down the exchange with Task-0 once this
+			 * node distributor's tasks have shut down.
+			 */
+			void finishUpstream();
+
+			/**
+			 * @brief
+			 * Log a message without waiting for the producer.
+			 * @details
+			 * The message is written now if the Logsheet is not
+			 * in use by createWorkPackage(), and otherwise, the
+			 * next time it is free.
+			 * @param[in] message
+			 * The log message.
+			 */
+			void deferLogMessage(
+			    const std::string &message);
+
+			/**
+			 * @brief
+			 * Write messages held by deferLogMessage().
+			 * @param[in] wait
+			 * Whether to wait for the Logsheet to be free, or
+			 * keep holding the messages if it is in use.
+			 */
+			void flushLog(
+			    bool wait);
+
+			/**
+			 * @brief
+			 * Receive the IDs of packages completed by workers
+			 * without waiting.
+			 * @details
+			 * Calls workPackageCompleted() for each.
+			 */
+			void receiveCompletions();
+
+			/**
+			 * @brief
+			 * Pass a completed package ID to
+			 * workPackageCompleted(), logging any error.
+			 * @param[in] packageID
+			 * The ID of the completed package.
+			 */
+			void completeWorkPackage(
+			    const uint64_t packageID);
+
 			/**
 			 * @brief
 			 * Shut down all MPI processing.
@@ -122,10 +336,54 @@ namespace BiometricEvaluation {
 
 			std::unique_ptr<MPI::Resources> _resources;
 
+			/* Arrangement of the tasks, set by start() */
+			std::shared_ptr<Topology> _topology;
+			/* Packages come from Task-0, not a producer */
+			bool _relay;
+			/* Last command from Task-0 to this relay */
+			MPI::TaskCommand _upstreamCommand;
+			/* Last batch received by this relay */
+			Memory::uint8Array _batchData;
+
 			/* The list of tasks accepting work */
 			std::set<int> _activeMpiTasks;
 
 			std::shared_ptr<IO::Logsheet> _logsheet;
+
+			/* Held while the Logsheet is written */
+			std::mutex _logsheetMutex;
+			/* Messages waiting for the Logsheet to be free */
+			std::vector<std::string> _heldLogMessages;
+
+			/* Thread running producePackages() */
+			std::thread _producer;
+			/* Work packages created ahead of requests */
+			std::deque<std::unique_ptr<MPI::WorkPackage>>
+			    _packageQueue;
+			/* Most packages to hold in _packageQueue */
+			size_t _packageQueueCapacity;
+			/* Protects the queue and producer state */
+			std::mutex _packageQueueMutex;
+			/* Signaled when a package is added to the queue */
+			std::condition_variable _packageQueued;
+			/* Signaled when a package is removed from the queue */
+			std::condition_variable _packageTaken;
+			/* The producer has created the last package */
+			bool _producerDone;
+			/* The producer has been asked to stop */
+			bool _producerStopping;
+			/* Exception thrown by createWorkPackage() */
+			std::exception_ptr _producerException;
+			/* ID of the last package created */
+			uint64_t _lastPackageID;
+
+			/* Packages in the queue when each request arrived */
+			Time::Histogram _queueDepth;
+			/* Time from receipt of a request to reply, in ns */
+			Time::Histogram _serviceLatency;
+			/* Packages sent with a locality, and to their node */
+			uint64_t _placedPackages;
+			uint64_t _localPackages;
 		};
 	}
 }
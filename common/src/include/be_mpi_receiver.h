@@ -10,6 +10,7 @@
 #ifndef _BE_MPI_RECEIVER_H
 #define _BE_MPI_RECEIVER_H
 
+#include <map>
 #include <string>
 #include <vector>
 #include <memory>
@@ -23,6 +24,8 @@
 
 namespace BiometricEvaluation {
 	namespace MPI {
+		class Topology;
+
 		/**
 		 * @brief
 		 * A class to represent an MPI task that receives WorkPackages
@@ -38,6 +41,14 @@ namespace BiometricEvaluation {
 		 * indicates that it has started successfully. Otherwise, the
 		 * Receiver transitions to the shutdown state.
 		 *
+		 * Work packages are received from the Distributor directly
+		 * into memory shared with the workers, which process them
+		 * in place, unless the package is larger than the Package
+		 * Pool Slot Size property, in which case it is copied to
+		 * the worker through a pipe. When the Node Distributors
+		 * property is true, packages come from a Distributor on
+		 * the receiver's node instead of from Task-0.
+		 *
 		 * One of the optional properties is a Uniform Resource Locator
 		 * (URL) for the Logsheet. If this property does not exist,
 		 * no logging takes place (although applications can create
@@ -88,23 +99,75 @@ namespace BiometricEvaluation {
 			 */
 			void start();
 
+			friend class Runtime;
+
 		protected:
 
 		private:
+			class PackagePool;
+
+			/*
+			 * Start receiving work from the task upstream in
+			 * an arrangement of tasks.
+			 */
+			void start(
+			    const std::shared_ptr<Topology> &topology);
+
 			MPI::TaskStatus requestWorkPackages();
 			void sendWorkPackage(MPI::WorkPackage &workPackage);
+
+			/*
+			 * Hand a work package that was received into a
+			 * slot of the PackagePool to a worker.
+			 */
+			void sendWorkPackage(
+			    uint32_t slot,
+			    uint64_t size,
+			    uint64_t numElements,
+			    uint64_t packageID);
+
+			/*
+			 * Wait for a worker to ask for a work package.
+			 * Returns nullptr if the package should not be
+			 * sent due to an exit condition.
+			 */
+			std::shared_ptr<Process::WorkerController>
+			    waitForWorker();
+
+			/*
+			 * Note that a worker sent a message, so is done
+			 * with the package it was last given. If the
+			 * status is OK, the package was completed, and
+			 * Task-0 is told so.
+			 */
+			void workerReported(
+			    const std::shared_ptr<Process::WorkerController>
+				&worker,
+			    MPI::TaskStatus taskStatus);
+
 			void startWorkers();
 			void shutdown(
 			    const MPI::TaskStatus &status,
 			    const std::string &reason);
 
 			Process::ForkManager _processManager;
+
+			/* Memory shared with the workers for packages */
+			std::shared_ptr<PackagePool> _packagePool;
+			/* The PackagePool slot each worker is processing */
+			std::map<std::shared_ptr<Process::WorkerController>,
+			    uint32_t> _workerSlots;
+			/* The ID of the package each worker is processing */
+			std::map<std::shared_ptr<Process::WorkerController>,
+			    uint64_t> _workerPackages;
 			
 			std::shared_ptr<MPI::WorkPackageProcessor>
 			    _workPackageProcessor;
 
 			std::shared_ptr<MPI::Resources> _resources;
 			std::shared_ptr<IO::Logsheet> _logsheet;
+			/* Arrangement of the tasks, set by start() */
+			std::shared_ptr<Topology> _topology;
 
 			/*
 			 * Declare the class that implements process worker.
@@ -116,7 +179,9 @@ namespace BiometricEvaluation {
 				const std::shared_ptr<MPI::WorkPackageProcessor>
 				    &workPackageProcessor,
 				const std::shared_ptr<MPI::Resources>
-				    &resources);
+				    &resources,
+				const std::shared_ptr<PackagePool>
+				    &packagePool);
 					
 			    int32_t workerMain();
 
@@ -128,6 +193,7 @@ namespace BiometricEvaluation {
 				    _workPackageProcessor;
 				std::shared_ptr<MPI::Resources> _resources;
 				std::shared_ptr<IO::Logsheet> _logsheet;
+				std::shared_ptr<PackagePool> _packagePool;
 			};
 		};
 	}
@@ -37,7 +37,10 @@ namespace BiometricEvaluation {
 			 * key is delivered as part of a work package.
 			 * When both key and value are part of the work
 			 * package, there is no need to have access to the
-			 * source record store.
+			 * source record store.  When whole shards are
+			 * distributed, the processor reads every record of
+			 * each shard it is given from the source record store,
+			 * and calls processRecord() with the key and value.
 			 * @note
 			 * The size of a single value item is limited to
 			 * 2^32 octets. If the size of the value item is
@@ -97,6 +100,36 @@ namespace BiometricEvaluation {
 			    const std::string &key,
 			    const Memory::uint8Array &value) = 0;
 
+			/**
+			 * @brief
+			 * Determine whether a record was processed by an
+			 * earlier run of the job.
+			 * @details
+			 * When a job resumes from a checkpoint journal,
+			 * packages that were being processed when the
+			 * earlier run stopped are distributed again, so
+			 * some of their records may already have been
+			 * processed. Implementations whose processRecord()
+			 * cannot safely be repeated (e.g., it appends to
+			 * output) override this method to skip those
+			 * records. It is only called when the Resume From
+			 * Checkpoint property is true, before each record
+			 * is processed. The default implementation returns
+			 * false.
+			 *
+			 * @param[in] key
+			 * The key of the record about to be processed.
+			 * @return
+			 * true if processRecord() should not be called for
+			 * the record, false otherwise.
+			 *
+			 * @throw Error::Exception
+			 * A fatal error occurred; the processing
+			 * responsible for this object should shut down.
+			 */
+			virtual bool isRecordProcessed(
+			    const std::string &key);
+
 			/* Implement WorkPackageProcessor interface */
 			virtual std::shared_ptr<WorkPackageProcessor>
 			    newProcessor(
@@ -114,6 +147,20 @@ namespace BiometricEvaluation {
 		private:
 			std::shared_ptr<MPI::RecordStoreResources>
 			     _resources;
+
+			/**
+			 * @brief
+			 * Process every record of one shard of the source
+			 * ShardedRecordStore.
+			 *
+			 * @param[in] shardIndex
+			 * Index of the shard, as sent in the work package.
+			 *
+			 * @throw Error::Exception
+			 * The shard could not be read, or processRecord()
+			 * requested a shutdown.
+			 */
+			void processShard(const std::string &shardIndex);
 		};
 	}
 }
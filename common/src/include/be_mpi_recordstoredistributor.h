@@ -10,6 +10,11 @@
 #ifndef _BE_MPI_RECORDSTOREDISTRIBUTOR_H
 #define _BE_MPI_RECORDSTOREDISTRIBUTOR_H
 
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#include <be_io_shardedrecstore.h>
 #include <be_mpi_distributor.h>
 #include <be_mpi_recordstoreresources.h>
 
@@ -34,6 +39,26 @@ namespace BiometricEvaluation {
 			 *
 			 * The work package sent to Receivers can contain
 			 * either RecordStore keys, or key/value pairs.
+			 * When the RecordStoreResources::
+			 * DISTRIBUTESHARDSPROPERTY property is true, each
+			 * work package instead names one shard of a
+			 * ShardedRecordStore, and includeValues is ignored.
+			 * When the RecordStoreResources::
+			 * CHECKPOINTJOURNALPROPERTY property is set, the
+			 * range of input positions in each package that a
+			 * worker completes is appended to that file, along
+			 * with the last key in the range. When
+			 * RecordStoreResources::RESUMEFROMCHECKPOINTPROPERTY
+			 * is also true, those ranges are skipped, using
+			 * RecordStore::setCursorAtKey(), so only work left
+			 * unfinished by an earlier run is distributed.
+			 * Packages that were being processed when that run
+			 * stopped are distributed again.
+			 *
+			 * When the input is a ShardedRecordStore, each
+			 * package's locality is the index of the shard of
+			 * its first record, so that a node tends to be sent
+			 * records from the same shards.
 			 * @note
 			 * The size of a single value item is limited to
 			 * 2^32 octets. If the size of the value item is
@@ -46,6 +71,11 @@ namespace BiometricEvaluation {
 			 * true if both the key and value items are included
 			 * in the work package, false otherwise.
 			 *
+			 * @throw Error::ParameterError
+			 * The checkpoint journal was written for a record
+			 * store with a different number of records.
+			 * @throw Error::FileError
+			 * The checkpoint journal could not be written.
 			 * @throw Error::Exception
 			 * An error occurred, typically due to missing or
 			 * invalid properties.
@@ -64,11 +94,66 @@ namespace BiometricEvaluation {
 			void
 			createWorkPackage(MPI::WorkPackage &workPackage);
 
+			void
+			workPackageCompleted(const uint64_t packageID);
+
 		private:
+			/** Input positions covered by a work package */
+			struct PackageRange
+			{
+				/** Position of the first record or shard */
+				uint64_t first;
+				/** Number of positions covered */
+				uint64_t count;
+				/**
+				 * Key at the last position, or empty if it
+				 * is unknown.
+				 */
+				std::string lastKey;
+			};
+
+			/**
+			 * @brief
+			 * Read the ranges completed by an earlier run from
+			 * the checkpoint journal, and start a compacted
+			 * copy of the journal.
+			 * @param[in] inputCount
+			 * Number of records, or shards, in the input.
+			 * @return
+			 * Number of positions completed by the earlier run.
+			 */
+			uint64_t
+			resumeJournal(uint64_t inputCount);
+
+			/**
+			 * @brief
+			 * Move the input past any completed range that
+			 * starts at the next position.
+			 * @param[in] recordStore
+			 * The input record store, or nullptr when
+			 * distributing shards.
+			 */
+			void
+			skipCompleted(IO::RecordStore *recordStore);
+
 			std::unique_ptr<MPI::RecordStoreResources>
 			    _resources;
 			uint64_t _recordsRemaining;
 			bool _includeValues;
+			/** Position of the next record or shard to read */
+			uint64_t _nextPosition;
+			/** The input, when it is sharded */
+			std::shared_ptr<IO::ShardedRecordStore>
+			    _shardedRecordStore;
+
+			/** Journal of completed ranges */
+			std::ofstream _journal;
+			/** Completed ranges to skip, by first position */
+			std::map<uint64_t, PackageRange> _completedRanges;
+			/** Ranges of packages not yet completed, by ID */
+			std::map<uint64_t, PackageRange> _packageRanges;
+			/** Protects _packageRanges */
+			std::mutex _packageRangesMutex;
 		};
 	}
 }
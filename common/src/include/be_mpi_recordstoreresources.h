@@ -37,6 +37,38 @@ namespace BiometricEvaluation {
 			 * The property string ``Chunk Size''; required.
 			 */
 			static const std::string CHUNKSIZEPROPERTY;
+			/**
+			 * @brief
+			 * The property string ``Distribute Shards''; optional.
+			 * @details
+			 * When true, the input record store must be a
+			 * ShardedRecordStore, and each work package names
+			 * one whole shard, which the receiving processor
+			 * reads directly instead of having the keys and
+			 * values sent to it.
+			 */
+			static const std::string DISTRIBUTESHARDSPROPERTY;
+			/**
+			 * @brief
+			 * The property string ``Checkpoint Journal'';
+			 * optional.
+			 * @details
+			 * The path of a file to which the Distributor
+			 * appends the range of input records (or shards) in
+			 * each work package that a worker completes.
+			 */
+			static const std::string CHECKPOINTJOURNALPROPERTY;
+			/**
+			 * @brief
+			 * The property string ``Resume From Checkpoint'';
+			 * optional.
+			 * @details
+			 * When true, records (or shards) listed in the
+			 * Checkpoint Journal by an earlier run are not
+			 * distributed again. When false or absent, the
+			 * journal is started anew.
+			 */
+			static const std::string RESUMEFROMCHECKPOINTPROPERTY;
 
 			/**
 			 * @brief
@@ -64,6 +96,9 @@ namespace BiometricEvaluation {
 			 * The resources file could not be read.
 			 * @throw Error::ObjectDoesNotExist
 			 * A required property does not exist.
+			 * @throw Error::ParameterError
+			 * Resume From Checkpoint is true without a
+			 * Checkpoint Journal.
 			 * @throw Error::Exception
 			 * Some other error occurred.
 			 */
@@ -74,6 +109,35 @@ namespace BiometricEvaluation {
 
 			uint32_t getChunkSize() const;
 
+			/**
+			 * @brief
+			 * Indicator that whole shards of the input record
+			 * store are distributed.
+			 *
+			 * @return true if work packages contain shards,
+			 * false if they contain records.
+			 */
+			bool getDistributeShards() const;
+
+			/**
+			 * @brief
+			 * Obtain the path of the checkpoint journal.
+			 *
+			 * @return The Checkpoint Journal property, or the
+			 * empty string if progress is not journaled.
+			 */
+			std::string getCheckpointJournal() const;
+
+			/**
+			 * @brief
+			 * Indicator that work completed by an earlier run,
+			 * as recorded in the checkpoint journal, is skipped.
+			 *
+			 * @return true if resuming from the checkpoint
+			 * journal, false otherwise.
+			 */
+			bool getResumeFromCheckpoint() const;
+
 			/**
 			 * @brief
 			 * Indicator that a record store has been opened.
@@ -93,6 +157,9 @@ namespace BiometricEvaluation {
 
 		private:
 			uint32_t _chunkSize;
+			bool _distributeShards;
+			std::string _checkpointJournal;
+			bool _resumeFromCheckpoint;
 			bool _haveRecordStore;
 			std::shared_ptr<IO::RecordStore> _recordStore;
 		};
@@ -10,6 +10,7 @@
 #ifndef _BE_MPI_RESOURCES_H
 #define _BE_MPI_RESOURCES_H
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -36,6 +37,69 @@ namespace BiometricEvaluation {
 			 */
 			static const std::string LOGSHEETURLPROPERTY;
 
+			/**
+			 * @brief
+			 * The property string ``Work Package Queue Depth'';
+			 * optional.
+			 * @details
+			 * The number of work packages the Distributor
+			 * builds ahead of requests from receivers. When
+			 * absent or 0, one package is built ahead for each
+			 * receiver task.
+			 */
+			static const std::string WORKPACKAGEQUEUEDEPTHPROPERTY;
+
+			/**
+			 * @brief
+			 * The property string ``Package Pool Slot Size'';
+			 * optional.
+			 * @details
+			 * The largest work package, in octets, that a
+			 * Receiver passes to its workers through shared
+			 * memory. Larger packages are copied through pipes.
+			 * When 0, shared memory is not used. When absent,
+			 * DEFAULTPACKAGEPOOLSLOTSIZE is used.
+			 */
+			static const std::string PACKAGEPOOLSLOTSIZEPROPERTY;
+
+			/** Package Pool Slot Size when not specified */
+			static const uint64_t DEFAULTPACKAGEPOOLSLOTSIZE =
+			    64 * 1024 * 1024;
+
+			/**
+			 * @brief
+			 * The property string ``Node Distributors'';
+			 * optional.
+			 * @details
+			 * When true, one task on each node receives batches
+			 * of work packages from the Distributor and hands
+			 * them out to the other tasks on its node, instead
+			 * of every task asking the Distributor for work.
+			 */
+			static const std::string NODEDISTRIBUTORSPROPERTY;
+
+			/**
+			 * @brief
+			 * The property string ``Tasks Per Node''; optional.
+			 * @details
+			 * When Node Distributors is true, the number of
+			 * consecutively ranked tasks treated as one node.
+			 * When absent or 0, tasks sharing memory form a
+			 * node. Setting this simulates many nodes on one
+			 * machine.
+			 */
+			static const std::string TASKSPERNODEPROPERTY;
+
+			/**
+			 * @brief
+			 * The property string ``Node Batch Size''; optional.
+			 * @details
+			 * The most work packages sent to a node distributor
+			 * at once. When absent or 0, one package is sent for
+			 * each worker on the node.
+			 */
+			static const std::string NODEBATCHSIZEPROPERTY;
+
 			/**
 			 * @brief
 			 * Obtain the list of required properties.
@@ -64,6 +128,8 @@ namespace BiometricEvaluation {
 			 * The resources file could not be read.
 			 * @throw Error::ObjectDoesNotExist
 			 * A required property does not exist.
+			 * @throw Error::ParameterError
+			 * A property has an invalid value.
 			 * @throw Error::Exception
 			 * Some other error occurred.
 			 */
@@ -90,6 +156,54 @@ namespace BiometricEvaluation {
 			 */
 			std::string getLogsheetURL() const;
 
+			/**
+			 * @brief
+			 * Obtain the number of work packages to build
+			 * ahead of requests.
+			 * @return
+			 * The Work Package Queue Depth property, or 0 if
+			 * it is not in the Properties file.
+			 */
+			int getWorkPackageQueueDepth() const;
+
+			/**
+			 * @brief
+			 * Obtain the size of each slot in a Receiver's
+			 * shared memory work package pool.
+			 * @return
+			 * The Package Pool Slot Size property, in octets.
+			 */
+			uint64_t getPackagePoolSlotSize() const;
+
+			/**
+			 * @brief
+			 * Indicator that work is distributed through a task
+			 * on each node.
+			 * @return
+			 * The Node Distributors property, or false if it is
+			 * not in the Properties file.
+			 */
+			bool getNodeDistributors() const;
+
+			/**
+			 * @brief
+			 * Obtain the number of tasks treated as one node.
+			 * @return
+			 * The Tasks Per Node property, or 0 if it is not
+			 * in the Properties file.
+			 */
+			int getTasksPerNode() const;
+
+			/**
+			 * @brief
+			 * Obtain the most work packages to send to a node
+			 * distributor at once.
+			 * @return
+			 * The Node Batch Size property, or 0 if it is not
+			 * in the Properties file.
+			 */
+			int getNodeBatchSize() const;
+
 			~Resources();
 
 			int getRank() const;
@@ -102,6 +216,11 @@ namespace BiometricEvaluation {
 			int _numTasks;
 			int _workersPerNode;
 			std::string _logsheetURL;
+			int _workPackageQueueDepth;
+			uint64_t _packagePoolSlotSize;
+			bool _nodeDistributors;
+			int _tasksPerNode;
+			int _nodeBatchSize;
 		};
 	}
 }
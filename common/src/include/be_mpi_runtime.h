@@ -31,7 +31,10 @@ namespace BiometricEvaluation {
 		 * to start and shutdown the MPI job. Each job consists of
 		 * a single distributor of work, and 1..n receivers of work
 		 * which then distribute the work packages to child processes
-		 * to take action on the work package.
+		 * to take action on the work package. When the Node
+		 * Distributors property is true, the distributor object on
+		 * the first task of each node relays work to the receivers
+		 * of that node.
 		 */
 		class Runtime {
 		public:
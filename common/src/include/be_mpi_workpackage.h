@@ -11,6 +11,7 @@
 #define _BE_MPI_WORKPACKAGE_H
 
 #include <be_memory_autoarray.h>
+#include <be_memory_byteview.h>
 
 namespace BiometricEvaluation {
 	namespace MPI {
@@ -21,9 +22,15 @@ namespace BiometricEvaluation {
 		 * @details
 		 * The work package is an wrapper around the data to
 		 * be processed, along with some ancillary information.
+		 * The data is either owned by the package, or, to avoid
+		 * copying large packages, viewed in memory owned by
+		 * someone else.
  		 */
 		class WorkPackage {
 		public:
+			/** Locality of a package that may go anywhere */
+			static const uint32_t ANYLOCALITY = UINT32_MAX;
+
 			/**
 			 * @brief
 			 * Construct an empty work package.
@@ -38,6 +45,17 @@ namespace BiometricEvaluation {
 			 * package.
 			 */
 			WorkPackage(const Memory::uint8Array &data);
+
+			/**
+			 * @brief
+			 * Construct a work package that views data owned
+			 * elsewhere.
+			 * @param[in] data
+			 * The data of the work package, which is not
+			 * copied, and must remain valid for the life of
+			 * this work package and its copies.
+			 */
+			WorkPackage(const Memory::ByteView &data);
 			~WorkPackage();
 
 			/**
@@ -46,11 +64,21 @@ namespace BiometricEvaluation {
 			 */
 			void getData(Memory::uint8Array &data) const;
 
+			/**
+		 	 * @brief
+			 * Obtain the package data without copying it.
+			 * @return
+			 * A view of the package data, valid until the
+			 * data is changed or this object is destroyed.
+			 */
+			Memory::ByteView getDataView() const;
+
 			/**
 		 	 * @brief
 			 * Set the package data from raw data.
 			 * @param[in] data
-			 * The data copied into the work package.
+			 * The data copied into the work package, replacing
+			 * any data that was viewed.
 			 */
 			void setData(const Memory::uint8Array &data);
 
@@ -83,10 +111,57 @@ namespace BiometricEvaluation {
 			 */
 			void setNumElements(const uint64_t numElements);
 
+			/**
+		 	 * @brief
+			 * Obtain the identifier of the package.
+			 * @details
+			 * The Distributor numbers each package it creates,
+			 * and is told the number of each package that a
+			 * worker completes.
+			 * @return
+			 * The package identifier, or 0 if not set.
+			 */
+			uint64_t getID() const;
+
+			/**
+		 	 * @brief
+			 * Set the identifier of the package.
+			 * @param[in] id
+			 * The package identifier.
+			 */
+			void setID(const uint64_t id);
+
+			/**
+		 	 * @brief
+			 * Obtain where the package's data is best processed.
+			 * @details
+			 * Packages with the same locality (e.g., records
+			 * from the same shard) are sent to the same node
+			 * when possible. The locality is only used by the
+			 * Distributor, and is not sent with the package.
+			 * @return
+			 * An application-defined locality, or ANYLOCALITY
+			 * if not set.
+			 */
+			uint32_t getLocality() const;
+
+			/**
+		 	 * @brief
+			 * Set where the package's data is best processed.
+			 * @param[in] locality
+			 * An application-defined locality, such as the
+			 * index of a shard.
+			 */
+			void setLocality(const uint32_t locality);
+
 		protected:
 		private:
 			Memory::uint8Array _data;
+			/* Data owned elsewhere, used instead of _data */
+			Memory::ByteView _externalData;
 			uint64_t _numElements;
+			uint64_t _id;
+			uint32_t _locality;
 		};
 	}
 }
@@ -16,6 +16,7 @@
 
 #include <be_error_exception.h>
 #include <be_memory_autoarray.h>
+#include <be_memory_byteview.h>
 
 namespace BiometricEvaluation {
 
@@ -143,8 +144,8 @@ namespace BiometricEvaluation {
 		 * @param[in] s
 		 * 	The string of which a digest should be computed.
 		 * @param[in] digest
-		 *	The digest to use.  Any digest supported by OpenSSL
-		 *	is valid, and the default is MD5.
+		 *	The digest to use.  Any digest supported by OpenSSL,
+		 *	or Digester::XXH64, is valid, and the default is MD5.
 		 *
 		 * @throw Error::MemoryError
 		 *	Could not allocate memory to store digest.
@@ -171,8 +172,8 @@ namespace BiometricEvaluation {
 		 * @param[in] buffer_size
 		 *	The size of buffer.
 		 * @param[in] digest
-		 *	The digest to use.  Any digest supported by OpenSSL
-		 *	is valid, and the default is MD5.
+		 *	The digest to use.  Any digest supported by OpenSSL,
+		 *	or Digester::XXH64, is valid, and the default is MD5.
 		 *
 		 * @throw Error::MemoryError
 		 *	Could not allocate memory to store digest.
@@ -191,6 +192,66 @@ namespace BiometricEvaluation {
 		    const size_t buffer_size,
 		    const std::string &digest = "md5");
 
+		/**
+		 * @brief
+		 * Compute the digest of a memory buffer.
+		 *
+		 * @param[in] buffer
+		 * 	The buffer of which a digest should be computed.
+		 * @param[in] digest
+		 *	The digest to use.  Any digest supported by OpenSSL,
+		 *	or Digester::XXH64, is valid, and the default is MD5.
+		 *
+		 * @throw Error::MemoryError
+		 *	Could not allocate memory to store digest.
+		 * @throw Error::NotImplemented
+		 *	The value of digest is not a supported digest.
+		 * @throw Error::StrategyError
+		 *	An error occurred while obtaining the digest.
+		 *
+		 * @return
+		 *	An ASCII representation of the hex digits composing
+		 *	the digest.
+		 */
+		std::string
+		digest(
+		    Memory::ByteView buffer,
+		    const std::string &digest = "md5");
+
+		/**
+		 * @brief
+		 * Compute the digests of many memory buffers.
+		 * @details
+		 * Buffers are divided among threads, each of which
+		 * reuses a single Digester.
+		 *
+		 * @param[in] buffers
+		 *	The buffers of which digests should be computed.
+		 * @param[in] digest
+		 *	The digest to use.  Any digest supported by OpenSSL,
+		 *	or Digester::XXH64, is valid, and the default is MD5.
+		 * @param[in] threadCount
+		 *	Maximum number of threads to use, or 0 to use one
+		 *	per processor core.
+		 *
+		 * @throw Error::NotImplemented
+		 *	The value of digest is not a supported digest.
+		 * @throw Error::StrategyError
+		 *	An error occurred while obtaining a digest.
+		 * @throw std::system_error
+		 *	A thread could not be started.
+		 *
+		 * @return
+		 *	Digests of buffers, in the same order, as ASCII
+		 *	representations of the hex digits composing the
+		 *	digests.
+		 */
+		std::vector<std::string>
+		digestBatch(
+		    const std::vector<Memory::uint8Array> &buffers,
+		    const std::string &digest = "md5",
+		    unsigned int threadCount = 0);
+
 		/**
 		 * @brief
 		 * Return tokens bound by delimiters and the beginning and end
@@ -317,6 +378,37 @@ namespace BiometricEvaluation {
 		encodeBase64(
 		    const BiometricEvaluation::Memory::uint8Array &data);
 
+		/**
+		 * @brief
+		 * Encode bytes as hexadecimal digits.
+		 *
+		 * @param data
+		 * Data to encode.
+		 * @param size
+		 * Number of bytes in data.
+		 *
+		 * @return
+		 * Two lowercase hex digits for each byte of data.
+		 */
+		std::string
+		encodeHex(
+		    const void *data,
+		    const size_t size);
+
+		/**
+		 * @brief
+		 * Encode bytes as hexadecimal digits.
+		 *
+		 * @param data
+		 * Data to encode.
+		 *
+		 * @return
+		 * Two lowercase hex digits for each byte of data.
+		 */
+		std::string
+		encodeHex(
+		    const BiometricEvaluation::Memory::uint8Array &data);
+
 		/**
 		 * @brief
 		 * Perform Base64 decoding.
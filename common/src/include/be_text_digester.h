@@ -0,0 +1,195 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef BE_TEXT_DIGESTER_H_
+#define BE_TEXT_DIGESTER_H_
+
+#include <istream>
+#include <memory>
+#include <string>
+
+#include <be_memory_autoarray.h>
+
+namespace BiometricEvaluation
+{
+	namespace Text
+	{
+		/**
+		 * @brief
+		 * Computes a digest incrementally.
+		 * @details
+		 * Data may be presented to a Digester in any number of
+		 * pieces, so large files and sets of records need not be
+		 * held in memory at once. The digest algorithm is looked
+		 * up once, when the Digester is constructed, and the
+		 * Digester may be reused after each digest is finalized.
+		 *
+		 * In addition to the digests supported by the platform
+		 * (e.g., "md5", "sha1", "sha256"), every platform supports
+		 * "xxh64", a fast non-cryptographic hash suitable for
+		 * detecting changed or duplicate content, but not for
+		 * security.
+		 *
+		 * A Digester is not thread-safe. Use one per thread.
+		 */
+		class Digester
+		{
+		public:
+			/** Name of the non-cryptographic XXH64 hash */
+			static const std::string XXH64;
+
+			/**
+			 * @brief
+			 * Constructor.
+			 *
+			 * @param digest
+			 * Name of the digest to compute.
+			 *
+			 * @throw Error::NotImplemented
+			 * digest is not a supported digest.
+			 * @throw Error::StrategyError
+			 * Could not initialize the digest.
+			 */
+			Digester(
+			    const std::string &digest = "md5");
+
+			/**
+			 * @brief
+			 * Add data to the digest.
+			 *
+			 * @param buffer
+			 * Data to add.
+			 * @param size
+			 * Number of bytes in buffer.
+			 *
+			 * @throw Error::StrategyError
+			 * Error updating the digest.
+			 */
+			void
+			update(
+			    const void *buffer,
+			    const size_t size);
+
+			/**
+			 * @brief
+			 * Add data to the digest.
+			 *
+			 * @param buffer
+			 * Data to add.
+			 *
+			 * @throw Error::StrategyError
+			 * Error updating the digest.
+			 */
+			void
+			update(
+			    const Memory::uint8Array &buffer);
+
+			/**
+			 * @brief
+			 * Add a string to the digest.
+			 *
+			 * @param s
+			 * String to add, not including a terminating NUL.
+			 *
+			 * @throw Error::StrategyError
+			 * Error updating the digest.
+			 */
+			void
+			update(
+			    const std::string &s);
+
+			/**
+			 * @brief
+			 * Add the remaining contents of a stream to the
+			 * digest.
+			 * @details
+			 * The stream is read in blocks until end-of-file.
+			 *
+			 * @param stream
+			 * Stream to read.
+			 *
+			 * @throw Error::StrategyError
+			 * Error reading stream or updating the digest.
+			 */
+			void
+			update(
+			    std::istream &stream);
+
+			/**
+			 * @brief
+			 * Complete the digest and restart.
+			 * @details
+			 * After the digest is returned, the Digester is ready
+			 * to compute a new digest of the same type.
+			 *
+			 * @return
+			 * Digest of all data added since construction or the
+			 * last call to finalize(), as lowercase hex digits.
+			 *
+			 * @throw Error::StrategyError
+			 * Error completing the digest.
+			 */
+			std::string
+			finalize();
+
+			/**
+			 * @brief
+			 * Complete the digest and restart.
+			 * @details
+			 * After the digest is returned, the Digester is ready
+			 * to compute a new digest of the same type.
+			 *
+			 * @return
+			 * Digest of all data added since construction or the
+			 * last call to finalize(), as bytes. Numeric hashes,
+			 * like XXH64, are stored most significant byte first.
+			 *
+			 * @throw Error::StrategyError
+			 * Error completing the digest.
+			 */
+			Memory::uint8Array
+			finalizeBytes();
+
+			/**
+			 * @brief
+			 * Discard all data added since construction or the
+			 * last call to finalize().
+			 *
+			 * @throw Error::StrategyError
+			 * Could not initialize the digest.
+			 */
+			void
+			reset();
+
+			/** @return Name of the digest computed. */
+			std::string
+			getName()
+			    const;
+
+			/** @return Size of the digest, in bytes. */
+			uint32_t
+			getSize()
+			    const;
+
+			~Digester();
+			Digester(Digester&&);
+			Digester& operator=(Digester&&);
+
+			Digester(const Digester&) = delete;
+			Digester& operator=(const Digester&) = delete;
+
+		private:
+			class Impl;
+			std::unique_ptr<Impl> pimpl;
+		};
+	}
+}
+
+#endif /* BE_TEXT_DIGESTER_H_ */
@@ -0,0 +1,252 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_TIME_HISTOGRAM_H__
+#define __BE_TIME_HISTOGRAM_H__
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <be_io_logsheet.h>
+#include <be_memory_autoarray.h>
+
+namespace BiometricEvaluation
+{
+	namespace Time
+	{
+		/**
+		 * @brief
+		 * A histogram of durations, suitable for reporting latency
+		 * percentiles.
+		 *
+		 * @details
+		 * Values are counted in log-linear buckets: every power of
+		 * two is split into SubBucketCount equal buckets, so any
+		 * value is reported within about 3% of what was recorded,
+		 * over the entire range of uint64_t. Recording is lock-free
+		 * and costs a few nanoseconds, so one Histogram may be
+		 * shared by many threads. Histograms recorded separately
+		 * (e.g., in different processes or MPI ranks) are combined
+		 * with merge(), exchanging them with serialize().
+		 *
+		 * Histogram is agnostic to units. Framework::API records
+		 * nanoseconds.
+		 */
+		class Histogram
+		{
+		public:
+			/** Log2 of the number of buckets per power of two */
+			static const uint8_t SubBucketBits = 5;
+			/** Number of buckets per power of two */
+			static const uint64_t SubBucketCount =
+			    (1 << SubBucketBits);
+			/** Total number of buckets */
+			static const uint64_t BucketCount =
+			    (65 - SubBucketBits) * SubBucketCount;
+
+			/** Constructor for an empty Histogram. */
+			Histogram();
+
+			/**
+			 * @brief
+			 * Construct a Histogram from a serialized Histogram.
+			 *
+			 * @param serialized
+			 * Return value of serialize().
+			 *
+			 * @throw Error::ParameterError
+			 * serialized is not a serialized Histogram.
+			 */
+			Histogram(
+			    const Memory::uint8Array &serialized);
+
+			/**
+			 * @brief
+			 * Copy constructor.
+			 *
+			 * @param other
+			 * Histogram to copy. Values recorded into other
+			 * during the copy may or may not be copied.
+			 */
+			Histogram(
+			    const Histogram &other);
+
+			/**
+			 * @brief
+			 * Copy assignment operator.
+			 *
+			 * @param other
+			 * Histogram to copy. Values recorded into other
+			 * during the copy may or may not be copied.
+			 *
+			 * @return
+			 * Reference to this object.
+			 */
+			Histogram&
+			operator=(
+			    const Histogram &other);
+
+			/**
+			 * @brief
+			 * Count a value.
+			 *
+			 * @param value
+			 * Value to count.
+			 *
+			 * @note
+			 * Lock-free and safe to call from multiple threads.
+			 */
+			void
+			record(
+			    uint64_t value)
+			    noexcept;
+
+			/**
+			 * @brief
+			 * Add the counts of another Histogram to this one.
+			 *
+			 * @param other
+			 * Histogram to add.
+			 */
+			void
+			merge(
+			    const Histogram &other)
+			    noexcept;
+
+			/** Remove all counts. */
+			void
+			reset()
+			    noexcept;
+
+			/** @return Number of values recorded. */
+			uint64_t
+			getCount()
+			    const
+			    noexcept;
+
+			/**
+			 * @return
+			 * Smallest value recorded, or 0 if no values were
+			 * recorded.
+			 */
+			uint64_t
+			getMin()
+			    const
+			    noexcept;
+
+			/** @return Largest value recorded. */
+			uint64_t
+			getMax()
+			    const
+			    noexcept;
+
+			/** @return Arithmetic mean of values recorded. */
+			double
+			getMean()
+			    const
+			    noexcept;
+
+			/**
+			 * @brief
+			 * Obtain the value below which a percentage of the
+			 * recorded values fall.
+			 *
+			 * @param percentile
+			 * Percentage, [0, 100].
+			 *
+			 * @return
+			 * Highest value equivalent (within bucket resolution)
+			 * to the value at percentile, or 0 if no values were
+			 * recorded.
+			 *
+			 * @throw Error::ParameterError
+			 * percentile is out of range.
+			 */
+			uint64_t
+			getPercentile(
+			    double percentile)
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain a portable copy of the Histogram.
+			 *
+			 * @return
+			 * Byte-order independent representation of the
+			 * Histogram, which can be passed to the
+			 * Histogram(const Memory::uint8Array&) constructor.
+			 */
+			Memory::uint8Array
+			serialize()
+			    const;
+
+			/**
+			 * @brief
+			 * Summarize the Histogram.
+			 *
+			 * @return
+			 * String with count, min, mean, p50, p90, p95, p99,
+			 * p99.9, and max, as space-separated "key=value"
+			 * pairs.
+			 */
+			std::string
+			toString()
+			    const;
+
+			/**
+			 * @brief
+			 * Write a summary of the Histogram as a Logsheet
+			 * entry.
+			 *
+			 * @param logsheet
+			 * Logsheet to write.
+			 * @param label
+			 * Label to prefix the summary, such as the operation
+			 * and units recorded.
+			 *
+			 * @throw Error::StrategyError
+			 * Propagated from Logsheet.
+			 */
+			void
+			writeToLogsheet(
+			    IO::Logsheet &logsheet,
+			    const std::string &label)
+			    const;
+
+		private:
+			/** @return Bucket counting value. */
+			static uint64_t
+			getBucketIndex(
+			    uint64_t value)
+			    noexcept;
+
+			/** @return Largest value counted in bucket. */
+			static uint64_t
+			getBucketUpperBound(
+			    uint64_t index)
+			    noexcept;
+
+			/** Count of values in each bucket */
+			std::unique_ptr<std::atomic<uint64_t>[]> _counts;
+			/** Number of values recorded */
+			std::atomic<uint64_t> _count{0};
+			/** Sum of values recorded */
+			std::atomic<uint64_t> _sum{0};
+			/** Smallest value recorded */
+			std::atomic<uint64_t> _min{UINT64_MAX};
+			/** Largest value recorded */
+			std::atomic<uint64_t> _max{0};
+		};
+	}
+}
+
+#endif /* __BE_TIME_HISTOGRAM_H__ */
@@ -21,6 +21,8 @@ namespace BiometricEvaluation
 {
 	namespace Time
 	{
+		class Histogram;
+
 		/**
 		 * @brief
 		 * This class can be used by applications to report
@@ -84,6 +86,22 @@ namespace BiometricEvaluation
 			void
 			stop();
 
+			/**
+			 * @brief
+			 * Stop tracking time and count the elapsed time.
+			 *
+			 * @param histogram
+			 * Histogram in which to record the elapsed time, in
+			 * nanoseconds.
+			 *
+			 * @throw Error::StrategyError
+			 * This object is not currently timing an operation or
+			 * an error occurred when obtaining timing information.
+			 */
+			void
+			stop(
+			    Histogram &histogram);
+
 			/**
 			 * @brief
 			 * Get the elapsed time in microseconds or nanoseconds
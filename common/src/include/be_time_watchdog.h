@@ -12,6 +12,7 @@
 
 #include <csetjmp>
 #include <csignal>
+#include <memory>
 
 #include <be_time.h>
 #include <be_error_exception.h>
@@ -65,6 +66,21 @@ namespace BiometricEvaluation {
  * of process virtual time or real time, based on how the object is
  * constructed.
  *
+ * The THREADREALTIME and THREADTIME types instead build on timer_create(2),
+ * delivering the timer signal only to the thread that started the timer.
+ * The jump state used by the watchdog macros is kept per-thread, so any
+ * number of threads may each run their own watchdog block at the same
+ * time. These types use the real-time signal SIGRTMIN, whose handler is
+ * installed once and left in place; applications must not otherwise use
+ * that signal. Thread timers are available only on Linux.
+ *
+ * The MONITORED type also signals only the starting thread, but instead of
+ * a system timer it publishes a deadline that a monitor thread, created on
+ * the first start() from a thread, watches. Later start() and stop() calls
+ * make no system calls, which suits guarding many short operations; the
+ * trade-off is that expiration may be detected up to a quarter of the
+ * interval late. Available only on Linux.
+ *
  * Most applications will not directly invoke the methods of the WatchDog
  * class, instead using the BEGIN_WATCHDOG_BLOCK() and END_WATCHDOG_BLOCK()
  * macros. Applications should not install their own signal handlers, but
@@ -91,6 +107,11 @@ namespace BiometricEvaluation {
  * may expire, forcing a jump into an incompletely initialized function.
  *
  * @note
+ * Signals from the process-wide PROCESSTIME and REALTIME timers may be
+ * delivered to any thread, and are ignored by threads not inside a
+ * watchdog block. Multithreaded applications should use the thread types.
+ *
+ * @note
  * Process virtual timing may not be available on all systems. In
  * those cases, an application compilation error will occur because
  * PROCESSTIME will not be defined.
@@ -116,6 +137,22 @@ namespace BiometricEvaluation {
 			static const uint8_t PROCESSTIME = 0;
 			/** A Watchdog based on real (wall clock) time. */
 			static const uint8_t REALTIME = 1;
+			/**
+			 * A Watchdog based on real time, signaling only the
+			 * thread that started it.
+			 */
+			static const uint8_t THREADREALTIME = 2;
+			/**
+			 * A Watchdog based on the CPU time of the thread
+			 * that started it.
+			 */
+			static const uint8_t THREADTIME = 3;
+			/**
+			 * A Watchdog based on real time, checked by a
+			 * monitor thread and signaling only the thread that
+			 * started it.
+			 */
+			static const uint8_t MONITORED = 4;
 
 			/**
 			 * Construct a new Watchdog object.
@@ -131,6 +168,10 @@ namespace BiometricEvaluation {
 			 * @warning
 			 *	Watchdog::PROCESSTIME is not supported under
 			 *	Cygwin.
+			 * @warning
+			 *	Watchdog::THREADREALTIME,
+			 *	Watchdog::THREADTIME, and Watchdog::MONITORED
+			 *	are only supported under Linux.
 			 */
 			Watchdog(const uint8_t type);
 
@@ -147,6 +188,14 @@ namespace BiometricEvaluation {
 			 */
 			void setInterval(uint64_t interval);
 
+			/**
+			 * Obtain the interval for the timer.
+			 *
+			 * @return
+			 *	The timer interval, in microseconds.
+			 */
+			uint64_t getInterval() const;
+
 			/**
 			 * Start a watchdog timer.
 			 *
@@ -194,10 +243,11 @@ namespace BiometricEvaluation {
 
 			/*
 			 * Flag indicating can jump after handling a signal,
-			 * and the jump buffer used by the signal handler.
+			 * and the jump buffer used by the signal handler,
+			 * both private to each thread.
 			 */
-			static bool _canSigJump;
-			static sigjmp_buf _sigJumpBuf;
+			static thread_local bool _canSigJump;
+			static thread_local sigjmp_buf _sigJumpBuf;
 
 		protected:
 
@@ -233,6 +283,32 @@ namespace BiometricEvaluation {
 			 * to the system signal number and which system timer.
 			 */
 			void internalMapWatchdogType(int *signo, int *which);
+
+			/*
+			 * Per-thread system timer used by the thread types,
+			 * created on first start() from a thread.
+			 */
+			class ThreadTimer;
+			std::shared_ptr<ThreadTimer> _threadTimer;
+
+			/*
+			 * Start and stop the per-thread system timer.
+			 */
+			void startThreadTimer();
+			void stopThreadTimer();
+
+			/*
+			 * Monitor thread used by the MONITORED type, created
+			 * on first start() from a thread.
+			 */
+			class Monitor;
+			std::shared_ptr<Monitor> _monitor;
+
+			/*
+			 * Publish and withdraw the monitored deadline.
+			 */
+			void startMonitor();
+			void stopMonitor();
 		};
 		/*
 		 * Declaration of the signal handler, a function with C linkage
@@ -45,6 +45,19 @@ namespace BiometricEvaluation
 			MPEG4PS		= 3,
 			AVI		= 4 
 		};
+		/** Algorithms used to scale and convert frames. */
+		enum class ScalingAlgorithm
+		{
+			/** Accurate rounding (default) */
+			Accurate	= 0,
+			Bicubic		= 1,
+			Bilinear	= 2,
+			/** Fastest, with lower quality */
+			FastBilinear	= 3,
+			/** Nearest neighbor */
+			Point		= 4
+		};
+
 		struct Frame {
 			Image::Size size;
 			int64_t timestamp;
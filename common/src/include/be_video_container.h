@@ -59,6 +59,13 @@ namespace BiometricEvaluation
 			/**
 			 * @brief
 			 * Construct a Container from file.
+			 * @details
+			 * The file is mapped into memory rather than read,
+			 * so memory usage does not depend on the size of
+			 * the container, and multiple processes reading
+			 * the same file share its pages. The file must not
+			 * be modified while the Container, or any Stream
+			 * obtained from it, exists.
 			 * @throw Error::ObjectDoesNotExist
 			 * File does not exist.
 			 * @throw Error::MemoryError
@@ -11,6 +11,8 @@
 #ifndef __BE_VIDEO_STREAM_H
 #define __BE_VIDEO_STREAM_H
 
+#include <functional>
+
 #include <be_image.h>
 #include <be_video.h>
 namespace BiometricEvaluation 
@@ -82,6 +84,60 @@ namespace BiometricEvaluation
 			    int64_t startTime,
 			    int64_t endTime) = 0;
 
+			/**
+			 * @brief
+			 * Process a sequence of frames from the video stream
+			 * without retaining them.
+			 * @details
+			 * Each frame between the start and end times is
+			 * passed to a callback as it is decoded. The same
+			 * Frame object, and its buffer, is used for every
+			 * call, so memory use does not depend on the length
+			 * of the sequence. Callbacks must copy any frame
+			 * that is needed after returning.
+			 * @param startTime
+			 * Approximate time of the starting frame, milliseconds.
+			 * @param endTime
+			 * Approximate time of the ending frame, milliseconds
+			 * @param callback
+			 * Function called with each frame. Return false to
+			 * stop processing the sequence.
+			 * @return
+			 * Number of frames passed to callback.
+			 *
+			 * @throws
+			 * Error::StrategyError
+			 * No codec available for the video stream or
+			 * other failure to read the stream.
+			 */
+			virtual uint64_t processFrameSequence(
+			    int64_t startTime,
+			    int64_t endTime,
+			    const std::function<bool(const Video::Frame&)>
+				&callback) = 0;
+
+			/**
+			 * @brief
+			 * Obtain the frame following the last frame decoded.
+			 * @details
+			 * Frames returned by getFrame() from its cache of
+			 * recent frames do not change the stream position.
+			 * The frame's buffer is reused when it is large
+			 * enough, so passing the same Frame to successive
+			 * calls avoids allocating memory for every frame.
+			 * @param frame
+			 * Frame to be filled in.
+			 * @return
+			 * true if a frame was read, false if there are no
+			 * more frames in the stream.
+			 *
+			 * @throws
+			 * Error::StrategyError
+			 * Failure to convert the frame.
+			 */
+			virtual bool getNextFrame(
+			    Video::Frame &frame) = 0;
+
 			/**
 			 * @brief
 			 * Set the scaling factors for returned video frames.
@@ -96,6 +152,22 @@ namespace BiometricEvaluation
 			    float xScale,
 			    float yScale) = 0;
 
+			/**
+			 * @brief
+			 * Set the algorithm used to scale and convert
+			 * returned video frames.
+			 * @details
+			 * Faster algorithms are useful when frames are
+			 * converted at the decoding rate of long videos.
+			 * 
+			 * @param algorithm
+			 * The scaling algorithm; the default is
+			 * ScalingAlgorithm::Accurate.
+			 *
+			 */
+			virtual void setFrameScalingAlgorithm(
+			    const ScalingAlgorithm algorithm) = 0;
+
 			/**
 			 * @brief
 			 * Set the pixel format for returned video frames.
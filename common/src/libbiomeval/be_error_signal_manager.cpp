@@ -11,23 +11,55 @@
 #include <csetjmp>
 #include <csignal>
 #include <iostream>
+#include <map>
+#include <mutex>
 
 #include <be_error_signal_manager.h>
 
-bool BiometricEvaluation::Error::SignalManager::_canSigJump = false;
-sigjmp_buf BiometricEvaluation::Error::SignalManager::_sigJumpBuf;
+thread_local bool BiometricEvaluation::Error::SignalManager::_canSigJump =
+    false;
+thread_local sigjmp_buf BiometricEvaluation::Error::SignalManager::_sigJumpBuf;
+
+/*
+ * Number of started SignalManagers handling each signal, shared by all
+ * threads so one thread's stop() cannot remove a handler another thread
+ * is relying on.
+ */
+static std::mutex activeSignalMutex;
+static std::map<int, uint32_t> activeSignalCount;
+
+/* Signals raised by the faulting instruction itself */
+static bool
+isSynchronousSignal(
+    int signo)
+{
+	return ((signo == SIGSEGV) || (signo == SIGBUS) || (signo == SIGFPE) ||
+	    (signo == SIGILL));
+}
 
 /*
  * The signal handler, with C linkage.
  */
 void
 BiometricEvaluation::Error::SignalManagerSighandler(
-    int /* signo */, siginfo_t * /* info */, void * /* uap */)
+    int signo, siginfo_t * /* info */, void * /* uap */)
 {
 	if (Error::SignalManager::_canSigJump) {
 		siglongjmp(
 		    BiometricEvaluation::Error::SignalManager::_sigJumpBuf, 1);
 	}
+
+	/*
+	 * Another thread's block has the handler installed. Returning from
+	 * a fault would retry the faulting instruction forever, so let it
+	 * fault again with the default disposition.
+	 */
+	if (isSynchronousSignal(signo)) {
+		struct sigaction sa{};
+		sigemptyset(&sa.sa_mask);
+		sa.sa_handler = SIG_DFL;
+		(void)sigaction(signo, &sa, nullptr);
+	}
 }
 
 static bool
@@ -45,6 +77,7 @@ validSignalSet(const sigset_t sigset)
 BiometricEvaluation::Error::SignalManager::SignalManager()
 {
 	_canSigJump = false;
+	(void)sigemptyset(&_activeSignalSet);
 	this->setDefaultSignalSet();
 }
 
@@ -55,6 +88,7 @@ BiometricEvaluation::Error::SignalManager::SignalManager(
 		throw (Error::ParameterError("Invalid signal set"));
 	}
 	_canSigJump = false;
+	(void)sigemptyset(&_activeSignalSet);
 	_signalSet = signalSet;
 }
 
@@ -95,15 +129,20 @@ BiometricEvaluation::Error::SignalManager::start()
 	sigemptyset(&sa.sa_mask);
 	sa.sa_flags = SA_SIGINFO;
 	sa.sa_sigaction = SignalManagerSighandler;
+
+	std::lock_guard<std::mutex> lock(activeSignalMutex);
 	for (int sig = SIGHUP; sig <= SIGUSR2; sig++) {
 		if ((sig == SIGKILL) || (sig == SIGSTOP)) {
 			continue;
 		}
-		if (sigismember(&_signalSet, sig)) {
+		if (sigismember(&_signalSet, sig) &&
+		    !sigismember(&_activeSignalSet, sig)) {
 			if (sigaction(sig, &sa, nullptr) == -1) {
 				throw (Error::StrategyError(
 				    "Registering signal handler failed"));
 			}
+			activeSignalCount[sig]++;
+			(void)sigaddset(&_activeSignalSet, sig);
 		}
 	}
 	_canSigJump = true;
@@ -112,22 +151,29 @@ BiometricEvaluation::Error::SignalManager::start()
 void
 BiometricEvaluation::Error::SignalManager::stop()
 {
+	_canSigJump = false;
+
 	struct sigaction sa{};
 	sigemptyset(&sa.sa_mask);
 	sa.sa_flags = 0;
 	sa.sa_handler = SIG_DFL;
+
+	std::lock_guard<std::mutex> lock(activeSignalMutex);
 	for (int sig = SIGHUP; sig <= SIGUSR2; sig++) {
 		if ((sig == SIGKILL) || (sig == SIGSTOP)) {
 			continue;
 		}
-		if (sigismember(&_signalSet, sig)) {
+		if (!sigismember(&_activeSignalSet, sig)) {
+			continue;
+		}
+		(void)sigdelset(&_activeSignalSet, sig);
+		if (--activeSignalCount[sig] == 0) {
 			if (sigaction(sig, &sa, nullptr) == -1) {
 				throw (Error::StrategyError(
 				    "Setting default signal handler failed"));
 			}
 		}
 	}
-	_canSigJump = false;
 }
 
 void
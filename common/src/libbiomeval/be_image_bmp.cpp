@@ -8,16 +8,28 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
 #include <be_image_bmp.h>
 
 BiometricEvaluation::Image::BMP::BMP(
     const uint8_t *data,
     const uint64_t size) :
+    BiometricEvaluation::Image::BMP::BMP(
+    Memory::SharedBuffer(Memory::ByteView(data, size)))
+{
+
+}
+
+BiometricEvaluation::Image::BMP::BMP(
+    const Memory::SharedBuffer &data) :
     Image::Image(data,
-    size,
     CompressionAlgorithm::BMP)
 {
-	if (BMP::isBMP(data, size) == false)
+	if (BMP::isBMP(this->getDataPointer(),
+	    this->getDataSize()) == false)
 		throw Error::StrategyError("Not a BMP");
 
 	BITMAPINFOHEADER dibHeader;
@@ -27,7 +39,8 @@ BiometricEvaluation::Image::BMP::BMP(
 		 * if this type of BMP is supported.
 		 */
 		BMPHeader bmpHeader;
-		BMP::getBMPHeader(data, size, &bmpHeader);
+		BMP::getBMPHeader(this->getDataPointer(),
+		    this->getDataSize(), &bmpHeader);
 
 		/* 
 		 * The types of BMP supported in this class do not support
@@ -35,7 +48,8 @@ BiometricEvaluation::Image::BMP::BMP(
 		 */
 		this->setHasAlphaChannel(false);
 
-		BMP::getDIBHeader(data, size, &dibHeader);
+		BMP::getDIBHeader(this->getDataPointer(),
+		    this->getDataSize(), &dibHeader);
 	} catch (Error::NotImplemented &e) {
 		throw Error::StrategyError(e.what());
 	}
@@ -85,33 +99,32 @@ BiometricEvaluation::Image::BMP::getRawData()
 	if ((bmpDataSize + 12 + 40) < imageSize)
 		throw Error::DataError("Buffer length too small");
 
-	/*
-	 * Stride is size of the BMP data storage area for each row,
-	 * not including padding of 4 bytes max, so account for the
-	 * padding later.
-	 */
-	uint64_t stride = (dibHeader.bitsPerPixel / 8) * dibHeader.width;
-	int padSz = dibHeader.width % 4;
 	switch (dibHeader.compressionMethod) {
 	case BI_RGB: {
-		const uint8_t *bmpRow = nullptr;
-		uint8_t *rawRow = nullptr;
+		/*
+		 * Stride is the size of the decoded data for each row.
+		 * Stored rows are padded to a multiple of 4 bytes.
+		 */
+		const uint64_t bytesPerPixel = dibHeader.bitsPerPixel / 8;
+		const uint64_t stride = bytesPerPixel * dibHeader.width;
+		const uint64_t storedStride = (stride + 3) & ~3ULL;
+		if ((absHeight > 0) && (bmpDataSize <
+		    (bmpHeader.startingAddress +
+		    (storedStride * (absHeight - 1)) + stride)))
+			throw Error::DataError("Buffer length too small");
 
 		for (int32_t row = 0; row < absHeight; row++) {
-			rawRow = rawData + (row * stride);
+			uint8_t *rawRow = rawData + (row * stride);
 			/* Pixels are stored top to bottom if height is < 0 */
-			if (dibHeader.height < 0) {
-				bmpRow = bmpData + bmpHeader.startingAddress +
-				    (row * (stride + padSz));
-			} else {
-				bmpRow = bmpData + bmpHeader.startingAddress +
-				    ((absHeight - row - 1) * (stride + padSz));
-			}
+			const uint8_t *bmpRow = bmpData +
+			    bmpHeader.startingAddress + (storedStride *
+			    ((dibHeader.height < 0) ? row :
+			    (absHeight - row - 1)));
+
 			switch (dibHeader.bitsPerPixel) {
 			case 32:
 				/* BGRA -> RGBA */
-				for (uint64_t i = 0; i <= (stride - 4);
-				    i += 4) {
+				for (uint64_t i = 0; i < stride; i += 4) {
 					rawRow[i] = bmpRow[i + 2];
 					rawRow[i + 1] = bmpRow[i + 1];
 					rawRow[i + 2] = bmpRow[i];
@@ -120,43 +133,26 @@ BiometricEvaluation::Image::BMP::getRawData()
 				break;
 			case 24:
 				/* BGR -> RGB */
-				for (uint64_t i = 0; i <= (stride - 3);
-				    i += 3) {
+				for (uint64_t i = 0; i < stride; i += 3) {
 					rawRow[i] = bmpRow[i + 2];
 					rawRow[i + 1] = bmpRow[i + 1];
 					rawRow[i + 2] = bmpRow[i];
 				}
 				break;
 			case 8:
-				memcpy(rawRow, bmpRow, stride);
+				std::memcpy(rawRow, bmpRow, stride);
 				break;
+			default:
+				throw Error::NotImplemented("Unsupported BMP "
+				    "bit depth");
 			}
 		}
 		break;
 	}
 	case BI_RLE8:
+		/* Decoded directly in top to bottom order */
 		BMP::rle8Decoder(bmpData, bmpDataSize, rawData, &bmpHeader,
 		    &dibHeader);
-
-		/* Pixels are stored top to bottom if height is negative */
-		if (dibHeader.height > 0) {
-			/* Reverse rows */
-			/* TODO: This should really be done in rle8Decoder() */
-			Memory::uint8Array tempRow(dibHeader.width);
-			for (int32_t rowFwd = 0, rowBack = absHeight - 1;
-			    rowFwd < rowBack;
-			    rowFwd++, rowBack--) {
-				std::memcpy(tempRow,
-				    rawData + (rowFwd * stride),
-				    dibHeader.width);
-				std::memcpy(rawData + (rowFwd * stride),
-				    rawData + (rowBack * stride),
-				    dibHeader.width);
-				std::memcpy(rawData + (rowBack * stride),
-				    tempRow,
-				    dibHeader.width);
-			}
-		}
 		break;
 	default:
 		throw Error::NotImplemented("Unsupported compression method");
@@ -277,49 +273,66 @@ BiometricEvaluation::Image::BMP::rle8Decoder(
 	if ((dibHeader->compressionMethod != BI_RLE8) ||
 	    (dibHeader->bitsPerPixel != 8))
 		throw Error::NotImplemented("Not RLE8 compressed");
-		
-	output.resize(dibHeader->width * abs(dibHeader->height));
 
-	uint8_t byte1, byte2;
-	uint64_t outputOffset = 0;
+	const uint32_t width = dibHeader->width;
+	const uint32_t absHeight = abs(dibHeader->height);
+	output.resize(static_cast<uint64_t>(width) * absHeight);
+	/* Colors of skipped pixels are undefined, so make them 0 */
+	std::memset(output, 0, output.size());
+
+	/*
+	 * Rows are encoded in the order they are stored, which is bottom
+	 * to top unless height is negative, so place each one in its
+	 * final position as it is decoded.
+	 */
+	const bool bottomUp = (dibHeader->height > 0);
+	uint64_t x = 0, y = 0;
+	const auto pixelsLeftInRow = [&](uint64_t count) -> uint64_t {
+		if ((y >= absHeight) || (x >= width))
+			return (0);
+		return (std::min<uint64_t>(count, width - x));
+	};
+	const auto rowStart = [&]() -> uint8_t* {
+		return (output + ((bottomUp ? (absHeight - 1 - y) : y) *
+		    static_cast<uint64_t>(width)));
+	};
+
 	for (uint64_t inputOffset = bmpHeader->startingAddress;
-	    inputOffset < inputSize; ) {
-		byte1 = input[inputOffset];
-		byte2 = input[inputOffset + 1];
+	    (inputOffset + 1) < inputSize; ) {
+		const uint8_t byte1 = input[inputOffset];
+		const uint8_t byte2 = input[inputOffset + 1];
 
 		if (byte1 == 0) {
 			switch (byte2) {
 			case 0: /* Encoded mode: End of line */
-				/* 
-				 * Colors after EOL are undefined, as there
-				 * shouldn't be any.
-				 */
-				while ((outputOffset % dibHeader->width) != 0)
-					outputOffset++;
-					
+				x = 0;
+				y++;
 				inputOffset += 2;
-				continue;
+				break;
 			case 1: /* Encoded mode: End of bitmap */
 				return;
 			case 2: /* Encoded mode: Delta */
-				/* Colors for delta-skipped pixels undefined */
 				/* byte3 = num pixels, byte4 = num rows */
-				outputOffset += input[inputOffset + 2];
-				outputOffset +=
-				    (input[inputOffset + 3] * dibHeader->width);
-
+				if ((inputOffset + 3) >= inputSize)
+					return;
+				x += input[inputOffset + 2];
+				y += input[inputOffset + 3];
 				inputOffset += 4;
 				break;
-			default: /* Absolute mode */
+			default: { /* Absolute mode */
 				/* byte2 = count, byte3..n = data */
-				memcpy(output + outputOffset,
-				    input + inputOffset + 3, byte2);
-				inputOffset += (2 + byte2);
-				outputOffset += byte2;
+				const uint64_t count = std::min<uint64_t>(
+				    byte2, inputSize - (inputOffset + 2));
+				const uint64_t n = pixelsLeftInRow(count);
+				if (n > 0)
+					std::memcpy(rowStart() + x,
+					    input + inputOffset + 2, n);
+				x += byte2;
 
 				/* Data must end on a word boundary */
-				while ((inputOffset % 8) != 0)
-					inputOffset++;
+				inputOffset += 2 + byte2 + (byte2 & 1);
+				break;
+			}
 			}
 		} else {
 			/*
@@ -327,11 +340,12 @@ BiometricEvaluation::Image::BMP::rle8Decoder(
 			 */
 			 
 			/* byte1 = count, byte2 = color */
-			memset(output + outputOffset, byte2, byte1);
+			const uint64_t n = pixelsLeftInRow(byte1);
+			if (n > 0)
+				std::memset(rowStart() + x, byte2, n);
 			
 			inputOffset += 2;
-			outputOffset += byte1;
+			x += byte1;
 		}
 	}
 }
-
@@ -37,24 +37,59 @@ BiometricEvaluation::Image::Image::Image(
     const Resolution resolution,
     const CompressionAlgorithm compressionAlgorithm,
     const bool hasAlphaChannel) :
+    BiometricEvaluation::Image::Image::Image(
+    Memory::SharedBuffer(Memory::ByteView(data, size)),
+    dimensions,
+    colorDepth,
+    bitDepth,
+    resolution,
+    compressionAlgorithm,
+    hasAlphaChannel)
+{
+
+}
+
+BiometricEvaluation::Image::Image::Image(
+    const uint8_t *data,
+    const uint64_t size,
+    const CompressionAlgorithm compressionAlgorithm) :
+    BiometricEvaluation::Image::Image::Image(
+    data,
+    size,
+    Size(),
+    0,
+    0,
+    Resolution(),
+    compressionAlgorithm,
+    false)
+{
+
+}
+
+BiometricEvaluation::Image::Image::Image(
+    const Memory::SharedBuffer &data,
+    const Size dimensions,
+    const uint32_t colorDepth,
+    const uint16_t bitDepth,
+    const Resolution resolution,
+    const CompressionAlgorithm compressionAlgorithm,
+    const bool hasAlphaChannel) :
     _dimensions(dimensions),
     _colorDepth(colorDepth),
     _hasAlphaChannel(hasAlphaChannel),
     _bitDepth(bitDepth),
     _resolution(resolution),
-    _data(size),
+    _data(data),
     _compressionAlgorithm(compressionAlgorithm)
 {
-	std::memcpy(_data, data, size);
+
 }
 
 BiometricEvaluation::Image::Image::Image(
-    const uint8_t *data,
-    const uint64_t size,
+    const Memory::SharedBuffer &data,
     const CompressionAlgorithm compressionAlgorithm) :
     BiometricEvaluation::Image::Image::Image(
     data,
-    size,
     Size(),
     0,
     0,
@@ -257,7 +292,16 @@ BiometricEvaluation::Memory::uint8Array
 BiometricEvaluation::Image::Image::getData()
     const
 {
-	return (Memory::uint8Array(_data));
+	Memory::uint8Array data;
+	data.copy(this->_data.data(), this->_data.size());
+	return (data);
+}
+
+BiometricEvaluation::Memory::SharedBuffer
+BiometricEvaluation::Image::Image::getSharedData()
+    const
+{
+	return (this->_data);
 }
 
 void
@@ -292,7 +336,7 @@ const uint8_t *
 BiometricEvaluation::Image::Image::getDataPointer()
     const
 {
-	return (&(*(this->_data)));
+	return (this->_data.data());
 }
 
 uint64_t
@@ -329,25 +373,33 @@ BiometricEvaluation::Image::Image::openImage(
     const uint8_t *data,
     const uint64_t size)
 {
-	switch (Image::getCompressionAlgorithm(data, size)) {
+	return (Image::openImage(Memory::SharedBuffer(
+	    Memory::ByteView(data, size))));
+}
+
+std::shared_ptr<BiometricEvaluation::Image::Image>
+BiometricEvaluation::Image::Image::openImage(
+    const Memory::SharedBuffer &data)
+{
+	switch (Image::getCompressionAlgorithm(data.data(), data.size())) {
 	case CompressionAlgorithm::JPEGB:
-		return (std::shared_ptr<Image>(new JPEG(data, size)));
+		return (std::shared_ptr<Image>(new JPEG(data)));
 	case CompressionAlgorithm::JPEGL:
-		return (std::shared_ptr<Image>(new JPEGL(data, size)));
+		return (std::shared_ptr<Image>(new JPEGL(data)));
 	case CompressionAlgorithm::JP2:
 		/* FALLTHROUGH */
 	case CompressionAlgorithm::JP2L:
-		return (std::shared_ptr<Image>(new JPEG2000(data, size)));
+		return (std::shared_ptr<Image>(new JPEG2000(data)));
 	case CompressionAlgorithm::PNG:
-		return (std::shared_ptr<Image>(new PNG(data, size)));
+		return (std::shared_ptr<Image>(new PNG(data)));
 	case CompressionAlgorithm::NetPBM:
-		return (std::shared_ptr<Image>(new NetPBM(data, size)));
+		return (std::shared_ptr<Image>(new NetPBM(data)));
 	case CompressionAlgorithm::WSQ20:
-		return (std::shared_ptr<Image>(new WSQ(data, size)));
+		return (std::shared_ptr<Image>(new WSQ(data)));
 	case CompressionAlgorithm::BMP:
-		return (std::shared_ptr<Image>(new BMP(data, size)));
+		return (std::shared_ptr<Image>(new BMP(data)));
 	case CompressionAlgorithm::TIFF:
-		return (std::shared_ptr<Image>(new TIFF(data, size)));
+		return (std::shared_ptr<Image>(new TIFF(data)));
 	default:
 		throw Error::StrategyError("Could not determine compression "
 		    "algorithm");
@@ -361,12 +413,18 @@ BiometricEvaluation::Image::Image::openImage(
 	return (Image::openImage(data, data.size()));
 }
 
+std::shared_ptr<BiometricEvaluation::Image::Image>
+BiometricEvaluation::Image::Image::openImage(
+    Memory::uint8Array &&data)
+{
+	return (Image::openImage(Memory::SharedBuffer(std::move(data))));
+}
+
 std::shared_ptr<BiometricEvaluation::Image::Image>
 BiometricEvaluation::Image::Image::openImage(
     const std::string &path)
 {
-	Memory::uint8Array data = IO::Utility::readFile(path);
-	return (Image::openImage(data));
+	return (Image::openImage(IO::Utility::readFile(path)));
 }
 
 BiometricEvaluation::Image::CompressionAlgorithm
@@ -374,6 +432,10 @@ BiometricEvaluation::Image::Image::getCompressionAlgorithm(
     const uint8_t *data,
     const uint64_t size)
 {
+	/* No format can be identified without at least a magic number */
+	if ((data == nullptr) || (size == 0))
+		return (CompressionAlgorithm::None);
+
 	if (NetPBM::isNetPBM(data, size))
 		return (CompressionAlgorithm::NetPBM);
 	else if (JPEG2000::isJPEG2000(data, size))
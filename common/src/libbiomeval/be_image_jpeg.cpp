@@ -8,7 +8,10 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <cstdio>		/* Needed for NBIS headers */
+#include <memory>
 #include <sstream>
 
 extern "C" {
@@ -19,12 +22,68 @@ extern "C" {
 
 #include <be_image_jpeg.h>
 
+/** Smallest initial size of an encoded buffer */
+static const uint64_t MIN_ENCODED_BUFFER_SIZE = 4096;
+
+/**
+ * @brief
+ * libjpeg destination manager that writes to a Memory::uint8Array.
+ */
+struct jpeg_uint8array_destination_mgr
+{
+	/** libjpeg's fields, first so cinfo->dest can be cast to this */
+	struct jpeg_destination_mgr pub;
+	/** Buffer receiving encoded data, grown as needed */
+	BiometricEvaluation::Memory::uint8Array *buffer;
+};
+
+static void
+jpegInitDestination(
+    j_compress_ptr cinfo)
+{
+	auto dest = reinterpret_cast<jpeg_uint8array_destination_mgr *>(
+	    cinfo->dest);
+	dest->pub.next_output_byte = *(dest->buffer);
+	dest->pub.free_in_buffer = dest->buffer->size();
+}
+
+static boolean
+jpegEmptyOutputBuffer(
+    j_compress_ptr cinfo)
+{
+	/* Only called when the entire buffer has been filled */
+	auto dest = reinterpret_cast<jpeg_uint8array_destination_mgr *>(
+	    cinfo->dest);
+	const uint64_t used = dest->buffer->size();
+	dest->buffer->resize(used * 2);
+	dest->pub.next_output_byte = *(dest->buffer) + used;
+	dest->pub.free_in_buffer = dest->buffer->size() - used;
+
+	return (TRUE);
+}
+
+static void
+jpegTermDestination(
+    j_compress_ptr cinfo)
+{
+	auto dest = reinterpret_cast<jpeg_uint8array_destination_mgr *>(
+	    cinfo->dest);
+	dest->buffer->resize(dest->buffer->size() - dest->pub.free_in_buffer);
+}
+
 BiometricEvaluation::Image::JPEG::JPEG(
     const uint8_t *data,
     const uint64_t size) :
+    BiometricEvaluation::Image::JPEG::JPEG(
+    Memory::SharedBuffer(Memory::ByteView(data, size)))
+{
+
+}
+
+BiometricEvaluation::Image::JPEG::JPEG(
+    const Memory::SharedBuffer &data) :
     Image::Image(
     data,
-    size,
     CompressionAlgorithm::JPEGB)
 {
 	/* Initialize custom JPEG error manager to throw exceptions */
@@ -185,6 +244,100 @@ BiometricEvaluation::Image::JPEG::getRawGrayscaleData(
 	return (rawGray);
 }
 
+BiometricEvaluation::Image::JPEG::EncodeOptions::EncodeOptions()
+{
+
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::JPEG::encode(
+    const Image &image,
+    const EncodeOptions &options)
+{
+	if ((options.quality < 1) || (options.quality > 100))
+		throw Error::ParameterError("Invalid JPEG quality");
+	if (image.getBitDepth() != 8)
+		throw Error::ParameterError("JPEG encoding requires 8-bit "
+		    "samples");
+	const uint32_t channels = (image.getColorDepth() / 8) -
+	    (image.hasAlphaChannel() ? 1 : 0);
+	if ((channels != 1) && (channels != 3))
+		throw Error::ParameterError("JPEG encoding requires grayscale "
+		    "or RGB samples");
+
+	const Size dimensions = image.getDimensions();
+	const Memory::uint8Array rawData = image.getRawData(true);
+	const uint64_t rowSize = static_cast<uint64_t>(dimensions.xSize) *
+	    channels;
+	if (rawData.size() < (rowSize * dimensions.ySize))
+		throw Error::DataError("Not enough raw data for dimensions");
+
+	/* Initialize custom JPEG error manager to throw exceptions */
+	struct jpeg_error_mgr jpeg_error_mgr;
+	jpeg_std_error(&jpeg_error_mgr);
+	jpeg_error_mgr.error_exit = JPEG::error_exit;
+
+	struct jpeg_compress_struct cinfo;
+	cinfo.err = &jpeg_error_mgr;
+	jpeg_create_compress(&cinfo);
+	std::unique_ptr<jpeg_compress_struct, void(*)(j_compress_ptr)>
+	    cinfoGuard(&cinfo, jpeg_destroy_compress);
+
+	Memory::uint8Array encodedData(std::max(MIN_ENCODED_BUFFER_SIZE,
+	    rawData.size() / 8));
+	jpeg_uint8array_destination_mgr dest;
+	dest.pub.init_destination = jpegInitDestination;
+	dest.pub.empty_output_buffer = jpegEmptyOutputBuffer;
+	dest.pub.term_destination = jpegTermDestination;
+	dest.buffer = &encodedData;
+	cinfo.dest = &dest.pub;
+
+	cinfo.image_width = dimensions.xSize;
+	cinfo.image_height = dimensions.ySize;
+	cinfo.input_components = channels;
+	cinfo.in_color_space = ((channels == 1) ? JCS_GRAYSCALE : JCS_RGB);
+	jpeg_set_defaults(&cinfo);
+	jpeg_set_quality(&cinfo, options.quality, TRUE);
+	switch (options.dctMethod) {
+	case DCTMethod::Integer:
+		cinfo.dct_method = JDCT_ISLOW;
+		break;
+	case DCTMethod::FastInteger:
+		cinfo.dct_method = JDCT_IFAST;
+		break;
+	case DCTMethod::Float:
+		cinfo.dct_method = JDCT_FLOAT;
+		break;
+	}
+	cinfo.optimize_coding = (options.optimizeCoding ? TRUE : FALSE);
+	if (options.progressive)
+		jpeg_simple_progression(&cinfo);
+
+	/* Constructor reads JFIF density as pixels per inch */
+	const Resolution resolution = image.getResolution();
+	if (resolution.units != Resolution::Units::NA) {
+		const Resolution ppi = resolution.toUnits(
+		    Resolution::Units::PPI);
+		cinfo.write_JFIF_header = TRUE;
+		cinfo.density_unit = 1;
+		cinfo.X_density = static_cast<UINT16>(std::min(
+		    std::round(ppi.xRes), 65535.0));
+		cinfo.Y_density = static_cast<UINT16>(std::min(
+		    std::round(ppi.yRes), 65535.0));
+	}
+
+	jpeg_start_compress(&cinfo, TRUE);
+	JSAMPROW row[1];
+	while (cinfo.next_scanline < cinfo.image_height) {
+		row[0] = const_cast<JSAMPROW>(static_cast<const uint8_t *>(
+		    rawData) + (cinfo.next_scanline * rowSize));
+		jpeg_write_scanlines(&cinfo, row, 1);
+	}
+	jpeg_finish_compress(&cinfo);
+
+	return (encodedData);
+}
+
 bool
 BiometricEvaluation::Image::JPEG::isJPEG(
     const uint8_t *data,
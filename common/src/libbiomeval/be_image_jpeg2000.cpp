@@ -10,19 +10,156 @@
 
 #include <openjpeg.h>
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include <be_image_jpeg2000.h>
 #include <be_memory_mutableindexedbuffer.h>
 
 namespace BE = BiometricEvaluation;
 
+const int8_t BiometricEvaluation::Image::JPEG2000::CODEC_J2K;
+const int8_t BiometricEvaluation::Image::JPEG2000::CODEC_JP2;
+static_assert(BE::Image::JPEG2000::CODEC_J2K == OPJ_CODEC_J2K,
+    "CODEC_J2K must match libopenjp2");
+static_assert(BE::Image::JPEG2000::CODEC_JP2 == OPJ_CODEC_JP2,
+    "CODEC_JP2 must match libopenjp2");
+
+/** Smallest initial size of an encoded buffer */
+static const uint64_t MIN_ENCODED_BUFFER_SIZE = 4096;
+
+/** Destination of a libopenjp2 compression stream */
+struct libopenjp2EncodedBuffer
+{
+	/** Encoded data, grown as needed */
+	BE::Memory::uint8Array data;
+	/** Position of the next write */
+	uint64_t offset;
+};
+
+/** Errors reported by libopenjp2 while encoding */
+struct libopenjp2Errors
+{
+	/** Held while appending, as encoding threads may report errors */
+	std::mutex mutex;
+	/** Each message reported, one per line */
+	std::string messages;
+};
+
+/**
+ * @brief
+ * Record an error from libopenjp2.
+ * @details
+ * Exceptions must not be thrown through libopenjp2, which may call
+ * this from its own threads, so the error is reported once the
+ * libopenjp2 function returns.
+ */
+static void
+libopenjp2Error(
+    const char *msg,
+    void *client_data)
+{
+	auto errors = static_cast<libopenjp2Errors *>(client_data);
+	try {
+		std::lock_guard<std::mutex> lock(errors->mutex);
+		std::string message(msg);
+		while (!message.empty() && (message.back() == '\n'))
+			message.pop_back();
+		if (!errors->messages.empty())
+			errors->messages += '\n';
+		errors->messages += message;
+	} catch (...) {}
+}
+
+/**
+ * @brief
+ * Ensure an encoded buffer holds at least a number of bytes.
+ * @details
+ * Capacity is doubled, so repeated small writes do not reallocate.
+ * Bytes skipped over are zero-filled.
+ */
+static void
+libopenjp2Reserve(
+    libopenjp2EncodedBuffer *buffer,
+    uint64_t size)
+{
+	const uint64_t oldSize = buffer->data.size();
+	if (size <= oldSize)
+		return;
+	if (size > buffer->data.capacity())
+		buffer->data.reserve(std::max(buffer->data.capacity() * 2,
+		    size));
+	buffer->data.resize(size);
+	std::memset(buffer->data + oldSize, 0, size - oldSize);
+}
+
+static OPJ_SIZE_T
+libopenjp2Write(
+    void *p_buffer,
+    OPJ_SIZE_T p_nb_bytes,
+    void *p_user_data)
+{
+	auto buffer = static_cast<libopenjp2EncodedBuffer *>(p_user_data);
+	try {
+		libopenjp2Reserve(buffer, buffer->offset + p_nb_bytes);
+	} catch (const BE::Error::Exception&) {
+		return (static_cast<OPJ_SIZE_T>(-1));
+	}
+	std::memcpy(buffer->data + buffer->offset, p_buffer, p_nb_bytes);
+	buffer->offset += p_nb_bytes;
+
+	return (p_nb_bytes);
+}
+
+static OPJ_OFF_T
+libopenjp2WriteSkip(
+    OPJ_OFF_T p_nb_bytes,
+    void *p_user_data)
+{
+	auto buffer = static_cast<libopenjp2EncodedBuffer *>(p_user_data);
+	if ((p_nb_bytes < 0) &&
+	    (static_cast<uint64_t>(-p_nb_bytes) > buffer->offset))
+		return (-1);
+	buffer->offset += p_nb_bytes;
+
+	return (p_nb_bytes);
+}
+
+static OPJ_BOOL
+libopenjp2WriteSeek(
+    OPJ_OFF_T p_nb_bytes,
+    void *p_user_data)
+{
+	if (p_nb_bytes < 0)
+		return (OPJ_FALSE);
+	static_cast<libopenjp2EncodedBuffer *>(p_user_data)->offset =
+	    p_nb_bytes;
+
+	return (OPJ_TRUE);
+}
+
 BiometricEvaluation::Image::JPEG2000::JPEG2000(
     const uint8_t *data,
     const uint64_t size,
     const int8_t codecFormat) :
+    BiometricEvaluation::Image::JPEG2000::JPEG2000(
+    Memory::SharedBuffer(Memory::ByteView(data, size)),
+    codecFormat)
+{
+
+}
+
+BiometricEvaluation::Image::JPEG2000::JPEG2000(
+    const Memory::SharedBuffer &data,
+    const int8_t codecFormat) :
     Image::Image(
     data,
-    size,
     CompressionAlgorithm::JP2),
     _codecFormat(codecFormat)
 {
@@ -180,6 +317,168 @@ BiometricEvaluation::Image::JPEG2000::getRawGrayscaleData(
 	return (Image::getRawGrayscaleData(depth));
 }
 
+BiometricEvaluation::Image::JPEG2000::EncodeOptions::EncodeOptions()
+{
+
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::JPEG2000::encode(
+    const Image &image,
+    const EncodeOptions &options)
+{
+	if ((options.codecFormat != CODEC_J2K) &&
+	    (options.codecFormat != CODEC_JP2))
+		throw Error::ParameterError("Unsupported encoding format: " +
+		    std::to_string(options.codecFormat));
+	if ((options.compressionRatio < 0) ||
+	    ((options.compressionRatio > 0) && (options.compressionRatio < 1)))
+		throw Error::ParameterError("Invalid compression ratio");
+	if (options.resolutionLevels == 0)
+		throw Error::ParameterError("Invalid number of resolution "
+		    "levels");
+
+	const uint16_t bitDepth = image.getBitDepth();
+	if ((bitDepth != 8) && (bitDepth != 16))
+		throw Error::ParameterError("JPEG-2000 encoding requires 8- "
+		    "or 16-bit samples");
+	const uint32_t channels = image.getColorDepth() / bitDepth;
+	const uint32_t colorChannels = channels -
+	    (image.hasAlphaChannel() ? 1 : 0);
+	if ((channels > 4) || ((colorChannels != 1) && (colorChannels != 3)))
+		throw Error::ParameterError("JPEG-2000 encoding requires "
+		    "grayscale or RGB samples");
+
+	const Size dimensions = image.getDimensions();
+	const uint64_t pixels = static_cast<uint64_t>(dimensions.xSize) *
+	    dimensions.ySize;
+	const Memory::uint8Array rawData = image.getRawData();
+	if (rawData.size() < (pixels * channels * (bitDepth / 8)))
+		throw Error::DataError("Not enough raw data for dimensions");
+
+	/* Separate interleaved samples into components */
+	std::vector<opj_image_cmptparm_t> componentParameters(channels);
+	for (auto &component : componentParameters) {
+		component.dx = 1;
+		component.dy = 1;
+		component.w = dimensions.xSize;
+		component.h = dimensions.ySize;
+		component.x0 = 0;
+		component.y0 = 0;
+		component.prec = bitDepth;
+		component.sgnd = 0;
+	}
+	opj_image_t *imagePtr = opj_image_create(channels,
+	    componentParameters.data(), ((colorChannels == 1) ?
+	    OPJ_CLRSPC_GRAY : OPJ_CLRSPC_SRGB));
+	if (imagePtr == nullptr)
+		throw Error::StrategyError("libopenjp2: opj_image_create");
+	std::unique_ptr<opj_image_t, void(*)(opj_image_t*)> opjImage(
+	    imagePtr, opj_image_destroy);
+	opjImage->x0 = 0;
+	opjImage->y0 = 0;
+	opjImage->x1 = dimensions.xSize;
+	opjImage->y1 = dimensions.ySize;
+	if (image.hasAlphaChannel())
+		opjImage->comps[channels - 1].alpha = 1;
+
+	const uint8_t *samples = rawData;
+	for (uint32_t c = 0; c < channels; c++) {
+		OPJ_INT32 *component = opjImage->comps[c].data;
+		if (bitDepth == 8) {
+			for (uint64_t i = 0; i < pixels; i++)
+				component[i] = samples[(i * channels) + c];
+		} else {
+			/* Raw samples are in native byte order */
+			uint16_t sample;
+			for (uint64_t i = 0; i < pixels; i++) {
+				std::memcpy(&sample, samples +
+				    (((i * channels) + c) * 2), 2);
+				component[i] = sample;
+			}
+		}
+	}
+
+	opj_cparameters_t parameters;
+	opj_set_default_encoder_parameters(&parameters);
+	parameters.tcp_numlayers = 1;
+	parameters.cp_disto_alloc = 1;
+	if (options.compressionRatio == 0) {
+		/* Reversible wavelet; a rate of 0 keeps every bit */
+		parameters.irreversible = 0;
+		parameters.tcp_rates[0] = 0;
+	} else {
+		parameters.irreversible = 1;
+		parameters.tcp_rates[0] = options.compressionRatio;
+	}
+	parameters.tcp_mct = ((colorChannels == 3) ? 1 : 0);
+
+	/* Each resolution level halves the smallest dimension */
+	const uint32_t smallestDimension = std::min(dimensions.xSize,
+	    dimensions.ySize);
+	parameters.numresolution = options.resolutionLevels;
+	while ((parameters.numresolution > 1) &&
+	    ((1u << (parameters.numresolution - 1)) > smallestDimension))
+		parameters.numresolution--;
+
+	/* Outlives codec, which reports errors to it */
+	libopenjp2Errors errors;
+	const auto failed = [&errors](const std::string &function) {
+		std::string message("libopenjp2: " + function);
+		if (!errors.messages.empty())
+			message += ": " + errors.messages;
+		return (Error::StrategyError(message));
+	};
+
+	std::unique_ptr<opj_codec_t, void(*)(opj_codec_t*)> codec(
+	    opj_create_compress(static_cast<OPJ_CODEC_FORMAT>(
+	    options.codecFormat)), opj_destroy_codec);
+	if (codec.get() == nullptr)
+		throw Error::StrategyError("libopenjp2: opj_create_compress");
+
+	/* Warnings do not prevent encoding */
+	opj_set_error_handler(codec.get(), libopenjp2Error, &errors);
+	opj_set_warning_handler(codec.get(), nullptr, nullptr);
+	opj_set_info_handler(codec.get(), nullptr, nullptr);
+
+#if defined(OPJ_VERSION_MAJOR) && ((OPJ_VERSION_MAJOR > 2) || \
+    ((OPJ_VERSION_MAJOR == 2) && (OPJ_VERSION_MINOR >= 5)))
+	uint32_t threads = options.threads;
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	/* Silently single-threaded if built without thread support */
+	opj_codec_set_threads(codec.get(), static_cast<int>(threads));
+#endif
+
+	if (opj_setup_encoder(codec.get(), &parameters, opjImage.get()) ==
+	    OPJ_FALSE)
+		throw failed("opj_setup_encoder");
+
+	libopenjp2EncodedBuffer encodedBuffer;
+	encodedBuffer.offset = 0;
+	encodedBuffer.data.reserve(std::max(MIN_ENCODED_BUFFER_SIZE,
+	    rawData.size() / 2));
+	std::unique_ptr<opj_stream_t, void(*)(opj_stream_t*)> stream(
+	    opj_stream_default_create(OPJ_FALSE), opj_stream_destroy);
+	if (stream.get() == nullptr)
+		throw Error::StrategyError("libopenjp2: "
+		    "opj_stream_default_create");
+	opj_stream_set_user_data(stream.get(), &encodedBuffer, nullptr);
+	opj_stream_set_write_function(stream.get(), libopenjp2Write);
+	opj_stream_set_skip_function(stream.get(), libopenjp2WriteSkip);
+	opj_stream_set_seek_function(stream.get(), libopenjp2WriteSeek);
+
+	if (opj_start_compress(codec.get(), opjImage.get(), stream.get()) ==
+	    OPJ_FALSE)
+		throw failed("opj_start_compress");
+	if (opj_encode(codec.get(), stream.get()) == OPJ_FALSE)
+		throw failed("opj_encode");
+	if (opj_end_compress(codec.get(), stream.get()) == OPJ_FALSE)
+		throw failed("opj_end_compress");
+
+	return (std::move(encodedBuffer.data));
+}
+
 bool
 BiometricEvaluation::Image::JPEG2000::isJPEG2000(
     const uint8_t *data,
@@ -21,9 +21,16 @@ extern "C" {
 BiometricEvaluation::Image::JPEGL::JPEGL(
     const uint8_t *data,
     const uint64_t size) :
+    BiometricEvaluation::Image::JPEGL::JPEGL(
+    Memory::SharedBuffer(Memory::ByteView(data, size)))
+{
+
+}
+
+BiometricEvaluation::Image::JPEGL::JPEGL(
+    const Memory::SharedBuffer &data) :
     Image::Image(
     data,
-    size,
     CompressionAlgorithm::JPEGL)
 {
 	uint8_t *markerBuf = (uint8_t *)this->getDataPointer();
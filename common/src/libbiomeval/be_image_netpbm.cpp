@@ -8,8 +8,11 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <sstream>
 #include <type_traits>
 
@@ -30,15 +33,126 @@ BE_FRAMEWORK_ENUMERATION_DEFINITIONS(
     BiometricEvaluation::Image::NetPBM::Kind,
     BE_Image_NetPBM_Kind_EnumToStringMap);
 
+/*
+ * Helpers for decoding image data.
+ */
+
+/** @return Whether c separates values in a NetPBM file */
+static inline bool
+isNetPBMSpace(
+    uint8_t c)
+{
+	return ((c == ' ') || (c == '\t') || (c == '\n') || (c == '\r') ||
+	    (c == '\v') || (c == '\f'));
+}
+
+/**
+ * @brief
+ * Advance past whitespace and comments to the next value.
+ *
+ * @param data
+ *	ASCII NetPBM data.
+ * @param dataSize
+ *	Size of data.
+ * @param offset
+ *	Position within data, updated to the start of the next value.
+ *
+ * @return
+ *	false if the end of data was reached, true otherwise.
+ */
+static bool
+skipToValue(
+    const uint8_t *data,
+    uint64_t dataSize,
+    uint64_t &offset)
+{
+	while (offset < dataSize) {
+		if (data[offset] == '#') {
+			while ((offset < dataSize) && (data[offset] != '\n'))
+				offset++;
+		} else if (isNetPBMSpace(data[offset])) {
+			offset++;
+		} else {
+			return (true);
+		}
+	}
+	return (false);
+}
+
+/**
+ * @brief
+ * Parse the unsigned decimal integer at offset.
+ *
+ * @param data
+ *	ASCII NetPBM data.
+ * @param dataSize
+ *	Size of data.
+ * @param offset
+ *	Start of the integer, updated to the first byte after it.
+ *
+ * @return
+ *	The integer.
+ *
+ * @throw BiometricEvaluation::Error::DataError
+ *	No integer at offset, or the integer is too large.
+ */
+static uint32_t
+scanInteger(
+    const uint8_t *data,
+    uint64_t dataSize,
+    uint64_t &offset)
+{
+	const uint64_t start = offset;
+	uint64_t value = 0;
+	while ((offset < dataSize) && (data[offset] >= '0') &&
+	    (data[offset] <= '9')) {
+		value = (value * 10) + (data[offset++] - '0');
+		if (value > UINT32_MAX)
+			throw BiometricEvaluation::Error::DataError("NetPBM "
+			    "value out of range");
+	}
+	if (offset == start)
+		throw BiometricEvaluation::Error::DataError("Invalid NetPBM "
+		    "value");
+
+	return (static_cast<uint32_t>(value));
+}
+
+/**
+ * @return
+ *	For each possible byte of a binary bitmap, the 8-bit pixels it
+ *	encodes (0 is white, 1 is black).
+ */
+static const std::array<std::array<uint8_t, 8>, 256>&
+getBitmapExpansion()
+{
+	static const std::array<std::array<uint8_t, 8>, 256> expansion = []() {
+		std::array<std::array<uint8_t, 8>, 256> table;
+		for (uint16_t byte = 0; byte < 256; byte++)
+			for (uint8_t bit = 0; bit < 8; bit++)
+				table[byte][bit] = ((byte & (0x80 >> bit)) ==
+				    0) ? 0xFF : 0x00;
+		return (table);
+	}();
+	return (expansion);
+}
+
 BiometricEvaluation::Image::NetPBM::NetPBM(
     const uint8_t *data,
     const uint64_t size) :
+    BiometricEvaluation::Image::NetPBM::NetPBM(
+    Memory::SharedBuffer(Memory::ByteView(data, size)))
+{
+
+}
+
+BiometricEvaluation::Image::NetPBM::NetPBM(
+    const Memory::SharedBuffer &data) :
     Image::Image(
     data,
-    size,
     CompressionAlgorithm::NetPBM)
 {
-	if (isNetPBM(data, size) != true)
+	if (isNetPBM(this->getDataPointer(), this->getDataSize()) != true)
 		throw Error::DataError("Not a NetPBM formatted image");
 	
 	try {
@@ -252,13 +366,21 @@ BiometricEvaluation::Image::NetPBM::getRawData()
 		/* FALLTHROUGH */
 	case Kind::BinaryPortablePixmap: {
 		Memory::uint8Array rawData(dataSize);
-		rawData.copy(data);
 
-		/* NetPBM stores data big-endian */
+		/* NetPBM stores data big-endian, so swap while copying */
 		if ((this->getColorDepth() == 16 ||
-		    this->getColorDepth() == 48) && Memory::isLittleEndian())
-			for (uint64_t i = 0; i < (rawData.size() - 1); i += 2)
-				std::swap(rawData[i], rawData[i + 1]);
+		    this->getColorDepth() == 48) && Memory::isLittleEndian()) {
+			uint8_t *out = rawData;
+			const uint64_t evenSize = dataSize & ~1ULL;
+			for (uint64_t i = 0; i < evenSize; i += 2) {
+				out[i] = data[i + 1];
+				out[i + 1] = data[i];
+			}
+			if (evenSize != dataSize)
+				out[evenSize] = data[evenSize];
+		} else {
+			rawData.copy(data);
+		}
 
 		return (rawData);
 	}
@@ -275,24 +397,19 @@ BiometricEvaluation::Image::NetPBM::ASCIIBitmapTo8Bit(
     uint32_t width,
     uint32_t height)
 {
-	Memory::uint8Array eightBitData(width * height);
-	Memory::MutableIndexedBuffer buffer(eightBitData);
-
-	std::string nextValue;
-	uint8_t byte;
-	size_t bitmapOffset = 0;
-	while (bitmapOffset < bitmapSize) {
-		/* Get next one-byte non-space value */
-		nextValue = getNextValue(bitmap, bitmapSize, bitmapOffset, 1);
+	Memory::uint8Array eightBitData(static_cast<uint64_t>(width) *
+	    height);
+	uint8_t *out = eightBitData;
 
+	uint64_t bitmapOffset = 0;
+	for (uint64_t pixel = 0; pixel < eightBitData.size(); pixel++) {
 		/* Extraneous spaces/newline at end of file */
-		if (nextValue.empty())
+		if (!skipToValue(bitmap, bitmapSize, bitmapOffset))
 			break;
 
-		byte = nextValue[0];
-		
+		/* Values are one digit and need not be separated */
 		/* 0 is white, 1 is black */
-		buffer.pushU8Val((byte == '0') ? 0xFF : 0x00);
+		out[pixel] = (bitmap[bitmapOffset++] == '0') ? 0xFF : 0x00;
 	}
 	
 	return (eightBitData);
@@ -310,32 +427,38 @@ BiometricEvaluation::Image::NetPBM::ASCIIPixmapToBinaryPixmap(
 	/* Ensure valid bit depth */
 	if (((depth % 8) != 0) || (depth > 48))
 		throw Error::ParameterError("Invalid depth");
+	if ((maxColor == 0) || (maxColor > UINT16_MAX))
+		throw Error::ParameterError("Invalid maximum color value");
 	const uint8_t bytesPerPixel = (depth / 8);
 
-	Memory::uint8Array binaryBuf(width * height * bytesPerPixel);
-	Memory::MutableIndexedBuffer buffer(binaryBuf);
-	
-	size_t ASCIIOffset = 0;
-	std::string nextValue;
-	uint32_t decimal;
-	while (ASCIIOffset < ASCIIBufSize) {
-		/* Read space separated ASCII integer */
-		nextValue = getNextValue(ASCIIBuf, ASCIIBufSize, ASCIIOffset);
+	/* Components are one byte, or two when max color requires */
+	const uint8_t bytesPerComponent = ((maxColor <= UINT8_MAX) ? 1 : 2);
+	const uint32_t maxComponent = ((bytesPerComponent == 1) ?
+	    UINT8_MAX : UINT16_MAX);
+
+	Memory::uint8Array binaryBuf(static_cast<uint64_t>(width) * height *
+	    bytesPerPixel);
+	uint8_t *out = binaryBuf;
+	const uint64_t componentCount = binaryBuf.size() / bytesPerComponent;
 
+	uint64_t ASCIIOffset = 0;
+	for (uint64_t i = 0; i < componentCount; i++) {
 		/* Extraneous spaces/newline at end of file */
-		if (nextValue.empty())
+		if (!skipToValue(ASCIIBuf, ASCIIBufSize, ASCIIOffset))
 			break;
 
 		/* Scale to colorspace */
-		decimal = valueInColorspace(std::stol(nextValue),
-		    maxColor, depth);
+		uint32_t value = std::min(scanInteger(ASCIIBuf, ASCIIBufSize,
+		    ASCIIOffset), maxColor);
+		if (maxColor != maxComponent)
+			value = (static_cast<uint64_t>(value) * maxComponent) /
+			    maxColor;
 
-		if (maxColor <= 255) {
-			/* One byte per component */
-			buffer.pushU8Val(decimal);
+		if (bytesPerComponent == 1) {
+			out[i] = static_cast<uint8_t>(value);
 		} else {
-			/* Two bytes per component (max color limited) */
-			buffer.pushU16Val(decimal);
+			const uint16_t value16 = static_cast<uint16_t>(value);
+			std::memcpy(out + (i * 2), &value16, sizeof(value16));
 		}
 	}
 
@@ -349,22 +472,28 @@ BiometricEvaluation::Image::NetPBM::BinaryBitmapTo8Bit(
     uint32_t width,
     uint32_t height)
 {
-	Memory::uint8Array eightBitData(width * height);
-	Memory::MutableIndexedBuffer buffer(eightBitData);
-	
-	uint8_t byte, mask;
-	for (size_t i = 0, offset = 0; i < bitmapSize; i++) {
-		byte = bitmap[i];
-		
-		mask = 0x80;	/* 0b10000000 */
-		for (int j = 0; j < 8; j++, mask >>= 1) {
-			/* 0 is white, 1 is black */
-			buffer.pushU8Val(((byte & mask) == 0) ? 0xFF : 0x00);
+	Memory::uint8Array eightBitData(static_cast<uint64_t>(width) *
+	    height);
+	const auto &expansion = getBitmapExpansion();
 
-			/* Skip filler bits when width not a multiple of 8 */
-			if ((++offset % width) == 0)
-				break;
-		}
+	/* Each row is padded to a whole byte */
+	const uint64_t rowSize = (static_cast<uint64_t>(width) + 7) / 8;
+	const uint64_t fullBytes = width / 8;
+	const uint8_t remainingBits = width % 8;
+	for (uint64_t row = 0; row < height; row++) {
+		if ((row * rowSize) >= bitmapSize)
+			break;
+		const uint8_t *in = bitmap + (row * rowSize);
+		uint8_t *out = eightBitData + (row * width);
+		const uint64_t available = std::min(rowSize,
+		    bitmapSize - (row * rowSize));
+
+		const uint64_t bytes = std::min(fullBytes, available);
+		for (uint64_t i = 0; i < bytes; i++)
+			std::memcpy(out + (i * 8), expansion[in[i]].data(), 8);
+		if ((remainingBits != 0) && (available == rowSize))
+			std::memcpy(out + (fullBytes * 8),
+			    expansion[in[fullBytes]].data(), remainingBits);
 	}
 	
 	return (eightBitData);
@@ -385,7 +514,7 @@ BiometricEvaluation::Image::NetPBM::isNetPBM(
 {
 	/* Skip any comments that exist before the magic bits */
 	size_t offset = 0;
-	while (data[offset] == '#') {
+	while ((offset < size) && (data[offset] == '#')) {
 		while (offset < size && data[offset] != '\n')
 			offset++;
 		if (offset + 1 < size)
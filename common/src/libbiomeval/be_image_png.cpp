@@ -10,16 +10,29 @@
 
 #include <png.h>
 
+#include <algorithm>
+#include <cmath>
+
 #include <be_memory.h>
 #include <be_image_png.h>
 #include <be_memory_autoarray.h>
 
+/** Smallest initial size of an encoded buffer */
+static const uint64_t MIN_ENCODED_BUFFER_SIZE = 4096;
+
 BiometricEvaluation::Image::PNG::PNG(
     const uint8_t *data,
     const uint64_t size) :
+    BiometricEvaluation::Image::PNG::PNG(
+    Memory::SharedBuffer(Memory::ByteView(data, size)))
+{
+
+}
+
+BiometricEvaluation::Image::PNG::PNG(
+    const Memory::SharedBuffer &data) :
     Image::Image(
     data,
-    size,
     CompressionAlgorithm::PNG)
 {
 	png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING,
@@ -143,6 +156,135 @@ BiometricEvaluation::Image::PNG::getRawGrayscaleData(
 	return (Image::getRawGrayscaleData(depth));
 }
 
+BiometricEvaluation::Image::PNG::EncodeOptions::EncodeOptions()
+{
+
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::PNG::encode(
+    const Image &image,
+    const EncodeOptions &options)
+{
+	if (options.compressionLevel > 9)
+		throw Error::ParameterError("Invalid PNG compression level");
+	const uint16_t bitDepth = image.getBitDepth();
+	if ((bitDepth != 8) && (bitDepth != 16))
+		throw Error::ParameterError("PNG encoding requires 8- or "
+		    "16-bit samples");
+	const uint32_t channels = image.getColorDepth() / bitDepth;
+	int colorType;
+	switch (channels) {
+	case 1:
+		colorType = PNG_COLOR_TYPE_GRAY;
+		break;
+	case 2:
+		colorType = PNG_COLOR_TYPE_GRAY_ALPHA;
+		break;
+	case 3:
+		colorType = PNG_COLOR_TYPE_RGB;
+		break;
+	case 4:
+		colorType = PNG_COLOR_TYPE_RGB_ALPHA;
+		break;
+	default:
+		throw Error::ParameterError("PNG encoding requires grayscale "
+		    "or RGB samples");
+	}
+	if (((colorType & PNG_COLOR_MASK_ALPHA) == PNG_COLOR_MASK_ALPHA) !=
+	    image.hasAlphaChannel())
+		throw Error::ParameterError("Alpha channel does not match "
+		    "color depth");
+
+	int filters;
+	switch (options.filter) {
+	case Filter::None:
+		filters = PNG_FILTER_NONE;
+		break;
+	case Filter::Sub:
+		filters = PNG_FILTER_SUB;
+		break;
+	case Filter::Up:
+		filters = PNG_FILTER_UP;
+		break;
+	case Filter::Average:
+		filters = PNG_FILTER_AVG;
+		break;
+	case Filter::Paeth:
+		filters = PNG_FILTER_PAETH;
+		break;
+	case Filter::Adaptive:
+		/* FALLTHROUGH */
+	default:
+		filters = PNG_ALL_FILTERS;
+		break;
+	}
+
+	const Size dimensions = image.getDimensions();
+	Memory::uint8Array rawData = image.getRawData();
+	const uint64_t rowSize = static_cast<uint64_t>(dimensions.xSize) *
+	    channels * (bitDepth / 8);
+	if (rawData.size() < (rowSize * dimensions.ySize))
+		throw Error::DataError("Not enough raw data for dimensions");
+
+	png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING,
+	    nullptr, png_error, png_error);
+	if (png_ptr == nullptr)
+		throw Error::StrategyError("libpng could not create "
+		    "png_struct");
+	png_infop png_info_ptr = png_create_info_struct(png_ptr);
+	if (png_info_ptr == nullptr) {
+		png_destroy_write_struct(&png_ptr, nullptr);
+		throw Error::StrategyError("libpng could not create "
+		    "png_info");
+	}
+
+	Memory::uint8Array encodedData;
+	encodedData.reserve(std::max(MIN_ENCODED_BUFFER_SIZE,
+	    rawData.size() / 2));
+	try {
+		/* Write encoded PNG data to an AutoArray using our extension */
+		png_set_write_fn(png_ptr, &encodedData, png_write_mem_dest,
+		    nullptr);
+		png_set_compression_level(png_ptr, options.compressionLevel);
+		png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, filters);
+
+		png_set_IHDR(png_ptr, png_info_ptr, dimensions.xSize,
+		    dimensions.ySize, bitDepth, colorType, PNG_INTERLACE_NONE,
+		    PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+		const Resolution resolution = image.getResolution();
+		if (resolution.units != Resolution::Units::NA) {
+			const Resolution ppcm = resolution.toUnits(
+			    Resolution::Units::PPCM);
+			png_set_pHYs(png_ptr, png_info_ptr,
+			    static_cast<png_uint_32>(std::round(
+			    ppcm.xRes * 100)),
+			    static_cast<png_uint_32>(std::round(
+			    ppcm.yRes * 100)),
+			    PNG_RESOLUTION_METER);
+		}
+		png_write_info(png_ptr, png_info_ptr);
+
+		/* PNG default storage is big-endian */
+		if ((bitDepth > 8) &&
+		    BiometricEvaluation::Memory::isLittleEndian())
+			png_set_swap(png_ptr);
+
+		/* Tell libpng to read raw data directly from AutoArray */
+		Memory::AutoArray<png_bytep> row_pointers(dimensions.ySize);
+		for (uint32_t row = 0; row < dimensions.ySize; row++)
+			row_pointers[row] = rawData + (row * rowSize);
+		png_write_image(png_ptr, row_pointers);
+		png_write_end(png_ptr, nullptr);
+	} catch (const Error::Exception&) {
+		png_destroy_write_struct(&png_ptr, &png_info_ptr);
+		throw;
+	}
+	png_destroy_write_struct(&png_ptr, &png_info_ptr);
+
+	return (encodedData);
+}
+
 bool
 BiometricEvaluation::Image::PNG::isPNG(
     const uint8_t *data,
@@ -180,6 +322,25 @@ BiometricEvaluation::Image::PNG::png_read_mem_src(
 	input->offset += length;
 }
 
+void
+BiometricEvaluation::Image::PNG::png_write_mem_dest(
+    png_structp png_ptr,
+    png_bytep data,
+    png_size_t length)
+{
+	if (png_get_io_ptr(png_ptr) == nullptr)
+		throw Error::StrategyError("libpng has no io_ptr set");
+
+	Memory::uint8Array *output = static_cast<Memory::uint8Array *>(
+	    png_get_io_ptr(png_ptr));
+	const uint64_t offset = output->size();
+	if ((offset + length) > output->capacity())
+		output->reserve(std::max(output->capacity() * 2,
+		    offset + length));
+	output->resize(offset + length);
+	std::memcpy(*output + offset, data, length);
+}
+
 void
 BiometricEvaluation::Image::PNG::png_error(
     png_structp png_ptr,
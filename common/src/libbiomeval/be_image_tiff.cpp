@@ -10,6 +10,17 @@
 
 #include <tiffio.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
 #include <be_image_tiff.h>
 #include <be_memory_mutableindexedbuffer.h>
 
@@ -76,6 +87,7 @@ static int
 libtiff_close(
     thandle_t handle)
 {
+	delete static_cast<BE::Memory::IndexedBuffer *>(handle);
 	return (0);
 }
 
@@ -111,12 +123,225 @@ libtiff_unmap(
 
 /******************************************************************************/
 
+/** Decode images with at least this many raw bytes using several threads */
+static const uint64_t MIN_PARALLEL_DECODE_SIZE = 4 * 1024 * 1024;
+
+/** Arrangement of decoded samples for the native decoder */
+struct NativeLayout
+{
+	uint32_t width;
+	uint32_t height;
+	/** Bytes in one row of the image */
+	uint64_t rowSize;
+	/** Bytes in one pixel */
+	uint64_t pixelSize;
+	/** Rows in each strip, when not tiled */
+	uint32_t rowsPerStrip;
+	/** Dimensions of each tile, when tiled */
+	uint32_t tileWidth;
+	uint32_t tileLength;
+};
+
+/**
+ * @brief
+ * Determine whether libtiff's decoded samples are already in the layout
+ * of raw data.
+ * @details
+ * That is the case for whole-byte unsigned samples, interleaved within
+ * each pixel, with rows stored top to bottom.  Everything else must be
+ * converted through libtiff's RGBA interface.
+ *
+ * @param tiff
+ *	Open libtiff handle.
+ *
+ * @return
+ *	true if the image can be decoded natively, false otherwise.
+ */
+static bool
+canDecodeNatively(
+    ::TIFF *tiff)
+{
+	uint16_t photometric{}, planarConfig{}, bitsPerSample{};
+	uint16_t sampleFormat{}, orientation{};
+	if (TIFFGetField(tiff, TIFFTAG_PHOTOMETRIC, &photometric) != 1)
+		return (false);
+	if ((photometric != PHOTOMETRIC_MINISBLACK) &&
+	    (photometric != PHOTOMETRIC_RGB))
+		return (false);
+
+	if ((TIFFGetFieldDefaulted(tiff, TIFFTAG_PLANARCONFIG,
+	    &planarConfig) != 1) || (planarConfig != PLANARCONFIG_CONTIG))
+		return (false);
+	if ((TIFFGetFieldDefaulted(tiff, TIFFTAG_BITSPERSAMPLE,
+	    &bitsPerSample) != 1) ||
+	    ((bitsPerSample != 8) && (bitsPerSample != 16)))
+		return (false);
+	if ((TIFFGetFieldDefaulted(tiff, TIFFTAG_SAMPLEFORMAT,
+	    &sampleFormat) != 1) || (sampleFormat != SAMPLEFORMAT_UINT))
+		return (false);
+	if ((TIFFGetFieldDefaulted(tiff, TIFFTAG_ORIENTATION,
+	    &orientation) != 1) || (orientation != ORIENTATION_TOPLEFT))
+		return (false);
+
+	return (true);
+}
+
+/**
+ * @brief
+ * Decode one strip directly into raw data.
+ *
+ * @param tiff
+ *	Open libtiff handle.
+ * @param strip
+ *	Index of the strip.
+ * @param layout
+ *	Layout of the image.
+ * @param raw
+ *	Raw data for the entire image.
+ */
+static void
+decodeStrip(
+    ::TIFF *tiff,
+    uint32_t strip,
+    const NativeLayout &layout,
+    uint8_t *raw)
+{
+	const uint64_t firstRow = static_cast<uint64_t>(strip) *
+	    layout.rowsPerStrip;
+	const uint64_t rows = std::min<uint64_t>(layout.rowsPerStrip,
+	    layout.height - firstRow);
+	const tmsize_t size = rows * layout.rowSize;
+
+	if (TIFFReadEncodedStrip(tiff, strip, raw + (firstRow *
+	    layout.rowSize), size) != size)
+		throw BE::Error::StrategyError("Error decompressing TIFF "
+		    "strip " + std::to_string(strip));
+}
+
+/**
+ * @brief
+ * Decode one tile and copy its rows into raw data.
+ *
+ * @param tiff
+ *	Open libtiff handle.
+ * @param tile
+ *	Index of the tile.
+ * @param layout
+ *	Layout of the image.
+ * @param tileData
+ *	Buffer of TIFFTileSize() bytes for the decoded tile.
+ * @param raw
+ *	Raw data for the entire image.
+ */
+static void
+decodeTile(
+    ::TIFF *tiff,
+    uint32_t tile,
+    const NativeLayout &layout,
+    BE::Memory::uint8Array &tileData,
+    uint8_t *raw)
+{
+	if (TIFFReadEncodedTile(tiff, tile, tileData, tileData.size()) == -1)
+		throw BE::Error::StrategyError("Error decompressing TIFF "
+		    "tile " + std::to_string(tile));
+
+	/* Tiles are numbered across, then down */
+	const uint32_t tilesAcross = (layout.width + layout.tileWidth - 1) /
+	    layout.tileWidth;
+	const uint64_t x = static_cast<uint64_t>(tile % tilesAcross) *
+	    layout.tileWidth;
+	const uint64_t y = static_cast<uint64_t>(tile / tilesAcross) *
+	    layout.tileLength;
+
+	/* Tiles on the right and bottom edges are padded */
+	const uint64_t tileRowSize = layout.tileWidth * layout.pixelSize;
+	const uint64_t copySize = std::min<uint64_t>(layout.tileWidth,
+	    layout.width - x) * layout.pixelSize;
+	const uint64_t rows = std::min<uint64_t>(layout.tileLength,
+	    layout.height - y);
+	for (uint64_t row = 0; row < rows; row++)
+		std::memcpy(raw + ((y + row) * layout.rowSize) +
+		    (x * layout.pixelSize), tileData + (row * tileRowSize),
+		    copySize);
+}
+
+/**
+ * @brief
+ * Decode an image through libtiff's RGBA interface.
+ * @details
+ * Used for layouts that cannot be decoded natively.  Every pixel is
+ * expanded to 32 bits before being repacked into raw data.
+ *
+ * @param tiff
+ *	Open libtiff handle.
+ * @param dim
+ *	Dimensions of the image.
+ * @param colorDepth
+ *	Color depth of the image.
+ * @param bitDepth
+ *	Bit depth of the image.
+ *
+ * @return
+ *	Raw data.
+ */
+static BE::Memory::uint8Array
+decodeRGBA(
+    ::TIFF *tiff,
+    const BE::Image::Size &dim,
+    uint16_t colorDepth,
+    uint16_t bitDepth)
+{
+	BE::Memory::AutoArray<uint32_t> raw32(dim.xSize * dim.ySize);
+	if (TIFFReadRGBAImageOriented(tiff, dim.xSize, dim.ySize, raw32,
+	    ORIENTATION_TOPLEFT) != 1)
+		throw BE::Error::StrategyError("Error decompressing TIFF");
+
+	const auto numChannels = (colorDepth / bitDepth);
+	BE::Memory::uint8Array raw8(raw32.size() * numChannels *
+	    (bitDepth / 8));
+	BE::Memory::MutableIndexedBuffer ib{raw8};
+
+	for (const auto &pixel : raw32) {
+		switch (numChannels) {
+		case 1:
+			ib.pushU8Val(TIFFGetR(pixel));
+			if (bitDepth == 16)
+				ib.pushU8Val(TIFFGetG(pixel));
+			break;
+		case 3:
+			ib.pushU8Val(TIFFGetR(pixel));
+			ib.pushU8Val(TIFFGetG(pixel));
+			ib.pushU8Val(TIFFGetB(pixel));
+			break;
+		case 4:
+			ib.pushU8Val(TIFFGetR(pixel));
+			ib.pushU8Val(TIFFGetG(pixel));
+			ib.pushU8Val(TIFFGetB(pixel));
+			ib.pushU8Val(TIFFGetA(pixel));
+			break;
+		default:
+			throw BE::Error::NotImplemented("TIFF number of "
+			    "channels == " + std::to_string(numChannels));
+		}
+	}
+
+	return (raw8);
+}
+
 BiometricEvaluation::Image::TIFF::TIFF(
     const uint8_t *data,
     const uint64_t size) :
-    Image(data, size, CompressionAlgorithm::TIFF)
+    BiometricEvaluation::Image::TIFF::TIFF(
+    Memory::SharedBuffer(Memory::ByteView(data, size)))
+{
+
+}
+
+BiometricEvaluation::Image::TIFF::TIFF(
+    const Memory::SharedBuffer &data) :
+    Image(data, CompressionAlgorithm::TIFF)
 {
-	if (!isTIFF(data, size))
+	if (!isTIFF(this->getDataPointer(), this->getDataSize()))
 		throw BE::Error::StrategyError("Not a TIFF image");
 
 	TIFFSetWarningHandler(TIFF::warningHandler);
@@ -151,19 +376,24 @@ BiometricEvaluation::Image::TIFF::TIFF(
 		throw BE::Error::StrategyError("libtiff: samples per pixel");
 	this->setColorDepth(samplesPerPixel * bitsPerSample);
 
-	if(this->getColorDepth() > 32)
+	/* Only the native decoder keeps more than 8 bits per channel */
+	if ((this->getColorDepth() > 32) && !canDecodeNatively(tiff.get()))
 		throw BE::Error::NotImplemented("Cannot parse TIFF images "
 		    "where one pixel requires more than 32 bits in memory");
 
 	if ((samplesPerPixel == 1) || (samplesPerPixel == 3))
 		this->setHasAlphaChannel(false);
 	else {
-		uint16_t extraSamples{};
+		/* Count and type of each sample after the color samples */
+		uint16_t extraSampleCount{};
+		uint16_t *extraSamples{};
 		if (TIFFGetFieldDefaulted(tiff.get(), TIFFTAG_EXTRASAMPLES,
-		    &extraSamples) != 1)
+		    &extraSampleCount, &extraSamples) != 1)
 			throw BE::Error::StrategyError("libtiff: extra "
 			    "samples");
-		if (extraSamples == EXTRASAMPLE_ASSOCALPHA)
+		if ((extraSampleCount == 1) &&
+		    ((extraSamples[0] == EXTRASAMPLE_ASSOCALPHA) ||
+		    (extraSamples[0] == EXTRASAMPLE_UNASSALPHA)))
 			this->setHasAlphaChannel(true);
 		else
 			throw BE::Error::NotImplemented("Unusual color depth, "
@@ -210,42 +440,99 @@ BiometricEvaluation::Image::TIFF::getRawData()
 
 	std::unique_ptr<::TIFF, void(*)(::TIFF*)> tiff(
 	    static_cast<::TIFF*>(this->getDecompressionStream()), TIFFClose);
+	if (!canDecodeNatively(tiff.get()))
+		return (decodeRGBA(tiff.get(), dim, this->getColorDepth(),
+		    this->getBitDepth()));
+
+	NativeLayout layout{};
+	layout.width = dim.xSize;
+	layout.height = dim.ySize;
+	layout.rowSize = TIFFScanlineSize64(tiff.get());
+	layout.pixelSize = this->getColorDepth() / 8;
+	if (layout.rowSize != (layout.width * layout.pixelSize))
+		throw BE::Error::StrategyError("libtiff: scanline size");
+
+	const bool tiled = (TIFFIsTiled(tiff.get()) != 0);
+	uint32_t unitCount;
+	if (tiled) {
+		if ((TIFFGetField(tiff.get(), TIFFTAG_TILEWIDTH,
+		    &layout.tileWidth) != 1) || (layout.tileWidth == 0))
+			throw BE::Error::StrategyError("libtiff: tile width");
+		if ((TIFFGetField(tiff.get(), TIFFTAG_TILELENGTH,
+		    &layout.tileLength) != 1) || (layout.tileLength == 0))
+			throw BE::Error::StrategyError("libtiff: tile length");
+		unitCount = TIFFNumberOfTiles(tiff.get());
+	} else {
+		if (TIFFGetFieldDefaulted(tiff.get(), TIFFTAG_ROWSPERSTRIP,
+		    &layout.rowsPerStrip) != 1)
+			throw BE::Error::StrategyError("libtiff: rows per "
+			    "strip");
+		layout.rowsPerStrip = std::max(1u, std::min(
+		    layout.rowsPerStrip, layout.height));
+		unitCount = (layout.height + layout.rowsPerStrip - 1) /
+		    layout.rowsPerStrip;
+	}
 
-	BE::Memory::AutoArray<uint32_t> raw32(dim.xSize * dim.ySize);
-	if (TIFFReadRGBAImageOriented(tiff.get(), dim.xSize, dim.ySize, raw32,
-	    ORIENTATION_TOPLEFT) != 1)
-		throw BE::Error::StrategyError("Error decompressing TIFF");
-
-	const auto numChannels = (this->getColorDepth() / this->getBitDepth());
-	BE::Memory::uint8Array raw8(raw32.size() * numChannels *
-	    (this->getBitDepth() / 8));
-	BE::Memory::MutableIndexedBuffer ib{raw8};
-
-	for (const auto &pixel : raw32) {
-		switch (numChannels) {
-		case 1:
-			ib.pushU8Val(TIFFGetR(pixel));
-			if (this->getBitDepth() == 16)
-				ib.pushU8Val(TIFFGetG(pixel));
-			break;
-		case 3:
-			ib.pushU8Val(TIFFGetR(pixel));
-			ib.pushU8Val(TIFFGetG(pixel));
-			ib.pushU8Val(TIFFGetB(pixel));
-			break;
-		case 4:
-			ib.pushU8Val(TIFFGetR(pixel));
-			ib.pushU8Val(TIFFGetG(pixel));
-			ib.pushU8Val(TIFFGetB(pixel));
-			ib.pushU8Val(TIFFGetA(pixel));
+	Memory::uint8Array raw(layout.rowSize * layout.height);
+
+	/*
+	 * libtiff handles can't be shared, so each thread decodes the
+	 * strips or tiles it claims through a handle of its own.
+	 */
+	std::atomic<uint32_t> next{0};
+	std::mutex errorMutex;
+	std::exception_ptr error;
+	const auto worker = [&](::TIFF *handle) {
+		try {
+			Memory::uint8Array tileData;
+			if (tiled)
+				tileData.resize(TIFFTileSize64(handle));
+			for (uint32_t i = next++; i < unitCount; i = next++) {
+				if (tiled)
+					decodeTile(handle, i, layout, tileData,
+					    raw);
+				else
+					decodeStrip(handle, i, layout, raw);
+			}
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(errorMutex);
+			if (!error)
+				error = std::current_exception();
+			next = unitCount;
+		}
+	};
+
+	uint32_t threadCount = 1;
+	if (raw.size() >= MIN_PARALLEL_DECODE_SIZE)
+		threadCount = std::min(unitCount,
+		    std::max(1u, std::thread::hardware_concurrency()));
+	std::vector<std::thread> threads;
+	for (uint32_t i = 1; i < threadCount; i++) {
+		try {
+			threads.emplace_back([&]() {
+				std::unique_ptr<::TIFF, void(*)(::TIFF*)>
+				    handle(nullptr, TIFFClose);
+				try {
+					handle.reset(static_cast<::TIFF*>(
+					    this->getDecompressionStream()));
+				} catch (const Error::Exception&) {
+					/* Leave the work to other threads */
+					return;
+				}
+				worker(handle.get());
+			});
+		} catch (const std::system_error&) {
+			/* Make do with the threads already running */
 			break;
-		default:
-			throw BE::Error::NotImplemented("TIFF number of "
-			    "channels == " + std::to_string(numChannels));
 		}
 	}
+	worker(tiff.get());
+	for (auto &thread : threads)
+		thread.join();
 
-	return (raw8);
+	if (error)
+		std::rethrow_exception(error);
+	return (raw);
 }
 
 BiometricEvaluation::Memory::uint8Array
@@ -285,10 +572,14 @@ BiometricEvaluation::Image::TIFF::libtiffMessageToString(
     const char *format,
     va_list args)
 {
-	const auto bufSize = std::snprintf(nullptr, 0, format, args) + 1;
+	/* Sizing the message consumes a copy of args */
+	va_list sizeArgs;
+	va_copy(sizeArgs, args);
+	const auto bufSize = std::vsnprintf(nullptr, 0, format, sizeArgs) + 1;
+	va_end(sizeArgs);
 	const std::unique_ptr<char[]> buf(new char[bufSize]);
-	std::snprintf(buf.get(), bufSize, format, args);
-	const std::string formattedMessage{buf.get(), buf.get() + bufSize};
+	std::vsnprintf(buf.get(), bufSize, format, args);
+	const std::string formattedMessage{buf.get()};
 
 	return ("libtiff (" + std::string(module) + "): " + formattedMessage);
 }
@@ -321,15 +612,18 @@ void*
 BiometricEvaluation::Image::TIFF::getDecompressionStream()
     const
 {
-	BE::Memory::IndexedBuffer *ib = new BE::Memory::IndexedBuffer(
-	    this->getDataPointer(), this->getDataSize());
+	/* Owned by the stream once opened, and freed by libtiff_close() */
+	std::unique_ptr<BE::Memory::IndexedBuffer> ib(
+	    new BE::Memory::IndexedBuffer(this->getDataPointer(),
+	    this->getDataSize()));
 
 	::TIFF *tiff = TIFFClientOpen("BiometricEvaluation::Image::TIFF", "rb",
-	    ib, libtiff_read, libtiff_write, libtiff_seek, libtiff_close,
+	    ib.get(), libtiff_read, libtiff_write, libtiff_seek, libtiff_close,
 	    libtiff_size, libtiff_map, libtiff_unmap);
 	if (tiff == nullptr)
 		throw BE::Error::StrategyError("Could not instantiate TIFF "
 		    "decompression stream");
 
+	ib.release();
 	return (tiff);
 }
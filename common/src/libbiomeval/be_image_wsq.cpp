@@ -8,7 +8,9 @@
  * about its quality, reliability, or any other characteristic.
  */
  
+#include <cmath>
 #include <cstdio>
+#include <mutex>
 
 extern "C" {
 	#include <dataio.h>
@@ -18,12 +20,26 @@ extern "C" {
 
 #include <be_image_wsq.h>
 
+/*
+ * libwsq keeps its wavelet and quantization tables and frame header in
+ * globals that both encoding and decoding write, so only one thread may
+ * be in libwsq at a time.
+ */
+static std::mutex libwsqMutex;
+
 BiometricEvaluation::Image::WSQ::WSQ(
     const uint8_t *data,
     const uint64_t size) :
+    BiometricEvaluation::Image::WSQ::WSQ(
+    Memory::SharedBuffer(Memory::ByteView(data, size)))
+{
+
+}
+
+BiometricEvaluation::Image::WSQ::WSQ(
+    const Memory::SharedBuffer &data) :
     Image::Image(
     data,
-    size,
     CompressionAlgorithm::WSQ20)
 {
 	uint8_t *marker_buf = (uint8_t *)this->getDataPointer();
@@ -33,20 +49,21 @@ BiometricEvaluation::Image::WSQ::WSQ(
 	uint16_t marker, tbl_size;
 	uint32_t rv = 0;
 	if ((rv = getc_marker_wsq(&marker, SOI_WSQ, &marker_buf,
-	    wsq_buf + size)))
+	    wsq_buf + this->getDataSize())))
 		throw Error::StrategyError("libwsq could not read to SOI_WSQ");
 	
 	/* Step through any tables up to the "start of frame" marker */
 	for (;;) {
 		if ((rv = getc_marker_wsq(&marker, TBLS_N_SOF, &marker_buf,
-		    wsq_buf + size)))
+		    wsq_buf + this->getDataSize())))
 			throw Error::StrategyError("libwsq could not read to "
 			    "TBLS_N_SOF");
 
 		if (marker == SOF_WSQ)
 			break;
 			
-		if ((rv = getc_ushort(&tbl_size, &marker_buf, wsq_buf + size)))
+		if ((rv = getc_ushort(&tbl_size, &marker_buf,
+		    wsq_buf + this->getDataSize())))
 			throw Error::StrategyError("libwsq could not read size "
 			    "of table");
 		/* Table size includes size of field but not the marker */
@@ -56,13 +73,13 @@ BiometricEvaluation::Image::WSQ::WSQ(
 	/* Read the frame header */
 	FRM_HEADER_WSQ wsq_header;
 	if ((rv = getc_frame_header_wsq(&wsq_header, &marker_buf,
-	    wsq_buf + size)))
+	    wsq_buf + this->getDataSize())))
 		throw Error::DataError("libwsq could not read frame header");
 	setDimensions(Size(wsq_header.width, wsq_header.height));
 
 	/* Read PPI from NISTCOM, if present */
 	int ppi{-1};
-	if (getc_ppi_wsq(&ppi, wsq_buf, size) == 0) {
+	if (getc_ppi_wsq(&ppi, wsq_buf, this->getDataSize()) == 0) {
 		/* Resolution does not have to be defined */
 		if (ppi == -1)
 			/* WSQ is a 500 ppi specification */
@@ -99,9 +116,13 @@ BiometricEvaluation::Image::WSQ::getRawData()
 {
 	uint8_t *rawbuf = nullptr;
 	int32_t depth, height, lossy, ppi, rv, width;
-	if ((rv = wsq_decode_mem(&rawbuf, &width, &height, &depth, &ppi,
-	    &lossy, (unsigned char *)this->getDataPointer(),
-	    this->getDataSize())))
+	{
+		std::lock_guard<std::mutex> lock(libwsqMutex);
+		rv = wsq_decode_mem(&rawbuf, &width, &height, &depth, &ppi,
+		    &lossy, (unsigned char *)this->getDataPointer(),
+		    this->getDataSize());
+	}
+	if (rv != 0)
 		throw Error::DataError("Could not convert WSQ to raw.");
 
 	/* rawbuf allocated within libwsq.  Copy to manage with AutoArray. */
@@ -121,6 +142,52 @@ BiometricEvaluation::Image::WSQ::getRawGrayscaleData(
 	return (Image::getRawGrayscaleData(depth));
 }
 
+BiometricEvaluation::Image::WSQ::EncodeOptions::EncodeOptions()
+{
+
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::WSQ::encode(
+    const Image &image,
+    const EncodeOptions &options)
+{
+	if (!(options.bitRate > 0))
+		throw Error::ParameterError("Invalid WSQ bit rate");
+
+	const Size dimensions = image.getDimensions();
+	Memory::uint8Array rawGray = image.getRawGrayscaleData(8);
+	if (rawGray.size() < (static_cast<uint64_t>(dimensions.xSize) *
+	    dimensions.ySize))
+		throw Error::DataError("Not enough raw data for dimensions");
+
+	/* Recorded in a NISTCOM comment, where the constructor finds it */
+	int32_t ppi{-1};
+	const Resolution resolution = image.getResolution();
+	if (resolution.units != Resolution::Units::NA)
+		ppi = static_cast<int32_t>(std::round(resolution.toUnits(
+		    Resolution::Units::PPI).xRes));
+
+	uint8_t *wsqbuf = nullptr;
+	int32_t rv, wsqlen;
+	{
+		std::lock_guard<std::mutex> lock(libwsqMutex);
+		rv = wsq_encode_mem(&wsqbuf, &wsqlen, options.bitRate,
+		    rawGray, dimensions.xSize, dimensions.ySize, 8, ppi,
+		    nullptr);
+	}
+	if (rv != 0)
+		throw Error::StrategyError("Could not convert raw to WSQ "
+		    "(libwsq error " + std::to_string(rv) + ")");
+
+	/* wsqbuf allocated within libwsq.  Copy to manage with AutoArray. */
+	Memory::uint8Array wsqData(wsqlen);
+	wsqData.copy(wsqbuf);
+	free(wsqbuf);
+
+	return (wsqData);
+}
+
 bool
 BiometricEvaluation::Image::WSQ::isWSQ(
     const uint8_t *data,
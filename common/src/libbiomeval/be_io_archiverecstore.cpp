@@ -17,21 +17,23 @@ const std::string BiometricEvaluation::IO::ArchiveRecordStore::
 
 BiometricEvaluation::IO::ArchiveRecordStore::ArchiveRecordStore(
     const std::string &pathname,
-    const std::string &description)
+    const std::string &description,
+    RecordStore::Concurrency concurrency)
 {
 	/*
 	 * Exceptions float out.
 	 */
 	this->pimpl.reset(new IO::ArchiveRecordStore::Impl(
-	    pathname, description));
+	    pathname, description, concurrency));
 }
 
 BiometricEvaluation::IO::ArchiveRecordStore::ArchiveRecordStore(
     const std::string &pathname,
-    IO::Mode mode)
+    IO::Mode mode,
+    RecordStore::Concurrency concurrency)
 {
 	this->pimpl.reset(new IO::ArchiveRecordStore::Impl(
-	    pathname, mode));
+	    pathname, mode, concurrency));
 }
 
 BiometricEvaluation::IO::ArchiveRecordStore::~ArchiveRecordStore()
@@ -119,6 +121,20 @@ BiometricEvaluation::IO::ArchiveRecordStore::setCursorAtKey(
 	this->pimpl->setCursorAtKey(key);
 }
 
+std::string
+BiometricEvaluation::IO::ArchiveRecordStore::nextKey(
+    const std::string &key)
+{
+	return (this->pimpl->nextKey(key));
+}
+
+BiometricEvaluation::IO::RecordStore::Concurrency
+BiometricEvaluation::IO::ArchiveRecordStore::getConcurrency()
+    const
+{
+	return (this->pimpl->getConcurrency());
+}
+
 unsigned int
 BiometricEvaluation::IO::ArchiveRecordStore::getCount()
     const
@@ -12,6 +12,7 @@
 #include <sys/param.h>
 #include <sys/stat.h>
 
+#include <fcntl.h>
 #include <unistd.h>
 
 #include <algorithm>
@@ -31,8 +32,12 @@ namespace BE = BiometricEvaluation;
 
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::Impl(
     const std::string &pathname,
-    const std::string &description) :
-    RecordStore::Impl(pathname, description, RecordStore::Kind::Archive)
+    const std::string &description,
+    RecordStore::Concurrency concurrency) :
+    RecordStore::Impl(pathname, description, RecordStore::Kind::Archive,
+    concurrency),
+    _archivefd(-1),
+    _unflushed(false)
 {
 	_dirty = false;
 
@@ -45,8 +50,11 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::Impl(
 
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::Impl(
     const std::string &pathname,
-    IO::Mode mode) :
-    RecordStore::Impl(pathname, mode)
+    IO::Mode mode,
+    RecordStore::Concurrency concurrency) :
+    RecordStore::Impl(pathname, mode, concurrency),
+    _archivefd(-1),
+    _unflushed(false)
 {
 	_dirty = false;
 
@@ -133,6 +141,14 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::open_streams()
 		if (!_archivefp || (_archivefp.is_open() == false))
 			throw Error::FileError("Could not open archive");
 	}
+
+	if (_archivefd == -1) {
+		_archivefd = ::open(canonicalName(ARCHIVE_FILE_NAME).c_str(),
+		    O_RDONLY | O_CLOEXEC);
+		if (_archivefd == -1)
+			throw Error::FileError("Could not open archive (" +
+			    Error::errorStr() + ")");
+	}
 		
 	_archivefp.clear();
 	_manifestfp.clear();
@@ -156,6 +172,14 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::close_streams()
 			throw Error::StrategyError("Could not close archive");
 	}
 	_archivefp.clear();
+	_unflushed = false;
+
+	if (_archivefd != -1) {
+		const int rv = ::close(_archivefd);
+		_archivefd = -1;
+		if (rv != 0)
+			throw Error::StrategyError("Could not close archive");
+	}
 }
 
 uint64_t
@@ -165,8 +189,9 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::getSpaceUsed()
 	struct stat sb;
 	uint64_t total;
 
+	WriterLock lock(*this);
 	total = RecordStore::Impl::getSpaceUsed();
-	sync();
+	this->i_sync();
 	if (stat(canonicalName(MANIFEST_FILE_NAME).c_str(), &sb) != 0)
 		throw Error::StrategyError("Could not find manifest file");
 	total += sb.st_blocks * S_BLKSIZE;
@@ -181,6 +206,14 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::getSpaceUsed()
 void
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::sync()
     const
+{
+	WriterLock lock(*this);
+	this->i_sync();
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::i_sync()
+    const
 {
 	if (getMode() == Mode::ReadOnly)
 		return;
@@ -198,9 +231,21 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::sync()
 		_archivefp.sync();
 		if (!_archivefp)
 			throw Error::StrategyError("Could not sync archive");
+		_unflushed = false;
 	}
 }
 
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::flush_archive()
+    const
+{
+	_archivefp.clear();
+	_archivefp.flush();
+	if (!_archivefp)
+		throw Error::StrategyError("Could not flush archive");
+	_unflushed = false;
+}
+
 uint64_t
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::length(
     const std::string &key)
@@ -208,6 +253,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::length(
 {
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
+	ReaderLock lock(*this);
 	const std::shared_ptr<ManifestMap::value_type> entry =
 	    _entries.find_quick(key);
 	if ((entry.get() == nullptr) ||
@@ -272,6 +318,15 @@ BiometricEvaluation::Memory::uint8Array
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::read(
     const std::string &key)
     const
+{
+	ReaderLock lock(*this);
+	return (this->i_read(key));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::i_read(
+    const std::string &key)
+    const
 {
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
@@ -286,22 +341,34 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::read(
 	if (entry->second.offset == OFFSET_RECORD_REMOVED)
 		throw Error::ObjectDoesNotExist(key + " was removed");
 
-	if (_archivefp.is_open() == false) {
+	if (_archivefd == -1) {
 		try {
 			this->open_streams();
 		} catch (Error::FileError &e) {
 			throw Error::StrategyError(e.what());
 		}
 	}
-	_archivefp.clear();
-	_archivefp.seekg(entry->second.offset, std::ios_base::beg);
-	if (!_archivefp)
-		throw Error::StrategyError("Archive cannot seek");
+	/* Shared RecordStores flush on insert, so only Exclusive gets here */
+	if (_unflushed)
+		this->flush_archive();
 
+	/* Positional reads leave no file position for readers to share */
 	Memory::uint8Array data(entry->second.size);
-	_archivefp.read((char *)&data[0], entry->second.size);
-	if (!_archivefp)
-		throw Error::StrategyError("Archive cannot read");
+	uint64_t total = 0;
+	while (total < entry->second.size) {
+		const ssize_t rv = pread(_archivefd, &data[0] + total,
+		    entry->second.size - total, entry->second.offset + total);
+		if (rv == -1) {
+			if (errno == EINTR)
+				continue;
+			throw Error::StrategyError("Archive cannot read (" +
+			    Error::errorStr() + ")");
+		}
+		if (rv == 0)
+			throw Error::StrategyError("Archive cannot read "
+			    "(truncated)");
+		total += rv;
+	}
 
 	return (data);
 }
@@ -317,6 +384,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::insert(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 	
+	WriterLock lock(*this);
 	if (this->keyExists(key))
 		throw Error::ObjectExists(key);
 
@@ -337,6 +405,11 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::insert(
 	_archivefp.write(static_cast<const char *>(data), size);
 	if (!_archivefp)
 		throw Error::StrategyError("Could not write to archive file");
+	_unflushed = true;
+
+	/* Readers must be able to read the record once the lock is freed */
+	if (this->getConcurrency() == RecordStore::Concurrency::Shared)
+		this->flush_archive();
 
 	/* Write to manifest */
 	ManifestEntry entry;
@@ -380,6 +453,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::remove(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
+	WriterLock lock(*this);
 	if (this->keyExists(key) == false)
 		throw Error::ObjectDoesNotExist(key);
 
@@ -411,6 +485,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::flush(
 		throw Error::StrategyError("Invalid key format");
 
 	/* Fulfill the RecordStore contract */
+	WriterLock lock(*this);
 	ManifestMap::const_iterator lb = _entries.find(key);
 	if (lb == _entries.end() ||
 	    (lb->second).offset == OFFSET_RECORD_REMOVED)
@@ -429,6 +504,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::flush(
 		_archivefp.flush();
 		if (!_archivefp)
 			throw Error::StrategyError("Could not flush archive");
+		_unflushed = false;
 	}
 }
 
@@ -478,7 +554,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::i_sequence(
 	BE::IO::RecordStore::Record record;
 	record.key.assign(_cursorPos->first);
 	if (returnData)
-		record.data = this->read(record.key);
+		record.data = this->i_read(record.key);
 	return (record);
 }
 
@@ -486,6 +562,7 @@ BiometricEvaluation::IO::RecordStore::Record
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::sequence(
     int cursor)
 {
+	WriterLock lock(*this);
 	return (i_sequence(true, cursor));
 }
 
@@ -493,6 +570,7 @@ std::string
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::sequenceKey(
     int cursor)
 {
+	WriterLock lock(*this);
 	RecordStore::Record record = i_sequence(false, cursor);
 	return (record.key);
 }
@@ -505,6 +583,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::setCursorAtKey(
 		throw Error::StrategyError("Invalid key format");
 
 	/* Check for existance */
+	WriterLock lock(*this);
 	ManifestMap::iterator lb = _entries.find(key);
 	if (lb == _entries.end())
 		throw Error::ObjectDoesNotExist(key);
@@ -514,7 +593,39 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::setCursorAtKey(
 	if (entry.offset == OFFSET_RECORD_REMOVED)
 		throw Error::ObjectDoesNotExist(key + " was removed");
 
-	_cursorPos = (lb == _entries.begin()) ? lb : --lb;
+	/* Sequencing from START or NEXT returns this record first */
+	if (lb == _entries.begin()) {
+		setCursor(BE_RECSTORE_SEQ_START);
+	} else {
+		setCursor(BE_RECSTORE_SEQ_NEXT);
+		_cursorPos = --lb;
+	}
+}
+
+std::string
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::nextKey(
+    const std::string &key)
+    const
+{
+	if (!key.empty() && !validateKeyString(key))
+		throw Error::StrategyError("Invalid key format");
+
+	ReaderLock lock(*this);
+	ManifestMap::const_iterator it = _entries.begin();
+	if (!key.empty()) {
+		it = _entries.find(key);
+		if (it == _entries.end())
+			throw Error::ObjectDoesNotExist(key);
+		++it;
+	}
+
+	/* Removed records remain in the manifest until vacuumed */
+	while ((it != _entries.end()) &&
+	    (it->second.offset == OFFSET_RECORD_REMOVED))
+		++it;
+	if (it == _entries.end())
+		throw Error::ObjectDoesNotExist("No record after " + key);
+	return (it->first);
 }
 
 void
@@ -570,13 +681,20 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::move(
 	if (this->getMode() == Mode::ReadOnly)
 		throw Error::StrategyError("RecordStore was opened read-only");
 
+	WriterLock lock(*this);
 	RecordStore::Impl::move(pathname);
 	this->close_streams();
+	try {
+		this->open_streams();
+	} catch (Error::FileError &e) {
+		throw Error::StrategyError(e.what());
+	}
 }
 
 bool
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::needsVacuum()
 {
+	ReaderLock lock(*this);
 	return (this->_dirty);
 }
 
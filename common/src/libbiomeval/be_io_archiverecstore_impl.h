@@ -32,6 +32,8 @@ namespace BiometricEvaluation {
 			 * 	The directory where the store is to be created.
 			 * @param[in] description
 			 *	The store's description.
+			 * @param[in] concurrency
+			 *	Whether the object may be shared by threads.
 			 *
 			 * @throw Error::ObjectExists
 			 * 	The store already exists.
@@ -41,7 +43,9 @@ namespace BiometricEvaluation {
 			 */
 			Impl(
 			    const std::string &pathname,
-			    const std::string &description);
+			    const std::string &description,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
 
 			/**
 			 * Open an existing ArchiveRecordStore.
@@ -50,6 +54,8 @@ namespace BiometricEvaluation {
 			 *	The path name of the store.
 			 * @param[in] mode
 			 *	Open mode, read-only or read-write.
+			 * @param[in] concurrency
+			 *	Whether the object may be shared by threads.
 			 *
 			 * @throw Error::ObjectDoesNotExist
 			 *	The store does not exist.
@@ -59,7 +65,9 @@ namespace BiometricEvaluation {
 			 */
 			 Impl(
 			     const std::string &pathname,
-			     IO::Mode mode = IO::Mode::ReadOnly);
+			     IO::Mode mode = IO::Mode::ReadOnly,
+			     RecordStore::Concurrency concurrency =
+			     RecordStore::Concurrency::Exclusive);
 
 			/**
 			 * Destructor.
@@ -100,6 +108,11 @@ namespace BiometricEvaluation {
 			void setCursorAtKey(
 			    const std::string &key);
 
+			std::string
+			nextKey(
+			    const std::string &key)
+			    const;
+
 			void move(
 			    const std::string &pathname);
 	
@@ -197,6 +210,13 @@ namespace BiometricEvaluation {
 			mutable std::fstream _manifestfp;
 			/** Archive file handle */
 			mutable std::fstream _archivefp;
+			/**
+			 * Archive file descriptor used for positional reads,
+			 * which readers can share without seeking.
+			 */
+			mutable int _archivefd;
+			/** Whether _archivefp has buffered unflushed writes */
+			mutable bool _unflushed;
 	
 			/*
 			 * Offsets and sizes of data chunks within the archive.
@@ -291,6 +311,38 @@ namespace BiometricEvaluation {
 			keyExists(
 			    const ManifestMap::key_type &k);
 
+			/**
+			 * @brief
+			 * read() without locking.
+			 *
+			 * @param[in] key
+			 *	The key of the record to read.
+			 *
+			 * @return
+			 *	The record's data.
+			 */
+			Memory::uint8Array
+			i_read(
+			    const std::string &key)
+			    const;
+
+			/** sync() without locking. */
+			void
+			i_sync()
+			    const;
+
+			/**
+			 * @brief
+			 * Flush buffered writes to the archive so that
+			 * positional reads can see them.
+			 *
+			 * @throw Error::StrategyError
+			 *	Could not flush the archive.
+			 */
+			void
+			flush_archive()
+			    const;
+
 			/**
 			 * Internal implementation of sequencing through a
 			 * store, returning the key, and optionally, the
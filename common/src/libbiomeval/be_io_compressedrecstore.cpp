@@ -163,3 +163,10 @@ BiometricEvaluation::IO::CompressedRecordStore::changeDescription(
 	return (this->pimpl->changeDescription(description));
 }
 
+void
+BiometricEvaluation::IO::CompressedRecordStore::setBlockCompression(
+    uint64_t blockSize,
+    unsigned int threadCount)
+{
+	this->pimpl->setBlockCompression(blockSize, threadCount);
+}
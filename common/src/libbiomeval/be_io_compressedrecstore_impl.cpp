@@ -14,6 +14,7 @@
 
 #include "be_io_compressedrecstore_impl.h"
 #include <be_memory_autoarrayutility.h>
+#include <be_io_gzip.h>
 #include <be_io_properties.h>
 
 namespace BE = BiometricEvaluation;
@@ -22,6 +23,7 @@ using namespace BE::Framework::Enumeration;
 
 const std::string BACKING_STORE{"theBackingStore"};
 const std::string COMPRESSOR_TYPE_KEY{"Compressor_Type"};
+const std::string BLOCK_SIZE_KEY{"Compressor_Block_Size"};
 const std::string METADATA_SUFFIX{"_md"};
 
 BiometricEvaluation::IO::CompressedRecordStore::Impl::Impl(
@@ -98,6 +100,12 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::Impl(
 	else
 		throw Error::StrategyError(compressorType + " is not a valid "
 		    "compressor type");
+
+	/* Blocks were requested when the store was written */
+	try {
+		this->_compressor->setOption(GZip::BLOCK_SIZE,
+		    props->getPropertyAsInteger(BLOCK_SIZE_KEY));
+	} catch (const Error::ObjectDoesNotExist &) {}
 }
 
 BiometricEvaluation::IO::CompressedRecordStore::Impl::~Impl()
@@ -144,8 +152,10 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::read(
 {
 	Memory::uint8Array compressedData = _rs->read(key);
 	
-	Memory::uint8Array decompressedData = _compressor->decompress(
-	    compressedData);
+	/* Uncompressed size was recorded at insert, so inflate in place */
+	Memory::uint8Array decompressedData(this->length(key));
+	_compressor->decompress(compressedData, compressedData.size(),
+	    decompressedData, decompressedData.size());
 	return (decompressedData);
 }
 
@@ -248,3 +258,18 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::flush(
 	_mdrs->flush(key);
 }
 
+void
+BiometricEvaluation::IO::CompressedRecordStore::Impl::setBlockCompression(
+    uint64_t blockSize,
+    unsigned int threadCount)
+{
+	this->_compressor->setOption(GZip::BLOCK_SIZE,
+	    static_cast<int64_t>(blockSize));
+	this->_compressor->setOption(GZip::THREAD_COUNT, threadCount);
+	if (this->getMode() == Mode::ReadOnly)
+		return;
+
+	std::shared_ptr<IO::Properties> props = this->getProperties();
+	props->setPropertyFromInteger(BLOCK_SIZE_KEY, blockSize);
+	this->setProperties(props);
+}
@@ -145,6 +145,11 @@ namespace BiometricEvaluation
 			move(
 			    const std::string &pathname);
 
+			void
+			setBlockCompression(
+			    uint64_t blockSize,
+			    unsigned int threadCount);
+
 			/**
 			 * @brief
 			 * Copy constructor (disabled).
@@ -8,6 +8,8 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <cstring>
+
 #include <be_framework_enumeration.h>
 #include <be_io_compressor.h>
 
@@ -35,6 +37,7 @@ BiometricEvaluation::IO::Compressor::setOption(
     const std::string &optionValue)
 {
 	_compressorOptions.setProperty(optionName, optionValue);
+	this->optionChanged(optionName);
 }
 
 void
@@ -44,6 +47,7 @@ BiometricEvaluation::IO::Compressor::setOption(
 {
 	_compressorOptions.setPropertyFromInteger(optionName,
 	    optionValue);
+	this->optionChanged(optionName);
 }
 
 std::string
@@ -66,7 +70,49 @@ void
 BiometricEvaluation::IO::Compressor::removeOption(
     const std::string &optionName)
 {
-	return (_compressorOptions.removeProperty(optionName));
+	_compressorOptions.removeProperty(optionName);
+	this->optionChanged(optionName);
+}
+
+void
+BiometricEvaluation::IO::Compressor::optionChanged(
+    const std::string &optionName)
+{
+
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Compressor::compress(
+    Memory::ByteView uncompressedData)
+    const
+{
+	return (this->compress(uncompressedData.data(),
+	    uncompressedData.size()));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Compressor::decompress(
+    Memory::ByteView compressedData)
+    const
+{
+	return (this->decompress(compressedData.data(),
+	    compressedData.size()));
+}
+
+void
+BiometricEvaluation::IO::Compressor::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize,
+    uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize)
+    const
+{
+	const Memory::uint8Array decompressedData = this->decompress(
+	    compressedData, compressedDataSize);
+	if (decompressedData.size() != uncompressedDataSize)
+		throw Error::StrategyError("Decompressed data is not the "
+		    "expected size");
+	std::memcpy(uncompressedData, decompressedData, uncompressedDataSize);
 }
 
 std::shared_ptr<BiometricEvaluation::IO::Compressor>
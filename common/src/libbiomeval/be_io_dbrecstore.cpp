@@ -13,6 +13,16 @@
 
 namespace BE = BiometricEvaluation;
 
+const std::string
+BiometricEvaluation::IO::DBRecordStore::BTREECACHESIZEPROPERTY =
+    "BTree Cache Size";
+const std::string
+BiometricEvaluation::IO::DBRecordStore::BTREEPAGESIZEPROPERTY =
+    "BTree Page Size";
+const std::string
+BiometricEvaluation::IO::DBRecordStore::BTREEMINKEYSPROPERTY =
+    "BTree Minimum Keys Per Page";
+
 BiometricEvaluation::IO::DBRecordStore::DBRecordStore(
     const std::string &pathname,
     const std::string &description)
@@ -23,6 +33,20 @@ BiometricEvaluation::IO::DBRecordStore::DBRecordStore(
 	this->pimpl.reset(new IO::DBRecordStore::Impl(pathname, description));
 }
 
+BiometricEvaluation::IO::DBRecordStore::DBRecordStore(
+    const std::string &pathname,
+    const std::string &description,
+    uint32_t cacheSize,
+    uint32_t pageSize,
+    uint32_t minKeysPerPage)
+{
+	/*
+	 * Exceptions float out.
+	 */
+	this->pimpl.reset(new IO::DBRecordStore::Impl(pathname, description,
+	    cacheSize, pageSize, minKeysPerPage));
+}
+
 BiometricEvaluation::IO::DBRecordStore::DBRecordStore(
     const std::string &pathname,
     IO::Mode mode)
@@ -66,6 +90,13 @@ BiometricEvaluation::IO::DBRecordStore::insert(
 	this->pimpl->insert(key, data, size);
 }
 
+void
+BiometricEvaluation::IO::DBRecordStore::insertSorted(
+    const std::vector<RecordStore::Record> &records)
+{
+	this->pimpl->insertSorted(records);
+}
+
 void
 BiometricEvaluation::IO::DBRecordStore::remove( 
     const std::string &key)
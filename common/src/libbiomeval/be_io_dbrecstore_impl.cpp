@@ -40,13 +40,50 @@ static const std::string SUBORDINATE_DBEXT = ".subordinate";
  */
 static const uint64_t MAX_REC_SIZE = (uint64_t)4294967295U;
 
-static void setBtreeInfo(BTREEINFO *bti)
+/* Limits on the page size accepted by dbopen() */
+static const uint32_t MIN_PAGE_SIZE = 512;
+static const uint32_t MAX_PAGE_SIZE = 65536;
+
+/*
+ * Read an optional B-tree tuning property; absence means 0, the
+ * library default.
+ */
+static u_int
+getBtreeProperty(
+    const std::shared_ptr<BiometricEvaluation::IO::Properties> &props,
+    const std::string &property)
+{
+	int64_t value;
+	try {
+		value = props->getPropertyAsInteger(property);
+	} catch (const BiometricEvaluation::Error::ObjectDoesNotExist&) {
+		return (0);
+	} catch (const BiometricEvaluation::Error::ConversionError&) {
+		throw BiometricEvaluation::Error::StrategyError("Invalid " +
+		    property + " property");
+	}
+	if ((value < 0) || (value > UINT_MAX))
+		throw BiometricEvaluation::Error::StrategyError("Invalid " +
+		    property + " property");
+	return (static_cast<u_int>(value));
+}
+
+void
+BiometricEvaluation::IO::DBRecordStore::Impl::getBtreeInfo(
+    BTREEINFO *bti)
+    const
 {
+	std::shared_ptr<IO::Properties> props = this->getProperties();
+
 	bti->flags = 0;
-	bti->cachesize = 0;	/* Default */
+	bti->cachesize = getBtreeProperty(props,
+	    DBRecordStore::BTREECACHESIZEPROPERTY);
 	bti->maxkeypage = 0;
-	bti->minkeypage = 0;
-	bti->psize = 0;
+	/* Page size and keys per page are ignored for existing files */
+	bti->minkeypage = getBtreeProperty(props,
+	    DBRecordStore::BTREEMINKEYSPROPERTY);
+	bti->psize = getBtreeProperty(props,
+	    DBRecordStore::BTREEPAGESIZEPROPERTY);
 	bti->compare = nullptr;
 	bti->prefix = nullptr;
 	bti->lorder = 4321;	/* Big-endian */
@@ -82,8 +119,48 @@ BiometricEvaluation::IO::DBRecordStore::Impl::getDBFilePathname() const
 BiometricEvaluation::IO::DBRecordStore::Impl::Impl(
     const std::string &pathname,
     const std::string &description) :
+    DBRecordStore::Impl(pathname, description, 0, 0, 0)
+{
+
+}
+
+BiometricEvaluation::IO::DBRecordStore::Impl::Impl(
+    const std::string &pathname,
+    const std::string &description,
+    uint32_t cacheSize,
+    uint32_t pageSize,
+    uint32_t minKeysPerPage) :
     RecordStore::Impl(pathname, description, RecordStore::Kind::BerkeleyDB)
 {
+	/* Tuning is kept in the control file, where open will find it */
+	try {
+		if ((pageSize != 0) && ((pageSize < MIN_PAGE_SIZE) ||
+		    (pageSize > MAX_PAGE_SIZE) ||
+		    ((pageSize & (pageSize - 1)) != 0)))
+			throw Error::ParameterError("Invalid page size");
+		if (minKeysPerPage == 1)
+			throw Error::ParameterError("Invalid minimum keys "
+			    "per page");
+
+		std::shared_ptr<IO::Properties> props =
+		    this->getProperties();
+		if (cacheSize != 0)
+			props->setPropertyFromInteger(
+			    DBRecordStore::BTREECACHESIZEPROPERTY, cacheSize);
+		if (pageSize != 0)
+			props->setPropertyFromInteger(
+			    DBRecordStore::BTREEPAGESIZEPROPERTY, pageSize);
+		if (minKeysPerPage != 0)
+			props->setPropertyFromInteger(
+			    DBRecordStore::BTREEMINKEYSPROPERTY,
+			    minKeysPerPage);
+		this->setProperties(props);
+	} catch (const Error::Exception&) {
+		/* Don't leave behind a store without databases */
+		IO::Utility::removeDirectory(pathname);
+		throw;
+	}
+
 	/*
 	 * The BDB files previously were named after the RecordStore
 	 * name, but name has been removed as concept. However, the
@@ -97,7 +174,7 @@ BiometricEvaluation::IO::DBRecordStore::Impl::Impl(
 
 	/* Create the primary DB file */
 	BTREEINFO bti;
-	setBtreeInfo(&bti);
+	this->getBtreeInfo(&bti);
 	this->_dbP = dbopen(this->_dbnameP.c_str(),
 	    O_CREAT | O_RDWR, DBRS_MODE_RW, DB_BTREE, &bti);
 	if (this->_dbP == nullptr)
@@ -123,7 +200,7 @@ BiometricEvaluation::IO::DBRecordStore::Impl::Impl(
 		throw Error::ObjectDoesNotExist("Database does not exist");
 
 	BTREEINFO bti;
-	setBtreeInfo(&bti);
+	this->getBtreeInfo(&bti);
 	/* Open the primary DB file */
 	if (mode == Mode::ReadWrite)
 		this->_dbP = dbopen(this->_dbnameP.c_str(),
@@ -236,14 +313,16 @@ BiometricEvaluation::IO::DBRecordStore::Impl::move(const std::string &pathname)
 		throw Error::StrategyError("Database " + this->_dbnameS + 
 		    "does not exist");
 
+	BTREEINFO bti;
+	this->getBtreeInfo(&bti);
 	this->_dbP = dbopen(this->_dbnameP.c_str(),
-	     O_RDWR, DBRS_MODE_RW, DB_BTREE, nullptr);
+	     O_RDWR, DBRS_MODE_RW, DB_BTREE, &bti);
 	if (this->_dbP == nullptr)
 		throw Error::StrategyError("Could not open primary DB (" +
 		    Error::errorStr() + ")");
 
 	this->_dbS = dbopen(this->_dbnameS.c_str(),
-	     O_RDWR, DBRS_MODE_RW, DB_BTREE, nullptr);
+	     O_RDWR, DBRS_MODE_RW, DB_BTREE, &bti);
 	if (this->_dbS == nullptr)
 		throw Error::StrategyError("Could not open subordinate DB (" +
 		    Error::errorStr() + ")");
@@ -306,6 +385,54 @@ BiometricEvaluation::IO::DBRecordStore::Impl::insert(
 	RecordStore::Impl::insert(key, data, size);
 }
 
+void
+BiometricEvaluation::IO::DBRecordStore::Impl::insertSorted(
+    const std::vector<RecordStore::Record> &records)
+{
+	if (getMode() == Mode::ReadOnly)
+		throw Error::StrategyError("RecordStore was opened read-only");
+
+	/*
+	 * Check all keys before inserting any. The order is that of the
+	 * B-tree's default comparison: bytewise, with a prefix sorting
+	 * before the longer key.
+	 */
+	for (size_t i = 0; i < records.size(); i++) {
+		if (!validateKeyString(records[i].key))
+			throw Error::StrategyError("Invalid key format");
+		if ((i > 0) && !(records[i - 1].key < records[i].key))
+			throw Error::ParameterError("Key " + records[i].key +
+			    " is out of order");
+	}
+
+	/* A record exists if the first segment is in the primary DB */
+	for (const auto &record : records) {
+		DBT dbtkey;
+		DBT dbtdata;
+		dbtkey.data = (void *)record.key.data();
+		dbtkey.size = record.key.length();
+		const int rc = this->_dbP->get(this->_dbP, &dbtkey, &dbtdata,
+		    0);
+		if (rc == 0)
+			throw Error::ObjectExists(record.key);
+		if (rc != 1)
+			throw Error::StrategyError("Could not read from DB (" +
+			    Error::errorStr() + ")");
+	}
+
+	/*
+	 * Each put now lands on the rightmost leaf, which the B-tree
+	 * finds without a search, and full leaves are split by adding
+	 * a new page rather than halving the old one.
+	 */
+	for (const auto &record : records) {
+		insertRecordSegments(record.key, record.data,
+		    record.data.size());
+		RecordStore::Impl::insert(record.key, record.data,
+		    record.data.size());
+	}
+}
+
 void
 BiometricEvaluation::IO::DBRecordStore::Impl::remove( 
     const std::string &key)
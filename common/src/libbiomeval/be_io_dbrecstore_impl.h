@@ -56,6 +56,36 @@ namespace BiometricEvaluation {
 			    const std::string &pathname,
 			    const std::string &description);
 
+			/**
+			 * Create a new DBRecordStore with tuned B-trees,
+			 * read/write mode.
+			 *
+			 * @param[in] pathname
+			 *	The directory where the store will be created.
+			 * @param[in] description
+			 *	The store's description.
+			 * @param[in] cacheSize
+			 *	Bytes of memory to cache pages of each B-tree.
+			 * @param[in] pageSize
+			 *	Bytes in each page of the B-trees.
+			 * @param[in] minKeysPerPage
+			 *	Minimum keys on each page of the B-trees.
+			 *
+			 * @throw Error::ObjectExists
+			 * 	The store already exists.
+			 * @throw Error::ParameterError
+			 *	pageSize or minKeysPerPage is invalid.
+			 * @throw Error::StrategyError
+			 * 	An error occurred when accessing the underlying
+			 * 	file system.
+			 */
+			Impl(
+			    const std::string &pathname,
+			    const std::string &description,
+			    uint32_t cacheSize,
+			    uint32_t pageSize,
+			    uint32_t minKeysPerPage);
+
 			/**
 			 * Open an existing DBRecordStore.
 			 *
@@ -95,6 +125,10 @@ namespace BiometricEvaluation {
 			    const void *const data,
 			    const uint64_t size);
 
+			void
+			insertSorted(
+			    const std::vector<RecordStore::Record> &records);
+
 			void remove(
 			    const std::string &key);
 
@@ -142,6 +176,12 @@ namespace BiometricEvaluation {
 			 */
 			std::string getDBFilePathname() const;
 
+			/*
+			 * Fill in the B-tree parameters from the control
+			 * properties.
+			 */
+			void getBtreeInfo(BTREEINFO *bti) const;
+
 			/*
 			 * Functions to insert/read/sequence/remove all
 			 * segments of a record. 
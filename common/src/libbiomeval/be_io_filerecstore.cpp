@@ -14,22 +14,26 @@ namespace BE = BiometricEvaluation;
 
 BiometricEvaluation::IO::FileRecordStore::FileRecordStore(
     const std::string &pathname,
-    const std::string &description)
+    const std::string &description,
+    RecordStore::Concurrency concurrency)
 {
 	/*
 	 * Exceptions float out.
 	 */
-	this->pimpl.reset(new IO::FileRecordStore::Impl(pathname, description));
+	this->pimpl.reset(new IO::FileRecordStore::Impl(pathname, description,
+	    concurrency));
 }
 
 BiometricEvaluation::IO::FileRecordStore::FileRecordStore(
     const std::string &pathname,
-    IO::Mode mode)
+    IO::Mode mode,
+    RecordStore::Concurrency concurrency)
 {
 	/*
 	 * Exceptions float out.
 	 */
-	this->pimpl.reset(new IO::FileRecordStore::Impl(pathname, mode));
+	this->pimpl.reset(new IO::FileRecordStore::Impl(pathname, mode,
+	    concurrency));
 }
 
 BiometricEvaluation::IO::FileRecordStore::~FileRecordStore()
@@ -126,6 +130,20 @@ BiometricEvaluation::IO::FileRecordStore::setCursorAtKey(
 	this->pimpl->setCursorAtKey(key);
 }
 
+std::string
+BiometricEvaluation::IO::FileRecordStore::nextKey(
+    const std::string &key)
+{
+	return (this->pimpl->nextKey(key));
+}
+
+BiometricEvaluation::IO::RecordStore::Concurrency
+BiometricEvaluation::IO::FileRecordStore::getConcurrency()
+    const
+{
+	return (this->pimpl->getConcurrency());
+}
+
 unsigned int
 BiometricEvaluation::IO::FileRecordStore::getCount()
     const
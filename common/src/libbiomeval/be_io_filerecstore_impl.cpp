@@ -26,8 +26,10 @@ static const std::string _fileArea = "theFiles";
 
 BiometricEvaluation::IO::FileRecordStore::Impl::Impl(
     const std::string &pathname,
-    const std::string &description) :
-    RecordStore::Impl(pathname, description, RecordStore::Kind::File)
+    const std::string &description,
+    RecordStore::Concurrency concurrency) :
+    RecordStore::Impl(pathname, description, RecordStore::Kind::File,
+    concurrency)
 {
 	_cursorPos = 1;
 	_theFilesDir = RecordStore::Impl::canonicalName(_fileArea);
@@ -39,8 +41,9 @@ BiometricEvaluation::IO::FileRecordStore::Impl::Impl(
 
 BiometricEvaluation::IO::FileRecordStore::Impl::Impl(
     const std::string &pathname,
-    IO::Mode mode) :
-    RecordStore::Impl(pathname, mode)
+    IO::Mode mode,
+    RecordStore::Concurrency concurrency) :
+    RecordStore::Impl(pathname, mode, concurrency)
 {
 	_cursorPos = 1;
 	_theFilesDir = RecordStore::Impl::canonicalName(_fileArea);
@@ -59,6 +62,7 @@ BiometricEvaluation::IO::FileRecordStore::Impl::move(
 	if (getMode() == Mode::ReadOnly)
 		throw Error::StrategyError("RecordStore was opened read-only");
 
+	WriterLock lock(*this);
 	RecordStore::Impl::move(pathname);
 	_theFilesDir = RecordStore::Impl::canonicalName(_fileArea);
 }
@@ -69,6 +73,7 @@ BiometricEvaluation::IO::FileRecordStore::Impl::getSpaceUsed()
 {
 	this->sync();
 	
+	ReaderLock lock(*this);
 	DIR *dir;
 	dir = opendir(this->_theFilesDir.c_str());
 	if (dir == nullptr)
@@ -112,6 +117,7 @@ BiometricEvaluation::IO::FileRecordStore::Impl::insert(
 
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
+	WriterLock lock(*this);
 	std::string pathname = FileRecordStore::Impl::canonicalName(key);
 	if (IO::Utility::fileExists(pathname))
 		throw Error::ObjectExists();
@@ -133,6 +139,7 @@ BiometricEvaluation::IO::FileRecordStore::Impl::remove(
 
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
+	WriterLock lock(*this);
 	std::string pathname = FileRecordStore::Impl::canonicalName(key);
 	if (!IO::Utility::fileExists(pathname))
 		throw Error::ObjectDoesNotExist();
@@ -147,6 +154,15 @@ BiometricEvaluation::Memory::uint8Array
 BiometricEvaluation::IO::FileRecordStore::Impl::read(
     const std::string &key)
     const
+{
+	ReaderLock lock(*this);
+	return (this->i_read(key));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::FileRecordStore::Impl::i_read(
+    const std::string &key)
+    const
 {
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
@@ -181,6 +197,7 @@ BiometricEvaluation::IO::FileRecordStore::Impl::replace(
 
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
+	WriterLock lock(*this);
 	std::string pathname = FileRecordStore::Impl::canonicalName(key);
 	if (!IO::Utility::fileExists(pathname))
 		throw Error::ObjectDoesNotExist();
@@ -199,6 +216,7 @@ BiometricEvaluation::IO::FileRecordStore::Impl::length(
 {
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
+	ReaderLock lock(*this);
 	std::string pathname = FileRecordStore::Impl::canonicalName(key);
 	if (!IO::Utility::fileExists(pathname))
 		throw Error::ObjectDoesNotExist();
@@ -216,6 +234,7 @@ BiometricEvaluation::IO::FileRecordStore::Impl::flush(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
+	ReaderLock lock(*this);
 	std::string pathname = FileRecordStore::Impl::canonicalName(key);
 	if (!IO::Utility::fileExists(pathname))
 		throw Error::ObjectDoesNotExist();
@@ -287,7 +306,7 @@ BiometricEvaluation::IO::FileRecordStore::Impl::i_sequence(
 	}
 	
 	if (returnData)
-		record.data = FileRecordStore::Impl::read(record.key);
+		record.data = this->i_read(record.key);
 	return (record);
 }
 
@@ -295,6 +314,7 @@ BiometricEvaluation::IO::RecordStore::Record
 BiometricEvaluation::IO::FileRecordStore::Impl::sequence(
     int cursor)
 {
+	WriterLock lock(*this);
 	return (i_sequence(true, cursor));
 }
 
@@ -302,6 +322,7 @@ std::string
 BiometricEvaluation::IO::FileRecordStore::Impl::sequenceKey(
     int cursor)
 {
+	WriterLock lock(*this);
 	BE::IO::RecordStore::Record record = i_sequence(false, cursor);
 	return (record.key);
 }
@@ -313,6 +334,7 @@ BiometricEvaluation::IO::FileRecordStore::Impl::setCursorAtKey(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
+	WriterLock lock(*this);
 	DIR *dir;
 	dir = opendir(_theFilesDir.c_str());
 	if (dir == nullptr)
@@ -332,6 +354,8 @@ BiometricEvaluation::IO::FileRecordStore::Impl::setCursorAtKey(
 		if ((S_IFMT & sb.st_mode) == S_IFDIR)	/* skip '.' and '..' */
 			continue;
 		if (key == entry->d_name) {
+			/* Sequence from here even if never sequenced */
+			setCursor(BE_RECSTORE_SEQ_NEXT);
 			_cursorPos = i;
 			break;
 		}
@@ -351,6 +375,55 @@ BiometricEvaluation::IO::FileRecordStore::Impl::setCursorAtKey(
 	}
 }
 
+std::string
+BiometricEvaluation::IO::FileRecordStore::Impl::nextKey(
+    const std::string &key)
+    const
+{
+	if (!key.empty() && !validateKeyString(key))
+		throw Error::StrategyError("Invalid key format");
+
+	ReaderLock lock(*this);
+	DIR *dir;
+	dir = opendir(_theFilesDir.c_str());
+	if (dir == nullptr)
+		throw Error::StrategyError("Cannot open store directory");
+
+	/* Directory order is the sequence order */
+	struct dirent *entry;
+	struct stat sb;
+	std::string cname;
+	bool foundKey = key.empty();
+	std::string next;
+	while ((entry = readdir(dir)) != nullptr) {
+		if (entry->d_ino == 0)
+			continue;
+		cname = _theFilesDir + "/" + entry->d_name;
+		if (stat(cname.c_str(), &sb) != 0) {
+			closedir(dir);
+			throw Error::StrategyError("Cannot stat store file (" +
+			    Error::errorStr() + ")");
+		}
+		if ((S_IFMT & sb.st_mode) == S_IFDIR)	/* skip '.' and '..' */
+			continue;
+		if (foundKey) {
+			next = entry->d_name;
+			break;
+		}
+		if (key == entry->d_name)
+			foundKey = true;
+	}
+
+	if (closedir(dir))
+		throw Error::StrategyError("Could not close " + _theFilesDir +
+		    " (" + Error::errorStr() + ")");
+	if (!foundKey)
+		throw Error::ObjectDoesNotExist(key);
+	if (next.empty())
+		throw Error::ObjectDoesNotExist("No record after " + key);
+	return (next);
+}
+
 /******************************************************************************/
 /* Private method implementations.                                            */
 /******************************************************************************/
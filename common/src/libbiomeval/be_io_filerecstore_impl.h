@@ -41,6 +41,8 @@ namespace BiometricEvaluation {
 			 *	The directory where the store is to be created.
 			 * @param[in] description
 			 *	The store's description.
+			 * @param[in] concurrency
+			 *	Whether the object may be shared by threads.
 			 * @throw  Error::ObjectExists
 			 *	The store already exists.
 			 * @throw Error::StrategyError
@@ -49,7 +51,9 @@ namespace BiometricEvaluation {
 			 */
 			Impl(
 			    const std::string &pathname,
-			    const std::string &description);
+			    const std::string &description,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
 
 			/**
 			 * Open an existing FileRecordStore.
@@ -58,6 +62,8 @@ namespace BiometricEvaluation {
 			 *	The path name of the store.
 			 * @param[in] mode
 			 *	Open mode, read-only or read-write.
+			 * @param[in] concurrency
+			 *	Whether the object may be shared by threads.
 			 *
 			 * @throw Error::ObjectDoesNotExist
 			 *	The store does not exist.
@@ -67,7 +73,9 @@ namespace BiometricEvaluation {
 			 */
 			Impl(
 			    const std::string &name,
-			    IO::Mode mode = IO::Mode::ReadOnly);
+			    IO::Mode mode = IO::Mode::ReadOnly,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
 
 			~Impl();
 
@@ -104,6 +112,8 @@ namespace BiometricEvaluation {
 
 			void setCursorAtKey(const std::string &key);
 
+			std::string nextKey(const std::string &key) const;
+
 			void move(const std::string &pathname);
 
 			/* Prevent copying of FileRecordStore objects */
@@ -123,6 +133,10 @@ namespace BiometricEvaluation {
 			uint64_t _cursorPos;
 			std::string _theFilesDir;
 
+			/** read() without locking */
+			Memory::uint8Array i_read(
+			    const std::string &key) const;
+
 			/**
 			 * Internal implementation of sequencing through a
 			 * store, returning the key, and optionally, the
@@ -8,7 +8,16 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
 
 #include <zlib.h>
 
@@ -26,9 +35,597 @@ const std::string
 const std::string BiometricEvaluation::IO::GZip::WINDOW_BITS = "WindowBits";
 const std::string BiometricEvaluation::IO::GZip::MEMORY_LEVEL = "MemoryLevel";
 const std::string BiometricEvaluation::IO::GZip::CHUNK_SIZE = "ChunkSize";
+const std::string BiometricEvaluation::IO::GZip::BLOCK_SIZE = "BlockSize";
+const std::string BiometricEvaluation::IO::GZip::THREAD_COUNT = "ThreadCount";
+
+/** Largest length zlib can be given in one z_stream field */
+static const uint64_t ZLIB_MAX_LENGTH = std::numeric_limits<uInt>::max();
+
+/** Largest ratio of inflated to deflated sizes that deflate can produce */
+static const uint64_t DEFLATE_MAX_RATIO = 1032;
+
+/** Bytes in the header of a gzip member written for a block */
+static const uint64_t BLOCK_HEADER_SIZE = 20;
+/** Bytes in the trailer of a gzip member (CRC-32 and size) */
+static const uint64_t GZIP_TRAILER_SIZE = 8;
+/** Largest block, so that sizes fit the 32-bit fields of a member */
+static const uint64_t MAX_BLOCK_SIZE = UINT64_C(1) << 30;
+/**
+ * Header of a gzip member written for a block, less the member size
+ * that follows: magic, deflate, FEXTRA, no MTIME, no XFL, unknown OS,
+ * XLEN of 8, and subfield "BE" of 4 bytes.
+ */
+static const uint8_t BLOCK_HEADER[BLOCK_HEADER_SIZE - 4] = {
+    0x1F, 0x8B, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0xFF, 0x08, 0x00, 'B', 'E', 0x04, 0x00};
+
+/** Location of a block within compressed and uncompressed buffers */
+struct GZipBlock
+{
+	/** Offset of the gzip member in the compressed buffer */
+	uint64_t compressedOffset;
+	/** Size of the gzip member */
+	uint64_t compressedSize;
+	/** Offset of the block in the uncompressed buffer */
+	uint64_t uncompressedOffset;
+	/** Size of the block */
+	uint64_t uncompressedSize;
+};
+
+struct BiometricEvaluation::IO::GZip::Streams
+{
+	/** Option values, as integers */
+	struct Options
+	{
+		int level;
+		int method;
+		int windowBits;
+		int memoryLevel;
+		int strategy;
+		uint64_t chunkSize;
+		uint64_t blockSize;
+		unsigned int threadCount;
+
+		/** Parse option values from a Compressor's properties */
+		static Options
+		read(
+		    const Compressor &compressor)
+		{
+			Options options;
+			options.level = compressor.getOptionAsInteger(
+			    COMPRESSION_LEVEL);
+			options.method = compressor.getOptionAsInteger(
+			    COMPRESSION_METHOD);
+			options.windowBits = compressor.getOptionAsInteger(
+			    WINDOW_BITS);
+			options.memoryLevel = compressor.getOptionAsInteger(
+			    MEMORY_LEVEL);
+			options.strategy = compressor.getOptionAsInteger(
+			    COMPRESSION_STRATEGY);
+			options.chunkSize = compressor.getOptionAsInteger(
+			    CHUNK_SIZE);
+			options.blockSize = std::min<uint64_t>(
+			    compressor.getOptionAsInteger(BLOCK_SIZE),
+			    MAX_BLOCK_SIZE);
+			options.threadCount = compressor.getOptionAsInteger(
+			    THREAD_COUNT);
+			if (options.threadCount == 0)
+				options.threadCount = std::max(1u,
+				    std::thread::hardware_concurrency());
+			return (options);
+		}
+
+		/**
+		 * @return
+		 * Whether buffers larger than blockSize should be
+		 * compressed as blocks.  Blocks are gzip members, so
+		 * the gzip wrapper must be in use.
+		 */
+		bool
+		useBlocks(
+		    uint64_t size)
+		    const
+		{
+			return ((this->blockSize > 0) &&
+			    (size > this->blockSize) &&
+			    (this->windowBits >= (GZIP_WBITS_MAGIC + 9)) &&
+			    (this->windowBits <= (GZIP_WBITS_MAGIC +
+			    MAX_WBITS)));
+		}
+	};
+
+	/**
+	 * A z_stream for one operation: the cached stream, reset, when no
+	 * other thread is using it, otherwise a stream of its own.
+	 */
+	class Lease
+	{
+	public:
+		Lease(
+		    Streams &streams,
+		    const Compressor &compressor,
+		    bool deflating) :
+		    _lock(streams.mutex, std::try_to_lock),
+		    _deflating(deflating)
+		{
+			const Options options = streams.getOptions(compressor);
+			if (!this->_lock.owns_lock()) {
+				this->init(this->_local, options);
+				this->_strm = &this->_local;
+				return;
+			}
+
+			bool &ready = (deflating ? streams.deflateReady :
+			    streams.inflateReady);
+			z_stream &cached = (deflating ? streams.deflateStream :
+			    streams.inflateStream);
+			if (ready) {
+				const int rv = (deflating ?
+				    deflateReset(&cached) :
+				    inflateReset(&cached));
+				if (rv == Z_OK) {
+					this->_strm = &cached;
+					return;
+				}
+				Streams::end(cached, deflating);
+				ready = false;
+			}
+			this->init(cached, options);
+			ready = true;
+			this->_strm = &cached;
+		}
+
+		z_stream&
+		get()
+		{
+			return (*this->_strm);
+		}
+
+		~Lease()
+		{
+			if (this->_strm == &this->_local)
+				Streams::end(this->_local, this->_deflating);
+		}
+
+		Lease(const Lease&) = delete;
+		Lease& operator=(const Lease&) = delete;
+
+	private:
+		void
+		init(
+		    z_stream &strm,
+		    const Options &options)
+		{
+			if (this->_deflating)
+				Streams::initDeflate(strm, options);
+			else
+				Streams::initInflate(strm, options);
+		}
+
+		std::unique_lock<std::mutex> _lock;
+		const bool _deflating;
+		z_stream _local;
+		z_stream *_strm{nullptr};
+	};
+
+	/** Initialize a compression stream in place */
+	static void
+	initDeflate(
+	    z_stream &strm,
+	    const Options &options)
+	{
+		/* Must be set before initialization */
+		strm.zalloc = Z_NULL;
+		strm.zfree = Z_NULL;
+		strm.opaque = Z_NULL;
+
+		if (deflateInit2(&strm, options.level, options.method,
+		    options.windowBits, options.memoryLevel,
+		    options.strategy) != Z_OK)
+			throw Error::StrategyError("Could not initialize "
+			    "stream");
+	}
+
+	/** Initialize a decompression stream in place */
+	static void
+	initInflate(
+	    z_stream &strm,
+	    const Options &options)
+	{
+		/* Must be set before initialization */
+		strm.zalloc = Z_NULL;
+		strm.zfree = Z_NULL;
+		strm.opaque = Z_NULL;
+		strm.avail_in = 0;
+		strm.next_in = Z_NULL;
+
+		if (inflateInit2(&strm, options.windowBits) != Z_OK)
+			throw Error::StrategyError("Could not initialize "
+			    "stream");
+	}
+
+	static void
+	end(
+	    z_stream &strm,
+	    bool deflating)
+	{
+		if (deflating)
+			deflateEnd(&strm);
+		else
+			inflateEnd(&strm);
+	}
+
+	/**
+	 * @return
+	 * Cached option values, or values parsed now when an option
+	 * was missing or malformed when last changed (in which case
+	 * this throws as getOptionAsInteger() does).
+	 */
+	Options
+	getOptions(
+	    const Compressor &compressor)
+	    const
+	{
+		if (this->optionsCached)
+			return (this->options);
+		return (Options::read(compressor));
+	}
+
+	/** Re-read option values and discard streams built from them */
+	void
+	refresh(
+	    const Compressor &compressor)
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (this->deflateReady)
+			Streams::end(this->deflateStream, true);
+		if (this->inflateReady)
+			Streams::end(this->inflateStream, false);
+		this->deflateReady = this->inflateReady = false;
+
+		try {
+			this->options = Options::read(compressor);
+			this->optionsCached = true;
+		} catch (Error::Exception&) {
+			this->optionsCached = false;
+		}
+	}
+
+	static Memory::uint8Array
+	compressBlocks(
+	    const uint8_t *const uncompressedData,
+	    uint64_t uncompressedDataSize,
+	    const Options &options);
+
+	~Streams()
+	{
+		if (this->deflateReady)
+			Streams::end(this->deflateStream, true);
+		if (this->inflateReady)
+			Streams::end(this->inflateStream, false);
+	}
+
+	/** Whether options holds the values of every option */
+	bool optionsCached{false};
+	/** Option values as of the last change */
+	Options options;
+
+	/** Serializes use of the cached streams */
+	std::mutex mutex;
+	/** Whether deflateStream has been initialized */
+	bool deflateReady{false};
+	/** Compression stream, reset between uses */
+	z_stream deflateStream;
+	/** Whether inflateStream has been initialized */
+	bool inflateReady{false};
+	/** Decompression stream, reset between uses */
+	z_stream inflateStream;
+};
+
+/**
+ * @brief
+ * Convert a fatal return value from inflate into an exception.
+ *
+ * @param rv
+ *	Return value from inflate.
+ *
+ * @throw Error::StrategyError
+ *	rv indicates an error.
+ */
+static void
+checkInflateResult(
+    int rv)
+{
+	switch (rv) {
+	case Z_NEED_DICT:
+		throw BiometricEvaluation::Error::StrategyError("Need "
+		    "dictionary during inflation");
+	case Z_DATA_ERROR:
+		throw BiometricEvaluation::Error::StrategyError("Data error "
+		    "during inflation");
+	case Z_MEM_ERROR:
+		throw BiometricEvaluation::Error::StrategyError("Memory error "
+		    "during inflation");
+	case Z_STREAM_ERROR:
+		throw BiometricEvaluation::Error::StrategyError("Stream error "
+		    "during inflate");
+	}
+}
+
+static void
+putLE32(
+    uint8_t *buffer,
+    uint32_t value)
+{
+	for (int i = 0; i < 4; i++)
+		buffer[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+static uint32_t
+getLE32(
+    const uint8_t *buffer)
+{
+	return (static_cast<uint32_t>(buffer[0]) |
+	    (static_cast<uint32_t>(buffer[1]) << 8) |
+	    (static_cast<uint32_t>(buffer[2]) << 16) |
+	    (static_cast<uint32_t>(buffer[3]) << 24));
+}
+
+/** A raw (unwrapped) deflate or inflate stream, ended when destroyed. */
+class RawStream
+{
+public:
+	/** Raw inflate stream */
+	RawStream() :
+	    _deflating(false)
+	{
+		this->strm.zalloc = Z_NULL;
+		this->strm.zfree = Z_NULL;
+		this->strm.opaque = Z_NULL;
+		this->strm.avail_in = 0;
+		this->strm.next_in = Z_NULL;
+		if (inflateInit2(&this->strm, -MAX_WBITS) != Z_OK)
+			throw BiometricEvaluation::Error::StrategyError("Could "
+			    "not initialize stream");
+	}
+
+	/** Raw deflate stream */
+	RawStream(
+	    int level,
+	    int method,
+	    int windowBits,
+	    int memoryLevel,
+	    int strategy) :
+	    _deflating(true)
+	{
+		this->strm.zalloc = Z_NULL;
+		this->strm.zfree = Z_NULL;
+		this->strm.opaque = Z_NULL;
+		if (deflateInit2(&this->strm, level, method, -windowBits,
+		    memoryLevel, strategy) != Z_OK)
+			throw BiometricEvaluation::Error::StrategyError("Could "
+			    "not initialize stream");
+	}
+
+	~RawStream()
+	{
+		if (this->_deflating)
+			deflateEnd(&this->strm);
+		else
+			inflateEnd(&this->strm);
+	}
+
+	RawStream(const RawStream&) = delete;
+	RawStream& operator=(const RawStream&) = delete;
+
+	z_stream strm;
+
+private:
+	const bool _deflating;
+};
+
+/**
+ * @brief
+ * Run work(0) through work(count - 1) on up to threadCount threads,
+ * including the calling thread.
+ *
+ * @throw Error::Exception
+ *	The first exception thrown from work.
+ */
+static void
+runOnThreads(
+    uint64_t count,
+    unsigned int threadCount,
+    const std::function<void(uint64_t)> &work)
+{
+	std::atomic<uint64_t> next{0};
+	std::mutex errorMutex;
+	std::exception_ptr error;
+	const auto worker = [&]() {
+		for (uint64_t i = next++; i < count; i = next++) {
+			try {
+				work(i);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(errorMutex);
+				if (!error)
+					error = std::current_exception();
+				next = count;
+				return;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (uint64_t i = 1; i < std::min<uint64_t>(threadCount, count); i++) {
+		try {
+			threads.emplace_back(worker);
+		} catch (const std::system_error&) {
+			/* Make do with the threads already running */
+			break;
+		}
+	}
+	worker();
+	for (auto &thread : threads)
+		thread.join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+/**
+ * @brief
+ * Locate the blocks of a buffer compressed as blocks.
+ *
+ * @param compressedData
+ *	Compressed data.
+ * @param compressedDataSize
+ *	Size of compressedData.
+ * @param blocks
+ *	Populated with the location of each block.
+ *
+ * @return
+ *	true if compressedData consists entirely of more than one block,
+ *	false otherwise.
+ */
+static bool
+findBlocks(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize,
+    std::vector<GZipBlock> &blocks)
+{
+	blocks.clear();
+	uint64_t offset = 0, uncompressedOffset = 0;
+	while (offset < compressedDataSize) {
+		const uint8_t *member = compressedData + offset;
+		if ((compressedDataSize - offset) <
+		    (BLOCK_HEADER_SIZE + GZIP_TRAILER_SIZE))
+			return (false);
+		/* Ignore MTIME, XFL, and OS */
+		if ((std::memcmp(member, BLOCK_HEADER, 4) != 0) ||
+		    (std::memcmp(member + 10, BLOCK_HEADER + 10, 6) != 0))
+			return (false);
+
+		const uint64_t size = getLE32(member + BLOCK_HEADER_SIZE - 4);
+		if ((size < (BLOCK_HEADER_SIZE + GZIP_TRAILER_SIZE)) ||
+		    (size > (compressedDataSize - offset)))
+			return (false);
+		const uint64_t uncompressedSize = getLE32(member + size - 4);
+		if (uncompressedSize > (size * DEFLATE_MAX_RATIO))
+			return (false);
+
+		blocks.push_back({offset, size, uncompressedOffset,
+		    uncompressedSize});
+		offset += size;
+		uncompressedOffset += uncompressedSize;
+	}
+	return (blocks.size() > 1);
+}
+
+/**
+ * @brief
+ * Decompress blocks in parallel.
+ *
+ * @param compressedData
+ *	Compressed data.
+ * @param blocks
+ *	Location of each block, from findBlocks().
+ * @param uncompressedData
+ *	Buffer large enough to hold every block.
+ * @param threadCount
+ *	Number of threads.
+ *
+ * @throw Error::StrategyError
+ *	A block is corrupt.
+ */
+static void
+decompressBlocks(
+    const uint8_t *const compressedData,
+    const std::vector<GZipBlock> &blocks,
+    uint8_t *const uncompressedData,
+    unsigned int threadCount)
+{
+	runOnThreads(blocks.size(), threadCount, [&](uint64_t i) {
+		const GZipBlock &block = blocks[i];
+		const uint8_t *member = compressedData +
+		    block.compressedOffset;
+		uint8_t *output = uncompressedData + block.uncompressedOffset;
+
+		RawStream raw;
+		uint8_t emptyBuffer;
+		raw.strm.next_in = (uint8_t *)(member + BLOCK_HEADER_SIZE);
+		raw.strm.avail_in = block.compressedSize - BLOCK_HEADER_SIZE -
+		    GZIP_TRAILER_SIZE;
+		raw.strm.next_out = ((block.uncompressedSize == 0) ?
+		    &emptyBuffer : output);
+		raw.strm.avail_out = block.uncompressedSize;
+
+		const int rv = inflate(&raw.strm, Z_FINISH);
+		checkInflateResult(rv);
+		if ((rv != Z_STREAM_END) || (raw.strm.avail_in != 0) ||
+		    (raw.strm.avail_out != 0))
+			throw BiometricEvaluation::Error::StrategyError(
+			    "Corrupt compressed block");
+		if (crc32(0, output, block.uncompressedSize) != getLE32(member +
+		    block.compressedSize - GZIP_TRAILER_SIZE))
+			throw BiometricEvaluation::Error::StrategyError("CRC "
+			    "mismatch in compressed block");
+	});
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::GZip::Streams::compressBlocks(
+    const uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize,
+    const Options &options)
+{
+	const uint64_t count = (uncompressedDataSize + options.blockSize - 1) /
+	    options.blockSize;
+	std::vector<Memory::uint8Array> members(count);
+	runOnThreads(count, options.threadCount, [&](uint64_t i) {
+		const uint8_t *input = uncompressedData + (i *
+		    options.blockSize);
+		const uint64_t inputSize = std::min(options.blockSize,
+		    uncompressedDataSize - (i * options.blockSize));
+
+		RawStream raw(options.level, options.method,
+		    options.windowBits - GZIP_WBITS_MAGIC,
+		    options.memoryLevel, options.strategy);
+		Memory::uint8Array &member = members[i];
+		member.resize(BLOCK_HEADER_SIZE + deflateBound(&raw.strm,
+		    inputSize) + GZIP_TRAILER_SIZE);
+		raw.strm.next_in = (uint8_t *)input;
+		raw.strm.avail_in = inputSize;
+		raw.strm.next_out = member + BLOCK_HEADER_SIZE;
+		raw.strm.avail_out = member.size() - BLOCK_HEADER_SIZE -
+		    GZIP_TRAILER_SIZE;
+		if (deflate(&raw.strm, Z_FINISH) != Z_STREAM_END)
+			throw Error::StrategyError("Could not compress block");
+
+		const uint64_t memberSize = BLOCK_HEADER_SIZE +
+		    raw.strm.total_out + GZIP_TRAILER_SIZE;
+		std::memcpy(member, BLOCK_HEADER, sizeof(BLOCK_HEADER));
+		putLE32(member + BLOCK_HEADER_SIZE - 4, memberSize);
+		putLE32(member + memberSize - GZIP_TRAILER_SIZE,
+		    crc32(0, input, inputSize));
+		putLE32(member + memberSize - 4, inputSize);
+		member.resize(memberSize);
+	});
+
+	uint64_t totalSize = 0;
+	for (const auto &member : members)
+		totalSize += member.size();
+	Memory::uint8Array compressedData(totalSize);
+	uint64_t offset = 0;
+	for (const auto &member : members) {
+		std::memcpy(compressedData + offset, member, member.size());
+		offset += member.size();
+	}
+	return (compressedData);
+}
 
 BiometricEvaluation::IO::GZip::GZip() :
-    BiometricEvaluation::IO::Compressor()
+    BiometricEvaluation::IO::Compressor(),
+    _streams(new Streams())
 {
 	this->setOption(COMPRESSION_LEVEL, Z_DEFAULT_COMPRESSION);
 	this->setOption(COMPRESSION_STRATEGY, Z_DEFAULT_STRATEGY);
@@ -37,6 +634,13 @@ BiometricEvaluation::IO::GZip::GZip() :
 	
 	/* 16 KB */
 	this->setOption(CHUNK_SIZE, 16384);
+
+	/*
+	 * Compress as a single stream, on the calling thread, unless
+	 * blocks are requested. Callers may already run a thread per core.
+	 */
+	this->setOption(BLOCK_SIZE, 0);
+	this->setOption(THREAD_COUNT, 1);
 	
 	/* Adding GZIP to window bits tells zlib to insert gzip header */
 	this->setOption(WINDOW_BITS, MAX_WBITS + GZIP_WBITS_MAGIC);
@@ -54,49 +658,45 @@ BiometricEvaluation::IO::GZip::compress(
     uint64_t uncompressedDataSize)
     const
 {
-	z_stream strm = this->initCompressionStream();
-		
-	uint8_t flush = Z_NO_FLUSH;
-	int32_t rv;
-	uint64_t chunk = this->getOptionAsInteger(CHUNK_SIZE);
+	const Streams::Options options = this->_streams->getOptions(*this);
+	if (options.useBlocks(uncompressedDataSize))
+		return (Streams::compressBlocks(uncompressedData,
+		    uncompressedDataSize, options));
+
+	Streams::Lease lease(*this->_streams, *this, true);
+	z_stream &strm = lease.get();
+
+	/* Size output once, for the worst case */
+	Memory::uint8Array compressedData(deflateBound(&strm,
+	    uncompressedDataSize));
 	uint64_t remainingBytes = uncompressedDataSize;
 	uint64_t totalCompressedBytes = 0;
-	Memory::uint8Array compressedData(chunk);
+	strm.next_in = (uint8_t *)uncompressedData;
+	strm.avail_in = 0;
+
+	int32_t rv;
 	do {
-		/* Move uncompressed pointer */
-		strm.next_in = (uint8_t *)(uncompressedData + 
-		    (uncompressedDataSize - remainingBytes));
-		
-		/* Update EOF */
-		if (chunk > remainingBytes) {
-			strm.avail_in = remainingBytes;
-			remainingBytes = 0;
-			flush = Z_FINISH;
-		} else {
-			strm.avail_in = chunk;
-			remainingBytes -= chunk;
-			flush = Z_NO_FLUSH;
-		}
-		
-		/* Perform compression */
-		rv = this->compressChunk(flush, chunk, totalCompressedBytes,
-		    compressedData, false, strm);
-		
-		/* Sanity check */
-		if (strm.avail_in != 0) {
-			deflateEnd(&strm);
-			throw Error::StrategyError("Uncompressed data remains "
-			    "after compressing chunk");
+		/* zlib lengths are 32 bits, so feed large buffers in parts */
+		if ((strm.avail_in == 0) && (remainingBytes > 0)) {
+			strm.avail_in = std::min(remainingBytes,
+			    ZLIB_MAX_LENGTH);
+			remainingBytes -= strm.avail_in;
 		}
-			    
-	} while (flush != Z_FINISH);
-	deflateEnd(&strm);
-	
-	/* Sanity check */
-	if (rv != Z_STREAM_END)
-		throw Error::StrategyError("Finished compressing, but not "
-		    "at stream end");
-	
+		if (totalCompressedBytes == compressedData.size())
+			compressedData.resize(compressedData.size() * 2);
+		strm.next_out = compressedData + totalCompressedBytes;
+		strm.avail_out = std::min(compressedData.size() -
+		    totalCompressedBytes, ZLIB_MAX_LENGTH);
+		const uint64_t availableBytes = strm.avail_out;
+
+		rv = deflate(&strm, (remainingBytes == 0) ? Z_FINISH :
+		    Z_NO_FLUSH);
+		if (rv == Z_STREAM_ERROR)
+			throw Error::StrategyError("Stream error "
+			    "during deflate");
+		totalCompressedBytes += (availableBytes - strm.avail_out);
+	} while (rv != Z_STREAM_END);
+
 	/* Resize output buffer's size parameter to match the actual size */
 	compressedData.resize(totalCompressedBytes);
 	return (compressedData);
@@ -120,10 +720,11 @@ BiometricEvaluation::IO::GZip::compress(
 	if (IO::Utility::fileExists(outputFile))
 		throw Error::ObjectExists(outputFile);
 
-	z_stream strm = this->initCompressionStream();
+	z_stream strm;
+	this->initCompressionStream(strm);
 		
 	uint8_t flush = Z_NO_FLUSH;
-	uint64_t chunk = this->getOptionAsInteger(CHUNK_SIZE);
+	uint64_t chunk = this->_streams->getOptions(*this).chunkSize;
 	uint64_t remainingBytes = uncompressedDataSize;
 	uint64_t totalCompressedBytes = 0;
 
@@ -202,10 +803,11 @@ BiometricEvaluation::IO::GZip::compress(
 	if (IO::Utility::fileExists(inputFile) == false)
 		throw Error::ObjectDoesNotExist(inputFile);
 
-	z_stream strm = this->initCompressionStream();
+	z_stream strm;
+	this->initCompressionStream(strm);
 		
 	uint8_t flush = Z_NO_FLUSH;
-	uint64_t chunk = this->getOptionAsInteger(CHUNK_SIZE);
+	uint64_t chunk = this->_streams->getOptions(*this).chunkSize;
 	uint64_t totalCompressedBytes = 0;
 	Memory::uint8Array compressedData(chunk);
 
@@ -262,10 +864,11 @@ BiometricEvaluation::IO::GZip::compress(
 	if (IO::Utility::fileExists(outputFile))
 		throw Error::ObjectExists(outputFile);
 
-	z_stream strm = this->initCompressionStream();
+	z_stream strm;
+	this->initCompressionStream(strm);
 		
 	uint8_t flush = Z_NO_FLUSH;
-	uint64_t chunk = this->getOptionAsInteger(CHUNK_SIZE);
+	uint64_t chunk = this->_streams->getOptions(*this).chunkSize;
 	uint64_t totalCompressedBytes = 0;
 	
 	/* Open input file */
@@ -326,26 +929,12 @@ BiometricEvaluation::IO::GZip::compress(
 		    "at stream end");
 }
 
-z_stream
-BiometricEvaluation::IO::GZip::initCompressionStream()
+void
+BiometricEvaluation::IO::GZip::initCompressionStream(
+    z_stream &strm)
     const
 {
-	z_stream strm;
-	
-	/* Must be set before initialization */
-	strm.zalloc = Z_NULL;
-	strm.zfree = Z_NULL;
-	strm.opaque = Z_NULL;
-
-	if (deflateInit2(&strm,
-	    this->getOptionAsInteger(COMPRESSION_LEVEL),
-	    this->getOptionAsInteger(COMPRESSION_METHOD), 
-	    this->getOptionAsInteger(WINDOW_BITS), 
-	    this->getOptionAsInteger(MEMORY_LEVEL),
-	    this->getOptionAsInteger(COMPRESSION_STRATEGY)) != Z_OK)
-		throw Error::StrategyError("Could not initialize stream");
-		
-	return (strm);
+	Streams::initDeflate(strm, this->_streams->getOptions(*this));
 }
 
 int32_t
@@ -405,41 +994,78 @@ BiometricEvaluation::IO::GZip::decompress(
     uint64_t compressedDataSize)
     const
 {
-	z_stream strm = this->initDecompressionStream();
-	
-	int32_t rv = 0;
-	uint64_t chunk = this->getOptionAsInteger(CHUNK_SIZE);
+	const Streams::Options options = this->_streams->getOptions(*this);
+	std::vector<GZipBlock> blocks;
+	if (findBlocks(compressedData, compressedDataSize, blocks)) {
+		Memory::uint8Array uncompressedData(
+		    blocks.back().uncompressedOffset +
+		    blocks.back().uncompressedSize);
+		decompressBlocks(compressedData, blocks, uncompressedData,
+		    options.threadCount);
+		return (uncompressedData);
+	}
+
+	Streams::Lease lease(*this->_streams, *this, false);
+	z_stream &strm = lease.get();
+
+	/*
+	 * The gzip trailer records the uncompressed size (modulo 2^32),
+	 * which, if plausible, sizes the output in one allocation.
+	 */
+	uint64_t initialSize = options.chunkSize;
+	if ((options.windowBits > MAX_WBITS) &&
+	    (compressedDataSize >= 4)) {
+		const uint8_t *trailer = compressedData +
+		    compressedDataSize - 4;
+		const uint64_t recordedSize = (uint64_t)trailer[0] |
+		    ((uint64_t)trailer[1] << 8) | ((uint64_t)trailer[2] << 16) |
+		    ((uint64_t)trailer[3] << 24);
+		if ((recordedSize > 0) && (recordedSize <=
+		    (compressedDataSize * DEFLATE_MAX_RATIO)))
+			initialSize = recordedSize;
+	}
+	Memory::uint8Array uncompressedData(std::max<uint64_t>(initialSize,
+	    1));
+
 	uint64_t remainingBytes = compressedDataSize;
 	uint64_t totalUncompressedBytes = 0;
-	Memory::uint8Array uncompressedData(chunk);
+	strm.next_in = (uint8_t *)compressedData;
+	strm.avail_in = 0;
+
+	int32_t rv;
 	do {
-		/* Move compressed pointer */
-		strm.next_in = (uint8_t *)(compressedData + 
-		    (compressedDataSize - remainingBytes));
-		
-		/* Update EOF */
-		if (chunk > remainingBytes) {
-			strm.avail_in = remainingBytes;
-			remainingBytes = 0;
-		} else {
-			strm.avail_in = chunk;
-			remainingBytes -= chunk;
+		if ((strm.avail_in == 0) && (remainingBytes > 0)) {
+			strm.avail_in = std::min(remainingBytes,
+			    ZLIB_MAX_LENGTH);
+			remainingBytes -= strm.avail_in;
 		}
-		
-		/* Perform decompression */
-		rv = this->decompressChunk(chunk, totalUncompressedBytes,
-		    uncompressedData, false, strm);
-		
-		/* Sanity check */
-		if (strm.avail_in != 0) {
-			inflateEnd(&strm);
-			throw Error::StrategyError("Compressed data remains "
-			    "after decompressing chunk");
+		if (totalUncompressedBytes == uncompressedData.size())
+			uncompressedData.resize(uncompressedData.size() * 2);
+		strm.next_out = uncompressedData + totalUncompressedBytes;
+		strm.avail_out = std::min(uncompressedData.size() -
+		    totalUncompressedBytes, ZLIB_MAX_LENGTH);
+		const uint64_t availableBytes = strm.avail_out;
+
+		rv = inflate(&strm, Z_NO_FLUSH);
+		checkInflateResult(rv);
+		totalUncompressedBytes += (availableBytes - strm.avail_out);
+
+		/* Output space was available, so input must have run out */
+		if ((rv == Z_BUF_ERROR) && (strm.avail_in == 0) &&
+		    (remainingBytes == 0))
+			throw Error::StrategyError("Compressed data ended "
+			    "before end of stream");
+
+		/* Concatenated gzip members are decompressed in turn */
+		if ((rv == Z_STREAM_END) && ((strm.avail_in != 0) ||
+		    (remainingBytes != 0))) {
+			if (inflateReset(&strm) != Z_OK)
+				throw Error::StrategyError("Could not reset "
+				    "stream");
+			rv = Z_OK;
 		}
-		
 	} while (rv != Z_STREAM_END);
-	inflateEnd(&strm);
-	
+
 	/* Resize output buffer's size parameter to match the actual size */
 	uncompressedData.resize(totalUncompressedBytes);
 	return (uncompressedData);
@@ -453,6 +1079,79 @@ BiometricEvaluation::IO::GZip::decompress(
 	return (this->decompress(compressedData, compressedData.size()));
 }
 
+void
+BiometricEvaluation::IO::GZip::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize,
+    uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize)
+    const
+{
+	std::vector<GZipBlock> blocks;
+	if (findBlocks(compressedData, compressedDataSize, blocks)) {
+		if ((blocks.back().uncompressedOffset +
+		    blocks.back().uncompressedSize) != uncompressedDataSize)
+			throw Error::StrategyError("Decompressed data is not "
+			    "the expected size");
+		decompressBlocks(compressedData, blocks, uncompressedData,
+		    this->_streams->getOptions(*this).threadCount);
+		return;
+	}
+
+	Streams::Lease lease(*this->_streams, *this, false);
+	z_stream &strm = lease.get();
+
+	/* zlib rejects a null output buffer, even when it is empty */
+	uint8_t emptyBuffer;
+	strm.next_out = ((uncompressedDataSize == 0) ? &emptyBuffer :
+	    uncompressedData);
+	strm.avail_out = 0;
+	strm.next_in = (uint8_t *)compressedData;
+	strm.avail_in = 0;
+	uint64_t remainingInBytes = compressedDataSize;
+	uint64_t remainingOutBytes = uncompressedDataSize;
+
+	int32_t rv;
+	do {
+		/* zlib lengths are 32 bits, so work in parts */
+		if ((strm.avail_in == 0) && (remainingInBytes > 0)) {
+			strm.avail_in = std::min(remainingInBytes,
+			    ZLIB_MAX_LENGTH);
+			remainingInBytes -= strm.avail_in;
+		}
+		if ((strm.avail_out == 0) && (remainingOutBytes > 0)) {
+			strm.avail_out = std::min(remainingOutBytes,
+			    ZLIB_MAX_LENGTH);
+			remainingOutBytes -= strm.avail_out;
+		}
+
+		rv = inflate(&strm, Z_NO_FLUSH);
+		checkInflateResult(rv);
+		if (rv == Z_BUF_ERROR) {
+			if ((strm.avail_in == 0) && (remainingInBytes == 0))
+				throw Error::StrategyError("Compressed data "
+				    "ended before end of stream");
+			if ((strm.avail_out == 0) && (remainingOutBytes == 0))
+				throw Error::StrategyError("Decompressed data "
+				    "is larger than expected");
+		}
+
+		/* Concatenated gzip members are decompressed in turn */
+		if ((rv == Z_STREAM_END) && ((strm.avail_in != 0) ||
+		    (remainingInBytes != 0))) {
+			if (inflateReset(&strm) != Z_OK)
+				throw Error::StrategyError("Could not reset "
+				    "stream");
+			rv = Z_OK;
+		}
+	} while (rv != Z_STREAM_END);
+
+	/* Sanity check */
+	if ((strm.avail_out != 0) || (remainingOutBytes != 0))
+		throw Error::StrategyError("Decompressed data is smaller "
+		    "than expected");
+}
+
 BiometricEvaluation::Memory::uint8Array
 BiometricEvaluation::IO::GZip::decompress(
     const std::string &inputFile)
@@ -461,10 +1160,11 @@ BiometricEvaluation::IO::GZip::decompress(
 	if (IO::Utility::fileExists(inputFile) == false)
 		throw Error::ObjectDoesNotExist(inputFile);
 		
-	z_stream strm = this->initDecompressionStream();
+	z_stream strm;
+	this->initDecompressionStream(strm);
 	
 	int32_t rv = 0;
-	uint64_t chunk = this->getOptionAsInteger(CHUNK_SIZE);
+	uint64_t chunk = this->_streams->getOptions(*this).chunkSize;
 	uint64_t totalUncompressedBytes = 0;
 	Memory::uint8Array uncompressedData(chunk);
 	Memory::uint8Array uncompressedChunk(chunk);
@@ -477,6 +1177,18 @@ BiometricEvaluation::IO::GZip::decompress(
 		strm.next_in = in;
 		strm.avail_in = fread(in, 1, chunk, fp);
 		
+		/* Another gzip member may follow the end of a stream */
+		if (rv == Z_STREAM_END) {
+			if (strm.avail_in == 0)
+				break;
+			inflateReset(&strm);
+		} else if (strm.avail_in == 0) {
+			inflateEnd(&strm);
+			fclose(fp);
+			throw Error::StrategyError("Compressed data ended "
+			    "before end of stream");
+		}
+
 		/* Perform decompression */
 		try {
 			rv = this->decompressChunk(chunk,
@@ -496,7 +1208,8 @@ BiometricEvaluation::IO::GZip::decompress(
 			    "after decompressing chunk");
 		}
 		
-	} while (rv != Z_STREAM_END);
+	} while ((rv != Z_STREAM_END) || !feof(fp));
+	fclose(fp);
 	inflateEnd(&strm);
 	
 	/* Resize output buffer's size parameter to match the actual size */
@@ -515,9 +1228,10 @@ BiometricEvaluation::IO::GZip::decompress(
 	if (IO::Utility::fileExists(outputFile))
 		throw Error::ObjectExists(outputFile);
 
-	z_stream strm = this->initDecompressionStream();
+	z_stream strm;
+	this->initDecompressionStream(strm);
 		
-	uint64_t chunk = this->getOptionAsInteger(CHUNK_SIZE);
+	uint64_t chunk = this->_streams->getOptions(*this).chunkSize;
 	uint64_t totalUncompressedBytes = 0;
 	
 	/* Open input file */
@@ -532,12 +1246,25 @@ BiometricEvaluation::IO::GZip::decompress(
 	if (ofp == nullptr)
 		throw Error::StrategyError("Could not create " + outputFile);
 
-	int32_t rv;
+	int32_t rv = Z_OK;
 	do {
 		/* Move compressed pointer */
 		strm.avail_in = fread(in, 1, chunk, ifp);
 		strm.next_in = in;
 		
+		/* Another gzip member may follow the end of a stream */
+		if (rv == Z_STREAM_END) {
+			if (strm.avail_in == 0)
+				break;
+			inflateReset(&strm);
+		} else if (strm.avail_in == 0) {
+			fclose(ifp);
+			fclose(ofp);
+			inflateEnd(&strm);
+			throw Error::StrategyError("Compressed data ended "
+			    "before end of stream");
+		}
+
 		/* Perform decompression */
 		try {
 			rv = this->decompressChunk(chunk,
@@ -566,7 +1293,7 @@ BiometricEvaluation::IO::GZip::decompress(
 			throw Error::StrategyError("Wrote invalid number of "
 			    "bytes after decompressing chunk");
 		}
-	} while (rv != Z_STREAM_END);
+	} while ((rv != Z_STREAM_END) || !feof(ifp));
 	fclose(ifp);
 	fclose(ofp);
 	inflateEnd(&strm);
@@ -587,9 +1314,10 @@ BiometricEvaluation::IO::GZip::decompress(
 	if (IO::Utility::fileExists(outputFile))
 		throw Error::ObjectExists(outputFile);
 
-	z_stream strm = this->initDecompressionStream();
+	z_stream strm;
+	this->initDecompressionStream(strm);
 		
-	uint64_t chunk = this->getOptionAsInteger(CHUNK_SIZE);
+	uint64_t chunk = this->_streams->getOptions(*this).chunkSize;
 	uint64_t remainingBytes = compressedDataSize;
 	uint64_t totalUncompressedBytes = 0;
 
@@ -599,7 +1327,7 @@ BiometricEvaluation::IO::GZip::decompress(
 	if (ofp == nullptr)
 		throw Error::StrategyError("Could not create " + outputFile);
 
-	int32_t rv;
+	int32_t rv = Z_OK;
 	do {
 		/* Move compressed pointer */
 		strm.next_in = (uint8_t *)(compressedData + 
@@ -614,6 +1342,16 @@ BiometricEvaluation::IO::GZip::decompress(
 			remainingBytes -= chunk;
 		}
 		
+		/* Another gzip member may follow the end of a stream */
+		if (rv == Z_STREAM_END) {
+			inflateReset(&strm);
+		} else if (strm.avail_in == 0) {
+			fclose(ofp);
+			inflateEnd(&strm);
+			throw Error::StrategyError("Compressed data ended "
+			    "before end of stream");
+		}
+
 		/* Perform decompression */
 		try {
 			rv = this->decompressChunk(chunk,
@@ -640,7 +1378,7 @@ BiometricEvaluation::IO::GZip::decompress(
 			throw Error::StrategyError("Wrote invalid number of "
 			    "bytes after decompressing chunk");
 		}
-	} while (rv != Z_STREAM_END);
+	} while ((rv != Z_STREAM_END) || (remainingBytes > 0));
 	fclose(ofp);
 	inflateEnd(&strm);
 	
@@ -659,24 +1397,12 @@ BiometricEvaluation::IO::GZip::decompress(
 	this->decompress(compressedData, compressedData.size(), outputFile);
 }
 
-z_stream
-BiometricEvaluation::IO::GZip::initDecompressionStream()
+void
+BiometricEvaluation::IO::GZip::initDecompressionStream(
+    z_stream &strm)
     const
 {
-	z_stream strm;
-	
-	/* Must be set before initialization */
-	strm.zalloc = Z_NULL;
-	strm.zfree = Z_NULL;
-	strm.opaque = Z_NULL;
-	strm.avail_in = 0;
-	strm.next_in = Z_NULL;
-	
-	if (inflateInit2(&strm, this->getOptionAsInteger(WINDOW_BITS)) !=
-	    Z_OK)
-		throw Error::StrategyError("Could not initialize stream");
-		
-	return (strm);
+	Streams::initInflate(strm, this->_streams->getOptions(*this));
 }
 
 int32_t
@@ -689,6 +1415,7 @@ BiometricEvaluation::IO::GZip::decompressChunk(
     const
 {
 	int32_t rv;
+	bool nextMember;
 	
 	uint64_t offset = 0;
 	do {
@@ -734,7 +1461,14 @@ BiometricEvaluation::IO::GZip::decompressChunk(
 		
 		offset += (chunkSize - strm.avail_out);
 		totalUncompressedBytes += (chunkSize - strm.avail_out);
-	} while (strm.avail_out == 0);
+
+		/* Concatenated gzip members are decompressed in turn */
+		nextMember = ((rv == Z_STREAM_END) && (strm.avail_in != 0));
+		if (nextMember && (inflateReset(&strm) != Z_OK)) {
+			inflateEnd(&strm);
+			throw Error::StrategyError("Could not reset stream");
+		}
+	} while ((strm.avail_out == 0) || nextMember);
 
 	if (uncompressedBufIsChunk)
 		uncompressedBuf.resize(offset);
@@ -742,6 +1476,13 @@ BiometricEvaluation::IO::GZip::decompressChunk(
 	return (rv);
 }
 
+void
+BiometricEvaluation::IO::GZip::optionChanged(
+    const std::string &optionName)
+{
+	this->_streams->refresh(*this);
+}
+
 BiometricEvaluation::IO::GZip::~GZip()
 {
 
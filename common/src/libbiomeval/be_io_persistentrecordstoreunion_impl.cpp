@@ -51,7 +51,7 @@ BiometricEvaluation::IO::PersistentRecordStoreUnion::Impl::Impl(
     RecordStoreUnion::Impl(getRecordStoresFromPropertiesFile(
     Impl::getControlFilePath(path)))
 {
-
+	this->loadKeyFilters(path);
 }
 
 BiometricEvaluation::IO::PersistentRecordStoreUnion::Impl::Impl(
@@ -75,6 +75,55 @@ BiometricEvaluation::IO::PersistentRecordStoreUnion::Impl::Impl(
 			/* Relative to union */
 			props->setProperty(r.first, "../" + r.second);
 	}
+
+	this->buildKeyFilters();
+	this->writeKeyFilters(Impl::getKeyFilterFilePath(path));
+}
+
+void
+BiometricEvaluation::IO::PersistentRecordStoreUnion::Impl::loadKeyFilters(
+    const std::string &unionPath)
+{
+	const std::string filterPath = Impl::getKeyFilterFilePath(unionPath);
+	std::map<const std::string, std::shared_ptr<KeyFilter>> saved;
+	try {
+		saved = Impl::readKeyFilters(filterPath);
+	} catch (const BE::Error::Exception &) {
+		/* Missing or damaged; rebuild everything */
+	}
+
+	/* Members modified after saving no longer match their fingerprint */
+	bool rebuilt = false;
+	for (const auto &name : this->getNames()) {
+		const auto filter = saved.find(name);
+		if ((filter != saved.cend()) &&
+		    (filter->second->getFingerprint() != 0) &&
+		    (filter->second->getFingerprint() ==
+		    this->getMemberFingerprint(name))) {
+			this->setKeyFilter(name, filter->second);
+		} else {
+			this->setKeyFilter(name, this->buildKeyFilter(name));
+			rebuilt = true;
+		}
+	}
+
+	if (rebuilt) {
+		try {
+			this->writeKeyFilters(filterPath);
+		} catch (const BE::Error::Exception &) {
+			/* Union may be read-only; rebuild next time */
+		}
+	}
+}
+
+const std::string BE::IO::PersistentRecordStoreUnion::Impl::KEYFILTERFILENAME(
+    ".rsukeyfilters");
+
+std::string
+BiometricEvaluation::IO::PersistentRecordStoreUnion::Impl::getKeyFilterFilePath(
+    const std::string &unionPath)
+{
+	return {unionPath + '/' + Impl::KEYFILTERFILENAME};
 }
 
 std::string
@@ -63,8 +63,42 @@ namespace BiometricEvaluation
 			getControlFilePath(
 			    const std::string &unionPath);
 
+			/**
+			 * @brief
+			 * Obtain path to saved KeyFilters.
+			 *
+			 * @param unionPath
+			 * Path to PersistentRecordStoreUnion.
+			 *
+			 * @return
+			 * Path to PersistentRecordStoreUnion KeyFilter file.
+			 */
+			static std::string
+			getKeyFilterFilePath(
+			    const std::string &unionPath);
+
+			/** Name of the file holding saved KeyFilters */
+			static const std::string KEYFILTERFILENAME;
+
 			/** Destructor */
 			~Impl() = default;
+
+		private:
+			/**
+			 * @brief
+			 * Use saved KeyFilters, rebuilding those that are
+			 * missing or out of date.
+			 *
+			 * @param unionPath
+			 * Path to PersistentRecordStoreUnion.
+			 *
+			 * @note
+			 * Rebuilt filters are saved when unionPath is
+			 * writable.
+			 */
+			void
+			loadKeyFilters(
+			    const std::string &unionPath);
 		};
 	}
 }
@@ -39,7 +39,8 @@ BE_IO_RecordStore_Kind_EnumToStringMap = {
 	{BiometricEvaluation::IO::RecordStore::Kind::File, "File"},
 	{BiometricEvaluation::IO::RecordStore::Kind::SQLite, "SQLite"},
 	{BiometricEvaluation::IO::RecordStore::Kind::Compressed, "Compressed"},
-	{BiometricEvaluation::IO::RecordStore::Kind::List, "List"}
+	{BiometricEvaluation::IO::RecordStore::Kind::List, "List"},
+	{BiometricEvaluation::IO::RecordStore::Kind::Sharded, "Sharded"}
 };
 BE_FRAMEWORK_ENUMERATION_DEFINITIONS(
     BiometricEvaluation::IO::RecordStore::Kind,
@@ -59,6 +60,14 @@ BiometricEvaluation::IO::RecordStore::insert(
 	this->insert(key, data, data.size());
 }
 
+void
+BiometricEvaluation::IO::RecordStore::insert(
+    const std::string &key,
+    Memory::ByteView data)
+{
+	this->insert(key, data.data(), data.size());
+}
+
 void
 BiometricEvaluation::IO::RecordStore::replace(
     const std::string &key,
@@ -77,6 +86,14 @@ BiometricEvaluation::IO::RecordStore::replace(
 	this->insert(key, data, size);
 }
 
+void
+BiometricEvaluation::IO::RecordStore::replace(
+    const std::string &key,
+    Memory::ByteView data)
+{
+	this->replace(key, data.data(), data.size());
+}
+
 bool
 BiometricEvaluation::IO::RecordStore::containsKey(
     const std::string &key) const
@@ -90,12 +107,34 @@ BiometricEvaluation::IO::RecordStore::containsKey(
 	return (true);
 }
 
+std::string
+BiometricEvaluation::IO::RecordStore::nextKey(
+    const std::string &key)
+{
+	if (key.empty())
+		return (this->sequenceKey(BE_RECSTORE_SEQ_START));
+
+	/* The first key sequenced after setCursorAtKey() is key itself */
+	this->setCursorAtKey(key);
+	this->sequenceKey();
+	return (this->sequenceKey());
+}
+
+BiometricEvaluation::IO::RecordStore::Concurrency
+BiometricEvaluation::IO::RecordStore::getConcurrency()
+    const
+{
+	return (Concurrency::Exclusive);
+}
+
 std::shared_ptr<BiometricEvaluation::IO::RecordStore>
 BiometricEvaluation::IO::RecordStore::openRecordStore(
     const std::string &pathname,
-    IO::Mode mode)
+    IO::Mode mode,
+    Concurrency concurrency)
 {
-	return (IO::RecordStore::Impl::openRecordStore(pathname, mode));
+	return (IO::RecordStore::Impl::openRecordStore(pathname, mode,
+	    concurrency));
 }
 
 
@@ -103,10 +142,11 @@ std::shared_ptr<BiometricEvaluation::IO::RecordStore>
 BiometricEvaluation::IO::RecordStore::createRecordStore(
     const std::string &pathname,
     const std::string &description,
-    const RecordStore::Kind &kind)
+    const RecordStore::Kind &kind,
+    Concurrency concurrency)
 {
 	return (IO::RecordStore::Impl::createRecordStore(
-	    pathname, description, kind));
+	    pathname, description, kind, concurrency));
 }
 
 void 
@@ -214,14 +254,6 @@ BiometricEvaluation::IO::RecordStoreIterator::operator==(
 void
 BiometricEvaluation::IO::RecordStoreIterator::setBegin()
 {
-	try {
-		std::string key = this->_recordStore->sequenceKey(
-		     RecordStore::BE_RECSTORE_SEQ_START);
-		this->_recordStore->setCursorAtKey(key);
-	} catch (Error::ObjectDoesNotExist) {
-		this->setEnd();
-	}
-
 	this->step(1);
 }
 
@@ -230,32 +262,29 @@ BiometricEvaluation::IO::RecordStoreIterator::step(
     BiometricEvaluation::IO::RecordStoreIterator::difference_type numSteps)
 {
 	/* Backwards */
-	if (numSteps <= 0)
+	if ((numSteps <= 0) || (this->_recordStore == nullptr))
 		return;
 
-	/* Forward one step */
-	if (numSteps == 1) {
+	/* The key of the current record is this iterator's cursor */
+	std::string key = this->_currentRecord.key;
+	Memory::uint8Array data;
+	for (;;) {
 		try {
-			this->_currentRecord = this->_recordStore->sequence();
+			for (difference_type i = 0; i < numSteps; i++)
+				key = this->_recordStore->nextKey(key);
 		} catch (Error::ObjectDoesNotExist) {
 			this->setEnd();
+			return;
 		}
-		return;
-	}
 
-	/* Forward 2..n steps */
-	std::string key;
-	for (difference_type i = 0; i < numSteps; i++) {
+		/* Another thread may remove the record before it is read */
 		try {
-			key = this->_recordStore->sequenceKey();
+			data = this->_recordStore->read(key);
+			break;
 		} catch (Error::ObjectDoesNotExist) {
-			this->setEnd();
-			return;
+			numSteps = 1;
 		}
 	}
-
-	Memory::uint8Array data;
-	data = this->_recordStore->read(key);
 	this->_currentRecord = RecordStore::Record(key, data);
 }
 
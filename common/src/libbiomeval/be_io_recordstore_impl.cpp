@@ -29,6 +29,7 @@
 #include <be_io_filerecstore.h>
 #include <be_io_listrecstore.h>
 #include <be_io_propertiesfile.h>
+#include <be_io_shardedrecstore.h>
 #include <be_io_sqliterecstore.h>
 #include <be_io_utility.h>
 #include <be_memory_autoarray.h>
@@ -58,11 +59,15 @@ const std::string BiometricEvaluation::IO::RecordStore::Impl::RSREADONLYERROR(
 BiometricEvaluation::IO::RecordStore::Impl::Impl(
     const std::string &pathname,
     const std::string &description,
-    const BE::IO::RecordStore::Kind &kind) :
+    const BE::IO::RecordStore::Kind &kind,
+    RecordStore::Concurrency concurrency) :
+    _count(0),
+    _concurrency(concurrency),
     _pathname(pathname),
     _cursor(RecordStore::BE_RECSTORE_SEQ_START),
     _mode(IO::Mode::ReadWrite)
 {
+	this->initLock();
 	if (IO::Utility::fileExists(pathname))
 		throw Error::ObjectExists(pathname + " already exists");
 
@@ -87,11 +92,15 @@ BiometricEvaluation::IO::RecordStore::Impl::Impl(
 
 BiometricEvaluation::IO::RecordStore::Impl::Impl(
     const std::string &pathname,
-    IO::Mode mode) :
+    IO::Mode mode,
+    RecordStore::Concurrency concurrency) :
+    _count(0),
+    _concurrency(concurrency),
     _pathname(pathname),
     _cursor(RecordStore::BE_RECSTORE_SEQ_START),
     _mode(mode)
 {
+	this->initLock();
 	if (!IO::Utility::fileExists(pathname))
 		throw Error::ObjectDoesNotExist("Could not find " + pathname);
 
@@ -109,7 +118,71 @@ BiometricEvaluation::IO::RecordStore::Impl::Impl(
 /*
  * Destructor for the abstract class; required empty implementaton.
  */
-BiometricEvaluation::IO::RecordStore::Impl::~Impl() { }
+BiometricEvaluation::IO::RecordStore::Impl::~Impl()
+{
+	pthread_rwlock_destroy(&this->_rwlock);
+}
+
+/******************************************************************************/
+/* Locking.                                                                   */
+/******************************************************************************/
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::initLock()
+{
+	pthread_rwlockattr_t attr;
+	pthread_rwlockattr_init(&attr);
+#ifdef __GLIBC__
+	/* Don't starve the writer when readers overlap continuously */
+	pthread_rwlockattr_setkind_np(&attr,
+	    PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+	const int rv = pthread_rwlock_init(&this->_rwlock, &attr);
+	pthread_rwlockattr_destroy(&attr);
+	if (rv != 0)
+		throw Error::StrategyError("Could not initialize lock");
+}
+
+BiometricEvaluation::IO::RecordStore::Concurrency
+BiometricEvaluation::IO::RecordStore::Impl::getConcurrency()
+    const
+{
+	return (this->_concurrency);
+}
+
+BiometricEvaluation::IO::RecordStore::Impl::ReaderLock::ReaderLock(
+    const RecordStore::Impl &impl) :
+    _lock(nullptr)
+{
+	if (impl._concurrency != RecordStore::Concurrency::Shared)
+		return;
+	if (pthread_rwlock_rdlock(&impl._rwlock) != 0)
+		throw Error::StrategyError("Could not lock RecordStore");
+	this->_lock = &impl._rwlock;
+}
+
+BiometricEvaluation::IO::RecordStore::Impl::ReaderLock::~ReaderLock()
+{
+	if (this->_lock != nullptr)
+		pthread_rwlock_unlock(this->_lock);
+}
+
+BiometricEvaluation::IO::RecordStore::Impl::WriterLock::WriterLock(
+    const RecordStore::Impl &impl) :
+    _lock(nullptr)
+{
+	if (impl._concurrency != RecordStore::Concurrency::Shared)
+		return;
+	if (pthread_rwlock_wrlock(&impl._rwlock) != 0)
+		throw Error::StrategyError("Could not lock RecordStore");
+	this->_lock = &impl._rwlock;
+}
+
+BiometricEvaluation::IO::RecordStore::Impl::WriterLock::~WriterLock()
+{
+	if (this->_lock != nullptr)
+		pthread_rwlock_unlock(this->_lock);
+}
 
 /******************************************************************************/
 /* Common public methods implementations.                                     */
@@ -128,14 +201,16 @@ BiometricEvaluation::IO::RecordStore::Impl::insert(
     const void *const data,
     const uint64_t size)
 {
-	_props->setPropertyFromInteger(COUNTPROPERTY, this->getCount() + 1);
+	std::lock_guard<std::mutex> lock(this->_propsMutex);
+	_props->setPropertyFromInteger(COUNTPROPERTY, ++this->_count);
 }
 
 void
 BiometricEvaluation::IO::RecordStore::Impl::remove(
     const std::string &key)
 {
-	_props->setPropertyFromInteger(COUNTPROPERTY, this->getCount() - 1);
+	std::lock_guard<std::mutex> lock(this->_propsMutex);
+	_props->setPropertyFromInteger(COUNTPROPERTY, --this->_count);
 }
 
 int
@@ -166,6 +241,7 @@ BiometricEvaluation::IO::RecordStore::Impl::sync() const
 	if (_mode == Mode::ReadOnly)
 		return;
 
+	std::lock_guard<std::mutex> lock(this->_propsMutex);
 	try {
 		_props->sync();
 	} catch (Error::Exception& e) {
@@ -176,7 +252,7 @@ BiometricEvaluation::IO::RecordStore::Impl::sync() const
 unsigned int
 BiometricEvaluation::IO::RecordStore::Impl::getCount() const
 {
-	return (_props->getPropertyAsInteger(COUNTPROPERTY));
+	return (this->_count);
 }
 
 std::string
@@ -188,6 +264,7 @@ BiometricEvaluation::IO::RecordStore::Impl::getPathname() const
 std::string
 BiometricEvaluation::IO::RecordStore::Impl::getDescription() const
 {
+	std::lock_guard<std::mutex> lock(this->_propsMutex);
 	return (_props->getProperty(DESCRIPTIONPROPERTY));
 }
 
@@ -201,6 +278,7 @@ BiometricEvaluation::IO::RecordStore::Impl::move(const std::string &pathname)
 		throw Error::ObjectExists(pathname);
 
 	/* Sync the old data first */
+	std::lock_guard<std::mutex> lock(this->_propsMutex);
 	_props->sync();
 	_props.reset();
 
@@ -221,6 +299,7 @@ BiometricEvaluation::IO::RecordStore::Impl::changeDescription(
 	if (_mode == Mode::ReadOnly)
 		throw Error::StrategyError(RSREADONLYERROR);
 
+	std::lock_guard<std::mutex> lock(this->_propsMutex);
 	_props->setProperty(DESCRIPTIONPROPERTY, description);
 	_props->sync();
 }
@@ -228,7 +307,8 @@ BiometricEvaluation::IO::RecordStore::Impl::changeDescription(
 std::shared_ptr<BiometricEvaluation::IO::RecordStore>
 BiometricEvaluation::IO::RecordStore::Impl::openRecordStore(
     const std::string &pathname,
-    IO::Mode mode)
+    IO::Mode mode,
+    RecordStore::Concurrency concurrency)
 {
 	if (!IO::Utility::fileExists(pathname))
 		throw Error::ObjectDoesNotExist("Could not find " + pathname);
@@ -257,14 +337,19 @@ BiometricEvaluation::IO::RecordStore::Impl::openRecordStore(
 
 	RecordStore *rs;
 	/* Exceptions thrown by constructors are allowed to float out */
-	if (type == to_string(RecordStore::Kind::BerkeleyDB))
-		rs = new DBRecordStore(pathname, mode);
-	else if (type == to_string(RecordStore::Kind::SQLite))
-		rs = new SQLiteRecordStore(pathname, mode);
+	if (type == to_string(RecordStore::Kind::SQLite))
+		rs = new SQLiteRecordStore(pathname, mode, concurrency);
 	else if (type == to_string(RecordStore::Kind::File))
-		rs = new FileRecordStore(pathname, mode);
+		rs = new FileRecordStore(pathname, mode, concurrency);
 	else if (type == to_string(RecordStore::Kind::Archive))
-		rs = new ArchiveRecordStore(pathname, mode);
+		rs = new ArchiveRecordStore(pathname, mode, concurrency);
+	else if (type == to_string(RecordStore::Kind::Sharded))
+		rs = new ShardedRecordStore(pathname, mode, concurrency);
+	else if (concurrency != RecordStore::Concurrency::Exclusive)
+		throw Error::StrategyError(type + " RecordStores cannot be "
+		    "shared by threads");
+	else if (type == to_string(RecordStore::Kind::BerkeleyDB))
+		rs = new DBRecordStore(pathname, mode);
 	else if (type == to_string(RecordStore::Kind::Compressed))
 		rs = new CompressedRecordStore(pathname, mode);
 	else if (type == to_string(RecordStore::Kind::List)) {
@@ -282,8 +367,23 @@ std::shared_ptr<BiometricEvaluation::IO::RecordStore>
 BiometricEvaluation::IO::RecordStore::Impl::createRecordStore(
     const std::string &pathname,
     const std::string &description,
-    const RecordStore::Kind &kind)
+    const RecordStore::Kind &kind,
+    RecordStore::Concurrency concurrency)
 {
+	/* As when opening, sharded stores leave the check to shards */
+	switch (kind) {
+	case BE::IO::RecordStore::Kind::SQLite:
+	case BE::IO::RecordStore::Kind::File:
+	case BE::IO::RecordStore::Kind::Archive:
+	case BE::IO::RecordStore::Kind::Sharded:
+		break;
+	default:
+		if (concurrency != RecordStore::Concurrency::Exclusive)
+			throw Error::StrategyError(to_string(kind) +
+			    " RecordStores cannot be shared by threads");
+		break;
+	}
+
 	RecordStore *rs;
 	/* Exceptions thrown by constructors are allowed to float out */
 	switch (kind) {
@@ -291,13 +391,15 @@ BiometricEvaluation::IO::RecordStore::Impl::createRecordStore(
 		rs = new DBRecordStore(pathname, description);
 		break;
 	case BE::IO::RecordStore::Kind::SQLite:
-		rs = new SQLiteRecordStore(pathname, description);
+		rs = new SQLiteRecordStore(pathname, description,
+		    concurrency);
 		break;
 	case BE::IO::RecordStore::Kind::File:
-		rs = new FileRecordStore(pathname, description);
+		rs = new FileRecordStore(pathname, description, concurrency);
 		break;
 	case BE::IO::RecordStore::Kind::Archive:
-		rs = new ArchiveRecordStore(pathname, description);
+		rs = new ArchiveRecordStore(pathname, description,
+		    concurrency);
 		break;
 	case BE::IO::RecordStore::Kind::Compressed:
 		rs = new CompressedRecordStore(pathname, description,
@@ -306,6 +408,11 @@ BiometricEvaluation::IO::RecordStore::Impl::createRecordStore(
 	case BE::IO::RecordStore::Kind::List:
 		throw Error::StrategyError("ListRecordStores cannot be "
 		    "created with this function");
+	case BE::IO::RecordStore::Kind::Sharded:
+		rs = new ShardedRecordStore(pathname, description,
+		    RecordStore::Kind::Default,
+		    ShardedRecordStore::DEFAULT_SHARD_COUNT, {}, concurrency);
+		break;
 	}
 	return (std::shared_ptr<RecordStore>(rs));
 }
@@ -315,12 +422,24 @@ BiometricEvaluation::IO::RecordStore::Impl::removeRecordStore(
     const std::string &pathname)
 {
 	/* Confirm that pathname is a RecordStore */
+	std::shared_ptr<RecordStore> rs;
 	try {   
-		openRecordStore(pathname);
+		rs = openRecordStore(pathname);
 	} catch (Error::Exception &e) {
 		throw;
 	}
 
+	/* Shards may be located outside of the store */
+	std::vector<std::string> shardPathnames;
+	const std::shared_ptr<ShardedRecordStore> sharded =
+	    std::dynamic_pointer_cast<ShardedRecordStore>(rs);
+	if (sharded)
+		for (uint32_t i = 0; i < sharded->getShardCount(); i++)
+			shardPathnames.push_back(sharded->getShardPathname(i));
+	rs.reset();
+	for (const auto &shardPathname : shardPathnames)
+		removeRecordStore(shardPathname);
+
 	try {
 		IO::Utility::removeDirectory(pathname);
 	} catch (Error::ObjectDoesNotExist &e) {
@@ -346,6 +465,8 @@ BiometricEvaluation::IO::RecordStore::Impl::mergeRecordStores(
 		case BiometricEvaluation::IO::RecordStore::Kind::File:
 			/* FALLTHROUGH */
 		case BiometricEvaluation::IO::RecordStore::Kind::SQLite:
+			/* FALLTHROUGH */
+		case BiometricEvaluation::IO::RecordStore::Kind::Sharded:
 			merged_rs = RecordStore::createRecordStore(
 			   mergePathname, description, kind);
 			break;
@@ -422,6 +543,7 @@ std::shared_ptr<BiometricEvaluation::IO::Properties>
 BiometricEvaluation::IO::RecordStore::Impl::getProperties() const
 {
 	std::shared_ptr<IO::Properties> exportProps(new IO::Properties());
+	std::lock_guard<std::mutex> lock(this->_propsMutex);
 	
 	/* Export all except core properties */
 	std::vector<std::string> keys = this->_props->getPropertyKeys();
@@ -442,6 +564,7 @@ BiometricEvaluation::IO::RecordStore::Impl::setProperties(
 		throw Error::StrategyError(RSREADONLYERROR);
 	
 	/* Merge new properties */
+	std::lock_guard<std::mutex> lock(this->_propsMutex);
 	std::vector<std::string> keys = importProps->getPropertyKeys();
 	for (auto k = keys.begin(); k != keys.end(); ++k) {
 		if (isKeyCoreProperty(*k) == false)
@@ -509,7 +632,7 @@ BiometricEvaluation::IO::RecordStore::Impl::validateControlFile()
                 throw Error::StrategyError("Type property is missing");
         }
 	try {
-		_props->getPropertyAsInteger(COUNTPROPERTY);
+		_count = _props->getPropertyAsInteger(COUNTPROPERTY);
         } catch (Error::ObjectDoesNotExist& e) {
                 throw Error::StrategyError("Count property is missing");
         }
@@ -10,7 +10,11 @@
 #ifndef __BE_IO_RECORDSTORE_IMPL_H__
 #define __BE_IO_RECORDSTORE_IMPL_H__
 
+#include <pthread.h>
+
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -163,17 +167,23 @@ namespace BiometricEvaluation {
 			 * @param[in] mode
 			 *	The type of access a client of this 
 			 *	RecordStore has.
+			 * @param[in] concurrency
+			 *	Whether the returned object may be shared
+			 *	by threads.
 			 * @return
 			 *	An object representing the existing store.
 			 * @throw Error::ObjectDoesNotExist
 			 *	The RecordStore does not exist.
 			 * @throw Error::StrategyError
 			 *	An error occurred when using the underlying
-			 *	storage system.
+			 *	storage system, or the kind of RecordStore
+			 *	does not support concurrency.
 			 */
 			static std::shared_ptr<RecordStore> openRecordStore(
 			    const std::string &pathname,
-			    IO::Mode mode = Mode::ReadOnly);
+			    IO::Mode mode = Mode::ReadOnly,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
 
 			/**
 			 * @brief
@@ -190,6 +200,9 @@ namespace BiometricEvaluation {
 			 *	The description of the store to be created.
 			 * @param[in] kind
 			 *	The kind of RecordStore to be created.
+			 * @param[in] concurrency
+			 *	Whether the returned object may be shared
+			 *	by threads.
 			 * @return
 			 *	An managed pointer to the object representing
 			 *	the created store.
@@ -197,12 +210,15 @@ namespace BiometricEvaluation {
 			 *	The RecordStore does not exist.
 			 * @throw Error::StrategyError
 			 *	An error occurred when using the underlying
-			 *	storage system.
+			 *	storage system, or kind does not support
+			 *	concurrency.
 			 */
 			static std::shared_ptr<RecordStore> createRecordStore(
 			    const std::string &pathname,
 			    const std::string &description,
-			    const IO::RecordStore::Kind &kind);
+			    const IO::RecordStore::Kind &kind,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
 
 			/**
 			 * Remove a RecordStore by deleting all persistant
@@ -258,6 +274,9 @@ namespace BiometricEvaluation {
 			 *	The text used to describe the store.
 			 * @param[in] kind
 			 *	The kind of RecordStore.
+			 * @param[in] concurrency
+			 *	Whether the RecordStore may be shared by
+			 *	threads.
 			 * @throw Error::ObjectExists
 			 *	The store was previously created, or the
 			 *	directory where it would be created exists.
@@ -268,7 +287,9 @@ namespace BiometricEvaluation {
 			Impl(
 			    const std::string &pathname,
 			    const std::string &description,
-			    const IO::RecordStore::Kind &kind);
+			    const IO::RecordStore::Kind &kind,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
 
 			/**
 			 * Constructor to open an existing RecordStore.
@@ -278,6 +299,9 @@ namespace BiometricEvaluation {
 			 * @param[in] mode
 			 *	The type of access a client of this 
 			 *	RecordStore has.
+			 * @param[in] concurrency
+			 *	Whether the RecordStore may be shared by
+			 *	threads.
 			 * @throw Error::ObjectDoesNotExist
 			 *	The RecordStore does not exist.
 			 * @throw Error::StrategyError
@@ -286,9 +310,64 @@ namespace BiometricEvaluation {
 			 */
 			Impl(
 			    const std::string &pathname,
-			    IO::Mode mode = Mode::ReadOnly);
+			    IO::Mode mode = Mode::ReadOnly,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
+
+			/** @return Whether the RecordStore may be shared */
+			RecordStore::Concurrency
+			getConcurrency()
+			    const;
 
 		protected:
+			/**
+			 * @brief
+			 * Shared hold of the RecordStore's reader/writer
+			 * lock for the lifetime of the object.
+			 * @details
+			 * The lock is only taken when the RecordStore was
+			 * opened with Concurrency::Shared.  The lock is not
+			 * recursive, so subclasses take it once, on entry
+			 * to their public methods.
+			 */
+			class ReaderLock
+			{
+			public:
+				ReaderLock(
+				    const RecordStore::Impl &impl);
+				~ReaderLock();
+
+				ReaderLock(const ReaderLock&) = delete;
+				ReaderLock& operator=(
+				    const ReaderLock&) = delete;
+			private:
+				/** Lock held, or nullptr */
+				pthread_rwlock_t *_lock;
+			};
+
+			/**
+			 * @brief
+			 * Exclusive hold of the RecordStore's reader/writer
+			 * lock for the lifetime of the object.
+			 * @details
+			 * The lock is only taken when the RecordStore was
+			 * opened with Concurrency::Shared.
+			 */
+			class WriterLock
+			{
+			public:
+				WriterLock(
+				    const RecordStore::Impl &impl);
+				~WriterLock();
+
+				WriterLock(const WriterLock&) = delete;
+				WriterLock& operator=(
+				    const WriterLock&) = delete;
+			private:
+				/** Lock held, or nullptr */
+				pthread_rwlock_t *_lock;
+			};
+
 			/** Character used to separate key segments */
 			static const char KEY_SEGMENT_SEPARATOR = '&';
 			/** First segment number of a segmented record */
@@ -363,6 +442,15 @@ namespace BiometricEvaluation {
 		private:
 			/** Properties of the RecordStore */
 			std::shared_ptr<IO::PropertiesFile> _props;
+			/** Serializes access to _props */
+			mutable std::mutex _propsMutex;
+			/** Cached value of the count property */
+			std::atomic<unsigned int> _count;
+
+			/** Whether the RecordStore may be shared by threads */
+			RecordStore::Concurrency _concurrency;
+			/** Lock held by ReaderLock and WriterLock */
+			mutable pthread_rwlock_t _rwlock;
 			
 			/*
 			 * The directory where the store is contained.
@@ -395,6 +483,16 @@ namespace BiometricEvaluation {
 			void
 			validateControlFile();
 
+			/**
+			 * @brief
+			 * Initialize _rwlock.
+			 *
+			 * @throw Error::StrategyError
+			 *	Could not initialize the lock.
+			 */
+			void
+			initLock();
+
 			/**
 			 * @brief
 			 * Open/create the PropertiesFile for this RecordStore.
@@ -105,6 +105,20 @@ BiometricEvaluation::IO::RecordStoreUnion::length(
 	return (this->pimpl->length(key));
 }
 
+std::map<const std::string, BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::RecordStoreUnion::tryRead(
+    const std::string &key)
+    const
+{
+	return (this->pimpl->tryRead(key));
+}
+
+void
+BiometricEvaluation::IO::RecordStoreUnion::buildKeyFilters()
+{
+	this->pimpl->buildKeyFilters();
+}
+
 void
 BiometricEvaluation::IO::RecordStoreUnion::setImpl(
     const std::shared_ptr<RecordStoreUnion::Impl> &pimpl)
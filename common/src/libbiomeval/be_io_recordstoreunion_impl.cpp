@@ -8,12 +8,30 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <future>
+#include <set>
+#include <system_error>
+#include <thread>
+
+#include <cstdio>
+#include <fstream>
+
+#include <be_error.h>
 #include <be_io_recordstore.h>
+#include <be_io_utility.h>
 
+#include "be_io_recordstore_impl.h"
 #include "be_io_recordstoreunion_impl.h"
 
 namespace BE = BiometricEvaluation;
 
+/*
+ * Most candidates to query serially. Starting a thread costs more than
+ * the reads it would overlap when the key filters leave few candidates.
+ */
+static const size_t MaximumSerialCandidates{3};
+
 BiometricEvaluation::IO::RecordStoreUnion::Impl::Impl(
     const std::map<const std::string, const std::string> &recordStores) :
     _recordStores(initRecordStoreMap(recordStores))
@@ -120,31 +138,109 @@ BiometricEvaluation::IO::RecordStoreUnion::Impl::getNames()
  * Operations.
  */
 
-std::map<const std::string, BiometricEvaluation::Memory::uint8Array>
-BiometricEvaluation::IO::RecordStoreUnion::Impl::read(
-    const std::string &key)
+template<typename T>
+std::map<const std::string, T>
+BiometricEvaluation::IO::RecordStoreUnion::Impl::lookup(
+    const std::string &key,
+    const std::function<T(BiometricEvaluation::IO::RecordStore&)> &op)
     const
 {
-	std::string exceptions;
-	std::map<const std::string,
-	    BiometricEvaluation::Memory::uint8Array> ret;
-
-	for (const auto &rsPair : this->_recordStores) {
+	struct Result
+	{
+		bool found{false};
+		T value{};
+		std::string error{};
+	};
+	const auto doLookup = [&key, &op](const std::pair<std::string,
+	    std::shared_ptr<BE::IO::RecordStore>> &rs) -> Result {
+		Result result;
 		try {
-			ret.emplace(std::make_pair(rsPair.first,
-			    rsPair.second->read(key)));
-		} catch (BE::Error::ObjectDoesNotExist) {
+			result.value = op(*rs.second);
+			result.found = true;
+		} catch (const BE::Error::ObjectDoesNotExist &) {
 			/* Swallow */
-		} catch (BE::Error::Exception &e) {
+		} catch (const BE::Error::Exception &e) {
+			result.error = e.whatString() + " (" + rs.first + ')';
+		}
+		return (result);
+	};
+
+	const auto candidates = this->getCandidates(key);
+	std::vector<Result> results(candidates.size());
+
+	/*
+	 * Query many candidates concurrently, with no more threads than
+	 * cores, each taking every stride-th candidate. This thread takes
+	 * the first stride. A RecordStore named more than once in the
+	 * union could be operated on from two threads, so such unions are
+	 * queried serially.
+	 */
+	size_t threadCount = 0;
+	if (candidates.size() > MaximumSerialCandidates) {
+		std::set<const BE::IO::RecordStore*> distinct;
+		for (const auto &c : candidates)
+			distinct.insert(c.second.get());
+		if (distinct.size() == candidates.size())
+			threadCount = std::min<size_t>(candidates.size(),
+			    std::max(1u, std::thread::hardware_concurrency())) -
+			    1;
+	}
+	const auto lookupStride = [&candidates, &results, &doLookup](
+	    size_t first, size_t stride) {
+		for (size_t i = first; i < candidates.size(); i += stride)
+			results[i] = doLookup(candidates[i]);
+	};
+	std::vector<std::future<void>> futures;
+	for (size_t t = 1; t <= threadCount; t++) {
+		try {
+			futures.push_back(std::async(std::launch::async,
+			    lookupStride, t, threadCount + 1));
+		} catch (const std::system_error &) {
+			/* Out of threads; finish serially */
+			break;
+		}
+	}
+	lookupStride(0, threadCount + 1);
+	for (auto &future : futures)
+		future.get();
+	for (size_t t = futures.size() + 1; t <= threadCount; t++)
+		lookupStride(t, threadCount + 1);
+
+	std::string exceptions;
+	std::map<const std::string, T> ret;
+	for (size_t i = 0; i < candidates.size(); i++) {
+		if (results[i].found) {
+			ret.emplace(candidates[i].first,
+			    std::move(results[i].value));
+		} else if (!results[i].error.empty()) {
 			if (!exceptions.empty())
 				exceptions += '\n';
-			exceptions += e.whatString() + " (" + rsPair.first +
-			    ')';
+			exceptions += results[i].error;
 		}
 	}
-
 	if (!exceptions.empty())
 		throw BE::Error::StrategyError(exceptions);
+
+	return (ret);
+}
+
+std::map<const std::string, BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::RecordStoreUnion::Impl::tryRead(
+    const std::string &key)
+    const
+{
+	return (this->lookup<BE::Memory::uint8Array>(key,
+	    [&key](BE::IO::RecordStore &rs) {
+		return (rs.read(key));
+	}));
+}
+
+std::map<const std::string, BiometricEvaluation::Memory::uint8Array>
+BiometricEvaluation::IO::RecordStoreUnion::Impl::read(
+    const std::string &key)
+    const
+{
+	auto ret = this->tryRead(key);
 	if (ret.size() == 0)
 		throw BE::Error::ObjectDoesNotExist(key);
 
@@ -156,28 +252,322 @@ BiometricEvaluation::IO::RecordStoreUnion::Impl::length(
     const std::string &key)
     const
 {
-	std::string exceptions;
-	std::map<const std::string, uint64_t> ret;
+	const auto ret = this->lookup<uint64_t>(key,
+	    [&key](BE::IO::RecordStore &rs) {
+		return (rs.length(key));
+	});
+	if (ret.size() == 0)
+		throw BE::Error::ObjectDoesNotExist(key);
 
+	return (ret);
+}
+
+/*
+ * Key filters.
+ */
+
+std::vector<std::pair<std::string,
+std::shared_ptr<BiometricEvaluation::IO::RecordStore>>>
+BiometricEvaluation::IO::RecordStoreUnion::Impl::getCandidates(
+    const std::string &key)
+    const
+{
+	std::vector<std::pair<std::string,
+	    std::shared_ptr<BE::IO::RecordStore>>> candidates;
 	for (const auto &rsPair : this->_recordStores) {
-		try {
-			ret.emplace(std::make_pair(rsPair.first,
-			    rsPair.second->length(key)));
-		} catch (BE::Error::ObjectDoesNotExist) {
-			/* Swallow */
-		} catch (BE::Error::Exception &e) {
-			if (!exceptions.empty())
-				exceptions += '\n';
-			exceptions += e.whatString() + " (" + rsPair.first +
-			    ')';
+		const auto filter = this->_keyFilters.find(rsPair.first);
+		if ((filter != this->_keyFilters.cend()) &&
+		    !filter->second->mayContain(key))
+			continue;
+		candidates.emplace_back(rsPair.first, rsPair.second);
+	}
+	return (candidates);
+}
+
+std::shared_ptr<BiometricEvaluation::IO::RecordStoreUnion::Impl::KeyFilter>
+BiometricEvaluation::IO::RecordStoreUnion::Impl::buildKeyFilter(
+    const std::string &name)
+    const
+{
+	const auto rs = this->getRecordStore(name);
+	auto filter = std::make_shared<KeyFilter>(rs->getCount());
+	/* Taken first, so changes made while reading are noticed later */
+	filter->setFingerprint(this->getMemberFingerprint(name));
+	try {
+		filter->add(rs->sequenceKey(
+		    BE::IO::RecordStore::BE_RECSTORE_SEQ_START));
+		for (;;)
+			filter->add(rs->sequenceKey(
+			    BE::IO::RecordStore::BE_RECSTORE_SEQ_NEXT));
+	} catch (const BE::Error::ObjectDoesNotExist &) {
+		/* End of sequence */
+	}
+	return (filter);
+}
+
+uint64_t
+BiometricEvaluation::IO::RecordStoreUnion::Impl::getMemberFingerprint(
+    const std::string &name)
+    const
+{
+	const auto rs = this->getRecordStore(name);
+	try {
+		/* Control file may be rewritten without changing records */
+		return (BE::IO::Utility::getDirectoryFingerprint(
+		    rs->getPathname(),
+		    {BE::IO::RecordStore::Impl::CONTROLFILENAME}));
+	} catch (const BE::Error::Exception &) {
+		return (0);
+	}
+}
+
+void
+BiometricEvaluation::IO::RecordStoreUnion::Impl::buildKeyFilters()
+{
+	for (const auto &rsPair : this->_recordStores)
+		this->setKeyFilter(rsPair.first,
+		    this->buildKeyFilter(rsPair.first));
+}
+
+void
+BiometricEvaluation::IO::RecordStoreUnion::Impl::setKeyFilter(
+    const std::string &name,
+    const std::shared_ptr<KeyFilter> &filter)
+{
+	if (this->_recordStores.find(name) == this->_recordStores.cend())
+		throw BE::Error::ObjectDoesNotExist(name);
+
+	this->_keyFilters.erase(name);
+	this->_keyFilters.emplace(name, filter);
+}
+
+/*
+ * KeyFilter.
+ */
+
+/* FNV-1a, which unlike std::hash is stable across platforms */
+static uint64_t
+hashKey(
+    const std::string &key)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (const auto c : key) {
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 0x100000001b3ULL;
+	}
+	return (hash);
+}
+
+/* Second, independent hash derived by remixing the first */
+static uint64_t
+remixHash(
+    uint64_t hash)
+{
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+	return (hash | 1);
+}
+
+BiometricEvaluation::IO::RecordStoreUnion::Impl::KeyFilter::KeyFilter(
+    uint64_t expectedKeys)
+{
+	/* ~9.6 bits and 7 hashes per key yield ~1% false positives */
+	static const uint64_t BitsPerKey{10};
+	static const uint64_t MinimumBits{64};
+
+	this->_hashCount = 7;
+	this->_bitCount = std::max(expectedKeys * BitsPerKey, MinimumBits);
+	this->_bits.resize((this->_bitCount + 63) / 64, 0);
+}
+
+uint64_t
+BiometricEvaluation::IO::RecordStoreUnion::Impl::KeyFilter::bitIndex(
+    uint64_t h1,
+    uint64_t h2,
+    uint32_t i)
+    const
+{
+	return ((h1 + (i * h2)) % this->_bitCount);
+}
+
+void
+BiometricEvaluation::IO::RecordStoreUnion::Impl::KeyFilter::add(
+    const std::string &key)
+{
+	const uint64_t h1 = hashKey(key);
+	const uint64_t h2 = remixHash(h1);
+	for (uint32_t i = 0; i < this->_hashCount; i++) {
+		const uint64_t bit = this->bitIndex(h1, h2, i);
+		this->_bits[bit / 64] |= (uint64_t{1} << (bit % 64));
+	}
+	this->_keyCount++;
+}
+
+bool
+BiometricEvaluation::IO::RecordStoreUnion::Impl::KeyFilter::mayContain(
+    const std::string &key)
+    const
+{
+	const uint64_t h1 = hashKey(key);
+	const uint64_t h2 = remixHash(h1);
+	for (uint32_t i = 0; i < this->_hashCount; i++) {
+		const uint64_t bit = this->bitIndex(h1, h2, i);
+		if ((this->_bits[bit / 64] & (uint64_t{1} << (bit % 64))) == 0)
+			return (false);
+	}
+	return (true);
+}
+
+uint64_t
+BiometricEvaluation::IO::RecordStoreUnion::Impl::KeyFilter::getKeyCount()
+    const
+{
+	return (this->_keyCount);
+}
+
+void
+BiometricEvaluation::IO::RecordStoreUnion::Impl::KeyFilter::setFingerprint(
+    uint64_t fingerprint)
+{
+	this->_fingerprint = fingerprint;
+}
+
+uint64_t
+BiometricEvaluation::IO::RecordStoreUnion::Impl::KeyFilter::getFingerprint()
+    const
+{
+	return (this->_fingerprint);
+}
+
+/* Little-endian so filters can move between hosts */
+static void
+writeUInt64(
+    std::ostream &stream,
+    uint64_t value)
+{
+	char buf[8];
+	for (int i = 0; i < 8; i++)
+		buf[i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+	stream.write(buf, 8);
+}
+
+static uint64_t
+readUInt64(
+    std::istream &stream)
+{
+	char buf[8];
+	if (!stream.read(buf, 8))
+		throw BE::Error::StrategyError("Truncated key filter");
+	uint64_t value = 0;
+	for (int i = 0; i < 8; i++)
+		value |= static_cast<uint64_t>(static_cast<uint8_t>(buf[i])) <<
+		    (i * 8);
+	return (value);
+}
+
+static const std::string KeyFilterFileMagic{"BEKEYFL2"};
+
+void
+BiometricEvaluation::IO::RecordStoreUnion::Impl::writeKeyFilters(
+    const std::string &pathname)
+    const
+{
+	const std::string tempPathname = pathname + ".tmp";
+	{
+		std::ofstream stream(tempPathname,
+		    std::ios::binary | std::ios::trunc);
+		if (!stream)
+			throw BE::Error::StrategyError("Could not open " +
+			    tempPathname);
+
+		stream.write(KeyFilterFileMagic.data(),
+		    KeyFilterFileMagic.size());
+		writeUInt64(stream, this->_keyFilters.size());
+		for (const auto &filter : this->_keyFilters) {
+			writeUInt64(stream, filter.first.size());
+			stream.write(filter.first.data(), filter.first.size());
+			filter.second->write(stream);
+		}
+		stream.close();
+		if (!stream) {
+			std::remove(tempPathname.c_str());
+			throw BE::Error::StrategyError("Could not write " +
+			    tempPathname);
 		}
 	}
+	if (std::rename(tempPathname.c_str(), pathname.c_str()) != 0) {
+		std::remove(tempPathname.c_str());
+		throw BE::Error::StrategyError("Could not rename " +
+		    tempPathname + " (" + BE::Error::errorStr() + ")");
+	}
+}
 
-	if (!exceptions.empty())
-		throw BE::Error::StrategyError(exceptions);
-	if (ret.size() == 0)
-		throw BE::Error::ObjectDoesNotExist(key);
+std::map<const std::string,
+std::shared_ptr<BiometricEvaluation::IO::RecordStoreUnion::Impl::KeyFilter>>
+BiometricEvaluation::IO::RecordStoreUnion::Impl::readKeyFilters(
+    const std::string &pathname)
+{
+	if (!BE::IO::Utility::fileExists(pathname))
+		throw BE::Error::ObjectDoesNotExist(pathname);
+	std::ifstream stream(pathname, std::ios::binary);
+	if (!stream)
+		throw BE::Error::StrategyError("Could not open " + pathname);
 
-	return (ret);
+	std::string magic(KeyFilterFileMagic.size(), '\0');
+	if (!stream.read(&magic[0], magic.size()) ||
+	    (magic != KeyFilterFileMagic))
+		throw BE::Error::StrategyError(pathname + " is not a key "
+		    "filter file");
+
+	std::map<const std::string, std::shared_ptr<KeyFilter>> filters;
+	const uint64_t count = readUInt64(stream);
+	for (uint64_t i = 0; i < count; i++) {
+		const uint64_t nameLength = readUInt64(stream);
+		/* Names are short; reject garbage before allocating */
+		if (nameLength > 4096)
+			throw BE::Error::StrategyError("Malformed key filter");
+		std::string name(nameLength, '\0');
+		if (!stream.read(&name[0], nameLength))
+			throw BE::Error::StrategyError("Truncated key filter");
+		filters.emplace(name, KeyFilter::read(stream));
+	}
+	return (filters);
 }
 
+void
+BiometricEvaluation::IO::RecordStoreUnion::Impl::KeyFilter::write(
+    std::ostream &stream)
+    const
+{
+	writeUInt64(stream, this->_hashCount);
+	writeUInt64(stream, this->_bitCount);
+	writeUInt64(stream, this->_keyCount);
+	writeUInt64(stream, this->_fingerprint);
+	for (const auto &word : this->_bits)
+		writeUInt64(stream, word);
+	if (!stream)
+		throw BE::Error::StrategyError("Could not write key filter");
+}
+
+std::shared_ptr<BiometricEvaluation::IO::RecordStoreUnion::Impl::KeyFilter>
+BiometricEvaluation::IO::RecordStoreUnion::Impl::KeyFilter::read(
+    std::istream &stream)
+{
+	std::shared_ptr<KeyFilter> filter(new KeyFilter());
+	filter->_hashCount = static_cast<uint32_t>(readUInt64(stream));
+	filter->_bitCount = readUInt64(stream);
+	filter->_keyCount = readUInt64(stream);
+	filter->_fingerprint = readUInt64(stream);
+	if ((filter->_hashCount == 0) || (filter->_hashCount > 64) ||
+	    (filter->_bitCount == 0) ||
+	    (filter->_bitCount > (filter->_keyCount + 1) * 64 * 64))
+		throw BE::Error::StrategyError("Malformed key filter");
+
+	filter->_bits.resize((filter->_bitCount + 63) / 64);
+	for (auto &word : filter->_bits)
+		word = readUInt64(stream);
+	return (filter);
+}
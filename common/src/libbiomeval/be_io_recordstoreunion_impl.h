@@ -15,6 +15,8 @@
 
 
 #include <functional>
+#include <istream>
+#include <ostream>
 
 namespace BiometricEvaluation
 {
@@ -24,6 +26,139 @@ namespace BiometricEvaluation
 		class RecordStoreUnion::Impl
 		{
 		public:
+			/**
+			 * @brief
+			 * Probabilistic set of the keys in a RecordStore.
+			 * @details
+			 * A Bloom filter never reports that a key it was
+			 * given is absent, but may report that a key it was
+			 * never given is present. Sized for a false
+			 * positive rate near 1%. Hashing is independent of
+			 * platform so that filters may be saved to disk.
+			 */
+			class KeyFilter
+			{
+			public:
+				/**
+				 * @brief
+				 * KeyFilter constructor.
+				 *
+				 * @param expectedKeys
+				 * Number of keys that will be added.
+				 */
+				KeyFilter(
+				    uint64_t expectedKeys);
+
+				/**
+				 * @brief
+				 * Add a key to the filter.
+				 *
+				 * @param key
+				 * Key to add.
+				 */
+				void
+				add(
+				    const std::string &key);
+
+				/**
+				 * @brief
+				 * Determine whether a key may have been added.
+				 *
+				 * @param key
+				 * Key to check.
+				 *
+				 * @return
+				 * false if key was definitely never added,
+				 * true otherwise.
+				 */
+				bool
+				mayContain(
+				    const std::string &key)
+				    const;
+
+				/**
+				 * @return
+				 * Number of keys added to the filter.
+				 */
+				uint64_t
+				getKeyCount()
+				    const;
+
+				/**
+				 * @brief
+				 * Set the state of the RecordStore whose keys
+				 * were added.
+				 *
+				 * @param fingerprint
+				 * Value from getMemberFingerprint() taken
+				 * before keys were added.
+				 */
+				void
+				setFingerprint(
+				    uint64_t fingerprint);
+
+				/**
+				 * @return
+				 * Value passed to setFingerprint(), or 0.
+				 */
+				uint64_t
+				getFingerprint()
+				    const;
+
+				/**
+				 * @brief
+				 * Write the filter to a stream.
+				 *
+				 * @param stream
+				 * Binary stream to write.
+				 */
+				void
+				write(
+				    std::ostream &stream)
+				    const;
+
+				/**
+				 * @brief
+				 * Read a filter previously written with
+				 * write().
+				 *
+				 * @param stream
+				 * Binary stream to read.
+				 *
+				 * @return
+				 * Filter read from stream.
+				 *
+				 * @throw Error::StrategyError
+				 * stream is truncated or malformed.
+				 */
+				static std::shared_ptr<KeyFilter>
+				read(
+				    std::istream &stream);
+
+			private:
+				/** Empty filter, sized by read() */
+				KeyFilter() = default;
+
+				/** Index of the ith bit set for a key */
+				uint64_t
+				bitIndex(
+				    uint64_t h1,
+				    uint64_t h2,
+				    uint32_t i)
+				    const;
+
+				/** Number of bits set per key */
+				uint32_t _hashCount{0};
+				/** Number of bits in the filter */
+				uint64_t _bitCount{0};
+				/** Number of keys added */
+				uint64_t _keyCount{0};
+				/** State of the RecordStore when built */
+				uint64_t _fingerprint{0};
+				/** Filter bits */
+				std::vector<uint64_t> _bits{};
+			};
+
 			/**
 			 * RecordStoreUnion::Impl constructor.
 			 *
@@ -205,10 +340,191 @@ namespace BiometricEvaluation
 			    const std::string &key)
 			    const;
 
+			/**
+			 * @brief
+			 * Read a key from member RecordStores without
+			 * throwing when the key is missing.
+			 *
+			 * @param key
+			 * The key to read.
+			 *
+			 * @return
+			 * Map of RecordStore name to data read from said
+			 * RecordStore. Empty if key does not exist in any
+			 * member RecordStore.
+			 *
+			 * @throw Error::StrategyError
+			 * Exceptions propagated from RecordStore, with the
+			 * exception of ObjectDoesNotExist.
+			 */
+			std::map<const std::string,
+			BiometricEvaluation::Memory::uint8Array>
+			tryRead(
+			    const std::string &key)
+			    const;
+
+			/**
+			 * @brief
+			 * Build a KeyFilter for every member RecordStore.
+			 *
+			 * @throw Error::StrategyError
+			 * Error sequencing a member RecordStore.
+			 *
+			 * @note
+			 * The sequence cursor of each member RecordStore
+			 * is left at the end of the RecordStore.
+			 */
+			void
+			buildKeyFilters();
+
 			/** Default destructor */
-			~Impl() = default;
+			virtual ~Impl() = default;
+
+		protected:
+			/**
+			 * @brief
+			 * Build a KeyFilter from the keys of a member
+			 * RecordStore.
+			 *
+			 * @param name
+			 * Name of the member RecordStore.
+			 *
+			 * @return
+			 * KeyFilter of every key in name.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 * name is not recognized.
+			 * @throw Error::StrategyError
+			 * Error sequencing the RecordStore.
+			 *
+			 * @note
+			 * The sequence cursor of the RecordStore is left at
+			 * the end of the RecordStore.
+			 */
+			std::shared_ptr<KeyFilter>
+			buildKeyFilter(
+			    const std::string &name)
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain a value that changes when the files of a
+			 * member RecordStore change.
+			 *
+			 * @param name
+			 * Name of the member RecordStore.
+			 *
+			 * @return
+			 * Fingerprint of the files of name, excluding its
+			 * control file, or 0 if it could not be taken.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 * name is not recognized.
+			 */
+			uint64_t
+			getMemberFingerprint(
+			    const std::string &name)
+			    const;
+
+			/**
+			 * @brief
+			 * Use a KeyFilter to skip a member RecordStore.
+			 *
+			 * @param name
+			 * Name of the member RecordStore.
+			 * @param filter
+			 * KeyFilter containing every key in name.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 * name is not recognized.
+			 */
+			void
+			setKeyFilter(
+			    const std::string &name,
+			    const std::shared_ptr<KeyFilter> &filter);
+
+			/**
+			 * @brief
+			 * Save all KeyFilters in use to a file.
+			 *
+			 * @param pathname
+			 * Path of file to write, replaced atomically.
+			 *
+			 * @throw Error::StrategyError
+			 * Error writing pathname.
+			 */
+			void
+			writeKeyFilters(
+			    const std::string &pathname)
+			    const;
+
+			/**
+			 * @brief
+			 * Read KeyFilters saved with writeKeyFilters().
+			 *
+			 * @param pathname
+			 * Path of file to read.
+			 *
+			 * @return
+			 * KeyFilters keyed by RecordStore name.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 * pathname does not exist.
+			 * @throw Error::StrategyError
+			 * pathname is unreadable or malformed.
+			 */
+			static std::map<const std::string,
+			    std::shared_ptr<KeyFilter>>
+			readKeyFilters(
+			    const std::string &pathname);
 
 		private:
+			/**
+			 * @brief
+			 * Obtain the member RecordStores that may contain
+			 * a key.
+			 *
+			 * @param key
+			 * The key to locate.
+			 *
+			 * @return
+			 * Name and RecordStore of each member whose KeyFilter
+			 * admits key, or that has no KeyFilter.
+			 */
+			std::vector<std::pair<std::string, std::shared_ptr<
+			    BiometricEvaluation::IO::RecordStore>>>
+			getCandidates(
+			    const std::string &key)
+			    const;
+
+			/**
+			 * @brief
+			 * Perform an operation on a key in every candidate
+			 * member RecordStore, concurrently when there are
+			 * more than a few candidates.
+			 *
+			 * @param key
+			 * The key to operate on.
+			 * @param op
+			 * Operation to perform on a RecordStore.
+			 *
+			 * @return
+			 * Map of RecordStore name to result of op for those
+			 * RecordStores that contain key.
+			 *
+			 * @throw Error::StrategyError
+			 * Exceptions propagated from op, with the exception
+			 * of ObjectDoesNotExist, thrown after op has
+			 * completed for all candidates.
+			 */
+			template<typename T>
+			std::map<const std::string, T>
+			lookup(
+			    const std::string &key,
+			    const std::function<T(
+			    BiometricEvaluation::IO::RecordStore&)> &op)
+			    const;
+
 			/**
 			 * @brief
 			 * Check that RecordStore names passed to a method
@@ -249,6 +565,10 @@ namespace BiometricEvaluation
 			const std::map<const std::string, const std::shared_ptr<
 			    BiometricEvaluation::IO::RecordStore>>
 			    _recordStores;
+
+			/** KeyFilters of member RecordStores */
+			std::map<const std::string, std::shared_ptr<KeyFilter>>
+			    _keyFilters{};
 		};
 	}
 }
@@ -0,0 +1,214 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include "be_io_shardedrecstore_impl.h"
+
+namespace BE = BiometricEvaluation;
+
+BiometricEvaluation::IO::ShardedRecordStore::ShardedRecordStore(
+    const std::string &pathname,
+    const std::string &description,
+    const RecordStore::Kind &shardKind,
+    uint32_t shardCount,
+    const std::vector<std::string> &shardPathnames,
+    RecordStore::Concurrency concurrency)
+{
+	/*
+	 * Exceptions float out.
+	 */
+	this->pimpl.reset(new IO::ShardedRecordStore::Impl(pathname,
+	    description, shardKind, shardCount, shardPathnames, concurrency));
+}
+
+BiometricEvaluation::IO::ShardedRecordStore::ShardedRecordStore(
+    const std::string &pathname,
+    IO::Mode mode,
+    RecordStore::Concurrency concurrency)
+{
+	/*
+	 * Exceptions float out.
+	 */
+	this->pimpl.reset(new IO::ShardedRecordStore::Impl(pathname, mode,
+	    concurrency));
+}
+
+BiometricEvaluation::IO::ShardedRecordStore::~ShardedRecordStore()
+{
+}
+
+uint32_t
+BiometricEvaluation::IO::ShardedRecordStore::getShardCount()
+    const
+{
+	return (this->pimpl->getShardCount());
+}
+
+BiometricEvaluation::IO::RecordStore::Kind
+BiometricEvaluation::IO::ShardedRecordStore::getShardKind()
+    const
+{
+	return (this->pimpl->getShardKind());
+}
+
+uint32_t
+BiometricEvaluation::IO::ShardedRecordStore::getShardIndex(
+    const std::string &key)
+    const
+{
+	return (this->pimpl->getShardIndex(key));
+}
+
+std::shared_ptr<BiometricEvaluation::IO::RecordStore>
+BiometricEvaluation::IO::ShardedRecordStore::getShard(
+    uint32_t index)
+    const
+{
+	return (this->pimpl->getShard(index));
+}
+
+std::string
+BiometricEvaluation::IO::ShardedRecordStore::getShardPathname(
+    uint32_t index)
+    const
+{
+	return (this->pimpl->getShardPathname(index));
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::reshard(
+    uint32_t shardCount,
+    const std::vector<std::string> &shardPathnames)
+{
+	this->pimpl->reshard(shardCount, shardPathnames);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::move(
+    const std::string &pathname)
+{
+	this->pimpl->move(pathname);
+}
+
+uint64_t
+BiometricEvaluation::IO::ShardedRecordStore::getSpaceUsed()
+    const
+{
+	return (this->pimpl->getSpaceUsed());
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::sync()
+    const
+{
+	this->pimpl->sync();
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::insert(
+    const std::string &key,
+    const void *const data,
+    const uint64_t size)
+{
+	this->pimpl->insert(key, data, size);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::remove(
+    const std::string &key)
+{
+	this->pimpl->remove(key);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::ShardedRecordStore::read(
+    const std::string &key)
+    const
+{
+	return (this->pimpl->read(key));
+}
+
+uint64_t
+BiometricEvaluation::IO::ShardedRecordStore::length(
+    const std::string &key)
+    const
+{
+	return (this->pimpl->length(key));
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::flush(
+    const std::string &key)
+    const
+{
+	this->pimpl->flush(key);
+}
+
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::ShardedRecordStore::sequence(
+    int cursor)
+{
+	return (this->pimpl->sequence(cursor));
+}
+
+std::string
+BiometricEvaluation::IO::ShardedRecordStore::sequenceKey(
+    int cursor)
+{
+	return (this->pimpl->sequenceKey(cursor));
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::setCursorAtKey(
+    const std::string &key)
+{
+	this->pimpl->setCursorAtKey(key);
+}
+
+std::string
+BiometricEvaluation::IO::ShardedRecordStore::nextKey(
+    const std::string &key)
+{
+	return (this->pimpl->nextKey(key));
+}
+
+BiometricEvaluation::IO::RecordStore::Concurrency
+BiometricEvaluation::IO::ShardedRecordStore::getConcurrency()
+    const
+{
+	return (this->pimpl->getConcurrency());
+}
+
+unsigned int
+BiometricEvaluation::IO::ShardedRecordStore::getCount()
+    const
+{
+	return (this->pimpl->getCount());
+}
+
+std::string
+BiometricEvaluation::IO::ShardedRecordStore::getPathname()
+    const
+{
+	return (this->pimpl->getPathname());
+}
+
+std::string
+BiometricEvaluation::IO::ShardedRecordStore::getDescription()
+    const
+{
+	return (this->pimpl->getDescription());
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::changeDescription(
+    const std::string &description)
+{
+	this->pimpl->changeDescription(description);
+}
@@ -0,0 +1,544 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <unistd.h>
+
+#include <climits>
+
+#include "be_io_shardedrecstore_impl.h"
+#include <be_io_properties.h>
+#include <be_io_utility.h>
+
+namespace BE = BiometricEvaluation;
+
+using namespace BE::Framework::Enumeration;
+
+const std::string SHARD_KIND_KEY{"Shard Kind"};
+const std::string SHARD_COUNT_KEY{"Shard Count"};
+const std::string SHARD_GENERATION_KEY{"Shard Generation"};
+/* Followed by the shard index */
+const std::string SHARD_PATHNAME_KEY{"Shard "};
+/* Followed by the shard index and generation */
+const std::string DEFAULT_SHARD_NAME{"shard"};
+
+/**
+ * @brief
+ * Select a shard for a key.
+ * @details
+ * Uses the 64-bit FNV-1a hash, whose value depends only on the bytes of
+ * the key, so every platform places a key in the same shard.
+ *
+ * @param key
+ *	Key of a record.
+ * @param shardCount
+ *	Number of shards.
+ *
+ * @return
+ *	Index of the shard for key.
+ */
+static uint32_t
+selectShard(
+    const std::string &key,
+    uint32_t shardCount)
+{
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (const char c : key) {
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 0x100000001B3ULL;
+	}
+	return (static_cast<uint32_t>(hash % shardCount));
+}
+
+BiometricEvaluation::IO::ShardedRecordStore::Impl::Impl(
+    const std::string &pathname,
+    const std::string &description,
+    const RecordStore::Kind &shardKind,
+    uint32_t shardCount,
+    const std::vector<std::string> &shardPathnames,
+    RecordStore::Concurrency concurrency) :
+    RecordStore::Impl(pathname, description, RecordStore::Kind::Sharded,
+    concurrency),
+    _shardKind(shardKind),
+    _generation(0),
+    _cursorShard(0),
+    _shardCursor(BE_RECSTORE_SEQ_START)
+{
+	try {
+		switch (shardKind) {
+		case RecordStore::Kind::List:
+		case RecordStore::Kind::Sharded:
+			throw Error::StrategyError(to_string(shardKind) +
+			    " RecordStores cannot be shards");
+		default:
+			break;
+		}
+
+		this->_shardPathnames = planShardPathnames(shardCount,
+		    shardPathnames, this->_generation);
+		this->_shards = this->createShards(this->_shardPathnames,
+		    description);
+		this->writeShardProperties();
+	} catch (const Error::Exception&) {
+		/* Don't leave behind a store without shards */
+		IO::Utility::removeDirectory(pathname);
+		throw;
+	}
+}
+
+BiometricEvaluation::IO::ShardedRecordStore::Impl::Impl(
+    const std::string &pathname,
+    IO::Mode mode,
+    RecordStore::Concurrency concurrency) :
+    RecordStore::Impl(pathname, mode, concurrency),
+    _cursorShard(0),
+    _shardCursor(BE_RECSTORE_SEQ_START)
+{
+	std::shared_ptr<IO::Properties> props = this->getProperties();
+	try {
+		this->_shardKind = to_enum<RecordStore::Kind>(
+		    props->getProperty(SHARD_KIND_KEY));
+		this->_generation = props->getPropertyAsInteger(
+		    SHARD_GENERATION_KEY);
+		const uint32_t shardCount = props->getPropertyAsInteger(
+		    SHARD_COUNT_KEY);
+		for (uint32_t i = 0; i < shardCount; i++)
+			this->_shardPathnames.push_back(props->getProperty(
+			    SHARD_PATHNAME_KEY + std::to_string(i)));
+	} catch (const Error::Exception &e) {
+		throw Error::StrategyError("Invalid shard properties: " +
+		    e.whatString());
+	}
+	if (this->_shardPathnames.empty())
+		throw Error::StrategyError("Invalid shard properties: no "
+		    "shards");
+
+	this->openShards();
+}
+
+BiometricEvaluation::IO::ShardedRecordStore::Impl::~Impl()
+{
+
+}
+
+std::vector<std::string>
+BiometricEvaluation::IO::ShardedRecordStore::Impl::planShardPathnames(
+    uint32_t shardCount,
+    const std::vector<std::string> &shardPathnames,
+    uint64_t generation)
+{
+	if (shardCount == 0)
+		throw Error::ParameterError("Shard count must be positive");
+	if (!shardPathnames.empty() && (shardPathnames.size() != shardCount))
+		throw Error::ParameterError("Number of shard pathnames does "
+		    "not match shard count");
+
+	std::vector<std::string> plan;
+	if (shardPathnames.empty()) {
+		/* Within the store, so they move with it */
+		for (uint32_t i = 0; i < shardCount; i++)
+			plan.push_back(DEFAULT_SHARD_NAME + std::to_string(i) +
+			    '.' + std::to_string(generation));
+		return (plan);
+	}
+
+	/* Relative to the working directory, not the store */
+	char cwd[PATH_MAX];
+	if (getcwd(cwd, PATH_MAX) == nullptr)
+		throw Error::StrategyError("Could not get working directory");
+	for (const auto &shardPathname : shardPathnames) {
+		if (shardPathname.empty())
+			throw Error::ParameterError("Empty shard pathname");
+		if (shardPathname[0] == '/')
+			plan.push_back(shardPathname);
+		else
+			plan.push_back(std::string(cwd) + '/' + shardPathname);
+	}
+	return (plan);
+}
+
+std::string
+BiometricEvaluation::IO::ShardedRecordStore::Impl::resolveShardPathname(
+    const std::string &shardPathname)
+    const
+{
+	if (shardPathname[0] == '/')
+		return (shardPathname);
+	return (this->getPathname() + '/' + shardPathname);
+}
+
+std::vector<std::shared_ptr<BiometricEvaluation::IO::RecordStore>>
+BiometricEvaluation::IO::ShardedRecordStore::Impl::createShards(
+    const std::vector<std::string> &shardPathnames,
+    const std::string &description)
+    const
+{
+	std::vector<std::shared_ptr<RecordStore>> shards;
+	try {
+		for (const auto &shardPathname : shardPathnames)
+			shards.push_back(RecordStore::createRecordStore(
+			    this->resolveShardPathname(shardPathname),
+			    description, this->_shardKind,
+			    this->getConcurrency()));
+	} catch (const Error::Exception&) {
+		for (auto &shard : shards) {
+			const std::string path = shard->getPathname();
+			shard.reset();
+			IO::Utility::removeDirectory(path);
+		}
+		throw;
+	}
+	return (shards);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::openShards()
+{
+	this->_shards.clear();
+	for (const auto &shardPathname : this->_shardPathnames)
+		this->_shards.push_back(RecordStore::openRecordStore(
+		    this->resolveShardPathname(shardPathname),
+		    this->getMode(), this->getConcurrency()));
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::writeShardProperties()
+{
+	std::shared_ptr<IO::Properties> props = this->getProperties();
+	props->setProperty(SHARD_KIND_KEY, to_string(this->_shardKind));
+	props->setPropertyFromInteger(SHARD_COUNT_KEY,
+	    this->_shardPathnames.size());
+	props->setPropertyFromInteger(SHARD_GENERATION_KEY,
+	    this->_generation);
+	for (uint32_t i = 0; i < this->_shardPathnames.size(); i++)
+		props->setProperty(SHARD_PATHNAME_KEY + std::to_string(i),
+		    this->_shardPathnames[i]);
+
+	/* Forget shards beyond the current count */
+	for (uint32_t i = this->_shardPathnames.size(); ; i++) {
+		try {
+			props->removeProperty(SHARD_PATHNAME_KEY +
+			    std::to_string(i));
+		} catch (const Error::ObjectDoesNotExist&) {
+			break;
+		}
+	}
+
+	this->setProperties(props);
+	RecordStore::Impl::sync();
+}
+
+uint32_t
+BiometricEvaluation::IO::ShardedRecordStore::Impl::i_getShardIndex(
+    const std::string &key)
+    const
+{
+	return (selectShard(key, this->_shards.size()));
+}
+
+uint32_t
+BiometricEvaluation::IO::ShardedRecordStore::Impl::getShardCount()
+    const
+{
+	ReaderLock lock(*this);
+	return (this->_shards.size());
+}
+
+BiometricEvaluation::IO::RecordStore::Kind
+BiometricEvaluation::IO::ShardedRecordStore::Impl::getShardKind()
+    const
+{
+	return (this->_shardKind);
+}
+
+uint32_t
+BiometricEvaluation::IO::ShardedRecordStore::Impl::getShardIndex(
+    const std::string &key)
+    const
+{
+	ReaderLock lock(*this);
+	return (this->i_getShardIndex(key));
+}
+
+std::shared_ptr<BiometricEvaluation::IO::RecordStore>
+BiometricEvaluation::IO::ShardedRecordStore::Impl::getShard(
+    uint32_t index)
+    const
+{
+	ReaderLock lock(*this);
+	if (index >= this->_shards.size())
+		throw Error::ParameterError("Invalid shard index");
+	return (this->_shards[index]);
+}
+
+std::string
+BiometricEvaluation::IO::ShardedRecordStore::Impl::getShardPathname(
+    uint32_t index)
+    const
+{
+	ReaderLock lock(*this);
+	if (index >= this->_shardPathnames.size())
+		throw Error::ParameterError("Invalid shard index");
+	return (this->resolveShardPathname(this->_shardPathnames[index]));
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::reshard(
+    uint32_t shardCount,
+    const std::vector<std::string> &shardPathnames)
+{
+	if (this->getMode() == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+
+	WriterLock lock(*this);
+	const uint64_t generation = this->_generation + 1;
+	const std::vector<std::string> newPathnames = planShardPathnames(
+	    shardCount, shardPathnames, generation);
+	for (const auto &newPathname : newPathnames) {
+		const std::string path = this->resolveShardPathname(
+		    newPathname);
+		if (!IO::Utility::fileExists(path))
+			continue;
+		/* Left behind by an earlier, interrupted reshard */
+		if (shardPathnames.empty())
+			IO::Utility::removeDirectory(path);
+		else
+			throw Error::ObjectExists(path);
+	}
+
+	std::vector<std::shared_ptr<RecordStore>> newShards =
+	    this->createShards(newPathnames, this->getDescription());
+	try {
+		for (auto &shard : this->_shards) {
+			int cursor = BE_RECSTORE_SEQ_START;
+			while (true) {
+				RecordStore::Record record;
+				try {
+					record = shard->sequence(cursor);
+				} catch (const Error::ObjectDoesNotExist&) {
+					break;
+				}
+				cursor = BE_RECSTORE_SEQ_NEXT;
+				newShards[selectShard(record.key, shardCount)]->
+				    insert(record.key, record.data);
+			}
+		}
+		for (auto &shard : newShards)
+			shard->sync();
+	} catch (const Error::Exception&) {
+		for (auto &shard : newShards) {
+			const std::string path = shard->getPathname();
+			shard.reset();
+			IO::Utility::removeDirectory(path);
+		}
+		throw;
+	}
+
+	/* Switch to the new shards before removing the old */
+	std::vector<std::string> oldPaths;
+	for (const auto &oldPathname : this->_shardPathnames)
+		oldPaths.push_back(this->resolveShardPathname(oldPathname));
+	this->_shards = std::move(newShards);
+	this->_shardPathnames = newPathnames;
+	this->_generation = generation;
+	this->writeShardProperties();
+	this->_cursorShard = 0;
+	this->_shardCursor = BE_RECSTORE_SEQ_START;
+
+	for (const auto &path : oldPaths)
+		IO::Utility::removeDirectory(path);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::insert(
+    const std::string &key,
+    const void *const data,
+    const uint64_t size)
+{
+	if (this->getMode() == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+
+	ReaderLock lock(*this);
+	this->_shards[this->i_getShardIndex(key)]->insert(key, data, size);
+	RecordStore::Impl::insert(key, data, size);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::remove(
+    const std::string &key)
+{
+	if (this->getMode() == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+
+	ReaderLock lock(*this);
+	this->_shards[this->i_getShardIndex(key)]->remove(key);
+	RecordStore::Impl::remove(key);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::ShardedRecordStore::Impl::read(
+    const std::string &key)
+    const
+{
+	ReaderLock lock(*this);
+	return (this->_shards[this->i_getShardIndex(key)]->read(key));
+}
+
+uint64_t
+BiometricEvaluation::IO::ShardedRecordStore::Impl::length(
+    const std::string &key)
+    const
+{
+	ReaderLock lock(*this);
+	return (this->_shards[this->i_getShardIndex(key)]->length(key));
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::flush(
+    const std::string &key)
+    const
+{
+	if (this->getMode() == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+
+	ReaderLock lock(*this);
+	this->_shards[this->i_getShardIndex(key)]->flush(key);
+}
+
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::ShardedRecordStore::Impl::i_sequence(
+    bool returnData,
+    int cursor)
+{
+	if ((cursor != BE_RECSTORE_SEQ_START) &&
+	    (cursor != BE_RECSTORE_SEQ_NEXT))
+		throw Error::StrategyError("Invalid cursor position as "
+		    "argument");
+
+	if (cursor == BE_RECSTORE_SEQ_START) {
+		this->_cursorShard = 0;
+		this->_shardCursor = BE_RECSTORE_SEQ_START;
+	}
+
+	/* Sequence each shard in turn */
+	while (this->_cursorShard < this->_shards.size()) {
+		const std::shared_ptr<RecordStore> &shard =
+		    this->_shards[this->_cursorShard];
+		try {
+			RecordStore::Record record;
+			if (returnData)
+				record = shard->sequence(this->_shardCursor);
+			else
+				record.key = shard->sequenceKey(
+				    this->_shardCursor);
+			this->_shardCursor = BE_RECSTORE_SEQ_NEXT;
+			return (record);
+		} catch (const Error::ObjectDoesNotExist&) {
+			this->_cursorShard++;
+			this->_shardCursor = BE_RECSTORE_SEQ_START;
+		}
+	}
+	throw Error::ObjectDoesNotExist("No record at cursor");
+}
+
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::ShardedRecordStore::Impl::sequence(
+    int cursor)
+{
+	WriterLock lock(*this);
+	return (this->i_sequence(true, cursor));
+}
+
+std::string
+BiometricEvaluation::IO::ShardedRecordStore::Impl::sequenceKey(
+    int cursor)
+{
+	WriterLock lock(*this);
+	return (this->i_sequence(false, cursor).key);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::setCursorAtKey(
+    const std::string &key)
+{
+	WriterLock lock(*this);
+	const uint32_t index = this->i_getShardIndex(key);
+	this->_shards[index]->setCursorAtKey(key);
+	this->_cursorShard = index;
+	this->_shardCursor = BE_RECSTORE_SEQ_NEXT;
+}
+
+std::string
+BiometricEvaluation::IO::ShardedRecordStore::Impl::nextKey(
+    const std::string &key)
+    const
+{
+	ReaderLock lock(*this);
+	uint32_t index = 0;
+	if (!key.empty()) {
+		index = this->i_getShardIndex(key);
+		try {
+			return (this->_shards[index]->nextKey(key));
+		} catch (const Error::ObjectDoesNotExist&) {
+			/* Distinguish a missing key from a shard's last */
+			if (!this->_shards[index]->containsKey(key))
+				throw;
+		}
+		index++;
+	}
+
+	/* First key of the following non-empty shard */
+	for (; index < this->_shards.size(); index++) {
+		try {
+			return (this->_shards[index]->nextKey(""));
+		} catch (const Error::ObjectDoesNotExist&) {}
+	}
+	throw Error::ObjectDoesNotExist("No record after " + key);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::sync()
+    const
+{
+	if (this->getMode() == Mode::ReadOnly)
+		return;
+
+	ReaderLock lock(*this);
+	for (const auto &shard : this->_shards)
+		shard->sync();
+	RecordStore::Impl::sync();
+}
+
+uint64_t
+BiometricEvaluation::IO::ShardedRecordStore::Impl::getSpaceUsed()
+    const
+{
+	ReaderLock lock(*this);
+	uint64_t total = RecordStore::Impl::getSpaceUsed();
+	for (const auto &shard : this->_shards)
+		total += shard->getSpaceUsed();
+	return (total);
+}
+
+void
+BiometricEvaluation::IO::ShardedRecordStore::Impl::move(
+    const std::string &pathname)
+{
+	if (this->getMode() == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+
+	WriterLock lock(*this);
+	this->_shards.clear();
+
+	/* Shards within the store move with it */
+	RecordStore::Impl::move(pathname);
+	this->openShards();
+	this->_cursorShard = 0;
+	this->_shardCursor = BE_RECSTORE_SEQ_START;
+}
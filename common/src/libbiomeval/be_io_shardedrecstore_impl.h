@@ -0,0 +1,286 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_IO_SHARDEDRECSTORE_IMPL_H__
+#define __BE_IO_SHARDEDRECSTORE_IMPL_H__
+
+#include <be_io_shardedrecstore.h>
+#include "be_io_recordstore_impl.h"
+
+namespace BiometricEvaluation
+{
+	namespace IO
+	{
+		/**
+		 * @brief
+		 * Implementation of ShardedRecordStore.
+		 */
+		class ShardedRecordStore::Impl : public RecordStore::Impl
+		{
+		public:
+			/**
+			 * Create a new ShardedRecordStore, read/write mode.
+			 *
+			 * @param[in] pathname
+			 *	The directory where the store is to be created.
+			 * @param[in] description
+			 *	The store's description.
+			 * @param[in] shardKind
+			 *	The kind of RecordStore each shard should be.
+			 * @param[in] shardCount
+			 *	The number of shards.
+			 * @param[in] shardPathnames
+			 *	The directory where each shard is to be
+			 *	created, or empty to create the shards
+			 *	within pathname.
+			 * @param[in] concurrency
+			 *	Whether the object may be shared by threads.
+			 *
+			 * @throw Error::ObjectExists
+			 *	The store or one of its shards already exists.
+			 * @throw Error::ParameterError
+			 *	Invalid shard count or pathnames.
+			 * @throw Error::StrategyError
+			 *	An error occurred when accessing the underlying
+			 *	file system.
+			 */
+			Impl(
+			    const std::string &pathname,
+			    const std::string &description,
+			    const RecordStore::Kind &shardKind,
+			    uint32_t shardCount,
+			    const std::vector<std::string> &shardPathnames,
+			    RecordStore::Concurrency concurrency);
+
+			/**
+			 * Open an existing ShardedRecordStore.
+			 *
+			 * @param[in] pathname
+			 *	The path name of the store.
+			 * @param[in] mode
+			 *	Open mode, read-only or read-write.
+			 * @param[in] concurrency
+			 *	Whether the object may be shared by threads.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 *	The store or one of its shards does not exist.
+			 * @throw Error::StrategyError
+			 *	An error occurred when accessing the underlying
+			 *	file system.
+			 */
+			Impl(
+			    const std::string &pathname,
+			    IO::Mode mode,
+			    RecordStore::Concurrency concurrency);
+
+			/*
+			 * Destructor.
+			 */
+			~Impl();
+
+			uint32_t
+			getShardCount()
+			    const;
+
+			RecordStore::Kind
+			getShardKind()
+			    const;
+
+			uint32_t
+			getShardIndex(
+			    const std::string &key)
+			    const;
+
+			std::shared_ptr<RecordStore>
+			getShard(
+			    uint32_t index)
+			    const;
+
+			std::string
+			getShardPathname(
+			    uint32_t index)
+			    const;
+
+			void
+			reshard(
+			    uint32_t shardCount,
+			    const std::vector<std::string> &shardPathnames);
+
+			uint64_t
+			getSpaceUsed() const;
+
+			void
+			sync() const;
+
+			void
+			insert(
+			    const std::string &key,
+			    const void *const data,
+			    const uint64_t size);
+
+			void
+			remove(
+			    const std::string &key);
+
+			Memory::uint8Array
+			read(
+			    const std::string &key) const;
+
+			uint64_t
+			length(
+			    const std::string &key) const;
+
+			void
+			flush(
+			    const std::string &key) const;
+
+			RecordStore::Record
+			sequence(
+			    int cursor = BE_RECSTORE_SEQ_NEXT);
+
+			std::string
+			sequenceKey(
+			    int cursor = BE_RECSTORE_SEQ_NEXT);
+
+			void
+			setCursorAtKey(
+			    const std::string &key);
+
+			std::string
+			nextKey(
+			    const std::string &key)
+			    const;
+
+			void
+			move(
+			    const std::string &pathname);
+
+			/* Prevent copying of ShardedRecordStore objects */
+			Impl(const Impl&) = delete;
+			Impl& operator=(const Impl&) = delete;
+
+		private:
+			/** Kind of RecordStore of each shard */
+			RecordStore::Kind _shardKind;
+
+			/** Shards, indexed by getShardIndex() */
+			std::vector<std::shared_ptr<RecordStore>> _shards;
+
+			/**
+			 * Location of each shard, as recorded in the control
+			 * file.  Relative paths are within the store.
+			 */
+			std::vector<std::string> _shardPathnames;
+
+			/** Number of times the store has been resharded */
+			uint64_t _generation;
+
+			/** Shard holding the sequence cursor */
+			uint32_t _cursorShard;
+
+			/** Cursor to use when next sequencing _cursorShard */
+			int _shardCursor;
+
+			/**
+			 * @brief
+			 * Determine where a set of shards will be located.
+			 *
+			 * @param[in] shardCount
+			 *	Number of shards.
+			 * @param[in] shardPathnames
+			 *	Caller-supplied locations, or empty to place
+			 *	shards within the store.
+			 * @param[in] generation
+			 *	Reshard generation of the shards.
+			 *
+			 * @return
+			 *	Location of each shard, as recorded in the
+			 *	control file.
+			 *
+			 * @throw Error::ParameterError
+			 *	Invalid shard count or pathnames.
+			 */
+			static std::vector<std::string>
+			planShardPathnames(
+			    uint32_t shardCount,
+			    const std::vector<std::string> &shardPathnames,
+			    uint64_t generation);
+
+			/**
+			 * @return
+			 *	Path name of a shard location recorded in the
+			 *	control file.
+			 */
+			std::string
+			resolveShardPathname(
+			    const std::string &shardPathname)
+			    const;
+
+			/**
+			 * @brief
+			 * Create a set of empty shards.
+			 * @details
+			 * If any shard cannot be created, the shards that
+			 * were created are removed.
+			 *
+			 * @param[in] shardPathnames
+			 *	Location of each shard, as recorded in the
+			 *	control file.
+			 * @param[in] description
+			 *	Description of each shard.
+			 *
+			 * @return
+			 *	The new shards.
+			 */
+			std::vector<std::shared_ptr<RecordStore>>
+			createShards(
+			    const std::vector<std::string> &shardPathnames,
+			    const std::string &description)
+			    const;
+
+			/** Open the shards listed in _shardPathnames */
+			void
+			openShards();
+
+			/** Record the shard layout in the control file */
+			void
+			writeShardProperties();
+
+			/** Shard for key, without locking */
+			uint32_t
+			i_getShardIndex(
+			    const std::string &key)
+			    const;
+
+			/**
+			 * Internal implementation of sequencing through the
+			 * shards, returning the key, and optionally, the
+			 * data.
+			 * @param[in] returnData
+			 *	Whether to return the data with the key.
+			 * @param[in] cursor
+			 *	The location within the sequence of the
+			 *	key/data pair to return.
+			 * @return
+			 *	The record that is next in sequence.
+			 * @throw Error::ObjectDoesNotExist
+			 *	End of sequencing.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			RecordStore::Record
+			i_sequence(
+			    bool returnData,
+			    int cursor);
+		};
+	}
+}
+#endif	/* __BE_IO_SHARDEDRECSTORE_IMPL_H__ */
@@ -14,23 +14,27 @@ namespace BE = BiometricEvaluation;
 
 BiometricEvaluation::IO::SQLiteRecordStore::SQLiteRecordStore(
     const std::string &pathname,
-    const std::string &description)
+    const std::string &description,
+    RecordStore::Concurrency concurrency)
 {
 	/*
 	 * Exceptions float out.
 	 */
 	this->pimpl.reset(
-	    new IO::SQLiteRecordStore::Impl(pathname, description));
+	    new IO::SQLiteRecordStore::Impl(pathname, description,
+	    concurrency));
 }
 
 BiometricEvaluation::IO::SQLiteRecordStore::SQLiteRecordStore(
     const std::string &pathname,
-    IO::Mode mode)
+    IO::Mode mode,
+    RecordStore::Concurrency concurrency)
 {
 	/*
 	 * Exceptions float out.
 	*/
-	this->pimpl.reset(new IO::SQLiteRecordStore::Impl(pathname, mode));
+	this->pimpl.reset(new IO::SQLiteRecordStore::Impl(pathname, mode,
+	    concurrency));
 }
 
 BiometricEvaluation::IO::SQLiteRecordStore::~SQLiteRecordStore()
@@ -118,6 +122,20 @@ BiometricEvaluation::IO::SQLiteRecordStore::setCursorAtKey(
 	this->pimpl->setCursorAtKey(key);
 }
 
+std::string
+BiometricEvaluation::IO::SQLiteRecordStore::nextKey(
+    const std::string &key)
+{
+	return (this->pimpl->nextKey(key));
+}
+
+BiometricEvaluation::IO::RecordStore::Concurrency
+BiometricEvaluation::IO::SQLiteRecordStore::getConcurrency()
+    const
+{
+	return (this->pimpl->getConcurrency());
+}
+
 unsigned int
 BiometricEvaluation::IO::SQLiteRecordStore::getCount()
     const
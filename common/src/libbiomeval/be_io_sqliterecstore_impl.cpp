@@ -8,6 +8,7 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
 #include <cstdlib>
 #include <sstream>
 
@@ -57,14 +58,23 @@ const std::string
  */
 static const uint64_t MAX_REC_SIZE = (uint64_t)1000000000U;
 
+/* 
+ * Milliseconds a connection of a Shared RecordStore waits for another
+ * connection's lock before failing with SQLITE_BUSY.
+ */
+static const int SHARED_BUSY_TIMEOUT = 60000;
+
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::Impl(
     const std::string &pathname,
-    const std::string &description) :
-    RecordStore::Impl(pathname, description, RecordStore::Kind::SQLite),
+    const std::string &description,
+    RecordStore::Concurrency concurrency) :
+    RecordStore::Impl(pathname, description, RecordStore::Kind::SQLite,
+    concurrency),
     _db(nullptr),
     _dbname(""),
     _sequencer(nullptr),
-    _sequenceEnd(false)
+    _sequenceEnd(false),
+    _readers(std::make_shared<ReadConnections>())
 {
 #ifdef	SQLITE_V2_SUPPORT
 	sqlite3_initialize();
@@ -86,17 +96,20 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::Impl(
 		sqliteError(rv);
 	
 	this->createStructure();
+	this->configureSharedConnection();
 	_cursorRow = 0;
 }
 
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::Impl(
     const std::string &pathname,
-    IO::Mode mode) :
-    RecordStore::Impl(pathname, mode),
+    IO::Mode mode,
+    RecordStore::Concurrency concurrency) :
+    RecordStore::Impl(pathname, mode, concurrency),
     _db(nullptr),
     _dbname(""),
     _sequencer(nullptr),
-    _sequenceEnd(false)
+    _sequenceEnd(false),
+    _readers(std::make_shared<ReadConnections>())
 {
 #ifdef	SQLITE_V2_SUPPORT
 	sqlite3_initialize();
@@ -124,6 +137,7 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::Impl(
 	
 	if (this->validateSchema() == false)
 		throw Error::StrategyError("sqlite3: Invalid schema");
+	this->configureSharedConnection();
 		
 	_cursorRow = 0;
 }
@@ -143,6 +157,7 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::move(
 	if (getMode() == Mode::ReadOnly)
 		throw Error::StrategyError("RecordStore was opened read-only");
 
+	WriterLock lock(*this);
 	this->cleanup();
 
 	std::string oldDBName, newDBName;
@@ -178,6 +193,102 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::move(
 
 	if (this->validateSchema() == false)
 		throw Error::StrategyError("sqlite3: Invalid schema");
+	this->configureSharedConnection();
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::configureSharedConnection()
+{
+	if (this->getConcurrency() != RecordStore::Concurrency::Shared)
+		return;
+
+#ifdef	SQLITE_V2_SUPPORT
+	int32_t rv = sqlite3_busy_timeout(_db, SHARED_BUSY_TIMEOUT);
+	if (rv != SQLITE_OK)
+		sqliteError(rv);
+
+	/* The journal mode is persistent, so only writers need to set it */
+	if (this->getMode() == Mode::ReadWrite) {
+		rv = sqlite3_exec(_db, "PRAGMA journal_mode=WAL", nullptr,
+		    nullptr, nullptr);
+		if (rv != SQLITE_OK)
+			sqliteError(rv);
+	}
+#else
+	throw Error::StrategyError("sqlite3: This version of SQLite cannot "
+	    "be shared by threads");
+#endif
+}
+
+sqlite3*
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::getReadConnection()
+    const
+{
+	if (this->getConcurrency() != RecordStore::Concurrency::Shared)
+		return (_db);
+
+	std::lock_guard<std::mutex> lock(this->_readers->mutex);
+	const auto reader = this->_readers->connections.find(
+	    std::this_thread::get_id());
+	if (reader != this->_readers->connections.end())
+		return (reader->second);
+
+	sqlite3 *db = nullptr;
+#ifdef	SQLITE_V2_SUPPORT
+	/* Connection is only used by this thread, so needs no mutex */
+	int32_t rv = sqlite3_open_v2(_dbname.c_str(), &db,
+	    SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr);
+	if ((rv != SQLITE_OK) || (db == nullptr)) {
+		sqlite3_close(db);
+		sqliteError(rv);
+	}
+	rv = sqlite3_busy_timeout(db, SHARED_BUSY_TIMEOUT);
+	if (rv != SQLITE_OK) {
+		sqlite3_close(db);
+		sqliteError(rv);
+	}
+#endif
+	/* Closed when this thread exits, rather than kept until cleanup() */
+	static thread_local ThreadReadConnections threadReaders;
+	try {
+		threadReaders.add(this->_readers);
+		this->_readers->connections[std::this_thread::get_id()] = db;
+	} catch (const std::bad_alloc &) {
+		sqlite3_close(db);
+		throw Error::StrategyError("Could not record read connection");
+	}
+	return (db);
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::ThreadReadConnections::add(
+    const std::shared_ptr<ReadConnections> &readers)
+{
+	/* Forget RecordStores that have been destroyed */
+	this->_readers.erase(std::remove_if(this->_readers.begin(),
+	    this->_readers.end(),
+	    [](const std::weak_ptr<ReadConnections> &r) {
+		return (r.expired());
+	    }), this->_readers.end());
+	this->_readers.push_back(readers);
+}
+
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::ThreadReadConnections::
+    ~ThreadReadConnections()
+{
+	const std::thread::id self = std::this_thread::get_id();
+	for (const auto &weakReaders : this->_readers) {
+		const auto readers = weakReaders.lock();
+		if (readers == nullptr)
+			continue;
+
+		std::lock_guard<std::mutex> lock(readers->mutex);
+		const auto reader = readers->connections.find(self);
+		if (reader != readers->connections.end()) {
+			sqlite3_close(reader->second);
+			readers->connections.erase(reader);
+		}
+	}
 }
 
 uint64_t
@@ -185,8 +296,14 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::getSpaceUsed()
     const
 {
 	this->sync();
-	return (RecordStore::Impl::getSpaceUsed() + 
-	    IO::Utility::getFileSize(this->_dbname));
+	uint64_t total = RecordStore::Impl::getSpaceUsed() + 
+	    IO::Utility::getFileSize(this->_dbname);
+
+	/* Write-ahead log of a Shared RecordStore */
+	const std::string walName = this->_dbname + "-wal";
+	if (IO::Utility::fileExists(walName))
+		total += IO::Utility::getFileSize(walName);
+	return (total);
 }
 
 void
@@ -201,11 +318,40 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::insert(
 		throw Error::StrategyError("Invalid key format");
 	
 	/* Warn if key is already in database */
+	WriterLock lock(*this);
 	try {
-		this->length(key);
+		this->readSegments(key, nullptr, _db);
 		throw Error::ObjectExists(key);
 	} catch (Error::ObjectDoesNotExist) {}
-	
+
+	/*
+	 * Insert every segment and count the record in one transaction,
+	 * so that readers never see part of a record.
+	 */
+	int32_t rv = sqlite3_exec(_db, "BEGIN", nullptr, nullptr, nullptr);
+	if (rv != SQLITE_OK)
+		sqliteError(rv);
+	try {
+		this->insertSegments(key, data, size);
+		RecordStore::Impl::insert(key, data, size);
+	} catch (...) {
+		sqlite3_exec(_db, "ROLLBACK", nullptr, nullptr, nullptr);
+		throw;
+	}
+	try {
+		this->commit();
+	} catch (const Error::Exception &) {
+		RecordStore::Impl::remove(key);
+		throw;
+	}
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::insertSegments(
+    const std::string &key,
+    const void *const data,
+    const uint64_t size)
+{
 	sqlite3_stmt *statement = nullptr;
 	std::string activeTable = PRIMARY_KV_TABLE;
 	uint64_t segnum = 0;
@@ -273,9 +419,6 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::insert(
 			break;
 		}
 	}
-	
-	/* Propagate to parent class */
-	RecordStore::Impl::insert(key, data, size);
 }
 
 void
@@ -287,6 +430,30 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::remove(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
+	/* Delete every segment and count the removal in one transaction */
+	WriterLock lock(*this);
+	int32_t rv = sqlite3_exec(_db, "BEGIN", nullptr, nullptr, nullptr);
+	if (rv != SQLITE_OK)
+		sqliteError(rv);
+	try {
+		this->removeSegments(key);
+		RecordStore::Impl::remove(key);
+	} catch (...) {
+		sqlite3_exec(_db, "ROLLBACK", nullptr, nullptr, nullptr);
+		throw;
+	}
+	try {
+		this->commit();
+	} catch (const Error::Exception &) {
+		RecordStore::Impl::insert(key, nullptr, 0);
+		throw;
+	}
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::removeSegments(
+    const std::string &key)
+{
 	sqlite3_stmt *statement;
 	std::string activeTable = PRIMARY_KV_TABLE;
 	int64_t segnum = 0;
@@ -346,9 +513,21 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::remove(
 			break;
 		}
 	}
-	
-	/* Propagate changes to parent */		
-	RecordStore::Impl::remove(key);
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::commit()
+{
+	const int32_t rv = sqlite3_exec(_db, "COMMIT", nullptr, nullptr,
+	    nullptr);
+	if (rv == SQLITE_OK)
+		return;
+	try {
+		sqliteError(rv);
+	} catch (const Error::Exception &) {
+		sqlite3_exec(_db, "ROLLBACK", nullptr, nullptr, nullptr);
+		throw;
+	}
 }
 
 BiometricEvaluation::Memory::uint8Array
@@ -356,9 +535,29 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::read(
     const std::string &key)
     const
 {
+	sqlite3 *db = this->getReadConnection();
+	if (this->getConcurrency() != RecordStore::Concurrency::Shared) {
+		BiometricEvaluation::Memory::uint8Array data;
+		data.resize(this->readSegments(key, nullptr, db));
+		this->readSegments(key, data, db);
+		return(data);
+	}
+
+	/* Read the length and the segments from the same snapshot */
+	int32_t rv = sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr);
+	if (rv != SQLITE_OK)
+		sqliteError(rv, db);
 	BiometricEvaluation::Memory::uint8Array data;
-	data.resize(this->length(key));
-	this->readSegments(key, data);
+	try {
+		data.resize(this->readSegments(key, nullptr, db));
+		this->readSegments(key, data, db);
+	} catch (...) {
+		sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+		throw;
+	}
+	rv = sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+	if (rv != SQLITE_OK)
+		sqliteError(rv, db);
 	return(data);
 }
 
@@ -367,13 +566,14 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::length(
     const std::string &key)
     const
 {
-	return (this->readSegments(key, nullptr));
+	return (this->readSegments(key, nullptr, this->getReadConnection()));
 }
     
 uint64_t
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::readSegments(
     const std::string &key,
-    void * const data)
+    void * const data,
+    sqlite3 *db)
     const
 {	
 	if (!validateKeyString(key))
@@ -386,21 +586,23 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::readSegments(
 	uint8_t *dataPtr = (uint8_t *)data;
 	bool moreSegments = true;
 	while (moreSegments) {
-		std::string sqlCommand = "SELECT " + VALUE_COL + " FROM " + 
+		/* When only the length is needed, don't load the value */
+		std::string sqlCommand = "SELECT " + (data == nullptr ?
+		    "length(" + VALUE_COL + ")" : VALUE_COL) + " FROM " +
 		    activeTable + " WHERE " + KEY_COL + " = '" + 
 		    genKeySegName(key, segnum) + "' LIMIT 1";
 		    
 		/* Prepare the statement */
 #ifdef	SQLITE_V2_SUPPORT
-		int32_t rv = sqlite3_prepare_v2(_db, sqlCommand.c_str(),
+		int32_t rv = sqlite3_prepare_v2(db, sqlCommand.c_str(),
 		    sqlCommand.length(), &statement, nullptr);
 #else
-		int32_t rv = sqlite3_prepare(_db, sqlCommand.c_str(),
+		int32_t rv = sqlite3_prepare(db, sqlCommand.c_str(),
 		    sqlCommand.length(), &statement, nullptr);
 #endif
 		if (rv != SQLITE_OK) {
 			sqlite3_finalize(statement);
-			sqliteError(rv);
+			sqliteError(rv, db);
 		}
 		if (statement == nullptr)
 			throw Error::StrategyError("SQLite: Could not allocate "
@@ -416,7 +618,10 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::readSegments(
 			}
 			/* FALLTHROUGH */
 		default:
-			segBytes = sqlite3_column_bytes(statement, 0);
+			if (data == nullptr)
+				segBytes = sqlite3_column_int64(statement, 0);
+			else
+				segBytes = sqlite3_column_bytes(statement, 0);
 			totalBytes += segBytes;
 			
 			if (data != nullptr) {
@@ -431,7 +636,7 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::readSegments(
 		/* Free the statement */
 		rv = sqlite3_finalize(statement);
 		if (rv != SQLITE_OK)
-			sqliteError(rv);
+			sqliteError(rv, db);
 			
 		/* Increment segment number if there's more data */
 		if (segBytes == MAX_REC_SIZE) {
@@ -571,6 +776,7 @@ BiometricEvaluation::IO::RecordStore::Record
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::sequence(
     int cursor)
 {
+	WriterLock lock(*this);
 	return (i_sequence(true, cursor));
 }
 
@@ -578,6 +784,7 @@ std::string
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::sequenceKey(
     int cursor)
 {
+	WriterLock lock(*this);
 	BiometricEvaluation::IO::RecordStore::Record record =
 	    i_sequence(false, cursor);
 	return (record.key);
@@ -590,6 +797,7 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::setCursorAtKey(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
+	WriterLock lock(*this);
 	int32_t rv;
 	
 	sqlite3_stmt *statement;
@@ -643,6 +851,58 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::setCursorAtKey(
 	_sequenceEnd = false;
 }
 
+std::string
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::nextKey(
+    const std::string &key)
+    const
+{
+	if (!key.empty() && !validateKeyString(key))
+		throw Error::StrategyError("Invalid key format");
+
+	std::string sqlCommand = "SELECT " + KEY_COL + " FROM " +
+	    PRIMARY_KV_TABLE + " ";
+	if (!key.empty())
+		sqlCommand += "WHERE ROWID > (SELECT ROWID FROM " +
+		    PRIMARY_KV_TABLE + " WHERE " + KEY_COL + " = '" + key +
+		    "') ";
+	sqlCommand += "ORDER BY ROWID LIMIT 1";
+
+	sqlite3 *db = this->getReadConnection();
+	sqlite3_stmt *statement;
+#ifdef	SQLITE_V2_SUPPORT
+	int32_t rv = sqlite3_prepare_v2(db, sqlCommand.c_str(),
+	    sqlCommand.length(), &statement, nullptr);
+#else
+	int32_t rv = sqlite3_prepare(db, sqlCommand.c_str(),
+	    sqlCommand.length(), &statement, nullptr);
+#endif
+	if ((rv != SQLITE_OK) || (statement == nullptr))
+		sqliteError(rv, db);
+
+	/* A missing key selects a NULL ROWID, and so no rows */
+	rv = sqlite3_step(statement);
+	switch (rv) {
+	case SQLITE_ROW: {
+		const std::string next(
+		    (const char *)sqlite3_column_text(statement, 0));
+		rv = sqlite3_finalize(statement);
+		if (rv != SQLITE_OK)
+			sqliteError(rv, db);
+		return (next);
+	} case SQLITE_DONE:
+		rv = sqlite3_finalize(statement);
+		if (rv != SQLITE_OK)
+			sqliteError(rv, db);
+		throw Error::ObjectDoesNotExist("No record after " + key);
+	default:
+		sqlite3_finalize(statement);
+		sqliteError(rv, db);
+	}
+
+	/* Not reached */
+	throw Error::StrategyError();
+}
+
 void
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::cleanup()
 {
@@ -655,6 +915,14 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::cleanup()
 		    "sequencer");
 	_sequenceEnd = false;
 	_sequencer = nullptr;
+
+	/* Close the connections of reading threads */
+	{
+		std::lock_guard<std::mutex> lock(this->_readers->mutex);
+		for (const auto &reader : this->_readers->connections)
+			sqlite3_close(reader.second);
+		this->_readers->connections.clear();
+	}
 	
 	/* Close DB */
 	rv = sqlite3_close(_db);
@@ -665,11 +933,13 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::cleanup()
 
 void
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::sqliteError(
-    int32_t errorNumber)
+    int32_t errorNumber,
+    sqlite3 *db)
     const
 {	
 	std::stringstream msg;
-	msg << "sqlite3: " << sqlite3_errmsg(_db) << " (" << errorNumber << ')';
+	msg << "sqlite3: " << sqlite3_errmsg(db == nullptr ? _db : db) <<
+	    " (" << errorNumber << ')';
 	throw Error::StrategyError(msg.str());
 }
 
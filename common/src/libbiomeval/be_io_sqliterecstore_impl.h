@@ -13,6 +13,12 @@
 
 #include <sqlite3.h>
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "be_io_recordstore_impl.h"
 #include <be_io_sqliterecstore.h>
 
@@ -30,11 +36,15 @@ namespace BiometricEvaluation
 		public:
 			Impl(
 			    const std::string &pathname,
-			    const std::string &description);
+			    const std::string &description,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
 
 			Impl(
 			    const std::string &pathname,
-			    IO::Mode mode = Mode::ReadOnly);
+			    IO::Mode mode = Mode::ReadOnly,
+			    RecordStore::Concurrency concurrency =
+			    RecordStore::Concurrency::Exclusive);
 
 			void
 			move(const std::string &pathname);
@@ -69,6 +79,9 @@ namespace BiometricEvaluation
 			void
 			setCursorAtKey(const std::string &key);
 
+			std::string
+			nextKey(const std::string &key) const;
+
 			~Impl();
 
 			Impl(const SQLiteRecordStore&) = delete;
@@ -81,12 +94,21 @@ namespace BiometricEvaluation
 			 * @brief
 			 * Convert an SQLite error into a StrategyError.
 			 *
+			 * @param errorNumber
+			 *	SQLite result code.
+			 * @param db
+			 *	Connection on which the error occurred, or
+			 *	nullptr for _db.
+			 *
 			 * @throw Error::StrategyError
 			 *	Always thrown with the textual description of
 			 *	the last error condition.
 			 */
 			void
-			sqliteError(int32_t errorNumber) const;
+			sqliteError(
+			    int32_t errorNumber,
+			    sqlite3 *db = nullptr)
+			    const;
 			
 			/**
 			 * @brief
@@ -157,6 +179,8 @@ namespace BiometricEvaluation
 			 * @param data
 			 *	If not nullptr, deep copy the record for key
 			 *	into data.
+			 * @param db
+			 *	Connection to read from.
 			 * 
 			 * @throw Error::ObjectDoesNotExist
 			 *	Key does not exist in RecordStore.
@@ -169,7 +193,96 @@ namespace BiometricEvaluation
 			uint64_t
 			readSegments(
 			    const std::string &key,
-			    void * const data) const;
+			    void * const data,
+			    sqlite3 *db) const;
+
+			/**
+			 * @brief
+			 * Insert the rows of a record.
+			 * @details
+			 * Records larger than MAX_REC_SIZE are split into
+			 * segments, each a row.
+			 *
+			 * @param key
+			 *	Key of the record.
+			 * @param data
+			 *	Record data.
+			 * @param size
+			 *	Size of data.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error executing SQL commands.
+			 */
+			void
+			insertSegments(
+			    const std::string &key,
+			    const void *const data,
+			    const uint64_t size);
+
+			/**
+			 * @brief
+			 * Delete the rows of a record.
+			 *
+			 * @param key
+			 *	Key of the record.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 *	Key does not exist in RecordStore.
+			 * @throw Error::StrategyError
+			 *	Error executing SQL commands.
+			 */
+			void
+			removeSegments(
+			    const std::string &key);
+
+			/**
+			 * @brief
+			 * Commit the transaction begun on _db.
+			 * @details
+			 * The transaction is rolled back if it cannot be
+			 * committed.
+			 *
+			 * @throw Error::StrategyError
+			 *	The transaction could not be committed.
+			 */
+			void
+			commit();
+
+			/**
+			 * @brief
+			 * Obtain the connection used to read on this
+			 * thread.
+			 * @details
+			 * Shared RecordStores give each thread a read-only
+			 * connection of its own, opened on first use and
+			 * closed when the thread exits or by cleanup().
+			 * Exclusive RecordStores read
+			 * with _db.
+			 *
+			 * @return
+			 *	Connection for reading.
+			 *
+			 * @throw Error::StrategyError
+			 *	Could not open a connection.
+			 */
+			sqlite3*
+			getReadConnection()
+			    const;
+
+			/**
+			 * @brief
+			 * Prepare _db for use by a Shared RecordStore.
+			 * @details
+			 * Sets a busy timeout, and for read/write
+			 * RecordStores, switches to write-ahead logging so
+			 * that readers and the writer do not block each
+			 * other.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error executing SQL commands.
+			 */
+			void
+			configureSharedConnection();
 
 			/**
 			 * @brief
@@ -195,6 +308,49 @@ namespace BiometricEvaluation
 			bool _sequenceEnd;
 			/** Row for key in setCursorForKey() */
 			uint64_t _cursorRow;
+			/** Read connections of threads using a Shared store */
+			struct ReadConnections
+			{
+				/** Connection opened by each thread */
+				std::map<std::thread::id, sqlite3*> connections;
+				/** Protects connections */
+				std::mutex mutex;
+			};
+
+			/**
+			 * @brief
+			 * The read connections opened by one thread.
+			 * @details
+			 * Each thread has one instance, which closes the
+			 * thread's connections to any RecordStore still
+			 * open when the thread exits.
+			 */
+			class ThreadReadConnections
+			{
+			public:
+				/**
+				 * @brief
+				 * Note that this thread added a connection.
+				 *
+				 * @param readers
+				 *	Read connections of a RecordStore.
+				 */
+				void
+				add(
+				    const std::shared_ptr<ReadConnections>
+				    &readers);
+
+				/** Close this thread's connections */
+				~ThreadReadConnections();
+
+			private:
+				/** Connections of RecordStores used */
+				std::vector<std::weak_ptr<ReadConnections>>
+				    _readers;
+			};
+
+			/** Per-thread read connections of Shared stores */
+			std::shared_ptr<ReadConnections> _readers;
 			
 			/** Name given to the primate SQLite table */
 			static const std::string PRIMARY_KV_TABLE;
@@ -14,6 +14,7 @@
 #include <dirent.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <cstdint>
 #include <cstdio>
@@ -23,6 +24,7 @@
 #include <iterator>
 #include <list>
 #include <sstream>
+#include <vector>
 
 #include <be_error.h>
 #include <be_error_signal_manager.h>
@@ -315,6 +317,90 @@ BiometricEvaluation::IO::Utility::sumDirectoryUsage(const std::string &pathname)
 	return (total);
 }
 
+/*
+ * Append a line naming each file below pathname, with its size and
+ * modification time, to entries. Names are relative to the directory
+ * first passed in, given by prefix.
+ */
+static void
+listFileStates(
+    const std::string &pathname,
+    const std::string &prefix,
+    const std::vector<std::string> &excluded,
+    std::vector<std::string> &entries)
+{
+	DIR *dir = opendir(pathname.c_str());
+	if (dir == NULL)
+		throw BE::Error::StrategyError("Could not open " + pathname +
+		    " (" + BE::Error::errorStr() + ")");
+
+	struct dirent *entry;
+	struct stat sb;
+	while ((entry = readdir(dir)) != NULL) {
+		if ((strcmp(entry->d_name, ".") == 0) ||
+		    (strcmp(entry->d_name, "..") == 0))
+			continue;
+
+		const std::string name = prefix + entry->d_name;
+		if (std::find(excluded.begin(), excluded.end(), name) !=
+		    excluded.end())
+			continue;
+		const std::string filename = pathname + "/" + entry->d_name;
+		if (lstat(filename.c_str(), &sb) != 0) {
+			closedir(dir);
+			throw BE::Error::StrategyError("Could not stat " +
+			    filename);
+		}
+
+		if (S_ISDIR(sb.st_mode)) {
+			try {
+				listFileStates(filename, name + "/", excluded,
+				    entries);
+			} catch (const BE::Error::Exception &) {
+				closedir(dir);
+				throw;
+			}
+			continue;
+		}
+#ifdef __APPLE__
+		const struct timespec &mtime = sb.st_mtimespec;
+#else
+		const struct timespec &mtime = sb.st_mtim;
+#endif
+		entries.push_back(name + '\0' + std::to_string(sb.st_size) +
+		    '\0' + std::to_string(mtime.tv_sec) + '.' +
+		    std::to_string(mtime.tv_nsec));
+	}
+
+	if (closedir(dir))
+		throw BE::Error::StrategyError("Could not close " + pathname +
+		    " (" + BE::Error::errorStr() + ")");
+}
+
+uint64_t
+BiometricEvaluation::IO::Utility::getDirectoryFingerprint(
+    const std::string &pathname,
+    const std::vector<std::string> &excluded)
+{
+	struct stat sb;
+	if (stat(pathname.c_str(), &sb) != 0)
+		throw Error::ObjectDoesNotExist(pathname + " does not exist");
+
+	std::vector<std::string> entries;
+	listFileStates(pathname, "", excluded, entries);
+	std::sort(entries.begin(), entries.end());
+
+	/* 64-bit FNV-1a over every entry, each ending with a newline */
+	uint64_t hash = 14695981039346656037ULL;
+	for (const auto &entry : entries) {
+		for (const char c : entry + '\n') {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 1099511628211ULL;
+		}
+	}
+	return (hash);
+}
+
 int
 BiometricEvaluation::IO::Utility::makePath(
     const std::string &path,
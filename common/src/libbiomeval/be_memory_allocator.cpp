@@ -0,0 +1,469 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <be_error_exception.h>
+#include <be_memory_allocator.h>
+
+namespace BE = BiometricEvaluation;
+
+const size_t BiometricEvaluation::Memory::PoolAllocator::MIN_POOLED_SIZE;
+const size_t BiometricEvaluation::Memory::PoolAllocator::MAX_POOLED_SIZE;
+const size_t BiometricEvaluation::Memory::PoolAllocator::MAX_POOLED_PER_CLASS;
+const size_t BiometricEvaluation::Memory::PoolAllocator::MAX_POOLED_BYTES;
+const size_t BiometricEvaluation::Memory::AlignedAllocator::CACHE_LINE_SIZE;
+const size_t BiometricEvaluation::Memory::AlignedAllocator::HUGE_PAGE_SIZE;
+
+/** Process default Allocator, or nullptr for NewAllocator */
+static std::atomic<BE::Memory::Allocator*> processDefaultAllocator{nullptr};
+/** Calling thread's default Allocator, or nullptr for the process default */
+static thread_local BE::Memory::Allocator *threadDefaultAllocator = nullptr;
+
+/*
+ * Allocator.
+ */
+
+void*
+BiometricEvaluation::Memory::Allocator::allocate(
+    size_t size,
+    size_t alignment)
+{
+	this->_allocations.fetch_add(1, std::memory_order_relaxed);
+	this->_bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+	return (this->doAllocate(size, alignment));
+}
+
+void
+BiometricEvaluation::Memory::Allocator::deallocate(
+    void *pointer,
+    size_t size,
+    size_t alignment)
+    noexcept
+{
+	if (pointer == nullptr)
+		return;
+	this->_deallocations.fetch_add(1, std::memory_order_relaxed);
+	this->doDeallocate(pointer, size, alignment);
+}
+
+BiometricEvaluation::Memory::AllocatorStatistics
+BiometricEvaluation::Memory::Allocator::getStatistics()
+    const
+{
+	AllocatorStatistics statistics;
+	statistics.allocations = this->_allocations.load(
+	    std::memory_order_relaxed);
+	statistics.deallocations = this->_deallocations.load(
+	    std::memory_order_relaxed);
+	statistics.bytesAllocated = this->_bytesAllocated.load(
+	    std::memory_order_relaxed);
+	statistics.systemAllocations = this->_systemAllocations.load(
+	    std::memory_order_relaxed);
+	return (statistics);
+}
+
+void
+BiometricEvaluation::Memory::Allocator::resetStatistics()
+{
+	this->_allocations.store(0, std::memory_order_relaxed);
+	this->_deallocations.store(0, std::memory_order_relaxed);
+	this->_bytesAllocated.store(0, std::memory_order_relaxed);
+	this->_systemAllocations.store(0, std::memory_order_relaxed);
+}
+
+BiometricEvaluation::Memory::Allocator&
+BiometricEvaluation::Memory::Allocator::getDefault()
+{
+	if (threadDefaultAllocator != nullptr)
+		return (*threadDefaultAllocator);
+	Allocator *allocator = processDefaultAllocator.load(
+	    std::memory_order_acquire);
+	if (allocator != nullptr)
+		return (*allocator);
+	return (NewAllocator::instance());
+}
+
+void
+BiometricEvaluation::Memory::Allocator::setDefault(
+    Allocator *allocator)
+{
+	processDefaultAllocator.store(allocator, std::memory_order_release);
+}
+
+void
+BiometricEvaluation::Memory::Allocator::countSystemAllocation()
+{
+	this->_systemAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void*
+BiometricEvaluation::Memory::Allocator::systemAllocate(
+    size_t size,
+    size_t alignment)
+{
+	void *pointer = nullptr;
+	if (alignment <= alignof(std::max_align_t)) {
+		pointer = std::malloc(size);
+	} else {
+		if (posix_memalign(&pointer, std::max(alignment,
+		    sizeof(void*)), size) != 0)
+			pointer = nullptr;
+	}
+	if (pointer == nullptr)
+		throw Error::MemoryError("Could not allocate data");
+	return (pointer);
+}
+
+void
+BiometricEvaluation::Memory::Allocator::systemDeallocate(
+    void *pointer)
+    noexcept
+{
+	std::free(pointer);
+}
+
+/*
+ * NewAllocator.
+ */
+
+BiometricEvaluation::Memory::NewAllocator&
+BiometricEvaluation::Memory::NewAllocator::instance()
+{
+	/* Never destroyed, so arrays may be freed during static destruction */
+	static NewAllocator *allocator = new NewAllocator();
+	return (*allocator);
+}
+
+void*
+BiometricEvaluation::Memory::NewAllocator::doAllocate(
+    size_t size,
+    size_t alignment)
+{
+	this->countSystemAllocation();
+	return (systemAllocate(size, alignment));
+}
+
+void
+BiometricEvaluation::Memory::NewAllocator::doDeallocate(
+    void *pointer,
+    size_t size,
+    size_t alignment)
+    noexcept
+{
+	systemDeallocate(pointer);
+}
+
+/*
+ * PoolAllocator.
+ */
+
+/** Number of PoolAllocator size classes */
+static const size_t POOL_CLASS_COUNT = 19;
+static_assert((BE::Memory::PoolAllocator::MIN_POOLED_SIZE <<
+    (POOL_CLASS_COUNT - 1)) == BE::Memory::PoolAllocator::MAX_POOLED_SIZE,
+    "POOL_CLASS_COUNT does not span MIN_POOLED_SIZE to MAX_POOLED_SIZE");
+
+/** Free buffers pooled by one thread. */
+struct ThreadPool
+{
+	ThreadPool()
+	{
+		/* Deallocation cannot throw, so never grow these */
+		for (auto &buffers : this->free)
+			buffers.reserve(
+			    BE::Memory::PoolAllocator::MAX_POOLED_PER_CLASS);
+	}
+
+	~ThreadPool()
+	{
+		for (auto &buffers : this->free)
+			for (void *buffer : buffers)
+				std::free(buffer);
+	}
+
+	/** Free buffers, by size class */
+	std::vector<void*> free[POOL_CLASS_COUNT];
+	/** Bytes of free buffers */
+	size_t bytes{0};
+};
+
+/** Calling thread's pool, created on first use */
+static thread_local ThreadPool *threadPool = nullptr;
+/** Whether the calling thread's pool has been released */
+static thread_local bool threadPoolReleased = false;
+
+/** Releases the calling thread's pool when the thread exits. */
+struct ThreadPoolOwner
+{
+	~ThreadPoolOwner()
+	{
+		delete threadPool;
+		threadPool = nullptr;
+		threadPoolReleased = true;
+	}
+};
+static thread_local ThreadPoolOwner threadPoolOwner;
+
+/**
+ * @return
+ * Calling thread's pool, or nullptr if it could not be created or the
+ * thread is exiting.
+ */
+static ThreadPool*
+getThreadPool()
+    noexcept
+{
+	if ((threadPool == nullptr) && !threadPoolReleased) {
+		/* Touch the owner so it is destroyed at thread exit */
+		(void)&threadPoolOwner;
+		try {
+			threadPool = new ThreadPool();
+		} catch (const std::bad_alloc&) {
+			return (nullptr);
+		}
+	}
+	return (threadPool);
+}
+
+/** @return Size class for a request of size bytes */
+static size_t
+getPoolClass(
+    size_t size)
+{
+	size_t poolClass = 0;
+	while ((BE::Memory::PoolAllocator::MIN_POOLED_SIZE << poolClass) < size)
+		poolClass++;
+	return (poolClass);
+}
+
+BiometricEvaluation::Memory::PoolAllocator&
+BiometricEvaluation::Memory::PoolAllocator::instance()
+{
+	/* Never destroyed, so arrays may be freed during static destruction */
+	static PoolAllocator *allocator = new PoolAllocator();
+	return (*allocator);
+}
+
+void*
+BiometricEvaluation::Memory::PoolAllocator::doAllocate(
+    size_t size,
+    size_t alignment)
+{
+	const size_t cacheLine = AlignedAllocator::CACHE_LINE_SIZE;
+	if ((size > MAX_POOLED_SIZE) || (alignment > cacheLine)) {
+		this->countSystemAllocation();
+		return (systemAllocate(size, std::max(alignment, cacheLine)));
+	}
+
+	const size_t poolClass = getPoolClass(size);
+	const size_t classSize = MIN_POOLED_SIZE << poolClass;
+	ThreadPool *pool = getThreadPool();
+	if ((pool != nullptr) && !pool->free[poolClass].empty()) {
+		void *buffer = pool->free[poolClass].back();
+		pool->free[poolClass].pop_back();
+		pool->bytes -= classSize;
+		return (buffer);
+	}
+
+	this->countSystemAllocation();
+	return (systemAllocate(classSize, cacheLine));
+}
+
+void
+BiometricEvaluation::Memory::PoolAllocator::doDeallocate(
+    void *pointer,
+    size_t size,
+    size_t alignment)
+    noexcept
+{
+	if ((size > MAX_POOLED_SIZE) ||
+	    (alignment > AlignedAllocator::CACHE_LINE_SIZE)) {
+		systemDeallocate(pointer);
+		return;
+	}
+
+	const size_t poolClass = getPoolClass(size);
+	const size_t classSize = MIN_POOLED_SIZE << poolClass;
+	ThreadPool *pool = getThreadPool();
+	if ((pool == nullptr) ||
+	    (pool->free[poolClass].size() >= MAX_POOLED_PER_CLASS) ||
+	    ((pool->bytes + classSize) > MAX_POOLED_BYTES)) {
+		systemDeallocate(pointer);
+		return;
+	}
+	pool->free[poolClass].push_back(pointer);
+	pool->bytes += classSize;
+}
+
+/*
+ * ArenaAllocator.
+ */
+
+BiometricEvaluation::Memory::ArenaAllocator::ArenaAllocator(
+    size_t chunkSize) :
+    _chunkSize(std::max<size_t>(chunkSize, 1)),
+    _chunks(),
+    _offset(0),
+    _bytesInUse(0)
+{
+
+}
+
+void*
+BiometricEvaluation::Memory::ArenaAllocator::doAllocate(
+    size_t size,
+    size_t alignment)
+{
+	if (!this->_chunks.empty()) {
+		const Chunk &chunk = this->_chunks.back();
+		const uintptr_t start = reinterpret_cast<uintptr_t>(chunk.data);
+		const uintptr_t aligned = (start + this->_offset +
+		    alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+		if (((aligned - start) + size) <= chunk.size) {
+			this->_offset = (aligned - start) + size;
+			this->_bytesInUse += size;
+			return (reinterpret_cast<void*>(aligned));
+		}
+	}
+
+	/* Large requests get their own chunk, leaving the current chunk */
+	const bool dedicated = (size > (this->_chunkSize / 2));
+	const size_t chunkAlignment = std::max(alignment,
+	    alignof(std::max_align_t));
+	Chunk chunk;
+	chunk.size = (dedicated ? size : this->_chunkSize);
+	chunk.data = static_cast<uint8_t*>(systemAllocate(chunk.size,
+	    chunkAlignment));
+	this->countSystemAllocation();
+	const bool current = (!dedicated || this->_chunks.empty());
+	try {
+		if (current)
+			this->_chunks.push_back(chunk);
+		else
+			this->_chunks.insert(this->_chunks.end() - 1, chunk);
+	} catch (...) {
+		systemDeallocate(chunk.data);
+		throw Error::MemoryError("Could not allocate data");
+	}
+	/* A dedicated chunk that becomes current is already full */
+	if (current)
+		this->_offset = size;
+	this->_bytesInUse += size;
+	return (chunk.data);
+}
+
+void
+BiometricEvaluation::Memory::ArenaAllocator::doDeallocate(
+    void *pointer,
+    size_t size,
+    size_t alignment)
+    noexcept
+{
+	/* Memory is released by reset() */
+}
+
+void
+BiometricEvaluation::Memory::ArenaAllocator::reset()
+{
+	if (this->_chunks.empty())
+		return;
+
+	const auto largest = std::max_element(this->_chunks.begin(),
+	    this->_chunks.end(), [](const Chunk &lhs, const Chunk &rhs) {
+	    return (lhs.size < rhs.size); });
+	const Chunk kept = *largest;
+	for (auto chunk = this->_chunks.begin(); chunk != this->_chunks.end();
+	    chunk++)
+		if (chunk != largest)
+			systemDeallocate(chunk->data);
+	this->_chunks.assign(1, kept);
+	this->_offset = 0;
+	this->_bytesInUse = 0;
+}
+
+size_t
+BiometricEvaluation::Memory::ArenaAllocator::getBytesInUse()
+    const
+{
+	return (this->_bytesInUse);
+}
+
+BiometricEvaluation::Memory::ArenaAllocator::~ArenaAllocator()
+{
+	for (const auto &chunk : this->_chunks)
+		systemDeallocate(chunk.data);
+}
+
+/*
+ * AlignedAllocator.
+ */
+
+BiometricEvaluation::Memory::AlignedAllocator::AlignedAllocator(
+    size_t alignment,
+    bool hugePages) :
+    _alignment(alignment),
+    _hugePages(hugePages)
+{
+	if ((alignment == 0) || ((alignment & (alignment - 1)) != 0))
+		throw Error::ParameterError("Alignment must be a power of 2");
+}
+
+void*
+BiometricEvaluation::Memory::AlignedAllocator::doAllocate(
+    size_t size,
+    size_t alignment)
+{
+	alignment = std::max(alignment, this->_alignment);
+	if (this->_hugePages && (size >= HUGE_PAGE_SIZE)) {
+		alignment = std::max(alignment, HUGE_PAGE_SIZE);
+		/* Whole huge pages, so the last page can be huge too */
+		size = ((size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) *
+		    HUGE_PAGE_SIZE;
+	}
+
+	void *pointer = systemAllocate(size, alignment);
+	this->countSystemAllocation();
+#ifdef MADV_HUGEPAGE
+	/* Advisory only; the memory is usable either way */
+	if (this->_hugePages && (size >= HUGE_PAGE_SIZE))
+		(void)madvise(pointer, size, MADV_HUGEPAGE);
+#endif /* MADV_HUGEPAGE */
+	return (pointer);
+}
+
+void
+BiometricEvaluation::Memory::AlignedAllocator::doDeallocate(
+    void *pointer,
+    size_t size,
+    size_t alignment)
+    noexcept
+{
+	systemDeallocate(pointer);
+}
+
+/*
+ * ScopedDefaultAllocator.
+ */
+
+BiometricEvaluation::Memory::ScopedDefaultAllocator::ScopedDefaultAllocator(
+    Allocator &allocator) :
+    _previous(threadDefaultAllocator)
+{
+	threadDefaultAllocator = &allocator;
+}
+
+BiometricEvaluation::Memory::ScopedDefaultAllocator::~ScopedDefaultAllocator()
+{
+	threadDefaultAllocator = this->_previous;
+}
@@ -135,3 +135,12 @@ BiometricEvaluation::Memory::IndexedBuffer::IndexedBuffer(
 {
 
 }
+
+BiometricEvaluation::Memory::IndexedBuffer::IndexedBuffer(
+    BiometricEvaluation::Memory::ByteView view) :
+    _data(view.data()),
+    _size(view.size()),
+    _index(0)
+{
+
+}
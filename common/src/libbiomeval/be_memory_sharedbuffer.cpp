@@ -0,0 +1,87 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <be_memory_sharedbuffer.h>
+
+BiometricEvaluation::Memory::SharedBuffer::SharedBuffer() :
+    _owner(),
+    _view()
+{
+
+}
+
+BiometricEvaluation::Memory::SharedBuffer::SharedBuffer(
+    uint8Array &&data) :
+    _owner(std::make_shared<const uint8Array>(std::move(data))),
+    _view(*this->_owner)
+{
+
+}
+
+BiometricEvaluation::Memory::SharedBuffer::SharedBuffer(
+    ByteView data)
+{
+	uint8Array copy;
+	copy.copy(data.data(), data.size());
+	this->_owner = std::make_shared<const uint8Array>(std::move(copy));
+	this->_view = ByteView(*this->_owner);
+}
+
+const uint8_t*
+BiometricEvaluation::Memory::SharedBuffer::data()
+    const
+    noexcept
+{
+	return (this->_view.data());
+}
+
+BiometricEvaluation::Memory::SharedBuffer::size_type
+BiometricEvaluation::Memory::SharedBuffer::size()
+    const
+    noexcept
+{
+	return (this->_view.size());
+}
+
+bool
+BiometricEvaluation::Memory::SharedBuffer::empty()
+    const
+    noexcept
+{
+	return (this->_view.empty());
+}
+
+BiometricEvaluation::Memory::ByteView
+BiometricEvaluation::Memory::SharedBuffer::getView()
+    const
+    noexcept
+{
+	return (this->_view);
+}
+
+BiometricEvaluation::Memory::SharedBuffer::operator ByteView()
+    const
+    noexcept
+{
+	return (this->_view);
+}
+
+BiometricEvaluation::Memory::SharedBuffer
+BiometricEvaluation::Memory::SharedBuffer::slice(
+    size_type offset,
+    size_type count)
+    const
+{
+	SharedBuffer slice;
+	slice._view = this->_view.subview(offset, count);
+	if (!slice._view.empty())
+		slice._owner = this->_owner;
+	return (slice);
+}
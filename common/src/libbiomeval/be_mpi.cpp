@@ -14,6 +14,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include <be_io_filelogsheet.h>
 #include <be_io_syslogsheet.h>
@@ -50,7 +51,8 @@ const std::map<BiometricEvaluation::MPI::MessageTag, std::string>
 BE_MPI_MessageTag_EnumToStringMap  = {
 	{BiometricEvaluation::MPI::MessageTag::Control, "Control"},
 	{BiometricEvaluation::MPI::MessageTag::Data, "Data"},
-	{BiometricEvaluation::MPI::MessageTag::OOB, "Out-of-band"}
+	{BiometricEvaluation::MPI::MessageTag::OOB, "Out-of-band"},
+	{BiometricEvaluation::MPI::MessageTag::Completion, "Completion"}
 };
 BE_FRAMEWORK_ENUMERATION_DEFINITIONS(
     BiometricEvaluation::MPI::MessageTag,
@@ -175,3 +177,40 @@ BiometricEvaluation::MPI::openLogsheet(
 	return (logsheet);
 }
 
+
+void
+BiometricEvaluation::MPI::mergeHistogram(
+    Time::Histogram &histogram,
+    const int root)
+{
+	const BE::Memory::uint8Array serialized = histogram.serialize();
+	int size = static_cast<int>(serialized.size());
+	const int rank = ::MPI::COMM_WORLD.Get_rank();
+	const int taskCount = ::MPI::COMM_WORLD.Get_size();
+
+	/* Sizes differ with the number of occupied buckets */
+	std::vector<int> sizes(rank == root ? taskCount : 0);
+	::MPI::COMM_WORLD.Gather(&size, 1, ::MPI::INT,
+	    sizes.data(), 1, ::MPI::INT, root);
+
+	std::vector<int> offsets(sizes.size());
+	int total = 0;
+	for (std::vector<int>::size_type i = 0; i < sizes.size(); i++) {
+		offsets[i] = total;
+		total += sizes[i];
+	}
+	BE::Memory::uint8Array gathered(total);
+	::MPI::COMM_WORLD.Gatherv(serialized, size, ::MPI::UNSIGNED_CHAR,
+	    gathered, sizes.data(), offsets.data(), ::MPI::UNSIGNED_CHAR,
+	    root);
+	if (rank != root)
+		return;
+
+	for (int i = 0; i < taskCount; i++) {
+		if (i == root)
+			continue;
+		BE::Memory::uint8Array task(sizes[i]);
+		task.copy(&gathered[offsets[i]], sizes[i]);
+		histogram.merge(BE::Time::Histogram(task));
+	}
+}
@@ -31,10 +31,10 @@ BiometricEvaluation::MPI::CSVProcessor::processWorkPackage(
     BiometricEvaluation::MPI::WorkPackage &workPackage)
 {
 	/*
-	 * Extract the key/value data from the work package
+	 * Extract the key/value data from the work package, which
+	 * may be in memory shared with the Receiver, without copying.
 	 */
-	 Memory::uint8Array packageData(0);
-	 workPackage.getData(packageData);
+	const Memory::ByteView packageData = workPackage.getDataView();
 	 uint64_t numElements = workPackage.getNumElements();
 
 	/*
@@ -7,9 +7,14 @@
  * its use by other parties, and makes no guarantees, expressed or implied,
  * about its quality, reliability, or any other characteristic.
  */
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
 #include <set>
 #include <string>
 #include <sstream>
+#include <thread>
 
 #include <mpi.h>
 
@@ -22,14 +27,53 @@
 #include <be_mpi_workpackage.h>
 #include <be_memory_autoarray.h>
 
+#include "be_mpi_topology.h"
+
 namespace BE = BiometricEvaluation;
 using namespace BE::Framework::Enumeration;
 
+/* Polls finding no messages before the distributor starts to sleep */
+static const uint32_t BusyPolls = 16;
+/* Shortest sleep between polls finding no messages */
+static const std::chrono::microseconds MinPollSleep(50);
+/* Longest sleep between polls finding no messages */
+static const std::chrono::microseconds MaxPollSleep(2000);
+
+/*
+ * Pause after a poll for messages found none. The first few pauses
+ * only yield, then sleeps double from MinPollSleep to MaxPollSleep,
+ * so an idle distributor uses little CPU but a busy one stays
+ * responsive.
+ */
+static void
+backOff(
+    uint32_t idlePolls)
+{
+	if (idlePolls < BusyPolls) {
+		std::this_thread::yield();
+		return;
+	}
+
+	const uint32_t doublings = std::min<uint32_t>(idlePolls - BusyPolls,
+	    16);
+	std::this_thread::sleep_for(std::min(MaxPollSleep,
+	    MinPollSleep * (1 << doublings)));
+}
+
 /******************************************************************************/
 /* Class method definitions.                                                  */
 /******************************************************************************/
 BiometricEvaluation::MPI::Distributor::Distributor(
-    const std::string &propertiesFileName)
+    const std::string &propertiesFileName) :
+    _relay(false),
+    _upstreamCommand(MPI::TaskCommand::Continue),
+    _batchData(0),
+    _packageQueueCapacity(0),
+    _producerDone(false),
+    _producerStopping(false),
+    _lastPackageID(0),
+    _placedPackages(0),
+    _localPackages(0)
 {
 	this->_resources = BE::Memory::make_unique<Resources>(
 	    propertiesFileName);
@@ -57,14 +101,46 @@ BiometricEvaluation::MPI::Distributor::getLogsheet() const
 /******************************************************************************/
 BiometricEvaluation::MPI::Distributor::~Distributor()
 {
+	if (this->_producer.joinable())
+		this->stopProducer();
 }
 
 void
 BiometricEvaluation::MPI::Distributor::start()
 {
+	this->start(std::make_shared<Topology>());
+}
+
+void
+BiometricEvaluation::MPI::Distributor::start(
+    const std::shared_ptr<Topology> &topology)
+{
+	this->_topology = topology;
+	this->_relay = (topology->getRole() ==
+	    Topology::Role::NodeDistributor);
+	::MPI::Intracomm &downstream = topology->getDownstream();
+
 	/* Release other tasks to start up */
 	::MPI::COMM_WORLD.Barrier();
 
+	/*
+	 * A node distributor starts the tasks of its node once Task-0
+	 * tells it to start. Its Logsheet is opened here, as its role
+	 * was not known when it was constructed.
+	 */
+	if (this->_relay) {
+		try {
+			this->_logsheet = BE::MPI::openLogsheet(
+			    this->_resources->getLogsheetURL(),
+			    "MPI::NodeDistributor");
+		} catch (const Error::Exception &) {
+			this->_logsheet.reset(new IO::Logsheet());
+		}
+		MPI::taskcmd_t startCmd;
+		topology->getUpstream().Recv(&startCmd, 1, MPI_INT32_T, 0,
+		    to_int_type(MPI::MessageTag::Control));
+	}
+
 	/*
  	 * Tell each child task to start requesting by sending an OK.
  	 */
@@ -73,21 +149,31 @@ BiometricEvaluation::MPI::Distributor::start()
 	BE::IO::Logsheet *log = this->_logsheet.get();
 	MPI::logMessage(*log, "Sending messages to Task-N processes");
 	MPI::taskstat_t taskStatus;
-	for (int task = 1; task < this->_resources->getNumTasks(); task++) {
+	for (int task = 1; task < downstream.Get_size(); task++) {
 		*log << "Tell Task-" << task << " to startup";
 		MPI::logEntry(*log);
 
 		MPI::taskcmd_t taskCmd =
 		    to_int_type(MPI::TaskCommand::Continue);
-		::MPI::COMM_WORLD.Send((void *)&taskCmd, 1, MPI_INT32_T,
+		downstream.Send((void *)&taskCmd, 1, MPI_INT32_T,
 		     task, to_int_type(MPI::MessageTag::Control));
-		::MPI::COMM_WORLD.Recv(&taskStatus, 1, MPI_INT32_T,
+		downstream.Recv(&taskStatus, 1, MPI_INT32_T,
 		    task, to_int_type(MPI::MessageTag::Control));
 		if (taskStatus == to_int_type(MPI::TaskStatus::OK))
 			this->_activeMpiTasks.insert(task);
 	}
 	MPI::logMessage(*log, "Done sending start messages");
 
+	/* A node with no working tasks takes no work from Task-0 */
+	if (this->_relay) {
+		taskStatus = to_int_type(this->_activeMpiTasks.empty() ?
+		    MPI::TaskStatus::Failed : MPI::TaskStatus::OK);
+		topology->getUpstream().Send((void *)&taskStatus, 1,
+		    MPI_INT32_T, 0, to_int_type(MPI::MessageTag::Control));
+		if (this->_activeMpiTasks.empty())
+			this->_upstreamCommand = MPI::TaskCommand::Exit;
+	}
+
 	if (this->_activeMpiTasks.empty())
 		MPI::logMessage(*log, "No receiver tasks available");
 	else
@@ -100,41 +186,432 @@ void
 BiometricEvaluation::MPI::Distributor::sendWorkPackage(
     BE::MPI::WorkPackage &workPackage, int MPITask)
 {
+	::MPI::Intracomm &downstream = this->_topology->getDownstream();
+
 	/*
 	 * Send three pieces of information:
 	 * The raw data and length, in the first message;
-	 * The number of elements in the second message.
+	 * The number of elements in the second message;
+	 * The package ID in the third message.
 	 */
-	BE::Memory::uint8Array data(0);
-	workPackage.getData(data);
+	const BE::Memory::ByteView data = workPackage.getDataView();
 	int size = static_cast<int>(data.size());
-	::MPI::COMM_WORLD.Send(
-	    (void *)data, size, MPI_CHAR, MPITask,
+	downstream.Send(
+	    (void *)data.data(), size, MPI_CHAR, MPITask,
 	    to_int_type(BE::MPI::MessageTag::Data));
 
 	uint64_t numElements = workPackage.getNumElements();
-	::MPI::COMM_WORLD.Send(
+	downstream.Send(
 	    (void *)&numElements, 1, MPI_UINT64_T,
 	    MPITask, to_int_type(BE::MPI::MessageTag::Data));
 
-	BE::IO::Logsheet *log = this->_logsheet.get();
+	uint64_t packageID = workPackage.getID();
+	downstream.Send(
+	    (void *)&packageID, 1, MPI_UINT64_T,
+	    MPITask, to_int_type(BE::MPI::MessageTag::Data));
+
 	std::ostringstream sstr;
 	sstr << "Sent package of size " << size << " to Task-" << MPITask;
-	MPI::logMessage(*log, sstr.str());
+	this->deferLogMessage(sstr.str());
+}
+
+void
+BiometricEvaluation::MPI::Distributor::sendWorkPackages(
+    const std::vector<std::unique_ptr<BE::MPI::WorkPackage>> &batch,
+    int MPITask)
+{
+	uint64_t size = 0;
+	for (const auto &workPackage : batch)
+		size += (3 * sizeof(uint64_t)) + workPackage->getSize();
+
+	BE::Memory::uint8Array data(size);
+	uint64_t offset = 0;
+	for (const auto &workPackage : batch) {
+		const BE::Memory::ByteView view = workPackage->getDataView();
+		const uint64_t header[3] = {workPackage->getNumElements(),
+		    workPackage->getID(), view.size()};
+		std::memcpy(&data[offset], header, sizeof(header));
+		offset += sizeof(header);
+		std::memcpy(&data[offset], view.data(), view.size());
+		offset += view.size();
+	}
+
+	/*
+	 * The batch is sent as a work package whose number of elements
+	 * is the number of packages in the batch, and whose ID is 0.
+	 */
+	BE::MPI::WorkPackage batchPackage(BE::Memory::ByteView(data,
+	    data.size()));
+	batchPackage.setNumElements(batch.size());
+	this->sendWorkPackage(batchPackage, MPITask);
+}
+
+size_t
+BiometricEvaluation::MPI::Distributor::getBatchSize(
+    int task) const
+{
+	const int nodeTasks = this->_topology->getNodeTaskCount(task);
+	if (nodeTasks == 0)
+		return (1);
+	if (this->_resources->getNodeBatchSize() > 0)
+		return (this->_resources->getNodeBatchSize());
+	return (nodeTasks * std::max(1, this->_resources->getWorkersPerNode()));
+}
+
+void
+BiometricEvaluation::MPI::Distributor::producePackages()
+{
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(
+			    this->_packageQueueMutex);
+			this->_packageTaken.wait(lock, [this]() {
+				return (this->_producerStopping ||
+				    (this->_packageQueue.size() <
+				    this->_packageQueueCapacity));
+			});
+			if (this->_producerStopping)
+				return;
+		}
+
+		/*
+		 * The subclass may write to the Logsheet, so the
+		 * distribution loop defers its messages while the
+		 * package is created.
+		 */
+		auto workPackage = BE::Memory::make_unique<MPI::WorkPackage>();
+		workPackage->setID(++this->_lastPackageID);
+		try {
+			std::lock_guard<std::mutex> logLock(
+			    this->_logsheetMutex);
+			this->createWorkPackage(*workPackage);
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(
+			    this->_packageQueueMutex);
+			this->_producerException = std::current_exception();
+			this->_producerDone = true;
+			this->_packageQueued.notify_all();
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(this->_packageQueueMutex);
+		if (workPackage->getNumElements() == 0) {
+			this->_producerDone = true;
+			this->_packageQueued.notify_all();
+			return;
+		}
+		this->_packageQueue.push_back(std::move(workPackage));
+		this->_packageQueued.notify_all();
+	}
+}
+
+void
+BiometricEvaluation::MPI::Distributor::stopProducer()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->_packageQueueMutex);
+		this->_producerStopping = true;
+		this->_packageTaken.notify_all();
+	}
+	if (this->_producer.joinable())
+		this->_producer.join();
+}
+
+std::unique_ptr<BiometricEvaluation::MPI::WorkPackage>
+BiometricEvaluation::MPI::Distributor::takeWorkPackage(
+    int task,
+    bool wait)
+{
+	std::unique_lock<std::mutex> lock(this->_packageQueueMutex);
+	if (wait)
+		this->_queueDepth.record(this->_packageQueue.size());
+
+	/* A node distributor asks Task-0 for more once it runs out */
+	if (this->_relay && wait && this->_packageQueue.empty() &&
+	    !this->_producerDone) {
+		lock.unlock();
+		this->requestBatch();
+		lock.lock();
+	}
+
+	/* Wait for the producer, but not past an exit signal */
+	while (wait && !this->_relay && this->_packageQueue.empty() &&
+	    !this->_producerDone) {
+		if (BiometricEvaluation::MPI::Exit ||
+		    BiometricEvaluation::MPI::QuickExit ||
+		    BiometricEvaluation::MPI::TermExit)
+			return (nullptr);
+		this->_packageQueued.wait_for(lock, MaxPollSleep);
+	}
+	if (this->_packageQueue.empty()) {
+		if (this->_producerException)
+			std::rethrow_exception(this->_producerException);
+		return (nullptr);
+	}
+
+	/*
+	 * Prefer the first package local to the task's node. Localities
+	 * are spread over the downstream tasks in turn, so each keeps
+	 * getting the same part of the input.
+	 */
+	auto chosen = this->_packageQueue.begin();
+	const uint32_t taskCount =
+	    this->_topology->getDownstream().Get_size() - 1;
+	const uint32_t node = task - 1;
+	for (auto it = this->_packageQueue.begin();
+	    (taskCount > 1) && (it != this->_packageQueue.end()); it++) {
+		const uint32_t locality = (*it)->getLocality();
+		if ((locality != WorkPackage::ANYLOCALITY) &&
+		    ((locality % taskCount) == node)) {
+			chosen = it;
+			break;
+		}
+	}
+	const uint32_t locality = (*chosen)->getLocality();
+	if (locality != WorkPackage::ANYLOCALITY) {
+		this->_placedPackages++;
+		if ((taskCount <= 1) || ((locality % taskCount) == node))
+			this->_localPackages++;
+	}
+
+	std::unique_ptr<MPI::WorkPackage> workPackage = std::move(*chosen);
+	this->_packageQueue.erase(chosen);
+	this->_packageTaken.notify_one();
+	return (workPackage);
+}
+
+void
+BiometricEvaluation::MPI::Distributor::returnWorkPackage(
+    std::unique_ptr<BE::MPI::WorkPackage> workPackage)
+{
+	std::lock_guard<std::mutex> lock(this->_packageQueueMutex);
+	this->_packageQueue.push_front(std::move(workPackage));
+}
+
+void
+BiometricEvaluation::MPI::Distributor::requestBatch()
+{
+	::MPI::Intracomm &upstream = this->_topology->getUpstream();
+
+	/* Ask for work as a Receiver would */
+	MPI::taskstat_t taskStatus = to_int_type(MPI::TaskStatus::OK);
+	MPI::taskcmd_t taskCmd;
+	upstream.Sendrecv(
+	    (void *)&taskStatus, 1, MPI_INT32_T, 0,
+	    to_int_type(MPI::MessageTag::Control),
+	    &taskCmd, 1, MPI_INT32_T, 0,
+	    to_int_type(MPI::MessageTag::Control));
+	this->_upstreamCommand = to_enum<MPI::TaskCommand>(taskCmd);
+	if (this->_upstreamCommand != MPI::TaskCommand::Continue) {
+		this->deferLogMessage("Received " +
+		    to_string(this->_upstreamCommand) + " from Task-0");
+		if (this->_upstreamCommand == MPI::TaskCommand::QuickExit)
+			BiometricEvaluation::MPI::QuickExit = true;
+		else if (this->_upstreamCommand == MPI::TaskCommand::TermExit)
+			BiometricEvaluation::MPI::TermExit = true;
+
+		std::lock_guard<std::mutex> lock(this->_packageQueueMutex);
+		this->_producerDone = true;
+		return;
+	}
+
+	::MPI::Status MPIstatus;
+	upstream.Probe(0, to_int_type(MPI::MessageTag::Data), MPIstatus);
+	const int size = MPIstatus.Get_count(MPI_CHAR);
+	this->_batchData.resize(size);
+	upstream.Recv(this->_batchData, size, MPI_CHAR, 0,
+	    to_int_type(MPI::MessageTag::Data));
+	uint64_t count, batchID;
+	upstream.Recv(&count, 1, MPI_UINT64_T, 0,
+	    to_int_type(MPI::MessageTag::Data));
+	upstream.Recv(&batchID, 1, MPI_UINT64_T, 0,
+	    to_int_type(MPI::MessageTag::Data));
+
+	/*
+	 * The packages view the batch, which is not replaced until
+	 * every package in it has been sent.
+	 */
+	std::lock_guard<std::mutex> lock(this->_packageQueueMutex);
+	uint64_t offset = 0;
+	for (uint64_t i = 0; i < count; i++) {
+		uint64_t header[3];
+		std::memcpy(header, &this->_batchData[offset], sizeof(header));
+		offset += sizeof(header);
+		auto workPackage = BE::Memory::make_unique<MPI::WorkPackage>(
+		    BE::Memory::ByteView(&this->_batchData[offset],
+		    header[2]));
+		workPackage->setNumElements(header[0]);
+		workPackage->setID(header[1]);
+		this->_packageQueue.push_back(std::move(workPackage));
+		offset += header[2];
+	}
+	this->deferLogMessage("Received batch of " + std::to_string(count) +
+	    " packages from Task-0");
+}
+
+void
+BiometricEvaluation::MPI::Distributor::receiveUpstreamCommand()
+{
+	::MPI::Intracomm &upstream = this->_topology->getUpstream();
+	while (upstream.Iprobe(0, to_int_type(MPI::MessageTag::OOB))) {
+		MPI::taskcmd_t oobCmd;
+		upstream.Recv((void *)&oobCmd, 1, MPI_INT32_T, 0,
+		    to_int_type(MPI::MessageTag::OOB));
+		const auto oobCmdE = to_enum<TaskCommand>(oobCmd);
+		if (oobCmdE == MPI::TaskCommand::QuickExit)
+			BiometricEvaluation::MPI::QuickExit = true;
+		else if (oobCmdE == MPI::TaskCommand::TermExit)
+			BiometricEvaluation::MPI::TermExit = true;
+	}
+}
+
+void
+BiometricEvaluation::MPI::Distributor::finishUpstream()
+{
+	::MPI::Intracomm &upstream = this->_topology->getUpstream();
+	BE::IO::Logsheet *log = this->_logsheet.get();
+	MPI::taskstat_t taskStatus = to_int_type(MPI::TaskStatus::OK);
+
+	/*
+	 * After an Ignore, Task-0 answers the next request with the
+	 * command to exit. If this node stopped while Task-0 still had
+	 * work, Task-0 is told so, and sends no reply.
+	 */
+	if (this->_upstreamCommand == MPI::TaskCommand::Ignore) {
+		MPI::taskcmd_t taskCmd;
+		upstream.Sendrecv(
+		    (void *)&taskStatus, 1, MPI_INT32_T, 0,
+		    to_int_type(MPI::MessageTag::Control),
+		    &taskCmd, 1, MPI_INT32_T, 0,
+		    to_int_type(MPI::MessageTag::Control));
+		*log << "Received " << to_enum<TaskCommand>(taskCmd) <<
+		    " from Task-0";
+		MPI::logEntry(*log);
+	} else if (this->_upstreamCommand == MPI::TaskCommand::Continue) {
+		const MPI::taskstat_t exitStatus = to_int_type(
+		    (BiometricEvaluation::MPI::Exit ||
+		    BiometricEvaluation::MPI::QuickExit ||
+		    BiometricEvaluation::MPI::TermExit) ?
+		    MPI::TaskStatus::Exit : MPI::TaskStatus::Failed);
+		upstream.Send((void *)&exitStatus, 1, MPI_INT32_T, 0,
+		    to_int_type(MPI::MessageTag::Control));
+	}
+
+	/* Completions were forwarded as the node's tasks sent them */
+	upstream.Send(nullptr, 0, MPI_UINT64_T, 0,
+	    to_int_type(MPI::MessageTag::Completion));
+	upstream.Barrier();
+	MPI::logMessage(*log, "Sending final message");
+	upstream.Send((void *)&taskStatus, 1, MPI_INT32_T, 0,
+	    to_int_type(MPI::MessageTag::Control));
+}
+
+void
+BiometricEvaluation::MPI::Distributor::workPackageCompleted(
+    const uint64_t packageID)
+{
+
+}
+
+void
+BiometricEvaluation::MPI::Distributor::receiveCompletions()
+{
+	::MPI::Intracomm &downstream = this->_topology->getDownstream();
+	::MPI::Status MPIstatus;
+	while (downstream.Iprobe(MPI_ANY_SOURCE,
+	    to_int_type(MPI::MessageTag::Completion), MPIstatus)) {
+		/* The last message from a task is handled in shutdown() */
+		if (MPIstatus.Get_count(MPI_UINT64_T) == 0)
+			return;
+
+		uint64_t packageID;
+		downstream.Recv(&packageID, 1, MPI_UINT64_T,
+		    MPIstatus.Get_source(),
+		    to_int_type(MPI::MessageTag::Completion));
+		this->completeWorkPackage(packageID);
+	}
+}
+
+void
+BiometricEvaluation::MPI::Distributor::completeWorkPackage(
+    const uint64_t packageID)
+{
+	/* Task-0 records the completions of every node */
+	if (this->_relay) {
+		this->_topology->getUpstream().Send((void *)&packageID, 1,
+		    MPI_UINT64_T, 0, to_int_type(MPI::MessageTag::Completion));
+		return;
+	}
+
+	try {
+		this->workPackageCompleted(packageID);
+	} catch (Error::Exception &e) {
+		this->deferLogMessage("Could not record completion of "
+		    "package " + std::to_string(packageID) + ": " +
+		    e.whatString());
+	}
+}
+
+void
+BiometricEvaluation::MPI::Distributor::deferLogMessage(
+    const std::string &message)
+{
+	this->_heldLogMessages.push_back(message);
+	this->flushLog(false);
+}
+
+void
+BiometricEvaluation::MPI::Distributor::flushLog(
+    bool wait)
+{
+	std::unique_lock<std::mutex> lock(this->_logsheetMutex,
+	    std::defer_lock);
+	if (wait)
+		lock.lock();
+	else if (!lock.try_lock())
+		return;
+
+	for (const auto &message : this->_heldLogMessages)
+		MPI::logMessage(*this->_logsheet, message);
+	this->_heldLogMessages.clear();
 }
 
 void
 BiometricEvaluation::MPI::Distributor::distributeWork()
 {
-	MPI::WorkPackage workPackage;
+	::MPI::Intracomm &downstream = this->_topology->getDownstream();
 	int numTasks = this->_activeMpiTasks.size();
 	auto taskStatus = BE::Memory::make_unique<MPI::taskstat_t[]>(numTasks);
 	auto indices = BE::Memory::make_unique<int[]>(numTasks);
 	auto MPIstatus = BE::Memory::make_unique<::MPI::Status[]>(numTasks);
 	auto requests = BE::Memory::make_unique<::MPI::Request[]>(numTasks);
 	int numRequests;
+	uint32_t idlePolls = 0;
 	BE::IO::Logsheet *log = this->_logsheet.get();
 
+	/*
+	 * Start creating work packages before any are requested, so
+	 * that reading the input overlaps with replying to tasks. A
+	 * node distributor's packages come from Task-0 instead.
+	 */
+	this->_packageQueueCapacity =
+	    this->_resources->getWorkPackageQueueDepth();
+	if (this->_packageQueueCapacity == 0)
+		for (const auto &task : this->_activeMpiTasks)
+			this->_packageQueueCapacity += this->getBatchSize(task);
+	this->_producerDone = false;
+	this->_producerStopping = false;
+	this->_producerException = nullptr;
+	if (!this->_relay)
+		this->_producer = std::thread(&Distributor::producePackages,
+		    this);
+	/* Stop the producer however the distribution loop is left */
+	std::unique_ptr<Distributor, void(*)(Distributor*)> producerGuard(
+	    this, [](Distributor *distributor) {
+		distributor->stopProducer();
+		distributor->flushLog(true);
+	    });
+
 	/*
  	 * Perform a non-blocking receive from all child tasks.
  	 * This loop creates the initial set of receive requests,
@@ -143,7 +620,7 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
  	 */
 	int t = 0;
 	for (const auto &task : this->_activeMpiTasks) {
-		requests[t] = ::MPI::COMM_WORLD.Irecv(
+		requests[t] = downstream.Irecv(
 		    &taskStatus[t], 1, MPI_INT32_T, task,
 		    to_int_type(MPI::MessageTag::Control));
 		t++;
@@ -167,6 +644,9 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 		    BiometricEvaluation::MPI::TermExit) {
 			break;
 		}
+		this->receiveCompletions();
+		if (this->_relay)
+			this->receiveUpstreamCommand();
 
 		/*
 		 * Implement a fair message processing scheme, where all 
@@ -175,9 +655,23 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 		 * with an MPI::Recv() (or Irecv(), etc.), so once a
 		 * message is processed, we must call Irecv() for the Task
 		 * so future messages will be processed.
+		 *
+		 * Waitsome() is not used because it would keep exit
+		 * signals from being noticed until a task sends a
+		 * message. Instead, back off between polls that find
+		 * nothing, writing any held log messages meanwhile.
 		 */
 		numRequests = ::MPI::Request::Testsome(
 		    numTasks, requests.get(), indices.get(), MPIstatus.get());
+		if (numRequests <= 0) {
+			if (this->_activeMpiTasks.empty())
+				break;
+			this->flushLog(false);
+			backOff(idlePolls++);
+			continue;
+		}
+		idlePolls = 0;
+		const auto received = std::chrono::steady_clock::now();
 		for (int r = 0; r < numRequests; r++) {
 			int task = MPIstatus[r].Get_source();
 			/*
@@ -185,28 +679,29 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 	 		* then take it out of the list of
 	 		* active tasks.
 			*/
-			*log << "Received ";
+			std::ostringstream sstr;
+			sstr << "Received ";
 			const auto ts = to_enum<MPI::TaskStatus>(
 			    taskStatus[indices[r]]);
 			if ((ts == MPI::TaskStatus::Exit) ||
 			    (ts == MPI::TaskStatus::Failed)) {
-				*log << "Exit/Failure from Task-" << task;
-				MPI::logEntry(*log);
+				sstr << "Exit/Failure from Task-" << task;
+				this->deferLogMessage(sstr.str());
 				this->_activeMpiTasks.erase(task);
 				continue;
 			} else if (ts == MPI::TaskStatus::
 			    RequestJobTermination) {
-				*log << "Job termination request from Task-" <<
+				sstr << "Job termination request from Task-" <<
 				    task;
-				MPI::logEntry(*log);
+				this->deferLogMessage(sstr.str());
 				this->_activeMpiTasks.erase(task);
 				BE::MPI::TermExit = true;
 				continue;
 			}
-			*log << "OK from Task-" << task;
-			MPI::logEntry(*log);
+			sstr << "OK from Task-" << task;
+			this->deferLogMessage(sstr.str());
 
-			this->createWorkPackage(workPackage);
+			auto workPackage = this->takeWorkPackage(task, true);
 
 			/*
 			 * If we are out of work, or in a shutdown
@@ -214,14 +709,19 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 			 * reply. We need to do this so the
 			 * communication send/recv pairs stay in sync.
 			 */
-			if ((workPackage.getNumElements() == 0) ||
+			if ((workPackage == nullptr) ||
 			   (BiometricEvaluation::MPI::Exit ||
 			    BiometricEvaluation::MPI::QuickExit ||
 			    BiometricEvaluation::MPI::TermExit)) {
 				taskCmd = to_int_type(MPI::TaskCommand::Ignore);
-				::MPI::COMM_WORLD.Send(
+				downstream.Send(
 				    (void *)&taskCmd, 1, MPI_INT32_T, task,
 				    to_int_type(MPI::MessageTag::Control));
+				this->_serviceLatency.record(
+				    std::chrono::duration_cast<
+				    std::chrono::nanoseconds>(
+				    std::chrono::steady_clock::now() -
+				    received).count());
 				haveWork = false;
 				continue;
 			}
@@ -230,22 +730,68 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 			 * data coming in the next messages.
 			 */
 			taskCmd = to_int_type(MPI::TaskCommand::Continue);
-			::MPI::COMM_WORLD.Send((void *)&taskCmd, 1, MPI_INT32_T,
+			downstream.Send((void *)&taskCmd, 1, MPI_INT32_T,
 			    task, to_int_type(MPI::MessageTag::Control));
 
-			sendWorkPackage(workPackage, task);
+			/*
+			 * A node distributor is sent a batch of the
+			 * packages ready now, up to the batch size, and
+			 * never more than one message can hold.
+			 */
+			if (this->_topology->getNodeTaskCount(task) == 0) {
+				this->sendWorkPackage(*workPackage, task);
+			} else {
+				const size_t batchSize =
+				    this->getBatchSize(task);
+				uint64_t batchBytes = workPackage->getSize();
+				std::vector<std::unique_ptr<MPI::WorkPackage>>
+				    batch;
+				batch.push_back(std::move(workPackage));
+				while (batch.size() < batchSize) {
+					auto next = this->takeWorkPackage(task,
+					    false);
+					if (next == nullptr)
+						break;
+					batchBytes += (3 * sizeof(uint64_t)) +
+					    next->getSize();
+					if (batchBytes > INT_MAX) {
+						this->returnWorkPackage(
+						    std::move(next));
+						break;
+					}
+					batch.push_back(std::move(next));
+				}
+				this->sendWorkPackages(batch, task);
+			}
+			this->_serviceLatency.record(
+			    std::chrono::duration_cast<
+			    std::chrono::nanoseconds>(
+			    std::chrono::steady_clock::now() -
+			    received).count());
 
 			/*
 			 * Repost the non-blocking receive
 			 * for the task just given work.
 			 */
-			requests[indices[r]] = ::MPI::COMM_WORLD.Irecv(
+			requests[indices[r]] = downstream.Irecv(
 			    &taskStatus[indices[r]], 1, MPI_INT32_T,
 			    task, to_int_type(MPI::MessageTag::Control));
 		}
 		if (this->_activeMpiTasks.empty())
 			break;
 	}
+	producerGuard.reset();
+
+	MPI::logMessage(*log, "Work package queue depth: " +
+	    this->_queueDepth.toString());
+	MPI::logMessage(*log, "Request service latency (ns): " +
+	    this->_serviceLatency.toString());
+	if (this->_placedPackages > 0) {
+		*log << "Packages sent to their node: " <<
+		    this->_localPackages << " of " << this->_placedPackages;
+		MPI::logEntry(*log);
+	}
+
 	/*
  	 * Send the Exit condition as an out-of-band message to
  	 * all Task-N that are still asking for work.
@@ -262,7 +808,7 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 		taskCmd = to_int_type(MPI::TaskCommand::TermExit);
 	}
 	for (const auto &task : this->_activeMpiTasks) {
-		::MPI::COMM_WORLD.Isend(
+		downstream.Isend(
 		    (void *)&taskCmd, 1, MPI_INT32_T, task,
 		    to_int_type(MPI::MessageTag::OOB));
 	}
@@ -282,7 +828,13 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
  	 * message requests in the set of requests.
  	 */
 	taskCmd = to_int_type(MPI::TaskCommand::Ignore);
+	idlePolls = 0;
  	while (numRequests != MPI_UNDEFINED) {
+		this->receiveCompletions();
+		if (numRequests == 0)
+			backOff(idlePolls++);
+		else
+			idlePolls = 0;
 		for (int r = 0; r < numRequests; r++) {
 			int task = MPIstatus[r].Get_source();
 			const auto ts = to_enum<TaskStatus>(
@@ -294,7 +846,7 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 				MPI::logEntry(*log);
 				this->_activeMpiTasks.erase(task);
 			} else {
-				::MPI::COMM_WORLD.Send(
+				downstream.Send(
 				    (void *)&taskCmd, 1,
 				    MPI_INT32_T, task,
 				    to_int_type(MPI::MessageTag::Control));
@@ -308,6 +860,7 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 void
 BiometricEvaluation::MPI::Distributor::shutdown()
 {
+	::MPI::Intracomm &downstream = this->_topology->getDownstream();
 	BE::IO::Logsheet *log = this->_logsheet.get();
 
 	/*
@@ -342,13 +895,13 @@ BiometricEvaluation::MPI::Distributor::shutdown()
 	while(!this->_activeMpiTasks.empty()) {
 
 		/* Wait for the receive of the work request */
-		::MPI::COMM_WORLD.Recv(&taskStatus, 1, MPI_INT32_T,
+		downstream.Recv(&taskStatus, 1, MPI_INT32_T,
 		    MPI_ANY_SOURCE, to_int_type(MPI::MessageTag::Control),
 		    MPIstatus);
 
 		/* Tell the task to exit */
 		int task = MPIstatus.Get_source();
-		::MPI::COMM_WORLD.Send(
+		downstream.Send(
 		    (void *)&taskCmd, 1, MPI_INT32_T, task,
 		    to_int_type(MPI::MessageTag::Control));
 
@@ -358,21 +911,41 @@ BiometricEvaluation::MPI::Distributor::shutdown()
 		MPI::logEntry(*log);
 	}
 
+	/*
+	 * Each task reports the last packages its workers completed
+	 * as it shuts down, followed by an empty message.
+	 */
+	::MPI::Status completionStatus;
+	for (int task = 1; task < downstream.Get_size(); ) {
+		uint64_t packageID;
+		downstream.Recv(&packageID, 1, MPI_UINT64_T,
+		    MPI_ANY_SOURCE, to_int_type(MPI::MessageTag::Completion),
+		    completionStatus);
+		if (completionStatus.Get_count(MPI_UINT64_T) == 0)
+			task++;
+		else
+			this->completeWorkPackage(packageID);
+	}
+	this->flushLog(true);
+
 	/* Wait for other tasks to start the shut down */
-	::MPI::COMM_WORLD.Barrier();
+	downstream.Barrier();
 
 	/*
 	 * Wait for all tasks to send a final message even if
 	 * they've done no receiving of work.
 	 */
 	::MPI::Status mpiStatus;
-	for (int task = 1; task < this->_resources->getNumTasks(); task++) {
-		::MPI::COMM_WORLD.Recv(&taskStatus, 1, MPI_INT32_T,
+	for (int task = 1; task < downstream.Get_size(); task++) {
+		downstream.Recv(&taskStatus, 1, MPI_INT32_T,
 		    MPI_ANY_SOURCE, to_int_type(MPI::MessageTag::Control),
 		    mpiStatus);
 		*log << "Received " << to_enum<TaskStatus>(taskStatus) << " " <<
 		    "from Task-" << mpiStatus.Get_source();
 		MPI::logEntry(*log);
 	}
+
+	if (this->_relay)
+		this->finishUpstream();
 }
 
@@ -7,18 +7,25 @@
  * its use by other parties, and makes no guarantees, expressed or implied,
  * about its quality, reliability, or any other characteristic.
  */
+#include <sys/mman.h>
+
+#include <chrono>
+#include <cstring>
 #include <set>
 #include <sstream>
 #include <mpi.h>
 #include <signal.h>
 #include <time.h>
 
+#include <be_error.h>
 #include <be_memory_autoarrayutility.h>
 #include <be_mpi.h>
 #include <be_mpi_exception.h>
 #include <be_mpi_receiver.h>
 #include <be_mpi_runtime.h>
 
+#include "be_mpi_topology.h"
+
 namespace BE = BiometricEvaluation;
 using namespace BE::Framework::Enumeration;
 
@@ -66,6 +73,110 @@ static void statusToMessage(
 	    std::to_string(to_int_type(taskStatus)));
 }
 
+/*
+ * Seconds to wait for a worker to ask for work before checking for
+ * out-of-band messages from Task-0.
+ */
+static const int WORKERWAITSECONDS = 1;
+
+/* PackageDescriptor slot when the package data is sent through a pipe */
+static const uint32_t NOSLOT = UINT32_MAX;
+
+/*
+ * Message that hands a work package to a worker, sent after the
+ * Continue command. Unless slot is NOSLOT, the package data is in
+ * that slot of the PackagePool; otherwise, it is the next message.
+ */
+struct PackageDescriptor
+{
+	uint64_t numElements;
+	uint64_t size;
+	uint32_t slot;
+};
+
+/*
+ * Memory shared by a Receiver and its workers, divided into slots that
+ * each hold one work package. The memory is mapped before the workers
+ * are forked, so every process sees it at the same address. Only the
+ * Receiver tracks which slots are in use: a slot is handed to a worker
+ * in a PackageDescriptor, and is free again once that worker sends its
+ * next message, as the worker is then done with the package. The pipe
+ * messages also order the accesses to the slot between processes.
+ */
+class BiometricEvaluation::MPI::Receiver::PackagePool
+{
+public:
+	/*
+	 * Map slotCount slots of slotSize octets. Memory is only
+	 * committed as slots are filled.
+	 * Throws Error::StrategyError if the memory cannot be mapped.
+	 */
+	PackagePool(
+	    uint32_t slotCount,
+	    uint64_t slotSize) :
+	    _slotSize(slotSize),
+	    _slotInUse(slotCount, false)
+	{
+		void *memory = mmap(nullptr, slotCount * slotSize,
+		    PROT_READ | PROT_WRITE,
+		    MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (memory == MAP_FAILED)
+			throw Error::StrategyError("Could not map package "
+			    "pool (" + Error::errorStr() + ")");
+		this->_memory = static_cast<uint8_t *>(memory);
+	}
+
+	~PackagePool()
+	{
+		munmap(this->_memory, this->_slotInUse.size() *
+		    this->_slotSize);
+	}
+
+	uint64_t
+	getSlotSize()
+	    const
+	{
+		return (this->_slotSize);
+	}
+
+	uint8_t *
+	getSlot(
+	    uint32_t slot)
+	    const
+	{
+		return (this->_memory + (slot * this->_slotSize));
+	}
+
+	/* Returns a free slot, now in use, or NOSLOT */
+	uint32_t
+	acquire()
+	{
+		for (uint32_t slot = 0; slot < this->_slotInUse.size();
+		    slot++) {
+			if (!this->_slotInUse[slot]) {
+				this->_slotInUse[slot] = true;
+				return (slot);
+			}
+		}
+		return (NOSLOT);
+	}
+
+	void
+	release(
+	    uint32_t slot)
+	{
+		this->_slotInUse[slot] = false;
+	}
+
+	PackagePool(const PackagePool&) = delete;
+	PackagePool& operator=(const PackagePool&) = delete;
+
+private:
+	uint8_t *_memory;
+	uint64_t _slotSize;
+	std::vector<bool> _slotInUse;
+};
+
 /******************************************************************************/
 /* Class method definitions.                                                  */
 /******************************************************************************/
@@ -74,10 +185,12 @@ static void statusToMessage(
  */
 BiometricEvaluation::MPI::Receiver::PackageWorker::PackageWorker(
     const std::shared_ptr<MPI::WorkPackageProcessor> &workPackageProcessor,
-    const std::shared_ptr<MPI::Resources> &resources)
+    const std::shared_ptr<MPI::Resources> &resources,
+    const std::shared_ptr<PackagePool> &packagePool)
 {
 	this->_workPackageProcessor = workPackageProcessor;
 	this->_resources = resources;
+	this->_packagePool = packagePool;
 }
 
 int32_t
@@ -199,17 +312,29 @@ BiometricEvaluation::MPI::Receiver::PackageWorker::workerMain()
 		}
 		/*
 		 * Receieve the work package and hand it off to the
-		 * package processor.
+		 * package processor. A package in the shared pool is
+		 * processed where it is, without copying.
 		 */
 		try {
 			this->waitForMessage();
 			this->receiveMessageFromManager(message);
-			uint64_t wpCount;
-			std::memcpy(&wpCount, &message[0], sizeof(wpCount));
-			this->waitForMessage();
-			this->receiveMessageFromManager(message);
-			workPackage = MPI::WorkPackage(message);
-			workPackage.setNumElements(wpCount);
+			if (message.size() != sizeof(PackageDescriptor))
+				throw Error::DataError("Invalid work package "
+				    "descriptor");
+			PackageDescriptor descriptor;
+			std::memcpy(&descriptor, &message[0],
+			    sizeof(descriptor));
+			if (descriptor.slot == NOSLOT) {
+				this->waitForMessage();
+				this->receiveMessageFromManager(message);
+				workPackage = MPI::WorkPackage(message);
+			} else {
+				workPackage = MPI::WorkPackage(
+				    Memory::ByteView(this->_packagePool->
+				    getSlot(descriptor.slot),
+				    descriptor.size));
+			}
+			workPackage.setNumElements(descriptor.numElements);
 		} catch (Error::Exception &e) {
 			MPI::logMessage(*log, "Failed to receive work package: "
 			    + e.whatString());
@@ -259,10 +384,11 @@ BiometricEvaluation::MPI::Receiver::~Receiver()
 {
 }
 
-void
-BiometricEvaluation::MPI::Receiver::sendWorkPackage(
-    MPI::WorkPackage &workPackage)
+std::shared_ptr<BiometricEvaluation::Process::WorkerController>
+BiometricEvaluation::MPI::Receiver::waitForWorker()
 {
+	::MPI::Intracomm &upstream = this->_topology->getUpstream();
+
 	/*
 	 * While there is some worker available, send the work package
 	 * to the first worker from which we receive a request. If that
@@ -272,7 +398,6 @@ BiometricEvaluation::MPI::Receiver::sendWorkPackage(
 	 */
 	std::shared_ptr<Process::WorkerController> worker;
 	BE::Memory::uint8Array message;
-	BE::Memory::uint8Array wpData;
 	MPI::TaskStatus taskStatus;
 	BE::IO::Logsheet *log = this->_logsheet.get();
 
@@ -292,11 +417,11 @@ BiometricEvaluation::MPI::Receiver::sendWorkPackage(
  		 * because we can be waiting a long time for a worker
  		 * to request a work package.
  		 */
-		bool oobmsg = ::MPI::COMM_WORLD.Iprobe(0,
+		bool oobmsg = upstream.Iprobe(0,
 		    to_int_type(MPI::MessageTag::OOB));
 		if (oobmsg) {
 			MPI::taskcmd_t oobCmd;
-			::MPI::COMM_WORLD.Recv((void *)&oobCmd, 1, MPI_INT32_T,
+			upstream.Recv((void *)&oobCmd, 1, MPI_INT32_T,
 			    0, to_int_type(MPI::MessageTag::OOB));
 			const auto oobCmdE = to_enum<TaskCommand>(oobCmd);
 			if (oobCmdE == MPI::TaskCommand::QuickExit) {
@@ -315,20 +440,26 @@ BiometricEvaluation::MPI::Receiver::sendWorkPackage(
 		 * Receiver is not done here.
 		 */
 		if (MPI::QuickExit || MPI::TermExit) {
-			return;
+			return (nullptr);
 		}
 
 		/*
- 		 * If no worker is ready, pause for a bit, then go back
- 		 * to the top of the loop and start over.
+ 		 * Block until a worker is ready, waking periodically to
+ 		 * go back to the top of the loop and start over. If no
+ 		 * worker can send a message (e.g., all are exiting), the
+ 		 * wait ends at once, so pause for a bit instead.
  		 */
-		bool msgAvail =
-		    this->_processManager.getNextMessage(worker, message, 0);
+		const auto waitStart = std::chrono::steady_clock::now();
+		bool msgAvail = this->_processManager.getNextMessage(worker,
+		    message, WORKERWAITSECONDS);
 		if (!msgAvail) {
-			struct timespec ts;
-			ts.tv_sec = 0;
-			ts.tv_nsec = 100000000L;	/* 100 milliseconds */
-			nanosleep(&ts, NULL);
+			if (std::chrono::steady_clock::now() - waitStart <
+			    std::chrono::seconds(WORKERWAITSECONDS)) {
+				struct timespec ts;
+				ts.tv_sec = 0;
+				ts.tv_nsec = 100000000L; /* 100 milliseconds */
+				nanosleep(&ts, NULL);
+			}
 			continue;
 		}
 
@@ -337,6 +468,7 @@ BiometricEvaluation::MPI::Receiver::sendWorkPackage(
 		 * the work package, so no checks for Exit conditions here.
 		 */
 		taskStatus = messageToStatus(message);
+		this->workerReported(worker, taskStatus);
 
 		/*
 		 * When a worker gets into trouble, have it stop processing.
@@ -352,9 +484,50 @@ BiometricEvaluation::MPI::Receiver::sendWorkPackage(
 				    + e.whatString());
 			}
 		} else {
-			break;
+			return (worker);
 		}
 	}
+}
+
+void
+BiometricEvaluation::MPI::Receiver::workerReported(
+    const std::shared_ptr<Process::WorkerController> &worker,
+    MPI::TaskStatus taskStatus)
+{
+	::MPI::Intracomm &upstream = this->_topology->getUpstream();
+
+	const auto workerSlot = this->_workerSlots.find(worker);
+	if (workerSlot != this->_workerSlots.end()) {
+		this->_packagePool->release(workerSlot->second);
+		this->_workerSlots.erase(workerSlot);
+	}
+
+	/*
+	 * A worker only reports OK after processing its whole package.
+	 * Any other status may follow a partly processed package.
+	 */
+	const auto workerPackage = this->_workerPackages.find(worker);
+	if (workerPackage == this->_workerPackages.end())
+		return;
+	uint64_t packageID = workerPackage->second;
+	this->_workerPackages.erase(workerPackage);
+	if (taskStatus == MPI::TaskStatus::OK)
+		upstream.Send((void *)&packageID, 1, MPI_UINT64_T,
+		    0, to_int_type(MPI::MessageTag::Completion));
+}
+
+void
+BiometricEvaluation::MPI::Receiver::sendWorkPackage(
+    MPI::WorkPackage &workPackage)
+{
+	BE::Memory::uint8Array message;
+	BE::Memory::uint8Array wpData;
+	BE::IO::Logsheet *log = this->_logsheet.get();
+
+	std::shared_ptr<Process::WorkerController> worker =
+	    this->waitForWorker();
+	if (worker == nullptr)
+		return;
 
 	/*
 	 * Tell the worker to continue on.
@@ -364,21 +537,61 @@ BiometricEvaluation::MPI::Receiver::sendWorkPackage(
 			
 	/*
 	 * A work package is sent in two parts: 
-	 * The number of elements, and the raw data.
+	 * The descriptor, and the raw data.
 	 */
-	uint64_t wpCount = workPackage.getNumElements();
-	message.resize(sizeof(wpCount));
-	std::memcpy(&message[0], &wpCount, sizeof(wpCount));
+	const PackageDescriptor descriptor{workPackage.getNumElements(),
+	    workPackage.getSize(), NOSLOT};
+	message.resize(sizeof(descriptor));
+	std::memcpy(&message[0], &descriptor, sizeof(descriptor));
 	worker->sendMessageToWorker(message);
 	workPackage.getData(wpData);
 	worker->sendMessageToWorker(wpData);
+	this->_workerPackages[worker] = workPackage.getID();
 	*log << "Sent work package of size " << wpData.size() << " to worker";
 	MPI::logEntry(*log);
 }
 
+void
+BiometricEvaluation::MPI::Receiver::sendWorkPackage(
+    uint32_t slot,
+    uint64_t size,
+    uint64_t numElements,
+    uint64_t packageID)
+{
+	BE::Memory::uint8Array message;
+	BE::IO::Logsheet *log = this->_logsheet.get();
+
+	std::shared_ptr<Process::WorkerController> worker;
+	try {
+		worker = this->waitForWorker();
+	} catch (...) {
+		this->_packagePool->release(slot);
+		throw;
+	}
+	if (worker == nullptr) {
+		this->_packagePool->release(slot);
+		return;
+	}
+
+	commandToMessage(MPI::TaskCommand::Continue, message);
+	worker->sendMessageToWorker(message);
+
+	/* The worker processes the package in the slot */
+	const PackageDescriptor descriptor{numElements, size, slot};
+	message.resize(sizeof(descriptor));
+	std::memcpy(&message[0], &descriptor, sizeof(descriptor));
+	worker->sendMessageToWorker(message);
+	this->_workerSlots[worker] = slot;
+	this->_workerPackages[worker] = packageID;
+	*log << "Shared work package of size " << size << " with worker";
+	MPI::logEntry(*log);
+}
+
 BiometricEvaluation::MPI::TaskStatus
 BiometricEvaluation::MPI::Receiver::requestWorkPackages()
 {
+	::MPI::Intracomm &upstream = this->_topology->getUpstream();
+
 	BE::Memory::uint8Array workPackageRaw(0);
 
 	::MPI::Status MPIstatus;
@@ -397,7 +610,7 @@ BiometricEvaluation::MPI::Receiver::requestWorkPackages()
 		if (MPI::Exit) {
 			MPI::logMessage(*log, "Exit signal");
 			taskStatus = to_int_type(MPI::TaskStatus::Exit);
-			::MPI::COMM_WORLD.Send(
+			upstream.Send(
 			    (void *)&taskStatus, 1, MPI_INT32_T,
 			    0, to_int_type(MPI::MessageTag::Control));
 			status = MPI::TaskStatus::Exit;
@@ -407,7 +620,7 @@ BiometricEvaluation::MPI::Receiver::requestWorkPackages()
 			MPI::logMessage(*log, "Quick Exit signal");
 			this->_processManager.broadcastSignal(SIGINT);
 			taskStatus = to_int_type(MPI::TaskStatus::Exit);
-			::MPI::COMM_WORLD.Send(
+			upstream.Send(
 			    (void *)&taskStatus, 1, MPI_INT32_T,
 			    0, to_int_type(MPI::MessageTag::Control));
 			status = MPI::TaskStatus::Exit;
@@ -417,7 +630,7 @@ BiometricEvaluation::MPI::Receiver::requestWorkPackages()
 			MPI::logMessage(*log, "Termination Exit signal");
 			this->_processManager.broadcastSignal(SIGKILL);
 			taskStatus = to_int_type(MPI::TaskStatus::Exit);
-			::MPI::COMM_WORLD.Send(
+			upstream.Send(
 			    (void *)&taskStatus, 1, MPI_INT32_T,
 			    0, to_int_type(MPI::MessageTag::Control));
 			status = MPI::TaskStatus::Exit;
@@ -426,7 +639,7 @@ BiometricEvaluation::MPI::Receiver::requestWorkPackages()
 
 		MPI::logMessage(*log, "Asking for work package");
 		taskStatus = to_int_type(MPI::TaskStatus::OK);
-		::MPI::COMM_WORLD.Sendrecv(
+		upstream.Sendrecv(
 		    (void *)&taskStatus, 1, MPI_INT32_T, 0,
 		    to_int_type(MPI::MessageTag::Control), &taskCommand, 1,
 		    MPI_INT32_T, 0, to_int_type(MPI::MessageTag::Control));
@@ -451,32 +664,59 @@ BiometricEvaluation::MPI::Receiver::requestWorkPackages()
 		/*
 		 * Receive three pieces of information:
 		 * The raw data and length in the first message;
-		 * The number of elements in the second message.
+		 * The number of elements in the second message;
+		 * The package ID in the third message.
 		 */
-		::MPI::COMM_WORLD.Probe(0, to_int_type(MPI::MessageTag::Data),
+		upstream.Probe(0, to_int_type(MPI::MessageTag::Data),
 		    MPIstatus);
 		uint64_t length = MPIstatus.Get_count(MPI_CHAR);
-		workPackageRaw.resize(length);
-		::MPI::COMM_WORLD.Recv(
-		    (void *)&workPackageRaw[0], length, MPI_CHAR, 0,
+
+		/*
+		 * Receive the package straight into shared memory when
+		 * it fits, so workers can process it without copies.
+		 */
+		uint32_t slot = NOSLOT;
+		if ((this->_packagePool != nullptr) &&
+		    (length <= this->_packagePool->getSlotSize()))
+			slot = this->_packagePool->acquire();
+		void *packageBuffer;
+		if (slot != NOSLOT) {
+			packageBuffer = this->_packagePool->getSlot(slot);
+		} else {
+			workPackageRaw.resize(length);
+			packageBuffer = &workPackageRaw[0];
+		}
+		upstream.Recv(
+		    packageBuffer, length, MPI_CHAR, 0,
 		    to_int_type(MPI::MessageTag::Data));
-		workPackageRaw.resize(length);
 
 		uint64_t numElements;
-		::MPI::COMM_WORLD.Recv(
+		upstream.Recv(
 		    (void *)&numElements, 1, MPI_UINT64_T, 0,
 		    to_int_type(MPI::MessageTag::Data));
+		uint64_t packageID;
+		upstream.Recv(
+		    (void *)&packageID, 1, MPI_UINT64_T, 0,
+		    to_int_type(MPI::MessageTag::Data));
 		try {
-			MPI::WorkPackage workPackage(workPackageRaw);
-			workPackage.setNumElements(numElements);
-			this->sendWorkPackage(workPackage);
+			if (slot != NOSLOT) {
+				this->sendWorkPackage(slot, length,
+				    numElements, packageID);
+			} else {
+				const Memory::ByteView packageData(
+				    workPackageRaw);
+				MPI::WorkPackage workPackage(packageData);
+				workPackage.setNumElements(numElements);
+				workPackage.setID(packageID);
+				this->sendWorkPackage(workPackage);
+			}
 		} catch (MPI::TerminateJob &e) {
 			MPI::logMessage(*log,
 			    "Package processor requested job termination " +
 			    e.whatString());
 			taskStatus = to_int_type(
 			    MPI::TaskStatus::RequestJobTermination);
-			::MPI::COMM_WORLD.Send(
+			upstream.Send(
 			    (void *)&taskStatus, 1, MPI_INT32_T, 0,
 			     to_int_type(MPI::MessageTag::Control));
 			status = MPI::TaskStatus::RequestJobTermination;
@@ -485,7 +725,7 @@ BiometricEvaluation::MPI::Receiver::requestWorkPackages()
 			    "Failure to process work package: "
 			    + e.whatString());
 			taskStatus = to_int_type(MPI::TaskStatus::Failed);
-			::MPI::COMM_WORLD.Send(
+			upstream.Send(
 			    (void *)&taskStatus, 1, MPI_INT32_T, 0,
 			     to_int_type(MPI::MessageTag::Control));
 			status = MPI::TaskStatus::Failed;
@@ -500,10 +740,29 @@ BiometricEvaluation::MPI::Receiver::startWorkers()
 {
 	std::shared_ptr<Process::WorkerController> wc;
 	BE::IO::Logsheet *log = this->_logsheet.get();
+
+	/*
+	 * Map the package pool before forking so workers share it.
+	 * Each worker holds at most one slot, leaving one free to
+	 * receive the next package from Task-0.
+	 */
+	const uint64_t slotSize = this->_resources->getPackagePoolSlotSize();
+	if (slotSize > 0) {
+		try {
+			this->_packagePool.reset(new PackagePool(
+			    this->_resources->getWorkersPerNode() + 1,
+			    slotSize));
+		} catch (Error::Exception &e) {
+			MPI::logMessage(*log, "Sending work packages through "
+			    "pipes: " + e.whatString());
+		}
+	}
+
 	for (int w = 0; w < this->_resources->getWorkersPerNode(); w++) {
 		std::shared_ptr<PackageWorker> pw(new PackageWorker(
 		    this->_workPackageProcessor,
-		    this->_resources));
+		    this->_resources,
+		    this->_packagePool));
 		wc = this->_processManager.addWorker(pw);
 		try {
 			this->_processManager.startWorker(wc, false, true);
@@ -518,6 +777,16 @@ BiometricEvaluation::MPI::Receiver::startWorkers()
 void
 BiometricEvaluation::MPI::Receiver::start()
 {
+	this->start(std::make_shared<Topology>());
+}
+
+void
+BiometricEvaluation::MPI::Receiver::start(
+    const std::shared_ptr<Topology> &topology)
+{
+	this->_topology = topology;
+	::MPI::Intracomm &upstream = topology->getUpstream();
+
 	/* Release other tasks to start up */
 	::MPI::COMM_WORLD.Barrier();
 
@@ -529,7 +798,7 @@ BiometricEvaluation::MPI::Receiver::start()
 			"MPI::Receiver");
 	} catch (Error::Exception) {
 		taskStatus = to_int_type(MPI::TaskStatus::Failed);
-		::MPI::COMM_WORLD.Send((void *)&taskStatus, 1, MPI_INT32_T,
+		upstream.Send((void *)&taskStatus, 1, MPI_INT32_T,
 		    0, to_int_type(MPI::MessageTag::Control));
 		this->shutdown(MPI::TaskStatus::Failed,
 		    "Failed opening Logsheet()");
@@ -538,13 +807,13 @@ BiometricEvaluation::MPI::Receiver::start()
 	BE::IO::Logsheet *log = this->_logsheet.get();
 	MPI::logMessage(*log, "Wait for startup message");
 	BE::MPI::taskstat_t flag;
-	::MPI::COMM_WORLD.Recv(&flag, 1, MPI_INT32_T, 0, 
+	upstream.Recv(&flag, 1, MPI_INT32_T, 0, 
 	    to_int_type(MPI::MessageTag::Control));
 
 	/* Shutdown Task-N if Task-0 says not OK */
 	taskStatus = to_int_type(MPI::TaskStatus::OK);
 	if (flag == to_int_type(MPI::TaskStatus::Failed)) {
-		::MPI::COMM_WORLD.Send((void *)&taskStatus, 1, MPI_INT32_T,
+		upstream.Send((void *)&taskStatus, 1, MPI_INT32_T,
 		     0, to_int_type(MPI::MessageTag::Control));
 		this->shutdown(MPI::TaskStatus::OK, "Distributor says abort");
 		return;
@@ -561,7 +830,7 @@ BiometricEvaluation::MPI::Receiver::start()
 		MPI::logMessage(*log, "Could not initialize package processor: "
 		    + e.whatString());
 		taskStatus = to_int_type(MPI::TaskStatus::Failed);
-		::MPI::COMM_WORLD.Send((void *)&taskStatus, 1, MPI_INT32_T,
+		upstream.Send((void *)&taskStatus, 1, MPI_INT32_T,
 		    0, to_int_type(MPI::MessageTag::Control));
 		this->shutdown(MPI::TaskStatus::Failed,
 		    "Failed performInitalization()");
@@ -572,13 +841,13 @@ BiometricEvaluation::MPI::Receiver::start()
 	//XXX Open log sheet
 	if (this->_processManager.getNumActiveWorkers() == 0) {
 		taskStatus = to_int_type(MPI::TaskStatus::Failed);
-		::MPI::COMM_WORLD.Send((void *)&taskStatus, 1, MPI_INT32_T,
+		upstream.Send((void *)&taskStatus, 1, MPI_INT32_T,
 		    0, to_int_type(MPI::MessageTag::Control));
 		this->shutdown(MPI::TaskStatus::Failed, "No workers");
 		return;
 	}
 
-	::MPI::COMM_WORLD.Send((void *)&taskStatus, 1, MPI_INT32_T,
+	upstream.Send((void *)&taskStatus, 1, MPI_INT32_T,
 	    0, to_int_type(MPI::MessageTag::Control));
 	
 	MPI::TaskStatus status = this->requestWorkPackages();
@@ -600,6 +869,8 @@ BiometricEvaluation::MPI::Receiver::shutdown(
     const MPI::TaskStatus &taskStatus,
     const std::string &reason)
 {
+	::MPI::Intracomm &upstream = this->_topology->getUpstream();
+
 	BE::IO::Logsheet *log = this->_logsheet.get();
 	MPI::logMessage(*log, "Shutting down: " + reason);
 
@@ -641,6 +912,8 @@ BiometricEvaluation::MPI::Receiver::shutdown(
 			}
 			if (!msgAvail)
 				break;
+			this->workerReported(worker,
+			    messageToStatus(inMessage));
 			try {
 				this->_processManager.stopWorker(worker);
 			} catch (Error::Exception &e) {
@@ -660,15 +933,19 @@ BiometricEvaluation::MPI::Receiver::shutdown(
 		    + e.whatString());
 	}
 
+	/* Tell Task-0 there are no more completed packages */
+	upstream.Send(nullptr, 0, MPI_UINT64_T, 0,
+	    to_int_type(MPI::MessageTag::Completion));
+
 	/*
  	 * We must synchronize here so these messages don't end up in
  	 * the queue for a receive operation done when the Task-0 is
  	 * still sending out data.
  	 */
-	::MPI::COMM_WORLD.Barrier();
+	upstream.Barrier();
 	MPI::logMessage(*log, "Sending final message");
 	const BE::MPI::taskstat_t rawTaskStatus = to_int_type(taskStatus);
-	::MPI::COMM_WORLD.Send((void *)&rawTaskStatus, 1, MPI_INT32_T,
+	upstream.Send((void *)&rawTaskStatus, 1, MPI_INT32_T,
 	    0, to_int_type(MPI::MessageTag::Control));
 }
 
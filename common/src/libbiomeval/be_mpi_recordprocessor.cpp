@@ -7,6 +7,7 @@
  * its use by other parties, and makes no guarantees, expressed or implied,
  * about its quality, reliability, or any other characteristic.
  */
+#include <be_io_shardedrecstore.h>
 #include <be_mpi_recordprocessor.h>
 #include <be_mpi_runtime.h>
 
@@ -35,16 +36,24 @@ BiometricEvaluation::MPI::RecordProcessor::getResources()
 	return (_resources);
 }
 
+bool
+BiometricEvaluation::MPI::RecordProcessor::isRecordProcessed(
+    const std::string &key)
+{
+	return (false);
+}
+
 void
 BiometricEvaluation::MPI::RecordProcessor::processWorkPackage(
     MPI::WorkPackage &workPackage)
 {
 	/*
-	 * Extract the key/value data from the work package
+	 * Extract the key/value data from the work package, which
+	 * may be in memory shared with the Receiver, without copying.
 	 */
-	 Memory::uint8Array packageData(0);
-	 workPackage.getData(packageData);
+	const Memory::ByteView packageData = workPackage.getDataView();
 	 uint64_t numElements = workPackage.getNumElements();
+	const bool resuming = this->_resources->getResumeFromCheckpoint();
 
 	/*
 	 * Call the implementation's record processor function
@@ -85,7 +94,11 @@ BiometricEvaluation::MPI::RecordProcessor::processWorkPackage(
 			break;
 		}
 		try {
-			if (valueSize > 0) {
+			if (this->_resources->getDistributeShards()) {
+				this->processShard(key);
+			} else if (resuming && this->isRecordProcessed(key)) {
+				continue;
+			} else if (valueSize > 0) {
 				this->processRecord(key, value);
 			} else {
 				this->processRecord(key);
@@ -101,3 +114,36 @@ BiometricEvaluation::MPI::RecordProcessor::processWorkPackage(
 	}
 }
 
+void
+BiometricEvaluation::MPI::RecordProcessor::processShard(
+    const std::string &shardIndex)
+{
+	const std::shared_ptr<IO::ShardedRecordStore> sharded =
+	    std::dynamic_pointer_cast<IO::ShardedRecordStore>(
+	    this->_resources->getRecordStore());
+	if (!sharded)
+		throw Error::Exception("Do not have sharded input record "
+		    "store");
+	const std::shared_ptr<IO::RecordStore> shard = sharded->getShard(
+	    std::stoul(shardIndex));
+
+	const bool resuming = this->_resources->getResumeFromCheckpoint();
+	IO::RecordStore::Record record;
+	int cursor = IO::RecordStore::BE_RECSTORE_SEQ_START;
+	while (true) {
+		if (MPI::QuickExit || MPI::TermExit) {
+			IO::Logsheet *log = this->getLogsheet().get();
+			log->writeDebug("Early exit: End shard processing");
+			break;
+		}
+		try {
+			record = shard->sequence(cursor);
+		} catch (const Error::ObjectDoesNotExist &) {
+			break;
+		}
+		cursor = IO::RecordStore::BE_RECSTORE_SEQ_NEXT;
+		if (resuming && this->isRecordProcessed(record.key))
+			continue;
+		this->processRecord(record.key, record.data);
+	}
+}
@@ -8,6 +8,14 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+#include <be_io_shardedrecstore.h>
+#include <be_io_utility.h>
+#include <be_mpi.h>
 #include <be_mpi_recordstoredistributor.h>
 
 namespace BE = BiometricEvaluation;
@@ -19,7 +27,8 @@ BiometricEvaluation::MPI::RecordStoreDistributor::RecordStoreDistributor(
     const std::string &propertiesFileName,
     const bool includeValues) :
     Distributor(propertiesFileName),
-    _includeValues(includeValues)
+    _includeValues(includeValues),
+    _nextPosition(0)
 {
 	try {
 		this->_resources.reset(
@@ -36,10 +45,46 @@ BiometricEvaluation::MPI::RecordStoreDistributor::RecordStoreDistributor(
 		if (this->_resources->haveRecordStore() == false) {
 			throw (Error::Exception(
 			    "Do not have input record store"));
+		}
+		this->_shardedRecordStore =
+		    std::dynamic_pointer_cast<IO::ShardedRecordStore>(
+		    this->_resources->getRecordStore());
+		if (this->_resources->getDistributeShards()) {
+			/* Shards are counted in place of records */
+			if (!this->_shardedRecordStore)
+				throw (Error::Exception("Input record store "
+				    "is not sharded"));
+			this->_recordsRemaining =
+			    this->_shardedRecordStore->getShardCount();
 		} else {
 			this->_recordsRemaining =
 			     this->_resources->getRecordStore()->getCount();
 		}
+
+		const std::string journalPath =
+		    this->_resources->getCheckpointJournal();
+		if (!journalPath.empty()) {
+			const uint64_t inputCount = this->_recordsRemaining;
+			uint64_t completed = 0;
+			if (this->_resources->getResumeFromCheckpoint() &&
+			    IO::Utility::fileExists(journalPath)) {
+				completed = this->resumeJournal(inputCount);
+			} else {
+				this->_journal.open(journalPath,
+				    std::ios::out | std::ios::trunc);
+				this->_journal << inputCount << '\n';
+				this->_journal.flush();
+			}
+			if (!this->_journal)
+				throw Error::FileError("Could not write "
+				    "checkpoint journal " + journalPath);
+			this->_recordsRemaining -= completed;
+
+			std::ostringstream sstr;
+			sstr << "Checkpoint journal " << journalPath << ": " <<
+			    completed << " of " << inputCount << " completed";
+			MPI::logMessage(*this->getLogsheet(), sstr.str());
+		}
 	}
 }
 
@@ -51,6 +96,154 @@ BiometricEvaluation::MPI::RecordStoreDistributor::~RecordStoreDistributor()
 	this->_recordsRemaining = 0;
 }
 
+uint64_t
+BiometricEvaluation::MPI::RecordStoreDistributor::resumeJournal(
+    uint64_t inputCount)
+{
+	const std::string journalPath =
+	    this->_resources->getCheckpointJournal();
+
+	/*
+	 * The first line is the number of records or shards in the
+	 * input, and each other line a completed range: the first
+	 * position, the number of positions, and the last key. A line
+	 * without a newline was being written when the job stopped.
+	 */
+	std::ifstream ifs(journalPath);
+	std::string line;
+	if (!std::getline(ifs, line) || ifs.eof())
+		throw Error::FileError("Could not read checkpoint journal " +
+		    journalPath);
+	uint64_t journalCount;
+	std::istringstream header(line);
+	if (!(header >> journalCount) || (journalCount != inputCount))
+		throw Error::ParameterError("Checkpoint journal " +
+		    journalPath + " is not for this input record store");
+
+	std::vector<PackageRange> ranges;
+	while (std::getline(ifs, line) && !ifs.eof()) {
+		std::istringstream entry(line);
+		PackageRange range;
+		if (!(entry >> range.first >> range.count) ||
+		    (range.count == 0) || (range.first >= inputCount))
+			continue;
+		range.count = std::min(range.count, inputCount - range.first);
+		if (entry.get() == ' ')
+			std::getline(entry, range.lastKey);
+		ranges.push_back(range);
+	}
+	ifs.close();
+
+	/* Merge overlapping and adjacent ranges */
+	std::sort(ranges.begin(), ranges.end(),
+	    [](const PackageRange &lhs, const PackageRange &rhs) {
+		return (lhs.first < rhs.first);
+	    });
+	uint64_t completed = 0;
+	for (const auto &range : ranges) {
+		if (!this->_completedRanges.empty()) {
+			PackageRange &last =
+			    this->_completedRanges.rbegin()->second;
+			const uint64_t lastEnd = last.first + last.count;
+			if (range.first <= lastEnd) {
+				const uint64_t end = range.first + range.count;
+				if (end > lastEnd) {
+					completed += end - lastEnd;
+					last.count = end - last.first;
+					last.lastKey = range.lastKey;
+				}
+				continue;
+			}
+		}
+		completed += range.count;
+		this->_completedRanges[range.first] = range;
+	}
+
+	/* Replace the journal with the merged ranges */
+	const std::string compactPath = journalPath + ".tmp";
+	std::ofstream compact(compactPath, std::ios::out | std::ios::trunc);
+	compact << inputCount << '\n';
+	for (const auto &range : this->_completedRanges)
+		compact << range.second.first << ' ' << range.second.count <<
+		    ' ' << range.second.lastKey << '\n';
+	compact.close();
+	if (!compact || (std::rename(compactPath.c_str(),
+	    journalPath.c_str()) != 0))
+		throw Error::FileError("Could not write checkpoint journal " +
+		    compactPath);
+	this->_journal.open(journalPath, std::ios::out | std::ios::app);
+
+	return (completed);
+}
+
+void
+BiometricEvaluation::MPI::RecordStoreDistributor::skipCompleted(
+    IO::RecordStore *recordStore)
+{
+	if (this->_completedRanges.empty())
+		return;
+	const auto range = this->_completedRanges.begin();
+	if (range->first != this->_nextPosition)
+		return;
+
+	/*
+	 * Ranges were merged, so the next position is not completed.
+	 * Find it by key where possible, since sequencing through the
+	 * completed records could take as long as reading them.
+	 */
+	const uint64_t end = range->second.first + range->second.count;
+	if (recordStore != nullptr) {
+		bool found = false;
+		if (!range->second.lastKey.empty()) {
+			try {
+				recordStore->setCursorAtKey(
+				    range->second.lastKey);
+				recordStore->sequenceKey();
+				found = true;
+			} catch (Error::Exception &e) {
+				this->getLogsheet()->writeDebug("Checkpoint "
+				    "key not found: " + e.whatString());
+			}
+		}
+		if (!found) {
+			for (uint64_t p = this->_nextPosition; p < end; p++) {
+				try {
+					recordStore->sequenceKey();
+				} catch (Error::Exception &e) {
+					this->getLogsheet()->writeDebug(
+					    "Caught " + e.whatString());
+				}
+			}
+		}
+	}
+	this->_nextPosition = end;
+	this->_completedRanges.erase(range);
+}
+
+void
+BiometricEvaluation::MPI::RecordStoreDistributor::workPackageCompleted(
+    const uint64_t packageID)
+{
+	if (!this->_journal.is_open())
+		return;
+
+	PackageRange range;
+	{
+		std::lock_guard<std::mutex> lock(this->_packageRangesMutex);
+		const auto packageRange = this->_packageRanges.find(packageID);
+		if (packageRange == this->_packageRanges.end())
+			return;
+		range = packageRange->second;
+		this->_packageRanges.erase(packageRange);
+	}
+
+	this->_journal << range.first << ' ' << range.count << ' ' <<
+	    range.lastKey << '\n';
+	this->_journal.flush();
+	if (!this->_journal)
+		throw Error::FileError("Could not write checkpoint journal");
+}
+
 /*
  * Add a string key to the given buffer, preceded by the length of the
  * key. The key is written as characters, without the nul terminator.
@@ -105,6 +298,32 @@ BiometricEvaluation::MPI::RecordStoreDistributor::createWorkPackage(
 		return;
 	}
 
+	/*
+	 * Hand out one whole shard, named by its index. The processor
+	 * reads the shard's records itself.
+	 */
+	BE::Memory::uint8Array::size_type index = 0;
+	PackageRange range;
+	if (this->_resources->getDistributeShards()) {
+		this->_recordsRemaining--;
+		this->skipCompleted(nullptr);
+		range.first = this->_nextPosition++;
+		range.count = 1;
+		range.lastKey = std::to_string(range.first);
+		BE::Memory::uint8Array noValue(0);
+		fillBufferWithKeyAndValue(packageData, range.lastKey,
+		    noValue, index);
+		workPackage.setNumElements(1);
+		workPackage.setData(packageData);
+		workPackage.setLocality(range.first);
+		if (!this->_resources->getCheckpointJournal().empty()) {
+			std::lock_guard<std::mutex> lock(
+			    this->_packageRangesMutex);
+			this->_packageRanges[workPackage.getID()] = range;
+		}
+		return;
+	}
+
 	/*
 	 * Distribute a work package based on the chunk size given
 	 * in the resources object. If a failure occurs reading a key,
@@ -125,7 +344,6 @@ BiometricEvaluation::MPI::RecordStoreDistributor::createWorkPackage(
 	 * if values are not to be sent.
 	 */
 	BE::IO::RecordStore::Record record;
-	BE::Memory::uint8Array::size_type index = 0;
 	uint64_t realKeyCount = 0;
 	std::shared_ptr<IO::RecordStore> recordStore =
 	    this->_resources->getRecordStore();
@@ -135,6 +353,11 @@ BiometricEvaluation::MPI::RecordStoreDistributor::createWorkPackage(
 	 * combine a chunk of them into a single work package.
 	 */
 	for (uint64_t n = 0; n < keyCount; n++) {
+		this->skipCompleted(recordStore.get());
+		if (n == 0)
+			range.first = this->_nextPosition;
+		this->_nextPosition++;
+		range.lastKey.clear();
 		try {
 			if (this->_includeValues)
 				record = recordStore->sequence();
@@ -146,8 +369,20 @@ BiometricEvaluation::MPI::RecordStoreDistributor::createWorkPackage(
 			log->writeDebug("Caught " + e.whatString());
 			continue;
 		}
+		if (this->_shardedRecordStore && (realKeyCount == 0))
+			workPackage.setLocality(
+			    this->_shardedRecordStore->getShardIndex(
+			    record.key));
+		/* A key that would split its journal line is not kept */
+		if (record.key.find('\n') == std::string::npos)
+			range.lastKey = record.key;
 		realKeyCount++;
 	}
+	range.count = this->_nextPosition - range.first;
+	if (!this->_resources->getCheckpointJournal().empty()) {
+		std::lock_guard<std::mutex> lock(this->_packageRangesMutex);
+		this->_packageRanges[workPackage.getID()] = range;
+	}
 
 	/*
 	 * NOTE: At this point it is possible to have no keys in the package.
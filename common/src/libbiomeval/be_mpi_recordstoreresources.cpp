@@ -22,6 +22,15 @@ BiometricEvaluation::MPI::RecordStoreResources::INPUTRSPROPERTY =
 const std::string
 BiometricEvaluation::MPI::RecordStoreResources::CHUNKSIZEPROPERTY =
     "Chunk Size";
+const std::string
+BiometricEvaluation::MPI::RecordStoreResources::DISTRIBUTESHARDSPROPERTY =
+    "Distribute Shards";
+const std::string
+BiometricEvaluation::MPI::RecordStoreResources::CHECKPOINTJOURNALPROPERTY =
+    "Checkpoint Journal";
+const std::string
+BiometricEvaluation::MPI::RecordStoreResources::RESUMEFROMCHECKPOINTPROPERTY =
+    "Resume From Checkpoint";
 
 /******************************************************************************/
 /* Class method definitions.                                                  */
@@ -49,6 +58,35 @@ BiometricEvaluation::MPI::RecordStoreResources::RecordStoreResources(
 		throw Error::ObjectDoesNotExist("Could not read properties: " +
 		    e.whatString());
 	}
+
+	/*
+	 * Optional properties.
+	 */
+	try {
+		this->_distributeShards = props->getPropertyAsBoolean(
+		    MPI::RecordStoreResources::DISTRIBUTESHARDSPROPERTY);
+	} catch (Error::Exception &e) {
+		this->_distributeShards = false;
+	}
+
+	try {
+		this->_checkpointJournal = props->getProperty(
+		    MPI::RecordStoreResources::CHECKPOINTJOURNALPROPERTY);
+	} catch (Error::Exception &e) {
+		this->_checkpointJournal = "";
+	}
+	try {
+		this->_resumeFromCheckpoint = props->getPropertyAsBoolean(
+		    MPI::RecordStoreResources::RESUMEFROMCHECKPOINTPROPERTY);
+	} catch (Error::Exception &e) {
+		this->_resumeFromCheckpoint = false;
+	}
+	if (this->_resumeFromCheckpoint && this->_checkpointJournal.empty())
+		throw Error::ParameterError(
+		    MPI::RecordStoreResources::RESUMEFROMCHECKPOINTPROPERTY +
+		    " requires " +
+		    MPI::RecordStoreResources::CHECKPOINTJOURNALPROPERTY);
+
 	try {
 		this->_recordStore = IO::RecordStore::openRecordStore(
 		    RSName, IO::Mode::ReadOnly);
@@ -71,6 +109,25 @@ BiometricEvaluation::MPI::RecordStoreResources::getChunkSize() const
 	return (this->_chunkSize);
 }
 
+bool
+BiometricEvaluation::MPI::RecordStoreResources::getDistributeShards() const
+{
+	return (this->_distributeShards);
+}
+
+std::string
+BiometricEvaluation::MPI::RecordStoreResources::getCheckpointJournal() const
+{
+	return (this->_checkpointJournal);
+}
+
+bool
+BiometricEvaluation::MPI::RecordStoreResources::getResumeFromCheckpoint()
+    const
+{
+	return (this->_resumeFromCheckpoint);
+}
+
 bool
 BiometricEvaluation::MPI::RecordStoreResources::haveRecordStore() const
 {
@@ -98,6 +155,10 @@ BiometricEvaluation::MPI::RecordStoreResources::getOptionalProperties()
 {
 	std::vector<std::string> props;
 	props = MPI::Resources::getOptionalProperties();
+	props.push_back(MPI::RecordStoreResources::DISTRIBUTESHARDSPROPERTY);
+	props.push_back(MPI::RecordStoreResources::CHECKPOINTJOURNALPROPERTY);
+	props.push_back(
+	    MPI::RecordStoreResources::RESUMEFROMCHECKPOINTPROPERTY);
 	return (props);
 }
 
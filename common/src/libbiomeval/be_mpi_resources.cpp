@@ -30,6 +30,19 @@ const std::string
 BiometricEvaluation::MPI::Resources::WORKERSPERNODEPROPERTY("Workers Per Node");
 const std::string
 BiometricEvaluation::MPI::Resources::LOGSHEETURLPROPERTY("Logsheet URL");
+const std::string
+BiometricEvaluation::MPI::Resources::WORKPACKAGEQUEUEDEPTHPROPERTY(
+    "Work Package Queue Depth");
+const std::string
+BiometricEvaluation::MPI::Resources::PACKAGEPOOLSLOTSIZEPROPERTY(
+    "Package Pool Slot Size");
+const std::string
+BiometricEvaluation::MPI::Resources::NODEDISTRIBUTORSPROPERTY(
+    "Node Distributors");
+const std::string
+BiometricEvaluation::MPI::Resources::TASKSPERNODEPROPERTY("Tasks Per Node");
+const std::string
+BiometricEvaluation::MPI::Resources::NODEBATCHSIZEPROPERTY("Node Batch Size");
 
 /******************************************************************************/
 /* Class method definitions.                                                  */
@@ -70,6 +83,56 @@ BiometricEvaluation::MPI::Resources::Resources(
 	} catch (Error::Exception &e) {
 		this->_logsheetURL = "";
 	}
+	try {
+		this->_workPackageQueueDepth = props->getPropertyAsInteger(
+		    MPI::Resources::WORKPACKAGEQUEUEDEPTHPROPERTY);
+	} catch (Error::Exception &e) {
+		this->_workPackageQueueDepth = 0;
+	}
+	if (this->_workPackageQueueDepth < 0)
+		throw Error::ParameterError(
+		    MPI::Resources::WORKPACKAGEQUEUEDEPTHPROPERTY +
+		    " must not be negative");
+
+	int64_t slotSize;
+	try {
+		slotSize = props->getPropertyAsInteger(
+		    MPI::Resources::PACKAGEPOOLSLOTSIZEPROPERTY);
+	} catch (Error::Exception &e) {
+		slotSize = MPI::Resources::DEFAULTPACKAGEPOOLSLOTSIZE;
+	}
+	if (slotSize < 0)
+		throw Error::ParameterError(
+		    MPI::Resources::PACKAGEPOOLSLOTSIZEPROPERTY +
+		    " must not be negative");
+	this->_packagePoolSlotSize = static_cast<uint64_t>(slotSize);
+
+	try {
+		this->_nodeDistributors = props->getPropertyAsBoolean(
+		    MPI::Resources::NODEDISTRIBUTORSPROPERTY);
+	} catch (Error::Exception &e) {
+		this->_nodeDistributors = false;
+	}
+	try {
+		this->_tasksPerNode = props->getPropertyAsInteger(
+		    MPI::Resources::TASKSPERNODEPROPERTY);
+	} catch (Error::Exception &e) {
+		this->_tasksPerNode = 0;
+	}
+	if (this->_tasksPerNode < 0)
+		throw Error::ParameterError(
+		    MPI::Resources::TASKSPERNODEPROPERTY +
+		    " must not be negative");
+	try {
+		this->_nodeBatchSize = props->getPropertyAsInteger(
+		    MPI::Resources::NODEBATCHSIZEPROPERTY);
+	} catch (Error::Exception &e) {
+		this->_nodeBatchSize = 0;
+	}
+	if (this->_nodeBatchSize < 0)
+		throw Error::ParameterError(
+		    MPI::Resources::NODEBATCHSIZEPROPERTY +
+		    " must not be negative");
 }
 
 std::vector<std::string>
@@ -85,6 +148,11 @@ BiometricEvaluation::MPI::Resources::getOptionalProperties()
 {
 	std::vector<std::string> props;
 	props.push_back(MPI::Resources::LOGSHEETURLPROPERTY);
+	props.push_back(MPI::Resources::WORKPACKAGEQUEUEDEPTHPROPERTY);
+	props.push_back(MPI::Resources::PACKAGEPOOLSLOTSIZEPROPERTY);
+	props.push_back(MPI::Resources::NODEDISTRIBUTORSPROPERTY);
+	props.push_back(MPI::Resources::TASKSPERNODEPROPERTY);
+	props.push_back(MPI::Resources::NODEBATCHSIZEPROPERTY);
 	return (props);
 }
 
@@ -101,6 +169,36 @@ BiometricEvaluation::MPI::Resources::getLogsheetURL() const
 	return (this->_logsheetURL);
 }
 
+int
+BiometricEvaluation::MPI::Resources::getWorkPackageQueueDepth() const
+{
+	return (this->_workPackageQueueDepth);
+}
+
+uint64_t
+BiometricEvaluation::MPI::Resources::getPackagePoolSlotSize() const
+{
+	return (this->_packagePoolSlotSize);
+}
+
+bool
+BiometricEvaluation::MPI::Resources::getNodeDistributors() const
+{
+	return (this->_nodeDistributors);
+}
+
+int
+BiometricEvaluation::MPI::Resources::getTasksPerNode() const
+{
+	return (this->_tasksPerNode);
+}
+
+int
+BiometricEvaluation::MPI::Resources::getNodeBatchSize() const
+{
+	return (this->_nodeBatchSize);
+}
+
 std::string
 BiometricEvaluation::MPI::Resources::getPropertiesFileName() const
 {
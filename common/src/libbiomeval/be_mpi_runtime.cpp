@@ -13,6 +13,8 @@
 
 #include <be_mpi_runtime.h>
 
+#include "be_mpi_topology.h"
+
 using namespace BiometricEvaluation;
 
 BiometricEvaluation::MPI::Runtime::Runtime(int &argc, char **&argv)
@@ -74,16 +76,20 @@ BiometricEvaluation::MPI::Runtime::start(
     BiometricEvaluation::MPI::Receiver &receiver)
 {
 	setExitConditions();
-	if (::MPI::COMM_WORLD.Get_rank() == 0)
+
+	/* Every task finds its part together, from the same properties */
+	const auto topology = std::make_shared<Topology>(
+	    *distributor._resources);
+	if (topology->getRole() != Topology::Role::Receiver)
 		try {
-			distributor.start();
+			distributor.start(topology);
 		} catch (Error::Exception &e) {
 			printStatus("Could not start distributor: "
 			    + e.whatString());
 		}
 	else
 		try {
-			receiver.start();
+			receiver.start(topology);
 		} catch (Error::Exception &e) {
 			printStatus("Could not start receiver: "
 			    + e.whatString());
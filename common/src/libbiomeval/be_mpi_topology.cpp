@@ -0,0 +1,150 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties.  Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain.  NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+#include <climits>
+
+#include <mpi.h>
+
+#include <be_error_exception.h>
+
+#include "be_mpi_topology.h"
+
+namespace BE = BiometricEvaluation;
+
+/*
+ * Find the node of this task: the lowest rank of the tasks sharing
+ * memory with it, or of its group of tasksPerNode consecutive ranks.
+ */
+static int
+findNode(
+    int tasksPerNode)
+{
+	const int rank = ::MPI::COMM_WORLD.Get_rank();
+	if (tasksPerNode > 0)
+		return ((rank / tasksPerNode) * tasksPerNode);
+
+	MPI_Comm shared;
+	MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+	    MPI_INFO_NULL, &shared);
+	::MPI::Intracomm sharedComm(shared);
+	int node;
+	sharedComm.Allreduce(&rank, &node, 1, MPI_INT, MPI_MIN);
+	sharedComm.Free();
+	return (node);
+}
+
+/******************************************************************************/
+/* Class method definitions.                                                  */
+/******************************************************************************/
+BiometricEvaluation::MPI::Topology::Topology() :
+    _nodeTaskCounts(::MPI::COMM_WORLD.Get_size(), 0)
+{
+	if (::MPI::COMM_WORLD.Get_rank() == 0) {
+		this->_role = Role::Distributor;
+		this->_downstream.reset(new ::MPI::Intracomm(
+		    ::MPI::COMM_WORLD));
+	} else {
+		this->_role = Role::Receiver;
+		this->_upstream.reset(new ::MPI::Intracomm(
+		    ::MPI::COMM_WORLD));
+	}
+}
+
+BiometricEvaluation::MPI::Topology::Topology(
+    const Resources &resources) :
+    Topology()
+{
+	if (!resources.getNodeDistributors())
+		return;
+	this->_upstream.reset();
+	this->_downstream.reset();
+
+	/*
+	 * Task-0 is left out of its node, as it only talks to node
+	 * distributors and tasks that are alone on their node.
+	 */
+	const int rank = ::MPI::COMM_WORLD.Get_rank();
+	const int node = findNode(resources.getTasksPerNode());
+	::MPI::Intracomm nodeComm = ::MPI::COMM_WORLD.Split(
+	    (rank == 0) ? MPI_UNDEFINED : node, rank);
+	const bool nodeLead = (rank != 0) && (nodeComm.Get_rank() == 0);
+	::MPI::Intracomm topComm = ::MPI::COMM_WORLD.Split(
+	    ((rank == 0) || nodeLead) ? 0 : MPI_UNDEFINED, rank);
+
+	int nodeTaskCount = 0;
+	if (rank == 0) {
+		this->_role = Role::Distributor;
+		this->_downstream.reset(new ::MPI::Intracomm(topComm));
+	} else if (nodeLead && (nodeComm.Get_size() > 1)) {
+		this->_role = Role::NodeDistributor;
+		this->_upstream.reset(new ::MPI::Intracomm(topComm));
+		this->_downstream.reset(new ::MPI::Intracomm(nodeComm));
+		nodeTaskCount = nodeComm.Get_size() - 1;
+	} else if (nodeLead) {
+		this->_role = Role::Receiver;
+		this->_upstream.reset(new ::MPI::Intracomm(topComm));
+		nodeComm.Free();
+	} else {
+		this->_role = Role::Receiver;
+		this->_upstream.reset(new ::MPI::Intracomm(nodeComm));
+	}
+
+	/* Task-0 needs to know which of its tasks serve others */
+	if ((rank == 0) || nodeLead) {
+		this->_nodeTaskCounts.assign(topComm.Get_size(), 0);
+		topComm.Gather(&nodeTaskCount, 1, MPI_INT,
+		    this->_nodeTaskCounts.data(), 1, MPI_INT, 0);
+	}
+}
+
+/******************************************************************************/
+/* Object method definitions.                                                 */
+/******************************************************************************/
+BiometricEvaluation::MPI::Topology::~Topology()
+{
+	/* Tasks are often destroyed after Runtime::shutdown() */
+	if (::MPI::Is_finalized())
+		return;
+	if (this->_upstream && (*this->_upstream != ::MPI::COMM_WORLD))
+		this->_upstream->Free();
+	if (this->_downstream && (*this->_downstream != ::MPI::COMM_WORLD))
+		this->_downstream->Free();
+}
+
+BiometricEvaluation::MPI::Topology::Role
+BiometricEvaluation::MPI::Topology::getRole() const
+{
+	return (this->_role);
+}
+
+::MPI::Intracomm &
+BiometricEvaluation::MPI::Topology::getUpstream() const
+{
+	if (!this->_upstream)
+		throw Error::ObjectDoesNotExist("Distributor has no upstream");
+	return (*this->_upstream);
+}
+
+::MPI::Intracomm &
+BiometricEvaluation::MPI::Topology::getDownstream() const
+{
+	if (!this->_downstream)
+		throw Error::ObjectDoesNotExist("Receiver has no downstream");
+	return (*this->_downstream);
+}
+
+int
+BiometricEvaluation::MPI::Topology::getNodeTaskCount(
+    int task) const
+{
+	if ((task < 0) ||
+	    (static_cast<size_t>(task) >= this->_nodeTaskCounts.size()))
+		return (0);
+	return (this->_nodeTaskCounts[task]);
+}
@@ -0,0 +1,132 @@
+/**
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties.  Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain.  NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+#ifndef _BE_MPI_TOPOLOGY_H
+#define _BE_MPI_TOPOLOGY_H
+
+#include <memory>
+#include <vector>
+
+#include <mpi.h>
+
+#include <be_mpi_resources.h>
+
+namespace BiometricEvaluation {
+	namespace MPI {
+		/**
+		 * @brief
+		 * The arrangement of the tasks of an MPI job.
+		 * @details
+		 * Normally, Task-0 distributes work packages to every
+		 * other task. When the Node Distributors property is true,
+		 * the other tasks are grouped into nodes, and the lowest
+		 * ranked task of each node becomes a node distributor,
+		 * which receives batches of work packages from Task-0 and
+		 * hands them out to the other tasks of its node. A task
+		 * that is alone on its node receives work packages from
+		 * Task-0 directly.
+		 *
+		 * A task talks to the task distributing work to it
+		 * through its upstream communicator, and to the tasks
+		 * it distributes work to through its downstream
+		 * communicator. In each, the distributing task is rank 0.
+		 */
+		class Topology {
+		public:
+			/** The part a task plays in distributing work */
+			enum class Role
+			{
+				/** Task-0, which creates the work packages */
+				Distributor,
+				/** Hands out work packages within a node */
+				NodeDistributor,
+				/** Passes work packages to its workers */
+				Receiver
+			};
+
+			/**
+			 * @brief
+			 * Construct the arrangement in which Task-0
+			 * distributes work to every other task.
+			 */
+			Topology();
+
+			/**
+			 * @brief
+			 * Construct the arrangement given by a set of
+			 * resources.
+			 * @note
+			 * Every task of the job must construct a Topology
+			 * from the same properties at the same point, as
+			 * the tasks exchange messages to find their nodes.
+			 * @param[in] resources
+			 * The resources of this task.
+			 */
+			Topology(const Resources &resources);
+
+			~Topology();
+
+			/**
+			 * @brief
+			 * Obtain the part this task plays.
+			 * @return
+			 * The role of this task.
+			 */
+			Role getRole() const;
+
+			/**
+			 * @brief
+			 * Obtain the communicator shared with the task
+			 * that distributes work to this task.
+			 * @return
+			 * The upstream communicator.
+			 * @throw Error::ObjectDoesNotExist
+			 * This task is the Distributor.
+			 */
+			::MPI::Intracomm &getUpstream() const;
+
+			/**
+			 * @brief
+			 * Obtain the communicator shared with the tasks
+			 * to which this task distributes work.
+			 * @return
+			 * The downstream communicator.
+			 * @throw Error::ObjectDoesNotExist
+			 * This task is a Receiver.
+			 */
+			::MPI::Intracomm &getDownstream() const;
+
+			/**
+			 * @brief
+			 * Obtain the number of tasks to which a downstream
+			 * task hands out work.
+			 * @details
+			 * Only known to the Distributor.
+			 * @param[in] task
+			 * Rank of the task in the downstream communicator.
+			 * @return
+			 * Number of tasks served by task when it is a node
+			 * distributor, 0 otherwise.
+			 */
+			int getNodeTaskCount(int task) const;
+
+			Topology(const Topology&) = delete;
+			Topology& operator=(const Topology&) = delete;
+
+		private:
+			Role _role;
+			std::unique_ptr<::MPI::Intracomm> _upstream;
+			std::unique_ptr<::MPI::Intracomm> _downstream;
+			/* Tasks served by each downstream task */
+			std::vector<int> _nodeTaskCounts;
+		};
+	}
+}
+
+#endif /* _BE_MPI_TOPOLOGY_H */
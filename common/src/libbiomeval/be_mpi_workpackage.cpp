@@ -8,6 +8,8 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <cstring>
+
 #include <be_mpi_workpackage.h>
 
 using namespace BiometricEvaluation;
@@ -15,16 +17,31 @@ using namespace BiometricEvaluation;
 /******************************************************************************/
 /* Class method definitions.                                                  */
 /******************************************************************************/
-BiometricEvaluation::MPI::WorkPackage::WorkPackage()
+BiometricEvaluation::MPI::WorkPackage::WorkPackage() :
+    _numElements(0),
+    _id(0),
+    _locality(ANYLOCALITY)
 {
 }
 
 BiometricEvaluation::MPI::WorkPackage::WorkPackage(
-    const Memory::uint8Array &data)
+    const Memory::uint8Array &data) :
+    _numElements(0),
+    _id(0),
+    _locality(ANYLOCALITY)
 {
 	this->_data = data;
 }
 
+BiometricEvaluation::MPI::WorkPackage::WorkPackage(
+    const Memory::ByteView &data) :
+    _externalData(data),
+    _numElements(0),
+    _id(0),
+    _locality(ANYLOCALITY)
+{
+}
+
 /******************************************************************************/
 /* Object method definitions.                                                 */
 /******************************************************************************/
@@ -36,19 +53,32 @@ void
 BiometricEvaluation::MPI::WorkPackage::getData(Memory::uint8Array &data)
     const
 {
-	data = this->_data;
+	const Memory::ByteView view = this->getDataView();
+	data.resize(view.size());
+	if (!view.empty())
+		std::memcpy(data, view.data(), view.size());
+}
+
+BiometricEvaluation::Memory::ByteView
+BiometricEvaluation::MPI::WorkPackage::getDataView()
+    const
+{
+	if (this->_externalData.data() != nullptr)
+		return (this->_externalData);
+	return (Memory::ByteView(this->_data));
 }
 
 void
 BiometricEvaluation::MPI::WorkPackage::setData(const Memory::uint8Array &data)
 {
 	this->_data = data;
+	this->_externalData = Memory::ByteView();
 }
 
 uint64_t
 BiometricEvaluation::MPI::WorkPackage::getSize() const
 {
-	return (this->_data.size());
+	return (this->getDataView().size());
 }
 
 uint64_t
@@ -64,3 +94,29 @@ BiometricEvaluation::MPI::WorkPackage::setNumElements(
 	this->_numElements = numElements;;
 }
 
+uint64_t
+BiometricEvaluation::MPI::WorkPackage::getID() const
+{
+	return (this->_id);
+}
+
+void
+BiometricEvaluation::MPI::WorkPackage::setID(
+    const uint64_t id)
+{
+	this->_id = id;
+}
+
+uint32_t
+BiometricEvaluation::MPI::WorkPackage::getLocality() const
+{
+	return (this->_locality);
+}
+
+void
+BiometricEvaluation::MPI::WorkPackage::setLocality(
+    const uint32_t locality)
+{
+	this->_locality = locality;
+}
+
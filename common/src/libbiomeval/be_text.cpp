@@ -14,7 +14,6 @@
 #endif
 
 #ifdef Darwin
-#include <CommonCrypto/CommonDigest.h>
 #include <CoreFoundation/CoreFoundation.h>
 #include <Security/Security.h>
 #else
@@ -23,12 +22,16 @@
 #endif
 
 #include <algorithm>
+#include <exception>
 #include <locale>
-#include <iomanip>
+#include <map>
+#include <memory>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #include <be_text.h>
+#include <be_text_digester.h>
 #include <be_memory_autoarray.h>
 
 namespace BE = BiometricEvaluation;
@@ -121,98 +124,76 @@ BiometricEvaluation::Text::digest(
     const size_t buffer_size,
     const std::string &digest)
 {
-#ifdef Darwin
-	/* Use CommonCrypto under OS X (10.4 or later) */
-	
- 	/* Length of the resulting digest */
-	CC_LONG digestLength;
-	/* Function pointer to the CommonCrypto digest function */
-	unsigned char *
-	(*digestFunction)
-	    (const void *data,
-	    CC_LONG len,
-	    unsigned char *md);
-	
-	/* Determine the digest requested */
-	if (strcasecmp(digest.c_str(), "md5") == 0) {
-		digestFunction = CC_MD5;
-		digestLength = CC_MD5_DIGEST_LENGTH;
-	} else if (strcasecmp(digest.c_str(), "md4") == 0) {
-		digestFunction = CC_MD4;
-		digestLength = CC_MD4_DIGEST_LENGTH;
-	} else if (strcasecmp(digest.c_str(), "md2") == 0) {
-		digestFunction = CC_MD2;
-		digestLength = CC_MD2_DIGEST_LENGTH;
-	} else if (strcasecmp(digest.c_str(), "sha1") == 0) {
-		digestFunction = CC_SHA1;
-		digestLength = CC_SHA1_DIGEST_LENGTH;
-	} else if (strcasecmp(digest.c_str(), "sha224") == 0) {
-		digestFunction = CC_SHA224;
-		digestLength = CC_SHA224_DIGEST_LENGTH;
-	} else if (strcasecmp(digest.c_str(), "sha256") == 0) {
-		digestFunction = CC_SHA256;
-		digestLength = CC_SHA256_DIGEST_LENGTH;
-	} else if (strcasecmp(digest.c_str(), "sha384") == 0) {
-		digestFunction = CC_SHA384;
-		digestLength = CC_SHA384_DIGEST_LENGTH;
-	} else if (strcasecmp(digest.c_str(), "sha512") == 0) {
-		digestFunction = CC_SHA512;
-		digestLength = CC_SHA512_DIGEST_LENGTH;
-	} else
-		throw Error::NotImplemented(digest);
-	
-	/* Obtain the digest */
-	Memory::AutoArray<unsigned char> md(digestLength);
-	if (digestFunction(buffer, buffer_size, md) == nullptr)
-		throw Error::StrategyError("Could not obtain digest");
-	
-	/* Stringify the digest */
-	std::stringstream ret;
-	for (CC_LONG i = 0; i < digestLength; i++)
-		ret << std::hex << std::setw(2) << std::setfill('0')
-		    << (int)md[i];
-		
-	return (ret.str());
-#else
-	/* Use OpenSSL everywhere else */
-	
-	/* This need only be called once per executable */
-	static bool digests_loaded = false;
-	if (!digests_loaded) {
-		OpenSSL_add_all_digests();
-		digests_loaded = true;
+	/* Reuse each thread's Digesters, avoiding lookup and allocation */
+	static thread_local std::map<std::string,
+	    std::unique_ptr<BE::Text::Digester>> digesters;
+	auto &digester = digesters[digest];
+	if (!digester) {
+		try {
+			digester.reset(new BE::Text::Digester(digest));
+		} catch (BE::Error::Exception &) {
+			digesters.erase(digest);
+			throw;
+		}
 	}
 
-	/* Supports any digest type supported by OpenSSL (MD5, SHA1, ...) */
-	const EVP_MD *md;
-	md = EVP_get_digestbyname(digest.c_str());
-	if (!md)
-		throw Error::StrategyError("Unknown message digest: " + digest);
-
-	EVP_MD_CTX mdctx;
-	EVP_MD_CTX_init(&mdctx);
-
-	EVP_DigestInit_ex(&mdctx, md, nullptr);
-	EVP_DigestUpdate(&mdctx, buffer, buffer_size);
-
-	unsigned char md_value[EVP_MAX_MD_SIZE];
-	unsigned int md_size;
-	EVP_DigestFinal_ex(&mdctx, md_value, &md_size);
+	digester->update(buffer, buffer_size);
+	return (digester->finalize());
+}
 
-	/*
-	 * While the EVP_MD_CTX may be safely reused, we have no way of knowing
-	 * when an app is finished with it, forcing us to free the structure 
-	 * every time.
-	 */
-	EVP_MD_CTX_cleanup(&mdctx);
+std::vector<std::string>
+BiometricEvaluation::Text::digestBatch(
+    const std::vector<Memory::uint8Array> &buffers,
+    const std::string &digest,
+    unsigned int threadCount)
+{
+	std::vector<std::string> digests(buffers.size());
+	if (buffers.empty())
+		return (digests);
+
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	threadCount = std::min<size_t>(threadCount, buffers.size());
+
+	/* Construct all Digesters first to report unsupported digests */
+	std::vector<BE::Text::Digester> digesters;
+	for (unsigned int i = 0; i < threadCount; i++)
+		digesters.emplace_back(digest);
+
+	/* Each thread hashes a contiguous range of buffers */
+	std::vector<std::exception_ptr> errors(threadCount);
+	const auto hashRange = [&](unsigned int t) {
+		const size_t first = (buffers.size() * t) / threadCount;
+		const size_t last = (buffers.size() * (t + 1)) / threadCount;
+		try {
+			for (size_t i = first; i < last; i++) {
+				digesters[t].update(buffers[i]);
+				digests[i] = digesters[t].finalize();
+			}
+		} catch (...) {
+			errors[t] = std::current_exception();
+		}
+	};
+
+	/* Threads still running when one cannot start must be joined */
+	std::vector<std::thread> threads;
+	try {
+		for (unsigned int t = 1; t < threadCount; t++)
+			threads.emplace_back(hashRange, t);
+	} catch (...) {
+		for (auto &thread : threads)
+			thread.join();
+		throw;
+	}
+	hashRange(0);
+	for (auto &thread : threads)
+		thread.join();
 
-	std::stringstream ret;
-	for (unsigned int i = 0; i < md_size; i++)
-		ret << std::hex << std::setw(2) << std::setfill('0') <<
-		    (int)md_value[i];
+	for (const auto &error : errors)
+		if (error)
+			std::rethrow_exception(error);
 
-	return ret.str();
-#endif
+	return (digests);
 }
 
 std::string
@@ -224,6 +205,15 @@ BiometricEvaluation::Text::digest(
 	    digest));
 }
 
+std::string
+BiometricEvaluation::Text::digest(
+    Memory::ByteView buffer,
+    const std::string &digest)
+{
+	return (BiometricEvaluation::Text::digest(buffer.data(),
+	    buffer.size(), digest));
+}
+
 std::vector<std::string>
 BiometricEvaluation::Text::split(
     const std::string &str,
@@ -413,6 +403,29 @@ BiometricEvaluation::Text::encodeBase64(
 #endif /* Darwin */
 }
 
+std::string
+BiometricEvaluation::Text::encodeHex(
+    const void *data,
+    const size_t size)
+{
+	static const char digits[] = "0123456789abcdef";
+
+	const uint8_t *bytes = static_cast<const uint8_t*>(data);
+	std::string hex(size * 2, '\0');
+	for (size_t i = 0; i < size; i++) {
+		hex[(i * 2)] = digits[bytes[i] >> 4];
+		hex[(i * 2) + 1] = digits[bytes[i] & 0x0F];
+	}
+	return (hex);
+}
+
+std::string
+BiometricEvaluation::Text::encodeHex(
+    const BiometricEvaluation::Memory::uint8Array &data)
+{
+	return (BiometricEvaluation::Text::encodeHex(data, data.size()));
+}
+
 BiometricEvaluation::Memory::uint8Array
 BiometricEvaluation::Text::decodeBase64(
     const std::string &data)
@@ -0,0 +1,90 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <be_text.h>
+#include <be_text_digester.h>
+
+#include "be_text_digester_impl.h"
+
+const std::string BiometricEvaluation::Text::Digester::XXH64("xxh64");
+
+BiometricEvaluation::Text::Digester::Digester(
+    const std::string &digest) :
+    pimpl{new BiometricEvaluation::Text::Digester::Impl(digest)}
+{
+
+}
+
+void
+BiometricEvaluation::Text::Digester::update(
+    const void *buffer,
+    const size_t size)
+{
+	this->pimpl->update(buffer, size);
+}
+
+void
+BiometricEvaluation::Text::Digester::update(
+    const Memory::uint8Array &buffer)
+{
+	this->pimpl->update(buffer, buffer.size());
+}
+
+void
+BiometricEvaluation::Text::Digester::update(
+    const std::string &s)
+{
+	this->pimpl->update(s.data(), s.length());
+}
+
+void
+BiometricEvaluation::Text::Digester::update(
+    std::istream &stream)
+{
+	this->pimpl->update(stream);
+}
+
+std::string
+BiometricEvaluation::Text::Digester::finalize()
+{
+	return (BiometricEvaluation::Text::encodeHex(
+	    this->pimpl->finalizeBytes()));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Text::Digester::finalizeBytes()
+{
+	return (this->pimpl->finalizeBytes());
+}
+
+void
+BiometricEvaluation::Text::Digester::reset()
+{
+	this->pimpl->reset();
+}
+
+std::string
+BiometricEvaluation::Text::Digester::getName()
+    const
+{
+	return (this->pimpl->getName());
+}
+
+uint32_t
+BiometricEvaluation::Text::Digester::getSize()
+    const
+{
+	return (this->pimpl->getSize());
+}
+
+BiometricEvaluation::Text::Digester::~Digester() = default;
+BiometricEvaluation::Text::Digester::Digester(Digester&&) = default;
+BiometricEvaluation::Text::Digester&
+BiometricEvaluation::Text::Digester::operator=(Digester&&) = default;
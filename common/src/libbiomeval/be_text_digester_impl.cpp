@@ -0,0 +1,372 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <strings.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include <be_error_exception.h>
+
+#include "be_text_digester_impl.h"
+
+namespace BE = BiometricEvaluation;
+
+/** Size of blocks read from streams */
+static const std::streamsize StreamBlockSize = 64 * 1024;
+
+#ifdef Darwin
+/** CommonCrypto functions for one digest */
+struct CCDigest
+{
+	const char *name;
+	uint32_t size;
+	int (*init)(void *context);
+	int (*update)(void *context, const void *data, CC_LONG length);
+	int (*final)(unsigned char *md, void *context);
+};
+
+#define CC_DIGEST(name, ALG, CONTEXT) \
+	{name, CC_##ALG##_DIGEST_LENGTH, \
+	[](void *c) -> int { \
+		return (CC_##ALG##_Init(static_cast<CONTEXT*>(c))); }, \
+	[](void *c, const void *d, CC_LONG l) -> int { \
+		return (CC_##ALG##_Update(static_cast<CONTEXT*>(c), d, l)); }, \
+	[](unsigned char *md, void *c) -> int { \
+		return (CC_##ALG##_Final(md, static_cast<CONTEXT*>(c))); }}
+
+static const CCDigest CCDigests[] = {
+	CC_DIGEST("md2", MD2, CC_MD2_CTX),
+	CC_DIGEST("md4", MD4, CC_MD4_CTX),
+	CC_DIGEST("md5", MD5, CC_MD5_CTX),
+	CC_DIGEST("sha1", SHA1, CC_SHA1_CTX),
+	CC_DIGEST("sha224", SHA224, CC_SHA256_CTX),
+	CC_DIGEST("sha256", SHA256, CC_SHA256_CTX),
+	CC_DIGEST("sha384", SHA384, CC_SHA512_CTX),
+	CC_DIGEST("sha512", SHA512, CC_SHA512_CTX)
+};
+#undef CC_DIGEST
+#else
+/** Guards one-time registration of OpenSSL digests */
+static std::once_flag DigestsLoaded;
+#endif
+
+BiometricEvaluation::Text::Digester::Impl::Impl(
+    const std::string &digest) :
+    _name{digest},
+    _isXXH64{strcasecmp(digest.c_str(), XXH64.c_str()) == 0}
+{
+	if (this->_isXXH64) {
+		this->xxh64Reset();
+		return;
+	}
+
+#ifdef Darwin
+	const CCDigest *found = nullptr;
+	for (const auto &ccDigest : CCDigests) {
+		if (strcasecmp(digest.c_str(), ccDigest.name) == 0) {
+			found = &ccDigest;
+			break;
+		}
+	}
+	if (found == nullptr)
+		throw BE::Error::NotImplemented(digest);
+	this->_init = found->init;
+	this->_update = found->update;
+	this->_final = found->final;
+	this->_size = found->size;
+#else
+	std::call_once(DigestsLoaded, []() { OpenSSL_add_all_digests(); });
+
+	this->_md = EVP_get_digestbyname(digest.c_str());
+	if (this->_md == nullptr)
+		throw BE::Error::NotImplemented("Unknown message digest: " +
+		    digest);
+	this->_context = EVP_MD_CTX_create();
+	if (this->_context == nullptr)
+		throw BE::Error::StrategyError("Could not allocate digest "
+		    "context");
+#endif
+
+	try {
+		this->reset();
+	} catch (BE::Error::Exception &) {
+#ifndef Darwin
+		EVP_MD_CTX_destroy(this->_context);
+#endif
+		throw;
+	}
+}
+
+void
+BiometricEvaluation::Text::Digester::Impl::reset()
+{
+	if (this->_isXXH64) {
+		this->xxh64Reset();
+		return;
+	}
+
+#ifdef Darwin
+	if (this->_init(&this->_context) != 1)
+		throw BE::Error::StrategyError("Could not initialize digest");
+#else
+	if (EVP_DigestInit_ex(this->_context, this->_md, nullptr) != 1)
+		throw BE::Error::StrategyError("Could not initialize digest");
+#endif
+}
+
+void
+BiometricEvaluation::Text::Digester::Impl::update(
+    const void *buffer,
+    const size_t size)
+{
+	if (this->_isXXH64) {
+		this->xxh64Update(static_cast<const uint8_t*>(buffer), size);
+		return;
+	}
+
+#ifdef Darwin
+	/* CC_LONG is 32 bits */
+	const uint8_t *data = static_cast<const uint8_t*>(buffer);
+	size_t remaining = size;
+	do {
+		const CC_LONG length = static_cast<CC_LONG>(std::min<size_t>(
+		    remaining, UINT32_MAX));
+		if (this->_update(&this->_context, data, length) != 1)
+			throw BE::Error::StrategyError("Could not update "
+			    "digest");
+		data += length;
+		remaining -= length;
+	} while (remaining > 0);
+#else
+	if (EVP_DigestUpdate(this->_context, buffer, size) != 1)
+		throw BE::Error::StrategyError("Could not update digest");
+#endif
+}
+
+void
+BiometricEvaluation::Text::Digester::Impl::update(
+    std::istream &stream)
+{
+	BE::Memory::uint8Array block(StreamBlockSize);
+	while (stream) {
+		stream.read(reinterpret_cast<char*>(&block[0]),
+		    StreamBlockSize);
+		if (stream.gcount() > 0)
+			this->update(block, stream.gcount());
+	}
+	if (!stream.eof())
+		throw BE::Error::StrategyError("Could not read stream");
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Text::Digester::Impl::finalizeBytes()
+{
+	BE::Memory::uint8Array md(this->getSize());
+	if (this->_isXXH64) {
+		const uint64_t hash = this->xxh64Final();
+		for (uint32_t i = 0; i < 8; i++)
+			md[i] = static_cast<uint8_t>(hash >> (56 - (i * 8)));
+		this->xxh64Reset();
+		return (md);
+	}
+
+#ifdef Darwin
+	if (this->_final(md, &this->_context) != 1)
+		throw BE::Error::StrategyError("Could not obtain digest");
+#else
+	unsigned int mdSize;
+	if (EVP_DigestFinal_ex(this->_context, md, &mdSize) != 1)
+		throw BE::Error::StrategyError("Could not obtain digest");
+#endif
+	this->reset();
+
+	return (md);
+}
+
+std::string
+BiometricEvaluation::Text::Digester::Impl::getName()
+    const
+{
+	return (this->_name);
+}
+
+uint32_t
+BiometricEvaluation::Text::Digester::Impl::getSize()
+    const
+{
+	if (this->_isXXH64)
+		return (sizeof(uint64_t));
+#ifdef Darwin
+	return (this->_size);
+#else
+	return (EVP_MD_size(this->_md));
+#endif
+}
+
+BiometricEvaluation::Text::Digester::Impl::~Impl()
+{
+#ifndef Darwin
+	if (!this->_isXXH64)
+		EVP_MD_CTX_destroy(this->_context);
+#endif
+}
+
+/*
+ * XXH64, as specified by the xxHash project.
+ */
+
+static const uint64_t XXH64Prime1 = UINT64_C(0x9E3779B185EBCA87);
+static const uint64_t XXH64Prime2 = UINT64_C(0xC2B2AE3D27D4EB4F);
+static const uint64_t XXH64Prime3 = UINT64_C(0x165667B19E3779F9);
+static const uint64_t XXH64Prime4 = UINT64_C(0x85EBCA77C2B2AE63);
+static const uint64_t XXH64Prime5 = UINT64_C(0x27D4EB2F165667C5);
+
+static inline uint64_t
+rotateLeft(
+    uint64_t value,
+    uint32_t bits)
+{
+	return ((value << bits) | (value >> (64 - bits)));
+}
+
+static inline uint64_t
+readLE64(
+    const uint8_t *p)
+{
+	uint64_t value = 0;
+	for (int i = 7; i >= 0; i--)
+		value = (value << 8) | p[i];
+	return (value);
+}
+
+static inline uint32_t
+readLE32(
+    const uint8_t *p)
+{
+	return (static_cast<uint32_t>(p[0]) |
+	    (static_cast<uint32_t>(p[1]) << 8) |
+	    (static_cast<uint32_t>(p[2]) << 16) |
+	    (static_cast<uint32_t>(p[3]) << 24));
+}
+
+static inline uint64_t
+xxh64Round(
+    uint64_t accumulator,
+    uint64_t input)
+{
+	accumulator += input * XXH64Prime2;
+	return (rotateLeft(accumulator, 31) * XXH64Prime1);
+}
+
+static inline uint64_t
+xxh64MergeRound(
+    uint64_t accumulator,
+    uint64_t value)
+{
+	accumulator ^= xxh64Round(0, value);
+	return ((accumulator * XXH64Prime1) + XXH64Prime4);
+}
+
+void
+BiometricEvaluation::Text::Digester::Impl::xxh64Reset()
+{
+	/* Seed is always 0 */
+	this->_xxh64.v[0] = XXH64Prime1 + XXH64Prime2;
+	this->_xxh64.v[1] = XXH64Prime2;
+	this->_xxh64.v[2] = 0;
+	this->_xxh64.v[3] = -XXH64Prime1;
+	this->_xxh64.length = 0;
+	this->_xxh64.pendingSize = 0;
+}
+
+void
+BiometricEvaluation::Text::Digester::Impl::xxh64Update(
+    const uint8_t *buffer,
+    size_t size)
+{
+	XXH64State &state = this->_xxh64;
+	state.length += size;
+
+	/* Complete a stripe started by a previous update */
+	if (state.pendingSize > 0) {
+		const size_t needed = std::min<size_t>(size,
+		    sizeof(state.pending) - state.pendingSize);
+		std::memcpy(state.pending + state.pendingSize, buffer, needed);
+		state.pendingSize += needed;
+		buffer += needed;
+		size -= needed;
+		if (state.pendingSize < sizeof(state.pending))
+			return;
+		for (int lane = 0; lane < 4; lane++)
+			state.v[lane] = xxh64Round(state.v[lane],
+			    readLE64(state.pending + (lane * 8)));
+		state.pendingSize = 0;
+	}
+
+	uint64_t v0 = state.v[0], v1 = state.v[1];
+	uint64_t v2 = state.v[2], v3 = state.v[3];
+	while (size >= 32) {
+		v0 = xxh64Round(v0, readLE64(buffer));
+		v1 = xxh64Round(v1, readLE64(buffer + 8));
+		v2 = xxh64Round(v2, readLE64(buffer + 16));
+		v3 = xxh64Round(v3, readLE64(buffer + 24));
+		buffer += 32;
+		size -= 32;
+	}
+	state.v[0] = v0; state.v[1] = v1; state.v[2] = v2; state.v[3] = v3;
+
+	if (size > 0) {
+		std::memcpy(state.pending, buffer, size);
+		state.pendingSize = size;
+	}
+}
+
+uint64_t
+BiometricEvaluation::Text::Digester::Impl::xxh64Final()
+    const
+{
+	const XXH64State &state = this->_xxh64;
+
+	uint64_t hash;
+	if (state.length >= 32) {
+		hash = rotateLeft(state.v[0], 1) + rotateLeft(state.v[1], 7) +
+		    rotateLeft(state.v[2], 12) + rotateLeft(state.v[3], 18);
+		for (int lane = 0; lane < 4; lane++)
+			hash = xxh64MergeRound(hash, state.v[lane]);
+	} else {
+		hash = XXH64Prime5;
+	}
+	hash += state.length;
+
+	const uint8_t *p = state.pending;
+	const uint8_t *end = state.pending + state.pendingSize;
+	for (; (p + 8) <= end; p += 8) {
+		hash ^= xxh64Round(0, readLE64(p));
+		hash = (rotateLeft(hash, 27) * XXH64Prime1) + XXH64Prime4;
+	}
+	if ((p + 4) <= end) {
+		hash ^= static_cast<uint64_t>(readLE32(p)) * XXH64Prime1;
+		hash = (rotateLeft(hash, 23) * XXH64Prime2) + XXH64Prime3;
+		p += 4;
+	}
+	for (; p < end; p++) {
+		hash ^= (*p) * XXH64Prime5;
+		hash = rotateLeft(hash, 11) * XXH64Prime1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= XXH64Prime2;
+	hash ^= hash >> 29;
+	hash *= XXH64Prime3;
+	hash ^= hash >> 32;
+	return (hash);
+}
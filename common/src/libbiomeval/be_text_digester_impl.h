@@ -0,0 +1,121 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef BE_TEXT_DIGESTER_IMPL_H_
+#define BE_TEXT_DIGESTER_IMPL_H_
+
+#ifdef Darwin
+#include <CommonCrypto/CommonDigest.h>
+#else
+#include <openssl/evp.h>
+#endif
+
+#include <be_text_digester.h>
+
+namespace BiometricEvaluation
+{
+	namespace Text
+	{
+		/** Implementation of Digester. */
+		class Digester::Impl
+		{
+		public:
+			Impl(
+			    const std::string &digest);
+
+			void
+			update(
+			    const void *buffer,
+			    const size_t size);
+
+			void
+			update(
+			    std::istream &stream);
+
+			Memory::uint8Array
+			finalizeBytes();
+
+			void
+			reset();
+
+			std::string
+			getName()
+			    const;
+
+			uint32_t
+			getSize()
+			    const;
+
+			~Impl();
+
+		private:
+			/** Streaming state of XXH64 */
+			struct XXH64State
+			{
+				/** Accumulators for each 8-byte lane */
+				uint64_t v[4];
+				/** Bytes added */
+				uint64_t length;
+				/** Bytes not yet in a full 32-byte stripe */
+				uint8_t pending[32];
+				/** Number of bytes in pending */
+				uint32_t pendingSize;
+			};
+
+			void
+			xxh64Reset();
+
+			void
+			xxh64Update(
+			    const uint8_t *buffer,
+			    size_t size);
+
+			uint64_t
+			xxh64Final()
+			    const;
+
+			/** Name of the digest */
+			std::string _name;
+			/** Whether this is XXH64 rather than a platform digest */
+			bool _isXXH64;
+			/** XXH64 state, when _isXXH64 */
+			XXH64State _xxh64;
+
+#ifdef Darwin
+			/** Largest CommonCrypto context */
+			union Context
+			{
+				CC_MD2_CTX md2;
+				CC_MD4_CTX md4;
+				CC_MD5_CTX md5;
+				CC_SHA1_CTX sha1;
+				CC_SHA256_CTX sha256;
+				CC_SHA512_CTX sha512;
+			};
+			/** CommonCrypto context */
+			Context _context;
+			/** CommonCrypto functions for the digest */
+			int (*_init)(void *context);
+			int (*_update)(void *context, const void *data,
+			    CC_LONG length);
+			int (*_final)(unsigned char *md, void *context);
+			/** Size of the digest */
+			uint32_t _size;
+#else
+			/** Digest type, looked up once */
+			const EVP_MD *_md;
+			/** Reusable digest context */
+			EVP_MD_CTX *_context;
+#endif
+		};
+	}
+}
+
+#endif /* BE_TEXT_DIGESTER_IMPL_H_ */
@@ -0,0 +1,328 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#include <be_error_exception.h>
+#include <be_time_histogram.h>
+
+namespace BE = BiometricEvaluation;
+
+/** Identifies a serialized Histogram */
+static const uint8_t SerializedMagic[] = {'B', 'E', 'H', 'G'};
+/** Version of the serialization format */
+static const uint8_t SerializedVersion = 1;
+
+BiometricEvaluation::Time::Histogram::Histogram() :
+    _counts{new std::atomic<uint64_t>[BucketCount]}
+{
+	for (uint64_t i = 0; i < BucketCount; i++)
+		this->_counts[i].store(0, std::memory_order_relaxed);
+}
+
+BiometricEvaluation::Time::Histogram::Histogram(
+    const Histogram &other) :
+    Histogram()
+{
+	this->merge(other);
+}
+
+BiometricEvaluation::Time::Histogram&
+BiometricEvaluation::Time::Histogram::operator=(
+    const Histogram &other)
+{
+	if (this != &other) {
+		this->reset();
+		this->merge(other);
+	}
+	return (*this);
+}
+
+uint64_t
+BiometricEvaluation::Time::Histogram::getBucketIndex(
+    uint64_t value)
+    noexcept
+{
+	if (value < SubBucketCount)
+		return (value);
+
+	/* Keep the SubBucketBits bits below the most significant bit */
+	const uint64_t magnitude = 63 - __builtin_clzll(value);
+	const uint64_t shift = magnitude - SubBucketBits;
+	return (((shift + 1) * SubBucketCount) +
+	    ((value >> shift) - SubBucketCount));
+}
+
+uint64_t
+BiometricEvaluation::Time::Histogram::getBucketUpperBound(
+    uint64_t index)
+    noexcept
+{
+	if (index < SubBucketCount)
+		return (index);
+
+	const uint64_t shift = (index / SubBucketCount) - 1;
+	const uint64_t mantissa = SubBucketCount + (index % SubBucketCount);
+	/* Wraps to UINT64_MAX for the final bucket */
+	return (((mantissa + 1) << shift) - 1);
+}
+
+void
+BiometricEvaluation::Time::Histogram::record(
+    uint64_t value)
+    noexcept
+{
+	this->_counts[getBucketIndex(value)].fetch_add(1,
+	    std::memory_order_relaxed);
+	this->_count.fetch_add(1, std::memory_order_relaxed);
+	this->_sum.fetch_add(value, std::memory_order_relaxed);
+
+	uint64_t current = this->_min.load(std::memory_order_relaxed);
+	while ((value < current) && !this->_min.compare_exchange_weak(
+	    current, value, std::memory_order_relaxed));
+	current = this->_max.load(std::memory_order_relaxed);
+	while ((value > current) && !this->_max.compare_exchange_weak(
+	    current, value, std::memory_order_relaxed));
+}
+
+void
+BiometricEvaluation::Time::Histogram::merge(
+    const Histogram &other)
+    noexcept
+{
+	for (uint64_t i = 0; i < BucketCount; i++) {
+		const uint64_t count = other._counts[i].load(
+		    std::memory_order_relaxed);
+		if (count != 0)
+			this->_counts[i].fetch_add(count,
+			    std::memory_order_relaxed);
+	}
+	this->_count.fetch_add(other._count.load(std::memory_order_relaxed),
+	    std::memory_order_relaxed);
+	this->_sum.fetch_add(other._sum.load(std::memory_order_relaxed),
+	    std::memory_order_relaxed);
+
+	const uint64_t otherMin = other._min.load(std::memory_order_relaxed);
+	uint64_t current = this->_min.load(std::memory_order_relaxed);
+	while ((otherMin < current) && !this->_min.compare_exchange_weak(
+	    current, otherMin, std::memory_order_relaxed));
+	const uint64_t otherMax = other._max.load(std::memory_order_relaxed);
+	current = this->_max.load(std::memory_order_relaxed);
+	while ((otherMax > current) && !this->_max.compare_exchange_weak(
+	    current, otherMax, std::memory_order_relaxed));
+}
+
+void
+BiometricEvaluation::Time::Histogram::reset()
+    noexcept
+{
+	for (uint64_t i = 0; i < BucketCount; i++)
+		this->_counts[i].store(0, std::memory_order_relaxed);
+	this->_count.store(0, std::memory_order_relaxed);
+	this->_sum.store(0, std::memory_order_relaxed);
+	this->_min.store(UINT64_MAX, std::memory_order_relaxed);
+	this->_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t
+BiometricEvaluation::Time::Histogram::getCount()
+    const
+    noexcept
+{
+	return (this->_count.load(std::memory_order_relaxed));
+}
+
+uint64_t
+BiometricEvaluation::Time::Histogram::getMin()
+    const
+    noexcept
+{
+	if (this->getCount() == 0)
+		return (0);
+	return (this->_min.load(std::memory_order_relaxed));
+}
+
+uint64_t
+BiometricEvaluation::Time::Histogram::getMax()
+    const
+    noexcept
+{
+	return (this->_max.load(std::memory_order_relaxed));
+}
+
+double
+BiometricEvaluation::Time::Histogram::getMean()
+    const
+    noexcept
+{
+	const uint64_t count = this->getCount();
+	if (count == 0)
+		return (0);
+	return (static_cast<double>(this->_sum.load(
+	    std::memory_order_relaxed)) / count);
+}
+
+uint64_t
+BiometricEvaluation::Time::Histogram::getPercentile(
+    double percentile)
+    const
+{
+	if ((percentile < 0) || (percentile > 100))
+		throw BE::Error::ParameterError("Percentile out of range");
+
+	const uint64_t count = this->getCount();
+	if (count == 0)
+		return (0);
+	if (percentile == 0)
+		return (this->getMin());
+
+	const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(
+	    std::ceil((percentile / 100.0) * count)));
+	uint64_t cumulative = 0;
+	for (uint64_t i = 0; i < BucketCount; i++) {
+		cumulative += this->_counts[i].load(std::memory_order_relaxed);
+		if (cumulative >= target)
+			return (std::min(getBucketUpperBound(i),
+			    this->getMax()));
+	}
+	return (this->getMax());
+}
+
+/*
+ * Serialization.
+ */
+
+/* Little-endian so Histograms can move between hosts */
+static void
+appendUInt64(
+    BE::Memory::uint8Array &buffer,
+    uint64_t &offset,
+    uint64_t value)
+{
+	for (int i = 0; i < 8; i++)
+		buffer[offset++] = static_cast<uint8_t>(value >> (i * 8));
+}
+
+static uint64_t
+extractUInt64(
+    const BE::Memory::uint8Array &buffer,
+    uint64_t &offset)
+{
+	if ((offset + 8) > buffer.size())
+		throw BE::Error::ParameterError("Truncated Histogram");
+
+	uint64_t value = 0;
+	for (int i = 0; i < 8; i++)
+		value |= static_cast<uint64_t>(buffer[offset++]) << (i * 8);
+	return (value);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Time::Histogram::serialize()
+    const
+{
+	/* Only occupied buckets are stored, as (index, count) pairs */
+	uint64_t occupied = 0;
+	for (uint64_t i = 0; i < BucketCount; i++)
+		if (this->_counts[i].load(std::memory_order_relaxed) != 0)
+			occupied++;
+
+	BE::Memory::uint8Array buffer(sizeof(SerializedMagic) + 2 +
+	    (5 * 8) + (occupied * 16));
+	uint64_t offset = 0;
+	for (const auto magic : SerializedMagic)
+		buffer[offset++] = magic;
+	buffer[offset++] = SerializedVersion;
+	buffer[offset++] = SubBucketBits;
+	appendUInt64(buffer, offset, this->_count.load());
+	appendUInt64(buffer, offset, this->_sum.load());
+	appendUInt64(buffer, offset, this->_min.load());
+	appendUInt64(buffer, offset, this->_max.load());
+	appendUInt64(buffer, offset, occupied);
+
+	/* Buckets may have filled since they were counted */
+	for (uint64_t i = 0; (i < BucketCount) && (occupied > 0); i++) {
+		const uint64_t count = this->_counts[i].load(
+		    std::memory_order_relaxed);
+		if (count == 0)
+			continue;
+		appendUInt64(buffer, offset, i);
+		appendUInt64(buffer, offset, count);
+		occupied--;
+	}
+
+	return (buffer);
+}
+
+BiometricEvaluation::Time::Histogram::Histogram(
+    const Memory::uint8Array &serialized) :
+    Histogram()
+{
+	uint64_t offset = 0;
+	if (serialized.size() < (sizeof(SerializedMagic) + 2))
+		throw BE::Error::ParameterError("Truncated Histogram");
+	for (const auto magic : SerializedMagic)
+		if (serialized[offset++] != magic)
+			throw BE::Error::ParameterError("Not a Histogram");
+	if (serialized[offset++] != SerializedVersion)
+		throw BE::Error::ParameterError("Unsupported Histogram "
+		    "version");
+	if (serialized[offset++] != SubBucketBits)
+		throw BE::Error::ParameterError("Incompatible Histogram "
+		    "resolution");
+
+	this->_count.store(extractUInt64(serialized, offset));
+	this->_sum.store(extractUInt64(serialized, offset));
+	this->_min.store(extractUInt64(serialized, offset));
+	this->_max.store(extractUInt64(serialized, offset));
+	const uint64_t occupied = extractUInt64(serialized, offset);
+	for (uint64_t i = 0; i < occupied; i++) {
+		const uint64_t index = extractUInt64(serialized, offset);
+		const uint64_t count = extractUInt64(serialized, offset);
+		if (index >= BucketCount)
+			throw BE::Error::ParameterError("Invalid Histogram "
+			    "bucket");
+		this->_counts[index].store(count);
+	}
+}
+
+/*
+ * Reporting.
+ */
+
+std::string
+BiometricEvaluation::Time::Histogram::toString()
+    const
+{
+	std::ostringstream summary;
+	summary << "count=" << this->getCount() <<
+	    " min=" << this->getMin() <<
+	    " mean=" << std::fixed << std::setprecision(1) << this->getMean() <<
+	    " p50=" << this->getPercentile(50) <<
+	    " p90=" << this->getPercentile(90) <<
+	    " p95=" << this->getPercentile(95) <<
+	    " p99=" << this->getPercentile(99) <<
+	    " p99.9=" << this->getPercentile(99.9) <<
+	    " max=" << this->getMax();
+	return (summary.str());
+}
+
+void
+BiometricEvaluation::Time::Histogram::writeToLogsheet(
+    IO::Logsheet &logsheet,
+    const std::string &label)
+    const
+{
+	logsheet << label << ": " << this->toString();
+	logsheet.newEntry();
+}
@@ -9,6 +9,7 @@
  */
 
 #include <be_error_exception.h>
+#include <be_time_histogram.h>
 #include <be_time_timer.h>
 
 BiometricEvaluation::Time::Timer::Timer() :
@@ -49,6 +50,14 @@ BiometricEvaluation::Time::Timer::stop()
 	this->_inProgress = false;
 }
 
+void
+BiometricEvaluation::Time::Timer::stop(
+    Histogram &histogram)
+{
+	this->stop();
+	histogram.record(this->elapsed(true));
+}
+
 uint64_t
 BiometricEvaluation::Time::Timer::elapsed(
     bool nano)
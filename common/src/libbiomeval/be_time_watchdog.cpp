@@ -9,24 +9,212 @@
 ******************************************************************************/
 #include <sys/time.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <csetjmp>
 #include <csignal>
+#include <ctime>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
+#if defined Linux
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <be_error.h>
 #include <be_time_watchdog.h>
 
+/* Older glibc does not name the thread ID member of struct sigevent */
+#if defined Linux && !defined sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
 /* Cygwin 2 does not define timerclear */
 #ifndef timerclear
 #define timerclear(tvp)         (tvp)->tv_sec = (tvp)->tv_usec = 0
 #endif
 
-bool BiometricEvaluation::Time::Watchdog::_canSigJump = false;
-sigjmp_buf BiometricEvaluation::Time::Watchdog::_sigJumpBuf;
+thread_local bool BiometricEvaluation::Time::Watchdog::_canSigJump = false;
+thread_local sigjmp_buf BiometricEvaluation::Time::Watchdog::_sigJumpBuf;
+
+/* Watchdog signals delivered to this thread, jumping or not */
+static thread_local volatile uint64_t watchdogSignalsReceived = 0;
+
+/*
+ * A POSIX timer that signals a single thread.
+ */
+class BiometricEvaluation::Time::Watchdog::ThreadTimer
+{
+public:
+#if defined Linux
+	ThreadTimer(
+	    clockid_t clock,
+	    int signo) :
+	    tid{static_cast<pid_t>(syscall(SYS_gettid))}
+	{
+		struct sigevent sev{};
+		sev.sigev_notify = SIGEV_THREAD_ID;
+		sev.sigev_signo = signo;
+		sev.sigev_notify_thread_id = this->tid;
+		if (timer_create(clock, &sev, &this->id) != 0)
+			throw (Error::StrategyError("Creating system timer "
+			    "failed (" + Error::errorStr() + ")"));
+	}
+
+	~ThreadTimer()
+	{
+		timer_delete(this->id);
+	}
+
+	/** Whether this timer signals the calling thread */
+	bool
+	isCurrentThread()
+	    const
+	{
+		return (this->tid == static_cast<pid_t>(syscall(SYS_gettid)));
+	}
+
+	/** Thread signaled by the timer */
+	const pid_t tid;
+	/** System timer */
+	timer_t id;
+#endif
+};
+
+/*
+ * A thread that signals another thread once a published deadline passes.
+ */
+class BiometricEvaluation::Time::Watchdog::Monitor
+{
+public:
+#if defined Linux
+	/** Deadline value when no deadline is published */
+	static const int64_t Disarmed = 0;
+	/** Deadline value once the target thread has been signaled */
+	static const int64_t Expired = -1;
+
+	Monitor(
+	    uint64_t interval,
+	    int signo) :
+	    target{pthread_self()},
+	    tid{static_cast<pid_t>(syscall(SYS_gettid))},
+	    _signo{signo},
+	    _idlePoll{std::chrono::microseconds(
+	        std::max<uint64_t>(interval / 4, 1))}
+	{
+		this->_thread = std::thread(&Monitor::run, this);
+	}
+
+	~Monitor()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->_mutex);
+			this->_quit = true;
+		}
+		this->_cv.notify_one();
+		this->_thread.join();
+	}
+
+	/** Nanoseconds on the monotonic clock */
+	static int64_t
+	now()
+	{
+		return (std::chrono::duration_cast<std::chrono::nanoseconds>(
+		    std::chrono::steady_clock::now().time_since_epoch()).
+		    count());
+	}
+
+	/** Whether this monitor signals the calling thread */
+	bool
+	isCurrentThread()
+	    const
+	{
+		return (this->tid == static_cast<pid_t>(syscall(SYS_gettid)));
+	}
+
+	/** Thread signaled on expiration */
+	const pthread_t target;
+	/** Kernel ID of target */
+	const pid_t tid;
+	/** Published deadline, or Disarmed or Expired */
+	std::atomic<int64_t> deadline{Disarmed};
+	/** Signals target had received when the deadline was published */
+	uint64_t receivedAtStart{0};
+
+private:
+	void
+	run()
+	{
+		std::unique_lock<std::mutex> lock(this->_mutex);
+		while (!this->_quit) {
+			int64_t current = this->deadline.load();
+			if (current <= Disarmed) {
+				this->_cv.wait_for(lock, this->_idlePoll);
+				continue;
+			}
+
+			const int64_t remaining = current - Monitor::now();
+			if (remaining > 0) {
+				this->_cv.wait_for(lock,
+				    std::chrono::nanoseconds(remaining));
+				continue;
+			}
+
+			/* The target may have withdrawn the deadline */
+			if (this->deadline.compare_exchange_strong(current,
+			    Expired))
+				pthread_kill(this->target, this->_signo);
+		}
+	}
+
+	const int _signo;
+	const std::chrono::microseconds _idlePoll;
+	std::thread _thread{};
+	std::mutex _mutex{};
+	std::condition_variable _cv{};
+	bool _quit{false};
+#endif
+};
+
+#if defined Linux
+/*
+ * The signal used by the thread timers. Its handler is installed once
+ * and never removed, since another thread's timer may be pending at any
+ * time; the handler ignores signals outside a watchdog block.
+ */
+static int
+threadTimerSignal()
+{
+	return (SIGRTMIN);
+}
+
+static void
+installThreadTimerHandler()
+{
+	static std::once_flag handlerInstalled;
+	std::call_once(handlerInstalled, []() {
+		struct sigaction sa{};
+		sigemptyset(&sa.sa_mask);
+		sa.sa_flags = SA_SIGINFO;
+		sa.sa_sigaction =
+		    BiometricEvaluation::Time::WatchdogSignalHandler;
+		if (sigaction(threadTimerSignal(), &sa, nullptr) != 0)
+			throw (BiometricEvaluation::Error::StrategyError(
+			    "Registering signal handler failed"));
+	});
+}
+#endif
 
 void
 BiometricEvaluation::Time::WatchdogSignalHandler(
     int /* signo */, siginfo_t * /* info */, void * /* uap */)
 {
+	watchdogSignalsReceived = watchdogSignalsReceived + 1;
 	if (Time::Watchdog::_canSigJump) {
 		siglongjmp(
 		    BiometricEvaluation::Time::Watchdog::_sigJumpBuf, 1);
@@ -36,7 +224,9 @@ BiometricEvaluation::Time::WatchdogSignalHandler(
 BiometricEvaluation::Time::Watchdog::Watchdog(
     const uint8_t type)
 {
-	if ((type != Watchdog::PROCESSTIME) && (type != Watchdog::REALTIME)) {
+	if ((type != Watchdog::PROCESSTIME) && (type != Watchdog::REALTIME) &&
+	    (type != Watchdog::THREADREALTIME) &&
+	    (type != Watchdog::THREADTIME) && (type != Watchdog::MONITORED)) {
 		throw (Error::ParameterError());
 	}
 #ifdef __CYGWIN__
@@ -44,6 +234,12 @@ BiometricEvaluation::Time::Watchdog::Watchdog(
 		throw (Error::NotImplemented());
 	}
 #endif
+#if !defined Linux
+	if ((type == Watchdog::THREADREALTIME) ||
+	    (type == Watchdog::THREADTIME) || (type == Watchdog::MONITORED)) {
+		throw (Error::NotImplemented());
+	}
+#endif
 
 	_type = type;
 	_canSigJump = false;
@@ -55,6 +251,9 @@ void
 BiometricEvaluation::Time::Watchdog::setInterval(uint64_t interval)
 {
 	_interval = interval;
+
+	/* The monitor's polling period depends on the interval */
+	_monitor.reset();
 }
 
 void
@@ -76,6 +275,15 @@ BiometricEvaluation::Time::Watchdog::start()
 	if (_interval == 0) {
 		return;
 	}
+	if ((_type == Watchdog::THREADREALTIME) ||
+	    (_type == Watchdog::THREADTIME)) {
+		startThreadTimer();
+		return;
+	}
+	if (_type == Watchdog::MONITORED) {
+		startMonitor();
+		return;
+	}
 
 	struct sigaction sa{};
 	int signo;
@@ -105,6 +313,16 @@ BiometricEvaluation::Time::Watchdog::start()
 void
 BiometricEvaluation::Time::Watchdog::stop()
 {
+	if ((_type == Watchdog::THREADREALTIME) ||
+	    (_type == Watchdog::THREADTIME)) {
+		stopThreadTimer();
+		return;
+	}
+	if (_type == Watchdog::MONITORED) {
+		stopMonitor();
+		return;
+	}
+
 	struct sigaction sa{};
 	int signo;
 	int which;
@@ -127,6 +345,89 @@ BiometricEvaluation::Time::Watchdog::stop()
 	}
 }
 
+void
+BiometricEvaluation::Time::Watchdog::startThreadTimer()
+{
+#if defined Linux
+	installThreadTimerHandler();
+
+	/* Timers are bound to a thread, so follow the object if it moves */
+	if (!_threadTimer || !_threadTimer->isCurrentThread()) {
+		_threadTimer.reset(new ThreadTimer(
+		    (_type == Watchdog::THREADTIME) ?
+		    CLOCK_THREAD_CPUTIME_ID : CLOCK_MONOTONIC,
+		    threadTimerSignal()));
+	}
+
+	struct itimerspec timerspec{};
+	timerspec.it_value.tv_sec = static_cast<time_t>(
+	    _interval / Time::MicrosecondsPerSecond);
+	timerspec.it_value.tv_nsec = static_cast<long>(
+	    (_interval % Time::MicrosecondsPerSecond) *
+	    Time::NanosecondsPerMicrosecond);
+	if (timer_settime(_threadTimer->id, 0, &timerspec, nullptr) != 0) {
+		throw (Error::StrategyError("Registering system timer failed"));
+	}
+#else
+	throw (Error::NotImplemented());
+#endif
+}
+
+void
+BiometricEvaluation::Time::Watchdog::stopThreadTimer()
+{
+#if defined Linux
+	if (!_threadTimer) {
+		return;
+	}
+	struct itimerspec timerspec{};
+	if (timer_settime(_threadTimer->id, 0, &timerspec, nullptr) != 0) {
+		throw (Error::StrategyError("Clearing system timer failed"));
+	}
+#else
+	throw (Error::NotImplemented());
+#endif
+}
+
+void
+BiometricEvaluation::Time::Watchdog::startMonitor()
+{
+#if defined Linux
+	if (!_monitor || !_monitor->isCurrentThread()) {
+		installThreadTimerHandler();
+		_monitor.reset(new Monitor(_interval, threadTimerSignal()));
+	}
+	_monitor->receivedAtStart = watchdogSignalsReceived;
+	_monitor->deadline.store(Monitor::now() + static_cast<int64_t>(
+	    _interval * Time::NanosecondsPerMicrosecond));
+#else
+	throw (Error::NotImplemented());
+#endif
+}
+
+void
+BiometricEvaluation::Time::Watchdog::stopMonitor()
+{
+#if defined Linux
+	if (!_monitor) {
+		return;
+	}
+
+	/*
+	 * If the monitor already signaled this thread, wait for the signal
+	 * to arrive (and be ignored, since the block is no longer jumpable)
+	 * so it cannot interrupt the next block instead.
+	 */
+	if (_monitor->deadline.exchange(Monitor::Disarmed) ==
+	    Monitor::Expired) {
+		while (watchdogSignalsReceived == _monitor->receivedAtStart)
+			std::this_thread::yield();
+	}
+#else
+	throw (Error::NotImplemented());
+#endif
+}
+
 void
 BiometricEvaluation::Time::Watchdog::setCanSigJump()
 {
@@ -151,6 +452,13 @@ BiometricEvaluation::Time::Watchdog::clearExpired()
 	_expired = false;
 }
 
+uint64_t
+BiometricEvaluation::Time::Watchdog::getInterval()
+    const
+{
+	return (_interval);
+}
+
 bool
 BiometricEvaluation::Time::Watchdog::expired()
 {
@@ -11,7 +11,6 @@
 #include "be_video_container_impl.h"
 #include "be_video_stream_impl.h"
 #include <be_error_exception.h>
-#include <be_io_utility.h>
 #include <be_time.h>
 
 namespace BE = BiometricEvaluation;
@@ -26,8 +25,8 @@ BiometricEvaluation::Video::Container::Impl::openContainer()
 	if (this->_fmtCtx == nullptr)
 		throw BE::Error::MemoryError("Could not allocate format context");
 	/* fill opaque structure used by the AVIOContext read callback */
-	this->_IOCtxBufferData.ptr = *this->_containerBuf.get();
-	this->_IOCtxBufferData.size = this->_containerBuf->size();
+	this->_IOCtxBufferData.ptr = this->_containerData->data();
+	this->_IOCtxBufferData.size = this->_containerData->size();
 	this->_IOCtxBufferData.pos = 0;
 
 	uint8_t *ctxBuf = nullptr;
@@ -129,23 +128,22 @@ findVideoStream(
 BiometricEvaluation::Video::Container::Impl::Impl(
     const Memory::uint8Array &buffer)
 {
-	this->_containerBuf.reset(new BE::Memory::uint8Array(buffer));
+	this->_containerData.reset(new BE::Video::ContainerData(
+	    std::make_shared<BE::Memory::uint8Array>(buffer)));
 	this->construct();
 }
 
 BiometricEvaluation::Video::Container::Impl::Impl(
     const std::shared_ptr<Memory::uint8Array> &buffer)
 {
-	this->_containerBuf = buffer;
+	this->_containerData.reset(new BE::Video::ContainerData(buffer));
 	this->construct();
 }
 
 BiometricEvaluation::Video::Container::Impl::Impl(
     const std::string &filename)
 {
-	this->_containerBuf.reset(
-	    new BE::Memory::uint8Array(
-		BiometricEvaluation::IO::Utility::readFile(filename)));
+	this->_containerData.reset(new BE::Video::ContainerData(filename));
 	this->construct();
 }
 
@@ -169,7 +167,8 @@ BiometricEvaluation::Video::Container::Impl::getVideoStream(
 		throw Error::ParameterError("Requested stream not present");
 	uint32_t streamIndex = findVideoStream(this->_fmtCtx, videoNum);
 	std::unique_ptr<BiometricEvaluation::Video::Stream> ptr;
-	ptr.reset(new BE::Video::StreamImpl(streamIndex, this->_containerBuf));
+	ptr.reset(new BE::Video::StreamImpl(streamIndex,
+	    this->_containerData));
 	return (ptr);
 }
 
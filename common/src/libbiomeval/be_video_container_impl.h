@@ -51,7 +51,7 @@ namespace BiometricEvaluation
 			void openContainer();
 			void construct();
 			void closeContainer();
-			std::shared_ptr<Memory::uint8Array> _containerBuf;
+			std::shared_ptr<ContainerData> _containerData;
 
 			/* FFMPEG library objects */
 			AVFormatContext *_fmtCtx;
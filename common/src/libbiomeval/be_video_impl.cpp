@@ -8,11 +8,21 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <cerrno>
 #include <cstring>
 #include <iostream>
 #include <memory>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "be_video_impl.h"
+#include <be_error.h>
+#include <be_error_exception.h>
+#include <be_io_utility.h>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -21,6 +31,79 @@ extern "C" {
 
 namespace BE = BiometricEvaluation;
 
+BiometricEvaluation::Video::ContainerData::ContainerData(
+    const std::shared_ptr<Memory::uint8Array> &buffer) :
+    _buffer(buffer),
+    _map(nullptr),
+    _data(*buffer),
+    _size(buffer->size())
+{
+}
+
+BiometricEvaluation::Video::ContainerData::ContainerData(
+    const std::string &filename) :
+    _map(nullptr),
+    _data(nullptr),
+    _size(0)
+{
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd == -1) {
+		if (errno == ENOENT)
+			throw BE::Error::ObjectDoesNotExist(filename);
+		throw BE::Error::StrategyError("Could not open " + filename +
+		    ": " + BE::Error::errorStr());
+	}
+	struct stat sb;
+	if (fstat(fd, &sb) != 0) {
+		close(fd);
+		throw BE::Error::StrategyError("Could not stat " + filename +
+		    ": " + BE::Error::errorStr());
+	}
+	this->_size = sb.st_size;
+
+	/*
+	 * The mapping remains valid after the descriptor is closed.
+	 * Pages are read from the file as FFMPEG reaches them, and
+	 * are shared with any other process mapping the same file.
+	 */
+	if (this->_size != 0) {
+		void *map = mmap(nullptr, this->_size, PROT_READ, MAP_SHARED,
+		    fd, 0);
+		if (map != MAP_FAILED)
+			this->_map = map;
+	}
+	close(fd);
+
+	if (this->_map != nullptr) {
+		this->_data = static_cast<const uint8_t *>(this->_map);
+	} else {
+		this->_buffer.reset(new BE::Memory::uint8Array(
+		    BE::IO::Utility::readFile(filename)));
+		this->_data = *this->_buffer;
+		this->_size = this->_buffer->size();
+	}
+}
+
+const uint8_t *
+BiometricEvaluation::Video::ContainerData::data()
+    const
+{
+	return (this->_data);
+}
+
+size_t
+BiometricEvaluation::Video::ContainerData::size()
+    const
+{
+	return (this->_size);
+}
+
+BiometricEvaluation::Video::ContainerData::~ContainerData()
+{
+	if (this->_map != nullptr)
+		munmap(this->_map, this->_size);
+}
+
 /*
  * The reading of the data is accomplished by setting up a read callback
  * function that returns packets from a buffer. Normally, the FFMPEG
@@ -43,7 +126,8 @@ BiometricEvaluation::Video::read_packet(
 }
 
 /*
- * Return the new buffer position, or buffer size.
+ * Return the new buffer position, or buffer size. Positions outside of
+ * the buffer are rejected so the demuxer can recover from a bad seek.
  */
 int64_t
 BiometricEvaluation::Video::seek(
@@ -51,26 +135,26 @@ BiometricEvaluation::Video::seek(
 {
 	struct BE::Video::BufferData *bd =
 	    (struct BE::Video::BufferData *)opaque;
-	switch (whence) {
+	int64_t newPos;
+	switch (whence & ~AVSEEK_FORCE) {
 		case SEEK_SET:		/* Seek from the start of buffer */
-			bd->ptr -= bd->pos;	/* Reset to start of buffer */
-			bd->ptr += offset;
-			bd->pos = offset;
+			newPos = offset;
 			break;
 		case SEEK_CUR:		/* Seek from the current position */
-			bd->ptr += offset;
-			bd->pos += offset;
+			newPos = bd->pos + offset;
 			break;
-		case SEEK_END:
-			bd->ptr -= bd->pos;	/* Reset to start of buffer */
-			bd->ptr += bd->size;
-			bd->pos = offset;
+		case SEEK_END:		/* Seek from the end of the buffer */
+			newPos = bd->size + offset;
 			break;
 		case AVSEEK_SIZE:	/* FFMPEG wants size of the stream */
 			return (bd->size);
-			break;
+		default:
+			return (-1);
 	}
-	return (0);
+	if ((newPos < 0) || (newPos > (int64_t)bd->size))
+		return (-1);
+	bd->ptr -= bd->pos;	/* Reset to start of buffer */
+	bd->ptr += newPos;
+	bd->pos = newPos;
+	return (newPos);
 }
-
-
@@ -12,18 +12,78 @@
 #define __BE_VIDEO_IMPL_H__
 
 #include <cstdint>
+#include <memory>
+#include <string>
 #include <stdio.h>
 
+#include <be_memory_autoarray.h>
+
 namespace BiometricEvaluation 
 {
 	namespace Video
 	{
 		static const uint32_t AVIOCTXBUFFERSIZE = 4096;
+		/** Number of converted frames retained by each stream. */
+		static const uint32_t FRAMECACHESIZE = 8;
 		struct BufferData {
-			uint8_t *ptr;
+			const uint8_t *ptr;
 			size_t size;
 			size_t pos;
 		};
+
+		/**
+		 * @brief
+		 * The complete contents of a container, shared by a
+		 * Container and the Streams obtained from it.
+		 * @details
+		 * Contents are either held in memory, or mapped read-only
+		 * from a file so that memory use does not depend on the
+		 * size of the container and the pages can be shared with
+		 * other processes reading the same file.
+		 */
+		class ContainerData {
+		public:
+			/**
+			 * @brief
+			 * Use a container held in memory.
+			 * @param buffer
+			 * Container contents, which must not be modified.
+			 */
+			ContainerData(
+			    const std::shared_ptr<Memory::uint8Array> &buffer);
+
+			/**
+			 * @brief
+			 * Map a container file into memory.
+			 * @details
+			 * If the file cannot be mapped, it is read into
+			 * memory instead.
+			 * @throw Error::ObjectDoesNotExist
+			 * filename does not exist.
+			 * @throw Error::StrategyError
+			 * Error opening or reading filename.
+			 */
+			ContainerData(
+			    const std::string &filename);
+
+			/** @return Pointer to the start of the container. */
+			const uint8_t *data() const;
+			/** @return Size of the container, in bytes. */
+			size_t size() const;
+
+			~ContainerData();
+
+			ContainerData(const ContainerData&) = delete;
+			ContainerData &operator=(const ContainerData&) = delete;
+		private:
+			/* Memory buffer, if not mapped */
+			std::shared_ptr<Memory::uint8Array> _buffer;
+			/* Start of the file mapping, or nullptr */
+			void *_map;
+			const uint8_t *_data;
+			size_t _size;
+		};
+
 		int read_packet(void *opaque, uint8_t *buf, int buf_size);
 		int64_t seek(void *opaque, int64_t offset, int whence);
 	}
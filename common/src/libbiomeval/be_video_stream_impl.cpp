@@ -8,6 +8,9 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <iterator>
+
 #include "be_video_impl.h"
 #include "be_video_stream_impl.h"
 #include <be_error_exception.h>
@@ -28,8 +31,8 @@ BiometricEvaluation::Video::StreamImpl::openContainer()
 	if (this->_fmtCtx == nullptr)
 		throw BE::Error::MemoryError("Could not allocate format context");
 	/* fill opaque structure used by the AVIOContext read callback */
-	this->_IOCtxBufferData.ptr = *this->_containerBuf.get();
-	this->_IOCtxBufferData.size = this->_containerBuf->size();
+	this->_IOCtxBufferData.ptr = this->_containerData->data();
+	this->_IOCtxBufferData.size = this->_containerData->size();
 	this->_IOCtxBufferData.pos = 0;
 
 	uint8_t *ctxBuf = nullptr;
@@ -81,6 +84,13 @@ BiometricEvaluation::Video::StreamImpl::openContainer()
 	avcodec_copy_context(this->_codecCtx,
 	    this->_fmtCtx->streams[this->_streamIndex]->codec);
 
+	/*
+	 * Let the library choose the number of decoding threads, using
+	 * both frame and slice threading when the codec supports them.
+	 */
+	this->_codecCtx->thread_count = 0;
+	this->_codecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
 	AVDictionary *opts = NULL;
 	av_dict_set(&opts, "refcounted_frames", "1", 0);
 	if (avcodec_open2(this->_codecCtx, codec, &opts) < 0 )
@@ -104,6 +114,13 @@ BiometricEvaluation::Video::StreamImpl::construct()
 	this->_yScale = 1.0;
 	this->_pixelFormat = BE::Image::PixelFormat::RGB24;
 	this->_avPixelFormat = AV_PIX_FMT_RGB24;
+	this->_swsFlags = SWS_ACCURATE_RND;
+	this->_frameIndexBuilt = false;
+
+	/* Decoded frames are received into the same frame every time */
+	this->_nativeFrame = av_frame_alloc();
+	if (this->_nativeFrame == nullptr)
+		throw (BE::Error::MemoryError("Could not allocate frame"));
 }
 
 /*
@@ -135,9 +152,9 @@ BiometricEvaluation::Video::StreamImpl::closeContainer()
 
 BiometricEvaluation::Video::StreamImpl::StreamImpl(
     uint32_t streamIndex,
-    const std::shared_ptr<BE::Memory::uint8Array> &containerBuf) :
+    const std::shared_ptr<BE::Video::ContainerData> &containerData) :
 	_streamIndex(streamIndex),
-	_containerBuf(containerBuf)
+	_containerData(containerData)
 {
 	this->construct();
 }
@@ -161,62 +178,174 @@ BiometricEvaluation::Video::StreamImpl::getFrameCount()
 }
 
 /*
+ * Receive the next frame from the decoder, feeding it packets from the
+ * video stream until a frame is available. Note that the stream position
+ * within the context depends on previous calls to this function.
  */
-uptrAVFrame
+AVFrame *
 BiometricEvaluation::Video::StreamImpl::getNextAVFrame()
 {
-	/* Allocate video frame for the FFMPEG internal encoded data */
-	AVFrame *frameNative;
-	frameNative = av_frame_alloc();
-	if (frameNative == nullptr)
-		throw (BE::Error::StrategyError("Could not allocate frame"));
-	uptrAVFrame pFrame(frameNative, freeAVFrame);
+	AVFrame *frameNative = this->_nativeFrame;
+	av_frame_unref(frameNative);
 
-	/*
-	 * Read the stream to get the next frame. Note that the stream position
-	 * within the context depends on previous calls to this function.
-	 */
-	int gotFrame = 0;
 	AVPacket packet;
 	av_init_packet(&packet);
 	packet.size = 0;
 	packet.data = nullptr;
 
-	/*
-	 * Grab the next frame from the video stream.
-	 */
-	while(av_read_frame(this->_fmtCtx, &packet) >= 0) {
-		if(packet.stream_index == (int)this->_streamIndex) {
-			avcodec_decode_video2(
-			    this->_codecCtx, frameNative, &gotFrame, &packet);
-			av_packet_unref(&packet);
-			if (gotFrame != 0) {
+	while (true) {
+		int ret = avcodec_receive_frame(this->_codecCtx, frameNative);
+		if (ret == 0)
+			break;
+		/* AVERROR_EOF once all flushed frames have been received */
+		if (ret != AVERROR(EAGAIN))
+			throw (BE::Error::ParameterError(
+			    "Frame could not be found"));
+
+		/*
+		 * The decoder needs another packet. When the container is
+		 * exhausted, enter draining mode to flush any cached frames.
+		 * Errors decoding an individual packet are not fatal.
+		 */
+		while (true) {
+			if (av_read_frame(this->_fmtCtx, &packet) < 0) {
+				avcodec_send_packet(this->_codecCtx, nullptr);
+				break;
+			}
+			if (packet.stream_index == (int)this->_streamIndex) {
+				avcodec_send_packet(this->_codecCtx, &packet);
+				av_packet_unref(&packet);
 				break;
-			} else {
-				av_frame_unref(frameNative);
 			}
-		} else {
 			av_packet_unref(&packet);
 		}
 	}
+	this->_currentFrameTS = av_frame_get_best_effort_timestamp(frameNative);
 	/*
-	 * We need to flush any cached frames.
-	 * See http://ffmpeg.org/doxygen/trunk/decoding_encoding_8c-example.html
+	 * Once the frame index exists, frame numbers are taken from it so
+	 * they remain correct after seeking.
 	 */
-	//XXX check packet.stream_index?
-	if (gotFrame == 0) {
-		packet.size = 0;
-		packet.data = nullptr;
-		avcodec_decode_video2(
-		    this->_codecCtx, frameNative, &gotFrame, &packet);
+	uint32_t frameNum = this->frameNumberForTS(this->_currentFrameTS);
+	if (frameNum != 0)
+		this->_currentFrameNum = frameNum;
+	else
+		this->_currentFrameNum++;
+	return (frameNative);
+}
+
+void
+BiometricEvaluation::Video::StreamImpl::buildFrameIndex()
+{
+	this->_frameIndexBuilt = true;
+
+	std::vector<int64_t> frameTS;
+	std::vector<int64_t> keyframeTS;
+	bool usable = true;
+	AVPacket packet;
+	av_init_packet(&packet);
+	packet.size = 0;
+	packet.data = nullptr;
+	while (av_read_frame(this->_fmtCtx, &packet) >= 0) {
+		if (packet.stream_index == (int)this->_streamIndex) {
+			if (packet.pts == AV_NOPTS_VALUE) {
+				usable = false;
+			} else {
+				frameTS.push_back(packet.pts);
+				if (packet.flags & AV_PKT_FLAG_KEY)
+					keyframeTS.push_back(packet.pts);
+			}
+		}
 		av_packet_unref(&packet);
 	}
-	if (gotFrame == 0) {
-		throw (BE::Error::ParameterError("Frame could not be found"));
+
+	/* Return to the start of the container, as seen by callers */
+	this->closeContainer();
+	this->openContainer();
+
+	if (!usable || keyframeTS.empty())
+		return;
+
+	/* Packets are in decode order; frames are returned in display order */
+	std::sort(frameTS.begin(), frameTS.end());
+	std::sort(keyframeTS.begin(), keyframeTS.end());
+	this->_frameTS = std::move(frameTS);
+	this->_keyframeTS = std::move(keyframeTS);
+}
+
+uint32_t
+BiometricEvaluation::Video::StreamImpl::frameNumberForTS(
+    int64_t ts)
+    const
+{
+	auto it = std::lower_bound(
+	    this->_frameTS.cbegin(), this->_frameTS.cend(), ts);
+	if ((it == this->_frameTS.cend()) || (*it != ts))
+		return (0);
+	return (std::distance(this->_frameTS.cbegin(), it) + 1);
+}
+
+int64_t
+BiometricEvaluation::Video::StreamImpl::keyframeTSForTS(
+    int64_t ts)
+    const
+{
+	auto it = std::upper_bound(
+	    this->_keyframeTS.cbegin(), this->_keyframeTS.cend(), ts);
+	if (it == this->_keyframeTS.cbegin())
+		return (this->_keyframeTS.front());
+	return (*(--it));
+}
+
+bool
+BiometricEvaluation::Video::StreamImpl::seekToKeyframe(
+    int64_t keyTS)
+{
+	if (av_seek_frame(this->_fmtCtx, this->_streamIndex, keyTS,
+	    AVSEEK_FLAG_BACKWARD) < 0)
+		return (false);
+	avcodec_flush_buffers(this->_codecCtx);
+
+	/* Nothing at or after the keyframe has been decoded yet */
+	uint32_t keyFrameNum = this->frameNumberForTS(keyTS);
+	this->_currentFrameNum = (keyFrameNum == 0 ? 0 : keyFrameNum - 1);
+	this->_currentFrameTS = keyTS - 1;
+	return (true);
+}
+
+void
+BiometricEvaluation::Video::StreamImpl::positionForTS(
+    int64_t targetTS)
+{
+	if (!this->_frameIndexBuilt)
+		this->buildFrameIndex();
+
+	bool behind = (this->_currentFrameTS >= targetTS);
+	if (this->_keyframeTS.empty()) {
+		/* No index; the only way back is from the start */
+		if (behind) {
+			this->closeContainer();
+			this->openContainer();
+		}
+		return;
+	}
+
+	/*
+	 * Seek when going backwards, or when going forward past at least
+	 * one keyframe, which is cheaper than decoding every frame between.
+	 */
+	int64_t keyTS = this->keyframeTSForTS(targetTS);
+	if (behind || (keyTS > this->_currentFrameTS)) {
+		if (!this->seekToKeyframe(keyTS) && behind) {
+			this->closeContainer();
+			this->openContainer();
+		}
 	}
-	this->_currentFrameNum++;
-	this->_currentFrameTS = av_frame_get_best_effort_timestamp(frameNative);
-	return (pFrame);
+}
+
+void
+BiometricEvaluation::Video::StreamImpl::clearFrameCache()
+{
+	this->_frameCache.clear();
 }
 
 /*
@@ -225,66 +354,52 @@ BiometricEvaluation::Video::StreamImpl::getNextAVFrame()
  * FFMPEG library. Therefore, this is a member function so the context
  * pointer can be updated.
  */
-BiometricEvaluation::Video::Frame
+void
 BiometricEvaluation::Video::StreamImpl::convertAVFrame(
-    AVFrame *frameNative)
+    AVFrame *frameNative,
+    BiometricEvaluation::Video::Frame &frame)
 {
-	BE::Video::Frame staticFrame;
-	staticFrame.size.xSize = this->_codecCtx->width * this->_xScale;
-	staticFrame.size.ySize = this->_codecCtx->height * this->_yScale;
-	staticFrame.timestamp = av_frame_get_best_effort_timestamp(frameNative);
+	frame.size.xSize = this->_codecCtx->width * this->_xScale;
+	frame.size.ySize = this->_codecCtx->height * this->_yScale;
+	frame.timestamp = av_frame_get_best_effort_timestamp(frameNative);
 
 	/* Calculate the size of the decoded frame */
 	int frameSize = av_image_get_buffer_size(
 	    this->_avPixelFormat,
-	    staticFrame.size.xSize, staticFrame.size.ySize, 1);
+	    frame.size.xSize, frame.size.ySize, 1);
 
 	/*
 	 * Reuse the scaling context, if possible. If there is more than
 	 * one video stream, with different codec parameters (width, etc.)
-	 * then a new scaling context will be allocated, the old one
-	 * being free'd.
+	 * or the scaling algorithm changed, then a new scaling context
+	 * will be allocated, the old one being free'd.
 	 */
 	this->_swsCtx = sws_getCachedContext(
 	    this->_swsCtx,
 	    this->_codecCtx->width, this->_codecCtx->height,
 	    this->_codecCtx->pix_fmt,
-	    staticFrame.size.xSize, staticFrame.size.ySize,
+	    frame.size.xSize, frame.size.ySize,
 	    this->_avPixelFormat,
-	    SWS_ACCURATE_RND, nullptr, nullptr, nullptr);
+	    this->_swsFlags, nullptr, nullptr, nullptr);
+	if (this->_swsCtx == nullptr)
+		throw (BE::Error::StrategyError("Could not get scaling "
+		    "context"));
 
-	//XXX We can either allocate a buffer for the output frame by using
-	//XXX the ffmpeg library function, or we can create an AutoArray
-	//XXX and associate that with the frame. The library function is
-	//XXX supposed to take care of alignment.
-/*
-	uint8_t *buffer = (uint8_t *)av_malloc(frameSize * sizeof(uint8_t));
-	std::unique_ptr<uint8_t, decltype(freeAVBuffer)>
-	    pBuffer(buffer, freeAVBuffer);
-	if (buffer == nullptr)
-		throw (Error::StrategyError("Could not allocate frame buffer"));
-*/
-	/* Allocate video frame for the for the output frame data */
-	AVFrame *frameOut;
-	frameOut = av_frame_alloc();
-	if (frameOut == nullptr)
-		throw (BE::Error::StrategyError("Could not allocate frame"));
-	uptrAVFrame pFrameOut(frameOut, freeAVFrame);
-
-	staticFrame.data.resize(frameSize);
-	av_image_fill_arrays(frameOut->data, frameOut->linesize,
-	    &staticFrame.data[0], this->_avPixelFormat, staticFrame.size.xSize,
-	    staticFrame.size.ySize, 1);
+	/*
+	 * Scale directly into the frame's buffer, which is only
+	 * reallocated when it is smaller than the converted frame.
+	 */
+	frame.data.resize(frameSize);
+	uint8_t *dstData[4];
+	int dstLinesize[4];
+	av_image_fill_arrays(dstData, dstLinesize,
+	    &frame.data[0], this->_avPixelFormat, frame.size.xSize,
+	    frame.size.ySize, 1);
 
 	sws_scale(
 	    this->_swsCtx, frameNative->data, frameNative->linesize,
 	    0, this->_codecCtx->height,
-	    frameOut->data, frameOut->linesize);
-
-//	XXX Copy is only necessary when the av_malloc'd buffer is used.
-//	std::memcpy(frameBuffer, frameOut->data[0], frameSize);
-
-	return (staticFrame);
+	    dstData, dstLinesize);
 }
 
 BiometricEvaluation::Video::Frame
@@ -292,31 +407,81 @@ BiometricEvaluation::Video::StreamImpl::getFrame(
     uint32_t frameNum)
 {
 	/*
-	 * If the last frame read from the stream is after the requested
-	 * frame, reset close and open the container stream and start
-	 * reading from the beginning.
-	 * XXX The av_seek* functions do not seem to work; try again some time.
+	 * Repeated requests for nearby frames are satisfied from the
+	 * cache of recently converted frames.
 	 */
-	if (frameNum <= this->_currentFrameNum) {
-		this->closeContainer();
-		this->openContainer();
+	for (auto it = this->_frameCache.begin();
+	    it != this->_frameCache.end(); it++) {
+		if (it->first == frameNum) {
+			this->_frameCache.splice(this->_frameCache.begin(),
+			    this->_frameCache, it);
+			return (this->_frameCache.front().second);
+		}
+	}
+
+	/*
+	 * The next frame in the stream is simply decoded. Anything else
+	 * uses the frame index, built on the first such request, to seek
+	 * to the keyframe preceding the requested frame. Without a usable
+	 * index, close and open the container stream and start reading
+	 * from the beginning.
+	 */
+	if (frameNum != this->_currentFrameNum + 1) {
+		if (!this->_frameIndexBuilt)
+			this->buildFrameIndex();
+		if ((frameNum >= 1) && (frameNum <= this->_frameTS.size())) {
+			this->positionForTS(this->_frameTS[frameNum - 1]);
+		} else if (frameNum <= this->_currentFrameNum) {
+			this->closeContainer();
+			this->openContainer();
+		}
 	}
+
 	/*
 	 * Let exceptions float out from here.
 	 */
 	while(true) {
-		auto uptrFrame = getNextAVFrame();
+		AVFrame *frameNative = getNextAVFrame();
 		if (frameNum == this->_currentFrameNum) {
-			AVFrame *frameNative = uptrFrame.get();
-			return (convertAVFrame(frameNative));
+			/* A full cache recycles its oldest frame buffer */
+			if (this->_frameCache.size() < FRAMECACHESIZE)
+				this->_frameCache.emplace_front();
+			else
+				this->_frameCache.splice(
+				    this->_frameCache.begin(),
+				    this->_frameCache,
+				    std::prev(this->_frameCache.end()));
+			this->_frameCache.front().first = frameNum;
+			this->convertAVFrame(frameNative,
+			    this->_frameCache.front().second);
+			return (this->_frameCache.front().second);
 		}
+		if (this->_currentFrameNum > frameNum)
+			throw (BE::Error::StrategyError("Frame could not be "
+			    "decoded"));
 	}
 }
 
-std::vector<BiometricEvaluation::Video::Frame>
-BiometricEvaluation::Video::StreamImpl::getFrameSequence(
-    int64_t startTime,     
-    int64_t endTime)
+bool
+BiometricEvaluation::Video::StreamImpl::getNextFrame(
+    BiometricEvaluation::Video::Frame &frame)
+{
+	AVFrame *frameNative;
+	try {
+		frameNative = this->getNextAVFrame();
+	} catch (const Error::ParameterError&) {
+		return (false);		/* Ran out of frames */
+	}
+	this->convertAVFrame(frameNative, frame);
+	return (true);
+}
+
+uint64_t
+BiometricEvaluation::Video::StreamImpl::processFrameSequence(
+    int64_t startTime,
+    int64_t endTime,
+    const std::function<bool(const BiometricEvaluation::Video::Frame&)>
+    &callback)
 {
 	uint32_t streamIdx = this->_streamIndex;
 	int64_t startTS = av_rescale(
@@ -332,33 +497,46 @@ BiometricEvaluation::Video::StreamImpl::getFrameSequence(
 
 	/*
 	 * If the last scanned frame has a time stamp later than
-	 * the time of the requested start of sequence, then
-	 * we need to start at the beginning of the container so
-	 * we can grab frames at any point. This is the equivalent
-	 * of seeking to the beginning.
+	 * the time of the requested start of sequence, or the start
+	 * is beyond the next keyframe, seek to the keyframe preceding
+	 * the start of the sequence.
 	 */
-	if (this->_currentFrameTS >= startTS) {
-		this->closeContainer();
-		this->openContainer();
-	}
+	this->positionForTS(startTS);
 
-	std::vector<BE::Video::Frame> frames;
+	/* Every frame is converted into the same buffer */
+	BE::Video::Frame frame;
+	uint64_t count = 0;
 	while (true) {
+		AVFrame *frameNative;
 		try {
-			auto uptrFrame = getNextAVFrame();
-			AVFrame *frameNative = uptrFrame.get();
-			if (this->_currentFrameTS > endTS) {
-				break;		/* past the point of caring */
-			}
-			if ((this->_currentFrameTS >= startTS)
-			     && (this->_currentFrameTS <= endTS)) {
-				auto frame = convertAVFrame(frameNative);
-				frames.push_back(std::move(frame));
-			}
-		} catch (Error::ParameterError) {
+			frameNative = this->getNextAVFrame();
+		} catch (const Error::ParameterError&) {
 			break;		/* Ran out of frames */
 		}
+		if (this->_currentFrameTS > endTS) {
+			break;		/* past the point of caring */
+		}
+		if (this->_currentFrameTS >= startTS) {
+			this->convertAVFrame(frameNative, frame);
+			count++;
+			if (!callback(frame))
+				break;
+		}
 	}
+	return (count);
+}
+
+std::vector<BiometricEvaluation::Video::Frame>
+BiometricEvaluation::Video::StreamImpl::getFrameSequence(
+    int64_t startTime,     
+    int64_t endTime)
+{
+	std::vector<BE::Video::Frame> frames;
+	this->processFrameSequence(startTime, endTime,
+	    [&](const BE::Video::Frame &frame) -> bool {
+		frames.push_back(frame);
+		return (true);
+	});
 	return (frames);
 }
 
@@ -369,6 +547,26 @@ BiometricEvaluation::Video::StreamImpl::setFrameScale(
 {
 	this->_xScale = xScale;
 	this->_yScale = yScale;
+	this->clearFrameCache();
+}
+
+void
+BiometricEvaluation::Video::StreamImpl::setFrameScalingAlgorithm(
+    const ScalingAlgorithm algorithm)
+{
+	switch (algorithm) {
+		case BE::Video::ScalingAlgorithm::Accurate:
+			this->_swsFlags = SWS_ACCURATE_RND; break;
+		case BE::Video::ScalingAlgorithm::Bicubic:
+			this->_swsFlags = SWS_BICUBIC; break;
+		case BE::Video::ScalingAlgorithm::Bilinear:
+			this->_swsFlags = SWS_BILINEAR; break;
+		case BE::Video::ScalingAlgorithm::FastBilinear:
+			this->_swsFlags = SWS_FAST_BILINEAR; break;
+		case BE::Video::ScalingAlgorithm::Point:
+			this->_swsFlags = SWS_POINT; break;
+	}
+	this->clearFrameCache();
 }
 
 void
@@ -386,10 +584,12 @@ BiometricEvaluation::Video::StreamImpl::setFramePixelFormat(
 		case BE::Image::PixelFormat::RGB24:
 			this->_avPixelFormat = AV_PIX_FMT_RGB24; break;
 	}
+	this->clearFrameCache();
 }
 
 BiometricEvaluation::Video::StreamImpl::~StreamImpl()
 {
 	this->closeContainer();
+	av_frame_free(&this->_nativeFrame);
 }
 
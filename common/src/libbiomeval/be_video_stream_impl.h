@@ -12,12 +12,17 @@
 #define __BE_VIDEO_STREAM_IMPL_H__
 
 #include <cstdint>
+#include <functional>
+#include <list>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include <be_memory_autoarray.h>
 #include <be_video_container.h>
 
+#include "be_video_impl.h"
+
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
@@ -31,13 +36,6 @@ extern "C" {
  */
 #undef PixelFormat
 
-/*
- * Create deleter functors for any of the FFMPEG library objects
- * that have library deleters, so we can wrap them in smart pointers.
- */
-
-static auto freeAVFrame = [](AVFrame* frame) { av_frame_free(&frame); };
-using uptrAVFrame = std::unique_ptr<AVFrame, decltype(freeAVFrame)>;
 namespace BiometricEvaluation 
 {
 	namespace Video
@@ -59,8 +57,20 @@ namespace BiometricEvaluation
 			    int64_t startTime,
 			    int64_t endTime);
 
+			uint64_t processFrameSequence(
+			    int64_t startTime,
+			    int64_t endTime,
+			    const std::function<bool(const Video::Frame&)>
+				&callback);
+
+			bool getNextFrame(
+			    Video::Frame &frame);
+
 			void setFrameScale(float xScale, float yScale);
 
+			void setFrameScalingAlgorithm(
+			    const ScalingAlgorithm algorithm);
+
 			void setFramePixelFormat(
 			    const Image::PixelFormat pixelFormat);
 
@@ -83,34 +93,120 @@ namespace BiometricEvaluation
 			 * use for video frames. This is the absolute index
 			 * number, where the second stream could be the first
 			 * video stream, for example.
-			 * @param containerBuf
-			 * A shared pointer to the container buffer.
+			 * @param containerData
+			 * A shared pointer to the container contents.
 			 */
 			StreamImpl(
 			    uint32_t streamIndex,
-			    const std::shared_ptr<Memory::uint8Array>
-				&containerBuf);
+			    const std::shared_ptr<ContainerData>
+				&containerData);
 
 			void openContainer();
 			void construct();
 			void closeContainer();
-			BiometricEvaluation::Video::Frame
-			    convertAVFrame(AVFrame *frameNative);
-			uptrAVFrame getNextAVFrame();
+			/**
+			 * @brief
+			 * Scale and convert a decoded frame.
+			 * @details
+			 * The frame's buffer is reused when large enough.
+			 */
+			void convertAVFrame(
+			    AVFrame *frameNative,
+			    Video::Frame &frame);
+
+			/**
+			 * @brief
+			 * Decode the next frame of the stream.
+			 * @return
+			 * Decoded frame, owned by this object and valid
+			 * until the next call.
+			 * @throw Error::ParameterError
+			 * No more frames in the stream.
+			 */
+			AVFrame *getNextAVFrame();
+
+			/**
+			 * @brief
+			 * Scan the packets of the video stream, recording
+			 * the presentation time stamp of every frame and
+			 * of every keyframe.
+			 * @details
+			 * Only the container is de-multiplexed; no frames
+			 * are decoded. The container is reopened afterwards.
+			 * If any packet lacks a time stamp, the index is
+			 * left empty and linear decoding is used.
+			 */
+			void buildFrameIndex();
+
+			/**
+			 * @brief
+			 * Obtain the frame number for a time stamp.
+			 * @return
+			 * Frame number, >= 1, or 0 if the time stamp is
+			 * not in the frame index.
+			 */
+			uint32_t frameNumberForTS(int64_t ts) const;
+
+			/**
+			 * @brief
+			 * Obtain the time stamp of the last keyframe at or
+			 * before a time stamp.
+			 * @note
+			 * The frame index must not be empty.
+			 */
+			int64_t keyframeTSForTS(int64_t ts) const;
+
+			/**
+			 * @brief
+			 * Position the demuxer and decoder at a keyframe.
+			 * @return
+			 * true if the seek succeeded, false otherwise, in
+			 * which case the stream position is unchanged.
+			 */
+			bool seekToKeyframe(int64_t keyTS);
+
+			/**
+			 * @brief
+			 * Position the stream so that the next frame
+			 * decoded is no later than the frame with the
+			 * given time stamp.
+			 * @details
+			 * Seeks to the preceding keyframe when the target
+			 * is behind the current position or when that
+			 * keyframe is ahead of it; otherwise decoding
+			 * simply continues from the current position.
+			 */
+			void positionForTS(int64_t targetTS);
+
+			/** Drop all converted frames from the cache. */
+			void clearFrameCache();
+
 			/* FFMPEG library objects */
 			struct Video::BufferData _IOCtxBufferData;
 			AVIOContext *_avioCtx;
 			AVFormatContext *_fmtCtx;
 			AVCodecContext *_codecCtx;
 			SwsContext *_swsCtx;
+			AVFrame *_nativeFrame;
 
 			uint32_t _streamIndex;
-			std::shared_ptr<Memory::uint8Array> _containerBuf;
+			std::shared_ptr<ContainerData> _containerData;
 			uint32_t _currentFrameNum;
 			int64_t _currentFrameTS;
 			float _xScale, _yScale;
 			Image::PixelFormat _pixelFormat;
 			AVPixelFormat _avPixelFormat;	/* FFMPEG value */
+			int _swsFlags;			/* FFMPEG value */
+
+			/* Whether buildFrameIndex() has been called */
+			bool _frameIndexBuilt;
+			/* Sorted presentation time stamps of all frames */
+			std::vector<int64_t> _frameTS;
+			/* Sorted presentation time stamps of keyframes */
+			std::vector<int64_t> _keyframeTS;
+			/* Most recently returned frames, newest first */
+			std::list<std::pair<uint32_t, Video::Frame>>
+			    _frameCache;
 		};
 	}
 }
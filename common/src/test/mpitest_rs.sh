@@ -34,6 +34,8 @@ PROPS=test_be_rs_mpi.props
 cat > $PROPS << EOF
 Input Record Store = $INPUTRS
 Chunk Size = 4
+# Hand out whole shards when the input is a ShardedRecordStore
+#Distribute Shards = YES
 Workers Per Node = 2
 Logsheet URL = file://mpi.log
 Record Logsheet URL = file://record.log
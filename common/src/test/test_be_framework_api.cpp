@@ -12,7 +12,10 @@
 #include <be_framework_enumeration.h>
 #include <be_framework_status.h>
 
+#include <atomic>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 namespace BE = BiometricEvaluation;
 using namespace BE::Framework::Enumeration;
@@ -164,6 +167,178 @@ Eval::to_string(
  ******************************************************************************
  ******************************************************************************/
 
+/**
+ * @brief
+ * Run guarded calls from many threads at once.
+ * @details
+ * Each thread completes, crashes, or hangs depending on its index, and
+ * must observe exactly its own outcome.
+ *
+ * @return
+ * true if every thread observed the expected outcome, false otherwise.
+ */
+static bool
+testConcurrentCalls()
+{
+	static const uint32_t numThreads{64};
+	std::cout << "Running " << numThreads << " concurrent guarded "
+	    "calls... " << std::flush;
+
+	std::atomic<uint32_t> failures{0};
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < numThreads; i++) {
+		threads.emplace_back([i, &failures]() {
+			BE::Framework::API<int> api;
+			api.getWatchdog()->setInterval(
+			    BE::Time::OneHalfSecond / 2);
+
+			BE::Framework::APICurrentState expected;
+			BE::Framework::API<int>::Result result;
+			switch (i % 3) {
+			case 0:
+				expected = BE::Framework::APICurrentState::
+				    Completed;
+				result = api.call([i]() -> int {
+					return (static_cast<int>(i));
+				});
+				if (result && (result.status !=
+				    static_cast<int>(i)))
+					failures++;
+				break;
+			case 1:
+				expected = BE::Framework::APICurrentState::
+				    SignalCaught;
+				result = api.call([]() -> int {
+					return (Eval::matchTemplates(1, 1));
+				});
+				break;
+			default:
+				expected = BE::Framework::APICurrentState::
+				    WatchdogExpired;
+				result = api.call([]() -> int {
+					volatile bool forever = true;
+					while (forever);
+					return (0);
+				});
+				break;
+			}
+			if (result.currentState != expected)
+				failures++;
+		});
+	}
+	for (auto &thread : threads)
+		thread.join();
+
+	if (failures != 0) {
+		std::cout << "FAIL (" << failures << " unexpected outcomes)" <<
+		    std::endl;
+		return (false);
+	}
+	std::cout << "PASS" << std::endl;
+	return (true);
+}
+
+/**
+ * @brief
+ * Run a batch of guarded calls and compare against individual calls.
+ *
+ * @return
+ * true if every operation in the batch observed the expected outcome,
+ * false otherwise.
+ */
+static bool
+testBatchCalls()
+{
+	static const uint32_t numOperations{10000};
+	BE::Framework::API<int> api;
+	api.getWatchdog()->setInterval(BE::Time::OneHalfSecond / 5);
+
+	std::cout << "Running batch of " << numOperations << " guarded "
+	    "calls... " << std::flush;
+	std::vector<std::function<int(void)>> operations;
+	for (uint32_t i = 0; i < numOperations; i++)
+		operations.push_back([i]() -> int {
+			return (static_cast<int>(i * 2));
+		});
+	/* A crash, a hang, and an exception, each followed by a success */
+	operations[100] = []() -> int {
+		return (Eval::matchTemplates(1, 1));
+	};
+	operations[200] = []() -> int {
+		volatile bool forever = true;
+		while (forever);
+		return (0);
+	};
+	operations[300] = []() -> int {
+		throw BE::Error::StrategyError("Vendor error");
+	};
+
+	BE::Time::Timer batchTimer;
+	batchTimer.start();
+	const auto results = api.callBatch(operations);
+	batchTimer.stop();
+	if (results.size() != numOperations) {
+		std::cout << "FAIL (" << results.size() << " results)" <<
+		    std::endl;
+		return (false);
+	}
+	for (uint32_t i = 0; i < numOperations; i++) {
+		BE::Framework::APICurrentState expected{
+		    BE::Framework::APICurrentState::Completed};
+		if (i == 100)
+			expected = BE::Framework::APICurrentState::SignalCaught;
+		else if (i == 200)
+			expected = BE::Framework::APICurrentState::
+			    WatchdogExpired;
+		else if (i == 300)
+			expected = BE::Framework::APICurrentState::
+			    ExceptionCaught;
+		if ((results[i].currentState != expected) ||
+		    (results[i] && (results[i].status !=
+		    static_cast<int>(i * 2)))) {
+			std::cout << "FAIL (operation " << i << " was " <<
+			    to_string(results[i].currentState) << ")" <<
+			    std::endl;
+			return (false);
+		}
+	}
+	std::cout << "PASS" << std::endl;
+
+	std::cout << "Checking latency histograms... ";
+	for (const auto state : {BE::Framework::APICurrentState::Completed,
+	    BE::Framework::APICurrentState::SignalCaught,
+	    BE::Framework::APICurrentState::WatchdogExpired,
+	    BE::Framework::APICurrentState::ExceptionCaught}) {
+		const uint64_t expected = (state ==
+		    BE::Framework::APICurrentState::Completed ?
+		    numOperations - 3 : 1);
+		const auto histogram = api.getLatencyHistogram(state);
+		if (histogram->getCount() != expected) {
+			std::cout << "FAIL (" << histogram->getCount() << " " <<
+			    to_string(state) << ")" << std::endl;
+			return (false);
+		}
+	}
+	std::cout << "PASS" << std::endl;
+	for (const auto state : {BE::Framework::APICurrentState::Completed,
+	    BE::Framework::APICurrentState::WatchdogExpired})
+		std::cout << "\t" << to_string(state) << " (ns): " <<
+		    api.getLatencyHistogram(state)->toString() << std::endl;
+
+	/* Compare per-operation overhead with individual calls */
+	BE::Time::Timer callTimer;
+	callTimer.start();
+	for (uint32_t i = 0; i < 1000; i++)
+		api.call(operations[0]);
+	callTimer.stop();
+	std::cout << "\tcall(): " << callTimer.elapsed() / 1000.0 <<
+	    "µs/operation; callBatch(): " << (batchTimer.elapsed() -
+	    results[200].elapsed) / static_cast<double>(numOperations - 1) <<
+	    "µs/operation" << std::endl;
+
+	return (true);
+}
+
 int
 main()
 {
@@ -241,6 +416,14 @@ main()
 	intAPI.getWatchdog()->setInterval(30 *
 	    BE::Time::MicrosecondsPerSecond);
 
+	/* Each thread may have its own API object */
+	if (!testConcurrentCalls())
+		return (1);
+
+	/* Many small operations may be guarded in one batch */
+	if (!testBatchCalls())
+		return (1);
+
 	return (0);
 }
 
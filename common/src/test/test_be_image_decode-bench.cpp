@@ -0,0 +1,117 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+/*
+ * Time getRawData() for every image in the sample image RecordStore,
+ * grouped by the decoder that handles it.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+
+#include <be_error_exception.h>
+#include <be_image_image.h>
+#include <be_io_recordstore.h>
+#include <be_time_timer.h>
+
+namespace BE = BiometricEvaluation;
+using namespace std;
+
+static const std::string ImageRSPath = "test_data/ImageRS";
+static const std::string RawSuffix = ".raw";
+/** Times each image is decoded when not given on the command line */
+static const uint32_t DEFAULT_ITERATIONS = 10;
+
+/** Totals for one decoder */
+struct DecoderTotals
+{
+	uint32_t images{0};
+	uint64_t rawBytes{0};
+	uint64_t microseconds{0};
+};
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+	uint32_t iterations = DEFAULT_ITERATIONS;
+	if (argc > 1)
+		iterations = std::max(1, std::atoi(argv[1]));
+
+	std::shared_ptr<BE::IO::RecordStore> imageRS;
+	try {
+		imageRS = BE::IO::RecordStore::openRecordStore(ImageRSPath,
+		    BE::IO::Mode::ReadOnly);
+	} catch (const BE::Error::Exception &e) {
+		cerr << "Could not open " << ImageRSPath << ": " <<
+		    e.whatString() << endl;
+		return (EXIT_FAILURE);
+	}
+
+	std::map<std::string, DecoderTotals> totals;
+	for (const auto &record : *imageRS) {
+		/* Decoded versions are stored alongside each image */
+		if ((record.key.length() >= RawSuffix.length()) &&
+		    (record.key.compare(record.key.length() -
+		    RawSuffix.length(), RawSuffix.length(), RawSuffix) == 0))
+			continue;
+
+		std::shared_ptr<BE::Image::Image> image;
+		try {
+			image = BE::Image::Image::openImage(record.data);
+		} catch (const BE::Error::Exception&) {
+			/* Not an image, or no decoder in this build */
+			continue;
+		}
+
+		BE::Time::Timer timer;
+		uint64_t rawBytes = 0;
+		try {
+			timer.start();
+			for (uint32_t i = 0; i < iterations; i++)
+				rawBytes = image->getRawData().size();
+			timer.stop();
+		} catch (const BE::Error::Exception &e) {
+			cerr << record.key << ": " << e.whatString() << endl;
+			return (EXIT_FAILURE);
+		}
+
+		auto &decoder = totals[BE::Framework::Enumeration::to_string(
+		    image->getCompressionAlgorithm())];
+		decoder.images++;
+		decoder.rawBytes += rawBytes * iterations;
+		decoder.microseconds += timer.elapsed();
+	}
+
+	cout << "Decoding each image " << iterations << " times" << endl;
+	cout << left << setw(12) << "Decoder" << right << setw(8) <<
+	    "Images" << setw(16) << "us/decode" << setw(12) << "MiB/s" <<
+	    endl;
+	for (const auto &decoder : totals) {
+		const auto &t = decoder.second;
+		const double decodes = static_cast<double>(t.images) *
+		    iterations;
+		const double mibPerSecond = (t.microseconds == 0) ? 0 :
+		    ((t.rawBytes / (1024.0 * 1024.0)) /
+		    (t.microseconds / 1000000.0));
+		cout << left << setw(12) << decoder.first << right <<
+		    setw(8) << t.images << setw(16) << fixed <<
+		    setprecision(1) << (t.microseconds / decodes) <<
+		    setw(12) << mibPerSecond << endl;
+	}
+
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,224 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+/*
+ * Time each encoder, with several settings, on the decoded versions of
+ * the images in the sample image RecordStore.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <be_error_exception.h>
+#include <be_image_image.h>
+#include <be_image_jpeg.h>
+#include <be_image_jpeg2000.h>
+#include <be_image_png.h>
+#include <be_image_raw.h>
+#include <be_image_wsq.h>
+#include <be_io_recordstore.h>
+#include <be_time_timer.h>
+
+namespace BE = BiometricEvaluation;
+using namespace std;
+
+static const std::string ImageRSPath = "test_data/ImageRS";
+static const std::string RawSuffix = ".raw";
+/** Times each image is encoded when not given on the command line */
+static const uint32_t DEFAULT_ITERATIONS = 3;
+
+/** One encoder and its settings */
+struct Encoder
+{
+	Encoder(
+	    const std::string &name,
+	    const std::function<BE::Memory::uint8Array(
+	    const BE::Image::Image&)> &encode) :
+	    name(name),
+	    encode(encode)
+	{
+
+	}
+
+	/** Description of the encoder and settings */
+	std::string name;
+	/** Encode an image */
+	std::function<BE::Memory::uint8Array(const BE::Image::Image&)> encode;
+
+	/** Images encoded */
+	uint32_t images{0};
+	/** Total size of the raw images encoded */
+	uint64_t rawBytes{0};
+	/** Total size of the encoded images */
+	uint64_t encodedBytes{0};
+	/** Total time spent encoding */
+	uint64_t microseconds{0};
+};
+
+/** @return Encoders and settings to compare */
+static std::vector<Encoder>
+getEncoders()
+{
+	std::vector<Encoder> encoders;
+
+	for (const uint8_t level : {1, 6, 9}) {
+		for (const auto filter : {BE::Image::PNG::Filter::None,
+		    BE::Image::PNG::Filter::Adaptive}) {
+			BE::Image::PNG::EncodeOptions options;
+			options.compressionLevel = level;
+			options.filter = filter;
+			encoders.emplace_back("PNG level " + std::to_string(
+			    level) + (filter == BE::Image::PNG::Filter::None ?
+			    ", no filter" : ", adaptive"),
+			    [options](const BE::Image::Image &image) {
+				return (BE::Image::PNG::encode(image, options));
+			    });
+		}
+	}
+
+	const std::vector<std::pair<std::string, BE::Image::JPEG::DCTMethod>>
+	    dctMethods{{"integer", BE::Image::JPEG::DCTMethod::Integer},
+	    {"fast integer", BE::Image::JPEG::DCTMethod::FastInteger},
+	    {"float", BE::Image::JPEG::DCTMethod::Float}};
+	for (const auto &method : dctMethods) {
+		BE::Image::JPEG::EncodeOptions options;
+		options.dctMethod = method.second;
+		encoders.emplace_back("JPEG q75, " + method.first + " DCT",
+		    [options](const BE::Image::Image &image) {
+			return (BE::Image::JPEG::encode(image, options));
+		    });
+	}
+	BE::Image::JPEG::EncodeOptions optimized;
+	optimized.optimizeCoding = true;
+	encoders.emplace_back("JPEG q75, optimized Huffman",
+	    [optimized](const BE::Image::Image &image) {
+		return (BE::Image::JPEG::encode(image, optimized));
+	    });
+
+	for (const float ratio : {0.0f, 10.0f}) {
+		for (const uint32_t threads : {1u, 0u}) {
+			BE::Image::JPEG2000::EncodeOptions options;
+			options.compressionRatio = ratio;
+			options.threads = threads;
+			encoders.emplace_back("JPEG2000 " + (ratio == 0 ?
+			    std::string("lossless") : "10:1") +
+			    (threads == 1 ? ", 1 thread" : ", all threads"),
+			    [options](const BE::Image::Image &image) {
+				return (BE::Image::JPEG2000::encode(image,
+				    options));
+			    });
+		}
+	}
+
+	for (const float bitRate : {0.75f, 2.25f}) {
+		BE::Image::WSQ::EncodeOptions options;
+		options.bitRate = bitRate;
+		encoders.emplace_back("WSQ " + std::string(bitRate < 1 ?
+		    "0.75" : "2.25") + " bpp",
+		    [options](const BE::Image::Image &image) {
+			return (BE::Image::WSQ::encode(image, options));
+		    });
+	}
+
+	return (encoders);
+}
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+	uint32_t iterations = DEFAULT_ITERATIONS;
+	if (argc > 1)
+		iterations = std::max(1, std::atoi(argv[1]));
+
+	std::shared_ptr<BE::IO::RecordStore> imageRS;
+	try {
+		imageRS = BE::IO::RecordStore::openRecordStore(ImageRSPath,
+		    BE::IO::Mode::ReadOnly);
+	} catch (const BE::Error::Exception &e) {
+		cerr << "Could not open " << ImageRSPath << ": " <<
+		    e.whatString() << endl;
+		return (EXIT_FAILURE);
+	}
+
+	std::vector<Encoder> encoders = getEncoders();
+	for (const auto &record : *imageRS) {
+		/* Decoded versions are stored alongside each image */
+		if ((record.key.length() >= RawSuffix.length()) &&
+		    (record.key.compare(record.key.length() -
+		    RawSuffix.length(), RawSuffix.length(), RawSuffix) == 0))
+			continue;
+
+		/* Decode once, so only encoding is timed */
+		std::shared_ptr<BE::Image::Image> raw;
+		try {
+			const auto image = BE::Image::Image::openImage(
+			    record.data);
+			raw.reset(new BE::Image::Raw(image->getRawData(),
+			    image->getDimensions(), image->getColorDepth(),
+			    image->getBitDepth(), image->getResolution(),
+			    image->hasAlphaChannel()));
+		} catch (const BE::Error::Exception&) {
+			/* Not an image, or no decoder in this build */
+			continue;
+		}
+		const uint64_t rawBytes = raw->getData().size();
+
+		for (auto &encoder : encoders) {
+			BE::Time::Timer timer;
+			uint64_t encodedBytes = 0;
+			try {
+				timer.start();
+				for (uint32_t i = 0; i < iterations; i++)
+					encodedBytes = encoder.encode(
+					    *raw).size();
+				timer.stop();
+			} catch (const BE::Error::Exception&) {
+				/* Encoder does not support this image */
+				continue;
+			}
+
+			encoder.images++;
+			encoder.rawBytes += rawBytes * iterations;
+			encoder.encodedBytes += encodedBytes * iterations;
+			encoder.microseconds += timer.elapsed();
+		}
+	}
+
+	cout << "Encoding each image " << iterations << " times" << endl;
+	cout << left << setw(36) << "Encoder" << right << setw(8) <<
+	    "Images" << setw(14) << "us/encode" << setw(10) << "MiB/s" <<
+	    setw(8) << "Ratio" << endl;
+	for (const auto &encoder : encoders) {
+		if (encoder.images == 0)
+			continue;
+		const double encodes = static_cast<double>(encoder.images) *
+		    iterations;
+		const double mibPerSecond = (encoder.microseconds == 0) ? 0 :
+		    ((encoder.rawBytes / (1024.0 * 1024.0)) /
+		    (encoder.microseconds / 1000000.0));
+		const double ratio = (encoder.encodedBytes == 0) ? 0 :
+		    (static_cast<double>(encoder.rawBytes) /
+		    encoder.encodedBytes);
+		cout << left << setw(36) << encoder.name << right <<
+		    setw(8) << encoder.images << setw(14) << fixed <<
+		    setprecision(1) << (encoder.microseconds / encodes) <<
+		    setw(10) << mibPerSecond << setw(8) << ratio << endl;
+	}
+
+	return (EXIT_SUCCESS);
+}
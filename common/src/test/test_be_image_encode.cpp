@@ -0,0 +1,468 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+/*
+ * Round-trip synthetic images through each encoder and its decoder.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#include <be_error_exception.h>
+#include <be_image_jpeg.h>
+#include <be_image_jpeg2000.h>
+#include <be_image_png.h>
+#include <be_image_raw.h>
+#include <be_image_wsq.h>
+
+namespace BE = BiometricEvaluation;
+using namespace std;
+
+static const BE::Image::Size Dimensions(300, 200);
+static const BE::Image::Resolution Resolution(500, 500,
+    BE::Image::Resolution::Units::PPI);
+/** Lowest acceptable quality of lossy round trips, in dB */
+static const double MIN_PSNR = 30.0;
+
+/**
+ * @brief
+ * Create a synthetic image: ridge-like waves with a little texture.
+ * @details
+ * WSQ quantizes poorly when subbands have no variance, so the image
+ * is not perfectly smooth.
+ *
+ * @param channels
+ *	Samples per pixel.
+ * @param bitDepth
+ *	Bits per sample, 8 or 16.
+ * @param hasAlphaChannel
+ *	Whether the last sample of each pixel is alpha.
+ *
+ * @return
+ *	The image.
+ */
+static BE::Image::Raw
+makeImage(
+    uint32_t channels,
+    uint16_t bitDepth,
+    bool hasAlphaChannel)
+{
+	const uint32_t bytesPerSample = bitDepth / 8;
+	BE::Memory::uint8Array data(Dimensions.xSize * Dimensions.ySize *
+	    channels * bytesPerSample);
+	uint64_t offset = 0;
+	for (uint32_t y = 0; y < Dimensions.ySize; y++) {
+		for (uint32_t x = 0; x < Dimensions.xSize; x++) {
+			for (uint32_t c = 0; c < channels; c++) {
+				const uint8_t value = static_cast<uint8_t>(
+				    128 + (60 * std::sin((x / 3.0) +
+				    (y / 7.0) + c) * std::cos(y / 4.0)) +
+				    (((x * 7) + (y * 13)) % 9));
+				if (bitDepth == 8) {
+					data[offset++] = value;
+				} else {
+					const uint16_t sample = (value * 256) +
+					    ((x + y) % 256);
+					std::memcpy(&data[offset], &sample, 2);
+					offset += 2;
+				}
+			}
+		}
+	}
+
+	return (BE::Image::Raw(data, Dimensions, channels * bitDepth,
+	    bitDepth, Resolution, hasAlphaChannel));
+}
+
+/** @return Peak signal to noise ratio of two sets of 8-bit samples */
+static double
+psnr(
+    const BE::Memory::uint8Array &expected,
+    const BE::Memory::uint8Array &actual)
+{
+	if ((expected.size() != actual.size()) || (expected.size() == 0))
+		return (0);
+
+	double squaredError = 0;
+	for (uint64_t i = 0; i < expected.size(); i++) {
+		const double difference = static_cast<double>(expected[i]) -
+		    actual[i];
+		squaredError += difference * difference;
+	}
+	if (squaredError == 0)
+		return (INFINITY);
+	return (10 * std::log10((255.0 * 255.0) /
+	    (squaredError / expected.size())));
+}
+
+/** @return Whether two arrays have the same contents */
+static bool
+sameData(
+    const BE::Memory::uint8Array &lhs,
+    const BE::Memory::uint8Array &rhs)
+{
+	return ((lhs.size() == rhs.size()) &&
+	    (std::memcmp(lhs, rhs, lhs.size()) == 0));
+}
+
+/** @return Whether two resolutions are within a pixel per inch */
+static bool
+sameResolution(
+    const BE::Image::Resolution &lhs,
+    const BE::Image::Resolution &rhs)
+{
+	const auto lhsPPI = lhs.toUnits(BE::Image::Resolution::Units::PPI);
+	const auto rhsPPI = rhs.toUnits(BE::Image::Resolution::Units::PPI);
+	return ((std::fabs(lhsPPI.xRes - rhsPPI.xRes) < 1) &&
+	    (std::fabs(lhsPPI.yRes - rhsPPI.yRes) < 1));
+}
+
+/**
+ * @brief
+ * Run one test, printing its name and result.
+ *
+ * @param name
+ *	Description of the test.
+ * @param test
+ *	The test, returning a reason for failure or an empty string.
+ *
+ * @return
+ *	Whether the test passed.
+ */
+static bool
+runTest(
+    const std::string &name,
+    const std::function<std::string()> &test)
+{
+	cout << name << "... ";
+	std::string failure;
+	try {
+		failure = test();
+	} catch (const BE::Error::Exception &e) {
+		failure = "caught " + e.whatString();
+	}
+	if (failure.empty())
+		cout << "passed" << endl;
+	else
+		cout << "failed (" << failure << ")" << endl;
+	return (failure.empty());
+}
+
+/**
+ * @return
+ *	Reason decoded differs from original in dimensions, depth, or
+ *	alpha channel, or an empty string.
+ */
+static std::string
+compareProperties(
+    const BE::Image::Image &original,
+    const BE::Image::Image &decoded)
+{
+	if (!(decoded.getDimensions() == original.getDimensions()))
+		return ("dimensions differ");
+	if (decoded.getColorDepth() != original.getColorDepth())
+		return ("color depth differs");
+	if (decoded.getBitDepth() != original.getBitDepth())
+		return ("bit depth differs");
+	if (decoded.hasAlphaChannel() != original.hasAlphaChannel())
+		return ("alpha channel differs");
+	return ("");
+}
+
+static bool
+testPNG()
+{
+	bool success = true;
+	const struct { uint32_t channels; uint16_t bitDepth; bool alpha; }
+	    kinds[] = {{1, 8, false}, {1, 16, false}, {2, 8, true},
+	    {3, 8, false}, {4, 8, true}, {3, 16, false}};
+	for (const auto &kind : kinds) {
+		const auto original = makeImage(kind.channels, kind.bitDepth,
+		    kind.alpha);
+		for (const auto filter : {BE::Image::PNG::Filter::None,
+		    BE::Image::PNG::Filter::Paeth,
+		    BE::Image::PNG::Filter::Adaptive}) {
+			for (const uint8_t level : {0, 1, 9}) {
+				success = runTest("PNG round trip (" +
+				    std::to_string(original.getColorDepth()) +
+				    "-bit, level " + std::to_string(level) +
+				    ", filter " + std::to_string(
+				    static_cast<int>(filter)) + ")", [&]() {
+					BE::Image::PNG::EncodeOptions options;
+					options.compressionLevel = level;
+					options.filter = filter;
+					const auto encoded =
+					    BE::Image::PNG::encode(original,
+					    options);
+					if (!BE::Image::PNG::isPNG(encoded,
+					    encoded.size()))
+						return (std::string("not PNG"));
+					BE::Image::PNG decoded(encoded);
+					const auto diff = compareProperties(
+					    original, decoded);
+					if (!diff.empty())
+						return (diff);
+					if (!sameResolution(
+					    decoded.getResolution(),
+					    original.getResolution()))
+						return (std::string(
+						    "resolution differs"));
+					if (!sameData(decoded.getRawData(),
+					    original.getRawData()))
+						return (std::string(
+						    "samples differ"));
+					return (std::string());
+				}) && success;
+			}
+		}
+	}
+
+	success = runTest("PNG rejects invalid compression level", [&]() {
+		BE::Image::PNG::EncodeOptions options;
+		options.compressionLevel = 10;
+		try {
+			BE::Image::PNG::encode(makeImage(1, 8, false),
+			    options);
+		} catch (const BE::Error::ParameterError&) {
+			return (std::string());
+		}
+		return (std::string("encoded"));
+	}) && success;
+
+	return (success);
+}
+
+static bool
+testJPEG()
+{
+	bool success = true;
+	const struct { uint32_t channels; bool alpha; } kinds[] = {
+	    {1, false}, {3, false}, {4, true}};
+	for (const auto &kind : kinds) {
+		const auto original = makeImage(kind.channels, 8, kind.alpha);
+		for (const auto method : {BE::Image::JPEG::DCTMethod::Integer,
+		    BE::Image::JPEG::DCTMethod::FastInteger,
+		    BE::Image::JPEG::DCTMethod::Float}) {
+			for (const bool progressive : {false, true}) {
+				success = runTest("JPEG round trip (" +
+				    std::to_string(original.getColorDepth()) +
+				    "-bit, DCT " + std::to_string(
+				    static_cast<int>(method)) +
+				    (progressive ? ", progressive" : "") + ")",
+				    [&]() {
+					BE::Image::JPEG::EncodeOptions options;
+					options.quality = 90;
+					options.dctMethod = method;
+					options.progressive = progressive;
+					options.optimizeCoding = progressive;
+					const auto encoded =
+					    BE::Image::JPEG::encode(original,
+					    options);
+					if (!BE::Image::JPEG::isJPEG(encoded,
+					    encoded.size()))
+						return (std::string(
+						    "not JPEG"));
+					BE::Image::JPEG decoded(encoded);
+
+					/* Alpha channels are discarded */
+					const uint32_t channels =
+					    kind.channels - (kind.alpha ? 1 :
+					    0);
+					if (!(decoded.getDimensions() ==
+					    original.getDimensions()) ||
+					    (decoded.getColorDepth() !=
+					    (channels * 8)))
+						return (std::string(
+						    "properties differ"));
+					if (!sameResolution(
+					    decoded.getResolution(),
+					    original.getResolution()))
+						return (std::string(
+						    "resolution differs"));
+					const BE::Image::Image &image =
+					    original;
+					const double quality = psnr(
+					    image.getRawData(true),
+					    decoded.getRawData());
+					if (quality < MIN_PSNR)
+						return ("PSNR " +
+						    std::to_string(quality));
+					return (std::string());
+				}) && success;
+			}
+		}
+	}
+
+	success = runTest("JPEG rejects 16-bit samples", [&]() {
+		try {
+			BE::Image::JPEG::encode(makeImage(1, 16, false));
+		} catch (const BE::Error::ParameterError&) {
+			return (std::string());
+		}
+		return (std::string("encoded"));
+	}) && success;
+
+	success = runTest("JPEG rejects invalid quality", [&]() {
+		BE::Image::JPEG::EncodeOptions options;
+		options.quality = 0;
+		try {
+			BE::Image::JPEG::encode(makeImage(1, 8, false),
+			    options);
+		} catch (const BE::Error::ParameterError&) {
+			return (std::string());
+		}
+		return (std::string("encoded"));
+	}) && success;
+
+	return (success);
+}
+
+static bool
+testJPEG2000()
+{
+	using JPEG2000 = BE::Image::JPEG2000;
+
+	bool success = true;
+	const struct { uint32_t channels; uint16_t bitDepth; bool alpha; }
+	    kinds[] = {{1, 8, false}, {1, 16, false}, {3, 8, false},
+	    {4, 8, true}};
+	for (const auto &kind : kinds) {
+		const auto original = makeImage(kind.channels, kind.bitDepth,
+		    kind.alpha);
+		for (const int8_t format : {JPEG2000::CODEC_J2K,
+		    JPEG2000::CODEC_JP2}) {
+			success = runTest("JPEG-2000 lossless round trip (" +
+			    std::to_string(original.getColorDepth()) +
+			    "-bit, " + (format == JPEG2000::CODEC_J2K ?
+			    "J2K" : "JP2") + ")",
+			    [&]() {
+				BE::Image::JPEG2000::EncodeOptions options;
+				options.codecFormat = format;
+				const auto encoded =
+				    BE::Image::JPEG2000::encode(original,
+				    options);
+				BE::Image::JPEG2000 decoded(encoded,
+				    encoded.size(), format);
+				/* Raw codestreams have no CDEF box */
+				if ((format == 2) || !kind.alpha) {
+					const auto diff = compareProperties(
+					    original, decoded);
+					if (!diff.empty())
+						return (diff);
+				}
+				if (!sameData(decoded.getRawData(),
+				    original.getRawData()))
+					return (std::string("samples differ"));
+				return (std::string());
+			}) && success;
+		}
+	}
+
+	success = runTest("JPEG-2000 lossy round trip (10:1)", [&]() {
+		const auto original = makeImage(3, 8, false);
+		BE::Image::JPEG2000::EncodeOptions options;
+		options.compressionRatio = 10;
+		const auto encoded = BE::Image::JPEG2000::encode(original,
+		    options);
+		if (encoded.size() > ((original.getRawData().size() / 10) +
+		    1024))
+			return ("encoded " + std::to_string(encoded.size()) +
+			    " bytes");
+		BE::Image::JPEG2000 decoded(encoded);
+		const double quality = psnr(original.getRawData(),
+		    decoded.getRawData());
+		if (quality < MIN_PSNR)
+			return ("PSNR " + std::to_string(quality));
+		return (std::string());
+	}) && success;
+
+	success = runTest("JPEG-2000 output independent of threads", [&]() {
+		const auto original = makeImage(3, 8, false);
+		BE::Image::JPEG2000::EncodeOptions options;
+		options.threads = 1;
+		const auto serial = BE::Image::JPEG2000::encode(original,
+		    options);
+		options.threads = 4;
+		if (!sameData(serial, BE::Image::JPEG2000::encode(original,
+		    options)))
+			return (std::string("encodings differ"));
+		return (std::string());
+	}) && success;
+
+	return (success);
+}
+
+static bool
+testWSQ()
+{
+	bool success = true;
+	success = runTest("WSQ round trip (2.25 bpp)", [&]() {
+		const auto original = makeImage(1, 8, false);
+		BE::Image::WSQ::EncodeOptions options;
+		options.bitRate = 2.25;
+		const auto encoded = BE::Image::WSQ::encode(original, options);
+		if (!BE::Image::WSQ::isWSQ(encoded, encoded.size()))
+			return (std::string("not WSQ"));
+		BE::Image::WSQ decoded(encoded);
+		const auto diff = compareProperties(original, decoded);
+		if (!diff.empty())
+			return (diff);
+		if (!sameResolution(decoded.getResolution(),
+		    original.getResolution()))
+			return (std::string("resolution differs"));
+		const double quality = psnr(original.getRawData(),
+		    decoded.getRawData());
+		if (quality < MIN_PSNR)
+			return ("PSNR " + std::to_string(quality));
+		return (std::string());
+	}) && success;
+
+	success = runTest("WSQ smaller at lower bit rate", [&]() {
+		const auto original = makeImage(1, 8, false);
+		BE::Image::WSQ::EncodeOptions options;
+		options.bitRate = 2.25;
+		const auto large = BE::Image::WSQ::encode(original, options);
+		options.bitRate = 0.75;
+		const auto small = BE::Image::WSQ::encode(original, options);
+		if (small.size() >= large.size())
+			return (std::string("sizes ") +
+			    std::to_string(small.size()) + " >= " +
+			    std::to_string(large.size()));
+		return (std::string());
+	}) && success;
+
+	success = runTest("WSQ converts color to grayscale", [&]() {
+		const auto original = makeImage(3, 8, false);
+		BE::Image::WSQ decoded(BE::Image::WSQ::encode(original));
+		if ((decoded.getColorDepth() != 8) ||
+		    !(decoded.getDimensions() == original.getDimensions()))
+			return (std::string("properties differ"));
+		return (std::string());
+	}) && success;
+
+	return (success);
+}
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+	bool success = testPNG();
+	success = testJPEG() && success;
+	success = testJPEG2000() && success;
+	success = testWSQ() && success;
+
+	return (success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
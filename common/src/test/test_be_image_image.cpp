@@ -8,12 +8,16 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <map>
 #include <sstream>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include <be_image_image.h>
 #include <be_io_properties.h>
@@ -52,6 +56,8 @@ static const std::string imageType = "PNG";
 #include <be_image_wsq.h>
 static const std::string imageType = "WSQ";
 #elif defined TIFFTEST
+#include <tiffio.h>
+
 #include <be_image_tiff.h>
 static const std::string imageType = "TIFF";
 #elif defined FACTORYTEST
@@ -90,6 +96,337 @@ stringToResUnits(
 }
 #endif
 
+#if defined TIFFTEST
+/** Arrangement of a TIFF written by testTIFFLayouts() */
+struct TIFFLayout
+{
+	std::string name;
+	uint32_t width;
+	uint32_t height;
+	uint16_t bitsPerSample;
+	uint16_t samplesPerPixel;
+	/** Rows in each strip, or 0 if tiled */
+	uint32_t rowsPerStrip;
+	/** Width and length of each tile, if tiled */
+	uint32_t tileSize;
+	uint16_t compression;
+	/** "wl" for little-endian or "wb" for big-endian */
+	std::string mode;
+};
+
+/**
+ * @brief
+ * Create raw data whose samples all differ from their neighbors.
+ * @details
+ * 16-bit samples are in host byte order, with high and low bytes that
+ * differ, so that swapped bytes are noticed.
+ */
+static Memory::uint8Array
+makeTIFFSamples(
+    const TIFFLayout &layout)
+{
+	const uint64_t samples = static_cast<uint64_t>(layout.width) *
+	    layout.height * layout.samplesPerPixel;
+	Memory::uint8Array raw(samples * (layout.bitsPerSample / 8));
+	for (uint64_t i = 0; i < samples; i++) {
+		const uint16_t value = static_cast<uint16_t>(
+		    (i * 40503) + 0x0102);
+		if (layout.bitsPerSample == 16)
+			std::memcpy(&raw[i * 2], &value, sizeof(value));
+		else
+			raw[i] = static_cast<uint8_t>(value ^ (value >> 8));
+	}
+	return (raw);
+}
+
+/**
+ * @brief
+ * Encode raw data as a TIFF with libtiff.
+ *
+ * @param layout
+ *	Arrangement of the TIFF.
+ * @param raw
+ *	Samples from makeTIFFSamples().
+ *
+ * @return
+ *	Encoded TIFF.
+ */
+static Memory::uint8Array
+writeTIFF(
+    const TIFFLayout &layout,
+    const Memory::uint8Array &raw)
+{
+	const std::string path{"test_be_image_tiff_layout.tif"};
+	::TIFF *tiff = TIFFOpen(path.c_str(), layout.mode.c_str());
+	if (tiff == nullptr)
+		throw Error::FileError("Could not open " + path);
+
+	TIFFSetField(tiff, TIFFTAG_IMAGEWIDTH, layout.width);
+	TIFFSetField(tiff, TIFFTAG_IMAGELENGTH, layout.height);
+	TIFFSetField(tiff, TIFFTAG_BITSPERSAMPLE, layout.bitsPerSample);
+	TIFFSetField(tiff, TIFFTAG_SAMPLESPERPIXEL, layout.samplesPerPixel);
+	TIFFSetField(tiff, TIFFTAG_PHOTOMETRIC, (layout.samplesPerPixel < 3 ?
+	    PHOTOMETRIC_MINISBLACK : PHOTOMETRIC_RGB));
+	TIFFSetField(tiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+	TIFFSetField(tiff, TIFFTAG_COMPRESSION, layout.compression);
+	if (layout.samplesPerPixel == 4) {
+		const uint16_t extraSamples[] = {EXTRASAMPLE_UNASSALPHA};
+		TIFFSetField(tiff, TIFFTAG_EXTRASAMPLES, 1, extraSamples);
+	}
+
+	const uint64_t pixelSize = layout.samplesPerPixel *
+	    (layout.bitsPerSample / 8);
+	const uint64_t rowSize = layout.width * pixelSize;
+	/* libtiff may swap the bytes of the buffers it writes */
+	bool written = true;
+	if (layout.rowsPerStrip != 0) {
+		TIFFSetField(tiff, TIFFTAG_ROWSPERSTRIP, layout.rowsPerStrip);
+		Memory::uint8Array strip;
+		for (uint32_t row = 0; row < layout.height;
+		    row += layout.rowsPerStrip) {
+			const uint32_t rows = std::min(layout.rowsPerStrip,
+			    layout.height - row);
+			strip.copy(&raw[row * rowSize], rows * rowSize);
+			written = written && (TIFFWriteEncodedStrip(tiff,
+			    row / layout.rowsPerStrip, strip,
+			    strip.size()) != -1);
+		}
+	} else {
+		TIFFSetField(tiff, TIFFTAG_TILEWIDTH, layout.tileSize);
+		TIFFSetField(tiff, TIFFTAG_TILELENGTH, layout.tileSize);
+		const uint64_t tileRowSize = layout.tileSize * pixelSize;
+		Memory::uint8Array tile(tileRowSize * layout.tileSize);
+		for (uint32_t y = 0; y < layout.height; y += layout.tileSize) {
+			for (uint32_t x = 0; x < layout.width;
+			    x += layout.tileSize) {
+				/* Pad tiles on the right and bottom edges */
+				std::fill(tile.begin(), tile.end(), 0);
+				const uint32_t columns = std::min(
+				    layout.tileSize, layout.width - x);
+				const uint32_t rows = std::min(layout.tileSize,
+				    layout.height - y);
+				for (uint32_t row = 0; row < rows; row++)
+					std::memcpy(&tile[row * tileRowSize],
+					    &raw[((y + row) * rowSize) +
+					    (x * pixelSize)],
+					    columns * pixelSize);
+				written = written && (TIFFWriteEncodedTile(
+				    tiff, TIFFComputeTile(tiff, x, y, 0, 0),
+				    tile, tile.size()) != -1);
+			}
+		}
+	}
+	TIFFClose(tiff);
+
+	Memory::uint8Array encoded;
+	if (written)
+		encoded = IO::Utility::readFile(path);
+	std::remove(path.c_str());
+	if (!written)
+		throw Error::StrategyError("Could not write " + layout.name);
+	return (encoded);
+}
+
+/**
+ * @brief
+ * Decode TIFFs of each layout handled natively, and compare the raw
+ * data with the samples encoded.
+ *
+ * @return
+ *	true if every layout decoded to its samples, false otherwise.
+ */
+static bool
+testTIFFLayouts()
+{
+	/* The last two are large enough to be decoded by several threads */
+	const std::vector<TIFFLayout> layouts{
+	    {"8-bit gray, one strip", 37, 23, 8, 1, 23, 0,
+	    COMPRESSION_NONE, "wl"},
+	    {"8-bit gray, LZW strips", 37, 23, 8, 1, 5, 0,
+	    COMPRESSION_LZW, "wb"},
+	    {"16-bit gray, little-endian", 31, 17, 16, 1, 4, 0,
+	    COMPRESSION_NONE, "wl"},
+	    {"16-bit gray, big-endian", 31, 17, 16, 1, 4, 0,
+	    COMPRESSION_NONE, "wb"},
+	    {"8-bit RGB", 29, 19, 8, 3, 3, 0, COMPRESSION_NONE, "wl"},
+	    {"8-bit RGBA", 29, 19, 8, 4, 7, 0, COMPRESSION_LZW, "wb"},
+	    {"16-bit RGB, tiled", 70, 45, 16, 3, 0, 16,
+	    COMPRESSION_LZW, "wb"},
+	    {"16-bit RGB, strips, threaded", 1024, 768, 16, 3, 16, 0,
+	    COMPRESSION_LZW, "wb"},
+	    {"8-bit RGBA, tiled, threaded", 1100, 1000, 8, 4, 0, 64,
+	    COMPRESSION_NONE, "wl"}};
+
+	bool success = true;
+	for (const auto &layout : layouts) {
+		cout << "Decode " << layout.name << " TIFF... ";
+		try {
+			const Memory::uint8Array raw = makeTIFFSamples(layout);
+			const Image::TIFF image(writeTIFF(layout, raw));
+			if ((image.getDimensions().xSize != layout.width) ||
+			    (image.getDimensions().ySize != layout.height) ||
+			    (image.getBitDepth() != layout.bitsPerSample) ||
+			    (image.getColorDepth() != layout.bitsPerSample *
+			    layout.samplesPerPixel) ||
+			    (image.hasAlphaChannel() !=
+			    (layout.samplesPerPixel == 4))) {
+				cout << "failed (properties)" << endl;
+				success = false;
+				continue;
+			}
+			const Memory::uint8Array decoded = image.getRawData();
+			if ((decoded.size() != raw.size()) ||
+			    !std::equal(raw.begin(), raw.end(),
+			    decoded.begin())) {
+				cout << "failed (samples)" << endl;
+				success = false;
+				continue;
+			}
+		} catch (const Error::Exception &e) {
+			cout << "failed (" << e.whatString() << ")" << endl;
+			success = false;
+			continue;
+		}
+		cout << "passed" << endl;
+	}
+	return (success);
+}
+#endif
+
+#if defined BMPTEST
+/**
+ * @brief
+ * Build a BITMAPINFOHEADER BMP around pixel data.
+ *
+ * @param width
+ *	Width of the image.
+ * @param height
+ *	Height of the image, negative if rows are stored top to bottom.
+ * @param bitsPerPixel
+ *	Bits per pixel.
+ * @param compression
+ *	Compression method.
+ * @param pixels
+ *	Stored pixel data, including row padding.
+ *
+ * @return
+ *	Encoded BMP, with an empty color table for 8-bit images.
+ */
+static Memory::uint8Array
+makeBMP(
+    int32_t width,
+    int32_t height,
+    uint16_t bitsPerPixel,
+    uint32_t compression,
+    const std::vector<uint8_t> &pixels)
+{
+	const uint32_t colorTableSize = (bitsPerPixel == 8 ? 256 * 4 : 0);
+	const uint32_t startingAddress = 14 + 40 + colorTableSize;
+	std::vector<uint8_t> bmp;
+	const auto put = [&](uint32_t value, int bytes) {
+		for (int i = 0; i < bytes; i++)
+			bmp.push_back(static_cast<uint8_t>(value >> (8 * i)));
+	};
+
+	bmp.push_back('B');
+	bmp.push_back('M');
+	put(startingAddress + pixels.size(), 4);
+	put(0, 4);
+	put(startingAddress, 4);
+
+	put(40, 4);
+	put(static_cast<uint32_t>(width), 4);
+	put(static_cast<uint32_t>(height), 4);
+	put(1, 2);
+	put(bitsPerPixel, 2);
+	put(compression, 4);
+	put(pixels.size(), 4);
+	put(2835, 4);
+	put(2835, 4);
+	put(0, 4);
+	put(0, 4);
+
+	bmp.resize(startingAddress, 0);
+	bmp.insert(bmp.end(), pixels.begin(), pixels.end());
+
+	Memory::uint8Array encoded(bmp.size());
+	std::copy(bmp.begin(), bmp.end(), encoded.begin());
+	return (encoded);
+}
+
+/**
+ * @brief
+ * Decode small BMPs whose rows need padding or whose RLE8 data has
+ * odd-length absolute runs, and compare the raw data with the pixels
+ * encoded.
+ *
+ * @return
+ *	true if every BMP decoded to its pixels, false otherwise.
+ */
+static bool
+testBMPLayouts()
+{
+	struct BMPCase
+	{
+		std::string name;
+		int32_t width;
+		int32_t height;
+		uint16_t bitsPerPixel;
+		uint32_t compression;
+		/* Stored pixel data */
+		std::vector<uint8_t> pixels;
+		/* Raw data, top row first */
+		std::vector<uint8_t> raw;
+	};
+
+	const std::vector<BMPCase> cases{
+	    /* 15 bytes per row, stored in 16 */
+	    {"24-bit, width 5", 5, 2, 24, Image::BI_RGB,
+	    {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0,
+	    21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 0},
+	    {23, 22, 21, 26, 25, 24, 29, 28, 27, 32, 31, 30, 35, 34, 33,
+	    3, 2, 1, 6, 5, 4, 9, 8, 7, 12, 11, 10, 15, 14, 13}},
+	    /* 7 bytes per row, stored in 8 */
+	    {"8-bit, width 7", 7, 3, 8, Image::BI_RGB,
+	    {1, 2, 3, 4, 5, 6, 7, 0, 11, 12, 13, 14, 15, 16, 17, 0,
+	    21, 22, 23, 24, 25, 26, 27, 0},
+	    {21, 22, 23, 24, 25, 26, 27, 11, 12, 13, 14, 15, 16, 17,
+	    1, 2, 3, 4, 5, 6, 7}},
+	    {"8-bit, width 7, top to bottom", 7, -2, 8, Image::BI_RGB,
+	    {1, 2, 3, 4, 5, 6, 7, 0, 11, 12, 13, 14, 15, 16, 17, 0},
+	    {1, 2, 3, 4, 5, 6, 7, 11, 12, 13, 14, 15, 16, 17}},
+	    /* Absolute runs of 3 and 5 pixels are padded to even lengths */
+	    {"RLE8, odd absolute runs", 8, 2, 8, Image::BI_RLE8,
+	    {0, 3, 10, 11, 12, 0, 5, 20, 0, 0,
+	    0, 5, 40, 41, 42, 43, 44, 0, 3, 30, 0, 0, 0, 1},
+	    {40, 41, 42, 43, 44, 30, 30, 30, 10, 11, 12, 20, 20, 20, 20,
+	    20}}};
+
+	bool success = true;
+	for (const auto &c : cases) {
+		cout << "Decode " << c.name << " BMP... ";
+		try {
+			const Image::BMP image(makeBMP(c.width, c.height,
+			    c.bitsPerPixel, c.compression, c.pixels));
+			const Memory::uint8Array decoded = image.getRawData();
+			if ((decoded.size() != c.raw.size()) ||
+			    !std::equal(c.raw.begin(), c.raw.end(),
+			    decoded.begin())) {
+				cout << "failed (pixels)" << endl;
+				success = false;
+				continue;
+			}
+		} catch (const Error::Exception &e) {
+			cout << "failed (" << e.whatString() << ")" << endl;
+			success = false;
+			continue;
+		}
+		cout << "passed" << endl;
+	}
+	return (success);
+}
+#endif
+
 /**
  * @brief
  * Convert Image::Resolution::Kind enumerations to a string.
@@ -305,6 +642,14 @@ main(
 	extensions["wsq"] = "WSQ";
 	extensions["tif"] = "TIFF";
 
+#if defined TIFFTEST
+	if (!testTIFFLayouts())
+		return (EXIT_FAILURE);
+#elif defined BMPTEST
+	if (!testBMPLayouts())
+		return (EXIT_FAILURE);
+#endif
+
 	/* Load images */
 	shared_ptr<IO::RecordStore> imageRS;
 	try {
@@ -0,0 +1,452 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <zlib.h>
+
+#include <be_error_exception.h>
+#include <be_io_gzip.h>
+#include <be_io_utility.h>
+#include <be_time_timer.h>
+
+using namespace std;
+namespace BE = BiometricEvaluation;
+
+/** Size of the latent-sized buffer used for benchmarking */
+static const uint64_t LARGE_SIZE = 20 * 1024 * 1024;
+/** Size of each of the record-sized buffers used for benchmarking */
+static const uint64_t SMALL_SIZE = 16 * 1024;
+/** Number of record-sized buffers */
+static const uint64_t SMALL_COUNT = 500;
+/** Chunk size used by GZip before single-allocation buffers */
+static const uint64_t LEGACY_CHUNK_SIZE = 16384;
+
+/** Image-like data: smooth gradients with some noise. */
+static BE::Memory::uint8Array
+makeData(
+    uint64_t size,
+    uint32_t seed)
+{
+	BE::Memory::uint8Array data(size);
+	for (uint64_t i = 0; i < size; i++) {
+		seed = (seed * 1103515245) + 12345;
+		data[i] = static_cast<uint8_t>(((i % 512) / 2) +
+		    ((seed >> 16) % 8));
+	}
+	return (data);
+}
+
+static bool
+equal(
+    const BE::Memory::uint8Array &lhs,
+    const BE::Memory::uint8Array &rhs)
+{
+	return ((lhs.size() == rhs.size()) && ((lhs.size() == 0) ||
+	    (std::memcmp(lhs, rhs, lhs.size()) == 0)));
+}
+
+/** Compress as GZip did before sizing output with deflateBound. */
+static BE::Memory::uint8Array
+legacyCompress(
+    const BE::Memory::uint8Array &data)
+{
+	z_stream strm;
+	strm.zalloc = Z_NULL;
+	strm.zfree = Z_NULL;
+	strm.opaque = Z_NULL;
+	if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+	    MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		throw BE::Error::StrategyError("deflateInit2");
+
+	const uint64_t chunk = LEGACY_CHUNK_SIZE;
+	BE::Memory::uint8Array out(chunk);
+	uint64_t remaining = data.size(), total = 0;
+	int flush;
+	do {
+		strm.next_in = (uint8_t *)(data + (data.size() - remaining));
+		strm.avail_in = std::min(chunk, remaining);
+		remaining -= strm.avail_in;
+		flush = (remaining == 0) ? Z_FINISH : Z_NO_FLUSH;
+		do {
+			while (out.size() < (total + chunk))
+				out.resize(chunk + (out.size() * 2));
+			strm.avail_out = chunk;
+			strm.next_out = out + total;
+			if (deflate(&strm, flush) == Z_STREAM_ERROR) {
+				deflateEnd(&strm);
+				throw BE::Error::StrategyError("deflate");
+			}
+			total += (chunk - strm.avail_out);
+		} while (strm.avail_out == 0);
+	} while (flush != Z_FINISH);
+	deflateEnd(&strm);
+	out.resize(total);
+	return (out);
+}
+
+/** Decompress as GZip did before sizing output from the trailer. */
+static BE::Memory::uint8Array
+legacyDecompress(
+    const BE::Memory::uint8Array &data)
+{
+	z_stream strm;
+	strm.zalloc = Z_NULL;
+	strm.zfree = Z_NULL;
+	strm.opaque = Z_NULL;
+	strm.avail_in = 0;
+	strm.next_in = Z_NULL;
+	if (inflateInit2(&strm, MAX_WBITS + 16) != Z_OK)
+		throw BE::Error::StrategyError("inflateInit2");
+
+	const uint64_t chunk = LEGACY_CHUNK_SIZE;
+	BE::Memory::uint8Array out(chunk);
+	uint64_t remaining = data.size(), total = 0;
+	int rv;
+	do {
+		strm.next_in = (uint8_t *)(data + (data.size() - remaining));
+		strm.avail_in = std::min(chunk, remaining);
+		remaining -= strm.avail_in;
+		do {
+			while (out.size() < (total + chunk))
+				out.resize(chunk + (out.size() * 2));
+			strm.avail_out = chunk;
+			strm.next_out = out + total;
+			rv = inflate(&strm, Z_NO_FLUSH);
+			if ((rv != Z_OK) && (rv != Z_STREAM_END)) {
+				inflateEnd(&strm);
+				throw BE::Error::StrategyError("inflate");
+			}
+			total += (chunk - strm.avail_out);
+		} while (strm.avail_out == 0);
+	} while (rv != Z_STREAM_END);
+	inflateEnd(&strm);
+	out.resize(total);
+	return (out);
+}
+
+static bool
+testRoundTrip()
+{
+	cout << "Compress and decompress buffers... ";
+	BE::IO::GZip gzip;
+	for (uint64_t size : {UINT64_C(0), UINT64_C(1), UINT64_C(100),
+	    UINT64_C(100000), UINT64_C(3000000)}) {
+		const BE::Memory::uint8Array data = makeData(size, size);
+		const BE::Memory::uint8Array compressed = gzip.compress(data);
+
+		/* Interoperable with each other and with chunked streams */
+		if (!equal(gzip.decompress(compressed), data) ||
+		    !equal(legacyDecompress(compressed), data) ||
+		    !equal(gzip.decompress(legacyCompress(data)), data)) {
+			cout << "failed (size " << size << ')' << endl;
+			return (false);
+		}
+
+		BE::Memory::uint8Array known(size);
+		gzip.decompress(compressed, compressed.size(), known,
+		    known.size());
+		if (!equal(known, data)) {
+			cout << "failed (known size " << size << ')' << endl;
+			return (false);
+		}
+	}
+	cout << "passed" << endl;
+	return (true);
+}
+
+static bool
+testWrongSize()
+{
+	cout << "Reject wrong sizes and truncated data... ";
+	BE::IO::GZip gzip;
+	const BE::Memory::uint8Array data = makeData(100000, 1);
+	const BE::Memory::uint8Array compressed = gzip.compress(data);
+
+	for (uint64_t size : {data.size() - 1, data.size() + 1,
+	    UINT64_C(0)}) {
+		BE::Memory::uint8Array out(size);
+		try {
+			gzip.decompress(compressed, compressed.size(), out,
+			    out.size());
+			cout << "failed (accepted size " << size << ')' << endl;
+			return (false);
+		} catch (const BE::Error::StrategyError&) {}
+	}
+
+	for (uint64_t size : {compressed.size() / 2, compressed.size() - 1}) {
+		try {
+			gzip.decompress(compressed, size);
+			cout << "failed (accepted truncation)" << endl;
+			return (false);
+		} catch (const BE::Error::StrategyError&) {}
+		BE::Memory::uint8Array out(data.size());
+		try {
+			gzip.decompress(compressed, size, out, out.size());
+			cout << "failed (accepted truncation)" << endl;
+			return (false);
+		} catch (const BE::Error::StrategyError&) {}
+	}
+
+	/* Streams reused after errors must still work */
+	if (!equal(gzip.decompress(compressed), data)) {
+		cout << "failed (after errors)" << endl;
+		return (false);
+	}
+	cout << "passed" << endl;
+	return (true);
+}
+
+static bool
+testOptionChange()
+{
+	cout << "Change options between calls... ";
+	BE::IO::GZip gzip;
+	const BE::Memory::uint8Array data = makeData(1000000, 2);
+
+	/* Level 0 stores data without compressing it */
+	gzip.setOption(BE::IO::GZip::COMPRESSION_LEVEL, 0);
+	const uint64_t storedSize = gzip.compress(data).size();
+	gzip.setOption(BE::IO::GZip::COMPRESSION_LEVEL, 9);
+	const BE::Memory::uint8Array best = gzip.compress(data);
+	if ((storedSize <= data.size()) || (best.size() >= data.size()) ||
+	    !equal(gzip.decompress(best), data)) {
+		cout << "failed (level not applied)" << endl;
+		return (false);
+	}
+
+	gzip.removeOption(BE::IO::GZip::COMPRESSION_LEVEL);
+	try {
+		gzip.compress(data);
+		cout << "failed (compressed without level)" << endl;
+		return (false);
+	} catch (const BE::Error::Exception&) {}
+	gzip.setOption(BE::IO::GZip::COMPRESSION_LEVEL, 9);
+	if (gzip.compress(data).size() != best.size()) {
+		cout << "failed (level not restored)" << endl;
+		return (false);
+	}
+	cout << "passed" << endl;
+	return (true);
+}
+
+static bool
+testConcurrent()
+{
+	cout << "Share one GZip between threads... ";
+	BE::IO::GZip gzip;
+	const BE::Memory::uint8Array data = makeData(200000, 3);
+	const BE::Memory::uint8Array compressed = gzip.compress(data);
+
+	std::vector<std::thread> threads;
+	std::vector<int> ok(4, 1);
+	for (unsigned int t = 0; t < ok.size(); t++) {
+		threads.emplace_back([&, t]() {
+			for (int i = 0; i < 25; i++) {
+				BE::Memory::uint8Array out(data.size());
+				gzip.decompress(compressed, compressed.size(),
+				    out, out.size());
+				if (!equal(out, data) || !equal(
+				    gzip.decompress(gzip.compress(data)), data))
+					ok[t] = 0;
+			}
+		});
+	}
+	for (auto &thread : threads)
+		thread.join();
+	if (std::find(ok.begin(), ok.end(), 0) != ok.end()) {
+		cout << "failed" << endl;
+		return (false);
+	}
+	cout << "passed" << endl;
+	return (true);
+}
+
+static bool
+testBlocks()
+{
+	cout << "Compress and decompress blocks... ";
+	BE::IO::GZip gzip;
+	gzip.setOption(BE::IO::GZip::BLOCK_SIZE, 64 * 1024);
+	const BE::Memory::uint8Array data = makeData(1000000, 5);
+	const BE::Memory::uint8Array compressed = gzip.compress(data);
+
+	/* Output does not depend on the number of threads */
+	gzip.setOption(BE::IO::GZip::THREAD_COUNT, 1);
+	if (!equal(gzip.compress(data), compressed)) {
+		cout << "failed (thread count changed output)" << endl;
+		return (false);
+	}
+	gzip.setOption(BE::IO::GZip::THREAD_COUNT, 4);
+
+	BE::Memory::uint8Array known(data.size());
+	gzip.decompress(compressed, compressed.size(), known, known.size());
+	if (!equal(gzip.decompress(compressed), data) ||
+	    !equal(known, data)) {
+		cout << "failed (round trip)" << endl;
+		return (false);
+	}
+
+	/* Blocks are gzip members, readable without the index */
+	const std::string path = "test_be_io_gzip.gz";
+	BE::IO::Utility::writeFile(compressed, path);
+	const BE::Memory::uint8Array fromFile = gzip.decompress(path);
+	std::remove(path.c_str());
+	if (!equal(fromFile, data)) {
+		cout << "failed (file)" << endl;
+		return (false);
+	}
+
+	/* A reader of one member sees one block, or everything if disabled */
+	BE::IO::GZip single;
+	single.setOption(BE::IO::GZip::BLOCK_SIZE, 0);
+	if ((legacyDecompress(compressed).size() != (64 * 1024)) ||
+	    !equal(legacyDecompress(single.compress(data)), data)) {
+		cout << "failed (block boundaries)" << endl;
+		return (false);
+	}
+
+	/* Corruption is detected in any block */
+	BE::Memory::uint8Array corrupt(compressed);
+	corrupt[corrupt.size() / 2] ^= 0xFF;
+	try {
+		gzip.decompress(corrupt);
+		cout << "failed (accepted corruption)" << endl;
+		return (false);
+	} catch (const BE::Error::StrategyError&) {}
+	try {
+		gzip.decompress(corrupt, corrupt.size(), known, known.size());
+		cout << "failed (accepted corruption)" << endl;
+		return (false);
+	} catch (const BE::Error::StrategyError&) {}
+	try {
+		gzip.decompress(compressed, compressed.size(), known,
+		    known.size() - 1);
+		cout << "failed (accepted wrong size)" << endl;
+		return (false);
+	} catch (const BE::Error::StrategyError&) {}
+
+	cout << "passed" << endl;
+	return (true);
+}
+
+/** Time the chunked, single-allocation, and block paths. */
+static bool
+benchmark()
+{
+	/* Compare the streaming paths; blocks are timed separately */
+	BE::IO::GZip gzip;
+	gzip.setOption(BE::IO::GZip::BLOCK_SIZE, 0);
+	BE::Time::Timer timer;
+
+	cout << "Benchmark (" << LARGE_SIZE / (1024 * 1024) << " MiB buffer, " <<
+	    SMALL_COUNT << " x " << SMALL_SIZE / 1024 << " KiB buffers):" <<
+	    endl;
+	const BE::Memory::uint8Array large = makeData(LARGE_SIZE, 4);
+	const BE::Memory::uint8Array compressedLarge = gzip.compress(large);
+	std::vector<BE::Memory::uint8Array> small, compressedSmall;
+	for (uint64_t i = 0; i < SMALL_COUNT; i++) {
+		small.push_back(makeData(SMALL_SIZE, i));
+		compressedSmall.push_back(gzip.compress(small.back()));
+	}
+
+	bool ok = true;
+	cout << "\tCompress large, chunked: " << timer.time([&]() {
+	    ok &= (legacyCompress(large).size() > 0); }).elapsedStr(true) <<
+	    endl;
+	cout << "\tCompress large, GZip: " << timer.time([&]() {
+	    ok &= (gzip.compress(large).size() > 0); }).elapsedStr(true) <<
+	    endl;
+	cout << "\tDecompress large, chunked: " << timer.time([&]() {
+	    ok &= equal(legacyDecompress(compressedLarge), large);
+	    }).elapsedStr(true) << endl;
+	cout << "\tDecompress large, GZip: " << timer.time([&]() {
+	    ok &= equal(gzip.decompress(compressedLarge), large);
+	    }).elapsedStr(true) << endl;
+	BE::Memory::uint8Array known(large.size());
+	cout << "\tDecompress large, GZip, known size: " << timer.time([&]() {
+	    gzip.decompress(compressedLarge, compressedLarge.size(), known,
+	    known.size()); }).elapsedStr(true) << endl;
+	ok &= equal(known, large);
+
+	cout << "\tCompress small, chunked: " << timer.time([&]() {
+	    for (const auto &data : small)
+	        ok &= (legacyCompress(data).size() > 0);
+	    }).elapsedStr(true) << endl;
+	cout << "\tCompress small, GZip: " << timer.time([&]() {
+	    for (const auto &data : small)
+	        ok &= (gzip.compress(data).size() > 0);
+	    }).elapsedStr(true) << endl;
+	cout << "\tDecompress small, chunked: " << timer.time([&]() {
+	    for (uint64_t i = 0; i < SMALL_COUNT; i++)
+	        ok &= equal(legacyDecompress(compressedSmall[i]), small[i]);
+	    }).elapsedStr(true) << endl;
+	BE::Memory::uint8Array out(SMALL_SIZE);
+	cout << "\tDecompress small, GZip, known size: " << timer.time([&]() {
+	    for (uint64_t i = 0; i < SMALL_COUNT; i++) {
+	        gzip.decompress(compressedSmall[i], compressedSmall[i].size(),
+	            out, out.size());
+	        ok &= equal(out, small[i]);
+	    }
+	    }).elapsedStr(true) << endl;
+
+	BE::IO::GZip blocks;
+	blocks.setOption(BE::IO::GZip::BLOCK_SIZE, 4 * 1024 * 1024);
+	blocks.setOption(BE::IO::GZip::THREAD_COUNT, 0);
+	const BE::Memory::uint8Array compressedBlocks = blocks.compress(large);
+	cout << "\tCompress large, GZip, " << std::thread::hardware_concurrency()
+	    << " cores, blocks: " << timer.time([&]() {
+	    ok &= (blocks.compress(large).size() > 0); }).elapsedStr(true) <<
+	    endl;
+	cout << "\tDecompress large, GZip, " <<
+	    std::thread::hardware_concurrency() << " cores, blocks: " <<
+	    timer.time([&]() {
+	    ok &= equal(blocks.decompress(compressedBlocks), large);
+	    }).elapsedStr(true) << endl;
+	cout << "\tCompressed size, single stream: " << compressedLarge.size() <<
+	    ", blocks: " << compressedBlocks.size() << endl;
+
+	if (!ok)
+		cout << "Benchmark results did not match input" << endl;
+	return (ok);
+}
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+	try {
+		if (!testRoundTrip())
+			return (EXIT_FAILURE);
+		if (!testWrongSize())
+			return (EXIT_FAILURE);
+		if (!testOptionChange())
+			return (EXIT_FAILURE);
+		if (!testConcurrent())
+			return (EXIT_FAILURE);
+		if (!testBlocks())
+			return (EXIT_FAILURE);
+		if (!benchmark())
+			return (EXIT_FAILURE);
+	} catch (const BE::Error::Exception &e) {
+		cout << "Caught " << e.whatString() << endl;
+		return (EXIT_FAILURE);
+	}
+
+	return (EXIT_SUCCESS);
+}
@@ -78,6 +78,17 @@ existingPRSTest(
 	auto result = prs->read("key0");
 	for (const auto &r : result)
 		std::cout << r.first << " = " << to_string(r.second) << '\n';
+	if (result.size() != numberOfRS)
+		throw BE::Error::StrategyError("Expected " +
+		    std::to_string(numberOfRS) + " values, read " +
+		    std::to_string(result.size()));
+
+	std::cout << "Reading missing key with tryRead()...";
+	if (prs->tryRead("nokey").size() != 0) {
+		std::cout << "FAIL" << std::endl;
+		throw BE::Error::StrategyError("Read data for missing key");
+	}
+	std::cout << "PASS" << std::endl;
 }
 
 void
@@ -98,6 +109,39 @@ newPRSTest(
 	for (const auto &r : result)
 		std::cout << r.first << " = " << to_string(r.second) << '\n';
 	std::cout << std::endl;
+
+	std::cout << "Checking for saved key filters...";
+	if (!BE::IO::Utility::fileExists(path + "/.rsukeyfilters")) {
+		std::cout << "FAIL" << std::endl;
+		throw BE::Error::StrategyError("Key filters were not saved");
+	}
+	std::cout << "PASS" << std::endl;
+}
+
+void
+modifiedPRSTest(
+    const std::string &path,
+    const std::vector<std::string> &rsNames)
+{
+	std::cout << "Replacing a key in a child without changing its "
+	    "count...\n";
+	{
+		auto rs = BE::IO::RecordStore::openRecordStore(rsNames[0],
+		    BE::IO::Mode::ReadWrite);
+		BE::Memory::uint8Array data;
+		BE::Memory::AutoArrayUtility::setString(data, "replaced");
+		rs->remove("key4");
+		rs->insert("newkey", data);
+	}
+
+	std::unique_ptr<BE::IO::PersistentRecordStoreUnion> prs(
+	    new BE::IO::PersistentRecordStoreUnion(path));
+	std::cout << "Reading \"newkey\" after reopening PRSU...";
+	if (prs->tryRead("newkey").size() != 1) {
+		std::cout << "FAIL" << std::endl;
+		throw BE::Error::StrategyError("Saved key filter was stale");
+	}
+	std::cout << "PASS" << std::endl;
 }
 
 int
@@ -113,6 +157,7 @@ main(
 		makeRecordStores(childNames);
 		newPRSTest(prsPath, childNames);
 		existingPRSTest(prsPath);
+		modifiedPRSTest(prsPath, childNames);
 	} catch (BE::Error::Exception &e) {
 		std::cout << e.whatString() << std::endl;
 		rv = EXIT_FAILURE;
@@ -0,0 +1,300 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <be_error_exception.h>
+#include <be_io_recordstore.h>
+#include <be_io_utility.h>
+
+using namespace std;
+namespace BE = BiometricEvaluation;
+
+static const std::string RSNAME{"test_be_io_recordstore-concurrent_rs"};
+/** Records in the store before the threads start */
+static const uint32_t INITIAL_RECORDS = 500;
+/** Records the writer inserts while the readers run */
+static const uint32_t WRITTEN_RECORDS = 500;
+/** Number of reader threads */
+static const uint32_t READER_COUNT = 4;
+
+/** @return Contents of the record with key */
+static std::string
+valueOf(
+    const std::string &key)
+{
+	return ("Value of " + key + std::string(key.size() * 10, '.'));
+}
+
+/** @return Whether record holds the value of its key */
+static bool
+recordIsValid(
+    const BE::IO::RecordStore::Record &record)
+{
+	const std::string expected = valueOf(record.key);
+	return ((record.data.size() == expected.size()) &&
+	    std::equal(expected.begin(), expected.end(), record.data.begin()));
+}
+
+/**
+ * @brief
+ * Run READER_COUNT reader threads and one writer thread on a Shared
+ * RecordStore.
+ *
+ * @param kind
+ *	Kind of RecordStore to test.
+ *
+ * @return
+ *	Whether every reader saw only valid records.
+ */
+static bool
+testReadersAndWriter(
+    const BE::IO::RecordStore::Kind &kind)
+{
+	cout << "N readers and 1 writer on " <<
+	    BE::Framework::Enumeration::to_string(kind) << "... ";
+	if (BE::IO::Utility::fileExists(RSNAME))
+		BE::IO::RecordStore::removeRecordStore(RSNAME);
+
+	std::shared_ptr<BE::IO::RecordStore> rs;
+	try {
+		rs = BE::IO::RecordStore::createRecordStore(RSNAME,
+		    "Concurrent test", kind,
+		    BE::IO::RecordStore::Concurrency::Shared);
+		for (uint32_t i = 0; i < INITIAL_RECORDS; i++) {
+			const std::string key = "initial" + std::to_string(i);
+			rs->insert(key, valueOf(key).data(),
+			    valueOf(key).size());
+		}
+	} catch (const BE::Error::Exception &e) {
+		cout << "failed (setup: " << e.whatString() << ")" << endl;
+		return (false);
+	}
+
+	std::atomic<bool> writing(true);
+	std::vector<char> valid(READER_COUNT, true);
+	std::vector<std::string> errors(READER_COUNT + 1);
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < READER_COUNT; t++) {
+		threads.emplace_back([&, t]() {
+			try {
+				do {
+					/* Each iterator has its own cursor */
+					uint32_t seen = 0;
+					for (const auto &record : *rs) {
+						if (!recordIsValid(record))
+							valid[t] = false;
+						seen++;
+					}
+					if (seen < INITIAL_RECORDS)
+						valid[t] = false;
+
+					const std::string key = "initial" +
+					    std::to_string(t);
+					if (rs->length(key) !=
+					    valueOf(key).size())
+						valid[t] = false;
+				} while (writing);
+			} catch (const BE::Error::Exception &e) {
+				errors[t] = e.whatString();
+				valid[t] = false;
+			}
+		});
+	}
+	threads.emplace_back([&]() {
+		try {
+			for (uint32_t i = 0; i < WRITTEN_RECORDS; i++) {
+				const std::string key = "written" +
+				    std::to_string(i);
+				rs->insert(key, valueOf(key).data(),
+				    valueOf(key).size());
+				if ((i % 10) == 0)
+					rs->remove(key);
+			}
+			rs->sync();
+		} catch (const BE::Error::Exception &e) {
+			errors[READER_COUNT] = e.whatString();
+		}
+		writing = false;
+	});
+	for (auto &thread : threads)
+		thread.join();
+
+	bool success = errors[READER_COUNT].empty();
+	for (uint32_t t = 0; t < READER_COUNT; t++)
+		success = success && valid[t];
+	const uint32_t expectedCount = INITIAL_RECORDS + WRITTEN_RECORDS -
+	    (WRITTEN_RECORDS / 10);
+	if (rs->getCount() != expectedCount)
+		success = false;
+
+	rs.reset();
+	BE::IO::RecordStore::removeRecordStore(RSNAME);
+	if (!success) {
+		cout << "failed";
+		for (const auto &error : errors)
+			if (!error.empty())
+				cout << " (" << error << ")";
+		cout << endl;
+		return (false);
+	}
+	cout << "passed" << endl;
+	return (true);
+}
+
+/**
+ * @brief
+ * Read from many threads that then exit, some after the RecordStore is
+ * destroyed.
+ *
+ * @return
+ *	Whether the read connections of exited threads were closed.
+ */
+static bool
+testExitingReaders()
+{
+	cout << "Close read connections of exited threads... ";
+	if (BE::IO::Utility::fileExists(RSNAME))
+		BE::IO::RecordStore::removeRecordStore(RSNAME);
+
+	const uint32_t threadCount = 100;
+	std::atomic<bool> success(true);
+	try {
+		auto rs = BE::IO::RecordStore::createRecordStore(RSNAME,
+		    "Concurrent test", BE::IO::RecordStore::Kind::SQLite,
+		    BE::IO::RecordStore::Concurrency::Shared);
+		const std::string key{"initial0"};
+		rs->insert(key, valueOf(key).data(), valueOf(key).size());
+		rs->sync();
+
+		/* All threads are alive at once, so none share an ID */
+		const int64_t memoryBefore = sqlite3_memory_used();
+		std::atomic<uint32_t> reading(threadCount);
+		std::vector<std::thread> threads;
+		for (uint32_t t = 0; t < threadCount; t++) {
+			threads.emplace_back([&]() {
+				try {
+					if (rs->length(key) !=
+					    valueOf(key).size())
+						success = false;
+				} catch (const BE::Error::Exception &) {
+					success = false;
+				}
+				reading--;
+				while (reading > 0)
+					std::this_thread::yield();
+			});
+		}
+		for (auto &thread : threads)
+			thread.join();
+		/* An open connection holds far more than this */
+		if ((sqlite3_memory_used() - memoryBefore) >
+		    static_cast<int64_t>(threadCount * 1024))
+			success = false;
+
+		/* Reader outlives the RecordStore */
+		std::atomic<bool> read(false), destroyed(false);
+		std::thread reader([&]() {
+			try {
+				rs->length(key);
+			} catch (const BE::Error::Exception &) {
+				success = false;
+			}
+			read = true;
+			while (!destroyed)
+				std::this_thread::yield();
+		});
+		while (!read)
+			std::this_thread::yield();
+		rs.reset();
+		destroyed = true;
+		reader.join();
+	} catch (const BE::Error::Exception &e) {
+		cout << "failed (" << e.whatString() << ")" << endl;
+		return (false);
+	}
+
+	BE::IO::RecordStore::removeRecordStore(RSNAME);
+	cout << (success ? "passed" : "failed") << endl;
+	return (success);
+}
+
+static bool
+testUnsupported()
+{
+	cout << "Reject sharing unsupported RecordStores... ";
+	if (BE::IO::Utility::fileExists(RSNAME))
+		BE::IO::RecordStore::removeRecordStore(RSNAME);
+	try {
+		BE::IO::RecordStore::createRecordStore(RSNAME,
+		    "Concurrent test", BE::IO::RecordStore::Kind::BerkeleyDB,
+		    BE::IO::RecordStore::Concurrency::Shared);
+		cout << "failed" << endl;
+		return (false);
+	} catch (const BE::Error::StrategyError&) {}
+
+	if (BE::IO::Utility::fileExists(RSNAME)) {
+		cout << "failed (created)" << endl;
+		return (false);
+	}
+
+	/* Sharded stores are shared when their shards can be */
+	try {
+		BE::IO::RecordStore::createRecordStore(RSNAME,
+		    "Concurrent test", BE::IO::RecordStore::Kind::Sharded,
+		    BE::IO::RecordStore::Concurrency::Shared);
+		cout << "failed (sharded)" << endl;
+		return (false);
+	} catch (const BE::Error::StrategyError&) {}
+	if (BE::IO::Utility::fileExists(RSNAME))
+		BE::IO::RecordStore::removeRecordStore(RSNAME);
+	BE::IO::RecordStore::createRecordStore(RSNAME, "Concurrent test",
+	    BE::IO::RecordStore::Kind::Sharded);
+	try {
+		BE::IO::RecordStore::openRecordStore(RSNAME,
+		    BE::IO::Mode::ReadOnly,
+		    BE::IO::RecordStore::Concurrency::Shared);
+		cout << "failed (open sharded)" << endl;
+		return (false);
+	} catch (const BE::Error::StrategyError&) {}
+	BE::IO::RecordStore::removeRecordStore(RSNAME);
+
+	cout << "passed" << endl;
+	return (true);
+}
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+	if (!testReadersAndWriter(BE::IO::RecordStore::Kind::Archive))
+		return (EXIT_FAILURE);
+	if (!testReadersAndWriter(BE::IO::RecordStore::Kind::File))
+		return (EXIT_FAILURE);
+	if (!testReadersAndWriter(BE::IO::RecordStore::Kind::SQLite))
+		return (EXIT_FAILURE);
+	if (!testExitingReaders())
+		return (EXIT_FAILURE);
+	if (!testUnsupported())
+		return (EXIT_FAILURE);
+
+	return (EXIT_SUCCESS);
+}
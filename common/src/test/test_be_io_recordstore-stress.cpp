@@ -22,6 +22,11 @@
 #endif
 
 #ifdef DBRECORDSTORETEST
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
 #include <be_io_dbrecstore.h>
 #define TESTDEFINED
 #endif
@@ -86,6 +91,120 @@ static int insertMany(IO::RecordStore *rs)
 	return (0);
 }
 
+#ifdef DBRECORDSTORETEST
+const int BULKCOUNT = 1000000;		/* Records to bulk load */
+const int BULKRECSIZE = 64;
+const int BULKBATCHSIZE = 10000;	/* Records per insertSorted() */
+const uint32_t BULKCACHESIZE = 32 * 1024 * 1024;
+const uint32_t BULKPAGESIZE = 8192;
+
+/*
+ * Compare loading the same records into identically tuned DBRecordStores
+ * in random order with insert() and in key order with insertSorted().
+ */
+static int
+compareBulkLoad()
+{
+	std::vector<int> order(BULKCOUNT);
+	std::iota(order.begin(), order.end(), 0);
+	std::shuffle(order.begin(), order.end(), std::mt19937(BULKCOUNT));
+	Memory::uint8Array theData(BULKRECSIZE);
+	const string randomName("dbrs_random"), sortedName("dbrs_sorted");
+
+	cout << "Loading " << BULKCOUNT << " records of size " <<
+	    BULKRECSIZE << " in random order." << endl;
+	try {
+		IO::DBRecordStore rs(randomName, "Random load", BULKCACHESIZE,
+		    BULKPAGESIZE);
+		totalTime = 0;
+		for (int i = 0; i < BULKCOUNT; i++) {
+			/* Zero-padded, so numeric and key order agree */
+			snprintf(keyName, KEYNAMESIZE, "key%07u", order[i]);
+			gettimeofday(&starttm, nullptr);
+			rs.insert(keyName, theData);
+			gettimeofday(&endtm, nullptr);
+			totalTime += TIMEINTERVAL(starttm, endtm);
+		}
+		gettimeofday(&starttm, nullptr);
+		rs.sync();
+		gettimeofday(&endtm, nullptr);
+		totalTime += TIMEINTERVAL(starttm, endtm);
+		cout << "Random insert lapsed time: " << totalTime << endl;
+		cout << "Space used is " << rs.getSpaceUsed() << endl;
+	} catch (Error::Exception &e) {
+		cout << "Could not load records: " << e.whatString() << endl;
+		return (-1);
+	}
+
+	cout << "Loading the same records in key order." << endl;
+	try {
+		IO::DBRecordStore rs(sortedName, "Sorted load", BULKCACHESIZE,
+		    BULKPAGESIZE);
+		std::vector<IO::RecordStore::Record> batch;
+		totalTime = 0;
+		for (int i = 0; i < BULKCOUNT; i += BULKBATCHSIZE) {
+			batch.clear();
+			for (int j = i; j < std::min(i + BULKBATCHSIZE,
+			    BULKCOUNT); j++) {
+				snprintf(keyName, KEYNAMESIZE, "key%07u", j);
+				batch.emplace_back(keyName, theData);
+			}
+			gettimeofday(&starttm, nullptr);
+			rs.insertSorted(batch);
+			gettimeofday(&endtm, nullptr);
+			totalTime += TIMEINTERVAL(starttm, endtm);
+		}
+		gettimeofday(&starttm, nullptr);
+		rs.sync();
+		gettimeofday(&endtm, nullptr);
+		totalTime += TIMEINTERVAL(starttm, endtm);
+		cout << "Sorted insert lapsed time: " << totalTime << endl;
+		cout << "Space used is " << rs.getSpaceUsed() << endl;
+		if (rs.getCount() != BULKCOUNT) {
+			cout << "Whoops! Count is " << rs.getCount() << endl;
+			return (-1);
+		}
+
+		/* Out-of-order batches must be rejected untouched */
+		batch.clear();
+		batch.emplace_back("key9999999", theData);
+		batch.emplace_back("key9999998", theData);
+		try {
+			rs.insertSorted(batch);
+			cout << "Whoops! Accepted keys out of order." << endl;
+			return (-1);
+		} catch (Error::ParameterError&) {}
+		if (rs.getCount() != BULKCOUNT) {
+			cout << "Whoops! Inserted keys out of order." << endl;
+			return (-1);
+		}
+
+		/* So must batches with an existing key */
+		batch.clear();
+		batch.emplace_back("key9999990", theData);
+		batch.emplace_back("key9999991", theData);
+		batch.emplace_back("key9999992", theData);
+		rs.insert(batch[1].key, theData, theData.size());
+		try {
+			rs.insertSorted(batch);
+			cout << "Whoops! Accepted an existing key." << endl;
+			return (-1);
+		} catch (Error::ObjectExists&) {}
+		if (rs.getCount() != BULKCOUNT + 1) {
+			cout << "Whoops! Inserted part of a batch." << endl;
+			return (-1);
+		}
+	} catch (Error::Exception &e) {
+		cout << "Could not load records: " << e.whatString() << endl;
+		return (-1);
+	}
+
+	IO::RecordStore::removeRecordStore(randomName);
+	IO::RecordStore::removeRecordStore(sortedName);
+	return (0);
+}
+#endif
+
 /*
  * Test the read and write operations of a RecordStore, hopefully stressing
  * it enough to gain confidence in its operation. This program should be
@@ -318,6 +437,11 @@ int main (int argc, char* argv[]) {
 	endStoreSize = ars->getSpaceUsed();
 	cout << "Space used after second insert is " << endStoreSize << endl;
 
+#ifdef DBRECORDSTORETEST
+	if (compareBulkLoad() != 0)
+		return (EXIT_FAILURE);
+#endif
+
 #endif
 	return(EXIT_SUCCESS);
 }
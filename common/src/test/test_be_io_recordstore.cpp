@@ -50,6 +50,12 @@
 #define TESTDEFINED
 #endif
 
+#ifdef SHARDEDRECORDSTORETEST
+#include <be_io_shardedrecstore.h>
+#include <be_io_utility.h>
+#define TESTDEFINED
+#endif
+
 #ifdef TESTDEFINED
 using namespace BiometricEvaluation;
 #endif
@@ -692,6 +698,22 @@ main(int argc, char* argv[]) {
 	}
 #endif
 
+#ifdef SHARDEDRECORDSTORETEST
+	/* Call the constructor that will create a new ShardedRecordStore. */
+	rsPath = "shardrs_test";
+	IO::ShardedRecordStore *rs;
+	try {
+		rs = new IO::ShardedRecordStore(rsPath, "ShardedRecordStore Test",
+		    IO::RecordStore::Kind::SQLite, 4);
+	} catch (Error::ObjectExists &e) {
+		cout << "The Sharded Record Store exists; exiting." << endl;
+		return (EXIT_FAILURE);
+	} catch (Error::StrategyError& e) {
+		cout << "A strategy error occurred: " << e.what() << endl;
+		return (EXIT_FAILURE);
+	}
+#endif
+
 #ifdef TESTDEFINED
 
 	cout << "Running tests with new record store:" << endl;
@@ -773,6 +795,20 @@ main(int argc, char* argv[]) {
 	}
 #endif
 
+#ifdef SHARDEDRECORDSTORETEST
+	/* Call the constructor that will open an existing ShardedRecordStore.*/
+	rsPath = "shardrs_test";
+	try {
+		rs = new IO::ShardedRecordStore(rsPath, IO::Mode::ReadWrite);
+	} catch (Error::ObjectDoesNotExist &e) {
+		cout << "The Sharded Record Store does not exist; exiting." << endl;
+		return (EXIT_FAILURE);
+	} catch (Error::StrategyError& e) {
+		cout << "A strategy error occurred: " << e.what() << endl;
+		return (EXIT_FAILURE);
+	}
+#endif
+
 #ifdef TESTDEFINED
 
 	cout << endl << "----------------------------------------" << endl << endl;
@@ -782,6 +818,20 @@ main(int argc, char* argv[]) {
 		return (EXIT_FAILURE);
 	}
 
+	/* A key other than the first, for a store not yet sequenced */
+	string cursorKey;
+	try {
+		rs->insert("cursorKey1", "1", 1);
+		rs->insert("cursorKey2", "2", 1);
+		rs->sync();
+		rs->sequenceKey(IO::RecordStore::BE_RECSTORE_SEQ_START);
+		cursorKey = rs->sequenceKey();
+	} catch (Error::Exception &e) {
+		cout << "Could not sequence: " << e.what() << endl;
+		delete rs;
+		return (EXIT_FAILURE);
+	}
+
 #ifdef ARCHIVERECORDSTORETEST
 	/*
 	 * Test vacuuming an ArchiveRecordStore
@@ -801,6 +851,71 @@ main(int argc, char* argv[]) {
 		cout << "failed:" << e.what() << "." << endl;
 	}
 #endif
+
+#ifdef COMPRESSEDRECORDSTORETEST
+	/*
+	 * Test compressing a CompressedRecordStore record as blocks
+	 */
+	cout << "Compressing a record as blocks on 2 threads... ";
+	try {
+		rs->setBlockCompression(64 * 1024, 2);
+		Memory::uint8Array large(1024 * 1024);
+		for (size_t i = 0; i < large.size(); i++)
+			large[i] = static_cast<uint8_t>((i / 7) ^ (i % 251));
+		rs->insert("blocks", large);
+		const Memory::uint8Array blocks = rs->read("blocks");
+		if ((blocks.size() != large.size()) ||
+		    (std::memcmp(blocks, large, large.size()) != 0))
+			throw Error::StrategyError("Record differs");
+		rs->remove("blocks");
+		rs->setBlockCompression(0, 1);
+		cout << "success." << endl;
+	} catch (Error::Exception &e) {
+		cout << "failed: " << e.whatString() << endl;
+		delete rs;
+		return (EXIT_FAILURE);
+	}
+#endif
+
+#ifdef SHARDEDRECORDSTORETEST
+	/*
+	 * Test resharding a ShardedRecordStore
+	 */
+	cout << "Resharding ShardedRecordStore from 4 to 3 shards... ";
+	try {
+		const std::string oldShard = rs->getShardPathname(0);
+		for (int i = 0; i < 100; i++)
+			rs->insert("reshard" + std::to_string(i),
+			    std::to_string(i).c_str(), std::to_string(i).size());
+		const unsigned int count = rs->getCount();
+		rs->reshard(3);
+
+		/* Every record is in the shard its key selects */
+		unsigned int shardTotal = 0;
+		for (uint32_t i = 0; i < rs->getShardCount(); i++) {
+			std::shared_ptr<IO::RecordStore> shard =
+			    rs->getShard(i);
+			for (const auto &record : *shard) {
+				if (rs->getShardIndex(record.key) != i)
+					throw Error::StrategyError(record.key +
+					    " is in the wrong shard");
+			}
+			shardTotal += shard->getCount();
+		}
+		if ((rs->getShardCount() != 3) || (rs->getCount() != count) ||
+		    (shardTotal != count) ||
+		    (rs->length("reshard42") != 2) ||
+		    IO::Utility::fileExists(oldShard))
+			throw Error::StrategyError("Records were not moved");
+		for (int i = 0; i < 100; i++)
+			rs->remove("reshard" + std::to_string(i));
+		cout << "success." << endl;
+	} catch (Error::Exception &e) {
+		cout << "failed: " << e.whatString() << endl;
+		delete rs;
+		return (EXIT_FAILURE);
+	}
+#endif
 	delete rs;
 
 	cout << "Open non-existing record store using factory method: ";
@@ -832,6 +947,22 @@ main(int argc, char* argv[]) {
 		cout << "A strategy error occurred: " << e.what() << endl;
 		return (EXIT_FAILURE);
 	}
+
+	cout << "Set cursor at \"" << cursorKey << "\" before sequencing: ";
+	try {
+		srs->setCursorAtKey(cursorKey);
+		const string key = srs->sequenceKey();
+		if (key != cursorKey) {
+			cout << "failed; sequenced \"" << key << "\"." << endl;
+			return (EXIT_FAILURE);
+		}
+		srs->remove("cursorKey1");
+		srs->remove("cursorKey2");
+		cout << "success." << endl;
+	} catch (Error::Exception &e) {
+		cout << "failed: " << e.what() << endl;
+		return (EXIT_FAILURE);
+	}
 	if (runTests(srs.get()) != 0)
 		return (EXIT_FAILURE);
 	srs.reset();		// Close the RecordStore
@@ -20,6 +20,7 @@ namespace BE = BiometricEvaluation;
 static const std::string RS1{"rsUnion_1_test"};
 static const std::string RS2{"rsUnion_2_test"};
 static const std::string NAME_KEY{"name"};
+static const std::string MISSING_KEY{"missing"};
 
 /**
  * @param rsUnion
@@ -100,6 +101,32 @@ doTest(
 		throw BE::Error::StrategyError(RS2 + " length was incorrect");
 	}
 	std::cout << "PASS" << std::endl;
+
+	std::cout << "Testing tryRead() of existing key...";
+	const auto tryValues = rsUnion.tryRead(NAME_KEY);
+	if ((tryValues.size() != 2) ||
+	    (to_string(tryValues.at(RS1)) != RS1) ||
+	    (to_string(tryValues.at(RS2)) != RS2)) {
+		std::cout << "FAIL" << std::endl;
+		throw BE::Error::StrategyError("tryRead() did not match read()");
+	}
+	std::cout << "PASS" << std::endl;
+
+	std::cout << "Testing tryRead() of missing key...";
+	if (rsUnion.tryRead(MISSING_KEY).size() != 0) {
+		std::cout << "FAIL" << std::endl;
+		throw BE::Error::StrategyError("Read data for " + MISSING_KEY);
+	}
+	std::cout << "PASS" << std::endl;
+
+	std::cout << "Testing read() of missing key...";
+	try {
+		rsUnion.read(MISSING_KEY);
+		std::cout << "FAIL" << std::endl;
+		throw BE::Error::StrategyError("Read data for " + MISSING_KEY);
+	} catch (const BE::Error::ObjectDoesNotExist &) {
+		std::cout << "PASS" << std::endl;
+	}
 }
 
 static void
@@ -142,6 +169,10 @@ main(
 			{RS2, BE::IO::RecordStore::openRecordStore(RS2)}});
 
 		doTest(*rsUnion.get());
+
+		std::cout << "\nBuilding key filters..." << std::endl;
+		rsUnion->buildKeyFilters();
+		doTest(*rsUnion.get());
 	} catch (BE::Error::Exception &e) {
 		std::cout << e.whatString() << std::endl;
 		rv = EXIT_FAILURE;
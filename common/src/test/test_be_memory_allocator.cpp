@@ -0,0 +1,324 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <be_error_exception.h>
+#include <be_io_utility.h>
+#include <be_memory_allocator.h>
+#include <be_memory_autoarray.h>
+
+using namespace std;
+namespace BE = BiometricEvaluation;
+
+/** File read repeatedly by the hot loop tests */
+static const std::string TESTFILE{"test_be_memory_allocator.dat"};
+/** Iterations of hot loops */
+static const uint32_t ITERATIONS = 2000;
+
+/** @return Whether pointer is aligned to alignment bytes */
+static bool
+isAligned(
+    const void *pointer,
+    size_t alignment)
+{
+	return ((reinterpret_cast<uintptr_t>(pointer) % alignment) == 0);
+}
+
+/**
+ * @brief
+ * Read TESTFILE ITERATIONS times, as a hot loop reading records would.
+ *
+ * @param allocator
+ *	Default Allocator while reading.
+ */
+static void
+readFileLoop(
+    BE::Memory::Allocator &allocator)
+{
+	BE::Memory::ScopedDefaultAllocator scope(allocator);
+	for (uint32_t i = 0; i < ITERATIONS; i++) {
+		BE::Memory::uint8Array contents =
+		    BE::IO::Utility::readFile(TESTFILE);
+		contents[0] = 0;
+	}
+}
+
+static bool
+testPoolReuse()
+{
+	cout << "Count system allocations in a readFile() loop... ";
+	BE::Memory::uint8Array data(256 * 1024);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = static_cast<uint8_t>(i);
+	BE::IO::Utility::writeFile(data, TESTFILE, std::ios_base::trunc);
+
+	BE::Memory::NewAllocator &newAllocator =
+	    BE::Memory::NewAllocator::instance();
+	BE::Memory::PoolAllocator &poolAllocator =
+	    BE::Memory::PoolAllocator::instance();
+	newAllocator.resetStatistics();
+	poolAllocator.resetStatistics();
+	readFileLoop(newAllocator);
+	readFileLoop(poolAllocator);
+	const BE::Memory::AllocatorStatistics newStats =
+	    newAllocator.getStatistics();
+	const BE::Memory::AllocatorStatistics poolStats =
+	    poolAllocator.getStatistics();
+	std::remove(TESTFILE.c_str());
+
+	if ((newStats.systemAllocations != ITERATIONS) ||
+	    (poolStats.allocations != ITERATIONS) ||
+	    (poolStats.deallocations != ITERATIONS) ||
+	    (poolStats.systemAllocations != 1)) {
+		cout << "failed (" << newStats.systemAllocations << " vs. " <<
+		    poolStats.systemAllocations << ")" << endl;
+		return (false);
+	}
+	cout << "passed" << endl;
+	cout << "\tNewAllocator: " << newStats.systemAllocations <<
+	    " system allocations" << endl;
+	cout << "\tPoolAllocator: " << poolStats.systemAllocations <<
+	    " system allocations" << endl;
+	return (true);
+}
+
+static bool
+testPoolThreads()
+{
+	cout << "Pool on several threads... ";
+	BE::Memory::PoolAllocator &poolAllocator =
+	    BE::Memory::PoolAllocator::instance();
+	poolAllocator.resetStatistics();
+
+	const uint32_t threadCount = 4;
+	std::vector<std::thread> threads;
+	std::vector<char> aligned(threadCount, true);
+	for (uint32_t t = 0; t < threadCount; t++) {
+		threads.emplace_back([&, t]() {
+			for (uint32_t i = 0; i < ITERATIONS; i++) {
+				BE::Memory::uint8Array buffer(1000 + t,
+				    poolAllocator);
+				if (!isAligned(buffer, BE::Memory::
+				    AlignedAllocator::CACHE_LINE_SIZE))
+					aligned[t] = false;
+				buffer[0] = 1;
+			}
+		});
+	}
+	for (auto &thread : threads)
+		thread.join();
+
+	/* Pools were released when their threads exited */
+	const BE::Memory::AllocatorStatistics stats =
+	    poolAllocator.getStatistics();
+	for (uint32_t t = 0; t < threadCount; t++) {
+		if (!aligned[t]) {
+			cout << "failed (alignment)" << endl;
+			return (false);
+		}
+	}
+	if ((stats.allocations != (threadCount * ITERATIONS)) ||
+	    (stats.systemAllocations != threadCount)) {
+		cout << "failed (" << stats.systemAllocations <<
+		    " system allocations)" << endl;
+		return (false);
+	}
+	cout << "passed" << endl;
+	return (true);
+}
+
+static bool
+testArena()
+{
+	cout << "Allocate from and reset an ArenaAllocator... ";
+	BE::Memory::ArenaAllocator arena(64 * 1024);
+	for (uint32_t package = 0; package < 100; package++) {
+		{
+			BE::Memory::uint8Array small(1000, arena);
+			BE::Memory::uint32Array words(1000, arena);
+			BE::Memory::uint8Array large(16 * 1024, arena);
+			if (!isAligned(words, alignof(uint32_t))) {
+				cout << "failed (alignment)" << endl;
+				return (false);
+			}
+			small[999] = 1;
+			words[999] = 1;
+			large[large.size() - 1] = 1;
+		}
+		if (arena.getBytesInUse() == 0) {
+			cout << "failed (bytes in use)" << endl;
+			return (false);
+		}
+		arena.reset();
+	}
+
+	/* Chunk was kept, so later packages allocate nothing */
+	BE::Memory::AllocatorStatistics stats = arena.getStatistics();
+	if ((arena.getBytesInUse() != 0) || (stats.allocations != 300) ||
+	    (stats.systemAllocations != 1)) {
+		cout << "failed (" << stats.systemAllocations <<
+		    " system allocations)" << endl;
+		return (false);
+	}
+
+	/* Large requests get a chunk of their own */
+	{
+		BE::Memory::uint8Array small(1000, arena);
+		BE::Memory::uint8Array large(1024 * 1024, arena);
+		BE::Memory::uint8Array next(1000, arena);
+		if ((next - small) != 1008) {
+			cout << "failed (chunk not kept)" << endl;
+			return (false);
+		}
+	}
+	arena.reset();
+	stats = arena.getStatistics();
+	if (stats.systemAllocations != 2) {
+		cout << "failed (" << stats.systemAllocations <<
+		    " system allocations)" << endl;
+		return (false);
+	}
+
+	/* A large first request must not be shared with the next */
+	BE::Memory::ArenaAllocator fresh(1024);
+	{
+		BE::Memory::uint8Array large(800, fresh);
+		BE::Memory::uint8Array small(100, fresh);
+		std::fill(large.begin(), large.end(), 1);
+		std::fill(small.begin(), small.end(), 2);
+		const uint8_t *first = &large[0];
+		const uint8_t *second = &small[0];
+		if ((second >= first) && (second < (first + large.size()))) {
+			cout << "failed (overlapping chunk)" << endl;
+			return (false);
+		}
+		if (std::count(large.begin(), large.end(), 1) !=
+		    static_cast<long>(large.size())) {
+			cout << "failed (overwritten)" << endl;
+			return (false);
+		}
+	}
+	cout << "passed" << endl;
+	return (true);
+}
+
+static bool
+testArenaNonTrivial()
+{
+	cout << "Hold strings in an ArenaAllocator... ";
+	BE::Memory::ArenaAllocator arena;
+	{
+		BE::Memory::AutoArray<std::string> strings(3, arena);
+		strings[0] = "zero";
+		strings[1] = std::string(1000, '1');
+		strings.resize(10);
+		strings[9] = "nine";
+		BE::Memory::AutoArray<std::string> copy(strings);
+		if ((copy.size() != 10) || (copy[0] != "zero") ||
+		    (copy[1].size() != 1000) || (copy[9] != "nine") ||
+		    (&copy.getAllocator() != &BE::Memory::Allocator::
+		    getDefault()) || (&strings.getAllocator() != &arena)) {
+			cout << "failed" << endl;
+			return (false);
+		}
+	}
+	arena.reset();
+	cout << "passed" << endl;
+	return (true);
+}
+
+static bool
+testAligned()
+{
+	cout << "Allocate aligned memory... ";
+	BE::Memory::AlignedAllocator aligned;
+	BE::Memory::uint8Array simd(1000, aligned);
+	if (!isAligned(simd, 64)) {
+		cout << "failed (64-byte)" << endl;
+		return (false);
+	}
+	simd.resize(100000);
+	if (!isAligned(simd, 64)) {
+		cout << "failed (64-byte, resized)" << endl;
+		return (false);
+	}
+
+	BE::Memory::AlignedAllocator huge(64, true);
+	BE::Memory::uint8Array hugeBuffer(
+	    BE::Memory::AlignedAllocator::HUGE_PAGE_SIZE * 3 / 2, huge);
+	if (!isAligned(hugeBuffer,
+	    BE::Memory::AlignedAllocator::HUGE_PAGE_SIZE)) {
+		cout << "failed (huge page)" << endl;
+		return (false);
+	}
+	hugeBuffer[hugeBuffer.size() - 1] = 1;
+
+	try {
+		BE::Memory::AlignedAllocator bad(48);
+		cout << "failed (non-power of 2)" << endl;
+		return (false);
+	} catch (const BE::Error::ParameterError&) {}
+
+	cout << "passed" << endl;
+	return (true);
+}
+
+static bool
+testCapacity()
+{
+	cout << "Reserve and reuse capacity... ";
+	BE::Memory::PoolAllocator &poolAllocator =
+	    BE::Memory::PoolAllocator::instance();
+	BE::Memory::uint16Array array(0, poolAllocator);
+	array.reserve(500);
+	poolAllocator.resetStatistics();
+	for (uint16_t i = 0; i < 500; i++) {
+		array.resize(i + 1);
+		array[i] = i;
+	}
+	BE::Memory::uint16Array other(10, poolAllocator);
+	other = array;
+	if ((poolAllocator.getStatistics().allocations != 2) ||
+	    (array.capacity() != 500) || (other != array)) {
+		cout << "failed" << endl;
+		return (false);
+	}
+	cout << "passed" << endl;
+	return (true);
+}
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+	if (!testPoolReuse())
+		return (EXIT_FAILURE);
+	if (!testPoolThreads())
+		return (EXIT_FAILURE);
+	if (!testArena())
+		return (EXIT_FAILURE);
+	if (!testArenaNonTrivial())
+		return (EXIT_FAILURE);
+	if (!testAligned())
+		return (EXIT_FAILURE);
+	if (!testCapacity())
+		return (EXIT_FAILURE);
+
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,215 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <be_error_exception.h>
+#include <be_image_image.h>
+#include <be_io_gzip.h>
+#include <be_io_recordstore.h>
+#include <be_io_utility.h>
+#include <be_memory_byteview.h>
+#include <be_memory_indexedbuffer.h>
+#include <be_memory_sharedbuffer.h>
+#include <be_text.h>
+
+using namespace std;
+namespace BE = BiometricEvaluation;
+
+static const std::string RSNAME{"test_be_memory_byteview_rs"};
+
+/** @return 4x2 8-bit binary PGM image */
+static BE::Memory::uint8Array
+makePGM()
+{
+	const std::string header{"P5\n4 2\n255\n"};
+	BE::Memory::uint8Array pgm(header.size() + 8);
+	std::copy(header.begin(), header.end(), pgm.begin());
+	for (uint8_t i = 0; i < 8; i++)
+		pgm[header.size() + i] = i * 32;
+	return (pgm);
+}
+
+static bool
+testByteView()
+{
+	cout << "View buffers... ";
+	const std::vector<uint8_t> vector{1, 2, 3, 4, 5};
+	const BE::Memory::uint8Array array{1, 2, 3, 4, 5};
+
+	const BE::Memory::ByteView vectorView(vector);
+	const BE::Memory::ByteView arrayView(array);
+	if ((vectorView.data() != vector.data()) ||
+	    (arrayView.data() != &array[0]) ||
+	    (arrayView.size() != 5) || !BE::Memory::ByteView().empty() ||
+	    !std::equal(vectorView.begin(), vectorView.end(),
+	    arrayView.begin())) {
+		cout << "failed (construction)" << endl;
+		return (false);
+	}
+
+	const BE::Memory::ByteView sub = arrayView.subview(1, 3);
+	if ((sub.size() != 3) || (sub[0] != 2) || (sub.at(2) != 4) ||
+	    (arrayView.subview(3).size() != 2) ||
+	    !arrayView.subview(5).empty()) {
+		cout << "failed (subview)" << endl;
+		return (false);
+	}
+	try {
+		sub.at(3);
+		cout << "failed (at)" << endl;
+		return (false);
+	} catch (const std::out_of_range&) {}
+	try {
+		arrayView.subview(6);
+		cout << "failed (subview range)" << endl;
+		return (false);
+	} catch (const std::out_of_range&) {}
+
+	cout << "passed" << endl;
+	return (true);
+}
+
+static bool
+testSharedBuffer()
+{
+	cout << "Share buffers... ";
+	BE::Memory::uint8Array array{1, 2, 3, 4, 5};
+	const uint8_t *original = array;
+
+	BE::Memory::SharedBuffer slice;
+	{
+		const BE::Memory::SharedBuffer shared(std::move(array));
+		const BE::Memory::SharedBuffer copy = shared;
+		if ((shared.data() != original) || (copy.data() != original) ||
+		    (shared.size() != 5) || (array.size() != 0)) {
+			cout << "failed (ownership)" << endl;
+			return (false);
+		}
+		slice = shared.slice(2);
+	}
+	/* Slice keeps the bytes alive */
+	if ((slice.size() != 3) || (slice.data() != (original + 2)) ||
+	    (slice.getView()[0] != 3)) {
+		cout << "failed (slice)" << endl;
+		return (false);
+	}
+
+	const std::vector<uint8_t> vector{9, 8, 7};
+	const BE::Memory::SharedBuffer copied{BE::Memory::ByteView(vector)};
+	if ((copied.data() == vector.data()) || (copied.size() != 3) ||
+	    (copied.getView()[2] != 7)) {
+		cout << "failed (copy)" << endl;
+		return (false);
+	}
+
+	cout << "passed" << endl;
+	return (true);
+}
+
+static bool
+testOverloads()
+{
+	cout << "Pass views to I/O APIs... ";
+	const std::vector<uint8_t> vector{'a', 'b', 'c'};
+	const BE::Memory::ByteView view(vector);
+
+	if (BE::Text::digest(view) != BE::Text::digest("abc")) {
+		cout << "failed (digest)" << endl;
+		return (false);
+	}
+
+	BE::Memory::IndexedBuffer buffer(view);
+	if ((buffer.getSize() != 3) || (buffer.scanU8Val() != 'a')) {
+		cout << "failed (IndexedBuffer)" << endl;
+		return (false);
+	}
+
+	BE::IO::GZip gzip;
+	const BE::Memory::uint8Array compressed = gzip.compress(view);
+	const BE::Memory::uint8Array decompressed = gzip.decompress(
+	    BE::Memory::ByteView(compressed));
+	if (BE::Memory::ByteView(decompressed).size() != 3 ||
+	    !std::equal(view.begin(), view.end(), decompressed.begin())) {
+		cout << "failed (GZip)" << endl;
+		return (false);
+	}
+
+	cout << "passed" << endl;
+	return (true);
+}
+
+static bool
+testZeroCopyImage()
+{
+	cout << "Move a record from RecordStore to Image... ";
+	if (BE::IO::Utility::fileExists(RSNAME))
+		BE::IO::RecordStore::removeRecordStore(RSNAME);
+	std::shared_ptr<BE::IO::RecordStore> rs =
+	    BE::IO::RecordStore::createRecordStore(RSNAME, "ByteView test",
+	    BE::IO::RecordStore::Kind::File);
+
+	const BE::Memory::uint8Array pgm = makePGM();
+	rs->insert("pgm", BE::Memory::ByteView(pgm));
+
+	/* Record read from store becomes the Image's encoded data */
+	BE::Memory::uint8Array record = rs->read("pgm");
+	const uint8_t *recordData = record;
+	const std::shared_ptr<BE::Image::Image> image =
+	    BE::Image::Image::openImage(std::move(record));
+	const BE::Memory::SharedBuffer encoded = image->getSharedData();
+	if ((encoded.data() != recordData) ||
+	    (encoded.size() != pgm.size()) ||
+	    (image->getCompressionAlgorithm() !=
+	    BE::Image::CompressionAlgorithm::NetPBM) ||
+	    (image->getDimensions().xSize != 4) ||
+	    (image->getRawData()[7] != (7 * 32))) {
+		cout << "failed" << endl;
+		BE::IO::RecordStore::removeRecordStore(RSNAME);
+		return (false);
+	}
+
+	/* Copying constructors still copy */
+	const std::shared_ptr<BE::Image::Image> copied =
+	    BE::Image::Image::openImage(pgm);
+	if (copied->getSharedData().data() == &pgm[0]) {
+		cout << "failed (copy)" << endl;
+		BE::IO::RecordStore::removeRecordStore(RSNAME);
+		return (false);
+	}
+
+	rs.reset();
+	BE::IO::RecordStore::removeRecordStore(RSNAME);
+	cout << "passed" << endl;
+	return (true);
+}
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+	if (!testByteView())
+		return (EXIT_FAILURE);
+	if (!testSharedBuffer())
+		return (EXIT_FAILURE);
+	if (!testOverloads())
+		return (EXIT_FAILURE);
+	if (!testZeroCopyImage())
+		return (EXIT_FAILURE);
+
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,389 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+/*
+ * Simulate distributing work across many nodes by running many tasks on
+ * one machine, with every Tasks Per Node consecutive tasks treated as a
+ * node that has its own node distributor. Each record of a sharded input
+ * store must be processed exactly once.
+ *
+ * Usage: mpirun -np <tasks> test_be_mpi_node-distribution [records [resume]]
+ *
+ * The properties file is created when it does not exist, and may be
+ * edited between runs (e.g., to compare Node Batch Sizes, or to turn
+ * off Node Distributors).
+ *
+ * With "resume", the job instead resumes from a checkpoint journal
+ * written as if an earlier run had completed part of the input and
+ * stopped while another package was in progress. Only the records
+ * not yet processed must be processed.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include <be_error_exception.h>
+#include <be_io_shardedrecstore.h>
+#include <be_io_utility.h>
+#include <be_mpi.h>
+#include <be_mpi_receiver.h>
+#include <be_mpi_recordprocessor.h>
+#include <be_mpi_recordstoredistributor.h>
+#include <be_mpi_recordstoreresources.h>
+#include <be_mpi_runtime.h>
+#include <be_time_timer.h>
+
+namespace BE = BiometricEvaluation;
+
+static const std::string PropertiesFileName(
+    "test_be_mpi_node-distribution.props");
+static const std::string InputRSName("test_be_mpi_node-distribution.rs");
+/** Every worker appends the keys it processes to this file */
+static const std::string OutputFileName(
+    "test_be_mpi_node-distribution.out");
+/** Properties for the resume case, which are always rewritten */
+static const std::string ResumePropertiesFileName(
+    "test_be_mpi_node-distribution-resume.props");
+static const std::string JournalFileName(
+    "test_be_mpi_node-distribution.journal");
+/** Keys processed before the job was resumed */
+static const std::string DoneFileName(
+    "test_be_mpi_node-distribution.done");
+/** Every worker appends the keys it skips when resuming to this file */
+static const std::string SkippedFileName(
+    "test_be_mpi_node-distribution.skipped");
+/** Number of records when not given on the command line */
+static const uint64_t DEFAULT_RECORD_COUNT = 4096;
+
+/** Records the key of every record processed */
+class KeyProcessor : public BE::MPI::RecordProcessor
+{
+public:
+	KeyProcessor(
+	    const std::string &propertiesFileName) :
+	    RecordProcessor(propertiesFileName)
+	{
+
+	}
+
+	std::shared_ptr<BE::MPI::WorkPackageProcessor>
+	newProcessor(
+	    std::shared_ptr<BE::IO::Logsheet> &logsheet)
+	{
+		std::shared_ptr<KeyProcessor> processor(
+		    new KeyProcessor(
+		    this->getResources()->getPropertiesFileName()));
+		processor->setLogsheet(logsheet);
+		return (processor);
+	}
+
+	void
+	performInitialization(
+	    std::shared_ptr<BE::IO::Logsheet> &logsheet)
+	{
+		this->setLogsheet(logsheet);
+	}
+
+	void
+	processRecord(
+	    const std::string &key)
+	{
+		/* Each line is one write, so workers can share the file */
+		if (!this->_output.is_open())
+			this->_output.open(OutputFileName, std::ios::app);
+		this->_output << key + "\n" << std::flush;
+	}
+
+	void
+	processRecord(
+	    const std::string &key,
+	    const BE::Memory::uint8Array &value)
+	{
+		this->processRecord(key);
+	}
+
+	bool
+	isRecordProcessed(
+	    const std::string &key)
+	{
+		if (!this->_doneLoaded) {
+			std::ifstream ifs(DoneFileName);
+			std::string doneKey;
+			while (std::getline(ifs, doneKey))
+				this->_done.insert(doneKey);
+			this->_doneLoaded = true;
+		}
+		if (this->_done.find(key) == this->_done.end())
+			return (false);
+
+		if (!this->_skipped.is_open())
+			this->_skipped.open(SkippedFileName, std::ios::app);
+		this->_skipped << key + "\n" << std::flush;
+		return (true);
+	}
+
+private:
+	std::ofstream _output;
+	std::ofstream _skipped;
+	std::set<std::string> _done;
+	bool _doneLoaded = false;
+};
+
+/* Create the input store and, if needed, the properties file */
+static void
+createInput(
+    uint64_t recordCount)
+{
+	if (BE::IO::Utility::fileExists(InputRSName))
+		BE::IO::RecordStore::removeRecordStore(InputRSName);
+	BE::IO::ShardedRecordStore rs(InputRSName,
+	    "Node distribution input", BE::IO::RecordStore::Kind::File);
+	const BE::Memory::uint8Array record(16);
+	for (uint64_t i = 0; i < recordCount; i++)
+		rs.insert(std::to_string(i), record);
+	rs.sync();
+	std::remove(OutputFileName.c_str());
+
+	if (BE::IO::Utility::fileExists(PropertiesFileName))
+		return;
+	std::ofstream ofs(PropertiesFileName);
+	ofs << "Input Record Store = " << InputRSName << "\n";
+	ofs << "Chunk Size = 8\n";
+	ofs << "Workers Per Node = 1\n";
+	ofs << "Node Distributors = true\n";
+	ofs << "Tasks Per Node = 4\n";
+	ofs << "Logsheet URL = file://./mpi-node.log\n";
+	if (!ofs)
+		throw BE::Error::FileError("Could not write " +
+		    PropertiesFileName);
+}
+
+/* Read the lines of a file */
+static std::vector<std::string>
+readLines(
+    const std::string &pathname)
+{
+	std::vector<std::string> lines;
+	std::ifstream ifs(pathname);
+	std::string line;
+	while (std::getline(ifs, line))
+		lines.push_back(line);
+	return (lines);
+}
+
+/*
+ * Write the properties, checkpoint journal, and output of an earlier
+ * run that completed two ranges of the input, and was also partway
+ * through the package after the first range when it stopped. Returns
+ * the keys in that partial package, which are processed but not
+ * journaled.
+ */
+static std::set<std::string>
+createCheckpoint(
+    uint64_t recordCount)
+{
+	std::ofstream props(ResumePropertiesFileName);
+	props << "Input Record Store = " << InputRSName << "\n";
+	props << "Chunk Size = 8\n";
+	props << "Workers Per Node = 1\n";
+	props << "Node Distributors = true\n";
+	props << "Tasks Per Node = 4\n";
+	props << "Logsheet URL = file://./mpi-node-resume.log\n";
+	props << BE::MPI::RecordStoreResources::CHECKPOINTJOURNALPROPERTY <<
+	    " = " << JournalFileName << "\n";
+	props << BE::MPI::RecordStoreResources::RESUMEFROMCHECKPOINTPROPERTY <<
+	    " = true\n";
+	if (!props)
+		throw BE::Error::FileError("Could not write " +
+		    ResumePropertiesFileName);
+
+	/* Positions are in the order the store sequences, not by key */
+	std::vector<std::string> keys;
+	BE::IO::ShardedRecordStore rs(InputRSName);
+	try {
+		while (true)
+			keys.push_back(rs.sequenceKey());
+	} catch (const BE::Error::ObjectDoesNotExist &) {}
+
+	const uint64_t firstCount = recordCount / 4;
+	const uint64_t secondFirst = recordCount / 2;
+	const uint64_t secondCount = recordCount / 8;
+	const uint64_t partialCount = std::min<uint64_t>(3,
+	    secondFirst - firstCount);
+
+	std::ofstream journal(JournalFileName);
+	journal << recordCount << "\n";
+	if (firstCount > 0)
+		journal << 0 << ' ' << firstCount << ' ' <<
+		    keys[firstCount - 1] << "\n";
+	if (secondCount > 0)
+		journal << secondFirst << ' ' << secondCount << ' ' <<
+		    keys[secondFirst + secondCount - 1] << "\n";
+	/* Being written when the job stopped */
+	journal << firstCount;
+	if (!journal)
+		throw BE::Error::FileError("Could not write " +
+		    JournalFileName);
+
+	std::ofstream done(DoneFileName);
+	std::ofstream output(OutputFileName);
+	std::set<std::string> partial;
+	for (uint64_t i = 0; i < keys.size(); i++) {
+		if ((i < firstCount) || ((i >= secondFirst) &&
+		    (i < secondFirst + secondCount))) {
+			done << keys[i] << "\n";
+			output << keys[i] << "\n";
+		} else if (i < firstCount + partialCount) {
+			done << keys[i] << "\n";
+			output << keys[i] << "\n";
+			partial.insert(keys[i]);
+		}
+	}
+	if (!done || !output)
+		throw BE::Error::FileError("Could not write " + DoneFileName);
+	std::remove(SkippedFileName.c_str());
+
+	return (partial);
+}
+
+/*
+ * Check that, when resuming, the only records a worker was given that
+ * were already processed are those of the partial package.
+ */
+static bool
+checkSkipped(
+    const std::set<std::string> &partial)
+{
+	bool success = true;
+	for (const auto &key : readLines(SkippedFileName)) {
+		if (partial.find(key) == partial.end()) {
+			std::cout << "Record " << key << " from a journaled "
+			    "range was distributed" << std::endl;
+			success = false;
+		}
+	}
+	return (success);
+}
+
+/* Check that each record was processed exactly once */
+static bool
+checkOutput(
+    uint64_t recordCount)
+{
+	std::map<std::string, uint64_t> timesProcessed;
+	std::ifstream ifs(OutputFileName);
+	std::string key;
+	while (std::getline(ifs, key))
+		timesProcessed[key]++;
+
+	bool success = true;
+	for (uint64_t i = 0; i < recordCount; i++) {
+		const auto count = timesProcessed.find(std::to_string(i));
+		if (count == timesProcessed.end()) {
+			std::cout << "Record " << i << " was not processed" <<
+			    std::endl;
+			success = false;
+		} else if (count->second != 1) {
+			std::cout << "Record " << i << " was processed " <<
+			    count->second << " times" << std::endl;
+			success = false;
+		}
+	}
+	if (timesProcessed.size() != recordCount) {
+		std::cout << "Unknown records were processed" << std::endl;
+		success = false;
+	}
+	return (success);
+}
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+	BE::MPI::Runtime runtime(argc, argv);
+	const bool isDistributor = (::MPI::COMM_WORLD.Get_rank() == 0);
+
+	uint64_t recordCount = DEFAULT_RECORD_COUNT;
+	if (argc > 1)
+		recordCount = std::max(1, std::atoi(argv[1]));
+	const bool resume = ((argc > 2) && (std::string(argv[2]) == "resume"));
+	const std::string propertiesFileName = (resume ?
+	    ResumePropertiesFileName : PropertiesFileName);
+
+	std::set<std::string> partial;
+	if (isDistributor) {
+		try {
+			createInput(recordCount);
+			if (resume)
+				partial = createCheckpoint(recordCount);
+		} catch (const BE::Error::Exception &e) {
+			BE::MPI::printStatus("Could not create input: " +
+			    e.whatString());
+			runtime.abort(EXIT_FAILURE);
+		}
+	}
+	::MPI::COMM_WORLD.Barrier();
+
+	std::unique_ptr<BE::MPI::RecordStoreDistributor> distributor;
+	std::shared_ptr<KeyProcessor> processor;
+	std::unique_ptr<BE::MPI::Receiver> receiver;
+	try {
+		distributor.reset(new BE::MPI::RecordStoreDistributor(
+		    propertiesFileName, false));
+		processor.reset(new KeyProcessor(propertiesFileName));
+		receiver.reset(new BE::MPI::Receiver(propertiesFileName,
+		    processor));
+	} catch (const BE::Error::Exception &e) {
+		BE::MPI::printStatus("Setup failed: " + e.whatString());
+		runtime.abort(EXIT_FAILURE);
+	}
+
+	BE::Time::Timer timer;
+	try {
+		timer.start();
+		runtime.start(*distributor, *receiver);
+		timer.stop();
+	} catch (const BE::Error::Exception &e) {
+		BE::MPI::printStatus("start, caught: " + e.whatString());
+		runtime.abort(EXIT_FAILURE);
+	}
+
+	/* Every worker has written its keys once all tasks are here */
+	::MPI::COMM_WORLD.Barrier();
+	int status = EXIT_SUCCESS;
+	if (isDistributor) {
+		const bool skippedOK = (!resume || checkSkipped(partial));
+		if (checkOutput(recordCount) && skippedOK) {
+			const double seconds = timer.elapsed() / 1000000.0;
+			std::cout << recordCount << " records processed " <<
+			    "exactly once by " <<
+			    ::MPI::COMM_WORLD.Get_size() << " tasks in " <<
+			    std::fixed << std::setprecision(3) << seconds <<
+			    " s" << std::endl;
+		} else {
+			status = EXIT_FAILURE;
+		}
+	}
+	runtime.shutdown();
+
+	return (status);
+}
@@ -0,0 +1,202 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+/*
+ * Measure how quickly large records (e.g., images) move from the
+ * Distributor through each Receiver to its workers.
+ *
+ * Usage: mpirun -np <tasks> test_be_mpi_package-bench [MiB/record [records]]
+ *
+ * The properties file is created when it does not exist, and may be
+ * edited between runs (e.g., to compare Package Pool Slot Sizes).
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <mpi.h>
+
+#include <be_error_exception.h>
+#include <be_io_recordstore.h>
+#include <be_io_utility.h>
+#include <be_mpi.h>
+#include <be_mpi_receiver.h>
+#include <be_mpi_recordprocessor.h>
+#include <be_mpi_recordstoredistributor.h>
+#include <be_mpi_runtime.h>
+#include <be_time_timer.h>
+
+namespace BE = BiometricEvaluation;
+
+static const std::string PropertiesFileName(
+    "test_be_mpi_package-bench.props");
+static const std::string InputRSName("test_be_mpi_package-bench.rs");
+/** Size of each record when not given on the command line */
+static const uint64_t DEFAULT_RECORD_MIB = 4;
+/** Number of records when not given on the command line */
+static const uint64_t DEFAULT_RECORD_COUNT = 256;
+
+/** Reads every byte of every record, as a decoder would */
+class ChecksumProcessor : public BE::MPI::RecordProcessor
+{
+public:
+	ChecksumProcessor(
+	    const std::string &propertiesFileName) :
+	    RecordProcessor(propertiesFileName)
+	{
+
+	}
+
+	std::shared_ptr<BE::MPI::WorkPackageProcessor>
+	newProcessor(
+	    std::shared_ptr<BE::IO::Logsheet> &logsheet)
+	{
+		std::shared_ptr<ChecksumProcessor> processor(
+		    new ChecksumProcessor(
+		    this->getResources()->getPropertiesFileName()));
+		processor->setLogsheet(logsheet);
+		return (processor);
+	}
+
+	void
+	performInitialization(
+	    std::shared_ptr<BE::IO::Logsheet> &logsheet)
+	{
+		this->setLogsheet(logsheet);
+	}
+
+	void
+	processRecord(
+	    const std::string &key)
+	{
+
+	}
+
+	void
+	processRecord(
+	    const std::string &key,
+	    const BE::Memory::uint8Array &value)
+	{
+		for (const auto byte : value)
+			this->_checksum += byte;
+	}
+
+	~ChecksumProcessor()
+	{
+		/* Only processors created by newProcessor() have a log */
+		if (this->getLogsheet() == nullptr)
+			return;
+		std::ostringstream sstr;
+		sstr << "Checksum " << this->_checksum;
+		BE::MPI::logMessage(*this->getLogsheet(), sstr.str());
+	}
+
+private:
+	uint64_t _checksum{0};
+};
+
+/* Create the input store and, if needed, the properties file */
+static void
+createInput(
+    uint64_t recordMiB,
+    uint64_t recordCount)
+{
+	if (BE::IO::Utility::fileExists(InputRSName))
+		BE::IO::RecordStore::removeRecordStore(InputRSName);
+	const auto rs = BE::IO::RecordStore::createRecordStore(InputRSName,
+	    "Package bench input", BE::IO::RecordStore::Kind::File);
+	BE::Memory::uint8Array record(recordMiB * 1024 * 1024);
+	for (uint64_t i = 0; i < record.size(); i++)
+		record[i] = static_cast<uint8_t>(i * 131);
+	for (uint64_t i = 0; i < recordCount; i++)
+		rs->insert(std::to_string(i), record);
+	rs->sync();
+
+	if (BE::IO::Utility::fileExists(PropertiesFileName))
+		return;
+	std::ofstream ofs(PropertiesFileName);
+	ofs << "Input Record Store = " << InputRSName << "\n";
+	ofs << "Chunk Size = 4\n";
+	ofs << "Workers Per Node = 4\n";
+	ofs << "Logsheet URL = file://./mpi-bench.log\n";
+	if (!ofs)
+		throw BE::Error::FileError("Could not write " +
+		    PropertiesFileName);
+}
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+	BE::MPI::Runtime runtime(argc, argv);
+	const bool isDistributor = (::MPI::COMM_WORLD.Get_rank() == 0);
+
+	uint64_t recordMiB = DEFAULT_RECORD_MIB;
+	uint64_t recordCount = DEFAULT_RECORD_COUNT;
+	if (argc > 1)
+		recordMiB = std::max(1, std::atoi(argv[1]));
+	if (argc > 2)
+		recordCount = std::max(1, std::atoi(argv[2]));
+
+	if (isDistributor) {
+		try {
+			createInput(recordMiB, recordCount);
+		} catch (const BE::Error::Exception &e) {
+			BE::MPI::printStatus("Could not create input: " +
+			    e.whatString());
+			runtime.abort(EXIT_FAILURE);
+		}
+	}
+	::MPI::COMM_WORLD.Barrier();
+
+	std::unique_ptr<BE::MPI::RecordStoreDistributor> distributor;
+	std::shared_ptr<ChecksumProcessor> processor;
+	std::unique_ptr<BE::MPI::Receiver> receiver;
+	try {
+		distributor.reset(new BE::MPI::RecordStoreDistributor(
+		    PropertiesFileName, true));
+		processor.reset(new ChecksumProcessor(PropertiesFileName));
+		receiver.reset(new BE::MPI::Receiver(PropertiesFileName,
+		    processor));
+	} catch (const BE::Error::Exception &e) {
+		BE::MPI::printStatus("Setup failed: " + e.whatString());
+		runtime.abort(EXIT_FAILURE);
+	}
+
+	BE::Time::Timer timer;
+	try {
+		timer.start();
+		runtime.start(*distributor, *receiver);
+		timer.stop();
+	} catch (const BE::Error::Exception &e) {
+		BE::MPI::printStatus("start, caught: " + e.whatString());
+		runtime.abort(EXIT_FAILURE);
+	}
+
+	if (isDistributor) {
+		const double mib = static_cast<double>(recordMiB) *
+		    recordCount;
+		const double seconds = timer.elapsed() / 1000000.0;
+		std::cout << std::fixed << std::setprecision(1) << mib <<
+		    " MiB in " << std::setprecision(3) << seconds << " s: " <<
+		    std::setprecision(1) << (mib / seconds) << " MiB/s" <<
+		    std::endl;
+	}
+	runtime.shutdown();
+
+	return (EXIT_SUCCESS);
+}
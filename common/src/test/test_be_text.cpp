@@ -10,9 +10,12 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <sstream>
 #include <vector>
 
 #include <be_text.h>
+#include <be_text_digester.h>
+#include <be_time_timer.h>
 
 using namespace BiometricEvaluation;
 using namespace std;
@@ -80,6 +83,82 @@ main(int argc, char* argv[])
 	    Text::digest(secret_str) << endl;
 	
 	cout << endl;
+
+	cout << "Text::Digester, in pieces: ";
+	Text::Digester digester("md5");
+	digester.update(buf_with_nuls, 10);
+	digester.update(std::string(buf_with_nuls + 10,
+	    buf_with_nuls_size - 10));
+	if (digester.finalize() == "fb9ebc9cf86de78e9f21f708bb8b8758")
+		cout << "passed." << endl;
+	else
+		cout << "failed." << endl;
+
+	cout << "Text::Digester, reused with a stream: ";
+	std::istringstream stream(secret_str);
+	digester.update(stream);
+	if (digester.finalize() == "169a337d3689cbcfe508778a89419fa6")
+		cout << "passed." << endl;
+	else
+		cout << "failed." << endl;
+
+	cout << "Text::Digester, unsupported digest: ";
+	try {
+		Text::Digester bogus("not-a-digest");
+		cout << "failed." << endl;
+	} catch (Error::NotImplemented &) {
+		cout << "passed." << endl;
+	}
+
+	/* Reference values from xxhsum */
+	cout << "Text::digest(XXH64): ";
+	std::string alphabet;
+	for (int i = 0; i < 4; i++)
+		alphabet += "abcdefghijklmnopqrstuvwxyz";
+	Text::Digester xxh64(Text::Digester::XXH64);
+	for (const auto c : alphabet)
+		xxh64.update(&c, 1);
+	if ((Text::digest("", Text::Digester::XXH64) == "ef46db3751d8e999") &&
+	    (Text::digest("abc", Text::Digester::XXH64) ==
+	    "44bc2cf5ad770999") &&
+	    (xxh64.finalize() == Text::digest(alphabet,
+	    Text::Digester::XXH64)))
+		cout << "passed." << endl;
+	else
+		cout << "failed." << endl;
+
+	cout << "Text::digestBatch(): ";
+	std::vector<Memory::uint8Array> records(10000);
+	for (size_t i = 0; i < records.size(); i++) {
+		records[i].resize(4096);
+		for (size_t j = 0; j < records[i].size(); j++)
+			records[i][j] = static_cast<uint8_t>(i + j);
+	}
+	for (const auto &name : {std::string("md5"), Text::Digester::XXH64}) {
+		Time::Timer serialTimer, batchTimer;
+		std::vector<std::string> serial;
+		serialTimer.start();
+		for (const auto &record : records)
+			serial.push_back(Text::digest(record, record.size(),
+			    name));
+		serialTimer.stop();
+		batchTimer.start();
+		const auto batch = Text::digestBatch(records, name, 4);
+		batchTimer.stop();
+		cout << (batch == serial ? "passed" : "failed") << " (" <<
+		    name << ": " << serialTimer.elapsed() << "µs serial, " <<
+		    batchTimer.elapsed() << "µs batch) ";
+	}
+	cout << endl;
+
+	cout << "Text::encodeHex(): ";
+	const uint8_t bytes[] = {0x00, 0x1f, 0xa0, 0xff};
+	if (Text::encodeHex(bytes, sizeof(bytes)) == "001fa0ff")
+		cout << "passed." << endl;
+	else
+		cout << "failed." << endl;
+
+	cout << endl;
 	
 	cout << "Text::split()" << endl;
 	string split_str1 = "This is, a string, split on commas.";
@@ -0,0 +1,265 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <be_error_exception.h>
+#include <be_time_histogram.h>
+#include <be_time_timer.h>
+
+using namespace std;
+namespace BE = BiometricEvaluation;
+
+/** Logsheet that remembers the last entry written. */
+class CapturingLogsheet : public BE::IO::Logsheet
+{
+public:
+	void
+	write(
+	    const std::string &entry)
+	    override
+	{
+		this->lastEntry = entry;
+	}
+
+	std::string lastEntry;
+};
+
+static bool
+testEmpty()
+{
+	cout << "Query an empty Histogram... ";
+	BE::Time::Histogram histogram;
+	if ((histogram.getCount() != 0) || (histogram.getMin() != 0) ||
+	    (histogram.getMax() != 0) || (histogram.getPercentile(50) != 0)) {
+		cout << "failed" << endl;
+		return (false);
+	}
+	cout << "passed" << endl;
+	return (true);
+}
+
+static bool
+testAccuracy()
+{
+	cout << "Record values across the range... ";
+	BE::Time::Histogram histogram;
+	for (uint64_t value = 1; value != 0; value <<= 1) {
+		for (uint64_t offset : {UINT64_C(0), value / 3}) {
+			BE::Time::Histogram single;
+			single.record(value + offset);
+			const uint64_t reported = single.getPercentile(50);
+			const uint64_t recorded = value + offset;
+			/* Bucket upper bound is no more than 1/32 too large */
+			if ((reported < recorded) ||
+			    ((reported - recorded) > (recorded / 32))) {
+				cout << "failed (recorded " << recorded <<
+				    ", reported " << reported << ")" << endl;
+				return (false);
+			}
+			histogram.record(value + offset);
+		}
+	}
+	histogram.record(UINT64_MAX);
+	if ((histogram.getMax() != UINT64_MAX) ||
+	    (histogram.getPercentile(100) != UINT64_MAX) ||
+	    (histogram.getMin() != 1)) {
+		cout << "failed (extremes)" << endl;
+		return (false);
+	}
+	cout << "passed" << endl;
+
+	cout << "Compute percentiles... ";
+	histogram.reset();
+	for (uint64_t value = 1; value <= 1000; value++)
+		histogram.record(value);
+	const uint64_t p50 = histogram.getPercentile(50);
+	const uint64_t p99 = histogram.getPercentile(99);
+	if ((histogram.getCount() != 1000) || (histogram.getMean() != 500.5) ||
+	    (p50 < 500) || (p50 > 500 + (500 / 32)) ||
+	    (p99 < 990) || (p99 > 990 + (990 / 32)) ||
+	    (histogram.getPercentile(100) != 1000) ||
+	    (histogram.getPercentile(0) != 1)) {
+		cout << "failed (" << histogram.toString() << ")" << endl;
+		return (false);
+	}
+	cout << "passed" << endl;
+	cout << "\t" << histogram.toString() << endl;
+
+	cout << "Request an invalid percentile... ";
+	try {
+		histogram.getPercentile(100.1);
+		cout << "failed" << endl;
+		return (false);
+	} catch (const BE::Error::ParameterError &) {
+		cout << "passed" << endl;
+	}
+
+	return (true);
+}
+
+static bool
+testConcurrentRecord()
+{
+	static const uint64_t ThreadCount = 8;
+	static const uint64_t RecordCount = 100000;
+
+	cout << "Record from " << ThreadCount << " threads... ";
+	BE::Time::Histogram histogram;
+	std::vector<std::thread> threads;
+	for (uint64_t t = 0; t < ThreadCount; t++)
+		threads.emplace_back([&histogram, t]() {
+			for (uint64_t i = 1; i <= RecordCount; i++)
+				histogram.record(i * (t + 1));
+		});
+	for (auto &thread : threads)
+		thread.join();
+
+	if ((histogram.getCount() != (ThreadCount * RecordCount)) ||
+	    (histogram.getMin() != 1) ||
+	    (histogram.getMax() != (ThreadCount * RecordCount))) {
+		cout << "failed (" << histogram.toString() << ")" << endl;
+		return (false);
+	}
+	cout << "passed" << endl;
+	return (true);
+}
+
+static bool
+testMergeAndSerialize()
+{
+	cout << "Merge Histograms... ";
+	BE::Time::Histogram low, high, all;
+	for (uint64_t value = 1; value <= 500; value++) {
+		low.record(value);
+		all.record(value);
+	}
+	for (uint64_t value = 501; value <= 1000; value++) {
+		high.record(value);
+		all.record(value);
+	}
+	BE::Time::Histogram merged(low);
+	merged.merge(high);
+	if (merged.toString() != all.toString()) {
+		cout << "failed (" << merged.toString() << " vs. " <<
+		    all.toString() << ")" << endl;
+		return (false);
+	}
+	cout << "passed" << endl;
+
+	cout << "Serialize and deserialize a Histogram... ";
+	try {
+		/* As if received from another process */
+		const BE::Memory::uint8Array serialized = high.serialize();
+		BE::Time::Histogram received(low);
+		received.merge(BE::Time::Histogram(serialized));
+		if (received.toString() != all.toString()) {
+			cout << "failed (" << received.toString() << ")" <<
+			    endl;
+			return (false);
+		}
+		cout << "passed (" << serialized.size() << " bytes)" << endl;
+	} catch (BE::Error::Exception &e) {
+		cout << "failed (" << e.whatString() << ")" << endl;
+		return (false);
+	}
+
+	cout << "Deserialize a corrupt Histogram... ";
+	BE::Memory::uint8Array corrupt = high.serialize();
+	corrupt.resize(corrupt.size() - 1);
+	try {
+		BE::Time::Histogram histogram(corrupt);
+		cout << "failed" << endl;
+		return (false);
+	} catch (const BE::Error::ParameterError &) {
+		cout << "passed" << endl;
+	}
+
+	return (true);
+}
+
+static bool
+testOverhead()
+{
+	static const uint64_t RecordCount = 10000000;
+
+	cout << "Time " << RecordCount << " records... ";
+	BE::Time::Histogram histogram;
+	BE::Time::Timer timer;
+	timer.start();
+	for (uint64_t i = 0; i < RecordCount; i++)
+		histogram.record(i);
+	timer.stop();
+
+	const double perRecord = timer.elapsed(true) /
+	    static_cast<double>(RecordCount);
+	if (perRecord >= 1000) {
+		cout << "failed (" << perRecord << " ns/record)" << endl;
+		return (false);
+	}
+	cout << "passed (" << perRecord << " ns/record)" << endl;
+
+	cout << "Record a Timer into a Histogram... ";
+	histogram.reset();
+	timer.start();
+	timer.stop(histogram);
+	if ((histogram.getCount() != 1) ||
+	    (histogram.getMax() != timer.elapsed(true))) {
+		cout << "failed" << endl;
+		return (false);
+	}
+	cout << "passed" << endl;
+
+	return (true);
+}
+
+static bool
+testLogsheet()
+{
+	cout << "Write a Histogram to a Logsheet... ";
+	BE::Time::Histogram histogram;
+	for (uint64_t value = 1; value <= 100; value++)
+		histogram.record(value);
+
+	CapturingLogsheet logsheet;
+	histogram.writeToLogsheet(logsheet, "match (ns)");
+	if (logsheet.lastEntry != ("match (ns): " + histogram.toString())) {
+		cout << "failed (" << logsheet.lastEntry << ")" << endl;
+		return (false);
+	}
+	cout << "passed" << endl;
+	cout << "\t" << logsheet.lastEntry << endl;
+	return (true);
+}
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+	if (!testEmpty())
+		return (EXIT_FAILURE);
+	if (!testAccuracy())
+		return (EXIT_FAILURE);
+	if (!testConcurrentRecord())
+		return (EXIT_FAILURE);
+	if (!testMergeAndSerialize())
+		return (EXIT_FAILURE);
+	if (!testOverhead())
+		return (EXIT_FAILURE);
+	if (!testLogsheet())
+		return (EXIT_FAILURE);
+
+	return (EXIT_SUCCESS);
+}
@@ -202,4 +202,30 @@ int main(int argc, char *argv[])
 		return (EXIT_FAILURE);
 
 	delete Indy;
+
+	/*
+	 * Test the per-thread watchdogs.
+	 */
+	for (const auto type : {Time::Watchdog::THREADTIME,
+	    Time::Watchdog::THREADREALTIME}) {
+		cout << "Creating Watchdog object with type " <<
+		    (type == Time::Watchdog::THREADTIME ? "THREADTIME" :
+		    "THREADREALTIME") << ": ";
+		try {
+			Indy = new Time::Watchdog(type);
+		} catch (const Error::NotImplemented &) {
+			cout << "not implemented on this platform." << endl;
+			continue;
+		} catch (Error::Exception &e) {
+			cout << "failed." << endl;
+			cout << "Caught " << e.what() << ".\n";
+			return (EXIT_FAILURE);
+		}
+		cout << "success." << endl;
+		if (testWatchdog(Indy) != 0)
+			return (EXIT_FAILURE);
+		if (testWatchdogAndSignalManager(Indy) != 0)
+			return (EXIT_FAILURE);
+		delete Indy;
+	}
 }
@@ -8,6 +8,7 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -82,6 +83,22 @@ main(int argc, char* argv[])
 	cout << "Audio Count: " << pvc->getAudioCount() << endl;
 	cout << "Video Count: " << pvc->getVideoCount() << endl;
 
+	cout << "Construct the same program stream by mapping the file: ";
+	try {
+		Video::Container mappedContainer(filename);
+		if ((mappedContainer.getAudioCount() ==
+		    pvc->getAudioCount()) &&
+		    (mappedContainer.getVideoCount() ==
+		    pvc->getVideoCount()) &&
+		    (mappedContainer.getVideoStream(1)->getFrame(1).data ==
+		    pvc->getVideoStream(1)->getFrame(1).data))
+			cout << "Success." << endl;
+		else
+			cout << "Fail; contents differ." << endl;
+	} catch (Error::Exception &e) {
+		cout << "Caught: " << e.whatString() << endl;
+	}
+
 
 	std::unique_ptr<Video::Stream> stream;
 	cout << "Attempt to open invalid video stream index: ";
@@ -112,10 +129,18 @@ main(int argc, char* argv[])
 	    << "saving first 50: ";
 	cout.flush();
 	uint64_t count = 0;
+	uint64_t earlyNum = 10;
+	uint64_t lateNum =
+	    (expectedCount > 20 ? expectedCount - 10 : expectedCount);
+	Video::Frame earlyFrame, lateFrame;
 	for (uint64_t f = 1; f <= expectedCount; f++) {
 		try {
 			auto frame = stream->getFrame(f);
 			count++;
+			if (f == earlyNum)
+				earlyFrame = frame;
+			if (f == lateNum)
+				lateFrame = frame;
 			if (count <= 50)
 				savePBM(frame, "frame-", "P6", "ppm", f);
 		} catch (Error::ParameterError &e) {
@@ -131,6 +156,35 @@ main(int argc, char* argv[])
 		cout << "Fail; ";
 	cout << "found " << count << " frames." << endl;
 
+	/*
+	 * Jump backwards and forwards within the stream, comparing against
+	 * the frames that were decoded sequentially.
+	 */
+	cout << "Randomly access frames " << lateNum << ", " << earlyNum
+	    << ", " << lateNum << ": ";
+	success = true;
+	try {
+		for (auto f : {lateNum, earlyNum, lateNum}) {
+			auto frame = stream->getFrame(f);
+			const Video::Frame &expected =
+			    (f == earlyNum ? earlyFrame : lateFrame);
+			if ((frame.timestamp != expected.timestamp) ||
+			    (frame.data.size() != expected.data.size()) ||
+			    !std::equal(frame.data.begin(), frame.data.end(),
+			    expected.data.begin())) {
+				cout << "Frame " << f << " differs; ";
+				success = false;
+			}
+		}
+	} catch (Error::Exception &e) {
+		cout << "Caught: " << e.whatString() << "; ";
+		success = false;
+	}
+	if (success)
+		cout << "Success." << endl;
+	else
+		cout << "Fail." << endl;
+
 	/*
 	 * Read a few frames in reverse order.
 	 */
@@ -181,6 +235,53 @@ main(int argc, char* argv[])
 		cout << "Fail." << endl;
 	}
 
+	/*
+	 * Pull every frame through the same Frame object.
+	 */
+	stream->setFrameScale(1.0, 1.0);
+	stream->setFramePixelFormat(Image::PixelFormat::RGB24);
+	stream->setFrameScalingAlgorithm(
+	    Video::ScalingAlgorithm::FastBilinear);
+	cout << "Read all frames from the first stream with getNextFrame(): ";
+	try {
+		Video::Frame frame = stream->getFrame(1);
+		count = 1;
+		while (stream->getNextFrame(frame))
+			count++;
+		if (count == expectedCount)
+			cout << "Success; ";
+		else
+			cout << "Fail; ";
+		cout << "found " << count << " frames." << endl;
+	} catch (Error::Exception &e) {
+		cout << "Caught: " << e.whatString() << endl;
+		cout << "Fail." << endl;
+	}
+
+	/*
+	 * Process a sequence of frames without retaining them.
+	 */
+	cout << "Process sequence of frames between time stamps ["
+	    << startTS << " - " << endTS << "] with a callback: ";
+	try {
+		uint64_t seen = 0;
+		auto processed = stream->processFrameSequence(startTS, endTS,
+		    [&](const Video::Frame &frame) -> bool {
+			if (seen == 0)
+				savePBM(frame, "cb-", "P6", "ppm", 1);
+			seen++;
+			return (true);
+		});
+		if ((processed == seen) && (seen > 0))
+			cout << "Success; ";
+		else
+			cout << "Fail; ";
+		cout << "processed " << processed << " frames." << endl;
+	} catch (Error::Exception &e) {
+		cout << "Caught: " << e.whatString() << endl;
+		cout << "Fail." << endl;
+	}
+
 	return (EXIT_SUCCESS);
 }
 
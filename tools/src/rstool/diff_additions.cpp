@@ -0,0 +1,512 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include <be_error_exception.h>
+#include <be_io_archiverecstore.h>
+#include <be_memory_autoarray.h>
+
+#include <diff_additions.h>
+
+namespace BE = BiometricEvaluation;
+
+/** Bytes read from each archive at a time */
+static const uint64_t ARCHIVE_CHUNK_SIZE{1024 * 1024};
+
+/** A key to compare. */
+struct DiffItem
+{
+	/** Position of the key in the comparison, for ordering output */
+	uint64_t index;
+	/** The key */
+	std::string key;
+	/** Location of the key in the source archive, if archives */
+	ArchiveRegion source;
+	/** Location of the key in the target archive, if archives */
+	ArchiveRegion target;
+};
+
+/** Outcome of comparing one key. */
+struct DiffResult
+{
+	/** Whether a difference or error was found */
+	bool differ{false};
+	/** Text for stdout */
+	std::string out{};
+	/** Text for stderr */
+	std::string err{};
+};
+
+/**
+ * @brief
+ * Keys waiting to be compared, and comparisons waiting to be printed.
+ * @details
+ * The queue of keys is bounded so that a fast key walk cannot get far
+ * ahead of the comparisons. Results are printed in key order.
+ */
+class DiffQueue
+{
+public:
+	DiffQueue(
+	    size_t capacity) :
+	    _capacity{capacity}
+	{
+
+	}
+
+	/** Add a key to compare, waiting for room if needed. */
+	void
+	push(
+	    DiffItem &&item)
+	{
+		std::unique_lock<std::mutex> lock(this->_mutex);
+		this->_notFull.wait(lock, [&]() {
+			return (this->_items.size() < this->_capacity); });
+		this->_items.push_back(std::move(item));
+		this->_notEmpty.notify_one();
+	}
+
+	/**
+	 * @brief
+	 * Obtain the next key to compare.
+	 *
+	 * @return
+	 * false if there are no more keys to compare.
+	 */
+	bool
+	pop(
+	    DiffItem &item)
+	{
+		std::unique_lock<std::mutex> lock(this->_mutex);
+		this->_notEmpty.wait(lock, [&]() {
+			return (!this->_items.empty() || this->_closed); });
+		if (this->_items.empty())
+			return (false);
+		item = std::move(this->_items.front());
+		this->_items.pop_front();
+		this->_notFull.notify_one();
+		return (true);
+	}
+
+	/** No more keys will be pushed. */
+	void
+	close()
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_closed = true;
+		this->_notEmpty.notify_all();
+	}
+
+	/** Print results in order, once all earlier results are in. */
+	void
+	report(
+	    uint64_t index,
+	    DiffResult &&result)
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_results.emplace(index, std::move(result));
+		for (auto next = this->_results.find(this->_nextIndex);
+		    next != this->_results.end();
+		    next = this->_results.find(this->_nextIndex)) {
+			if (next->second.differ)
+				this->_differ = true;
+			std::cout << next->second.out;
+			std::cerr << next->second.err;
+			this->_results.erase(next);
+			this->_nextIndex++;
+		}
+	}
+
+	/** @return Whether any difference or error was reported. */
+	bool
+	differ()
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		return (this->_differ);
+	}
+
+private:
+	const size_t _capacity;
+	std::mutex _mutex;
+	std::condition_variable _notFull;
+	std::condition_variable _notEmpty;
+	std::deque<DiffItem> _items{};
+	bool _closed{false};
+
+	std::map<uint64_t, DiffResult> _results{};
+	uint64_t _nextIndex{0};
+	bool _differ{false};
+};
+
+/** Names printed in differences. */
+struct DiffNames
+{
+	std::string sourcePath;
+	std::string targetPath;
+	std::string method;
+};
+
+static DiffResult
+existenceResult(
+    const std::string &key,
+    bool sourceExists,
+    bool targetExists,
+    const DiffNames &names)
+{
+	DiffResult result;
+	if (sourceExists && targetExists)
+		return (result);
+
+	result.differ = true;
+	if (!sourceExists && !targetExists)
+		result.out = key + ": not found.\n";
+	else if (sourceExists)
+		result.out = key + ": only in " + names.sourcePath + '\n';
+	else
+		result.out = key + ": only in " + names.targetPath + '\n';
+	return (result);
+}
+
+static DiffResult
+differResult(
+    const std::string &key,
+    const std::string &reason,
+    const DiffNames &names)
+{
+	DiffResult result;
+	result.differ = true;
+	result.out = key + ':' + names.sourcePath + " and " + key + ':' +
+	    names.targetPath + " differ (" + reason + ")\n";
+	return (result);
+}
+
+static DiffResult
+errorResult(
+    const std::string &key,
+    const std::string &reason)
+{
+	DiffResult result;
+	result.differ = true;
+	result.err = "Could not diff " + key + " (" + reason + ")\n";
+	return (result);
+}
+
+/** Compare a key by reading both RecordStores. */
+static DiffResult
+compareRecords(
+    BE::IO::RecordStore &sourceRS,
+    BE::IO::RecordStore &targetRS,
+    const std::string &key,
+    const DiffNames &names)
+{
+	bool sourceExists{true}, targetExists{true};
+	uint64_t sourceLength{0}, targetLength{0};
+	try {
+		try {
+			sourceLength = sourceRS.length(key);
+		} catch (BE::Error::ObjectDoesNotExist &) {
+			sourceExists = false;
+		}
+		try {
+			targetLength = targetRS.length(key);
+		} catch (BE::Error::ObjectDoesNotExist &) {
+			targetExists = false;
+		}
+		if (!sourceExists || !targetExists)
+			return (existenceResult(key, sourceExists,
+			    targetExists, names));
+
+		if (sourceLength != targetLength)
+			return (differResult(key, "size", names));
+
+		/* Equal bytes are equal checksums; no need to compute them */
+		const BE::Memory::uint8Array sourceBuf = sourceRS.read(key);
+		if (sourceBuf.size() != sourceLength)
+			throw BE::Error::StrategyError("Source size");
+		const BE::Memory::uint8Array targetBuf = targetRS.read(key);
+		if (targetBuf.size() != targetLength)
+			throw BE::Error::StrategyError("Target size");
+		if ((sourceLength != 0) && (std::memcmp(sourceBuf,
+		    targetBuf, sourceLength) != 0))
+			return (differResult(key, names.method, names));
+	} catch (BE::Error::Exception &e) {
+		return (errorResult(key, e.whatString()));
+	}
+
+	return (DiffResult());
+}
+
+/** Compare a key by reading regions of both archive files. */
+static DiffResult
+compareRegions(
+    std::ifstream &sourceArchive,
+    std::ifstream &targetArchive,
+    BE::Memory::uint8Array &sourceChunk,
+    BE::Memory::uint8Array &targetChunk,
+    const DiffItem &item,
+    const DiffNames &names)
+{
+	sourceArchive.clear();
+	targetArchive.clear();
+	sourceArchive.seekg(item.source.offset);
+	targetArchive.seekg(item.target.offset);
+
+	/* Stop reading at the first differing chunk */
+	for (uint64_t remaining = item.source.size; remaining > 0; ) {
+		const uint64_t size = std::min(remaining, ARCHIVE_CHUNK_SIZE);
+		sourceArchive.read(reinterpret_cast<char*>(&sourceChunk[0]),
+		    size);
+		targetArchive.read(reinterpret_cast<char*>(&targetChunk[0]),
+		    size);
+		if (!sourceArchive || !targetArchive)
+			return (errorResult(item.key, "Could not read archive"));
+		if (std::memcmp(sourceChunk, targetChunk, size) != 0)
+			return (differResult(item.key, names.method, names));
+		remaining -= size;
+	}
+
+	return (DiffResult());
+}
+
+ArchiveManifest
+readArchiveManifest(
+    const std::string &manifestPath)
+{
+	std::ifstream manifest(manifestPath);
+	if (!manifest)
+		throw BE::Error::FileError("Could not open " + manifestPath);
+
+	/* Entries are "key size offset"; the last entry for a key wins */
+	ArchiveManifest contents;
+	std::string line;
+	while (std::getline(manifest, line)) {
+		const std::string::size_type offsetStart = line.rfind(' ');
+		if ((offsetStart == std::string::npos) || (offsetStart == 0))
+			throw BE::Error::FileError(line);
+		const std::string::size_type sizeStart = line.rfind(' ',
+		    offsetStart - 1);
+		if ((sizeStart == std::string::npos) || (sizeStart == 0))
+			throw BE::Error::FileError(line);
+
+		const std::string key = line.substr(0, sizeStart);
+		ArchiveRegion region;
+		long offset;
+		try {
+			region.size = std::stoull(line.substr(sizeStart + 1,
+			    offsetStart - sizeStart - 1));
+			offset = std::stol(line.substr(offsetStart + 1));
+		} catch (std::exception &) {
+			throw BE::Error::FileError(line);
+		}
+
+		if (offset == RSTool::OFFSET_RECORD_REMOVED) {
+			contents.regions.erase(key);
+			continue;
+		}
+		region.offset = offset;
+		contents.keys.push_back(key);
+		contents.regions[key] = region;
+	}
+	if (!manifest.eof())
+		throw BE::Error::FileError("Could not read " + manifestPath);
+
+	/* Keep the first position of keys that were not removed */
+	std::vector<std::string> keys;
+	std::unordered_set<std::string> seen;
+	keys.reserve(contents.regions.size());
+	for (const auto &key : contents.keys)
+		if ((contents.regions.find(key) != contents.regions.end()) &&
+		    seen.insert(key).second)
+			keys.push_back(key);
+	contents.keys.swap(keys);
+
+	return (contents);
+}
+
+/** @return Whether two paths name the same file. */
+static bool
+isSameFile(
+    const std::string &first,
+    const std::string &second)
+{
+	struct stat firstStat, secondStat;
+	if ((stat(first.c_str(), &firstStat) != 0) ||
+	    (stat(second.c_str(), &secondStat) != 0))
+		return (false);
+	return ((firstStat.st_dev == secondStat.st_dev) &&
+	    (firstStat.st_ino == secondStat.st_ino));
+}
+
+/** Compare two ArchiveRecordStores using their manifests. */
+static int
+diffArchives(
+    const std::shared_ptr<BE::IO::ArchiveRecordStore> &sourceRS,
+    const std::shared_ptr<BE::IO::ArchiveRecordStore> &targetRS,
+    const std::vector<std::string> &keys,
+    const DiffNames &names,
+    unsigned int threadCount)
+{
+	ArchiveManifest sourceManifest, targetManifest;
+	try {
+		sourceManifest = readArchiveManifest(
+		    sourceRS->getManifestName());
+		targetManifest = readArchiveManifest(
+		    targetRS->getManifestName());
+	} catch (BE::Error::Exception &e) {
+		std::cerr << "Could not read manifest (" << e.whatString() <<
+		    ')' << std::endl;
+		return (EXIT_FAILURE);
+	}
+	const std::string sourceArchivePath = sourceRS->getArchiveName();
+	const std::string targetArchivePath = targetRS->getArchiveName();
+	const bool sameArchive = isSameFile(sourceArchivePath,
+	    targetArchivePath);
+
+	DiffQueue queue(threadCount * 64);
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < threadCount; i++) {
+		workers.emplace_back([&]() {
+			std::ifstream sourceArchive(sourceArchivePath,
+			    std::ios::binary);
+			std::ifstream targetArchive(targetArchivePath,
+			    std::ios::binary);
+			BE::Memory::uint8Array sourceChunk(ARCHIVE_CHUNK_SIZE);
+			BE::Memory::uint8Array targetChunk(ARCHIVE_CHUNK_SIZE);
+			DiffItem item;
+			while (queue.pop(item))
+				queue.report(item.index, compareRegions(
+				    sourceArchive, targetArchive, sourceChunk,
+				    targetChunk, item, names));
+		});
+	}
+
+	/* Existence and size come from the manifests alone */
+	const std::vector<std::string> &visit = (keys.empty() ?
+	    sourceManifest.keys : keys);
+	uint64_t index{0};
+	for (const auto &key : visit) {
+		const auto source = sourceManifest.regions.find(key);
+		const auto target = targetManifest.regions.find(key);
+		const bool sourceExists = (source !=
+		    sourceManifest.regions.end());
+		const bool targetExists = (target !=
+		    targetManifest.regions.end());
+		if (!sourceExists || !targetExists)
+			queue.report(index, existenceResult(key, sourceExists,
+			    targetExists, names));
+		else if (source->second.size != target->second.size)
+			queue.report(index, differResult(key, "size", names));
+		else if ((source->second.size == 0) || (sameArchive &&
+		    (source->second.offset == target->second.offset)))
+			queue.report(index, DiffResult());
+		else
+			queue.push({index, key, source->second,
+			    target->second});
+		index++;
+	}
+
+	queue.close();
+	for (auto &worker : workers)
+		worker.join();
+
+	return (queue.differ() ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+int
+diffRecordStores(
+    const std::shared_ptr<BE::IO::RecordStore> &sourceRS,
+    const std::shared_ptr<BE::IO::RecordStore> &targetRS,
+    const std::vector<std::string> &keys,
+    const std::string &methodName,
+    unsigned int threadCount)
+{
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	const DiffNames names{sourceRS->getPathname(),
+	    targetRS->getPathname(), methodName};
+
+	const auto sourceArchive = std::dynamic_pointer_cast<
+	    BE::IO::ArchiveRecordStore>(sourceRS);
+	const auto targetArchive = std::dynamic_pointer_cast<
+	    BE::IO::ArchiveRecordStore>(targetRS);
+	if (sourceArchive && targetArchive)
+		return (diffArchives(sourceArchive, targetArchive, keys, names,
+		    threadCount));
+
+	/* RecordStores are not thread-safe; each thread opens its own */
+	std::vector<std::pair<std::shared_ptr<BE::IO::RecordStore>,
+	    std::shared_ptr<BE::IO::RecordStore>>> copies;
+	try {
+		for (unsigned int i = 0; i < threadCount; i++)
+			copies.emplace_back(
+			    BE::IO::RecordStore::openRecordStore(
+			    names.sourcePath, BE::IO::Mode::ReadOnly),
+			    BE::IO::RecordStore::openRecordStore(
+			    names.targetPath, BE::IO::Mode::ReadOnly));
+	} catch (BE::Error::Exception &e) {
+		std::cerr << "Could not open RecordStores (" <<
+		    e.whatString() << ')' << std::endl;
+		return (EXIT_FAILURE);
+	}
+
+	DiffQueue queue(threadCount * 64);
+	std::vector<std::thread> workers;
+	for (auto &copy : copies) {
+		workers.emplace_back([&]() {
+			DiffItem item;
+			while (queue.pop(item))
+				queue.report(item.index, compareRecords(
+				    *copy.first, *copy.second, item.key,
+				    names));
+		});
+	}
+
+	/* Stream keys instead of collecting them first */
+	uint64_t index{0};
+	if (keys.empty()) {
+		std::string key;
+		for (;;) {
+			try {
+				key = sourceRS->sequenceKey();
+			} catch (BE::Error::ObjectDoesNotExist &) {
+				/* End of sequence */
+				break;
+			} catch (BE::Error::Exception &e) {
+				queue.report(index, errorResult("keys",
+				    e.whatString()));
+				break;
+			}
+			queue.push({index++, key, {}, {}});
+		}
+	} else {
+		for (const auto &key : keys)
+			queue.push({index++, key, {}, {}});
+	}
+
+	queue.close();
+	for (auto &worker : workers)
+		worker.join();
+
+	return (queue.differ() ? EXIT_FAILURE : EXIT_SUCCESS);
+}
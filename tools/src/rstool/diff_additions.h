@@ -0,0 +1,104 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+/*
+ * diff_additions - compare RecordStores on many threads, reading archive
+ *                  files directly when both RecordStores are archives.
+ */
+
+#ifndef __RSTOOL_DIFF_ADDITIONS_H__
+#define __RSTOOL_DIFF_ADDITIONS_H__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <be_io_recordstore.h>
+
+namespace RSTool
+{
+	/* Constants cloned from be_io_archiverecstore_impl.h */
+	const long OFFSET_RECORD_REMOVED{-1};
+}
+
+/** Location of a record within an archive file. */
+struct ArchiveRegion
+{
+	/** Offset of the record from the start of the archive file */
+	uint64_t offset;
+	/** Size of the record */
+	uint64_t size;
+};
+
+/** Contents of an ArchiveRecordStore manifest. */
+struct ArchiveManifest
+{
+	/** Keys, in the order they were first added */
+	std::vector<std::string> keys;
+	/** Location of each key in keys */
+	std::unordered_map<std::string, ArchiveRegion> regions;
+};
+
+/**
+ * @brief
+ * Read the manifest of an ArchiveRecordStore without opening it.
+ *
+ * @param manifestPath
+ *	Path to the manifest file.
+ *
+ * @return
+ *	Records that have not been removed.
+ *
+ * @throw Error::FileError
+ *	Could not read or parse the manifest.
+ */
+ArchiveManifest
+readArchiveManifest(
+    const std::string &manifestPath);
+
+/**
+ * @brief
+ * Compare the records of two RecordStores, on multiple threads.
+ * @details
+ * Records are compared first by existence, then by size, and only then
+ * by content, stopping at the first differing byte. Keys are streamed
+ * from the source RecordStore, so the key list need not fit in memory,
+ * and each thread reads from its own read-only copies of the
+ * RecordStores. When both RecordStores are ArchiveRecordStores, the
+ * manifests are compared first, and only the regions of the archive
+ * files holding same-sized records are read. Differences are printed
+ * in the order keys were visited, in the same format as a
+ * single-threaded comparison.
+ *
+ * @param sourceRS
+ *	First RecordStore to compare.
+ * @param targetRS
+ *	Second RecordStore to compare.
+ * @param keys
+ *	Keys to compare. If empty, every key in sourceRS is compared.
+ * @param methodName
+ *	Name of the comparison method, printed when contents differ.
+ * @param threadCount
+ *	Number of threads comparing records, or 0 for one per core.
+ *
+ * @return
+ *	EXIT_SUCCESS if no differences were found, EXIT_FAILURE otherwise.
+ */
+int
+diffRecordStores(
+    const std::shared_ptr<BiometricEvaluation::IO::RecordStore> &sourceRS,
+    const std::shared_ptr<BiometricEvaluation::IO::RecordStore> &targetRS,
+    const std::vector<std::string> &keys,
+    const std::string &methodName,
+    unsigned int threadCount);
+
+#endif /* __RSTOOL_DIFF_ADDITIONS_H__ */
@@ -0,0 +1,399 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <dirent.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <be_error.h>
+#include <be_error_exception.h>
+#include <be_image_image.h>
+#include <be_io_utility.h>
+#include <be_text.h>
+
+#include <ingest_additions.h>
+
+namespace BE = BiometricEvaluation;
+
+/** A path found by the directory walk. */
+struct WalkedPath
+{
+	/** Position in the walk */
+	uint64_t index;
+	/** Path to a file */
+	std::string filename;
+	/** Why the walk could not continue, instead of a file */
+	std::string error;
+};
+
+/** A file read (or not) by a reader thread. */
+struct ReadFile
+{
+	/** File and its contents */
+	IngestedFile file;
+	/** Why the file could not be read */
+	std::string error;
+	/** Bytes counted against IngestOptions::maxBytesInFlight */
+	uint64_t reserved{0};
+};
+
+/** State shared by the walker, readers, and writer. */
+class IngestPipeline
+{
+public:
+	IngestPipeline(
+	    const IngestOptions &options,
+	    unsigned int threadCount,
+	    const std::function<std::string(const IngestedFile&)> &hash) :
+	    _options(options),
+	    _pathCapacity{threadCount * 16},
+	    _hash(hash)
+	{
+
+	}
+
+	/** Walk elements, queueing the files found. */
+	void
+	walk(
+	    const std::vector<std::string> &elements)
+	{
+		for (const auto &element : elements) {
+			if (this->_abort)
+				break;
+			if (!BE::IO::Utility::pathIsDirectory(element)) {
+				this->pushPath(element, "");
+				continue;
+			}
+			try {
+				this->walkDirectory(BE::Text::basename(element),
+				    BE::Text::dirname(element));
+			} catch (BE::Error::Exception &e) {
+				this->pushPath(element, "Could not add "
+				    "contents of dir " + element + " - " +
+				    e.whatString());
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_walkDone = true;
+		this->_pathNotEmpty.notify_all();
+		this->_resultReady.notify_all();
+	}
+
+	/** Read and hash queued files until the walk is exhausted. */
+	void
+	read()
+	{
+		WalkedPath path;
+		while (this->popPath(path)) {
+			ReadFile result;
+			result.file.filename = path.filename;
+			result.error = path.error;
+			if (result.error.empty())
+				this->readOne(path.index, result);
+
+			std::lock_guard<std::mutex> lock(this->_mutex);
+			this->_results.emplace(path.index, std::move(result));
+			this->_resultReady.notify_all();
+		}
+	}
+
+	/**
+	 * @brief
+	 * Obtain the next file in walk order.
+	 *
+	 * @return
+	 * false once every walked file has been returned.
+	 */
+	bool
+	next(
+	    ReadFile &result)
+	{
+		std::unique_lock<std::mutex> lock(this->_mutex);
+		this->_resultReady.wait(lock, [&]() {
+			return (this->_abort || (this->_results.find(
+			    this->_nextIndex) != this->_results.end()) ||
+			    (this->_walkDone && (this->_nextIndex ==
+			    this->_walkCount)));
+		});
+		const auto found = this->_results.find(this->_nextIndex);
+		if (this->_abort || (found == this->_results.end()))
+			return (false);
+		result = std::move(found->second);
+		this->_results.erase(found);
+		return (true);
+	}
+
+	/** The file returned from next() is no longer needed. */
+	void
+	release(
+	    const ReadFile &result)
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_bytesInFlight -= result.reserved;
+		this->_nextIndex++;
+		this->_memoryAvailable.notify_all();
+	}
+
+	/** Stop walking and reading as soon as possible. */
+	void
+	abort()
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_abort = true;
+		this->_pathNotFull.notify_all();
+		this->_pathNotEmpty.notify_all();
+		this->_memoryAvailable.notify_all();
+		this->_resultReady.notify_all();
+	}
+
+private:
+	/** Walk a directory recursively, as make has always done. */
+	void
+	walkDirectory(
+	    const std::string &directory,
+	    const std::string &prefix)
+	{
+		const std::string dirpath = prefix + "/" + directory;
+		if (!BE::IO::Utility::fileExists(dirpath))
+			throw BE::Error::ObjectDoesNotExist(dirpath +
+			    " does not exist");
+		DIR *dir = opendir(dirpath.c_str());
+		if (dir == nullptr)
+			throw BE::Error::StrategyError(dirpath +
+			    " could not be opened");
+
+		struct dirent *entry;
+		while (!this->_abort && ((entry = readdir(dir)) != nullptr)) {
+			if (entry->d_ino == 0)
+				continue;
+			if ((strcmp(entry->d_name, ".") == 0) ||
+			    (strcmp(entry->d_name, "..") == 0))
+				continue;
+
+			const std::string filename = dirpath + "/" +
+			    entry->d_name;
+			if (BE::IO::Utility::pathIsDirectory(filename)) {
+				try {
+					this->walkDirectory(entry->d_name,
+					    dirpath);
+				} catch (BE::Error::Exception &) {
+					closedir(dir);
+					throw;
+				}
+			} else {
+				this->pushPath(filename, "");
+			}
+		}
+
+		if (closedir(dir))
+			throw BE::Error::StrategyError("Could not close " +
+			    dirpath + " (" + BE::Error::errorStr() + ")");
+	}
+
+	void
+	pushPath(
+	    const std::string &filename,
+	    const std::string &error)
+	{
+		std::unique_lock<std::mutex> lock(this->_mutex);
+		this->_pathNotFull.wait(lock, [&]() {
+			return (this->_abort ||
+			    (this->_paths.size() < this->_pathCapacity)); });
+		if (this->_abort)
+			return;
+		this->_paths.push_back({this->_walkCount++, filename, error});
+		this->_pathNotEmpty.notify_one();
+	}
+
+	bool
+	popPath(
+	    WalkedPath &path)
+	{
+		std::unique_lock<std::mutex> lock(this->_mutex);
+		this->_pathNotEmpty.wait(lock, [&]() {
+			return (this->_abort || !this->_paths.empty() ||
+			    this->_walkDone); });
+		if (this->_abort || this->_paths.empty())
+			return (false);
+		path = std::move(this->_paths.front());
+		this->_paths.pop_front();
+		this->_pathNotFull.notify_one();
+		return (true);
+	}
+
+	/** Read, validate, and hash one file. */
+	void
+	readOne(
+	    uint64_t index,
+	    ReadFile &result)
+	{
+		uint64_t size;
+		try {
+			size = BE::IO::Utility::getFileSize(
+			    result.file.filename);
+		} catch (BE::Error::Exception &) {
+			result.error = "Could not get file size for " +
+			    result.file.filename;
+			return;
+		}
+
+		/* The next file to insert may always be read */
+		{
+			std::unique_lock<std::mutex> lock(this->_mutex);
+			this->_memoryAvailable.wait(lock, [&]() {
+				return (this->_abort ||
+				    (index == this->_nextIndex) ||
+				    ((this->_bytesInFlight + size) <=
+				    this->_options.maxBytesInFlight));
+			});
+			this->_bytesInFlight += size;
+			result.reserved = size;
+		}
+		if (this->_abort)
+			return;
+
+		try {
+			result.file.contents = BE::IO::Utility::readFile(
+			    result.file.filename);
+		} catch (BE::Error::Exception &) {
+			result.error = "Error reading file (" +
+			    result.file.filename + ')';
+			return;
+		}
+
+		if (this->_options.validateImages && (
+		    BE::Image::Image::getCompressionAlgorithm(
+		    result.file.contents) ==
+		    BE::Image::CompressionAlgorithm::None)) {
+			result.error = result.file.filename + " is not a "
+			    "recognized image";
+			return;
+		}
+
+		try {
+			result.file.hashValue = this->_hash(result.file);
+		} catch (BE::Error::Exception &e) {
+			result.error = "Could not hash " +
+			    result.file.filename + " - " + e.whatString();
+		}
+	}
+
+	const IngestOptions &_options;
+	const size_t _pathCapacity;
+	const std::function<std::string(const IngestedFile&)> &_hash;
+
+	std::mutex _mutex;
+	std::atomic<bool> _abort{false};
+
+	std::condition_variable _pathNotFull;
+	std::condition_variable _pathNotEmpty;
+	std::deque<WalkedPath> _paths{};
+	uint64_t _walkCount{0};
+	bool _walkDone{false};
+
+	std::condition_variable _memoryAvailable;
+	uint64_t _bytesInFlight{0};
+
+	std::condition_variable _resultReady;
+	std::map<uint64_t, ReadFile> _results{};
+	uint64_t _nextIndex{0};
+};
+
+/** Print files and bytes inserted, and their rates. */
+static void
+printProgress(
+    uint64_t files,
+    uint64_t bytes,
+    std::chrono::steady_clock::time_point start,
+    bool final)
+{
+	const double seconds = std::chrono::duration<double>(
+	    std::chrono::steady_clock::now() - start).count();
+	const double mebibytes = bytes / (1024.0 * 1024.0);
+	char line[128];
+	std::snprintf(line, sizeof(line), "%llu files, %.1f MiB in %.0f s "
+	    "(%.0f files/s, %.1f MiB/s)",
+	    static_cast<unsigned long long>(files), mebibytes, seconds,
+	    (seconds > 0 ? files / seconds : 0),
+	    (seconds > 0 ? mebibytes / seconds : 0));
+	std::cerr << '\r' << line << (final ? "\n" : "") << std::flush;
+}
+
+int
+ingestFiles(
+    const std::vector<std::string> &elements,
+    const IngestOptions &options,
+    const std::function<std::string(const IngestedFile&)> &hash,
+    const std::function<int(const IngestedFile&)> &insert)
+{
+	unsigned int threadCount = options.threadCount;
+	if (threadCount == 0)
+		threadCount = 2 * std::max(1u,
+		    std::thread::hardware_concurrency());
+
+	IngestPipeline pipeline(options, threadCount, hash);
+	std::thread walker(&IngestPipeline::walk, &pipeline,
+	    std::cref(elements));
+	std::vector<std::thread> readers;
+	for (unsigned int i = 0; i < threadCount; i++)
+		readers.emplace_back(&IngestPipeline::read, &pipeline);
+
+	int status = EXIT_SUCCESS;
+	uint64_t files{0}, bytes{0};
+	const auto start = std::chrono::steady_clock::now();
+	auto lastProgress = start;
+	ReadFile result;
+	while (pipeline.next(result)) {
+		bool failed = false;
+		if (!result.error.empty()) {
+			std::cerr << result.error << std::endl;
+			failed = true;
+		} else if (insert(result.file) != EXIT_SUCCESS) {
+			failed = true;
+		} else {
+			files++;
+			bytes += result.file.contents.size();
+		}
+		pipeline.release(result);
+
+		if (failed) {
+			status = EXIT_FAILURE;
+			if (options.stopOnError) {
+				pipeline.abort();
+				break;
+			}
+		}
+
+		if (options.showProgress && ((std::chrono::steady_clock::now() -
+		    lastProgress) >= std::chrono::seconds(1))) {
+			lastProgress = std::chrono::steady_clock::now();
+			printProgress(files, bytes, start, false);
+		}
+	}
+
+	walker.join();
+	for (auto &reader : readers)
+		reader.join();
+	if (options.showProgress)
+		printProgress(files, bytes, start, true);
+
+	return (status);
+}
@@ -0,0 +1,82 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+/*
+ * ingest_additions - read and hash files on many threads while inserting
+ *                    them into a RecordStore in order on one thread.
+ */
+
+#ifndef __RSTOOL_INGEST_ADDITIONS_H__
+#define __RSTOOL_INGEST_ADDITIONS_H__
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <be_memory_autoarray.h>
+
+/** Settings for ingestFiles(). */
+struct IngestOptions
+{
+	/** Threads reading files, or 0 for twice the number of cores */
+	unsigned int threadCount{0};
+	/** Most bytes of file contents held in memory at once */
+	uint64_t maxBytesInFlight{256 * 1024 * 1024};
+	/** Reject files that are not images known to the framework */
+	bool validateImages{false};
+	/** Periodically print progress and throughput to stderr */
+	bool showProgress{false};
+	/** Stop at the first file that could not be read or inserted */
+	bool stopOnError{true};
+};
+
+/** A file that has been read, ready to insert. */
+struct IngestedFile
+{
+	/** Path to the file, as built by the directory walk */
+	std::string filename;
+	/** Contents of the file */
+	BiometricEvaluation::Memory::uint8Array contents;
+	/** Value returned from the hash function */
+	std::string hashValue;
+};
+
+/**
+ * @brief
+ * Insert the contents of files and directories into a RecordStore.
+ * @details
+ * One thread walks directories, several threads read and hash files,
+ * and the calling thread inserts files in the order of the walk, so
+ * that RecordStores need not be thread-safe. Directories are walked
+ * recursively, in the same order as readdir(3).
+ *
+ * @param elements
+ *	Paths to files and directories to insert.
+ * @param options
+ *	Pipeline settings.
+ * @param hash
+ *	Function computing IngestedFile::hashValue, run on reader threads.
+ * @param insert
+ *	Function inserting a file, run on the calling thread in walk
+ *	order. Returns EXIT_SUCCESS or EXIT_FAILURE.
+ *
+ * @return
+ *	EXIT_SUCCESS if every file was read and inserted, EXIT_FAILURE
+ *	otherwise.
+ */
+int
+ingestFiles(
+    const std::vector<std::string> &elements,
+    const IngestOptions &options,
+    const std::function<std::string(const IngestedFile&)> &hash,
+    const std::function<int(const IngestedFile&)> &insert);
+
+#endif /* __RSTOOL_INGEST_ADDITIONS_H__ */
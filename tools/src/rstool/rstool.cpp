@@ -37,6 +37,7 @@
 #include <be_text.h>
 #include <be_memory_autoarrayutility.h>
 
+#include <diff_additions.h>
 #include <image_additions.h>
 #include <lrs_additions.h>
 #include <rstool.h>
@@ -136,7 +137,7 @@ void usage(char *exe)
 	std::cerr << "Usage: " << exe << " <action> -s <RS> [options]" <<
 	    std::endl;
 	std::cerr << "Actions: add, display, dump, list, make, merge, remove, "
-	    "rename, version, unhash" << std::endl;
+	    "rename, stats, version, unhash" << std::endl;
 
 	std::cerr << std::endl;
 
@@ -155,6 +156,10 @@ void usage(char *exe)
 	    "exists" << std::endl;
 	std::cerr << "\t-h <hash_rs>\tExisting hash translation RecordStore" <<
 	    std::endl;
+	std::cerr << "\t-i\t\tOnly add files that are images" << std::endl;
+	std::cerr << "\t-j <#>\t\tNumber of threads reading files "
+	    "(default: two per\n\t\t\tcore)" << std::endl;
+	std::cerr << "\t-v\t\tShow progress" << std::endl;
 	std::cerr << "\t-k(fp)\t\tPrint 'f'ilename or file'p'ath of key as "
 	    "value " << std::endl << "\t\t\tin hash translation RecordStore" <<
 	    std::endl;
@@ -173,6 +178,8 @@ void usage(char *exe)
 	std::cerr << "\t-a <file>\tText file with keys to compare" << std::endl;
 	std::cerr << "\t-f\t\tCompare files byte for byte " <<
 	    "(as opposed to checksum)" << std::endl;
+	std::cerr << "\t-j <#>\t\tNumber of threads (default: one per "
+	    "core)" << std::endl;
 	std::cerr << "\t-k <key>\tKey to compare" << std::endl;
 
 	std::cerr << std::endl;
@@ -196,6 +203,9 @@ void usage(char *exe)
 	    "RecordStore" << std::endl;
 	std::cerr << "\t-f\t\tForce insertion even if the same key already "
 	   "exists" << std::endl;
+	std::cerr << "\t-i\t\tOnly add files that are images" << std::endl;
+	std::cerr << "\t-j <#>\t\tNumber of threads reading files "
+	    "(default: two per\n\t\t\tcore)" << std::endl;
 	std::cerr << "\t-k(fp)\t\tPrint 'f'ilename or file'p'ath of key as "
 	   "value " << std::endl << "\t\t\tin hash translation RecordStore" <<
 	    std::endl;
@@ -211,6 +221,7 @@ void usage(char *exe)
 	    "\n\t\t\tWhere type is GZIP" << std::endl;
 	std::cerr << "\t<file> ...\tFiles/dirs to add as a record" << std::endl;
 	std::cerr << "\t-q\t\tSkip the confirmation step" << std::endl;
+	std::cerr << "\t-v\t\tShow progress" << std::endl;
 
 	std::cerr << std::endl;
 
@@ -240,6 +251,17 @@ void usage(char *exe)
 
 	std::cerr << std::endl;
 
+	std::cerr << "Stats Options:" << std::endl;
+	std::cerr << "\t-f\t\tIgnore cached statistics" << std::endl;
+	std::cerr << "\t-i\t\tCount image formats and dimensions" <<
+	    std::endl;
+	std::cerr << "\t-j <#>\t\tNumber of threads (default: one per "
+	    "core)" << std::endl;
+	std::cerr << "\t-s <RS>\t\tRecordStore to summarize (multiple)" <<
+	    std::endl;
+
+	std::cerr << std::endl;
+
 	std::cerr << "Unhash Options:" << std::endl;
 	std::cerr << "\t-h <hash>\tHash to unhash" << std::endl;
 
@@ -315,6 +337,8 @@ Action procargs(int argc, char *argv[])
 		action = Action::REMOVE;
 	else if (BE::Text::caseInsensitiveCompare(argv[1], RENAME_ARG))
 		action = Action::RENAME;
+	else if (strcasecmp(argv[1], STATS_ARG.c_str()) == 0)
+		action = Action::STATS;
 	else if (strcasecmp(argv[1], VERSION_ARG.c_str()) == 0)
 		return Action::VERSION;
 	else if (strcasecmp(argv[1], UNHASH_ARG.c_str()) == 0)
@@ -730,7 +754,8 @@ procargs_make(
     std::vector<std::string> &elements,
     bool &compress,
     BiometricEvaluation::IO::Compressor::Kind &compressorKind,
-    bool &stopOnDuplicate)
+    bool &stopOnDuplicate,
+    IngestOptions &ingestOptions)
 {
 	what_to_hash = HashablePart::NOTHING;
 	hashed_key_format = KeyFormat::DEFAULT;
@@ -806,6 +831,18 @@ procargs_make(
 		case 'h':	/* Hash translation RecordStore */
 			hash_pathname.assign(optarg);
 			break;
+		case 'i':	/* Only insert images */
+			ingestOptions.validateImages = true;
+			break;
+		case 'j':	/* Number of threads reading files */
+			try {
+				ingestOptions.threadCount = std::stoul(optarg);
+			} catch (std::exception &) {
+				std::cerr << "Invalid thread count: " <<
+				    optarg << std::endl;
+				return (EXIT_FAILURE);
+			}
+			break;
 		case 'k':	/* Hash key display type */
 			switch (optarg[0]) {
 			case 'f':	/* Display as file's name */
@@ -844,6 +881,9 @@ procargs_make(
 				return (EXIT_FAILURE);
 			}
 			break;
+		case 'v':	/* Show progress */
+			ingestOptions.showProgress = true;
+			break;
 		case 'z':	/* Compress */
 			compress = true;
 			compressorKind = BE::IO::Compressor::Kind::GZIP;
@@ -1027,37 +1067,37 @@ makeHumanConfirmation(
 	return (EXIT_SUCCESS);
 }
 
-int make_insert_contents(const std::string &filename,
+std::string
+make_hash_contents(
+    const IngestedFile &file,
+    const HashablePart what_to_hash)
+{
+	switch (what_to_hash) {
+	case HashablePart::FILECONTENTS:
+		return (BE::Text::digest(file.contents, file.contents.size()));
+	case HashablePart::FILENAME:
+		return (BE::Text::digest(BE::Text::basename(file.filename)));
+	case HashablePart::FILEPATH:
+		return (BE::Text::digest(file.filename));
+	case HashablePart::NOTHING:
+		/* FALLTHROUGH */
+	default:
+		/* Don't hash */
+		return ("");
+	}
+}
+
+int
+make_insert_contents(
+    const IngestedFile &file,
     const std::shared_ptr<BiometricEvaluation::IO::RecordStore> &rs,
     const std::shared_ptr<BiometricEvaluation::IO::RecordStore> &hash_rs,
-    const HashablePart what_to_hash,
     const KeyFormat hashed_key_format,
     bool stopOnDuplicate)
 {
-	static BE::Memory::uint8Array buffer;
-	static uint64_t buffer_size = 0;
-	static std::ifstream buffer_file;
-
-	try {
-		buffer_size = BE::IO::Utility::getFileSize(filename);
-		buffer.resize(buffer_size);
-	} catch (BE::Error::Exception &e) {
-		std::cerr << "Could not get file size for " << filename <<
-		    std::endl;
-		return (EXIT_FAILURE);
-	}
-
-	/* Extract file into buffer */
-	buffer_file.open(filename.c_str(), std::ifstream::binary);
-	buffer_file.read((char *)&(*buffer), buffer_size);
-	if (buffer_file.bad()) {
-		std::cerr << "Error reading file (" << filename << ')' <<
-		    std::endl;
-		return (EXIT_FAILURE);
-	}
-	buffer_file.close();
-	
-	static std::string key = "", hash_value = "";
+	const std::string &filename = file.filename;
+	const BE::Memory::uint8Array &buffer = file.contents;
+	std::string key;
 	try {
 		key = BE::Text::basename(filename);
 		if (hash_rs.get() == NULL) {
@@ -1074,24 +1114,7 @@ int make_insert_contents(const std::string &filename,
 				rs->replace(key, buffer);
 			}
 		} else {
-			switch (what_to_hash) {
-			case HashablePart::FILECONTENTS:
-				hash_value = BE::Text::digest(buffer,
-				    buffer_size);
-				break;
-			case HashablePart::FILENAME:
-				hash_value = BE::Text::digest(key);
-				break;
-			case HashablePart::FILEPATH:
-				hash_value = BE::Text::digest(filename);
-				break;
-			case HashablePart::NOTHING:
-				/* FALLTHROUGH */
-			default:
-				/* Don't hash */
-				break;
-			}
-
+			const std::string &hash_value = file.hashValue;
 			switch (hashed_key_format) {
 			case KeyFormat::FILENAME:
 				/* Already done */
@@ -1144,59 +1167,6 @@ int make_insert_contents(const std::string &filename,
 	return (EXIT_SUCCESS);
 }
 
-int
-make_insert_directory_contents(
-    const std::string &directory,
-    const std::string &prefix,
-    const std::shared_ptr<BiometricEvaluation::IO::RecordStore> &rs,
-    const std::shared_ptr<BiometricEvaluation::IO::RecordStore> &hash_rs,
-    const HashablePart what_to_hash,
-    const KeyFormat hashed_key_format,
-    bool stopOnDuplicate)
-{
-	struct dirent *entry;
-	DIR *dir = NULL;
-	std::string dirpath, filename;
-
-	dirpath = prefix + "/" + directory;
-	if (!BE::IO::Utility::fileExists(dirpath))
-		throw BE::Error::ObjectDoesNotExist(dirpath + " does not exist");
-	dir = opendir(dirpath.c_str());
-	if (dir == NULL)
-		throw BE::Error::StrategyError(dirpath + " could not be opened");
-	
-	while ((entry = readdir(dir)) != NULL) {
-		if (entry->d_ino == 0)
-			continue;
-		if ((strcmp(entry->d_name, ".") == 0) ||
-		    (strcmp(entry->d_name, "..") == 0))
-			continue;
-
-		filename = dirpath + "/" + entry->d_name;
-
-		/* Recursively remove subdirectories and files */
-		if (BE::IO::Utility::pathIsDirectory(filename)) {
-			if (make_insert_directory_contents(entry->d_name,
-			    dirpath, rs, hash_rs, what_to_hash,
-			    hashed_key_format, stopOnDuplicate) !=
-			    EXIT_SUCCESS)
-				return (EXIT_FAILURE);
-		} else {
-			if (make_insert_contents(filename, rs, hash_rs,
-			    what_to_hash, hashed_key_format,
-			    stopOnDuplicate) != EXIT_SUCCESS)
-				return (EXIT_FAILURE);
-		}
-	}
-
-	if (dir != NULL)
-		if (closedir(dir))
-			throw BE::Error::StrategyError("Could not close " + 
-			    dirpath + " (" + BE::Error::errorStr() + ")");
-
-	return (EXIT_SUCCESS);
-}
-
 int
 makeListRecordStore(
     int argc,
@@ -1298,10 +1268,11 @@ int make(int argc, char *argv[])
 	bool compress = false;
 	BE::IO::Compressor::Kind compressorKind;
 	bool stopOnDuplicate = true;
+	IngestOptions ingestOptions;
 
 	if (procargs_make(argc, argv, description, hash_pathname, what_to_hash,
 	    hashed_key_format, type, elements, compress, compressorKind,
-	    stopOnDuplicate) != EXIT_SUCCESS)
+	    stopOnDuplicate, ingestOptions) != EXIT_SUCCESS)
 		return (EXIT_FAILURE);
 		
 	if (type == BE::IO::RecordStore::Kind::List) {
@@ -1332,32 +1303,18 @@ int make(int argc, char *argv[])
 		return (EXIT_FAILURE);
 	}
 
-	for (unsigned int i = 0; i < elements.size(); i++) {
-		if (BE::IO::Utility::pathIsDirectory(elements[i])) {
-			try {
-				/* Recursively insert contents of directory */
-				if (make_insert_directory_contents(
-				    BE::Text::basename(elements[i]),
-				    BE::Text::dirname(elements[i]),
-				    rs, hash_rs, what_to_hash,
-				    hashed_key_format,
-				    stopOnDuplicate) != EXIT_SUCCESS)
-			    		return (EXIT_FAILURE);
-			} catch (BE::Error::Exception &e) {
-				std::cerr << "Could not add contents of dir " <<
-				    elements[i] << " - " << e.what() <<
-				    std::endl;
-				return (EXIT_FAILURE);
-			}
-		} else {
-			if (make_insert_contents(elements[i], rs, hash_rs,
-			    what_to_hash, hashed_key_format,
-			    stopOnDuplicate) != EXIT_SUCCESS)
-				return (EXIT_FAILURE);
-		}
-	}
-
-	return (EXIT_SUCCESS);
+	/* Files are read on many threads, but inserted on this one */
+	ingestOptions.stopOnError = true;
+	return (ingestFiles(elements, ingestOptions,
+	    [&](const IngestedFile &file) {
+		if (hash_rs.get() == NULL)
+			return (std::string());
+		return (make_hash_contents(file, what_to_hash));
+	    },
+	    [&](const IngestedFile &file) {
+		return (make_insert_contents(file, rs, hash_rs,
+		    hashed_key_format, stopOnDuplicate));
+	    }));
 }
 
 int
@@ -1680,7 +1637,8 @@ procargs_add(
     std::vector<std::string> &files,
     HashablePart &what_to_hash,
     KeyFormat &hashed_key_format,
-    bool &stopOnDuplicate)
+    bool &stopOnDuplicate,
+    IngestOptions &ingestOptions)
 {
 	what_to_hash = HashablePart::NOTHING;
 	hashed_key_format = KeyFormat::DEFAULT;
@@ -1747,6 +1705,21 @@ procargs_add(
 				return (EXIT_FAILURE);
 			}
 			break;
+		case 'i':	/* Only insert images */
+			ingestOptions.validateImages = true;
+			break;
+		case 'j':	/* Number of threads reading files */
+			try {
+				ingestOptions.threadCount = std::stoul(optarg);
+			} catch (std::exception &) {
+				std::cerr << "Invalid thread count: " <<
+				    optarg << std::endl;
+				return (EXIT_FAILURE);
+			}
+			break;
+		case 'v':	/* Show progress */
+			ingestOptions.showProgress = true;
+			break;
 		}
 	}
 	/* Remaining arguments are files to add (same as -a) */
@@ -2045,29 +2018,28 @@ add(
 	std::shared_ptr<BE::IO::RecordStore> rs, hash_rs;
 	std::vector<std::string> files;
 	bool stopOnDuplicate = true;
+	IngestOptions ingestOptions;
 
 	if (procargs_add(argc, argv, rs, hash_rs, files, what_to_hash,
-	    hashed_key_format, stopOnDuplicate) != EXIT_SUCCESS)
+	    hashed_key_format, stopOnDuplicate, ingestOptions) != EXIT_SUCCESS)
 		return (EXIT_FAILURE);
 
-	for (std::vector<std::string>::const_iterator file_path = files.begin();
-	    file_path != files.end(); file_path++) {
-		/*
-		 * Conscious decision to not care about the return value
-		 * when inserting because we may have multiple files we'd
-		 * like to add and there's no point in quitting halfway.
-		 */
-		if (BE::IO::Utility::pathIsDirectory(*file_path))
-			make_insert_directory_contents(
-			    BE::Text::basename(*file_path),
-			    BE::Text::dirname(*file_path), rs, hash_rs,
-			    what_to_hash, hashed_key_format,
-			    stopOnDuplicate);
-		else
-			make_insert_contents(*file_path, rs, hash_rs,
-			    what_to_hash, hashed_key_format,
-			    stopOnDuplicate);
-	}
+	/*
+	 * Conscious decision to not care about the return value
+	 * when inserting because we may have multiple files we'd
+	 * like to add and there's no point in quitting halfway.
+	 */
+	ingestOptions.stopOnError = false;
+	ingestFiles(files, ingestOptions,
+	    [&](const IngestedFile &file) {
+		if (hash_rs.get() == NULL)
+			return (std::string());
+		return (make_hash_contents(file, what_to_hash));
+	    },
+	    [&](const IngestedFile &file) {
+		return (make_insert_contents(file, rs, hash_rs,
+		    hashed_key_format, stopOnDuplicate));
+	    });
 
 	return (EXIT_SUCCESS);
 }
@@ -2180,7 +2152,8 @@ procargs_diff(
     std::shared_ptr<BE::IO::RecordStore> &sourceRS,
     std::shared_ptr<BE::IO::RecordStore> &targetRS,
     std::vector<std::string> &keys,
-    bool &byte_for_byte)
+    bool &byte_for_byte,
+    unsigned int &threadCount)
 {
 	int rsCount = 0;
 	char c;
@@ -2209,6 +2182,15 @@ procargs_diff(
 		} case 'f':	/* Byte-for-byte diff method */
 			byte_for_byte = true;
 			break;
+		case 'j':	/* Number of threads */
+			try {
+				threadCount = std::stoul(optarg);
+			} catch (std::exception &) {
+				std::cerr << "Invalid thread count: " <<
+				    optarg << std::endl;
+				return (EXIT_FAILURE);
+			}
+			break;
 		case 'k':	/* Individual keys to diff */
 			keys.push_back(optarg);
 			break;
@@ -2253,11 +2235,11 @@ diff(
     char *argv[])
 {
 	bool byte_for_byte = false;
-	int status = EXIT_SUCCESS;
+	unsigned int threadCount = 0;
 	std::shared_ptr<BE::IO::RecordStore> sourceRS, targetRS;
 	std::vector<std::string> keys;
 	if (procargs_diff(argc, argv, sourceRS, targetRS, keys,
-	    byte_for_byte) != EXIT_SUCCESS)
+	    byte_for_byte, threadCount) != EXIT_SUCCESS)
 		return (EXIT_FAILURE);
 
 	std::string sourcePath = sourceRS->getPathname();
@@ -2272,109 +2254,8 @@ diff(
 		return (EXIT_FAILURE);
 	}
 
-	/* If no keys passed, compare every key */
-	if (keys.empty()) {	
-		std::string key;
-		for (;;) {
-			try {
-				key = sourceRS->sequenceKey();
-				keys.push_back(key);
-			} catch (BE::Error::ObjectDoesNotExist) {
-				/* End of sequence */
-				break;
-			}
-		}
-	}
-	
-	bool sourceExists, targetExists;
-	BE::Memory::AutoArray<uint8_t> sourceBuf, targetBuf;
-	uint64_t sourceLength{0}, targetLength{0};
-	std::vector<std::string>::const_iterator key;
-	for (key = keys.begin(); key != keys.end(); key++) {		
-		/* Get sizes to check existence */
-		try {
-			sourceLength = sourceRS->length(*key);
-			sourceExists = true;
-		} catch (BE::Error::ObjectDoesNotExist) {
-			sourceExists = false;
-		}
-		try {
-			targetLength = targetRS->length(*key);
-			targetExists = true;
-		} catch (BE::Error::ObjectDoesNotExist) {
-			targetExists = false;
-		}
-		
-		/* Difference based on existence */
-		if ((sourceExists == false) && (targetExists == false)) {
-			std::cout << *key << ": not found." << std::endl;
-			status = EXIT_FAILURE;
-			continue;
-		} else if ((sourceExists == true) && (targetExists == false)) {
-			std::cout << *key << ": only in " << sourcePath << std::endl;
-			status = EXIT_FAILURE;
-			continue;
-		} else if ((sourceExists == false) && (targetExists == true)) {
-			std::cout << *key << ": only in " << targetPath << std::endl;
-			status = EXIT_FAILURE;
-			continue;
-		}
-		
-		/* Difference based on size */
-		if (sourceLength != targetLength) {
-			std::cout << *key << ':' << sourcePath << " and " <<
-			    *key << ':' << targetPath << " differ (size)" <<
-			    std::endl;
-			status = EXIT_FAILURE;
-			continue;
-		}
-		
-		/* Difference based on content */
-		try {
-			sourceBuf = sourceRS->read(*key);
-			if (sourceBuf.size() != sourceLength)
-				throw BE::Error::StrategyError("Source size");
-			targetBuf = targetRS->read(*key);
-			if (targetBuf.size() != targetLength)
-				throw BE::Error::StrategyError("Target size");
-		} catch (BE::Error::Exception &e) {
-			std::cerr << "Could not diff " << *key << " (" << 
-			    e.what() << ')' << std::endl;
-			status = EXIT_FAILURE;
-			continue;
-		}
-		
-		if (byte_for_byte) {
-			for (uint64_t i = 0; i < sourceLength; i++) {
-				if (sourceBuf[i] != targetBuf[i]) {
-					std::cout << *key << ':' << sourcePath
-					    << " and " << *key << ':' <<
-					    targetPath << " differ " <<
-					    "(byte for byte)" << std::endl;
-					status = EXIT_FAILURE;
-					break;
-				}
-			}
-		} else { /* MD5 */
-			try {
-				if (BE::Text::digest(sourceBuf, sourceLength) !=
-				    BE::Text::digest(targetBuf, targetLength)) {
-					std::cout << *key << ':' << sourcePath <<
-					    " and " << *key << ':' <<
-					    targetPath << " differ " <<
-					    "(MD5)" << std::endl;
-					status = EXIT_FAILURE;
-				}
-			} catch (BE::Error::Exception &e) {
-				std::cerr << "Could not diff " << *key << " ("
-				    << e.what() << ')' << std::endl;
-				status = EXIT_FAILURE;
-				continue;
-			}
-		}
-	}
-
-	return (status);
+	return (diffRecordStores(sourceRS, targetRS, keys,
+	    (byte_for_byte ? "byte for byte" : "MD5"), threadCount));
 }
 
 int
@@ -2526,6 +2407,68 @@ rename(
 	return (EXIT_SUCCESS);
 }
 
+int
+procargs_stats(
+    int argc,
+    char *argv[],
+    std::vector<std::string> &paths,
+    bool &examineImages,
+    bool &useCache,
+    unsigned int &threadCount)
+{
+	examineImages = false;
+	useCache = true;
+	threadCount = 0;
+
+	char c;
+	while ((c = getopt(argc, argv, optstr)) != EOF) {
+		switch (c) {
+		case 'f':	/* Ignore cached statistics */
+			useCache = false;
+			break;
+		case 'i':	/* Examine images */
+			examineImages = true;
+			break;
+		case 'j':	/* Number of threads */
+			try {
+				threadCount = std::stoul(optarg);
+			} catch (std::exception &) {
+				std::cerr << "Invalid thread count: " <<
+				    optarg << std::endl;
+				return (EXIT_FAILURE);
+			}
+			break;
+		case 's':	/* RecordStores to summarize */
+			if (!isRecordStoreAccessible(std::string(optarg),
+			    BE::IO::Mode::ReadOnly)) {
+				std::cerr << optarg << ": Permission "
+				    "denied." << std::endl;
+				return (EXIT_FAILURE);
+			}
+			paths.push_back(optarg);
+			break;
+		}
+	}
+
+	return (EXIT_SUCCESS);
+}
+
+int
+stats(
+    int argc,
+    char *argv[])
+{
+	std::vector<std::string> paths;
+	bool examineImages, useCache;
+	unsigned int threadCount;
+	if (procargs_stats(argc, argv, paths, examineImages, useCache,
+	    threadCount) != EXIT_SUCCESS)
+		return (EXIT_FAILURE);
+
+	return (printRecordStoreStatistics(paths, examineImages, useCache,
+	    threadCount));
+}
+
 int main(int argc, char *argv[])
 {
 	Action action = procargs(argc, argv);
@@ -2558,6 +2501,8 @@ int main(int argc, char *argv[])
 		return (remove(argc, argv));
 	case Action::RENAME:
 		return (rename(argc, argv));
+	case Action::STATS:
+		return (stats(argc, argv));
 	case Action::VERSION:
 		return (version(argc, argv));
 	case Action::UNHASH:
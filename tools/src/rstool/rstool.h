@@ -44,11 +44,13 @@
 #include <be_text.h>
 #include <be_memory_autoarray.h>
 
+#include <ingest_additions.h>
 #include <lrs_additions.h>
+#include <stats_additions.h>
 
 static std::string oflagval = ".";		/* Output directory */
 static std::string sflagval = "";		/* Path to main RecordStore */
-static const char optstr[] = "a:cfh:k:m:o:pqr:s:t:zZ:";
+static const char optstr[] = "a:cfh:ij:k:m:o:pqr:s:t:vzZ:";
 
 /* Possible actions performed by this utility */
 static const std::string ADD_ARG = "add";
@@ -61,6 +63,7 @@ static const std::string MAKE_ARG = "make";
 static const std::string MERGE_ARG = "merge";
 static const std::string REMOVE_ARG = "remove";
 static const std::string RENAME_ARG = "rename";
+static const std::string STATS_ARG = "stats";
 static const std::string VERSION_ARG = "version";
 static const std::string UNHASH_ARG = "unhash";
 
@@ -76,6 +79,7 @@ enum class Action
 	MERGE,
 	RENAME,
 	REMOVE,
+	STATS,
 	VERSION,
 	UNHASH,
 	QUIT
@@ -395,6 +399,8 @@ listRecordStore(
  * @param[in] stopOnDuplicate
  *	Whether or not to stop when attempting to add a duplicate key into
  *	the data RecordStore.
+ * @param[in/out] ingestOptions
+ *	Reference to settings for reading files on multiple threads.
  *
  * @return
  *	An exit status, either EXIT_SUCCESS or EXIT_FAILURE, that can be
@@ -412,73 +418,56 @@ procargs_make(
     std::vector<std::string> &elements,
     bool &compress,
     BiometricEvaluation::IO::Compressor::Kind &compressorKind,
-    bool &stopOnDuplicate);
+    bool &stopOnDuplicate,
+    IngestOptions &ingestOptions);
 
 /**
  * @brief
- * Helper function to insert the contents of a file into a RecordStore.
+ * Helper function to compute the hashed key of a file.
  *
- * @param[in] filename
- *	The name of the file whose contents should be inserted into rs.
- * @param[in] rs
- *	The RecordStore into which the contents of filename should be inserted
- * @param[in] hash_rs
- *	The RecordStore into which hash translations should be stored
+ * @param[in] file
+ *	The file to hash, including its contents.
  * @param[in] what_to_hash
  *	What should be hashed when creating a hash for an entry.
- * @param[in] hashed_key_format
- *	How the key should be displayed in a hash translation RecordStore.
- * @param[in] stopOnDuplicate
- *	Whether or not to stop when attempting to add a duplicate key into
- *	the data RecordStore.
  *
  * @return
- *	An exit status, either EXIT_FAILURE or EXIT_SUCCESS, depending on if
- *	the contents of filename could be inserted.
+ *	Hashed key for file, or an empty string when what_to_hash is
+ *	HashablePart::NOTHING.
+ *
+ * @note
+ *	Called from multiple threads at once.
  */
-int make_insert_contents(const std::string &filename,
-    const std::shared_ptr<BiometricEvaluation::IO::RecordStore> &rs,
-    const std::shared_ptr<BiometricEvaluation::IO::RecordStore> &hash_rs,
-    const HashablePart what_to_hash,
-    const KeyFormat hashed_key_format,
-    bool stopOnDuplicate);
+std::string
+make_hash_contents(
+    const IngestedFile &file,
+    const HashablePart what_to_hash);
 
 /**
  * @brief
- * Recursive helper function to insert the contents of a directory into
- * a RecordStore.
- * 
- * @param[in] directory
- *	Path of the directory to search through
- * @param[in] prefix
- *	The parent directories of directory
+ * Helper function to insert the contents of a file into a RecordStore.
+ *
+ * @param[in] file
+ *	The file whose contents should be inserted into rs, and its hashed
+ *	key when hash_rs is set.
  * @param[in] rs
- *	The RecordStore into which files should be inserted
+ *	The RecordStore into which the contents of filename should be inserted
  * @param[in] hash_rs
  *	The RecordStore into which hash translations should be stored
- * @param[in] what_to_hash
- *	What should be hashed when creating a hash for an entry.
- * @param[in] hashed_key_value
- *	How the key should be displayed in the hash translation RecordStore.
+ * @param[in] hashed_key_format
+ *	How the key should be displayed in a hash translation RecordStore.
  * @param[in] stopOnDuplicate
- *	Whether or not to stop if a duplicate key is detected.
- *
- * @throws BiometricEvaluation::Error::ObjectDoesNotExist
- *	If the contents of the directory changes during the run
- * @throws BiometricEvaluation::Error::StrategyError
- *	Underlying problem in storage system
+ *	Whether or not to stop when attempting to add a duplicate key into
+ *	the data RecordStore.
  *
  * @return
- *	An exit status, either EXIT_SUCCESS or EXIT_FAILURE, that can be
- *	returned from main().
+ *	An exit status, either EXIT_FAILURE or EXIT_SUCCESS, depending on if
+ *	the contents of filename could be inserted.
  */
 int
-make_insert_directory_contents(
-    const std::string &directory,
-    const std::string &prefix,
+make_insert_contents(
+    const IngestedFile &file,
     const std::shared_ptr<BiometricEvaluation::IO::RecordStore> &rs,
     const std::shared_ptr<BiometricEvaluation::IO::RecordStore> &hash_rs,
-    const HashablePart what_to_hash,
     const KeyFormat hashed_key_format,
     bool stopOnDuplicate);
 
@@ -627,6 +616,57 @@ merge(
     int argc,
     char *argv[]);
 
+/**
+ * @brief
+ * Process command-line arguments specific to the STATS Action.
+ *
+ * @param[in] argc
+ *	argc from main()
+ * @param[in] argv
+ *	argv from main()
+ * @param[in/out] paths
+ *	Reference to a vector that will hold paths to RecordStores to
+ *	summarize.
+ * @param[in/out] examineImages
+ *	Reference to a boolean that when true will examine the format and
+ *	dimensions of records that are images.
+ * @param[in/out] useCache
+ *	Reference to a boolean that when false will ignore statistics
+ *	cached in the RecordStores.
+ * @param[in/out] threadCount
+ *	Reference to the number of threads to use (0 for one per core).
+ *
+ * @return
+ *	An exit status, either EXIT_SUCCESS or EXIT_FAILURE, that can be
+ *	returned from main().
+ */
+int
+procargs_stats(
+    int argc,
+    char *argv[],
+    std::vector<std::string> &paths,
+    bool &examineImages,
+    bool &useCache,
+    unsigned int &threadCount);
+
+/**
+ * @brief
+ * Print statistics about the records in one or more RecordStores.
+ *
+ * @param[in] argc
+ *	argc from main()
+ * @param[in] argv
+ *	argv from main()
+ *
+ * @return
+ *	An exit status, either EXIT_SUCCESS or EXIT_FAILURE, that can be
+ *	returned from main().
+ */
+int
+stats(
+    int argc,
+    char *argv[]);
+
 /**
  * @brief
  * Display version information.
@@ -714,6 +754,8 @@ unhash(
  * @param[in] stopOnDuplicate
  *	Whether or not to stop when attempting to add a duplicate key into
  *	the data RecordStore.
+ * @param[in/out] ingestOptions
+ *	Reference to settings for reading files on multiple threads.
  *
  * @return
  *	An exit status, either EXIT_SUCCESS or EXIT_FAILURE, that can be
@@ -728,7 +770,8 @@ procargs_add(
     std::vector<std::string> &files,
     HashablePart &what_to_hash,
     KeyFormat &hashed_key_format,
-    bool &stopOnDuplicate);
+    bool &stopOnDuplicate,
+    IngestOptions &ingestOptions);
 /**
  * @brief
  * Process command-line arguments specific to the ADD/REMOVE actions when
@@ -913,6 +956,9 @@ rename(
  * @param[in/out] byte_for_byte
  *	Reference to a boolean that, when true, will perform the difference by
  *	comparing buffers byte-for-byte instead of using an MD5 checksum.
+ * @param[in/out] threadCount
+ *	Reference to the number of threads that compare records, where 0
+ *	means one per core.
  *
  * @return
  *	An exit status, either EXIT_SUCCESS or EXIT_FAILURE, that can be
@@ -925,7 +971,8 @@ procargs_diff(
     std::shared_ptr<BiometricEvaluation::IO::RecordStore> &sourceRS,
     std::shared_ptr<BiometricEvaluation::IO::RecordStore> &targetRS,
     std::vector<std::string> &keys,
-    bool &byte_for_byte);
+    bool &byte_for_byte,
+    unsigned int &threadCount);
 
 
 /**
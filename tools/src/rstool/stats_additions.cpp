@@ -0,0 +1,538 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <be_error_exception.h>
+#include <be_image_image.h>
+#include <be_io_archiverecstore.h>
+#include <be_io_propertiesfile.h>
+#include <be_io_recordstore.h>
+#include <be_io_utility.h>
+
+#include <diff_additions.h>
+#include <lrs_additions.h>
+#include <stats_additions.h>
+
+namespace BE = BiometricEvaluation;
+using namespace BE::Framework::Enumeration;
+
+/** A record found while listing a RecordStore. */
+struct StoreEntry
+{
+	/** Key of the record */
+	std::string key;
+	/** Size of the record */
+	uint64_t size;
+	/** Offset of the record within an archive file, if applicable */
+	uint64_t offset;
+};
+
+/** @return Smallest size in the power-of-two group containing size */
+static uint64_t
+sizeGroup(
+    uint64_t size)
+{
+	uint64_t group = 1;
+	if (size == 0)
+		return (0);
+	while ((size >>= 1) != 0)
+		group <<= 1;
+	return (group);
+}
+
+void
+StoreStatistics::addRecord(
+    const std::string &key,
+    uint64_t size)
+{
+	this->recordCount++;
+	this->totalSize += size;
+	this->minSize = std::min(this->minSize, size);
+	this->maxSize = std::max(this->maxSize, size);
+	this->sizes[sizeGroup(size)]++;
+	this->keyLengths[key.length()]++;
+}
+
+void
+StoreStatistics::merge(
+    const StoreStatistics &other)
+{
+	this->recordCount += other.recordCount;
+	this->totalSize += other.totalSize;
+	this->minSize = std::min(this->minSize, other.minSize);
+	this->maxSize = std::max(this->maxSize, other.maxSize);
+	for (const auto &count : other.sizes)
+		this->sizes[count.first] += count.second;
+	for (const auto &count : other.keyLengths)
+		this->keyLengths[count.first] += count.second;
+
+	/* Image statistics of a union are only meaningful if complete */
+	this->imagesExamined = (this->imagesExamined && other.imagesExamined);
+	for (const auto &count : other.imageFormats)
+		this->imageFormats[count.first] += count.second;
+	for (const auto &count : other.imageDimensions)
+		this->imageDimensions[count.first] += count.second;
+}
+
+/**
+ * @return Fingerprint that changes when a RecordStore is modified.
+ * @note The control file is excluded, since the cache is written there.
+ */
+static std::string
+storeFingerprint(
+    const BE::IO::RecordStore &rs)
+{
+	return (std::to_string(BE::IO::Utility::getDirectoryFingerprint(
+	    rs.getPathname(), {RSTool::CONTROLFILENAME})));
+}
+
+/** List the records of rs, reading only the manifest of archives. */
+static std::vector<StoreEntry>
+listStoreEntries(
+    const std::shared_ptr<BE::IO::RecordStore> &rs)
+{
+	std::vector<StoreEntry> entries;
+
+	const auto archive = std::dynamic_pointer_cast<
+	    BE::IO::ArchiveRecordStore>(rs);
+	if (archive) {
+		const ArchiveManifest manifest = readArchiveManifest(
+		    archive->getManifestName());
+		entries.reserve(manifest.keys.size());
+		for (const auto &key : manifest.keys) {
+			const ArchiveRegion &region = manifest.regions.at(key);
+			entries.push_back({key, region.size, region.offset});
+		}
+		return (entries);
+	}
+
+	entries.reserve(rs->getCount());
+	std::string key;
+	for (;;) {
+		try {
+			key = rs->sequenceKey();
+		} catch (BE::Error::ObjectDoesNotExist &) {
+			/* End of sequence */
+			break;
+		}
+		entries.push_back({key, rs->length(key), 0});
+	}
+	return (entries);
+}
+
+/** Count the format and dimensions of one record. */
+static void
+examineImage(
+    const BE::Memory::uint8Array &data,
+    std::map<std::string, uint64_t> &formats,
+    std::map<std::string, uint64_t> &dimensions)
+{
+	const BE::Image::CompressionAlgorithm format =
+	    BE::Image::Image::getCompressionAlgorithm(data);
+	formats[to_string(format)]++;
+	if (format == BE::Image::CompressionAlgorithm::None)
+		return;
+
+	try {
+		const BE::Image::Size size = BE::Image::Image::openImage(
+		    data)->getDimensions();
+		dimensions[std::to_string(size.xSize) + 'x' +
+		    std::to_string(size.ySize)]++;
+	} catch (BE::Error::Exception &) {
+		dimensions["Unreadable"]++;
+	}
+}
+
+/** Determine the format and dimensions of entries, on many threads. */
+static void
+examineImages(
+    const std::shared_ptr<BE::IO::RecordStore> &rs,
+    const std::vector<StoreEntry> &entries,
+    unsigned int threadCount,
+    StoreStatistics &stats)
+{
+	/* Archive records are read directly from the archive file */
+	std::string archivePath;
+	const auto archive = std::dynamic_pointer_cast<
+	    BE::IO::ArchiveRecordStore>(rs);
+	if (archive)
+		archivePath = archive->getArchiveName();
+
+	std::mutex statsMutex;
+	std::atomic<uint64_t> next{0};
+	std::vector<std::thread> workers;
+	threadCount = std::max(1u, threadCount);
+	std::vector<std::string> errors(threadCount);
+	for (unsigned int i = 0; i < threadCount; i++) {
+		workers.emplace_back([&, i]() {
+			std::map<std::string, uint64_t> formats, dimensions;
+			try {
+				/* RecordStores are not thread-safe */
+				std::shared_ptr<BE::IO::RecordStore> copy;
+				std::ifstream archiveFile;
+				if (archivePath.empty())
+					copy = BE::IO::RecordStore::
+					    openRecordStore(rs->getPathname(),
+					    BE::IO::Mode::ReadOnly);
+				else
+					archiveFile.open(archivePath,
+					    std::ios::binary);
+
+				BE::Memory::uint8Array data;
+				for (uint64_t index = next++; index <
+				    entries.size(); index = next++) {
+					const StoreEntry &entry =
+					    entries[index];
+					if (copy) {
+						data = copy->read(entry.key);
+						examineImage(data, formats,
+						    dimensions);
+						continue;
+					}
+
+					data.resize(entry.size);
+					archiveFile.seekg(entry.offset);
+					archiveFile.read(reinterpret_cast<
+					    char *>(&data[0]), entry.size);
+					if (!archiveFile)
+						throw BE::Error::FileError(
+						    "Could not read " +
+						    entry.key);
+					examineImage(data, formats, dimensions);
+				}
+			} catch (BE::Error::Exception &e) {
+				errors[i] = e.whatString();
+				next = entries.size();
+			}
+
+			std::lock_guard<std::mutex> lock(statsMutex);
+			for (const auto &count : formats)
+				stats.imageFormats[count.first] +=
+				    count.second;
+			for (const auto &count : dimensions)
+				stats.imageDimensions[count.first] +=
+				    count.second;
+		});
+	}
+	for (auto &worker : workers)
+		worker.join();
+
+	for (const auto &error : errors)
+		if (!error.empty())
+			throw BE::Error::StrategyError(error);
+	stats.imagesExamined = true;
+}
+
+StoreStatistics
+computeStoreStatistics(
+    const std::string &path,
+    bool examineImages,
+    unsigned int threadCount)
+{
+	const auto rs = BE::IO::RecordStore::openRecordStore(path,
+	    BE::IO::Mode::ReadOnly);
+	const std::vector<StoreEntry> entries = listStoreEntries(rs);
+
+	StoreStatistics stats;
+	for (const auto &entry : entries)
+		stats.addRecord(entry.key, entry.size);
+	if (examineImages)
+		::examineImages(rs, entries, threadCount, stats);
+
+	return (stats);
+}
+
+/** @return "label=count;label=count;..." */
+template<typename T>
+static std::string
+serializeCounts(
+    const std::map<T, uint64_t> &counts)
+{
+	std::ostringstream value;
+	for (const auto &count : counts) {
+		if (value.tellp() > 0)
+			value << ';';
+		value << count.first << '=' << count.second;
+	}
+	return (value.str());
+}
+
+/** @return Label of a count, as a string */
+static std::string
+parseLabel(
+    const std::string &label,
+    const std::string &)
+{
+	return (label);
+}
+
+/** @return Label of a count, as a number */
+static uint64_t
+parseLabel(
+    const std::string &label,
+    const uint64_t &)
+{
+	return (std::stoull(label));
+}
+
+/** @return Counts parsed from the output of serializeCounts() */
+template<typename T>
+static std::map<T, uint64_t>
+parseCounts(
+    const std::string &value)
+{
+	std::map<T, uint64_t> counts;
+	std::istringstream stream(value);
+	std::string item;
+	while (std::getline(stream, item, ';')) {
+		const std::string::size_type separator = item.rfind('=');
+		if (separator == std::string::npos)
+			throw BE::Error::StrategyError("Invalid count: " +
+			    item);
+
+		try {
+			counts[parseLabel(item.substr(0, separator),
+			    T())] = std::stoull(item.substr(separator + 1));
+		} catch (std::exception &) {
+			throw BE::Error::StrategyError("Invalid count: " +
+			    item);
+		}
+	}
+	return (counts);
+}
+
+bool
+readCachedStoreStatistics(
+    const std::string &path,
+    const std::string &fingerprint,
+    bool examineImages,
+    StoreStatistics &stats)
+{
+	try {
+		const BE::IO::PropertiesFile props(path + '/' +
+		    RSTool::CONTROLFILENAME, BE::IO::Mode::ReadOnly);
+		if (props.getProperty(RSTool::STATSFINGERPRINTPROPERTY) !=
+		    fingerprint)
+			return (false);
+
+		StoreStatistics cached;
+		std::istringstream range(props.getProperty(
+		    RSTool::STATSSIZERANGEPROPERTY));
+		range >> cached.recordCount >> cached.totalSize >>
+		    cached.minSize >> cached.maxSize;
+		if (!range)
+			return (false);
+		cached.sizes = parseCounts<uint64_t>(props.getProperty(
+		    RSTool::STATSSIZESPROPERTY));
+		cached.keyLengths = parseCounts<uint64_t>(props.getProperty(
+		    RSTool::STATSKEYLENGTHSPROPERTY));
+
+		try {
+			cached.imageFormats = parseCounts<std::string>(
+			    props.getProperty(
+			    RSTool::STATSIMAGEFORMATSPROPERTY));
+			cached.imageDimensions = parseCounts<std::string>(
+			    props.getProperty(
+			    RSTool::STATSIMAGESIZESPROPERTY));
+			cached.imagesExamined = true;
+		} catch (BE::Error::ObjectDoesNotExist &) {
+			if (examineImages)
+				return (false);
+		}
+
+		stats = cached;
+		return (true);
+	} catch (BE::Error::Exception &) {
+		return (false);
+	}
+}
+
+void
+writeCachedStoreStatistics(
+    const std::string &path,
+    const std::string &fingerprint,
+    const StoreStatistics &stats)
+{
+	BE::IO::PropertiesFile props(path + '/' + RSTool::CONTROLFILENAME,
+	    BE::IO::Mode::ReadWrite);
+	props.setProperty(RSTool::STATSFINGERPRINTPROPERTY, fingerprint);
+	props.setProperty(RSTool::STATSSIZERANGEPROPERTY,
+	    std::to_string(stats.recordCount) + ' ' +
+	    std::to_string(stats.totalSize) + ' ' +
+	    std::to_string(stats.minSize) + ' ' +
+	    std::to_string(stats.maxSize));
+	props.setProperty(RSTool::STATSSIZESPROPERTY,
+	    serializeCounts(stats.sizes));
+	props.setProperty(RSTool::STATSKEYLENGTHSPROPERTY,
+	    serializeCounts(stats.keyLengths));
+	if (stats.imagesExamined) {
+		props.setProperty(RSTool::STATSIMAGEFORMATSPROPERTY,
+		    serializeCounts(stats.imageFormats));
+		props.setProperty(RSTool::STATSIMAGESIZESPROPERTY,
+		    serializeCounts(stats.imageDimensions));
+	} else {
+		try {
+			props.removeProperty(
+			    RSTool::STATSIMAGEFORMATSPROPERTY);
+			props.removeProperty(RSTool::STATSIMAGESIZESPROPERTY);
+		} catch (BE::Error::ObjectDoesNotExist &) {}
+	}
+	props.sync();
+}
+
+/** Print one line per count, in a column. */
+template<typename T>
+static void
+printCounts(
+    std::ostream &stream,
+    const std::string &title,
+    const std::map<T, uint64_t> &counts,
+    const std::function<std::string(const T&)> &label)
+{
+	stream << title << ':' << std::endl;
+	for (const auto &count : counts)
+		stream << "  " << std::left << std::setw(24) <<
+		    label(count.first) << std::right << std::setw(12) <<
+		    count.second << std::endl;
+}
+
+void
+printStoreStatistics(
+    std::ostream &stream,
+    const StoreStatistics &stats)
+{
+	stream << "Records: " << stats.recordCount << std::endl;
+	if (stats.recordCount == 0)
+		return;
+	stream << "Total size: " << stats.totalSize << " bytes" << std::endl;
+	stream << "Record size: " << stats.minSize << " min, " <<
+	    (stats.totalSize / stats.recordCount) << " mean, " <<
+	    stats.maxSize << " max" << std::endl;
+
+	printCounts<uint64_t>(stream, "Record sizes (bytes)", stats.sizes,
+	    [](const uint64_t &group) {
+		if (group <= 1)
+			return (std::to_string(group));
+		return (std::to_string(group) + " - " +
+		    std::to_string((group * 2) - 1));
+	    });
+	printCounts<uint64_t>(stream, "Key lengths", stats.keyLengths,
+	    [](const uint64_t &length) { return (std::to_string(length)); });
+
+	if (!stats.imagesExamined)
+		return;
+	printCounts<std::string>(stream, "Image formats", stats.imageFormats,
+	    [](const std::string &format) { return (format); });
+	printCounts<std::string>(stream, "Image dimensions",
+	    stats.imageDimensions,
+	    [](const std::string &dimension) { return (dimension); });
+}
+
+/** Statistics for one RecordStore, from the cache if possible. */
+static StoreStatistics
+statisticsForStore(
+    const std::string &path,
+    bool examineImages,
+    bool useCache,
+    unsigned int threadCount)
+{
+	std::string fingerprint;
+	{
+		const auto rs = BE::IO::RecordStore::openRecordStore(path,
+		    BE::IO::Mode::ReadOnly);
+		fingerprint = storeFingerprint(*rs);
+	}
+
+	StoreStatistics stats;
+	if (useCache && readCachedStoreStatistics(path, fingerprint,
+	    examineImages, stats))
+		return (stats);
+
+	stats = computeStoreStatistics(path, examineImages, threadCount);
+	try {
+		writeCachedStoreStatistics(path, fingerprint, stats);
+	} catch (BE::Error::Exception &) {
+		/* Caching is best effort (e.g., RecordStore is read-only) */
+	}
+	return (stats);
+}
+
+int
+printRecordStoreStatistics(
+    const std::vector<std::string> &paths,
+    bool examineImages,
+    bool useCache,
+    unsigned int threadCount)
+{
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	/* Split threads between RecordStores and images within them */
+	const unsigned int storeThreadCount = std::min<unsigned int>(
+	    threadCount, paths.size());
+	const unsigned int imageThreadCount = std::max(1u,
+	    threadCount / std::max(1u, storeThreadCount));
+
+	std::vector<StoreStatistics> stats(paths.size());
+	std::vector<std::string> errors(paths.size());
+	std::atomic<size_t> next{0};
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < storeThreadCount; i++) {
+		workers.emplace_back([&]() {
+			for (size_t index = next++; index < paths.size();
+			    index = next++) {
+				try {
+					stats[index] = statisticsForStore(
+					    paths[index], examineImages,
+					    useCache, imageThreadCount);
+				} catch (BE::Error::Exception &e) {
+					errors[index] = e.whatString();
+				}
+			}
+		});
+	}
+	for (auto &worker : workers)
+		worker.join();
+
+	int status = EXIT_SUCCESS;
+	StoreStatistics total;
+	total.imagesExamined = examineImages;
+	for (size_t i = 0; i < paths.size(); i++) {
+		if (i != 0)
+			std::cout << std::endl;
+		std::cout << paths[i] << std::endl;
+		if (!errors[i].empty()) {
+			std::cerr << "Could not summarize " << paths[i] <<
+			    " - " << errors[i] << std::endl;
+			status = EXIT_FAILURE;
+			continue;
+		}
+		printStoreStatistics(std::cout, stats[i]);
+		total.merge(stats[i]);
+	}
+
+	if (paths.size() > 1) {
+		std::cout << std::endl << "Total" << std::endl;
+		printStoreStatistics(std::cout, total);
+	}
+
+	return (status);
+}
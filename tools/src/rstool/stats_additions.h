@@ -0,0 +1,207 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+/*
+ * stats_additions - summarize the records of RecordStores, reading only
+ *                   manifests and record lengths where possible.
+ */
+
+#ifndef __RSTOOL_STATS_ADDITIONS_H__
+#define __RSTOOL_STATS_ADDITIONS_H__
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace RSTool
+{
+	/* Properties caching statistics in a RecordStore's control file */
+	const std::string STATSFINGERPRINTPROPERTY{"Statistics Fingerprint"};
+	const std::string STATSSIZESPROPERTY{"Statistics Record Sizes"};
+	const std::string STATSSIZERANGEPROPERTY{"Statistics Size Range"};
+	const std::string STATSKEYLENGTHSPROPERTY{"Statistics Key Lengths"};
+	const std::string STATSIMAGEFORMATSPROPERTY{"Statistics Image Formats"};
+	const std::string STATSIMAGESIZESPROPERTY{
+	    "Statistics Image Dimensions"};
+}
+
+/** Summary of the records in one or more RecordStores. */
+struct StoreStatistics
+{
+	/** Number of records */
+	uint64_t recordCount{0};
+	/** Sum of the sizes of all records */
+	uint64_t totalSize{0};
+	/** Size of the smallest record */
+	uint64_t minSize{std::numeric_limits<uint64_t>::max()};
+	/** Size of the largest record */
+	uint64_t maxSize{0};
+	/**
+	 * Number of records of each size. Sizes are grouped by power of two
+	 * and identified by the smallest size in the group (0, 1, 2, 4, ...).
+	 */
+	std::map<uint64_t, uint64_t> sizes{};
+	/** Number of keys of each length */
+	std::map<uint64_t, uint64_t> keyLengths{};
+
+	/** Whether record contents were examined as images */
+	bool imagesExamined{false};
+	/** Number of records of each image format ("None" if unknown) */
+	std::map<std::string, uint64_t> imageFormats{};
+	/** Number of images of each dimension ("WxH") */
+	std::map<std::string, uint64_t> imageDimensions{};
+
+	/**
+	 * @brief
+	 * Count one record.
+	 *
+	 * @param key
+	 *	Key of the record.
+	 * @param size
+	 *	Size of the record.
+	 */
+	void
+	addRecord(
+	    const std::string &key,
+	    uint64_t size);
+
+	/**
+	 * @brief
+	 * Add the counts of another StoreStatistics to this one.
+	 *
+	 * @param other
+	 *	Statistics to merge.
+	 */
+	void
+	merge(
+	    const StoreStatistics &other);
+};
+
+/**
+ * @brief
+ * Summarize the records of a RecordStore.
+ * @details
+ * Sizes of ArchiveRecordStore records are read from the manifest. Other
+ * RecordStores are sequenced by key alone and asked for the length of
+ * each record. Record contents are read only when examining images,
+ * which is done on threadCount threads.
+ *
+ * @param path
+ *	Path to the RecordStore.
+ * @param examineImages
+ *	Whether or not to determine the format and dimensions of records
+ *	that are images.
+ * @param threadCount
+ *	Number of threads examining images.
+ *
+ * @return
+ *	Statistics for the RecordStore at path.
+ *
+ * @throw Error::Exception
+ *	Could not open or read from the RecordStore.
+ */
+StoreStatistics
+computeStoreStatistics(
+    const std::string &path,
+    bool examineImages,
+    unsigned int threadCount);
+
+/**
+ * @brief
+ * Obtain statistics cached in a RecordStore's control file.
+ *
+ * @param path
+ *	Path to the RecordStore.
+ * @param fingerprint
+ *	Current fingerprint of the RecordStore.
+ * @param examineImages
+ *	Whether or not image statistics are required.
+ * @param stats
+ *	Populated with the cached statistics.
+ *
+ * @return
+ *	true if statistics were cached with fingerprint (and with image
+ *	statistics, if required), false otherwise.
+ */
+bool
+readCachedStoreStatistics(
+    const std::string &path,
+    const std::string &fingerprint,
+    bool examineImages,
+    StoreStatistics &stats);
+
+/**
+ * @brief
+ * Cache statistics in a RecordStore's control file.
+ *
+ * @param path
+ *	Path to the RecordStore, which must not be open for writing.
+ * @param fingerprint
+ *	Current fingerprint of the RecordStore.
+ * @param stats
+ *	Statistics to cache.
+ *
+ * @throw Error::Exception
+ *	Could not write to the control file.
+ */
+void
+writeCachedStoreStatistics(
+    const std::string &path,
+    const std::string &fingerprint,
+    const StoreStatistics &stats);
+
+/**
+ * @brief
+ * Print statistics.
+ *
+ * @param stream
+ *	Where to print stats.
+ * @param stats
+ *	Statistics to print.
+ */
+void
+printStoreStatistics(
+    std::ostream &stream,
+    const StoreStatistics &stats);
+
+/**
+ * @brief
+ * Summarize the records of several RecordStores, in parallel.
+ * @details
+ * Statistics are printed for each RecordStore, followed by statistics
+ * for their union when there is more than one. Statistics are cached in
+ * each RecordStore's control file and reused until the number of records
+ * or space used by the RecordStore changes.
+ *
+ * @param paths
+ *	Paths to RecordStores.
+ * @param examineImages
+ *	Whether or not to determine the format and dimensions of records
+ *	that are images.
+ * @param useCache
+ *	Whether or not to use previously cached statistics.
+ * @param threadCount
+ *	Number of threads, or 0 for one per core.
+ *
+ * @return
+ *	EXIT_SUCCESS if statistics were printed for every RecordStore,
+ *	EXIT_FAILURE otherwise.
+ */
+int
+printRecordStoreStatistics(
+    const std::vector<std::string> &paths,
+    bool examineImages,
+    bool useCache,
+    unsigned int threadCount);
+
+#endif /* __RSTOOL_STATS_ADDITIONS_H__ */